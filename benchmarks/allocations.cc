@@ -0,0 +1,209 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Measures what parsing a message allocates, by category (see
+// google/protobuf/allocator.h), and how long parsing takes with the default
+// allocator and with a simple free-list Allocator.  Each round parses into
+// a new message and deletes it, and then parses into a reused one.  The
+// message type comes from a .proto file (parsed at run time, so the
+// message is a DynamicMessage) and its contents from a binary file, e.g.:
+//
+//   ./allocations google_speed.proto benchmarks.SpeedMessage2 \
+//       google_message2.dat 20000 free-lists
+//
+// uses the free-list Allocator; leave out "free-lists" for the default.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/allocator.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/compiler/parser.h>
+#include <google/protobuf/io/tokenizer.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+// Keeps freed blocks of up to 1 KB in free lists by size, and reuses them.
+// Each block has a 16-byte header with its size class (0 for blocks from
+// operator new).  The library only hands it back blocks of its own.
+class FreeListAllocator : public Allocator {
+ public:
+  FreeListAllocator() : free_lists_(kClasses + 1) {}
+
+  virtual void* Allocate(size_t size, AllocationCategory category) {
+    size_t size_class = (size + kHeader - 1) / kHeader;
+    char* block;
+    if (size_class > kClasses) {
+      size_class = 0;
+      block = static_cast<char*>(::operator new(size + kHeader));
+    } else if (!free_lists_[size_class].empty()) {
+      block = free_lists_[size_class].back();
+      free_lists_[size_class].pop_back();
+    } else {
+      block = static_cast<char*>(::operator new((size_class + 1) * kHeader));
+    }
+    memcpy(block, &size_class, sizeof(size_class));
+    return block + kHeader;
+  }
+
+  virtual void Free(void* ptr, AllocationCategory category) {
+    char* block = static_cast<char*>(ptr) - kHeader;
+    size_t size_class;
+    memcpy(&size_class, block, sizeof(size_class));
+    if (size_class == 0) {
+      ::operator delete(block);
+    } else {
+      free_lists_[size_class].push_back(block);
+    }
+  }
+
+ private:
+  static const size_t kHeader = 16;
+  static const size_t kClasses = 1024 / kHeader;
+
+  std::vector<std::vector<char*> > free_lists_;
+};
+
+double Now() {
+  return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+}
+
+std::string ReadFile(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) {
+    fprintf(stderr, "%s: cannot open\n", path);
+    exit(1);
+  }
+  std::string contents;
+  char buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    contents.append(buffer, size);
+  }
+  fclose(file);
+  return contents;
+}
+
+// Parses data rounds times into a new message each time and into a reused
+// one, and prints the time and allocations per message.
+void Run(const Message& prototype, const std::string& data, int rounds) {
+  const char* const kNames[] = { "new message", "reused message" };
+  Message* reused = prototype.New();
+  reused->ParseFromString(data);  // Warm up.
+  for (int reuse = 0; reuse < 2; reuse++) {
+    AllocationStats before[MAX_ALLOCATION_CATEGORY + 1];
+    for (int i = 0; i <= MAX_ALLOCATION_CATEGORY; i++) {
+      before[i] = GetAllocationStats(static_cast<AllocationCategory>(i));
+    }
+    double start = Now();
+    for (int i = 0; i < rounds; i++) {
+      if (reuse) {
+        reused->ParseFromString(data);
+      } else {
+        Message* message = prototype.New();
+        message->ParseFromString(data);
+        delete message;
+      }
+    }
+    double seconds = Now() - start;
+
+    printf("  %-16s %8.2f us/message\n", kNames[reuse],
+           seconds * 1e6 / rounds);
+    for (int i = 0; i <= MAX_ALLOCATION_CATEGORY; i++) {
+      AllocationCategory category = static_cast<AllocationCategory>(i);
+      AllocationStats after = GetAllocationStats(category);
+      printf("    %-20s %8.1f allocations/message %8.1f bytes/message\n",
+             AllocationCategoryName(category),
+             static_cast<double>(after.allocations - before[i].allocations) /
+                 rounds,
+             static_cast<double>(after.bytes - before[i].bytes) / rounds);
+    }
+  }
+  delete reused;
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
+
+int main(int argc, char* argv[]) {
+  using namespace google::protobuf;
+
+  if (argc < 4) {
+    fprintf(stderr, "Usage: %s PROTO_FILE MESSAGE_TYPE DATA_FILE "
+            "[ROUNDS [free-lists]]\n", argv[0]);
+    return 1;
+  }
+  int rounds = argc > 4 ? atoi(argv[4]) : 20000;
+
+  // Everything below is allocated by one allocator or the other.
+  static FreeListAllocator free_list_allocator;
+  bool use_free_lists = argc > 5 && strcmp(argv[5], "free-lists") == 0;
+  if (use_free_lists) SetAllocator(&free_list_allocator);
+
+  FileDescriptorProto file_proto;
+  {
+    std::string contents = ReadFile(argv[1]);
+    io::ArrayInputStream input(contents.data(), contents.size());
+    io::Tokenizer tokenizer(&input, NULL);
+    compiler::Parser parser;
+    if (!parser.Parse(&tokenizer, &file_proto)) {
+      fprintf(stderr, "%s: parse failed\n", argv[1]);
+      return 1;
+    }
+  }
+  file_proto.set_name(argv[1]);
+  DescriptorPool pool;
+  if (pool.BuildFile(file_proto) == NULL) {
+    fprintf(stderr, "%s: build failed\n", argv[1]);
+    return 1;
+  }
+  const Descriptor* type = pool.FindMessageTypeByName(argv[2]);
+  if (type == NULL) {
+    fprintf(stderr, "%s: no such message type\n", argv[2]);
+    return 1;
+  }
+  DynamicMessageFactory factory(&pool);
+  std::string data = ReadFile(argv[3]);
+
+  printf("%s allocator:\n", use_free_lists ? "free-list" : "default");
+  Run(*factory.GetPrototype(type), data, rounds);
+  return 0;
+}
@@ -0,0 +1,148 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Measures what a "done" closure costs per call:  one from NewCallback(),
+// one from NewPooledCallback() and a MethodCallback1 kept by the caller and
+// Bind()'d again for each call.  Each closure is handed to a function which
+// runs it through the Closure interface, as an RpcChannel would, e.g.:
+//
+//   ./closures 10000000
+//
+// It reports the time and the heap allocations per call of each.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <new>
+
+#include <google/protobuf/stubs/common.h>
+
+#if __cplusplus >= 201103L
+#define NOTHROW noexcept
+#else
+#define NOTHROW throw()
+#endif
+
+// Counts heap allocations.
+static long long allocations = 0;
+void* operator new(size_t size) {
+  ++allocations;
+  void* p = malloc(size);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) NOTHROW { free(p); }
+
+namespace google {
+namespace protobuf {
+namespace {
+
+double NowSeconds() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + now.tv_usec / 1e6;
+}
+
+// Stands in for an RpcChannel:  runs done, in another translation unit as
+// far as the compiler can tell.
+void __attribute__((noinline)) Call(Closure* done) {
+  done->Run();
+}
+
+class Caller {
+ public:
+  Caller() : sum_(0) {}
+
+  void Done(int64 value) { sum_ += value; }
+
+  double NewCallbacks(int calls) {
+    double start = NowSeconds();
+    for (int i = 0; i < calls; i++) {
+      Call(NewCallback(this, &Caller::Done, static_cast<int64>(i)));
+    }
+    return NowSeconds() - start;
+  }
+
+  double PooledCallbacks(int calls) {
+    double start = NowSeconds();
+    for (int i = 0; i < calls; i++) {
+      Call(NewPooledCallback(this, &Caller::Done, static_cast<int64>(i)));
+    }
+    return NowSeconds() - start;
+  }
+
+  double EmbeddedCallbacks(int calls) {
+    double start = NowSeconds();
+    for (int i = 0; i < calls; i++) {
+      done_.Bind(this, &Caller::Done, static_cast<int64>(i));
+      Call(&done_);
+    }
+    return NowSeconds() - start;
+  }
+
+  int64 sum() const { return sum_; }
+
+ private:
+  int64 sum_;
+  MethodCallback1<Caller, int64> done_;
+};
+
+void Report(const char* name, int calls, double seconds,
+            long long allocated) {
+  printf("  %-20s %8.1f ns/call %6.2f allocations/call\n", name,
+         seconds * 1e9 / calls, static_cast<double>(allocated) / calls);
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
+
+int main(int argc, char* argv[]) {
+  using google::protobuf::Caller;
+  using google::protobuf::Report;
+
+  int calls = argc > 1 ? atoi(argv[1]) : 10000000;
+  Caller caller;
+  printf("%d calls:\n", calls);
+
+  long long before = allocations;
+  double seconds = caller.NewCallbacks(calls);
+  Report("NewCallback()", calls, seconds, allocations - before);
+
+  before = allocations;
+  seconds = caller.PooledCallbacks(calls);
+  Report("NewPooledCallback()", calls, seconds, allocations - before);
+
+  before = allocations;
+  seconds = caller.EmbeddedCallbacks(calls);
+  Report("MethodCallback1", calls, seconds, allocations - before);
+
+  return caller.sum() == 0;
+}
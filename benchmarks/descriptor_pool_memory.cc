@@ -0,0 +1,189 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Measures how many heap bytes a DescriptorPool holds after loading
+// unittest_enormous_descriptor.proto and a large synthetic corpus of files.
+// Live bytes are tracked by replacing the global operator new/delete, so the
+// numbers include all per-allocation bookkeeping the pool asks for but not
+// the malloc implementation's own headers.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <string>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/compiler/parser.h>
+#include <google/protobuf/io/tokenizer.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/stubs/strutil.h>
+
+namespace {
+
+size_t live_bytes = 0;
+size_t live_allocations = 0;
+
+}  // namespace
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+  size_t* block = static_cast<size_t*>(malloc(size + sizeof(size_t)));
+  if (block == NULL) throw std::bad_alloc();
+  *block = size;
+  live_bytes += size;
+  ++live_allocations;
+  return block + 1;
+}
+
+void operator delete(void* ptr) throw() {
+  if (ptr == NULL) return;
+  size_t* block = static_cast<size_t*>(ptr) - 1;
+  live_bytes -= *block;
+  --live_allocations;
+  free(block);
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc) {
+  return operator new(size);
+}
+
+void operator delete[](void* ptr) throw() {
+  operator delete(ptr);
+}
+
+namespace google {
+namespace protobuf {
+namespace {
+
+const char* const kFieldNames[] = {
+  "id", "name", "display_name", "description", "created_at", "updated_at",
+  "owner", "labels", "state", "version", "parent_id", "start_time",
+  "end_time", "count", "total", "value", "unit", "kind", "status", "error",
+};
+const int kFieldNameCount = sizeof(kFieldNames) / sizeof(kFieldNames[0]);
+
+void Report(const char* name, int files, size_t bytes, size_t allocations) {
+  printf("%-24s %6d files %12lu bytes %9lu allocations\n", name, files,
+         static_cast<unsigned long>(bytes),
+         static_cast<unsigned long>(allocations));
+}
+
+void MeasureEnormousDescriptor(const char* path) {
+  FileDescriptorProto file_proto;
+  {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+      fprintf(stderr, "%s: cannot open\n", path);
+      exit(1);
+    }
+    io::FileInputStream input(fileno(file));
+    io::Tokenizer tokenizer(&input, NULL);
+    compiler::Parser parser;
+    if (!parser.Parse(&tokenizer, &file_proto)) {
+      fprintf(stderr, "%s: parse failed\n", path);
+      exit(1);
+    }
+    fclose(file);
+  }
+  file_proto.set_name("google/protobuf/unittest_enormous_descriptor.proto");
+
+  size_t bytes_before = live_bytes;
+  size_t allocations_before = live_allocations;
+  DescriptorPool* pool = new DescriptorPool;
+  if (pool->BuildFile(file_proto) == NULL) {
+    fprintf(stderr, "%s: build failed\n", path);
+    exit(1);
+  }
+  Report("enormous_descriptor", 1, live_bytes - bytes_before,
+         live_allocations - allocations_before);
+  delete pool;
+}
+
+void MeasureSyntheticCorpus(int file_count) {
+  size_t bytes_before = live_bytes;
+  size_t allocations_before = live_allocations;
+  DescriptorPool* pool = new DescriptorPool;
+
+  for (int i = 0; i < file_count; i++) {
+    FileDescriptorProto* file_proto = new FileDescriptorProto;
+    file_proto->set_name("corpus/file" + SimpleItoa(i) + ".proto");
+    file_proto->set_package("corpus.service" + SimpleItoa(i));
+
+    for (int j = 0; j < 10; j++) {
+      DescriptorProto* message = file_proto->add_message_type();
+      message->set_name("Message" + SimpleItoa(j));
+      for (int k = 0; k < kFieldNameCount; k++) {
+        FieldDescriptorProto* field = message->add_field();
+        field->set_name(kFieldNames[k]);
+        field->set_number(k + 1);
+        field->set_label(FieldDescriptorProto::LABEL_OPTIONAL);
+        field->set_type(k % 3 == 0 ? FieldDescriptorProto::TYPE_STRING
+                                   : FieldDescriptorProto::TYPE_INT64);
+      }
+    }
+
+    EnumDescriptorProto* enum_proto = file_proto->add_enum_type();
+    enum_proto->set_name("State");
+    const char* const kValueNames[] = {
+      "UNKNOWN", "PENDING", "RUNNING", "DONE", "FAILED" };
+    for (int j = 0; j < 5; j++) {
+      EnumValueDescriptorProto* value = enum_proto->add_value();
+      value->set_name(std::string("STATE_") + kValueNames[j]);
+      value->set_number(j);
+    }
+
+    if (pool->BuildFile(*file_proto) == NULL) {
+      fprintf(stderr, "synthetic file %d: build failed\n", i);
+      exit(1);
+    }
+    delete file_proto;
+  }
+
+  Report("synthetic_corpus", file_count, live_bytes - bytes_before,
+         live_allocations - allocations_before);
+  delete pool;
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s unittest_enormous_descriptor.proto [files]\n",
+            argv[0]);
+    return 1;
+  }
+  int file_count = argc > 2 ? atoi(argv[2]) : 2000;
+
+  google::protobuf::MeasureEnormousDescriptor(argv[1]);
+  google::protobuf::MeasureSyntheticCorpus(file_count);
+  return 0;
+}
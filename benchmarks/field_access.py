@@ -0,0 +1,131 @@
+#! /usr/bin/python
+#
+# Protocol Buffers - Google's data interchange format
+# Copyright 2008 Google Inc.  All rights reserved.
+# http://code.google.com/p/protobuf/
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+#
+#     * Redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above
+# copyright notice, this list of conditions and the following disclaimer
+# in the documentation and/or other materials provided with the
+# distribution.
+#     * Neither the name of Google Inc. nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Measures attribute access on a message of google_speed.proto.
+
+Reads and writes singular fields of a SpeedMessage1 parsed from
+google_message1.dat, and reports the time per access.  Then fills its
+repeated fixed64 field with a million values, and reports how long it takes
+to get them all out and to assign them all back.  The implementation
+measured is the one PROTOCOL_BUFFERS_PYTHON_IMPLEMENTATION selects, so run
+it once with "python" and once with "cpp" to compare them.
+"""
+
+import sys
+import time
+
+from google.protobuf.internal import api_implementation
+import google_speed_pb2
+
+
+def TimeLoop(name, function, rounds):
+  start = time.time()
+  function(rounds)
+  seconds = time.time() - start
+  print '  %-22s %8.1f ns/access' % (name, seconds * 1e9 / rounds)
+
+
+def main(argv):
+  rounds = 1000000
+  if len(argv) > 1:
+    rounds = int(argv[1])
+
+  message = google_speed_pb2.SpeedMessage1()
+  message.ParseFromString(open('google_message1.dat', 'rb').read())
+
+  def GetInt32(rounds):
+    for i in xrange(rounds):
+      message.field2
+
+  def GetBool(rounds):
+    for i in xrange(rounds):
+      message.field80
+
+  def GetInt64(rounds):
+    for i in xrange(rounds):
+      message.field22
+
+  def GetString(rounds):
+    for i in xrange(rounds):
+      message.field1
+
+  def SetInt32(rounds):
+    for i in xrange(rounds):
+      message.field2 = 1234
+
+  def SetBool(rounds):
+    for i in xrange(rounds):
+      message.field80 = True
+
+  def HasField(rounds):
+    for i in xrange(rounds):
+      message.HasField('field2')
+
+  def EmptyLoop(rounds):
+    for i in xrange(rounds):
+      pass
+
+  print '%s implementation, %d rounds:' % (api_implementation.Type(), rounds)
+  TimeLoop('empty loop', EmptyLoop, rounds)
+  TimeLoop('get int32', GetInt32, rounds)
+  TimeLoop('get bool', GetBool, rounds)
+  TimeLoop('get int64', GetInt64, rounds)
+  TimeLoop('get string', GetString, rounds)
+  TimeLoop('set int32', SetInt32, rounds)
+  TimeLoop('set bool', SetBool, rounds)
+  TimeLoop('HasField()', HasField, rounds)
+
+  values = range(1000000)
+  message.field5.extend(values)
+  other = google_speed_pb2.SpeedMessage1()
+
+  def TimeOnce(name, function):
+    start = time.time()
+    function()
+    print '  %-22s %8.1f ms' % (name, (time.time() - start) * 1e3)
+
+  def AssignList():
+    other.field5[:] = values
+
+  def AssignView():
+    other.field5[:] = message.field5.AsMemoryView()
+
+  print 'Repeated field of %d values:' % len(message.field5)
+  TimeOnce('copy to list', lambda: message.field5[:])
+  TimeOnce('assign from list', AssignList)
+  if api_implementation.Type() == 'cpp':
+    TimeOnce('memoryview', message.field5.AsMemoryView)
+    TimeOnce('assign from memoryview', AssignView)
+
+
+if __name__ == '__main__':
+  main(sys.argv)
@@ -0,0 +1,224 @@
+#! /bin/sh
+#
+# Measures what compiling google_speed.proto with a field profile (the
+# field_profile option of the C++ generator, see
+# ../src/google/protobuf/compiler/cpp/cpp_generator.cc) changes:  the
+# profile counts how often each field is set in google_message1.dat and
+# google_message2.dat, so that the fields neither sets become cold and move
+# out of the message objects.  For both builds it reports sizeof() and the
+# resident memory of many parsed SpeedMessage1s and SpeedMessage2s, the time
+# per parse, and the time per message to read a few of their hot fields.
+# If perf is installed, it also reports the cache misses of each run.
+#
+# Compiles google_speed.proto with ../src/protoc, once without and once with
+# the profile, and builds a program with each copy of the generated code.
+#
+# Usage:  ./field_profile.sh [MESSAGES]
+#
+# Environment:  PROTOC, CXX, CXXFLAGS and LIBPROTOBUF override the defaults
+# below.  Run it from this directory after building ../src.
+
+set -e
+
+MESSAGES=${1:-100000}
+
+PROTOC=${PROTOC:-../src/protoc}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+LIBPROTOBUF=${LIBPROTOBUF:-../src/.libs/libprotobuf.a}
+SRC_DIR=$(cd ../src && pwd)
+PROTOC=$(cd "$(dirname "$PROTOC")" && pwd)/$(basename "$PROTOC")
+
+WORK=$(mktemp -d ${TMPDIR:-/tmp}/field_profile.XXXXXX)
+trap 'rm -rf "$WORK"' EXIT
+
+mkdir "$WORK/plain" "$WORK/profiled"
+cp google_speed.proto "$WORK"
+
+# Counts every field set in the messages read, by full name.
+cat > "$WORK/make_profile.cc" << '__EOF__'
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <google/protobuf/descriptor.h>
+#include "google_speed.pb.h"
+
+using namespace google::protobuf;
+
+std::map<std::string, long long> counts;
+
+void Count(const Message& message) {
+  const Reflection* reflection = message.GetReflection();
+  std::vector<const FieldDescriptor*> fields;
+  reflection->ListFields(message, &fields);
+  for (int i = 0; i < fields.size(); i++) {
+    const FieldDescriptor* field = fields[i];
+    if (field->is_repeated()) {
+      int size = reflection->FieldSize(message, field);
+      counts[field->full_name()] += size;
+      if (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+        for (int j = 0; j < size; j++) {
+          Count(reflection->GetRepeatedMessage(message, field, j));
+        }
+      }
+    } else {
+      counts[field->full_name()]++;
+      if (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+        Count(reflection->GetMessage(message, field));
+      }
+    }
+  }
+}
+
+bool Read(const char* filename, Message* message) {
+  FILE* file = fopen(filename, "rb");
+  if (file == NULL) return false;
+  std::string data;
+  char buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.append(buffer, size);
+  }
+  fclose(file);
+  return message->ParseFromString(data);
+}
+
+int main(int argc, char* argv[]) {
+  benchmarks::SpeedMessage1 message1;
+  benchmarks::SpeedMessage2 message2;
+  if (!Read(argv[1], &message1) || !Read(argv[2], &message2)) return 1;
+  Count(message1);
+  Count(message2);
+  for (std::map<std::string, long long>::const_iterator it = counts.begin();
+       it != counts.end(); ++it) {
+    printf("%s %lld\n", it->first.c_str(), it->second);
+  }
+  return 0;
+}
+__EOF__
+
+cat > "$WORK/field_profile.cc" << '__EOF__'
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "google_speed.pb.h"
+
+using namespace google::protobuf;
+
+double NowSeconds() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + now.tv_usec / 1e6;
+}
+
+// Resident set size in bytes, from /proc (Linux only; 0 elsewhere).
+long ResidentBytes() {
+  FILE* file = fopen("/proc/self/statm", "r");
+  if (file == NULL) return 0;
+  long pages = 0, resident = 0;
+  if (fscanf(file, "%ld %ld", &pages, &resident) != 2) resident = 0;
+  fclose(file);
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+std::string Read(const char* filename) {
+  FILE* file = fopen(filename, "rb");
+  std::string data;
+  char buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.append(buffer, size);
+  }
+  fclose(file);
+  return data;
+}
+
+uint64 Access(const benchmarks::SpeedMessage1& message) {
+  return message.field2() + message.field3() + message.field12() +
+         message.field15().field1() + message.field1().size();
+}
+
+uint64 Access(const benchmarks::SpeedMessage2& message) {
+  uint64 sum = message.field3();
+  for (int i = 0; i < message.group1_size(); i++) {
+    sum += message.group1(i).field15() + message.group1(i).field5();
+  }
+  return sum;
+}
+
+template <typename Type>
+void Run(const char* name, const std::string& data, int count) {
+  std::vector<Type*> messages(count);
+  long resident = ResidentBytes();
+  double start = NowSeconds();
+  for (int i = 0; i < count; i++) {
+    messages[i] = new Type;
+    messages[i]->ParseFromString(data);
+  }
+  double parse = NowSeconds() - start;
+  resident = ResidentBytes() - resident;
+
+  const int kRounds = 10;
+  uint64 sum = 0;
+  start = NowSeconds();
+  for (int round = 0; round < kRounds; round++) {
+    for (int i = 0; i < count; i++) {
+      sum += Access(*messages[i]);
+    }
+  }
+  double access = NowSeconds() - start;
+
+  printf("  %-14s sizeof %4d  %7.0f resident bytes/message  "
+         "%8.1f ns/parse  %7.1f ns/access  (%llu)\n", name,
+         static_cast<int>(sizeof(Type)),
+         static_cast<double>(resident) / count, parse * 1e9 / count,
+         access * 1e9 / (count * kRounds), static_cast<unsigned long long>(sum));
+  for (int i = 0; i < count; i++) {
+    delete messages[i];
+  }
+}
+
+int main(int argc, char* argv[]) {
+  int count = atoi(argv[1]);
+  // google_message2.dat is far larger; parse fewer of it.
+  Run<benchmarks::SpeedMessage1>("SpeedMessage1", Read(argv[2]), count);
+  Run<benchmarks::SpeedMessage2>("SpeedMessage2", Read(argv[3]),
+                                 count / 100 + 1);
+  return 0;
+}
+__EOF__
+
+Build() {
+  $CXX $CXXFLAGS -w -I$SRC_DIR -I"$WORK/$1" -o "$WORK/$1/$2" \
+    "$WORK/$2.cc" "$WORK/$1/google_speed.pb.cc" "$LIBPROTOBUF" -lpthread
+}
+
+(cd "$WORK" && "$PROTOC" --cpp_out=plain google_speed.proto)
+Build plain make_profile
+"$WORK/plain/make_profile" google_message1.dat google_message2.dat \
+  > "$WORK/profile.txt"
+echo "$(wc -l < "$WORK/profile.txt") of" \
+     "$(grep -c '^ *\(optional\|required\|repeated\)' google_speed.proto)" \
+     "fields of google_speed.proto are set in the sample data."
+
+(cd "$WORK" && "$PROTOC" --cpp_out=field_profile=profile.txt:profiled \
+                 google_speed.proto)
+Build plain field_profile
+Build profiled field_profile
+
+if command -v perf > /dev/null 2>&1; then
+  PERF="perf stat -e cache-references,cache-misses"
+else
+  PERF=
+  echo "(perf not found; not counting cache misses.)"
+fi
+
+for BUILD in plain profiled; do
+  echo "$MESSAGES messages, $BUILD:"
+  $PERF "$WORK/$BUILD/field_profile" $MESSAGES \
+    google_message1.dat google_message2.dat
+done
@@ -0,0 +1,154 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Measures how fast DoubleToBuffer() and FloatToBuffer() format values, next
+// to the snprintf()/strtod() approach they used to take.  Three sets of
+// values are used:  "metrics" (doubles with a handful of significant digits,
+// like typical measurements), "random" (uniformly random bit patterns, which
+// mostly need 16-17 digits) and "small integers".
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/strutil.h>
+
+using google::protobuf::uint32;
+using google::protobuf::uint64;
+
+namespace {
+
+// What DoubleToBuffer() used to do.
+char* SnprintfDoubleToBuffer(double value, char* buffer) {
+  snprintf(buffer, google::protobuf::kDoubleToBufferSize, "%.*g",
+           DBL_DIG, value);
+  volatile double parsed_value = strtod(buffer, NULL);
+  if (parsed_value != value) {
+    snprintf(buffer, google::protobuf::kDoubleToBufferSize, "%.*g",
+             DBL_DIG + 2, value);
+  }
+  return buffer;
+}
+
+// What FloatToBuffer() used to do.
+char* SnprintfFloatToBuffer(float value, char* buffer) {
+  snprintf(buffer, google::protobuf::kFloatToBufferSize, "%.*g",
+           FLT_DIG, value);
+  float parsed_value = strtof(buffer, NULL);
+  if (parsed_value != value) {
+    snprintf(buffer, google::protobuf::kFloatToBufferSize, "%.*g",
+             FLT_DIG + 2, value);
+  }
+  return buffer;
+}
+
+double Now() {
+  return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+}
+
+// Formats every value `rounds` times and prints nanoseconds per value.
+template <typename Value>
+void Time(const char* name, const std::vector<Value>& values, int rounds,
+          char* (*format)(Value, char*)) {
+  char buffer[google::protobuf::kDoubleToBufferSize];
+  size_t total_length = 0;  // So the work can't be optimized away.
+  double start = Now();
+  for (int round = 0; round < rounds; round++) {
+    for (int i = 0; i < values.size(); i++) {
+      total_length += strlen(format(values[i], buffer));
+    }
+  }
+  double seconds = Now() - start;
+  printf("  %-28s %7.1f ns/value  (%.1f chars/value)\n", name,
+         seconds * 1e9 / (static_cast<double>(values.size()) * rounds),
+         static_cast<double>(total_length) / values.size() / rounds);
+}
+
+void TimeDoubles(const char* set_name, const std::vector<double>& values,
+                 int rounds) {
+  printf("%s (double):\n", set_name);
+  Time<double>("DoubleToBuffer", values, rounds,
+               &google::protobuf::DoubleToBuffer);
+  Time<double>("snprintf + strtod", values, rounds, &SnprintfDoubleToBuffer);
+}
+
+void TimeFloats(const char* set_name, const std::vector<float>& values,
+                int rounds) {
+  printf("%s (float):\n", set_name);
+  Time<float>("FloatToBuffer", values, rounds,
+              &google::protobuf::FloatToBuffer);
+  Time<float>("snprintf + strtof", values, rounds, &SnprintfFloatToBuffer);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : 100000;
+  int rounds = argc > 2 ? atoi(argv[2]) : 10;
+
+  std::vector<double> metrics, random_doubles, integers;
+  std::vector<float> float_metrics, random_floats;
+  uint64 state = 1;
+  for (int i = 0; i < count; i++) {
+    state = state * GOOGLE_ULONGLONG(6364136223846793005) +
+            GOOGLE_ULONGLONG(1442695040888963407);
+
+    // e.g. 1234.5, 0.0271, 98.125
+    double metric = static_cast<double>(state >> 44) / 1000 *
+                    (i % 3 == 0 ? 1 : i % 3 == 1 ? 0.01 : 100);
+    metrics.push_back(metric);
+    float_metrics.push_back(static_cast<float>(metric));
+
+    uint64 bits = state;
+    double random_double;
+    memcpy(&random_double, &bits, sizeof(random_double));
+    if (random_double != random_double) random_double = 0;  // NaN
+    random_doubles.push_back(random_double);
+
+    uint32 float_bits = static_cast<uint32>(state >> 32);
+    float random_float;
+    memcpy(&random_float, &float_bits, sizeof(random_float));
+    if (random_float != random_float) random_float = 0;  // NaN
+    random_floats.push_back(random_float);
+
+    integers.push_back(static_cast<double>(i % 10000));
+  }
+
+  TimeDoubles("metrics", metrics, rounds);
+  TimeDoubles("random", random_doubles, rounds);
+  TimeDoubles("small integers", integers, rounds);
+  TimeFloats("metrics", float_metrics, rounds);
+  TimeFloats("random", random_floats, rounds);
+  return 0;
+}
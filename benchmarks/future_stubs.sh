@@ -0,0 +1,186 @@
+#! /bin/sh
+#
+# Measures the overhead of a call made through a generated stub with a
+# "done" closure from NewCallback(), against one made through the RpcFuture
+# method the future_stubs option adds.
+#
+# Compiles an echo service with "../src/protoc --cpp_out=future_stubs=true"
+# and builds a program calling it through an RpcChannel which runs the
+# service right away on the calling thread, so what is measured is the stub,
+# the closure or future and the response.  It reports the time per call and
+# the heap allocations per call of each way.  If CXX supports C++20
+# coroutines, it also times co_await'ing the future from a coroutine.
+#
+# Usage:  ./future_stubs.sh [CALLS]
+#
+# Environment:  PROTOC, CXX, CXXFLAGS and LIBPROTOBUF override the defaults
+# below.  Run it from this directory after building ../src.
+
+set -e
+
+CALLS=${1:-5000000}
+
+PROTOC=${PROTOC:-../src/protoc}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+LIBPROTOBUF=${LIBPROTOBUF:-../src/.libs/libprotobuf.a}
+SRC_DIR=$(cd ../src && pwd)
+PROTOC=$(cd "$(dirname "$PROTOC")" && pwd)/$(basename "$PROTOC")
+
+WORK=$(mktemp -d ${TMPDIR:-/tmp}/future_stubs.XXXXXX)
+trap 'rm -rf "$WORK"' EXIT
+
+cat > "$WORK/echo.proto" << __EOF__
+package benchmarks;
+option cc_generic_services = true;
+message EchoMessage {
+  optional int64 id = 1;
+}
+service EchoService {
+  rpc Echo(EchoMessage) returns (EchoMessage);
+}
+__EOF__
+
+cat > "$WORK/future_stubs.cc" << '__EOF__'
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <new>
+#include <google/protobuf/local_rpc_channel.h>
+#include "echo.pb.h"
+
+using namespace google::protobuf;
+
+#if __cplusplus >= 201103L
+#define NOTHROW noexcept
+#else
+#define NOTHROW throw()
+#endif
+
+// Counts heap allocations.
+static long long allocations = 0;
+void* operator new(size_t size) {
+  ++allocations;
+  void* p = malloc(size);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) NOTHROW { free(p); }
+
+double NowSeconds() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + now.tv_usec / 1e6;
+}
+
+class EchoServiceImpl : public benchmarks::EchoService {
+ public:
+  void Echo(RpcController* controller,
+            const benchmarks::EchoMessage* request,
+            benchmarks::EchoMessage* response,
+            Closure* done) {
+    response->set_id(request->id());
+    done->Run();
+  }
+};
+
+// Runs each call on the calling thread.
+class InlineChannel : public RpcChannel {
+ public:
+  explicit InlineChannel(Service* service) : service_(service) {}
+  void CallMethod(const MethodDescriptor* method, RpcController* controller,
+                  const Message* request, Message* response, Closure* done) {
+    service_->CallMethod(method, controller, request, response, done);
+  }
+ private:
+  Service* service_;
+};
+
+int64 sum = 0;
+void Done(benchmarks::EchoMessage* response) { sum += response->id(); }
+
+void Report(const char* name, int calls, double seconds,
+            long long allocated) {
+  printf("  %-24s %8.1f ns/call %6.2f allocations/call\n", name,
+         seconds * 1e9 / calls, static_cast<double>(allocated) / calls);
+}
+
+#if defined(GOOGLE_PROTOBUF_RPC_FUTURE_AWAITABLE)
+#include <coroutine>
+
+// A coroutine which starts at once and is never resumed by anyone else.
+struct Task {
+  struct promise_type {
+    Task get_return_object() { return Task(); }
+    std::suspend_never initial_suspend() { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { abort(); }
+  };
+};
+
+Task AwaitCalls(benchmarks::EchoService::Stub* stub,
+                RpcController* controller,
+                benchmarks::EchoMessage* request,
+                RpcFuture<benchmarks::EchoMessage>* future, int calls) {
+  for (int i = 0; i < calls; i++) {
+    request->set_id(i);
+    benchmarks::EchoMessage* response =
+        co_await stub->Echo(controller, request, future);
+    sum += response->id();
+  }
+}
+#endif
+
+int main(int argc, char* argv[]) {
+  int calls = atoi(argv[1]);
+  EchoServiceImpl service;
+  InlineChannel channel(&service);
+  benchmarks::EchoService::Stub stub(&channel);
+  LocalRpcController controller;
+  benchmarks::EchoMessage request;
+  benchmarks::EchoMessage response;
+  RpcFuture<benchmarks::EchoMessage> future;
+
+  printf("%d calls:\n", calls);
+
+  long long before = allocations;
+  double start = NowSeconds();
+  for (int i = 0; i < calls; i++) {
+    request.set_id(i);
+    stub.Echo(&controller, &request, &response,
+              NewCallback(&Done, &response));
+  }
+  Report("NewCallback()", calls, NowSeconds() - start, allocations - before);
+
+  before = allocations;
+  start = NowSeconds();
+  for (int i = 0; i < calls; i++) {
+    request.set_id(i);
+    stub.Echo(&controller, &request, &future).Wait();
+    sum += future.response().id();
+  }
+  Report("RpcFuture, Wait()", calls, NowSeconds() - start,
+         allocations - before);
+
+#if defined(GOOGLE_PROTOBUF_RPC_FUTURE_AWAITABLE)
+  before = allocations;
+  start = NowSeconds();
+  AwaitCalls(&stub, &controller, &request, &future, calls);
+  Report("RpcFuture, co_await", calls, NowSeconds() - start,
+         allocations - before);
+#endif
+
+  return 0;
+}
+__EOF__
+
+(cd "$WORK" && "$PROTOC" --cpp_out=future_stubs=true:. echo.proto)
+
+if echo 'int main() { return 0; }' | \
+   $CXX -std=c++20 -x c++ -o /dev/null - 2>/dev/null; then
+  STD=-std=c++20
+fi
+$CXX $CXXFLAGS $STD -w -I$SRC_DIR -I"$WORK" -o "$WORK/future_stubs" \
+  "$WORK/future_stubs.cc" "$WORK/echo.pb.cc" "$LIBPROTOBUF" -lpthread
+"$WORK/future_stubs" $CALLS
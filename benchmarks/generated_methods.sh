@@ -0,0 +1,156 @@
+#! /bin/sh
+#
+# Measures the generated Clear(), MergeFrom(), CopyFrom(), ByteSize() and
+# SerializeWithCachedSizes() of SpeedMessage1, which has enough fields for
+# them to visit only the fields which are set with the has_bit_iteration
+# generator option (see kMinFieldsForHasBitIteration in
+# ../src/google/protobuf/compiler/cpp/cpp_message.cc), and Clear() followed
+# by parsing again:  the time per call with google_message1.dat, and with a
+# sparse message of which only three fields are set.  Run it with and without
+# GENERATOR_OPTIONS=has_bit_iteration=true, or with the protoc of two builds,
+# to compare their generated code.
+#
+# Compiles google_speed.proto with ../src/protoc and builds a program with
+# the generated code.
+#
+# Usage:  ./generated_methods.sh [ROUNDS]
+#
+# Environment:  PROTOC, GENERATOR_OPTIONS (passed to --cpp_out), CXX,
+# CXXFLAGS and LIBPROTOBUF override the defaults below.  Run it from this
+# directory after building ../src.
+
+set -e
+
+ROUNDS=${1:-1000000}
+
+PROTOC=${PROTOC:-../src/protoc}
+GENERATOR_OPTIONS=${GENERATOR_OPTIONS:-}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+LIBPROTOBUF=${LIBPROTOBUF:-../src/.libs/libprotobuf.a}
+SRC_DIR=$(cd ../src && pwd)
+PROTOC=$(cd "$(dirname "$PROTOC")" && pwd)/$(basename "$PROTOC")
+
+WORK=$(mktemp -d ${TMPDIR:-/tmp}/generated_methods.XXXXXX)
+trap 'rm -rf "$WORK"' EXIT
+
+cp google_speed.proto "$WORK"
+
+cat > "$WORK/generated_methods.cc" << '__EOF__'
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <string>
+#include <vector>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include "google_speed.pb.h"
+
+using namespace google::protobuf;
+
+double NowSeconds() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + now.tv_usec / 1e6;
+}
+
+void Time(const char* name, const benchmarks::SpeedMessage1& message,
+          int rounds) {
+  benchmarks::SpeedMessage1 copy;
+  double start = NowSeconds();
+  for (int i = 0; i < rounds; i++) {
+    copy.Clear();
+    copy.MergeFrom(message);
+  }
+  double merge = NowSeconds() - start;
+
+  // Clear() of a message which is already clear costs little; time it on
+  // copies set up by MergeFrom() and subtract the MergeFrom() time.
+  start = NowSeconds();
+  for (int i = 0; i < rounds; i++) {
+    copy.MergeFrom(message);
+    copy.Clear();
+    copy.MergeFrom(message);
+    copy.Clear();
+  }
+  double clear = (NowSeconds() - start) / 2 - merge / 2;
+
+  start = NowSeconds();
+  for (int i = 0; i < rounds; i++) {
+    copy.CopyFrom(message);
+  }
+  double copy_from = NowSeconds() - start;
+
+  // The message reuse loop of a server:  Clear() and parse again.
+  std::string serialized = message.SerializeAsString();
+  start = NowSeconds();
+  for (int i = 0; i < rounds; i++) {
+    copy.Clear();
+    copy.ParseFromString(serialized);
+  }
+  double reparse = NowSeconds() - start;
+
+  int total = 0;
+  start = NowSeconds();
+  for (int i = 0; i < rounds; i++) {
+    total += message.ByteSize();
+  }
+  double byte_size = NowSeconds() - start;
+
+  std::string data;
+  data.reserve(message.ByteSize() * 2);
+  start = NowSeconds();
+  for (int i = 0; i < rounds; i++) {
+    data.clear();
+    io::StringOutputStream output(&data);
+    io::CodedOutputStream coded_output(&output);
+    message.SerializeWithCachedSizes(&coded_output);
+  }
+  double serialize = NowSeconds() - start;
+
+  printf("  %-8s %4d bytes %7.1f ns/Clear %7.1f ns/Clear+MergeFrom "
+         "%7.1f ns/CopyFrom %7.1f ns/Clear+ParseFromString\n"
+         "  %-8s %10s %7.1f ns/ByteSize %7.1f ns/SerializeWithCachedSizes\n",
+         name, total / rounds, clear * 1e9 / rounds, merge * 1e9 / rounds,
+         copy_from * 1e9 / rounds, reparse * 1e9 / rounds, "", "",
+         byte_size * 1e9 / rounds, serialize * 1e9 / rounds);
+}
+
+int main(int argc, char* argv[]) {
+  int rounds = atoi(argv[1]);
+  FILE* file = fopen(argv[2], "rb");
+  std::string data;
+  char buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.append(buffer, size);
+  }
+  fclose(file);
+
+  benchmarks::SpeedMessage1 full;
+  full.ParseFromString(data);
+  benchmarks::SpeedMessage1 sparse;
+  sparse.set_field1(full.field1());
+  sparse.set_field2(full.field2());
+  sparse.set_field3(full.field3());
+
+  std::vector<const FieldDescriptor*> fields;
+  full.GetReflection()->ListFields(full, &fields);
+  printf("%d rounds, SpeedMessage1 with %d of its %d fields set, "
+         "and with 3:\n", rounds, static_cast<int>(fields.size()),
+         full.GetDescriptor()->field_count());
+  Time("full", full, rounds);
+  Time("sparse", sparse, rounds);
+  return 0;
+}
+__EOF__
+
+CPP_OUT=.
+if [ -n "$GENERATOR_OPTIONS" ]; then CPP_OUT="$GENERATOR_OPTIONS:."; fi
+(cd "$WORK" && "$PROTOC" --cpp_out="$CPP_OUT" google_speed.proto)
+
+$CXX $CXXFLAGS -w -I$SRC_DIR -I"$WORK" -o "$WORK/generated_methods" \
+  "$WORK/generated_methods.cc" "$WORK/google_speed.pb.cc" \
+  "$LIBPROTOBUF" -lpthread
+"$WORK/generated_methods" $ROUNDS google_message1.dat
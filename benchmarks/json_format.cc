@@ -0,0 +1,211 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Compares JsonFormat with TextFormat:  the time and heap allocations it
+// takes to print a message with a reused Printer and output string, and to
+// parse that output back into a reused message.  The message type comes
+// from a .proto file (parsed at run time, so the message is a
+// DynamicMessage) and its contents from a binary file, e.g.:
+//
+//   ./json_format google_speed.proto benchmarks.SpeedMessage1 \
+//       google_message1.dat
+//
+// Allocations are counted by replacing the global operator new.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <new>
+#include <string>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/json_format.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/compiler/parser.h>
+#include <google/protobuf/io/tokenizer.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+
+namespace {
+
+size_t allocations = 0;
+
+}  // namespace
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+  ++allocations;
+  void* block = malloc(size);
+  if (block == NULL) throw std::bad_alloc();
+  return block;
+}
+
+void operator delete(void* ptr) throw() {
+  free(ptr);
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc) {
+  return operator new(size);
+}
+
+void operator delete[](void* ptr) throw() {
+  operator delete(ptr);
+}
+
+namespace google {
+namespace protobuf {
+namespace {
+
+double Now() {
+  return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+}
+
+std::string ReadFile(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) {
+    fprintf(stderr, "%s: cannot open\n", path);
+    exit(1);
+  }
+  std::string contents;
+  char buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    contents.append(buffer, size);
+  }
+  fclose(file);
+  return contents;
+}
+
+void Report(const char* name, int rounds, size_t bytes, double seconds,
+            size_t allocation_count) {
+  printf("%-24s %9.2f us/message %7.1f MB/s %9.1f allocations/message\n",
+         name, seconds * 1e6 / rounds, bytes / seconds / 1e6,
+         static_cast<double>(allocation_count) / rounds);
+}
+
+// Times printing the message with printer and parsing the result back with
+// parser.  Printer and Parser may be TextFormat's or JsonFormat's.
+template <typename Printer, typename Parser>
+void Time(const char* format_name, const Message& message, int rounds,
+          const Printer& printer, Parser* parser) {
+  std::string output;
+  printer.PrintToString(message, &output);  // Warm up.
+  Message* parsed = message.New();
+  if (!parser->ParseFromString(output, parsed)) {
+    fprintf(stderr, "%s: output did not parse\n", format_name);
+    exit(1);
+  }
+
+  std::string name;
+  size_t bytes = 0;
+  size_t allocations_before = allocations;
+  double start = Now();
+  for (int i = 0; i < rounds; i++) {
+    printer.PrintToString(message, &output);
+    bytes += output.size();
+  }
+  name = std::string(format_name) + " print";
+  Report(name.c_str(), rounds, bytes, Now() - start,
+         allocations - allocations_before);
+
+  bytes = 0;
+  allocations_before = allocations;
+  start = Now();
+  for (int i = 0; i < rounds; i++) {
+    parser->ParseFromString(output, parsed);
+    bytes += output.size();
+  }
+  name = std::string(format_name) + " parse";
+  Report(name.c_str(), rounds, bytes, Now() - start,
+         allocations - allocations_before);
+
+  delete parsed;
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
+
+int main(int argc, char* argv[]) {
+  using namespace google::protobuf;
+
+  if (argc < 4) {
+    fprintf(stderr, "Usage: %s PROTO_FILE MESSAGE_TYPE DATA_FILE [ROUNDS]\n",
+            argv[0]);
+    return 1;
+  }
+  int rounds = argc > 4 ? atoi(argv[4]) : 20000;
+
+  FileDescriptorProto file_proto;
+  {
+    std::string contents = ReadFile(argv[1]);
+    io::ArrayInputStream input(contents.data(), contents.size());
+    io::Tokenizer tokenizer(&input, NULL);
+    compiler::Parser parser;
+    if (!parser.Parse(&tokenizer, &file_proto)) {
+      fprintf(stderr, "%s: parse failed\n", argv[1]);
+      return 1;
+    }
+  }
+  file_proto.set_name(argv[1]);
+  DescriptorPool pool;
+  if (pool.BuildFile(file_proto) == NULL) {
+    fprintf(stderr, "%s: build failed\n", argv[1]);
+    return 1;
+  }
+  const Descriptor* type = pool.FindMessageTypeByName(argv[2]);
+  if (type == NULL) {
+    fprintf(stderr, "%s: no such message type\n", argv[2]);
+    return 1;
+  }
+  DynamicMessageFactory factory(&pool);
+  Message* message = factory.GetPrototype(type)->New();
+  if (!message->ParseFromString(ReadFile(argv[3]))) {
+    fprintf(stderr, "%s: parse failed\n", argv[3]);
+    return 1;
+  }
+
+  {
+    TextFormat::Printer printer;
+    printer.SetSingleLineMode(true);
+    TextFormat::Parser parser;
+    Time("TextFormat", *message, rounds, printer, &parser);
+  }
+  {
+    JsonFormat::Printer printer;
+    JsonFormat::Parser parser;
+    Time("JsonFormat", *message, rounds, printer, &parser);
+  }
+
+  delete message;
+  return 0;
+}
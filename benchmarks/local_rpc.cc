@@ -0,0 +1,242 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Measures how many calls a second go through a LocalRpcChannel, and their
+// latency, with 1 to 64 worker threads.  The service echoes its request
+// back, so what is measured is the channel:  queueing, handing the call to
+// a worker and running the "done" callback.  One thread makes the calls,
+// keeping up to WINDOW (256 by default) of them outstanding, and the
+// latency of a call is from CallMethod() to its "done" callback, e.g.:
+//
+//   ./local_rpc 200000 256
+//
+// Latency includes the time a call waits behind the others of the window,
+// so the smaller the window, the closer it is to the cost of one call.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/local_rpc_channel.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/compiler/parser.h>
+#include <google/protobuf/io/tokenizer.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+const char kEchoProto[] =
+    "package benchmarks;\n"
+    "message EchoMessage {\n"
+    "  optional int64 id = 1;\n"
+    "  optional bytes payload = 2;\n"
+    "}\n"
+    "service EchoService {\n"
+    "  rpc Echo(EchoMessage) returns (EchoMessage);\n"
+    "}\n";
+
+int64 NowUs() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return static_cast<int64>(now.tv_sec) * 1000000 + now.tv_usec;
+}
+
+// Copies the request into the response.
+class EchoService : public Service {
+ public:
+  EchoService(const ServiceDescriptor* descriptor, MessageFactory* factory)
+    : descriptor_(descriptor), factory_(factory) {}
+
+  const ServiceDescriptor* GetDescriptor() { return descriptor_; }
+
+  void CallMethod(const MethodDescriptor* method, RpcController* controller,
+                  const Message* request, Message* response, Closure* done) {
+    response->CopyFrom(*request);
+    done->Run();
+  }
+
+  const Message& GetRequestPrototype(const MethodDescriptor* method) const {
+    return *factory_->GetPrototype(method->input_type());
+  }
+  const Message& GetResponsePrototype(const MethodDescriptor* method) const {
+    return *factory_->GetPrototype(method->output_type());
+  }
+
+ private:
+  const ServiceDescriptor* descriptor_;
+  MessageFactory* factory_;
+};
+
+// One outstanding call of the window.
+struct Slot {
+  LocalRpcController controller;
+  Message* request;
+  Message* response;
+  int64 start;
+  Closure* done;
+};
+
+// Keeps WINDOW calls going until all have been made, collecting latencies.
+class Client {
+ public:
+  Client(const MethodDescriptor* method, const Message& prototype,
+         int window)
+    : method_(method) {
+    pthread_mutex_init(&mutex_, NULL);
+    pthread_cond_init(&slot_freed_, NULL);
+    for (int i = 0; i < window; i++) {
+      Slot* slot = new Slot;
+      slot->request = prototype.New();
+      slot->response = prototype.New();
+      slot->request->GetReflection()->SetString(
+          slot->request, method->input_type()->FindFieldByName("payload"),
+          std::string(64, 'x'));
+      slot->done = NewPermanentCallback(this, &Client::Finished, slot);
+      slots_.push_back(slot);
+    }
+  }
+
+  ~Client() {
+    for (int i = 0; i < slots_.size(); i++) {
+      delete slots_[i]->request;
+      delete slots_[i]->response;
+      delete slots_[i]->done;
+      delete slots_[i];
+    }
+    pthread_cond_destroy(&slot_freed_);
+    pthread_mutex_destroy(&mutex_);
+  }
+
+  // Makes calls calls through channel, returning the seconds it took.
+  double Run(RpcChannel* channel, int calls) {
+    free_slots_ = slots_;
+    latencies_.clear();
+    latencies_.reserve(calls);
+    int64 start = NowUs();
+    for (int i = 0; i < calls; i++) {
+      pthread_mutex_lock(&mutex_);
+      while (free_slots_.empty()) pthread_cond_wait(&slot_freed_, &mutex_);
+      Slot* slot = free_slots_.back();
+      free_slots_.pop_back();
+      pthread_mutex_unlock(&mutex_);
+
+      slot->controller.Reset();
+      slot->start = NowUs();
+      channel->CallMethod(method_, &slot->controller, slot->request,
+                          slot->response, slot->done);
+    }
+    pthread_mutex_lock(&mutex_);
+    while (free_slots_.size() < slots_.size()) {
+      pthread_cond_wait(&slot_freed_, &mutex_);
+    }
+    pthread_mutex_unlock(&mutex_);
+    return (NowUs() - start) / 1e6;
+  }
+
+  // Returns the given percentile of the latencies of the last Run(), in
+  // microseconds.
+  int64 Percentile(double percent) {
+    std::vector<int64>::iterator nth =
+        latencies_.begin() + (latencies_.size() - 1) * percent / 100;
+    std::nth_element(latencies_.begin(), nth, latencies_.end());
+    return *nth;
+  }
+
+ private:
+  void Finished(Slot* slot) {
+    int64 latency = NowUs() - slot->start;
+    if (slot->controller.Failed()) {
+      fprintf(stderr, "Call failed: %s\n",
+              slot->controller.ErrorText().c_str());
+      exit(1);
+    }
+    pthread_mutex_lock(&mutex_);
+    latencies_.push_back(latency);
+    free_slots_.push_back(slot);
+    pthread_cond_signal(&slot_freed_);
+    pthread_mutex_unlock(&mutex_);
+  }
+
+  const MethodDescriptor* method_;
+  std::vector<Slot*> slots_;
+
+  pthread_mutex_t mutex_;
+  pthread_cond_t slot_freed_;
+  std::vector<Slot*> free_slots_;
+  std::vector<int64> latencies_;
+};
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
+
+int main(int argc, char* argv[]) {
+  using namespace google::protobuf;
+
+  int calls = argc > 1 ? atoi(argv[1]) : 200000;
+  int window = argc > 2 ? atoi(argv[2]) : 256;
+
+  FileDescriptorProto file_proto;
+  io::ArrayInputStream input(kEchoProto, sizeof(kEchoProto) - 1);
+  io::Tokenizer tokenizer(&input, NULL);
+  compiler::Parser parser;
+  if (!parser.Parse(&tokenizer, &file_proto)) {
+    fprintf(stderr, "Can't parse the service definition.\n");
+    return 1;
+  }
+  file_proto.set_name("echo.proto");
+  DescriptorPool pool;
+  const FileDescriptor* file = pool.BuildFile(file_proto);
+  const MethodDescriptor* method = file->service(0)->method(0);
+  DynamicMessageFactory factory;
+  EchoService service(file->service(0), &factory);
+  Client client(method, *factory.GetPrototype(method->input_type()), window);
+
+  printf("%d calls, up to %d outstanding:\n", calls, window);
+  printf("%8s %12s %10s %10s\n", "threads", "calls/s", "p50 us", "p99 us");
+  for (int threads = 1; threads <= 64; threads *= 2) {
+    LocalRpcChannel channel(threads);
+    channel.RegisterService(&service);
+    double seconds = client.Run(&channel, calls);
+    long long p50 = client.Percentile(50);
+    long long p99 = client.Percentile(99);
+    printf("%8d %12.0f %10lld %10lld\n", threads, calls / seconds, p50, p99);
+  }
+  return 0;
+}
@@ -0,0 +1,125 @@
+#! /bin/sh
+#
+# Measures what the message stats (../src/google/protobuf/message_stats.h)
+# cost:  the time per ParseFromString() and SerializeToString() of
+# google_message1.dat as a SpeedMessage1, and of a message with one int32
+# field, where the counting is the largest part of the work.  Run it against
+# a library built with "./configure --enable-message-stats" and against one
+# built without to compare; with the counting compiled in, it also prints
+# what GetMessageStats() returned, and how long that took.
+#
+# Compiles google_speed.proto with ../src/protoc and builds a program with
+# the generated code.
+#
+# Usage:  ./message_stats.sh [ROUNDS]
+#
+# Environment:  PROTOC, CXX, CXXFLAGS and LIBPROTOBUF override the defaults
+# below.  Run it from this directory after building ../src.
+
+set -e
+
+ROUNDS=${1:-1000000}
+
+PROTOC=${PROTOC:-../src/protoc}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+LIBPROTOBUF=${LIBPROTOBUF:-../src/.libs/libprotobuf.a}
+SRC_DIR=$(cd ../src && pwd)
+PROTOC=$(cd "$(dirname "$PROTOC")" && pwd)/$(basename "$PROTOC")
+
+WORK=$(mktemp -d ${TMPDIR:-/tmp}/message_stats.XXXXXX)
+trap 'rm -rf "$WORK"' EXIT
+
+cp google_speed.proto "$WORK"
+cat > "$WORK/small.proto" << __EOF__
+package benchmarks;
+message SmallMessage {
+  optional int32 value = 1;
+}
+__EOF__
+
+cat > "$WORK/message_stats.cc" << '__EOF__'
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <string>
+#include <vector>
+#include <google/protobuf/message_stats.h>
+#include "google_speed.pb.h"
+#include "small.pb.h"
+
+using namespace google::protobuf;
+
+double NowSeconds() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + now.tv_usec / 1e6;
+}
+
+void Time(const char* name, Message* message, const std::string& data,
+          int rounds) {
+  double start = NowSeconds();
+  for (int i = 0; i < rounds; i++) {
+    message->ParseFromString(data);
+  }
+  double parse = NowSeconds() - start;
+
+  std::string output;
+  start = NowSeconds();
+  for (int i = 0; i < rounds; i++) {
+    message->SerializeToString(&output);
+  }
+  double serialize = NowSeconds() - start;
+
+  printf("  %-14s %5d bytes %8.1f ns/parse %8.1f ns/serialize\n", name,
+         static_cast<int>(data.size()), parse * 1e9 / rounds,
+         serialize * 1e9 / rounds);
+}
+
+int main(int argc, char* argv[]) {
+  int rounds = atoi(argv[1]);
+  FILE* file = fopen(argv[2], "rb");
+  std::string data;
+  char buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.append(buffer, size);
+  }
+  fclose(file);
+
+  printf("%d rounds, message stats %s:\n", rounds,
+         MessageStatsEnabled() ? "compiled in" : "compiled out");
+  benchmarks::SpeedMessage1 speed;
+  Time("SpeedMessage1", &speed, data, rounds);
+  benchmarks::SmallMessage small;
+  small.set_value(150);
+  Time("SmallMessage", &small, small.SerializeAsString(), rounds);
+
+  if (MessageStatsEnabled()) {
+    std::vector<MessageStats> stats;
+    double start = NowSeconds();
+    GetMessageStats(&stats);
+    printf("GetMessageStats() took %.1f us:\n",
+           (NowSeconds() - start) * 1e6);
+    for (int i = 0; i < stats.size(); i++) {
+      printf("  %-24s %9lld parsed %11lld bytes %12lld cycles\n"
+             "  %-24s %9lld serialized %7lld bytes %12lld cycles\n",
+             stats[i].type_name.c_str(),
+             static_cast<long long>(stats[i].parses),
+             static_cast<long long>(stats[i].parse_bytes),
+             static_cast<long long>(stats[i].parse_cycles), "",
+             static_cast<long long>(stats[i].serializes),
+             static_cast<long long>(stats[i].serialize_bytes),
+             static_cast<long long>(stats[i].serialize_cycles));
+    }
+  }
+  return 0;
+}
+__EOF__
+
+(cd "$WORK" && "$PROTOC" --cpp_out=. google_speed.proto small.proto)
+
+$CXX $CXXFLAGS -w -I$SRC_DIR -I"$WORK" -o "$WORK/message_stats" \
+  "$WORK/message_stats.cc" "$WORK/google_speed.pb.cc" "$WORK/small.pb.cc" \
+  "$LIBPROTOBUF" -lpthread
+"$WORK/message_stats" $ROUNDS google_message1.dat
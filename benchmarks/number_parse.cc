@@ -0,0 +1,182 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Measures number conversion while parsing text:  ParseDecimalDouble()
+// next to NoLocaleStrtod() on the same strings, and TextFormat::Parser on a
+// message made up of repeated double, int64 and float fields.  Values are
+// "metrics" (a handful of significant digits) and "random" (uniformly
+// random bit patterns printed with 17 digits).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/strutil.h>
+
+using google::protobuf::uint64;
+
+namespace {
+
+double Now() {
+  return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+}
+
+void TimeConversions(const char* set_name,
+                     const std::vector<std::string>& texts, int rounds) {
+  printf("%s:\n", set_name);
+
+  double sum = 0;  // So the work can't be optimized away.
+  double start = Now();
+  for (int round = 0; round < rounds; round++) {
+    for (int i = 0; i < texts.size(); i++) {
+      double value;
+      google::protobuf::ParseDecimalDouble(
+          texts[i].data(), texts[i].data() + texts[i].size(), &value);
+      sum += value;
+    }
+  }
+  double seconds = Now() - start;
+  printf("  %-28s %7.1f ns/value\n", "ParseDecimalDouble",
+         seconds * 1e9 / (static_cast<double>(texts.size()) * rounds));
+
+  start = Now();
+  for (int round = 0; round < rounds; round++) {
+    for (int i = 0; i < texts.size(); i++) {
+      sum += google::protobuf::NoLocaleStrtod(texts[i].c_str(), NULL);
+    }
+  }
+  seconds = Now() - start;
+  printf("  %-28s %7.1f ns/value\n", "NoLocaleStrtod",
+         seconds * 1e9 / (static_cast<double>(texts.size()) * rounds));
+  if (sum == 1) printf("\n");
+}
+
+void TimeTextFormat(const char* set_name, const std::string& text,
+                    int values, int rounds,
+                    const google::protobuf::Message& prototype) {
+  google::protobuf::Message* message = prototype.New();
+  double start = Now();
+  for (int round = 0; round < rounds; round++) {
+    if (!google::protobuf::TextFormat::ParseFromString(text, message)) {
+      fprintf(stderr, "Parse failed.\n");
+      exit(1);
+    }
+  }
+  double seconds = Now() - start;
+  printf("TextFormat::ParseFromString, %s:  %.1f ns/value, %.1f MB/s\n",
+         set_name, seconds * 1e9 / (static_cast<double>(values) * rounds),
+         static_cast<double>(text.size()) * rounds / seconds / 1e6);
+  delete message;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : 100000;
+  int rounds = argc > 2 ? atoi(argv[2]) : 10;
+
+  std::vector<std::string> metrics, random_doubles;
+  std::string metrics_text, random_text;
+  uint64 state = 1;
+  char buffer[64];
+  for (int i = 0; i < count; i++) {
+    state = state * GOOGLE_ULONGLONG(6364136223846793005) +
+            GOOGLE_ULONGLONG(1442695040888963407);
+
+    // e.g. 1234.5, 0.0271, 98.125
+    double metric = static_cast<double>(state >> 44) / 1000 *
+                    (i % 3 == 0 ? 1 : i % 3 == 1 ? 0.01 : 100);
+    metrics.push_back(google::protobuf::SimpleDtoa(metric));
+    metrics_text += "d: " + metrics.back() + "\n";
+    metrics_text += "i: " + google::protobuf::SimpleItoa(
+        static_cast<long long>(state >> 44)) + "\n";
+    metrics_text += "f: " + google::protobuf::SimpleFtoa(
+        static_cast<float>(metric)) + "\n";
+
+    double random_double;
+    memcpy(&random_double, &state, sizeof(random_double));
+    if (random_double != random_double) random_double = 0;  // NaN
+    if (random_double < 0) random_double = -random_double;
+    snprintf(buffer, sizeof(buffer), "%.17g", random_double);
+    if (strchr(buffer, 'i') != NULL) strcpy(buffer, "0");  // inf
+    random_doubles.push_back(buffer);
+    random_text += "d: " + random_doubles.back() + "\n";
+    random_text += "i: " + google::protobuf::SimpleItoa(
+        static_cast<long long>(state >> 1)) + "\n";
+    random_text += "f: " + google::protobuf::SimpleFtoa(
+        static_cast<float>(random_double / 1e300)) + "\n";
+  }
+
+  TimeConversions("metrics", metrics, rounds);
+  TimeConversions("random", random_doubles, rounds);
+
+  // message Numbers {
+  //   repeated double d = 1;
+  //   repeated int64 i = 2;
+  //   repeated float f = 3;
+  // }
+  google::protobuf::FileDescriptorProto file;
+  file.set_name("number_parse.proto");
+  google::protobuf::DescriptorProto* type = file.add_message_type();
+  type->set_name("Numbers");
+  const char* const kNames[] = { "d", "i", "f" };
+  const google::protobuf::FieldDescriptorProto::Type kTypes[] = {
+    google::protobuf::FieldDescriptorProto::TYPE_DOUBLE,
+    google::protobuf::FieldDescriptorProto::TYPE_INT64,
+    google::protobuf::FieldDescriptorProto::TYPE_FLOAT,
+  };
+  for (int i = 0; i < 3; i++) {
+    google::protobuf::FieldDescriptorProto* field = type->add_field();
+    field->set_name(kNames[i]);
+    field->set_number(i + 1);
+    field->set_label(google::protobuf::FieldDescriptorProto::LABEL_REPEATED);
+    field->set_type(kTypes[i]);
+  }
+  google::protobuf::DescriptorPool pool;
+  const google::protobuf::FileDescriptor* file_descriptor =
+      pool.BuildFile(file);
+  google::protobuf::DynamicMessageFactory factory(&pool);
+  const google::protobuf::Message* prototype =
+      factory.GetPrototype(file_descriptor->message_type(0));
+
+  TimeTextFormat("metrics", metrics_text, count * 3, rounds, *prototype);
+  TimeTextFormat("random", random_text, count * 3, rounds, *prototype);
+  return 0;
+}
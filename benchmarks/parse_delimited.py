@@ -0,0 +1,104 @@
+#! /usr/bin/python
+#
+# Protocol Buffers - Google's data interchange format
+# Copyright 2008 Google Inc.  All rights reserved.
+# http://code.google.com/p/protobuf/
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+#
+#     * Redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above
+# copyright notice, this list of conditions and the following disclaimer
+# in the documentation and/or other materials provided with the
+# distribution.
+#     * Neither the name of Google Inc. nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+"""Measures parsing a stream of delimited messages of google_speed.proto.
+
+Writes a stream of copies of the SpeedMessage1 in google_message1.dat, each
+preceded by its size as a varint, and reports how many messages a second
+are parsed from it by a loop in Python reading each size and calling
+FromString() on the bytes after it.  With the C++ implementation, it also
+reports how many are parsed by one call to ParseDelimited(), from the
+string and from a file descriptor, and on several threads.
+"""
+
+import os
+import sys
+import tempfile
+import time
+
+from google.protobuf.internal import api_implementation
+from google.protobuf.internal import decoder
+from google.protobuf.internal import encoder
+import google_speed_pb2
+
+
+def main(argv):
+  count = 100000
+  num_threads = 4
+  if len(argv) > 1:
+    count = int(argv[1])
+  if len(argv) > 2:
+    num_threads = int(argv[2])
+
+  record = open('google_message1.dat', 'rb').read()
+  stream = (encoder._VarintBytes(len(record)) + record) * count
+  message_class = google_speed_pb2.SpeedMessage1
+
+  def Time(name, function):
+    start = time.time()
+    messages = function()
+    seconds = time.time() - start
+    assert len(messages) == count
+    print '  %-26s %10.0f messages/s' % (name, count / seconds)
+
+  def LoopOverRecords():
+    messages = []
+    position = 0
+    while position < len(stream):
+      size, position = decoder._DecodeVarint32(stream, position)
+      messages.append(
+          message_class.FromString(stream[position:position + size]))
+      position += size
+    return messages
+
+  def ParseFromFile():
+    stream_file = tempfile.TemporaryFile()
+    stream_file.write(stream)
+    stream_file.seek(0)
+    try:
+      return message_class.ParseDelimited(stream_file.fileno())
+    finally:
+      stream_file.close()
+
+  print '%s implementation, %d messages of %d bytes:' % (
+      api_implementation.Type(), count, len(record))
+  Time('loop over records', LoopOverRecords)
+  if api_implementation.Type() == 'cpp':
+    Time('ParseDelimited()', lambda: message_class.ParseDelimited(stream))
+    Time('ParseDelimited(fd)', ParseFromFile)
+    Time('ParseDelimited(%d threads)' % num_threads,
+         lambda: message_class.ParseDelimited(stream, num_threads))
+
+
+if __name__ == '__main__':
+  main(sys.argv)
@@ -0,0 +1,73 @@
+#! /bin/sh
+#
+# Measures how long one protoc invocation takes when its code generator is
+# a plugin, with and without a plugin server keeping the plugin running.
+#
+# Builds a plugin which wraps the C++ code generator and sleeps STARTUP_MS
+# milliseconds when it starts (standing in for a JVM or interpreter), then
+# reports the average wall time of RUNS invocations of ../src/protoc on
+# google_speed.proto:  with --cpp_out, with the plugin run directly, and
+# with the plugin run through "protoc --serve_plugins".
+#
+# Usage:  ./plugin_latency.sh [RUNS] [STARTUP_MS]
+#
+# Environment:  PROTOC, CXX, CXXFLAGS, LIBPROTOBUF and LIBPROTOC override the
+# defaults below.  Run it from this directory after building ../src.
+
+set -e
+
+RUNS=${1:-50}
+STARTUP_MS=${2:-100}
+
+PROTOC=${PROTOC:-../src/protoc}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+LIBPROTOBUF=${LIBPROTOBUF:-../src/.libs/libprotobuf.a}
+LIBPROTOC=${LIBPROTOC:-../src/.libs/libprotoc.a}
+SRC_DIR=$(cd ../src && pwd)
+
+WORK=$(mktemp -d ${TMPDIR:-/tmp}/plugin_latency.XXXXXX)
+SERVER_PID=
+trap '[ -n "$SERVER_PID" ] && kill $SERVER_PID; rm -rf "$WORK"' EXIT
+
+cat > "$WORK/plugin.cc" << __EOF__
+#include <unistd.h>
+#include <google/protobuf/compiler/plugin.h>
+#include <google/protobuf/compiler/cpp/cpp_generator.h>
+
+int main(int argc, char* argv[]) {
+  usleep($STARTUP_MS * 1000);
+  google::protobuf::compiler::cpp::CppGenerator generator;
+  return google::protobuf::compiler::PluginMain(argc, argv, &generator);
+}
+__EOF__
+
+echo "Building the plugin in $WORK"
+$CXX $CXXFLAGS -I$SRC_DIR -o "$WORK/protoc-gen-bench" "$WORK/plugin.cc" \
+  "$LIBPROTOC" "$LIBPROTOBUF" -lpthread
+mkdir "$WORK/out"
+
+# Prints the average wall time in milliseconds of RUNS runs of protoc with
+# the given arguments.
+time_runs() {
+  start=$(date +%s%N)
+  r=0
+  while [ $r -lt $RUNS ]; do
+    "$PROTOC" "$@" google_speed.proto
+    r=$((r + 1))
+  done
+  end=$(date +%s%N)
+  awk "BEGIN { printf \"%.2f\", ($end - $start) / $RUNS / 1000000 }"
+}
+
+PLUGIN="--plugin=protoc-gen-bench=$WORK/protoc-gen-bench --bench_out=$WORK/out"
+
+"$PROTOC" --serve_plugins="$WORK/plugins.sock" \
+  --plugin=protoc-gen-bench="$WORK/protoc-gen-bench" &
+SERVER_PID=$!
+while [ ! -S "$WORK/plugins.sock" ]; do sleep 0.1; done
+
+echo "Built-in --cpp_out:     $(time_runs --cpp_out="$WORK/out") ms"
+echo "Plugin, run directly:   $(time_runs $PLUGIN) ms"
+echo "Plugin, through server: $(time_runs $PLUGIN \
+  --plugin_server="$WORK/plugins.sock") ms"
@@ -0,0 +1,94 @@
+#! /bin/sh
+#
+# Measures the process startup cost of linking many generated .pb.cc files.
+#
+# Generates NUM_FILES .proto files (each importing the first one and
+# declaring MESSAGES messages), compiles them with ../src/protoc, links them
+# into one program together with a main() that does nothing unless asked to,
+# and reports the average wall time of RUNS executions.  A second figure is
+# reported for runs which also construct one message and look up one
+# descriptor, to show the cost of first use.
+#
+# Usage:  ./startup_time.sh [NUM_FILES] [MESSAGES] [RUNS]
+#
+# Environment:  PROTOC, CXX, CXXFLAGS and LIBPROTOBUF override the defaults
+# below.  Run it from this directory after building ../src.
+
+set -e
+
+NUM_FILES=${1:-1000}
+MESSAGES=${2:-10}
+RUNS=${3:-20}
+
+PROTOC=${PROTOC:-../src/protoc}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+LIBPROTOBUF=${LIBPROTOBUF:-../src/.libs/libprotobuf.a}
+SRC_DIR=$(cd ../src && pwd)
+PROTOC=$(cd "$(dirname "$PROTOC")" && pwd)/$(basename "$PROTOC")
+
+WORK=$(mktemp -d ${TMPDIR:-/tmp}/startup_time.XXXXXX)
+trap 'rm -rf "$WORK"' EXIT
+
+echo "Generating $NUM_FILES files with $MESSAGES messages each in $WORK"
+i=0
+while [ $i -lt $NUM_FILES ]; do
+  {
+    echo "package startup$i;"
+    if [ $i -gt 0 ]; then
+      echo "import \"startup0.proto\";"
+    fi
+    m=0
+    while [ $m -lt $MESSAGES ]; do
+      echo "message Message$m {"
+      echo "  optional int32 id = 1;"
+      echo "  optional string name = 2 [default = \"message\"];"
+      echo "  repeated int64 values = 3;"
+      if [ $i -gt 0 ]; then
+        echo "  optional startup0.Message$m base = 4;"
+      fi
+      if [ $m -gt 0 ]; then
+        echo "  optional Message$((m - 1)) sibling = 5;"
+      fi
+      echo "}"
+      m=$((m + 1))
+    done
+  } > "$WORK/startup$i.proto"
+  i=$((i + 1))
+done
+
+cat > "$WORK/main.cc" << __EOF__
+#include <string.h>
+#include "startup0.pb.h"
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && strcmp(argv[1], "--use") == 0) {
+    startup0::Message0 message;
+    message.set_id(1);
+    return message.GetDescriptor() == NULL || message.id() != 1;
+  }
+  return 0;
+}
+__EOF__
+
+echo "Compiling"
+(cd "$WORK" && "$PROTOC" -I. --cpp_out=. *.proto)
+ls "$WORK"/*.cc | xargs -P "$(getconf _NPROCESSORS_ONLN 2>/dev/null || echo 1)" \
+  -I{} sh -c "$CXX $CXXFLAGS -I$SRC_DIR -I$WORK -c {} -o {}.o"
+$CXX $CXXFLAGS -o "$WORK/startup" "$WORK"/*.o "$LIBPROTOBUF" -lpthread
+
+# Prints the average wall time in milliseconds of RUNS runs of the program.
+time_runs() {
+  start=$(date +%s%N)
+  r=0
+  while [ $r -lt $RUNS ]; do
+    "$WORK/startup" "$@"
+    r=$((r + 1))
+  done
+  end=$(date +%s%N)
+  awk "BEGIN { printf \"%.2f\", ($end - $start) / $RUNS / 1000000 }"
+}
+
+"$WORK/startup"  # Warm up the page cache.
+echo "Startup only:        $(time_runs) ms"
+echo "Startup + first use: $(time_runs --use) ms"
@@ -0,0 +1,142 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Measures how fast io::Tokenizer splits files into tokens, e.g.:
+//
+//   ./tokenize ../src/google/protobuf/unittest_enormous_descriptor.proto
+//
+// Files ending in ".proto" are read with C++ comments, anything else (such
+// as text format) with shell comments.  Each file is held in memory and
+// read through an ArrayInputStream, with token text copied (as
+// compiler::Parser reads it) and not copied (as TextFormat::Parser does).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+
+#include <google/protobuf/io/tokenizer.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+
+namespace {
+
+using google::protobuf::io::ArrayInputStream;
+using google::protobuf::io::ErrorCollector;
+using google::protobuf::io::Tokenizer;
+
+double Now() {
+  return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+}
+
+std::string ReadFile(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) {
+    fprintf(stderr, "%s: cannot open\n", path);
+    exit(1);
+  }
+  std::string contents;
+  char buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    contents.append(buffer, size);
+  }
+  fclose(file);
+  return contents;
+}
+
+class CountingErrorCollector : public ErrorCollector {
+ public:
+  CountingErrorCollector() : count_(0) {}
+  virtual void AddError(int line, int column, const std::string& message) {
+    if (count_++ == 0) {
+      fprintf(stderr, "%d:%d: %s\n", line + 1, column + 1, message.c_str());
+    }
+  }
+
+ private:
+  int count_;
+};
+
+// Tokenizes the whole of contents and returns the number of tokens.
+int Tokenize(const std::string& contents, Tokenizer::CommentStyle style,
+             bool copy_token_text, CountingErrorCollector* errors) {
+  // A block size like the one FileInputStream uses, so that tokens
+  // straddling buffers are exercised too.
+  ArrayInputStream input(contents.data(), contents.size(), 8192);
+  Tokenizer tokenizer(&input, errors);
+  tokenizer.set_comment_style(style);
+  tokenizer.set_copy_token_text(copy_token_text);
+  int count = 0;
+  while (tokenizer.Next()) ++count;
+  return count;
+}
+
+void TimeTokenizer(const char* name, const std::string& contents,
+                   Tokenizer::CommentStyle style, bool copy_token_text,
+                   int rounds) {
+  CountingErrorCollector errors;
+  int tokens = 0;
+  double start = Now();
+  for (int i = 0; i < rounds; i++) {
+    tokens = Tokenize(contents, style, copy_token_text, &errors);
+  }
+  double seconds = Now() - start;
+  printf("  %-22s %8.1f MB/s %8.1f ns/token (%d tokens)\n", name,
+         contents.size() * static_cast<double>(rounds) / seconds / 1e6,
+         seconds * 1e9 / (static_cast<double>(tokens) * rounds), tokens);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s FILE... [-rounds N]\n", argv[0]);
+    return 1;
+  }
+  int rounds = 20;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-rounds") == 0 && i + 1 < argc) {
+      rounds = atoi(argv[++i]);
+      continue;
+    }
+    std::string contents = ReadFile(argv[i]);
+    size_t length = strlen(argv[i]);
+    Tokenizer::CommentStyle style =
+        length > 6 && strcmp(argv[i] + length - 6, ".proto") == 0
+            ? Tokenizer::CPP_COMMENT_STYLE
+            : Tokenizer::SH_COMMENT_STYLE;
+    printf("%s (%d bytes):\n", argv[i], static_cast<int>(contents.size()));
+    TimeTokenizer("copied token text", contents, style, true, rounds);
+    TimeTokenizer("token text in place", contents, style, false, rounds);
+  }
+  return 0;
+}
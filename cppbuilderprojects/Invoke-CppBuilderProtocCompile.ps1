@@ -1,13 +1,43 @@
+# Generator options are off unless asked for.  In tests.cbproj,
+# cpp_test_future_stubs.proto needs -FutureStubs,
+# cpp_test_many_fields.proto needs -HasBitIteration, and
+# cpp_test_field_profile.proto needs -FieldProfile with the
+# cpp_test_field_profile.txt next to it.
 param 
 (
 	[Parameter(Mandatory=$true)]
 	$ProjectDirectory,
 
 	[Parameter(Mandatory=$true)]
-	$ProtoFile
+	$ProtoFile,
+
+	# Passes future_stubs=true to the generator.
+	[switch]
+	$FutureStubs,
+
+	# Passes has_bit_iteration=true to the generator.
+	[switch]
+	$HasBitIteration,
+
+	# A field profile to pass to the generator as field_profile.
+	$FieldProfile
 )
 
 cd $ProjectDirectory
 $relativeProtoPath = resolve-path $ProtoFile -Relative
 
-protoc.exe -I..\src --cpp_out=.\ $relativeProtoPath
+$generatorOptions = @()
+if ($FutureStubs) {
+	$generatorOptions += "future_stubs=true"
+}
+if ($HasBitIteration) {
+	$generatorOptions += "has_bit_iteration=true"
+}
+if ($FieldProfile) {
+	$generatorOptions += "field_profile=$(resolve-path $FieldProfile -Relative)"
+}
+if ($generatorOptions.Count -gt 0) {
+	protoc.exe -I..\src --cpp_out=$($generatorOptions -join ","):.\ $relativeProtoPath
+} else {
+	protoc.exe -I..\src --cpp_out=.\ $relativeProtoPath
+}
@@ -21,3 +21,11 @@
 
 /* define has set class */
 #define HASH_SET_CLASS hash_set
+
+/* define to count parsing and serialization per message type.  See
+ * google/protobuf/message_stats.h. */
+// #define GOOGLE_PROTOBUF_MESSAGE_STATS 1
+
+/* define to count what the library allocates per category.  See
+ * google/protobuf/allocator.h. */
+// #define GOOGLE_PROTOBUF_ALLOCATION_STATS 1
@@ -74,15 +74,12 @@ def NewCMessage(full_message_name):
 
 
 def ScalarProperty(cdescriptor):
-  """Returns a scalar property for the given descriptor."""
+  """Returns a scalar property for the given descriptor.
 
-  def Getter(self):
-    return self._cmsg.GetScalar(cdescriptor)
-
-  def Setter(self, value):
-    self._cmsg.SetScalar(cdescriptor, value)
-
-  return property(Getter, Setter)
+  The property is implemented in C++, and reads and writes the field of
+  self._cmsg without calling back into Python.
+  """
+  return _net_proto2___python.NewCScalarProperty(cdescriptor)
 
 
 def CompositeProperty(cdescriptor, message_type):
@@ -128,6 +125,9 @@ class RepeatedScalarContainer(object):
     self._cmsg.AssignRepeatedScalar(self._cfield_descriptor, values)
 
   def __setitem__(self, key, value):
+    if key == slice(None, None, None):
+      self._cmsg.AssignRepeatedScalar(self._cfield_descriptor, value)
+      return
     values = self[slice(None, None, None)]
     values[key] = value
     self._cmsg.AssignRepeatedScalar(self._cfield_descriptor, values)
@@ -139,7 +139,21 @@ class RepeatedScalarContainer(object):
     self._cmsg.DeleteRepeatedField(self._cfield_descriptor, key)
 
   def __len__(self):
-    return len(self[slice(None, None, None)])
+    return self._cmsg.FieldLength(self._cfield_descriptor)
+
+  def AsMemoryView(self):
+    """Returns a memoryview of the elements of a repeated numeric or bool
+    field, without copying them.  numpy.asarray() can wrap it, and writing
+    to it writes the field.  Assigning a buffer of the field's type to the
+    field, as in msg.field[:] = array, copies it into the field at once.
+
+    Until the view and everything made from it are gone, anything that would
+    resize or clear the field, including clearing or merging into a message
+    holding it, raises BufferError.  Assigning a buffer of the same length
+    still copies it into the field in place.
+    """
+    return memoryview(_net_proto2___python.NewCRepeatedScalarView(
+        self._message, self._cfield_descriptor))
 
   def __eq__(self, other):
     if self is other:
@@ -606,6 +620,28 @@ def _AddMessageMethods(message_descriptor, cls):
     return msg
   cls.FromString = staticmethod(FromString)
 
+  def ParseDelimited(source, num_threads=1):
+    """Parses a stream of messages each preceded by its size as a varint.
+
+    Args:
+      source: A string or other buffer holding the whole stream, or a file
+        descriptor to read it from up to its end.
+      num_threads: How many threads to parse the messages on.  They run
+        without the GIL.
+
+    Returns:
+      A list of the messages, in order.
+    """
+    if num_threads < 1:
+      raise ValueError('num_threads must be at least 1.')
+    try:
+      cmessages = _net_proto2___python.ParseDelimited(
+          message_descriptor.full_name, source, num_threads)
+    except ValueError, e:
+      raise message.DecodeError(str(e))
+    return [cls(__cmessage=cmessage) for cmessage in cmessages]
+  cls.ParseDelimited = staticmethod(ParseDelimited)
+
 
 
 def _AddPropertiesForExtensions(message_descriptor, cls):
@@ -37,7 +37,9 @@ pure-Python protocol compiler.
 
 __author__ = 'robinson@google.com (Will Robinson)'
 
+import ctypes
 import operator
+import os
 import struct
 
 import unittest
@@ -54,6 +56,7 @@ from google.protobuf.internal import more_messages_pb2
 from google.protobuf.internal import wire_format
 from google.protobuf.internal import test_util
 from google.protobuf.internal import decoder
+from google.protobuf.internal import encoder
 
 
 class _MiniDecoder(object):
@@ -538,6 +541,8 @@ class ReflectionTest(unittest.TestCase):
                       'some_attribute', 34)
     # proto.nonexistent_field = 23 should fail as well.
     self.assertRaises(AttributeError, setattr, proto, 'nonexistent_field', 23)
+    # Nor can singular fields be deleted.
+    self.assertRaises(AttributeError, delattr, proto, 'optional_int32')
 
   def testSingleScalarTypeSafety(self):
     proto = unittest_pb2.TestAllTypes()
@@ -754,6 +759,171 @@ class ReflectionTest(unittest.TestCase):
     # Remove a non-existent element.
     self.assertRaises(ValueError, proto.repeated_int32.remove, 123)
 
+  def testRepeatedScalarsAsMemoryView(self):
+    # Only the C++ implementation exports repeated fields as buffers.
+    if api_implementation.Type() == 'python':
+      return
+
+    proto = unittest_pb2.TestAllTypes()
+    proto.repeated_int32.extend([5, -10, 15])
+    proto.repeated_double.extend([1.5, 2.5])
+    proto.repeated_bool.extend([True, False])
+
+    view = proto.repeated_int32.AsMemoryView()
+    self.assertEqual('i', view.format)
+    self.assertEqual(4, view.itemsize)
+    self.assertEqual((3,), view.shape)
+    self.assertFalse(view.readonly)
+    self.assertEqual((5, -10, 15), struct.unpack('=3i', view.tobytes()))
+    view = proto.repeated_double.AsMemoryView()
+    self.assertEqual('d', view.format)
+    self.assertEqual((1.5, 2.5), struct.unpack('=2d', view.tobytes()))
+    view = proto.repeated_bool.AsMemoryView()
+    self.assertEqual('?', view.format)
+    self.assertEqual('\x01\x00', view.tobytes())
+    self.assertEqual(0, len(proto.repeated_float.AsMemoryView()))
+
+    # Writing to a view writes the field.
+    other = unittest_pb2.TestAllTypes()
+    other.repeated_int32.append(7)
+    proto.repeated_int32.AsMemoryView()[0:1] = (
+        other.repeated_int32.AsMemoryView())
+    self.assertEqual([7, -10, 15], proto.repeated_int32)
+
+    # Buffers of the field's type are assigned in one copy, including the
+    # field's own.
+    other.repeated_int32[:] = proto.repeated_int32.AsMemoryView()
+    self.assertEqual([7, -10, 15], other.repeated_int32)
+    other.repeated_double[:] = proto.repeated_double.AsMemoryView()
+    self.assertEqual([1.5, 2.5], other.repeated_double)
+    other.repeated_int32[:] = other.repeated_int32.AsMemoryView()
+    self.assertEqual([7, -10, 15], other.repeated_int32)
+    other.repeated_int32[:] = other.repeated_int32
+    self.assertEqual([7, -10, 15], other.repeated_int32)
+    self.assertRaises(TypeError, other.repeated_int32.__setitem__,
+                      slice(None, None, None), 5)
+    self.assertEqual([7, -10, 15], other.repeated_int32)
+
+    # Bytes other than 0 and 1 in a buffer of bools are read as True.
+    raw_bools = (ctypes.c_bool * 3)()
+    ctypes.memmove(raw_bools, '\x02\x00\x01', 3)
+    other.repeated_bool[:] = raw_bools
+    self.assertEqual('\x01\x00\x01',
+                     other.repeated_bool.AsMemoryView().tobytes())
+
+    self.assertRaises(TypeError, proto.repeated_string.AsMemoryView)
+    extendee = unittest_pb2.TestAllExtensions()
+    self.assertRaises(
+        TypeError,
+        extendee.Extensions[unittest_pb2.repeated_int32_extension].AsMemoryView)
+
+  def testMemoryViewBlocksResizing(self):
+    # Only the C++ implementation exports repeated fields as buffers.
+    if api_implementation.Type() == 'python':
+      return
+
+    proto = unittest_pb2.TestAllTypes()
+    proto.repeated_int32.extend([1, 2, 3])
+    proto.optional_nested_message.bb = 1
+    file_proto = descriptor_pb2.FileDescriptorProto()
+    file_proto.source_code_info.location.add().path.extend([4, 5])
+    other = unittest_pb2.TestAllTypes()
+    other.repeated_int32.extend([7, 8, 9])
+    serialized = other.SerializeToString()
+
+    view = proto.repeated_int32.AsMemoryView()
+    nested_view = file_proto.source_code_info.location[0].path.AsMemoryView()
+
+    # Nothing may resize or clear the field while the view exists.
+    self.assertRaises(BufferError, proto.repeated_int32.append, 4)
+    self.assertRaises(BufferError, proto.repeated_int32.__delitem__, 0)
+    self.assertRaises(BufferError, proto.repeated_int32.__setitem__,
+                      slice(None, None, None), [1, 2])
+    self.assertRaises(BufferError, proto.repeated_int32.__setitem__,
+                      slice(None, None, None),
+                      other.repeated_int32.AsMemoryView()[0:2])
+    self.assertRaises(BufferError, proto.ClearField, 'repeated_int32')
+    self.assertRaises(BufferError, proto.Clear)
+    self.assertRaises(BufferError, proto.MergeFrom, other)
+    self.assertRaises(BufferError, proto.CopyFrom, other)
+    self.assertRaises(BufferError, proto.MergeFromString, serialized)
+    self.assertRaises(BufferError, file_proto.ClearField, 'source_code_info')
+    self.assertRaises(BufferError, file_proto.source_code_info.Clear)
+    self.assertRaises(BufferError,
+                      file_proto.source_code_info.location.__delitem__, 0)
+    self.assertEqual([1, 2, 3], proto.repeated_int32)
+    self.assertEqual([4, 5], file_proto.source_code_info.location[0].path)
+
+    # Other fields are not affected, and a buffer of the same length is
+    # copied in place, where the view sees it.
+    proto.repeated_double.append(1.5)
+    proto.ClearField('optional_nested_message')
+    proto.repeated_int32[:] = other.repeated_int32.AsMemoryView()
+    self.assertEqual((7, 8, 9), struct.unpack('=3i', view.tobytes()))
+    proto.repeated_int32[:] = view
+    self.assertEqual([7, 8, 9], proto.repeated_int32)
+
+    del view
+    proto.repeated_int32.append(10)
+    self.assertEqual([7, 8, 9, 10], proto.repeated_int32)
+    proto.Clear()
+    del nested_view
+    file_proto.ClearField('source_code_info')
+    self.assertFalse(file_proto.HasField('source_code_info'))
+
+  def testParseDelimited(self):
+    # Only the C++ implementation parses delimited streams.
+    if api_implementation.Type() == 'python':
+      return
+
+    protos = []
+    for i in range(20):
+      proto = unittest_pb2.TestAllTypes()
+      if i % 3:
+        proto.optional_int32 = i
+        proto.optional_string = 'x' * i
+        proto.repeated_nested_message.add().bb = i
+      protos.append(proto)
+    stream = ''.join(encoder._VarintBytes(proto.ByteSize()) +
+                     proto.SerializeToString() for proto in protos)
+
+    self.assertEqual([], unittest_pb2.TestAllTypes.ParseDelimited(''))
+    self.assertEqual(protos, unittest_pb2.TestAllTypes.ParseDelimited(stream))
+    self.assertEqual(protos, unittest_pb2.TestAllTypes.ParseDelimited(
+        buffer(stream)))
+    self.assertEqual(protos, unittest_pb2.TestAllTypes.ParseDelimited(
+        bytearray(stream), num_threads=3))
+    self.assertEqual(protos, unittest_pb2.TestAllTypes.ParseDelimited(
+        stream, num_threads=100))
+
+    # The parsed messages are independent and writable.
+    parsed = unittest_pb2.TestAllTypes.ParseDelimited(stream)
+    parsed[1].optional_int32 = 100
+    self.assertEqual(100, parsed[1].optional_int32)
+    self.assertEqual(2, parsed[2].optional_int32)
+
+    read_fd, write_fd = os.pipe()
+    os.write(write_fd, stream)
+    os.close(write_fd)
+    try:
+      self.assertEqual(protos,
+                       unittest_pb2.TestAllTypes.ParseDelimited(read_fd))
+    finally:
+      os.close(read_fd)
+    self.assertRaises(IOError, unittest_pb2.TestAllTypes.ParseDelimited,
+                      read_fd)
+
+    self.assertRaises(message.DecodeError,
+                      unittest_pb2.TestAllTypes.ParseDelimited, stream[:-1])
+    self.assertRaises(message.DecodeError,
+                      unittest_pb2.TestAllTypes.ParseDelimited, '\x80')
+    # A message whose bytes don't parse: a lone field number 0 tag.
+    self.assertRaises(message.DecodeError,
+                      unittest_pb2.TestAllTypes.ParseDelimited,
+                      stream + '\x01\x00', num_threads=2)
+    self.assertRaises(ValueError, unittest_pb2.TestAllTypes.ParseDelimited,
+                      stream, num_threads=0)
+
   def testRepeatedComposites(self):
     proto = unittest_pb2.TestAllTypes()
     self.assertTrue(not proto.repeated_nested_message)
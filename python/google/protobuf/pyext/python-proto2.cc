@@ -31,6 +31,9 @@
 // Author: petar@google.com (Petar Petrov)
 
 #include <Python.h>
+#include <pythread.h>
+#include <errno.h>
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
@@ -38,9 +41,11 @@
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/pyext/python_descriptor.h>
 #include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/dynamic_message.h>
 #include <google/protobuf/message.h>
+#include <google/protobuf/repeated_field.h>
 #include <google/protobuf/unknown_field_set.h>
 #include <google/protobuf/pyext/python_protobuf.h>
 
@@ -333,6 +338,17 @@ static void FormatTypeError(PyObject* arg, char* expected_types) {
 template <class T>
 static bool CheckAndGetInteger(
     PyObject* arg, T* value, PyObject* min, PyObject* max) {
+  if (PyInt_Check(arg)) {
+    // Plain ints which fit in T need none of the comparisons below.
+    long int_value = PyInt_AS_LONG(arg);
+    T result = static_cast<T>(int_value);
+    if (static_cast<long>(result) == int_value &&
+        (int_value >= 0 || min != kPythonZero)) {
+      *value = result;
+      return true;
+    }
+  }
+
   bool is_long = PyLong_Check(arg);
   if (!PyInt_Check(arg) && !is_long) {
     FormatTypeError(arg, "int, long");
@@ -469,7 +485,8 @@ static bool CheckAndSetString(
 }
 
 static PyObject* ToStringObject(
-    const google::protobuf::FieldDescriptor* descriptor, string value) {
+    const google::protobuf::FieldDescriptor* descriptor,
+    const std::string& value) {
   if (descriptor->type() != google::protobuf::FieldDescriptor::TYPE_STRING) {
     return PyString_FromStringAndSize(value.c_str(), value.length());
   }
@@ -936,6 +953,279 @@ static PyObject* InternalGetRepeatedScalarSlice(
   return list;
 }
 
+// Describes the elements of a repeated field whose cpp_type() is a number
+// or bool in the notation of the struct module, as a buffer's format does.
+// Returns false for other types.
+static bool GetRepeatedScalarFormat(
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    const char** format, Py_ssize_t* itemsize) {
+  switch (field_descriptor->cpp_type()) {
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+      *format = "i";
+      *itemsize = sizeof(int32);
+      return true;
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+      *format = "q";
+      *itemsize = sizeof(int64);
+      return true;
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+      *format = "I";
+      *itemsize = sizeof(uint32);
+      return true;
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+      *format = "Q";
+      *itemsize = sizeof(uint64);
+      return true;
+    case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+      *format = "f";
+      *itemsize = sizeof(float);
+      return true;
+    case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+      *format = "d";
+      *itemsize = sizeof(double);
+      return true;
+    case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+      *format = "?";
+      *itemsize = sizeof(bool);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Checks whether a buffer holds native values of the field's type, e.g.
+// "l" (a long) with an itemsize of 8 for an int64 field.  Only the kind of
+// number and its size have to match the field's own format.
+static bool BufferFormatMatches(
+    const Py_buffer& buffer,
+    const google::protobuf::FieldDescriptor* field_descriptor) {
+  const char* field_format;
+  Py_ssize_t field_itemsize;
+  if (!GetRepeatedScalarFormat(field_descriptor, &field_format,
+                               &field_itemsize) ||
+      buffer.itemsize != field_itemsize) {
+    return false;
+  }
+
+  const char* format = buffer.format == NULL ? "B" : buffer.format;
+  if (*format == '@' || *format == '=') {
+    ++format;
+#ifdef PROTOBUF_LITTLE_ENDIAN
+  } else if (*format == '<') {
+    ++format;
+#endif
+  }
+  if (format[0] == '\0' || format[1] != '\0') {
+    return false;
+  }
+
+  static const char kSigned[] = "bhilq";
+  static const char kUnsigned[] = "BHILQ";
+  static const char kFloating[] = "fd";
+  static const char kBool[] = "?";
+  const char* kinds[] = { kSigned, kUnsigned, kFloating, kBool };
+  for (int i = 0; i < 4; ++i) {
+    if (strchr(kinds[i], *format) != NULL) {
+      return strchr(kinds[i], *field_format) != NULL;
+    }
+  }
+  return false;
+}
+
+// Buffers exported by CRepeatedScalarViews and not yet released, counted by
+// the message and field whose array they point into.  Changing the size of
+// such a field could move or free the array, so it is refused until they
+// are released.
+typedef std::pair<const google::protobuf::Message*,
+                  const google::protobuf::FieldDescriptor*> ExportedField;
+static std::map<ExportedField, int> exported_fields;
+
+static bool HasExportedBuffers(
+    const google::protobuf::Message& message,
+    const google::protobuf::FieldDescriptor* field_descriptor);
+
+// Returns true if a buffer exported from any field of message, or of a
+// message under it, is still held.
+static bool HasExportedBuffers(const google::protobuf::Message& message) {
+  std::map<ExportedField, int>::const_iterator iter =
+      exported_fields.lower_bound(ExportedField(&message, NULL));
+  if (iter != exported_fields.end() && iter->first.first == &message) {
+    return true;
+  }
+  vector<const google::protobuf::FieldDescriptor*> fields;
+  message.GetReflection()->ListFields(message, &fields);
+  for (size_t i = 0; i < fields.size(); ++i) {
+    if (fields[i]->cpp_type() ==
+            google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE &&
+        HasExportedBuffers(message, fields[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if a buffer exported from the given field of message, or
+// from a field of a message under it, is still held.
+static bool HasExportedBuffers(
+    const google::protobuf::Message& message,
+    const google::protobuf::FieldDescriptor* field_descriptor) {
+  if (exported_fields.count(ExportedField(&message, field_descriptor)) > 0) {
+    return true;
+  }
+  if (field_descriptor->cpp_type() !=
+      google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+    return false;
+  }
+  const google::protobuf::Reflection* reflection = message.GetReflection();
+  if (FIELD_IS_REPEATED(field_descriptor)) {
+    int size = reflection->FieldSize(message, field_descriptor);
+    for (int i = 0; i < size; ++i) {
+      if (HasExportedBuffers(reflection->GetRepeatedMessage(
+              message, field_descriptor, i))) {
+        return true;
+      }
+    }
+    return false;
+  }
+  return reflection->HasField(message, field_descriptor) &&
+         HasExportedBuffers(reflection->GetMessage(message, field_descriptor));
+}
+
+// Must be called before anything which may change the size of the given
+// field of message, or of any of its fields if field_descriptor is NULL.
+// Returns false with BufferError set if a buffer exported from one of them
+// is still held.
+static bool CheckNoExportedBuffers(
+    const google::protobuf::Message& message,
+    const google::protobuf::FieldDescriptor* field_descriptor) {
+  if (exported_fields.empty()) {
+    return true;
+  }
+  bool exported = field_descriptor == NULL
+      ? HasExportedBuffers(message)
+      : HasExportedBuffers(message, field_descriptor);
+  if (exported) {
+    PyErr_SetString(PyExc_BufferError,
+                    "Existing views of a repeated field: it cannot be "
+                    "resized or cleared.");
+    return false;
+  }
+  return true;
+}
+
+// Sets the contents of a RepeatedField<T> to count values.  If it already
+// holds that many, they are overwritten, so that its array stays put.
+template <typename T>
+static void SetRepeatedFieldValues(
+    google::protobuf::RepeatedField<T>* repeated,
+    const T* values, Py_ssize_t count) {
+  if (repeated->size() == count) {
+    std::copy(values, values + count, repeated->mutable_data());
+  } else {
+    repeated->Clear();
+    repeated->Add(values, values + count);
+  }
+}
+
+template <typename T>
+static void ReplaceRepeatedField(void* field, const void* data,
+                                 Py_ssize_t count) {
+  google::protobuf::RepeatedField<T>* repeated =
+      static_cast<google::protobuf::RepeatedField<T>*>(field);
+  const T* values = static_cast<const T*>(data);
+  // The values may be the field's own, as in field[:] = field.AsMemoryView(),
+  // and Clear() and Add() could free them while they are read.
+  google::protobuf::scoped_array<T> copy;
+  const T* array = repeated->data();
+  if (count > 0 && array != NULL &&
+      values < array + repeated->size() && array < values + count) {
+    copy.reset(new T[count]);
+    memcpy(copy.get(), values, count * sizeof(T));
+    values = copy.get();
+  }
+  SetRepeatedFieldValues(repeated, values, count);
+}
+
+// A bool must be 0 or 1, while a buffer of format "?" may hold any byte, so
+// each one is converted.  That also copies them out of the field.
+template <>
+void ReplaceRepeatedField<bool>(void* field, const void* data,
+                                Py_ssize_t count) {
+  const uint8* bytes = static_cast<const uint8*>(data);
+  google::protobuf::scoped_array<bool> values(new bool[count]);
+  for (Py_ssize_t i = 0; i < count; ++i) {
+    values[i] = bytes[i] != 0;
+  }
+  SetRepeatedFieldValues(
+      static_cast<google::protobuf::RepeatedField<bool>*>(field),
+      values.get(), count);
+}
+
+// Replaces the contents of a repeated field with those of arg in one copy,
+// if arg is a one-dimensional buffer of values of the field's type, such as
+// a numpy array or a memoryview of another such field.  Returns 1 if it
+// did, 0 if arg is no such buffer, or -1 with BufferError set if views of
+// the field exist and arg holds a different number of values; the field is
+// unchanged unless 1 is returned.  While views exist, a buffer of the same
+// length is copied into the field's array in place.
+static int AssignRepeatedScalarFromBuffer(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    PyObject* arg) {
+  if (!PyObject_CheckBuffer(arg)) {
+    return 0;
+  }
+  const google::protobuf::Reflection* reflection = message->GetReflection();
+  void* field = reflection->MutableRawRepeatedField(message, field_descriptor);
+  if (field == NULL) {
+    return 0;
+  }
+
+  Py_buffer buffer;
+  if (PyObject_GetBuffer(arg, &buffer, PyBUF_ND | PyBUF_FORMAT) < 0) {
+    // Not contiguous, for example; it can still be iterated.
+    PyErr_Clear();
+    return 0;
+  }
+  if (buffer.ndim > 1 || !BufferFormatMatches(buffer, field_descriptor)) {
+    PyBuffer_Release(&buffer);
+    return 0;
+  }
+  Py_ssize_t count = buffer.len / buffer.itemsize;
+  if (count != reflection->FieldSize(*message, field_descriptor) &&
+      !CheckNoExportedBuffers(*message, field_descriptor)) {
+    PyBuffer_Release(&buffer);
+    return -1;
+  }
+  switch (field_descriptor->cpp_type()) {
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+      ReplaceRepeatedField<int32>(field, buffer.buf, count);
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+      ReplaceRepeatedField<int64>(field, buffer.buf, count);
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+      ReplaceRepeatedField<uint32>(field, buffer.buf, count);
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+      ReplaceRepeatedField<uint64>(field, buffer.buf, count);
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+      ReplaceRepeatedField<float>(field, buffer.buf, count);
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+      ReplaceRepeatedField<double>(field, buffer.buf, count);
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+      ReplaceRepeatedField<bool>(field, buffer.buf, count);
+      break;
+    default:
+      break;
+  }
+  PyBuffer_Release(&buffer);
+  return 1;
+}
+
 // ------ C Constructor/Destructor:
 
 static int CMessageInit(CMessage* self, PyObject *args, PyObject *kwds) {
@@ -957,6 +1247,9 @@ static void CMessageDealloc(CMessage* self) {
 
 static PyObject* CMessage_Clear(CMessage* self, PyObject* args) {
   AssureWritable(self);
+  if (!CheckNoExportedBuffers(*self->message, NULL)) {
+    return NULL;
+  }
   self->message->Clear();
   Py_RETURN_NONE;
 }
@@ -1034,6 +1327,9 @@ static PyObject* CMessage_ClearFieldByDescriptor(
                     "Field does not belong to message!");
     return NULL;
   }
+  if (!CheckNoExportedBuffers(*message, field_descriptor)) {
+    return NULL;
+  }
 
   message->GetReflection()->ClearField(message, field_descriptor);
   Py_RETURN_NONE;
@@ -1053,6 +1349,9 @@ static PyObject* CMessage_ClearField(CMessage* self, PyObject* arg) {
     PyErr_Format(PyExc_ValueError, "Unknown field %s.", field_name);
     return NULL;
   }
+  if (!CheckNoExportedBuffers(*message, field_descriptor)) {
+    return NULL;
+  }
 
   message->GetReflection()->ClearField(message, field_descriptor);
   Py_RETURN_NONE;
@@ -1093,20 +1392,36 @@ static PyObject* CMessage_AssignRepeatedScalar(CMessage* self, PyObject* args) {
 
   AssureWritable(self);
   google::protobuf::Message* message = self->message;
-  message->GetReflection()->ClearField(message, cfield_descriptor->descriptor);
+  int assigned = AssignRepeatedScalarFromBuffer(
+      message, cfield_descriptor->descriptor, slice);
+  if (assigned < 0) {
+    return NULL;
+  } else if (assigned > 0) {
+    Py_RETURN_NONE;
+  }
+  if (!CheckNoExportedBuffers(*message, cfield_descriptor->descriptor)) {
+    return NULL;
+  }
 
-  PyObject* iter = PyObject_GetIter(slice);
-  PyObject* next;
-  while ((next = PyIter_Next(iter)) != NULL) {
-    if (InternalAddRepeatedScalar(
-            message, cfield_descriptor->descriptor, next) == NULL) {
-      Py_DECREF(next);
-      Py_DECREF(iter);
+  // Take all of the values before clearing the field, as they may come from
+  // the field itself.
+  PyObject* values = PySequence_Fast(slice, "can only assign an iterable");
+  if (values == NULL) {
+    return NULL;
+  }
+  message->GetReflection()->ClearField(message, cfield_descriptor->descriptor);
+  Py_ssize_t size = PySequence_Fast_GET_SIZE(values);
+  for (Py_ssize_t i = 0; i < size; ++i) {
+    PyObject* result = InternalAddRepeatedScalar(
+        message, cfield_descriptor->descriptor,
+        PySequence_Fast_GET_ITEM(values, i));
+    if (result == NULL) {
+      Py_DECREF(values);
       return NULL;
     }
-    Py_DECREF(next);
+    Py_DECREF(result);
   }
-  Py_DECREF(iter);
+  Py_DECREF(values);
   Py_RETURN_NONE;
 }
 
@@ -1124,6 +1439,9 @@ static PyObject* CMessage_DeleteRepeatedField(CMessage* self, PyObject* args) {
   const google::protobuf::FieldDescriptor* field_descriptor =
       cfield_descriptor->descriptor;
   const google::protobuf::Reflection* reflection = message->GetReflection();
+  if (!CheckNoExportedBuffers(*message, field_descriptor)) {
+    return NULL;
+  }
   int min, max;
   length = reflection->FieldSize(*message, field_descriptor);
 
@@ -1203,6 +1521,9 @@ static PyObject* CMessage_AddRepeatedScalar(CMessage* self, PyObject* args) {
     return NULL;
   }
   AssureWritable(self);
+  if (!CheckNoExportedBuffers(*self->message, cfield_descriptor->descriptor)) {
+    return NULL;
+  }
 
   return InternalAddRepeatedScalar(
       self->message, cfield_descriptor->descriptor, value);
@@ -1274,6 +1595,9 @@ static PyObject* CMessage_MergeFrom(CMessage* self, PyObject* arg) {
     return NULL;
   }
   AssureWritable(self);
+  if (!CheckNoExportedBuffers(*self->message, NULL)) {
+    return NULL;
+  }
 
   self->message->MergeFrom(*other_message->message);
   Py_RETURN_NONE;
@@ -1298,6 +1622,9 @@ static PyObject* CMessage_CopyFrom(CMessage* self, PyObject* arg) {
   }
 
   AssureWritable(self);
+  if (!CheckNoExportedBuffers(*self->message, NULL)) {
+    return NULL;
+  }
 
   self->message->CopyFrom(*other_message->message);
   Py_RETURN_NONE;
@@ -1311,6 +1638,9 @@ static PyObject* CMessage_MergeFromString(CMessage* self, PyObject* arg) {
   }
 
   AssureWritable(self);
+  if (!CheckNoExportedBuffers(*self->message, NULL)) {
+    return NULL;
+  }
   google::protobuf::io::CodedInputStream input(
       reinterpret_cast<const uint8*>(data), data_length);
   bool success = self->message->MergePartialFromCodedStream(&input);
@@ -1558,6 +1888,871 @@ PyObject* Python_NewCMessage(PyObject* ignored, PyObject* arg) {
   return reinterpret_cast<PyObject*>(py_cmsg);
 }
 
+// --- CScalarProperty Custom Type:
+
+// A CScalarProperty is the attribute of a message class for one of its
+// singular scalar fields.  It is made once per field when the class is
+// created (see ScalarProperty() in cpp_message.py) and reads and writes the
+// field through functions chosen for its C++ type then, instead of having
+// GetScalar() and SetScalar() check the descriptor and switch on the type
+// at every access.
+
+typedef PyObject* (*ScalarGetter)(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor);
+typedef bool (*ScalarSetter)(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    PyObject* arg);
+
+typedef struct CScalarProperty {
+  PyObject_HEAD
+
+  // Held so that descriptor stays valid for the life of the property.
+  CFieldDescriptor* cfield_descriptor;
+  const google::protobuf::FieldDescriptor* descriptor;
+  ScalarGetter get;
+  ScalarSetter set;
+} CScalarProperty;
+
+// Interned "_cmsg", the attribute of a message holding its CMessage.
+static PyObject* kCMessageAttribute;
+
+static PyObject* GetInt32Scalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor) {
+  return PyInt_FromLong(
+      message->GetReflection()->GetInt32(*message, field_descriptor));
+}
+
+static PyObject* GetInt64Scalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor) {
+  int64 value = message->GetReflection()->GetInt64(*message, field_descriptor);
+#if IS_64BIT
+  return PyInt_FromLong(value);
+#else
+  return PyLong_FromLongLong(value);
+#endif
+}
+
+static PyObject* GetUInt32Scalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor) {
+  uint32 value =
+      message->GetReflection()->GetUInt32(*message, field_descriptor);
+#if IS_64BIT
+  return PyInt_FromLong(value);
+#else
+  return PyLong_FromLongLong(value);
+#endif
+}
+
+static PyObject* GetUInt64Scalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor) {
+  uint64 value =
+      message->GetReflection()->GetUInt64(*message, field_descriptor);
+#if IS_64BIT
+  if (value <= static_cast<uint64>(kint64max)) {
+    return PyInt_FromLong(static_cast<uint64>(value));
+  }
+#else
+  if (value <= static_cast<uint32>(kint32max)) {
+    return PyInt_FromLong(static_cast<uint32>(value));
+  }
+#endif
+  return PyLong_FromUnsignedLongLong(value);
+}
+
+static PyObject* GetFloatScalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor) {
+  return PyFloat_FromDouble(
+      message->GetReflection()->GetFloat(*message, field_descriptor));
+}
+
+static PyObject* GetDoubleScalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor) {
+  return PyFloat_FromDouble(
+      message->GetReflection()->GetDouble(*message, field_descriptor));
+}
+
+static PyObject* GetBoolScalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor) {
+  return PyBool_FromLong(
+      message->GetReflection()->GetBool(*message, field_descriptor) ? 1 : 0);
+}
+
+static PyObject* GetStringScalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor) {
+  std::string scratch;
+  const std::string& value = message->GetReflection()->GetStringReference(
+      *message, field_descriptor, &scratch);
+  return ToStringObject(field_descriptor, value);
+}
+
+static bool SetInt32Scalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    PyObject* arg) {
+  int32 value;
+  if (!CheckAndGetInteger(arg, &value, kint32min_py, kint32max_py)) {
+    return false;
+  }
+  message->GetReflection()->SetInt32(message, field_descriptor, value);
+  return true;
+}
+
+static bool SetInt64Scalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    PyObject* arg) {
+  int64 value;
+  if (!CheckAndGetInteger(arg, &value, kint64min_py, kint64max_py)) {
+    return false;
+  }
+  message->GetReflection()->SetInt64(message, field_descriptor, value);
+  return true;
+}
+
+static bool SetUInt32Scalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    PyObject* arg) {
+  uint32 value;
+  if (!CheckAndGetInteger(arg, &value, kPythonZero, kuint32max_py)) {
+    return false;
+  }
+  message->GetReflection()->SetUInt32(message, field_descriptor, value);
+  return true;
+}
+
+static bool SetUInt64Scalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    PyObject* arg) {
+  uint64 value;
+  if (!CheckAndGetInteger(arg, &value, kPythonZero, kuint64max_py)) {
+    return false;
+  }
+  message->GetReflection()->SetUInt64(message, field_descriptor, value);
+  return true;
+}
+
+static bool SetFloatScalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    PyObject* arg) {
+  float value;
+  if (!CheckAndGetFloat(arg, &value)) {
+    return false;
+  }
+  message->GetReflection()->SetFloat(message, field_descriptor, value);
+  return true;
+}
+
+static bool SetDoubleScalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    PyObject* arg) {
+  double value;
+  if (!CheckAndGetDouble(arg, &value)) {
+    return false;
+  }
+  message->GetReflection()->SetDouble(message, field_descriptor, value);
+  return true;
+}
+
+static bool SetBoolScalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    PyObject* arg) {
+  bool value;
+  if (!CheckAndGetBool(arg, &value)) {
+    return false;
+  }
+  message->GetReflection()->SetBool(message, field_descriptor, value);
+  return true;
+}
+
+// Strings and enums need all of InternalSetScalar().
+static bool SetAnyScalar(
+    google::protobuf::Message* message,
+    const google::protobuf::FieldDescriptor* field_descriptor,
+    PyObject* arg) {
+  PyObject* result = InternalSetScalar(message, field_descriptor, arg);
+  if (result == NULL) {
+    return false;
+  }
+  Py_DECREF(result);
+  return true;
+}
+
+// Returns a new reference to the CMessage of the given message object, or
+// NULL with an exception set if it has none or it is of another type.
+static CMessage* GetCMessageForField(
+    PyObject* obj, const google::protobuf::FieldDescriptor* field_descriptor) {
+  PyObject* cmessage = PyObject_GetAttr(obj, kCMessageAttribute);
+  if (cmessage == NULL) {
+    return NULL;
+  }
+  if (!PyObject_TypeCheck(cmessage, &CMessage_Type)) {
+    Py_DECREF(cmessage);
+    PyErr_SetString(PyExc_TypeError, "Must be a message");
+    return NULL;
+  }
+  if (!FIELD_BELONGS_TO_MESSAGE(
+          field_descriptor, reinterpret_cast<CMessage*>(cmessage)->message)) {
+    Py_DECREF(cmessage);
+    PyErr_SetString(PyExc_KeyError, "Field does not belong to message!");
+    return NULL;
+  }
+  return reinterpret_cast<CMessage*>(cmessage);
+}
+
+static PyObject* CScalarPropertyGet(
+    CScalarProperty* self, PyObject* obj, PyObject* type) {
+  if (obj == NULL) {
+    // Looked up on the class rather than on a message.
+    Py_INCREF(self);
+    return reinterpret_cast<PyObject*>(self);
+  }
+  CMessage* cmessage = GetCMessageForField(obj, self->descriptor);
+  if (cmessage == NULL) {
+    return NULL;
+  }
+  PyObject* result = self->get(cmessage->message, self->descriptor);
+  Py_DECREF(cmessage);
+  return result;
+}
+
+static int CScalarPropertySet(
+    CScalarProperty* self, PyObject* obj, PyObject* value) {
+  if (value == NULL) {
+    PyErr_SetString(PyExc_AttributeError, "can't delete attribute");
+    return -1;
+  }
+  CMessage* cmessage = GetCMessageForField(obj, self->descriptor);
+  if (cmessage == NULL) {
+    return -1;
+  }
+  AssureWritable(cmessage);
+  bool success = self->set(cmessage->message, self->descriptor, value);
+  Py_DECREF(cmessage);
+  return success ? 0 : -1;
+}
+
+static void CScalarPropertyDealloc(CScalarProperty* self) {
+  Py_XDECREF(self->cfield_descriptor);
+  self->ob_type->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+PyTypeObject CScalarProperty_Type = {
+  PyObject_HEAD_INIT(&PyType_Type)
+  0,
+  C("google3.net.google.protobuf.python.internal."
+    "_net_proto2___python."
+    "CScalarProperty"),                // tp_name
+  sizeof(CScalarProperty),             //  tp_basicsize
+  0,                                   //  tp_itemsize
+  (destructor)CScalarPropertyDealloc,  //  tp_dealloc
+  0,                                   //  tp_print
+  0,                                   //  tp_getattr
+  0,                                   //  tp_setattr
+  0,                                   //  tp_compare
+  0,                                   //  tp_repr
+  0,                                   //  tp_as_number
+  0,                                   //  tp_as_sequence
+  0,                                   //  tp_as_mapping
+  0,                                   //  tp_hash
+  0,                                   //  tp_call
+  0,                                   //  tp_str
+  0,                                   //  tp_getattro
+  0,                                   //  tp_setattro
+  0,                                   //  tp_as_buffer
+  Py_TPFLAGS_DEFAULT,                  //  tp_flags
+  C("A singular scalar field of a protocol message class"),  //  tp_doc
+  0,                                   //  tp_traverse
+  0,                                   //  tp_clear
+  0,                                   //  tp_richcompare
+  0,                                   //  tp_weaklistoffset
+  0,                                   //  tp_iter
+  0,                                   //  tp_iternext
+  0,                                   //  tp_methods
+  0,                                   //  tp_members
+  0,                                   //  tp_getset
+  0,                                   //  tp_base
+  0,                                   //  tp_dict
+  (descrgetfunc)CScalarPropertyGet,    //  tp_descr_get
+  (descrsetfunc)CScalarPropertySet,    //  tp_descr_set
+  0,                                   //  tp_dictoffset
+  0,                                   //  tp_init
+  PyType_GenericAlloc,                 //  tp_alloc
+  0,                                   //  tp_new
+  PyObject_Del,                        //  tp_free
+};
+
+PyObject* Python_NewCScalarProperty(PyObject* ignored, PyObject* arg) {
+  if (!PyObject_TypeCheck(arg, &CFieldDescriptor_Type)) {
+    PyErr_SetString(PyExc_TypeError, "Must be a field descriptor");
+    return NULL;
+  }
+  CFieldDescriptor* cfield_descriptor =
+      reinterpret_cast<CFieldDescriptor*>(arg);
+  const google::protobuf::FieldDescriptor* field_descriptor =
+      cfield_descriptor->descriptor;
+  if (FIELD_IS_REPEATED(field_descriptor) ||
+      field_descriptor->cpp_type() ==
+          google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+    PyErr_SetString(PyExc_TypeError,
+                    "Field must be a singular scalar field.");
+    return NULL;
+  }
+
+  ScalarGetter get = InternalGetScalar;
+  ScalarSetter set = SetAnyScalar;
+  switch (field_descriptor->cpp_type()) {
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+      get = GetInt32Scalar;
+      set = SetInt32Scalar;
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+      get = GetInt64Scalar;
+      set = SetInt64Scalar;
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+      get = GetUInt32Scalar;
+      set = SetUInt32Scalar;
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+      get = GetUInt64Scalar;
+      set = SetUInt64Scalar;
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+      get = GetFloatScalar;
+      set = SetFloatScalar;
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+      get = GetDoubleScalar;
+      set = SetDoubleScalar;
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+      get = GetBoolScalar;
+      set = SetBoolScalar;
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_STRING:
+      get = GetStringScalar;
+      break;
+    default:
+      // Enums keep their unknown values, which InternalGetScalar() and
+      // InternalSetScalar() handle.
+      break;
+  }
+
+  CScalarProperty* property =
+      PyObject_New(CScalarProperty, &CScalarProperty_Type);
+  if (property == NULL) {
+    return NULL;
+  }
+  Py_INCREF(cfield_descriptor);
+  property->cfield_descriptor = cfield_descriptor;
+  property->descriptor = field_descriptor;
+  property->get = get;
+  property->set = set;
+  return reinterpret_cast<PyObject*>(property);
+}
+
+// --- CRepeatedScalarView Custom Type:
+
+// A CRepeatedScalarView exports a repeated numeric or bool field of a
+// message through the buffer protocol, so that memoryview, numpy and the
+// like can read and write the RepeatedField's array in place.  Each buffer
+// taken from it holds the array's address, so until all of them are
+// released the field, and the messages holding it, refuse to change its
+// size (see CheckNoExportedBuffers()).
+
+typedef struct CRepeatedScalarView {
+  PyObject_HEAD
+
+  // The Python message, which keeps its CMessage (and that message's
+  // parents) alive.
+  PyObject* message;
+  CFieldDescriptor* cfield_descriptor;
+
+  // The message the buffers exported so far point into, and how many of
+  // them are still held.  Python 2's memoryview passes the Py_buffer of its
+  // own export to bf_releasebuffer for buffers taken from it, so the
+  // Py_buffer cannot say which message a buffer came from.
+  const google::protobuf::Message* exported_message;
+  int exports;
+} CRepeatedScalarView;
+
+template <typename T>
+static void* GetRepeatedFieldData(void* field, Py_ssize_t* size) {
+  google::protobuf::RepeatedField<T>* repeated =
+      static_cast<google::protobuf::RepeatedField<T>*>(field);
+  *size = repeated->size();
+  return repeated->mutable_data();
+}
+
+static int CRepeatedScalarViewGetBuffer(
+    CRepeatedScalarView* self, Py_buffer* view, int flags) {
+  const google::protobuf::FieldDescriptor* field_descriptor =
+      self->cfield_descriptor->descriptor;
+  CMessage* cmessage = GetCMessageForField(self->message, field_descriptor);
+  if (cmessage == NULL) {
+    return -1;
+  }
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+    AssureWritable(cmessage);
+  }
+  // A sub-message which has not been written to yet is its type's default
+  // instance, which may only be read.
+  bool readonly = cmessage->read_only;
+  google::protobuf::Message* message = cmessage->message;
+  const google::protobuf::Reflection* reflection = message->GetReflection();
+  void* field = readonly
+      ? const_cast<void*>(
+            reflection->GetRawRepeatedField(*message, field_descriptor))
+      : reflection->MutableRawRepeatedField(message, field_descriptor);
+  Py_DECREF(cmessage);
+  if (field == NULL) {
+    PyErr_SetString(PyExc_BufferError,
+                    "Field is not stored in a RepeatedField.");
+    return -1;
+  }
+  if (self->exports > 0 && self->exported_message != message) {
+    // The sub-message was read-only when the held buffers were taken.
+    PyErr_SetString(PyExc_BufferError,
+                    "Message has changed since the view's buffers were "
+                    "taken.");
+    return -1;
+  }
+
+  Py_ssize_t size = 0;
+  void* data = NULL;
+  switch (field_descriptor->cpp_type()) {
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+      data = GetRepeatedFieldData<int32>(field, &size);
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+      data = GetRepeatedFieldData<int64>(field, &size);
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+      data = GetRepeatedFieldData<uint32>(field, &size);
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+      data = GetRepeatedFieldData<uint64>(field, &size);
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+      data = GetRepeatedFieldData<float>(field, &size);
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+      data = GetRepeatedFieldData<double>(field, &size);
+      break;
+    case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+      data = GetRepeatedFieldData<bool>(field, &size);
+      break;
+    default:
+      break;
+  }
+
+  const char* format;
+  Py_ssize_t itemsize;
+  GetRepeatedScalarFormat(field_descriptor, &format, &itemsize);
+  if (data == NULL) {
+    // An empty field may have no array at all.
+    static char empty[1];
+    data = empty;
+  }
+
+  Py_INCREF(self);
+  view->obj = reinterpret_cast<PyObject*>(self);
+  view->buf = data;
+  view->len = size * itemsize;
+  view->itemsize = itemsize;
+  view->readonly = readonly ? 1 : 0;
+  view->ndim = 1;
+  view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT
+      ? const_cast<char*>(format) : NULL;
+  view->smalltable[0] = size;
+  view->shape = (flags & PyBUF_ND) == PyBUF_ND ? view->smalltable : NULL;
+  view->strides =
+      (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &view->itemsize : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+
+  self->exported_message = message;
+  ++self->exports;
+  ++exported_fields[ExportedField(message, field_descriptor)];
+  return 0;
+}
+
+static void CRepeatedScalarViewReleaseBuffer(
+    CRepeatedScalarView* self, Py_buffer* view) {
+  std::map<ExportedField, int>::iterator iter = exported_fields.find(
+      ExportedField(self->exported_message,
+                    self->cfield_descriptor->descriptor));
+  if (iter != exported_fields.end() && --iter->second == 0) {
+    exported_fields.erase(iter);
+  }
+  --self->exports;
+}
+
+static void CRepeatedScalarViewDealloc(CRepeatedScalarView* self) {
+  Py_XDECREF(self->message);
+  Py_XDECREF(self->cfield_descriptor);
+  self->ob_type->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+static PyBufferProcs CRepeatedScalarViewBufferProcs = {
+  0,                                              // bf_getreadbuffer
+  0,                                              // bf_getwritebuffer
+  0,                                              // bf_getsegcount
+  0,                                              // bf_getcharbuffer
+  (getbufferproc)CRepeatedScalarViewGetBuffer,    // bf_getbuffer
+  (releasebufferproc)CRepeatedScalarViewReleaseBuffer,  // bf_releasebuffer
+};
+
+PyTypeObject CRepeatedScalarView_Type = {
+  PyObject_HEAD_INIT(&PyType_Type)
+  0,
+  C("google3.net.google.protobuf.python.internal."
+    "_net_proto2___python."
+    "CRepeatedScalarView"),              // tp_name
+  sizeof(CRepeatedScalarView),           //  tp_basicsize
+  0,                                     //  tp_itemsize
+  (destructor)CRepeatedScalarViewDealloc,  //  tp_dealloc
+  0,                                     //  tp_print
+  0,                                     //  tp_getattr
+  0,                                     //  tp_setattr
+  0,                                     //  tp_compare
+  0,                                     //  tp_repr
+  0,                                     //  tp_as_number
+  0,                                     //  tp_as_sequence
+  0,                                     //  tp_as_mapping
+  0,                                     //  tp_hash
+  0,                                     //  tp_call
+  0,                                     //  tp_str
+  0,                                     //  tp_getattro
+  0,                                     //  tp_setattro
+  &CRepeatedScalarViewBufferProcs,       //  tp_as_buffer
+  Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER,  //  tp_flags
+  C("The array of a repeated numeric field"),  //  tp_doc
+};
+
+PyObject* Python_NewCRepeatedScalarView(PyObject* ignored, PyObject* args) {
+  PyObject* message;
+  CFieldDescriptor* cfield_descriptor;
+  if (!PyArg_ParseTuple(args, C("OO!:NewCRepeatedScalarView"),
+                        &message, &CFieldDescriptor_Type,
+                        &cfield_descriptor)) {
+    return NULL;
+  }
+  const google::protobuf::FieldDescriptor* field_descriptor =
+      cfield_descriptor->descriptor;
+  CMessage* cmessage = GetCMessageForField(message, field_descriptor);
+  if (cmessage == NULL) {
+    return NULL;
+  }
+  bool stored_as_array =
+      FIELD_IS_REPEATED(field_descriptor) &&
+      cmessage->message->GetReflection()->GetRawRepeatedField(
+          *cmessage->message, field_descriptor) != NULL;
+  Py_DECREF(cmessage);
+  if (!stored_as_array) {
+    PyErr_SetString(PyExc_TypeError,
+                    "Field must be a repeated numeric or bool field, "
+                    "and not an extension.");
+    return NULL;
+  }
+
+  CRepeatedScalarView* view =
+      PyObject_New(CRepeatedScalarView, &CRepeatedScalarView_Type);
+  if (view == NULL) {
+    return NULL;
+  }
+  Py_INCREF(message);
+  view->message = message;
+  Py_INCREF(cfield_descriptor);
+  view->cfield_descriptor = cfield_descriptor;
+  view->exported_message = NULL;
+  view->exports = 0;
+  return reinterpret_cast<PyObject*>(view);
+}
+
+// --- Parsing Streams of Delimited Messages:
+
+// In a stream of delimited messages each message is preceded by its size as
+// a varint, as Java's writeDelimitedTo() writes them.  ParseDelimited() takes
+// the whole stream at once and does the framing and the parsing in C++, so
+// that reading a file of many small records costs one call from Python
+// instead of one per record.
+
+struct DelimitedRecord {
+  const uint8* data;
+  int size;
+};
+
+// Splits the stream in [data, data + size) into its records.  Returns false
+// if a size is malformed or runs past the end of the stream, setting
+// *error_offset to the offset of that size.
+static bool SplitDelimitedRecords(const uint8* data, int size,
+                                  vector<DelimitedRecord>* records,
+                                  int* error_offset) {
+  google::protobuf::io::CodedInputStream input(data, size);
+  input.SetTotalBytesLimit(kint32max, -1);
+  input.PushLimit(size);
+  while (input.BytesUntilLimit() > 0) {
+    int offset = size - input.BytesUntilLimit();
+    uint32 length;
+    if (!input.ReadVarint32(&length) ||
+        length > static_cast<uint32>(input.BytesUntilLimit())) {
+      *error_offset = offset;
+      return false;
+    }
+    DelimitedRecord record;
+    record.data = data + size - input.BytesUntilLimit();
+    record.size = length;
+    records->push_back(record);
+    input.Skip(length);
+  }
+  return true;
+}
+
+// Reads fd up to its end.  Returns false and sets *error to errno on
+// failure.
+static bool ReadFileDescriptor(int fd, string* contents, int* error) {
+  google::protobuf::io::FileInputStream input(fd);
+  const void* data;
+  int size;
+  while (input.Next(&data, &size)) {
+    contents->append(reinterpret_cast<const char*>(data), size);
+  }
+  *error = input.GetErrno();
+  return *error == 0;
+}
+
+// The records one thread parses: messages[i] is made from records[i].
+struct ParseDelimitedTask {
+  const google::protobuf::Message* prototype;
+  const DelimitedRecord* records;
+  google::protobuf::Message** messages;
+  int count;
+  // Index of the first record that failed to parse, or -1.
+  int failed;
+  // Released when the task is done, if it runs on its own thread.
+  PyThread_type_lock done;
+};
+
+static void RunParseDelimitedTask(void* arg) {
+  ParseDelimitedTask* task = reinterpret_cast<ParseDelimitedTask*>(arg);
+  for (int i = 0; i < task->count; ++i) {
+    task->messages[i] = task->prototype->New();
+    if (!task->messages[i]->ParsePartialFromArray(task->records[i].data,
+                                                  task->records[i].size)) {
+      task->failed = i;
+      break;
+    }
+  }
+  if (task->done != NULL) {
+    PyThread_release_lock(task->done);
+  }
+}
+
+// Parses all the records, splitting them between num_threads threads, the
+// calling one included.  Must be called without the GIL held if
+// num_threads > 1.  Returns the index of the first record that failed to
+// parse, or -1.
+static int ParseDelimitedRecords(const google::protobuf::Message* prototype,
+                                 const vector<DelimitedRecord>& records,
+                                 int num_threads,
+                                 vector<google::protobuf::Message*>* messages) {
+  int count = records.size();
+  messages->assign(count, NULL);
+  if (num_threads > count) {
+    num_threads = count;
+  }
+  if (num_threads < 1) {
+    return -1;
+  }
+
+  vector<ParseDelimitedTask> tasks(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    int begin = static_cast<int64>(count) * i / num_threads;
+    int end = static_cast<int64>(count) * (i + 1) / num_threads;
+    tasks[i].prototype = prototype;
+    tasks[i].records = &records[begin];
+    tasks[i].messages = &(*messages)[begin];
+    tasks[i].count = end - begin;
+    tasks[i].failed = -1;
+    tasks[i].done = NULL;
+  }
+
+  for (int i = 1; i < num_threads; ++i) {
+    tasks[i].done = PyThread_allocate_lock();
+    if (tasks[i].done == NULL) {
+      continue;
+    }
+    PyThread_acquire_lock(tasks[i].done, WAIT_LOCK);
+    if (PyThread_start_new_thread(RunParseDelimitedTask, &tasks[i]) == -1) {
+      PyThread_release_lock(tasks[i].done);
+      PyThread_free_lock(tasks[i].done);
+      tasks[i].done = NULL;
+    }
+  }
+  RunParseDelimitedTask(&tasks[0]);
+
+  int failed = -1;
+  for (int i = 0; i < num_threads; ++i) {
+    if (i > 0) {
+      if (tasks[i].done != NULL) {
+        PyThread_acquire_lock(tasks[i].done, WAIT_LOCK);
+        PyThread_release_lock(tasks[i].done);
+        PyThread_free_lock(tasks[i].done);
+      } else {
+        // Its thread couldn't be started; parse its records here instead.
+        RunParseDelimitedTask(&tasks[i]);
+      }
+    }
+    if (failed == -1 && tasks[i].failed != -1) {
+      failed = tasks[i].records - &records[0] + tasks[i].failed;
+    }
+  }
+  return failed;
+}
+
+PyObject* Python_ParseDelimited(PyObject* ignored, PyObject* args) {
+  const char* message_type;
+  PyObject* source;
+  int num_threads = 1;
+  if (!PyArg_ParseTuple(args, C("sO|i:ParseDelimited"),
+                        &message_type, &source, &num_threads)) {
+    return NULL;
+  }
+  if (num_threads < 1) {
+    PyErr_SetString(PyExc_ValueError, "num_threads must be at least 1.");
+    return NULL;
+  }
+  const google::protobuf::Message* prototype = CreateMessage(message_type);
+  if (prototype == NULL) {
+    PyErr_Format(PyExc_TypeError, "Couldn't create message of type %s!",
+                 message_type);
+    return NULL;
+  }
+
+  // The GIL may only be released while nothing else can move or free the
+  // bytes being parsed: when they were read from a file descriptor, or when
+  // the source exports them through the new buffer protocol, which keeps
+  // e.g. a bytearray from being resized until the buffer is released.
+  string contents;
+  Py_buffer view;
+  bool have_view = false;
+  bool release_gil = true;
+  const void* data;
+  Py_ssize_t data_length;
+  if (PyInt_Check(source) || PyLong_Check(source)) {
+    long fd = PyInt_AsLong(source);
+    if (fd == -1 && PyErr_Occurred()) {
+      return NULL;
+    }
+    bool success;
+    int error;
+    Py_BEGIN_ALLOW_THREADS
+    success = ReadFileDescriptor(fd, &contents, &error);
+    Py_END_ALLOW_THREADS
+    if (!success) {
+      errno = error;
+      return PyErr_SetFromErrno(PyExc_IOError);
+    }
+    data = contents.data();
+    data_length = contents.size();
+  } else if (PyObject_CheckBuffer(source)) {
+    if (PyObject_GetBuffer(source, &view, PyBUF_SIMPLE) < 0) {
+      return NULL;
+    }
+    have_view = true;
+    data = view.buf;
+    data_length = view.len;
+  } else {
+    if (PyObject_AsReadBuffer(source, &data, &data_length) < 0) {
+      return NULL;
+    }
+    release_gil = false;
+    num_threads = 1;
+  }
+
+  PyObject* list = NULL;
+  if (data_length > kint32max) {
+    PyErr_SetString(PyExc_ValueError,
+                    "Delimited message stream is larger than 2GB.");
+  } else {
+    vector<DelimitedRecord> records;
+    vector<google::protobuf::Message*> messages;
+    bool split;
+    int error_offset;
+    int failed = -1;
+    PyThreadState* thread_state = NULL;
+    if (release_gil) {
+      thread_state = PyEval_SaveThread();
+    }
+    split = SplitDelimitedRecords(reinterpret_cast<const uint8*>(data),
+                                  data_length, &records, &error_offset);
+    if (split) {
+      failed = ParseDelimitedRecords(prototype, records, num_threads,
+                                     &messages);
+    }
+    if (release_gil) {
+      PyEval_RestoreThread(thread_state);
+    }
+
+    if (!split) {
+      PyErr_Format(PyExc_ValueError,
+                   "Truncated or malformed size of delimited message %d, "
+                   "at byte %d.",
+                   static_cast<int>(records.size()), error_offset);
+    } else if (failed != -1) {
+      PyErr_Format(PyExc_ValueError,
+                   "Couldn't parse delimited message %d.", failed);
+    } else {
+      list = PyList_New(messages.size());
+    }
+
+    // Each message is handed over to its CMessage as soon as that is made;
+    // the rest are deleted here on any failure.
+    if (list != NULL) {
+      for (size_t i = 0; i < messages.size(); ++i) {
+        CMessage* py_cmsg = PyObject_New(CMessage, &CMessage_Type);
+        if (py_cmsg == NULL) {
+          Py_DECREF(list);
+          list = NULL;
+          break;
+        }
+        py_cmsg->message = messages[i];
+        messages[i] = NULL;
+        py_cmsg->free_message = true;
+        py_cmsg->full_name = prototype->GetDescriptor()->full_name().c_str();
+        py_cmsg->read_only = false;
+        py_cmsg->parent = NULL;
+        py_cmsg->parent_field = NULL;
+        PyList_SET_ITEM(list, i, reinterpret_cast<PyObject*>(py_cmsg));
+      }
+    }
+    for (size_t i = 0; i < messages.size(); ++i) {
+      delete messages[i];
+    }
+  }
+
+  if (have_view) {
+    PyBuffer_Release(&view);
+  }
+  return list;
+}
+
 // --- Module Functions (exposed to Python):
 
 PyMethodDef methods[] = {
@@ -1567,6 +2762,20 @@ PyMethodDef methods[] = {
   { C("NewCDescriptorPool"), (PyCFunction)Python_NewCDescriptorPool,
     METH_NOARGS,
     C("Creates a new C++ descriptor pool.") },
+  { C("NewCScalarProperty"), (PyCFunction)Python_NewCScalarProperty,
+    METH_O,
+    C("Creates the attribute of a message class for a singular scalar "
+      "field, given its field descriptor.") },
+  { C("NewCRepeatedScalarView"), (PyCFunction)Python_NewCRepeatedScalarView,
+    METH_VARARGS,
+    C("Creates an object exporting the array of a repeated numeric field "
+      "through the buffer protocol, given a message and the field's "
+      "descriptor.") },
+  { C("ParseDelimited"), (PyCFunction)Python_ParseDelimited,
+    METH_VARARGS,
+    C("Parses a stream of delimited messages of the given type, from a "
+      "string or buffer or read from a file descriptor, optionally on "
+      "several threads.  Returns a list of new C++ messages.") },
   { C("BuildFile"), (PyCFunction)Python_BuildFile,
     METH_O,
     C("Registers a new protocol buffer file in the global C++ descriptor "
@@ -1645,6 +2854,14 @@ extern "C" {
       return;
     }
 
+    if (PyType_Ready(&CScalarProperty_Type) < 0) {
+      return;
+    }
+    if (PyType_Ready(&CRepeatedScalarView_Type) < 0) {
+      return;
+    }
+    kCMessageAttribute = PyString_InternFromString("_cmsg");
+
     if (!InitDescriptor()) {
       return;
     }
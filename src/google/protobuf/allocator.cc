@@ -0,0 +1,229 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/allocator.h>
+#include <algorithm>
+#include <vector>
+#include <google/protobuf/stubs/once.h>
+
+#include "config.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN  // We only need minimal includes
+#include <windows.h>
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#else
+#error "No suitable threading library available."
+#endif
+
+namespace google {
+namespace protobuf {
+
+namespace {
+
+const char* const kCategoryNames[MAX_ALLOCATION_CATEGORY + 1] = {
+  "message",             // ALLOCATION_MESSAGE
+  "string",              // ALLOCATION_STRING
+  "repeated field",      // ALLOCATION_REPEATED_FIELD
+  "repeated ptr field",  // ALLOCATION_REPEATED_PTR_FIELD
+  "unknown fields",      // ALLOCATION_UNKNOWN_FIELDS
+};
+
+Allocator* allocator_ = NULL;
+
+// Each block starts with a header naming the Allocator which allocated it,
+// or NULL for operator new, so that Free() can hand it back to that one.
+// The header is as large as the most strictly aligned of the basic types,
+// so what follows it is still aligned for any type.
+union BlockHeader {
+  Allocator* owner;
+  long double aligned_long_double;
+  double aligned_double;
+  int64 aligned_int64;
+  void* aligned_pointer;
+};
+
+#ifdef GOOGLE_PROTOBUF_ALLOCATION_STATS
+
+// The counts of one thread.  Only that thread writes them, without locking.
+struct ThreadCounts {
+  AllocationStats counts[MAX_ALLOCATION_CATEGORY + 1];
+};
+
+// All the threads' counts.
+struct Registry {
+  internal::Mutex mutex;
+  std::vector<ThreadCounts*> threads;  // Threads counting.
+  ThreadCounts exited;                 // Counts of threads which exited.
+};
+
+Registry* registry_ = NULL;
+GOOGLE_PROTOBUF_DECLARE_ONCE(registry_init_);
+
+// This thread's counts, or NULL if it has not counted yet.
+GOOGLE_THREAD_LOCAL ThreadCounts* thread_counts_ = NULL;
+
+void AddCounts(const ThreadCounts& from, ThreadCounts* to) {
+  for (int i = 0; i <= MAX_ALLOCATION_CATEGORY; i++) {
+    to->counts[i].allocations += from.counts[i].allocations;
+    to->counts[i].bytes += from.counts[i].bytes;
+  }
+}
+
+#if defined(HAVE_PTHREAD) && !defined(_WIN32)
+// Moves the counts of a thread into registry_->exited when it exits.  On
+// Windows, the counts of threads which exit are kept as they are instead.
+pthread_key_t thread_exit_key_;
+
+void ThreadExited(void* thread_counts) {
+  ThreadCounts* counts = static_cast<ThreadCounts*>(thread_counts);
+  {
+    internal::MutexLock lock(&registry_->mutex);
+    AddCounts(*counts, &registry_->exited);
+    std::vector<ThreadCounts*>& threads = registry_->threads;
+    threads.erase(std::find(threads.begin(), threads.end(), counts));
+  }
+  delete counts;
+  // Whatever the thread allocates from here on is counted afresh.
+  thread_counts_ = NULL;
+}
+#endif
+
+// Like that of message_stats.cc, the registry is never deleted, not even by
+// ShutdownProtobufLibrary(): other threads may still allocate, and hold
+// their ThreadCounts in thread_counts_, after that.
+void InitRegistry() {
+  registry_ = new Registry;
+#if defined(HAVE_PTHREAD) && !defined(_WIN32)
+  pthread_key_create(&thread_exit_key_, &ThreadExited);
+#endif
+}
+
+ThreadCounts* GetThreadCounts() {
+  if (thread_counts_ == NULL) {
+    GoogleOnceInit(&registry_init_, &InitRegistry);
+    thread_counts_ = new ThreadCounts;
+    {
+      internal::MutexLock lock(&registry_->mutex);
+      registry_->threads.push_back(thread_counts_);
+    }
+#if defined(HAVE_PTHREAD) && !defined(_WIN32)
+    pthread_setspecific(thread_exit_key_, thread_counts_);
+#endif
+  }
+  return thread_counts_;
+}
+
+#endif  // GOOGLE_PROTOBUF_ALLOCATION_STATS
+
+}  // namespace
+
+const char* AllocationCategoryName(AllocationCategory category) {
+  return kCategoryNames[category];
+}
+
+Allocator::~Allocator() {}
+
+void SetAllocator(Allocator* allocator) {
+  allocator_ = allocator;
+}
+
+Allocator* GetAllocator() {
+  return allocator_;
+}
+
+bool AllocationStatsEnabled() {
+#ifdef GOOGLE_PROTOBUF_ALLOCATION_STATS
+  return true;
+#else
+  return false;
+#endif
+}
+
+AllocationStats GetAllocationStats(AllocationCategory category) {
+  AllocationStats stats;
+#ifdef GOOGLE_PROTOBUF_ALLOCATION_STATS
+  GoogleOnceInit(&registry_init_, &InitRegistry);
+  internal::MutexLock lock(&registry_->mutex);
+  stats = registry_->exited.counts[category];
+  for (int i = 0; i < registry_->threads.size(); i++) {
+    const AllocationStats& counts = registry_->threads[i]->counts[category];
+    stats.allocations += counts.allocations;
+    stats.bytes += counts.bytes;
+  }
+#endif
+  return stats;
+}
+
+namespace internal {
+
+void* Allocate(size_t size, AllocationCategory category) {
+#ifdef GOOGLE_PROTOBUF_ALLOCATION_STATS
+  CountAllocation(size, category);
+#endif
+  Allocator* owner = allocator_;
+  size += sizeof(BlockHeader);
+  BlockHeader* header = static_cast<BlockHeader*>(
+      owner == NULL ? ::operator new(size) : owner->Allocate(size, category));
+  header->owner = owner;
+  return header + 1;
+}
+
+void* AllocateNoThrow(size_t size, AllocationCategory category) {
+  try {
+    return Allocate(size, category);
+  } catch (const std::bad_alloc&) {
+    return NULL;
+  }
+}
+
+void Free(void* ptr, AllocationCategory category) {
+  if (ptr == NULL) return;
+  BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+  if (header->owner == NULL) {
+    ::operator delete(header);
+  } else {
+    header->owner->Free(header, category);
+  }
+}
+
+void CountAllocation(size_t size, AllocationCategory category) {
+#ifdef GOOGLE_PROTOBUF_ALLOCATION_STATS
+  AllocationStats* counts = &GetThreadCounts()->counts[category];
+  ++counts->allocations;
+  counts->bytes += size;
+#endif
+}
+
+}  // namespace internal
+
+}  // namespace protobuf
+}  // namespace google
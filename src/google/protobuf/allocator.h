@@ -0,0 +1,200 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Lets a program choose how the library allocates the memory of messages,
+// and counts what the library allocates, by category.  For example, to
+// allocate messages from a pool:
+//   class PoolAllocator : public Allocator {
+//    public:
+//     void* Allocate(size_t size, AllocationCategory category) { ... }
+//     void Free(void* ptr, AllocationCategory category) { ... }
+//   };
+//
+//   int main(int argc, char* argv[]) {
+//     static PoolAllocator pool_allocator;
+//     SetAllocator(&pool_allocator);
+//     ...
+//   }
+//
+// and to find out how many arrays RepeatedFields have allocated:
+//   GetAllocationStats(ALLOCATION_REPEATED_FIELD).allocations
+//
+// What goes through the Allocator:
+// * Message objects:  generated messages, including the embedded messages
+//   of message fields, and the blocks of DynamicMessages.  MessageLite has
+//   its own operator new and operator delete, so "new MyMessage" and
+//   "delete message" go through the Allocator too.
+// * The element arrays of RepeatedField and RepeatedPtrField.
+// * The contents of UnknownFieldSets.
+//
+// The std::string objects of string fields are counted (in
+// ALLOCATION_STRING) but are allocated with plain new all the same, since
+// release_foo(), RepeatedPtrField::ReleaseLast() and AddAllocated() hand
+// them to and from the caller, who deletes them or new's them with plain
+// new and delete.  The character buffers of std::strings and the buffers
+// of std::vectors are not seen at all; they come from std::allocator.
+//
+// The library remembers which Allocator allocated each block and frees it
+// through that one, so an Allocator only ever frees its own memory, even
+// if SetAllocator() was called again in between.
+//
+// Counting is only compiled in when the library is built with
+// GOOGLE_PROTOBUF_ALLOCATION_STATS defined ("./configure
+// --enable-allocation-stats", or in config.h for MSVC and C++ Builder),
+// since it costs a thread-local lookup per allocation.  Otherwise
+// GetAllocationStats() returns zeros.  Each thread counts in its own table,
+// without locking, and GetAllocationStats() adds up the tables of all
+// threads.
+
+#ifndef GOOGLE_PROTOBUF_ALLOCATOR_H__
+#define GOOGLE_PROTOBUF_ALLOCATOR_H__
+
+#include <new>
+#include <string>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+
+// What the library allocates memory for.
+enum AllocationCategory {
+  ALLOCATION_MESSAGE = 0,         // Message objects.
+  ALLOCATION_STRING = 1,          // std::string objects of string fields.
+  ALLOCATION_REPEATED_FIELD = 2,  // Element arrays of RepeatedFields.
+  ALLOCATION_REPEATED_PTR_FIELD = 3,
+                                  // Pointer arrays of RepeatedPtrFields.
+  ALLOCATION_UNKNOWN_FIELDS = 4,  // Contents of UnknownFieldSets.
+
+  MAX_ALLOCATION_CATEGORY = 4     // Constant useful for defining lookup
+                                  // tables indexed by AllocationCategory.
+};
+
+// Returns the name of the category, e.g. "repeated field" for
+// ALLOCATION_REPEATED_FIELD.
+LIBPROTOBUF_EXPORT const char* AllocationCategoryName(
+    AllocationCategory category);
+
+// Allocates and frees the memory listed above.
+class LIBPROTOBUF_EXPORT Allocator {
+ public:
+  inline Allocator() {}
+  virtual ~Allocator();
+
+  // Returns size bytes of memory, aligned for any type, like operator new.
+  // Must not return NULL; throw std::bad_alloc or abort instead.  size
+  // includes a few bytes in front of each block in which the library
+  // records the Allocator.
+  virtual void* Allocate(size_t size, AllocationCategory category) = 0;
+
+  // Frees memory returned by Allocate() of this Allocator; category is the
+  // one it was allocated in.
+  virtual void Free(void* ptr, AllocationCategory category) = 0;
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(Allocator);
+};
+
+// Makes the library allocate through allocator from now on, or through
+// operator new and operator delete if allocator is NULL (the default).
+// Does not take ownership.
+//
+// Call it at the start of main(), before other threads start:  the library
+// reads the allocator without locking.  allocator must outlive everything
+// it allocated, but need not stay installed; memory is always freed by the
+// Allocator which allocated it.
+LIBPROTOBUF_EXPORT void SetAllocator(Allocator* allocator);
+
+// Returns the allocator installed by SetAllocator(), or NULL.
+LIBPROTOBUF_EXPORT Allocator* GetAllocator();
+
+// What the library allocated in one category.
+struct LIBPROTOBUF_EXPORT AllocationStats {
+  inline AllocationStats() : allocations(0), bytes(0) {}
+
+  int64 allocations;  // Allocations made.
+  int64 bytes;        // Bytes those asked for.
+};
+
+// Returns whether the library counts allocations at all, i.e. was built
+// with GOOGLE_PROTOBUF_ALLOCATION_STATS.
+LIBPROTOBUF_EXPORT bool AllocationStatsEnabled();
+
+// Returns what the library allocated in the category since the program
+// started, in all threads, or zeros if counting is not compiled in.  Memory freed is not subtracted.  Allocations
+// made while this runs may or may not be in what it returns.
+LIBPROTOBUF_EXPORT AllocationStats GetAllocationStats(
+    AllocationCategory category);
+
+namespace internal {
+
+// Used by the library to allocate:  counts the allocation and allocates
+// through the installed Allocator, or operator new.  Free() ignores NULL.
+// AllocateNoThrow() returns NULL where Allocate() would throw
+// std::bad_alloc.
+LIBPROTOBUF_EXPORT void* Allocate(size_t size, AllocationCategory category);
+LIBPROTOBUF_EXPORT void* AllocateNoThrow(size_t size,
+                                         AllocationCategory category);
+LIBPROTOBUF_EXPORT void Free(void* ptr, AllocationCategory category);
+
+// Counts an allocation made some other way, if counting is compiled in.
+LIBPROTOBUF_EXPORT void CountAllocation(size_t size,
+                                        AllocationCategory category);
+
+// Allocates a T through Allocate().  Free it with DeleteObject() only.
+template <typename T>
+inline T* NewObject(AllocationCategory category) {
+  return new(Allocate(sizeof(T), category)) T;
+}
+
+template <typename T>
+inline void DeleteObject(T* object, AllocationCategory category) {
+  if (object != NULL) {
+    object->~T();
+    Free(object, category);
+  }
+}
+
+// Allocates the std::string of a string field with plain new, and counts
+// it; see above.
+inline std::string* NewString() {
+  CountAllocation(sizeof(std::string), ALLOCATION_STRING);
+  return new std::string;
+}
+inline std::string* NewString(const std::string& value) {
+  CountAllocation(sizeof(std::string), ALLOCATION_STRING);
+  return new std::string(value);
+}
+
+}  // namespace internal
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_ALLOCATOR_H__
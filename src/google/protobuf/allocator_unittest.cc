@@ -0,0 +1,295 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+#include <google/protobuf/allocator.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/test_util.h>
+#include <google/protobuf/unittest.pb.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+// Remembers GetAllocationStats() of all categories, to tell what was
+// counted since.
+class Snapshot {
+ public:
+  Snapshot() {
+    for (int i = 0; i <= MAX_ALLOCATION_CATEGORY; i++) {
+      stats_[i] = GetAllocationStats(static_cast<AllocationCategory>(i));
+    }
+  }
+
+  int64 Allocations(AllocationCategory category) const {
+    return GetAllocationStats(category).allocations -
+           stats_[category].allocations;
+  }
+
+  int64 Bytes(AllocationCategory category) const {
+    return GetAllocationStats(category).bytes - stats_[category].bytes;
+  }
+
+ private:
+  AllocationStats stats_[MAX_ALLOCATION_CATEGORY + 1];
+};
+
+TEST(AllocationStatsTest, CategoryNames) {
+  EXPECT_STREQ("message", AllocationCategoryName(ALLOCATION_MESSAGE));
+  EXPECT_STREQ("string", AllocationCategoryName(ALLOCATION_STRING));
+  EXPECT_STREQ("repeated field",
+               AllocationCategoryName(ALLOCATION_REPEATED_FIELD));
+  EXPECT_STREQ("repeated ptr field",
+               AllocationCategoryName(ALLOCATION_REPEATED_PTR_FIELD));
+  EXPECT_STREQ("unknown fields",
+               AllocationCategoryName(ALLOCATION_UNKNOWN_FIELDS));
+}
+
+TEST(AllocationStatsTest, CountsByCategory) {
+  Snapshot before;
+  unittest::TestAllTypes* message = new unittest::TestAllTypes;
+  message->mutable_optional_nested_message();
+  if (!AllocationStatsEnabled()) {
+    EXPECT_EQ(0, GetAllocationStats(ALLOCATION_MESSAGE).allocations);
+    delete message;
+    return;
+  }
+  EXPECT_EQ(2, before.Allocations(ALLOCATION_MESSAGE));
+  EXPECT_EQ(sizeof(unittest::TestAllTypes) +
+            sizeof(unittest::TestAllTypes::NestedMessage),
+            before.Bytes(ALLOCATION_MESSAGE));
+
+  // RepeatedFields hold 4 elements without allocating; the fifth makes them
+  // allocate room for 8.
+  for (int i = 0; i < 4; i++) message->add_repeated_int32(i);
+  EXPECT_EQ(0, before.Allocations(ALLOCATION_REPEATED_FIELD));
+  message->add_repeated_int32(4);
+  EXPECT_EQ(1, before.Allocations(ALLOCATION_REPEATED_FIELD));
+  EXPECT_EQ(8 * sizeof(int32), before.Bytes(ALLOCATION_REPEATED_FIELD));
+
+  message->set_optional_string("foo");
+  for (int i = 0; i < 5; i++) message->add_repeated_string("bar");
+  EXPECT_EQ(6, before.Allocations(ALLOCATION_STRING));
+  EXPECT_EQ(6 * sizeof(std::string), before.Bytes(ALLOCATION_STRING));
+  EXPECT_EQ(1, before.Allocations(ALLOCATION_REPEATED_PTR_FIELD));
+  EXPECT_EQ(8 * sizeof(void*), before.Bytes(ALLOCATION_REPEATED_PTR_FIELD));
+
+  // Clearing keeps the memory, so filling again allocates nothing.
+  message->Clear();
+  Snapshot cleared;
+  message->set_optional_string("foo");
+  for (int i = 0; i < 5; i++) message->add_repeated_int32(i);
+  for (int i = 0; i < 5; i++) message->add_repeated_string("bar");
+  for (int i = 0; i <= MAX_ALLOCATION_CATEGORY; i++) {
+    EXPECT_EQ(0, cleared.Allocations(static_cast<AllocationCategory>(i)));
+  }
+
+  // An unknown int32 makes the UnknownFieldSet allocate its vector, and an
+  // unknown string its std::string as well.
+  unittest::TestAllTypes fields;
+  fields.set_optional_int32(1);
+  fields.set_optional_string("foo");
+  std::string data = fields.SerializeAsString();
+  unittest::TestEmptyMessage empty;
+  Snapshot parsing;
+  ASSERT_TRUE(empty.ParseFromString(data));
+  EXPECT_EQ(2, parsing.Allocations(ALLOCATION_UNKNOWN_FIELDS));
+  EXPECT_EQ(sizeof(std::vector<UnknownField>) + sizeof(std::string),
+            parsing.Bytes(ALLOCATION_UNKNOWN_FIELDS));
+
+  // Nothing counts frees.
+  Snapshot deleting;
+  delete message;
+  for (int i = 0; i <= MAX_ALLOCATION_CATEGORY; i++) {
+    EXPECT_EQ(0, deleting.Allocations(static_cast<AllocationCategory>(i)));
+  }
+}
+
+// Allocates with operator new, and remembers what it allocated.
+class TestAllocator : public Allocator {
+ public:
+  TestAllocator() : foreign_frees_(0) {
+    for (int i = 0; i <= MAX_ALLOCATION_CATEGORY; i++) allocations_[i] = 0;
+  }
+
+  virtual void* Allocate(size_t size, AllocationCategory category) {
+    void* ptr = ::operator new(size);
+    live_[ptr] = category;
+    ++allocations_[category];
+    return ptr;
+  }
+
+  virtual void Free(void* ptr, AllocationCategory category) {
+    std::map<void*, AllocationCategory>::iterator it = live_.find(ptr);
+    if (it == live_.end()) {
+      ++foreign_frees_;
+    } else {
+      EXPECT_EQ(it->second, category);
+      live_.erase(it);
+    }
+    ::operator delete(ptr);
+  }
+
+  int allocations_[MAX_ALLOCATION_CATEGORY + 1];
+  std::map<void*, AllocationCategory> live_;
+  int foreign_frees_;
+};
+
+class AllocatorTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    // Build the descriptors first, so that the DescriptorPool does not
+    // allocate what it keeps through allocator_.
+    unittest::TestAllTypes::descriptor();
+    SetAllocator(&allocator_);
+  }
+
+  virtual void TearDown() {
+    // What allocator_ allocated is still freed through it, so the tests
+    // free all of it before allocator_ goes away.
+    SetAllocator(NULL);
+    EXPECT_TRUE(allocator_.live_.empty());
+  }
+
+  TestAllocator allocator_;
+};
+
+TEST_F(AllocatorTest, AllocatesThroughAllocator) {
+  EXPECT_EQ(&allocator_, GetAllocator());
+  {
+    unittest::TestAllTypes* message = new unittest::TestAllTypes;
+    TestUtil::SetAllFields(message);
+    for (int i = 0; i < 10; i++) {
+      message->add_repeated_int32(i);
+      message->add_repeated_nested_message()->set_bb(i);
+    }
+    unittest::TestEmptyMessage empty;
+    ASSERT_TRUE(empty.ParseFromString(message->SerializeAsString()));
+
+    DynamicMessageFactory factory;
+    Message* dynamic =
+        factory.GetPrototype(unittest::TestAllTypes::descriptor())->New();
+    dynamic->CopyFrom(*message);
+    delete dynamic;
+    delete message;
+
+    unittest::TestAllTypes* nothrow = new(std::nothrow) unittest::TestAllTypes;
+    ASSERT_TRUE(nothrow != NULL);
+    delete nothrow;
+  }
+
+  EXPECT_GT(allocator_.allocations_[ALLOCATION_MESSAGE], 0);
+  EXPECT_GT(allocator_.allocations_[ALLOCATION_REPEATED_FIELD], 0);
+  EXPECT_GT(allocator_.allocations_[ALLOCATION_REPEATED_PTR_FIELD], 0);
+  EXPECT_GT(allocator_.allocations_[ALLOCATION_UNKNOWN_FIELDS], 0);
+  // Strings are only counted.
+  EXPECT_EQ(0, allocator_.allocations_[ALLOCATION_STRING]);
+
+  // Everything was freed, through the allocator.
+  EXPECT_TRUE(allocator_.live_.empty());
+  EXPECT_EQ(0, allocator_.foreign_frees_);
+}
+
+TEST_F(AllocatorTest, FreesThroughAllocatorWhichAllocated) {
+  // What operator new allocated goes back to operator delete.
+  SetAllocator(NULL);
+  unittest::TestAllTypes* message = new unittest::TestAllTypes;
+  message->mutable_optional_nested_message();
+  SetAllocator(&allocator_);
+  delete message;
+  EXPECT_EQ(0, allocator_.foreign_frees_);
+
+  // And what allocator_ allocated goes back to it.
+  message = new unittest::TestAllTypes;
+  message->add_repeated_nested_message();
+  EXPECT_FALSE(allocator_.live_.empty());
+  SetAllocator(NULL);
+  delete message;
+  EXPECT_TRUE(allocator_.live_.empty());
+  EXPECT_EQ(0, allocator_.foreign_frees_);
+}
+
+// Allocates 1000 TestAllTypes.
+#ifdef _WIN32
+DWORD WINAPI AllocateMessages(LPVOID) {
+#else
+void* AllocateMessages(void*) {
+#endif
+  for (int i = 0; i < 1000; i++) {
+    delete new unittest::TestAllTypes;
+  }
+  return 0;
+}
+
+TEST(AllocationStatsTest, AddsUpThreads) {
+  if (!AllocationStatsEnabled()) return;
+  Snapshot before;
+
+  const int kThreads = 4;
+#ifdef _WIN32
+  HANDLE threads[kThreads];
+  for (int i = 0; i < kThreads; i++) {
+    threads[i] = CreateThread(NULL, 0, &AllocateMessages, NULL, 0, NULL);
+  }
+  for (int i = 0; i < kThreads; i++) {
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+  }
+#else
+  pthread_t threads[kThreads];
+  for (int i = 0; i < kThreads; i++) {
+    pthread_create(&threads[i], NULL, &AllocateMessages, NULL);
+  }
+  for (int i = 0; i < kThreads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+#endif
+
+  // The threads have exited, but their counts remain.
+  EXPECT_EQ(kThreads * 1000, before.Allocations(ALLOCATION_MESSAGE));
+  EXPECT_EQ(kThreads * 1000 * sizeof(unittest::TestAllTypes),
+            before.Bytes(ALLOCATION_MESSAGE));
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
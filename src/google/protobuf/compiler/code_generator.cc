@@ -42,6 +42,12 @@ namespace protobuf {
 namespace compiler {
 
 CodeGenerator::~CodeGenerator() {}
+
+bool CodeGenerator::AppendCacheKey(const std::string& parameter,
+                                   std::string* key) const {
+  return true;
+}
+
 GeneratorContext::~GeneratorContext() {}
 
 io::ZeroCopyOutputStream* GeneratorContext::OpenForInsert(
@@ -79,6 +79,15 @@ class LIBPROTOC_EXPORT CodeGenerator {
                         GeneratorContext* generator_context,
                         std::string* error) const = 0;
 
+  // Appends to *key whatever the output of Generate() with the given
+  // parameter depends on, other than the .proto files, the parameter itself
+  // and the generator's own code:  the contents of a file the parameter
+  // names, say.  protoc's --cache_dir keeps that output under a key which
+  // includes it.  Returns false if the output must not be cached at all.
+  // The default appends nothing and returns true.
+  virtual bool AppendCacheKey(const std::string& parameter,
+                              std::string* key) const;
+
  private:
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(CodeGenerator);
 };
@@ -41,26 +41,36 @@
 #ifdef _WIN32
 #include <io.h>
 #include <direct.h>
+#include <process.h>
+#include <windows.h>
 #else
 #include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
 #endif
 #include <errno.h>
 #include <iostream>
 #include <ctype.h>
+#include <algorithm>
 
 #include <google/protobuf/stubs/hash.h>
 
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/once.h>
 #include <google/protobuf/compiler/importer.h>
+#include <google/protobuf/compiler/parser.h>
 #include <google/protobuf/compiler/code_generator.h>
 #include <google/protobuf/compiler/plugin.pb.h>
+#include <google/protobuf/compiler/plugin_server.h>
 #include <google/protobuf/compiler/subprocess.h>
 #include <google/protobuf/compiler/zip_writer.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/io/printer.h>
+#include <google/protobuf/io/tokenizer.h>
 #include <google/protobuf/stubs/strutil.h>
 #include <google/protobuf/stubs/substitute.h>
 #include <google/protobuf/stubs/map-util.h>
@@ -181,6 +191,230 @@ bool TryCreateParentDirectory(const std::string& prefix, const std::string& file
   return true;
 }
 
+struct ThreadStart {
+  void (*function)(void*);
+  void* arg;
+};
+
+// Calls function(arg) on num_threads threads, one of which is the calling
+// thread, and returns once all of them have returned.
+#ifdef _WIN32
+unsigned __stdcall ThreadMain(void* start) {
+  ThreadStart* thread_start = reinterpret_cast<ThreadStart*>(start);
+  thread_start->function(thread_start->arg);
+  return 0;
+}
+
+void RunOnThreads(int num_threads, void (*function)(void*), void* arg) {
+  ThreadStart start = { function, arg };
+  std::vector<HANDLE> threads;
+  for (int i = 1; i < num_threads; i++) {
+    uintptr_t thread = _beginthreadex(NULL, 0, &ThreadMain, &start, 0, NULL);
+    if (thread == 0) break;  // Make do with the threads we have.
+    threads.push_back(reinterpret_cast<HANDLE>(thread));
+  }
+  function(arg);
+  for (int i = 0; i < threads.size(); i++) {
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+  }
+}
+#else
+void* ThreadMain(void* start) {
+  ThreadStart* thread_start = reinterpret_cast<ThreadStart*>(start);
+  thread_start->function(thread_start->arg);
+  return NULL;
+}
+
+void RunOnThreads(int num_threads, void (*function)(void*), void* arg) {
+  ThreadStart start = { function, arg };
+  std::vector<pthread_t> threads;
+  for (int i = 1; i < num_threads; i++) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, &ThreadMain, &start) != 0) break;
+    threads.push_back(thread);
+  }
+  function(arg);
+  for (int i = 0; i < threads.size(); i++) {
+    pthread_join(threads[i], NULL);
+  }
+}
+#endif
+
+#ifndef _WIN32
+// The server run by --serve_plugins, for ShutDownServer().
+PluginServer* server_to_shut_down = NULL;
+
+// Signal handler.  PluginServer::Shutdown() only writes to a pipe, so it is
+// safe to call here.
+void ShutDownServer(int signal) {
+  if (server_to_shut_down != NULL) {
+    server_to_shut_down->Shutdown();
+  }
+}
+#endif
+
+// Reads the whole file into *contents.  Returns false if the file could not
+// be opened or read.
+bool ReadFileToString(const std::string& filename, std::string* contents) {
+  int file_descriptor;
+  do {
+    file_descriptor = open(filename.c_str(), O_RDONLY | O_BINARY);
+  } while (file_descriptor < 0 && errno == EINTR);
+  if (file_descriptor < 0) return false;
+
+  io::FileInputStream input(file_descriptor);
+  contents->clear();
+  const void* data;
+  int size;
+  while (input.Next(&data, &size)) {
+    contents->append(reinterpret_cast<const char*>(data), size);
+  }
+  bool success = input.GetErrno() == 0;
+  input.Close();
+  return success;
+}
+
+// Files in the --cache_dir directory are named by a hash of their key and
+// hold the full key followed by the value, so a hash collision costs no
+// more than a cache miss.  Entries are never modified once written.
+std::string CacheEntryFilename(const std::string& cache_dir,
+                               const std::string& key) {
+  // 64-bit FNV-1a.
+  uint64 hash = GOOGLE_ULONGLONG(14695981039346656037);
+  for (int i = 0; i < key.size(); i++) {
+    hash ^= static_cast<uint8>(key[i]);
+    hash *= GOOGLE_ULONGLONG(1099511628211);
+  }
+  char buffer[kFastToBufferSize];
+  return cache_dir + FastHex64ToBuffer(hash, buffer);
+}
+
+bool ReadCacheEntry(const std::string& cache_dir, const std::string& key,
+                    std::string* value) {
+  std::string contents;
+  if (!ReadFileToString(CacheEntryFilename(cache_dir, key), &contents)) {
+    return false;
+  }
+
+  io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(contents.data()), contents.size());
+  uint32 key_size;
+  if (!input.ReadVarint32(&key_size)) return false;
+  std::string::size_type key_start =
+      io::CodedOutputStream::VarintSize32(key_size);
+  if (contents.size() - key_start < key_size ||
+      contents.compare(key_start, key_size, key) != 0) {
+    return false;
+  }
+  value->assign(contents, key_start + key_size, std::string::npos);
+  return true;
+}
+
+// Numbers the temporary files of WriteCacheEntry() within this process.
+Mutex* temp_file_count_mutex_ = NULL;
+int temp_file_count_ = 0;
+GOOGLE_PROTOBUF_DECLARE_ONCE(temp_file_count_init_);
+
+void DeleteTempFileCount() {
+  delete temp_file_count_mutex_;
+  temp_file_count_mutex_ = NULL;
+}
+void InitTempFileCount() {
+  temp_file_count_mutex_ = new Mutex;
+  internal::OnShutdown(&DeleteTempFileCount);
+}
+
+// Returns a name for a temporary file next to "filename" which no other
+// thread or process is using.
+std::string TempFilename(const std::string& filename) {
+  GoogleOnceInit(&temp_file_count_init_, &InitTempFileCount);
+  int count;
+  {
+    MutexLock lock(temp_file_count_mutex_);
+    count = temp_file_count_++;
+  }
+  return filename + ".tmp" + SimpleItoa(static_cast<int>(getpid())) + "-" +
+         SimpleItoa(count);
+}
+
+// Renames "from" to "to", replacing "to" if it exists, which rename() does
+// not do on Windows.
+bool RenameReplacing(const std::string& from, const std::string& to) {
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+// Failing to write an entry is not an error; the next run will simply miss.
+void WriteCacheEntry(const std::string& cache_dir, const std::string& key,
+                     const std::string& value) {
+  std::string contents;
+  {
+    io::StringOutputStream output(&contents);
+    io::CodedOutputStream coded_output(&output);
+    coded_output.WriteVarint32(key.size());
+    coded_output.WriteString(key);
+    coded_output.WriteString(value);
+  }
+
+  // Write to a temporary file and rename it into place, so that a concurrent
+  // protoc never sees a partial entry.  The temporary file's name is unique
+  // to this call; O_TRUNC takes care of one left behind by a crashed run
+  // which had the same process ID.
+  std::string filename = CacheEntryFilename(cache_dir, key);
+  std::string temp_filename = TempFilename(filename);
+  int file_descriptor;
+  do {
+    file_descriptor = open(temp_filename.c_str(),
+                           O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0666);
+  } while (file_descriptor < 0 && errno == EINTR);
+  if (file_descriptor < 0) return;
+
+  io::FileOutputStream output(file_descriptor);
+  bool success;
+  {
+    io::CodedOutputStream coded_output(&output);
+    coded_output.WriteString(contents);
+    success = !coded_output.HadError();
+  }
+  success = output.Close() && success;
+
+  if (!success || !RenameReplacing(temp_filename, filename)) {
+    remove(temp_filename.c_str());
+  }
+}
+
+// Collects the errors of an attempt whose errors are not reported, so that
+// we can tell whether it succeeded.
+class SilentErrorCollector : public io::ErrorCollector,
+                             public DescriptorPool::ErrorCollector {
+ public:
+  SilentErrorCollector() : had_errors_(false) {}
+  ~SilentErrorCollector() {}
+
+  bool had_errors() const { return had_errors_; }
+
+  // implements io::ErrorCollector -----------------------------------
+  void AddError(int line, int column, const std::string& message) {
+    had_errors_ = true;
+  }
+
+  // implements DescriptorPool::ErrorCollector -----------------------
+  void AddError(const std::string& filename,
+                const std::string& element_name,
+                const Message* descriptor,
+                ErrorLocation location,
+                const std::string& message) {
+    had_errors_ = true;
+  }
+
+ private:
+  bool had_errors_;
+};
+
 }  // namespace
 
 // A MultiFileErrorCollector that prints errors to stderr.
@@ -242,8 +476,10 @@ class CommandLineInterface::GeneratorContextImpl : public GeneratorContext {
   ~GeneratorContextImpl();
 
   // Write all files in the directory to disk at the given output location,
-  // which must end in a '/'.
-  bool WriteAllToDisk(const std::string& prefix);
+  // which must end in a '/'.  If skip_unchanged is true, files which already
+  // have the right contents are not rewritten, so their modification times
+  // do not change.
+  bool WriteAllToDisk(const std::string& prefix, bool skip_unchanged);
 
   // Write the contents of this directory to a ZIP-format archive with the
   // given name.
@@ -310,7 +546,7 @@ CommandLineInterface::GeneratorContextImpl::~GeneratorContextImpl() {
 }
 
 bool CommandLineInterface::GeneratorContextImpl::WriteAllToDisk(
-    const std::string& prefix) {
+    const std::string& prefix, bool skip_unchanged) {
   if (had_error_) {
     return false;
   }
@@ -330,6 +566,14 @@ bool CommandLineInterface::GeneratorContextImpl::WriteAllToDisk(
     }
     std::string filename = prefix + relative_filename;
 
+    if (skip_unchanged) {
+      std::string old_contents;
+      if (ReadFileToString(filename, &old_contents) &&
+          old_contents == *iter->second) {
+        continue;
+      }
+    }
+
     // Create the output file.
     int file_descriptor;
     do {
@@ -564,6 +808,269 @@ CommandLineInterface::MemoryOutputStream::~MemoryOutputStream() {
   }
 }
 
+// -------------------------------------------------------------------
+
+// A GeneratorContext which records everything written to it, so that it can
+// be filled by one thread and later copied into the real GeneratorContextImpl
+// by another.
+class CommandLineInterface::BufferedGeneratorContext : public GeneratorContext {
+ public:
+  BufferedGeneratorContext(
+      const std::vector<const FileDescriptor*>& parsed_files);
+  ~BufferedGeneratorContext();
+
+  // Writes everything to target, in the order the streams were closed.
+  void WriteTo(GeneratorContext* target);
+
+  // Convert everything written so far to a std::string and back, for
+  // --cache_dir.  ParseFromString() replaces the current contents and
+  // returns false if the data is malformed.
+  void SerializeToString(std::string* output) const;
+  bool ParseFromString(const std::string& data);
+
+  // implements GeneratorContext --------------------------------------
+  io::ZeroCopyOutputStream* Open(const std::string& filename);
+  io::ZeroCopyOutputStream* OpenForInsert(
+      const std::string& filename, const std::string& insertion_point);
+  void ListParsedFiles(std::vector<const FileDescriptor*>* output) {
+    *output = parsed_files_;
+  }
+
+ private:
+  friend class BufferedOutputStream;
+
+  struct Output {
+    std::string filename;
+    std::string insertion_point;  // Empty for Open().
+    std::string data;
+  };
+
+  std::vector<Output*> outputs_;
+  const std::vector<const FileDescriptor*>& parsed_files_;
+};
+
+class CommandLineInterface::BufferedOutputStream
+    : public io::ZeroCopyOutputStream {
+ public:
+  BufferedOutputStream(BufferedGeneratorContext* context,
+                       const std::string& filename,
+                       const std::string& insertion_point);
+  virtual ~BufferedOutputStream();
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  virtual bool Next(void** data, int* size) { return inner_->Next(data, size); }
+  virtual void BackUp(int count)            {        inner_->BackUp(count);    }
+  virtual int64 ByteCount() const           { return inner_->ByteCount();      }
+
+ private:
+  BufferedGeneratorContext* context_;
+  BufferedGeneratorContext::Output* output_;
+  scoped_ptr<io::StringOutputStream> inner_;
+};
+
+CommandLineInterface::BufferedGeneratorContext::BufferedGeneratorContext(
+    const std::vector<const FileDescriptor*>& parsed_files)
+    : parsed_files_(parsed_files) {
+}
+
+CommandLineInterface::BufferedGeneratorContext::~BufferedGeneratorContext() {
+  STLDeleteElements(&outputs_);
+}
+
+void CommandLineInterface::BufferedGeneratorContext::WriteTo(
+    GeneratorContext* target) {
+  for (int i = 0; i < outputs_.size(); i++) {
+    const Output& output = *outputs_[i];
+    scoped_ptr<io::ZeroCopyOutputStream> stream(
+        output.insertion_point.empty()
+            ? target->Open(output.filename)
+            : target->OpenForInsert(output.filename, output.insertion_point));
+    io::CodedOutputStream coded_stream(stream.get());
+    coded_stream.WriteString(output.data);
+  }
+}
+
+void CommandLineInterface::BufferedGeneratorContext::SerializeToString(
+    std::string* output) const {
+  output->clear();
+  io::StringOutputStream stream(output);
+  io::CodedOutputStream coded_stream(&stream);
+  coded_stream.WriteVarint32(outputs_.size());
+  for (int i = 0; i < outputs_.size(); i++) {
+    const Output& output = *outputs_[i];
+    coded_stream.WriteVarint32(output.filename.size());
+    coded_stream.WriteString(output.filename);
+    coded_stream.WriteVarint32(output.insertion_point.size());
+    coded_stream.WriteString(output.insertion_point);
+    coded_stream.WriteVarint32(output.data.size());
+    coded_stream.WriteString(output.data);
+  }
+}
+
+bool CommandLineInterface::BufferedGeneratorContext::ParseFromString(
+    const std::string& data) {
+  STLDeleteElements(&outputs_);
+
+  io::CodedInputStream coded_stream(
+      reinterpret_cast<const uint8*>(data.data()), data.size());
+  coded_stream.SetTotalBytesLimit(kint32max, -1);
+  uint32 count;
+  if (!coded_stream.ReadVarint32(&count)) return false;
+  for (uint32 i = 0; i < count; i++) {
+    Output* output = new Output;
+    outputs_.push_back(output);
+    uint32 size;
+    if (!coded_stream.ReadVarint32(&size) ||
+        !coded_stream.ReadString(&output->filename, size) ||
+        !coded_stream.ReadVarint32(&size) ||
+        !coded_stream.ReadString(&output->insertion_point, size) ||
+        !coded_stream.ReadVarint32(&size) ||
+        !coded_stream.ReadString(&output->data, size)) {
+      STLDeleteElements(&outputs_);
+      return false;
+    }
+  }
+  return true;
+}
+
+io::ZeroCopyOutputStream* CommandLineInterface::BufferedGeneratorContext::Open(
+    const std::string& filename) {
+  return new BufferedOutputStream(this, filename, "");
+}
+
+io::ZeroCopyOutputStream*
+CommandLineInterface::BufferedGeneratorContext::OpenForInsert(
+    const std::string& filename, const std::string& insertion_point) {
+  return new BufferedOutputStream(this, filename, insertion_point);
+}
+
+CommandLineInterface::BufferedOutputStream::BufferedOutputStream(
+    BufferedGeneratorContext* context, const std::string& filename,
+    const std::string& insertion_point)
+    : context_(context),
+      output_(new BufferedGeneratorContext::Output) {
+  output_->filename = filename;
+  output_->insertion_point = insertion_point;
+  inner_.reset(new io::StringOutputStream(&output_->data));
+}
+
+CommandLineInterface::BufferedOutputStream::~BufferedOutputStream() {
+  // Make sure all data has been written.
+  inner_.reset();
+  context_->outputs_.push_back(output_);
+}
+
+// -------------------------------------------------------------------
+
+// Like Importer, but keeps the FileDescriptorProto parsed from each .proto
+// file in the --cache_dir directory, keyed by the file's name and contents,
+// so that later runs decode it instead of parsing the file again.  Reports
+// no errors; Run() parses again with an Importer if anything fails.
+class CommandLineInterface::CachingImporter : public DescriptorDatabase {
+ public:
+  CachingImporter(SourceTree* source_tree, const std::string& cache_dir);
+  ~CachingImporter();
+
+  const DescriptorPool* pool() const { return &pool_; }
+
+  // implements DescriptorDatabase -----------------------------------
+  bool FindFileByName(const std::string& filename,
+                      FileDescriptorProto* output);
+  bool FindFileContainingSymbol(const std::string& symbol_name,
+                                FileDescriptorProto* output) {
+    return false;
+  }
+  bool FindFileContainingExtension(const std::string& containing_type,
+                                   int field_number,
+                                   FileDescriptorProto* output) {
+    return false;
+  }
+
+ private:
+  SourceTree* source_tree_;
+  std::string cache_dir_;
+  SilentErrorCollector validation_error_collector_;
+  DescriptorPool pool_;
+};
+
+CommandLineInterface::CachingImporter::CachingImporter(
+    SourceTree* source_tree, const std::string& cache_dir)
+    : source_tree_(source_tree),
+      cache_dir_(cache_dir),
+      pool_(this, &validation_error_collector_) {
+}
+
+CommandLineInterface::CachingImporter::~CachingImporter() {}
+
+bool CommandLineInterface::CachingImporter::FindFileByName(
+    const std::string& filename, FileDescriptorProto* output) {
+  scoped_ptr<io::ZeroCopyInputStream> input(source_tree_->Open(filename));
+  if (input == NULL) return false;
+
+  // The parser's output depends only on its version and the file.
+  std::string key = "parse\n";
+  key += protobuf::internal::VersionString(GOOGLE_PROTOBUF_VERSION);
+  key += '\n';
+  key += filename;
+  key += '\0';
+  std::string::size_type contents_start = key.size();
+  const void* data;
+  int size;
+  while (input->Next(&data, &size)) {
+    key.append(reinterpret_cast<const char*>(data), size);
+  }
+  input.reset();
+
+  std::string value;
+  if (ReadCacheEntry(cache_dir_, key, &value) &&
+      output->ParseFromString(value) && output->name() == filename) {
+    return true;
+  }
+  output->Clear();
+
+  // Parse the copy of the file we just hashed, so that the entry matches its
+  // key even if the file changes under us.
+  io::ArrayInputStream contents(key.data() + contents_start,
+                                key.size() - contents_start);
+  SilentErrorCollector error_collector;
+  io::Tokenizer tokenizer(&contents, &error_collector);
+  Parser parser;
+  parser.RecordErrorsTo(&error_collector);
+  output->set_name(filename);
+  if (!parser.Parse(&tokenizer, output) || error_collector.had_errors()) {
+    return false;
+  }
+
+  WriteCacheEntry(cache_dir_, key, output->SerializeAsString());
+  return true;
+}
+
+// -------------------------------------------------------------------
+
+// One call to RunGenerator() made by GenerateOutputInParallel().
+struct CommandLineInterface::GenerationTask {
+  int directive_index;
+  int file_index;
+  BufferedGeneratorContext* output;
+  bool success;
+  std::string error;
+};
+
+// The tasks of GenerateOutputInParallel() and which one to run next.
+struct CommandLineInterface::GenerationQueue {
+  CommandLineInterface* cli;
+  const std::vector<const FileDescriptor*>* parsed_files;
+  std::vector<GenerationTask>* tasks;
+
+  Mutex mutex;
+  int next_task;  // Under mutex.
+
+  // Plugins run one at a time:  child processes started at the same time
+  // would inherit each other's pipes, so a plugin might never see the end of
+  // its input.
+  Mutex plugin_mutex;
+};
+
 // ===================================================================
 
 CommandLineInterface::CommandLineInterface()
@@ -571,7 +1078,8 @@ CommandLineInterface::CommandLineInterface()
     error_format_(ERROR_FORMAT_GCC),
     imports_in_descriptor_set_(false),
     disallow_services_(false),
-    inputs_are_proto_path_relative_(false) {}
+    inputs_are_proto_path_relative_(false),
+    jobs_(1) {}
 CommandLineInterface::~CommandLineInterface() {}
 
 void CommandLineInterface::RegisterGenerator(const std::string& flag_name,
@@ -591,6 +1099,10 @@ int CommandLineInterface::Run(int argc, const char* const argv[]) {
   Clear();
   if (!ParseArguments(argc, argv)) return 1;
 
+  if (mode_ == MODE_SERVE_PLUGINS) {
+    return ServePlugins() ? 0 : 1;
+  }
+
   // Set up the source tree.
   DiskSourceTree source_tree;
   for (int i = 0; i < proto_path_.size(); i++) {
@@ -604,23 +1116,41 @@ int CommandLineInterface::Run(int argc, const char* const argv[]) {
     }
   }
 
-  // Allocate the Importer.
+  if (!VerifyDirectoryExists(cache_dir_)) {
+    return 1;
+  }
+
+  // Parse each file.  With --cache_dir, we first try a CachingImporter,
+  // which reports no errors.  If that fails we start over with a normal
+  // Importer, so that errors are reported exactly as they would be without
+  // the cache, line numbers included.
   ErrorPrinter error_collector(error_format_, &source_tree);
-  Importer importer(&source_tree, &error_collector);
+  scoped_ptr<CachingImporter> caching_importer;
+  scoped_ptr<Importer> importer;
+  const DescriptorPool* pool = NULL;
 
   std::vector<const FileDescriptor*> parsed_files;
 
-  // Parse each file.
-  for (int i = 0; i < input_files_.size(); i++) {
-    // Import the file.
-    const FileDescriptor* parsed_file = importer.Import(input_files_[i]);
-    if (parsed_file == NULL) return 1;
-    parsed_files.push_back(parsed_file);
-
-    // Enforce --disallow_services.
-    if (disallow_services_ && parsed_file->service_count() > 0) {
-      std::cerr << parsed_file->name() << ": This file contains services, but "
-              "--disallow_services was used." << std::endl;
+  if (!cache_dir_.empty()) {
+    caching_importer.reset(new CachingImporter(&source_tree, cache_dir_));
+    pool = caching_importer->pool();
+    if (!ImportInputFiles(pool, &parsed_files)) {
+      parsed_files.clear();
+      caching_importer.reset();
+      pool = NULL;
+    }
+  }
+  if (pool == NULL) {
+    importer.reset(new Importer(&source_tree, &error_collector));
+    pool = importer->pool();
+    if (!ImportInputFiles(pool, &parsed_files)) return 1;
+  }
+
+  // Enforce --disallow_services.
+  for (int i = 0; i < parsed_files.size(); i++) {
+    if (disallow_services_ && parsed_files[i]->service_count() > 0) {
+      std::cerr << parsed_files[i]->name() << ": This file contains services, "
+              "but --disallow_services was used." << std::endl;
       return 1;
     }
   }
@@ -633,6 +1163,7 @@ int CommandLineInterface::Run(int argc, const char* const argv[]) {
 
   // Generate output.
   if (mode_ == MODE_COMPILE) {
+    std::vector<GeneratorContext*> generator_contexts;
     for (int i = 0; i < output_directives_.size(); i++) {
       std::string output_location = output_directives_[i].output_location;
       if (!protobuf::HasSuffixString(output_location, ".zip") &&
@@ -645,11 +1176,22 @@ int CommandLineInterface::Run(int argc, const char* const argv[]) {
         // First time we've seen this output location.
         *map_slot = new GeneratorContextImpl(parsed_files);
       }
+      generator_contexts.push_back(*map_slot);
+    }
 
-      if (!GenerateOutput(parsed_files, output_directives_[i], *map_slot)) {
+    if (jobs_ > 1 || !cache_dir_.empty()) {
+      if (!GenerateOutputInParallel(parsed_files, generator_contexts)) {
         STLDeleteValues(&output_directories);
         return 1;
       }
+    } else {
+      for (int i = 0; i < output_directives_.size(); i++) {
+        if (!GenerateOutput(parsed_files, output_directives_[i],
+                            generator_contexts[i])) {
+          STLDeleteValues(&output_directories);
+          return 1;
+        }
+      }
     }
   }
 
@@ -659,7 +1201,7 @@ int CommandLineInterface::Run(int argc, const char* const argv[]) {
     const std::string& location = iter->first;
     GeneratorContextImpl* directory = iter->second;
     if (protobuf::HasSuffixString(location, "/")) {
-      if (!directory->WriteAllToDisk(location)) {
+      if (!directory->WriteAllToDisk(location, !cache_dir_.empty())) {
         STLDeleteValues(&output_directories);
         return 1;
       }
@@ -696,7 +1238,7 @@ int CommandLineInterface::Run(int argc, const char* const argv[]) {
         return 1;
       }
     } else {
-      if (!EncodeOrDecode(importer.pool())) {
+      if (!EncodeOrDecode(pool)) {
         return 1;
       }
     }
@@ -718,6 +1260,20 @@ void CommandLineInterface::Clear() {
   mode_ = MODE_COMPILE;
   imports_in_descriptor_set_ = false;
   disallow_services_ = false;
+  jobs_ = 1;
+  cache_dir_.clear();
+  plugin_server_.clear();
+}
+
+bool CommandLineInterface::ImportInputFiles(
+    const DescriptorPool* pool,
+    std::vector<const FileDescriptor*>* parsed_files) {
+  for (int i = 0; i < input_files_.size(); i++) {
+    const FileDescriptor* parsed_file = pool->FindFileByName(input_files_[i]);
+    if (parsed_file == NULL) return false;
+    parsed_files->push_back(parsed_file);
+  }
+  return true;
 }
 
 bool CommandLineInterface::MakeInputsBeProtoPathRelative(
@@ -790,6 +1346,20 @@ bool CommandLineInterface::ParseArguments(int argc, const char* const argv[]) {
 
   // Check some errror cases.
   bool decoding_raw = (mode_ == MODE_DECODE) && codec_type_.empty();
+  if (mode_ == MODE_SERVE_PLUGINS) {
+    if (!input_files_.empty() || !output_directives_.empty() ||
+        !descriptor_set_name_.empty()) {
+      std::cerr << "When using --serve_plugins, no input files or output "
+                   "directives should be given." << std::endl;
+      return false;
+    }
+    if (plugins_.empty()) {
+      std::cerr << "--serve_plugins requires the plugins to serve to be "
+                   "given with --plugin." << std::endl;
+      return false;
+    }
+    return true;
+  }
   if (decoding_raw && !input_files_.empty()) {
     std::cerr << "When using --decode_raw, no input files should be given." << std::endl;
     return false;
@@ -956,6 +1526,28 @@ bool CommandLineInterface::InterpretArgument(const std::string& name,
   } else if (name == "--disallow_services") {
     disallow_services_ = true;
 
+  } else if (name == "-j" || name == "--jobs") {
+    char* end;
+    long jobs = strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || jobs < 1 || jobs > 1024) {
+      std::cerr << name << " requires a number of jobs between 1 and 1024."
+                << std::endl;
+      return false;
+    }
+    jobs_ = jobs;
+
+  } else if (name == "--cache_dir") {
+    if (!cache_dir_.empty()) {
+      std::cerr << name << " may only be passed once." << std::endl;
+      return false;
+    }
+    if (value.empty()) {
+      std::cerr << name << " requires a non-empty value." << std::endl;
+      return false;
+    }
+    cache_dir_ = value;
+    AddTrailingSlash(&cache_dir_);
+
   } else if (name == "--encode" || name == "--decode" ||
              name == "--decode_raw") {
     if (mode_ != MODE_COMPILE) {
@@ -1019,6 +1611,30 @@ bool CommandLineInterface::InterpretArgument(const std::string& name,
 
     plugins_[name] = path;
 
+  } else if (name == "--plugin_server" || name == "--serve_plugins") {
+    if (plugin_prefix_.empty()) {
+      std::cerr << "This compiler does not support plugins." << std::endl;
+      return false;
+    }
+    if (!plugin_server_.empty()) {
+      std::cerr << "Only one of --plugin_server and --serve_plugins can be "
+                   "given, and only once." << std::endl;
+      return false;
+    }
+    if (value.empty()) {
+      std::cerr << name << " requires a non-empty value." << std::endl;
+      return false;
+    }
+    if (name == "--serve_plugins") {
+      if (mode_ != MODE_COMPILE) {
+        std::cerr << "Cannot use --encode or --decode and --serve_plugins at "
+                     "the same time." << std::endl;
+        return false;
+      }
+      mode_ = MODE_SERVE_PLUGINS;
+    }
+    plugin_server_ = value;
+
   } else {
     // Some other flag.  Look it up in the generators list.
     const GeneratorInfo* generator_info = FindOrNull(generators_, name);
@@ -1092,7 +1708,18 @@ void CommandLineInterface::PrintHelpText() {
 "                              set, so that the set is self-contained.\n"
 "  --error_format=FORMAT       Set the format in which to print errors.\n"
 "                              FORMAT may be 'gcc' (the default) or 'msvs'\n"
-"                              (Microsoft Visual Studio format)." << std::endl;
+"                              (Microsoft Visual Studio format).\n"
+"  -jN, --jobs=N               Run up to N code generators at once.  The\n"
+"                              output is the same as with the default of 1,\n"
+"                              but code generators must be safe to call from\n"
+"                              several threads.\n"
+"  --cache_dir=DIR             Keep parsed .proto files and generated code in\n"
+"                              the existing directory DIR, and reuse them\n"
+"                              when the inputs have not changed.  Output files\n"
+"                              whose contents did not change are not\n"
+"                              rewritten.  Entries are keyed by the protoc\n"
+"                              version, not the build, so clear DIR when a\n"
+"                              code generator or plugin changes." << std::endl;
   if (!plugin_prefix_.empty()) {
     std::cerr <<
 "  --plugin=EXECUTABLE         Specifies a plugin executable to use.\n"
@@ -1102,7 +1729,18 @@ void CommandLineInterface::PrintHelpText() {
 "                              Additionally, EXECUTABLE may be of the form\n"
 "                              NAME=PATH, in which case the given plugin name\n"
 "                              is mapped to the given executable even if\n"
-"                              the executable's own name differs." << std::endl;
+"                              the executable's own name differs.\n"
+"  --plugin_server=SOCKET      Run plugins through the plugin server on the\n"
+"                              Unix domain socket SOCKET, which keeps them\n"
+"                              running between runs of protoc.  Plugins the\n"
+"                              server does not serve or cannot run, or all\n"
+"                              plugins if no server is listening there, are\n"
+"                              run directly.\n"
+"  --serve_plugins=SOCKET      Instead of compiling, serve the plugins given\n"
+"                              with --plugin on SOCKET until killed, running\n"
+"                              up to -jN requests at once.  Plugins run this\n"
+"                              way must support the persistent mode\n"
+"                              described in plugin.proto." << std::endl;
   }
 
   for (GeneratorMap::iterator iter = generators_.begin();
@@ -1122,39 +1760,203 @@ bool CommandLineInterface::GenerateOutput(
     GeneratorContext* generator_context) {
   // Call the generator.
   std::string error;
+  if (output_directive.generator == NULL) {
+    // This is a plugin, which handles all files at once.
+    if (!RunGenerator(parsed_files, output_directive, -1,
+                      generator_context, &error)) {
+      std::cerr << error << std::endl;
+      return false;
+    }
+  } else {
+    // Regular generator.
+    for (int i = 0; i < parsed_files.size(); i++) {
+      if (!RunGenerator(parsed_files, output_directive, i,
+                        generator_context, &error)) {
+        std::cerr << error << std::endl;
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool CommandLineInterface::GenerateOutputInParallel(
+    const std::vector<const FileDescriptor*>& parsed_files,
+    const std::vector<GeneratorContext*>& generator_contexts) {
+  // List the tasks in the order GenerateOutput() would run them.
+  std::vector<GenerationTask> tasks;
+  for (int i = 0; i < output_directives_.size(); i++) {
+    GenerationTask task;
+    task.directive_index = i;
+    task.output = NULL;
+    task.success = false;
+    if (output_directives_[i].generator == NULL) {
+      task.file_index = -1;
+      tasks.push_back(task);
+    } else {
+      for (int j = 0; j < parsed_files.size(); j++) {
+        task.file_index = j;
+        tasks.push_back(task);
+      }
+    }
+  }
+
+  GenerationQueue queue;
+  queue.cli = this;
+  queue.parsed_files = &parsed_files;
+  queue.tasks = &tasks;
+  queue.next_task = 0;
+  RunOnThreads(std::min<int>(jobs_, tasks.size()), &GenerationWorker, &queue);
+
+  // Write the buffers out in order, stopping at the first error like
+  // GenerateOutput() does.
+  bool success = true;
+  for (int i = 0; i < tasks.size(); i++) {
+    if (success && !tasks[i].success) {
+      std::cerr << tasks[i].error << std::endl;
+      success = false;
+    }
+    if (success) {
+      tasks[i].output->WriteTo(generator_contexts[tasks[i].directive_index]);
+    }
+    delete tasks[i].output;
+  }
+
+  return success;
+}
+
+void CommandLineInterface::GenerationWorker(void* queue_ptr) {
+  GenerationQueue* queue = reinterpret_cast<GenerationQueue*>(queue_ptr);
+  while (true) {
+    GenerationTask* task;
+    {
+      MutexLock lock(&queue->mutex);
+      if (queue->next_task == queue->tasks->size()) return;
+      task = &(*queue->tasks)[queue->next_task++];
+    }
+
+    CommandLineInterface* cli = queue->cli;
+    const OutputDirective& directive =
+        cli->output_directives_[task->directive_index];
+    task->output = new BufferedGeneratorContext(*queue->parsed_files);
+
+    std::string cache_key;
+    if (!cli->cache_dir_.empty()) {
+      cache_key = cli->OutputCacheKey(*queue->parsed_files, directive,
+                                      task->file_index);
+    }
+    if (!cache_key.empty()) {
+      std::string cached_output;
+      if (ReadCacheEntry(cli->cache_dir_, cache_key, &cached_output) &&
+          task->output->ParseFromString(cached_output)) {
+        task->success = true;
+        continue;
+      }
+    }
+
+    {
+      MutexLockMaybe lock(directive.generator == NULL ? &queue->plugin_mutex
+                                                      : NULL);
+      task->success = cli->RunGenerator(
+          *queue->parsed_files, directive, task->file_index, task->output,
+          &task->error);
+    }
+
+    if (task->success && !cache_key.empty()) {
+      std::string output;
+      task->output->SerializeToString(&output);
+      WriteCacheEntry(cli->cache_dir_, cache_key, output);
+    }
+  }
+}
+
+std::string CommandLineInterface::OutputCacheKey(
+    const std::vector<const FileDescriptor*>& parsed_files,
+    const OutputDirective& output_directive,
+    int file_index) const {
+  std::string key = "generate\n";
+  key += protobuf::internal::VersionString(GOOGLE_PROTOBUF_VERSION);
+  key += '\n';
+  key += output_directive.name;
+  key += '\n';
+  key += output_directive.parameter;
+  key += '\n';
+  if (output_directive.generator == NULL) {
+    std::map<std::string, std::string>::const_iterator plugin =
+        plugins_.find(PluginName(output_directive));
+    if (plugin != plugins_.end()) key += plugin->second;
+  } else if (!output_directive.generator->AppendCacheKey(
+                 output_directive.parameter, &key)) {
+    return "";
+  }
+  key += '\n';
+
+  // Generators may call GeneratorContext::ListParsedFiles().
+  for (int i = 0; i < parsed_files.size(); i++) {
+    key += parsed_files[i]->name();
+    key += '\n';
+  }
+
+  // Everything the generator can see of the .proto files.
+  FileDescriptorSet file_set;
+  std::set<const FileDescriptor*> already_seen;
+  if (file_index == -1) {
+    for (int i = 0; i < parsed_files.size(); i++) {
+      GetTransitiveDependencies(parsed_files[i], &already_seen,
+                                file_set.mutable_file());
+    }
+  } else {
+    key += parsed_files[file_index]->name();
+    GetTransitiveDependencies(parsed_files[file_index], &already_seen,
+                              file_set.mutable_file());
+  }
+  key += '\0';
+  file_set.AppendToString(&key);
+  return key;
+}
+
+bool CommandLineInterface::RunGenerator(
+    const std::vector<const FileDescriptor*>& parsed_files,
+    const OutputDirective& output_directive,
+    int file_index,
+    GeneratorContext* generator_context,
+    std::string* error) {
+  std::string generator_error;
   if (output_directive.generator == NULL) {
     // This is a plugin.
     GOOGLE_CHECK(protobuf::HasPrefixString(output_directive.name, "--") &&
           protobuf::HasSuffixString(output_directive.name, "_out"))
         << "Bad name for plugin generator: " << output_directive.name;
 
-    // Strip the "--" and "_out" and add the plugin prefix.
-    std::string plugin_name = plugin_prefix_ + "gen-" +
-        output_directive.name.substr(2, output_directive.name.size() - 6);
-
+    std::string plugin_name = PluginName(output_directive);
     if (!GeneratePluginOutput(parsed_files, plugin_name,
                               output_directive.parameter,
-                              generator_context, &error)) {
-      std::cerr << output_directive.name << ": " << error << std::endl;
+                              generator_context, &generator_error)) {
+      *error = output_directive.name + ": " + generator_error;
       return false;
     }
   } else {
-    // Regular generator.
-    for (int i = 0; i < parsed_files.size(); i++) {
-      if (!output_directive.generator->Generate(
-          parsed_files[i], output_directive.parameter,
-          generator_context, &error)) {
-        // Generator returned an error.
-        std::cerr << output_directive.name << ": " << parsed_files[i]->name() << ": "
-             << error << std::endl;
-        return false;
-      }
+    if (!output_directive.generator->Generate(
+        parsed_files[file_index], output_directive.parameter,
+        generator_context, &generator_error)) {
+      // Generator returned an error.
+      *error = output_directive.name + ": " +
+               parsed_files[file_index]->name() + ": " + generator_error;
+      return false;
     }
   }
 
   return true;
 }
 
+std::string CommandLineInterface::PluginName(
+    const OutputDirective& output_directive) const {
+  // Strip the "--" and "_out" and add the plugin prefix.
+  return plugin_prefix_ + "gen-" +
+      output_directive.name.substr(2, output_directive.name.size() - 6);
+}
+
 bool CommandLineInterface::GeneratePluginOutput(
     const std::vector<const FileDescriptor*>& parsed_files,
     const std::string& plugin_name,
@@ -1177,18 +1979,25 @@ bool CommandLineInterface::GeneratePluginOutput(
   }
 
   // Invoke the plugin.
-  Subprocess subprocess;
-
+  std::string program = plugin_name;
+  Subprocess::SearchMode search_mode = Subprocess::SEARCH_PATH;
   if (plugins_.count(plugin_name) > 0) {
-    subprocess.Start(plugins_[plugin_name], Subprocess::EXACT_NAME);
-  } else {
-    subprocess.Start(plugin_name, Subprocess::SEARCH_PATH);
+    program = plugins_[plugin_name];
+    search_mode = Subprocess::EXACT_NAME;
   }
 
-  std::string communicate_error;
-  if (!subprocess.Communicate(request, &response, &communicate_error)) {
-    *error = strings::Substitute("$0: $1", plugin_name, communicate_error);
-    return false;
+  // Fall back to running the plugin ourselves if the server cannot.
+  if (plugin_server_.empty() ||
+      !PluginServer::RunPlugin(plugin_server_, program, search_mode, request,
+                               &response)) {
+    response.Clear();
+    std::string communicate_error;
+    Subprocess subprocess;
+    subprocess.Start(program, search_mode);
+    if (!subprocess.Communicate(request, &response, &communicate_error)) {
+      *error = strings::Substitute("$0: $1", plugin_name, communicate_error);
+      return false;
+    }
   }
 
   // Write the files.  We do this even if there was a generator error in order
@@ -1296,6 +2105,37 @@ bool CommandLineInterface::EncodeOrDecode(const DescriptorPool* pool) {
   return true;
 }
 
+bool CommandLineInterface::ServePlugins() {
+  PluginServer server;
+  std::string error;
+  if (!server.Listen(plugin_server_, &error)) {
+    std::cerr << error << std::endl;
+    return false;
+  }
+  for (std::map<std::string, std::string>::const_iterator iter =
+           plugins_.begin();
+       iter != plugins_.end(); ++iter) {
+    server.AllowPlugin(iter->second);
+  }
+
+#ifndef _WIN32
+  // Shut down cleanly when killed, so that the plugins are ended and the
+  // socket removed.
+  server_to_shut_down = &server;
+  signal(SIGINT, &ShutDownServer);
+  signal(SIGTERM, &ShutDownServer);
+#endif
+
+  server.Serve(jobs_);
+
+#ifndef _WIN32
+  signal(SIGINT, SIG_DFL);
+  signal(SIGTERM, SIG_DFL);
+  server_to_shut_down = NULL;
+#endif
+  return true;
+}
+
 bool CommandLineInterface::WriteDescriptorSet(
     const std::vector<const FileDescriptor*> parsed_files) {
   FileDescriptorSet file_set;
@@ -176,6 +176,11 @@ class LIBPROTOC_EXPORT CommandLineInterface {
   class ErrorPrinter;
   class GeneratorContextImpl;
   class MemoryOutputStream;
+  class BufferedGeneratorContext;
+  class BufferedOutputStream;
+  class CachingImporter;
+  struct GenerationTask;
+  struct GenerationQueue;
 
   // Clear state from previous Run().
   void Clear();
@@ -186,6 +191,11 @@ class LIBPROTOC_EXPORT CommandLineInterface {
   bool MakeInputsBeProtoPathRelative(
     DiskSourceTree* source_tree);
 
+  // Looks up each of input_files_ in the pool, adding the results to
+  // parsed_files.  Returns false if any of them failed to import.
+  bool ImportInputFiles(const DescriptorPool* pool,
+                        std::vector<const FileDescriptor*>* parsed_files);
+
   // Parse all command-line arguments.
   bool ParseArguments(int argc, const char* const argv[]);
 
@@ -213,6 +223,42 @@ class LIBPROTOC_EXPORT CommandLineInterface {
   bool GenerateOutput(const std::vector<const FileDescriptor*>& parsed_files,
                       const OutputDirective& output_directive,
                       GeneratorContext* generator_context);
+
+  // Like calling GenerateOutput() for each directive in turn, but runs the
+  // (directive, file) pairs on jobs_ threads.  Each pair writes to its own
+  // buffer; the buffers are then copied to generator_contexts[i] (the context
+  // for output_directives_[i]) in the same order GenerateOutput() would have
+  // written them, so the output does not depend on the number of threads.
+  // With --cache_dir, this is also used with a single thread:  the buffers
+  // are what gets cached.
+  bool GenerateOutputInParallel(
+      const std::vector<const FileDescriptor*>& parsed_files,
+      const std::vector<GeneratorContext*>& generator_contexts);
+
+  // Runs the directive's generator on parsed_files[file_index], or, for a
+  // plugin, on all of parsed_files (file_index is ignored).  On failure, sets
+  // *error to the message to print and returns false.
+  bool RunGenerator(const std::vector<const FileDescriptor*>& parsed_files,
+                    const OutputDirective& output_directive,
+                    int file_index,
+                    GeneratorContext* generator_context,
+                    std::string* error);
+
+  // Thread body for GenerateOutputInParallel().  queue is a GenerationQueue.
+  static void GenerationWorker(void* queue);
+
+  // Returns the --cache_dir key for the output of RunGenerator() with the
+  // same arguments:  everything that output depends on, short of the code
+  // generator's own code.  Returns an empty string if the generator says its
+  // output must not be cached.
+  std::string OutputCacheKey(
+      const std::vector<const FileDescriptor*>& parsed_files,
+      const OutputDirective& output_directive,
+      int file_index) const;
+
+  // Returns the name of the plugin executable for the given directive.
+  std::string PluginName(const OutputDirective& output_directive) const;
+
   bool GeneratePluginOutput(const std::vector<const FileDescriptor*>& parsed_files,
                             const std::string& plugin_name,
                             const std::string& parameter,
@@ -222,6 +268,9 @@ class LIBPROTOC_EXPORT CommandLineInterface {
   // Implements --encode and --decode.
   bool EncodeOrDecode(const DescriptorPool* pool);
 
+  // Implements --serve_plugins.
+  bool ServePlugins();
+
   // Implements the --descriptor_set_out option.
   bool WriteDescriptorSet(const std::vector<const FileDescriptor*> parsed_files);
 
@@ -264,7 +313,8 @@ class LIBPROTOC_EXPORT CommandLineInterface {
   enum Mode {
     MODE_COMPILE,  // Normal mode:  parse .proto files and compile them.
     MODE_ENCODE,   // --encode:  read text from stdin, write binary to stdout.
-    MODE_DECODE    // --decode:  read binary from stdin, write text to stdout.
+    MODE_DECODE,   // --decode:  read binary from stdin, write text to stdout.
+    MODE_SERVE_PLUGINS  // --serve_plugins:  run plugins for other protocs.
   };
 
   Mode mode_;
@@ -308,6 +358,15 @@ class LIBPROTOC_EXPORT CommandLineInterface {
   // See SetInputsAreProtoPathRelative().
   bool inputs_are_proto_path_relative_;
 
+  // Number of generators to run at once (-j / --jobs).
+  int jobs_;
+
+  // Directory given with --cache_dir, with a trailing '/', or empty.
+  std::string cache_dir_;
+
+  // Socket given with --plugin_server or --serve_plugins, or empty.
+  std::string plugin_server_;
+
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(CommandLineInterface);
 
   // Friends
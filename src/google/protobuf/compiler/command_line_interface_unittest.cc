@@ -37,8 +37,11 @@
 #include <fcntl.h>
 #if defined(_MSC_VER) || defined(__BORLANDC__)
 #include <io.h>
+#include <sys/utime.h>
 #else
+#include <pthread.h>
 #include <unistd.h>
+#include <utime.h>
 #endif
 #include <vector>
 
@@ -48,6 +51,8 @@
 #include <google/protobuf/compiler/command_line_interface.h>
 #include <google/protobuf/compiler/code_generator.h>
 #include <google/protobuf/compiler/mock_code_generator.h>
+#include <google/protobuf/compiler/plugin.pb.h>
+#include <google/protobuf/compiler/plugin_server.h>
 #include <google/protobuf/compiler/subprocess.h>
 #include <google/protobuf/io/printer.h>
 #include <google/protobuf/unittest.pb.h>
@@ -102,6 +107,8 @@ class CommandLineInterfaceTest : public testing::Test {
   // Create a subdirectory within temp_directory_.
   void CreateTempDir(const std::string& name);
 
+  const std::string& temp_directory() { return temp_directory_; }
+
   void SetInputsAreProtoPathRelative(bool enable) {
     cli_.SetInputsAreProtoPathRelative(enable);
   }
@@ -155,6 +162,15 @@ class CommandLineInterfaceTest : public testing::Test {
                                      const std::string& message_name);
 
   void ExpectNullCodeGeneratorCalled(const std::string& parameter);
+  void ExpectNullCodeGeneratorNotCalled();
+
+  // Sets what the NullCodeGenerator appends to --cache_dir keys.
+  void SetNullCodeGeneratorCacheKey(const std::string& key);
+
+  // Sets the modification time of a file in the temp directory to long ago,
+  // and checks whether it still is, to tell whether the file was rewritten.
+  void BackdateTempFile(const std::string& name);
+  bool TempFileIsBackdated(const std::string& name);
 
   void ReadDescriptorSet(const std::string& filename,
                          FileDescriptorSet* descriptor_set);
@@ -191,6 +207,8 @@ class CommandLineInterfaceTest::NullCodeGenerator : public CodeGenerator {
 
   mutable bool called_;
   mutable std::string parameter_;
+  // Appended to the --cache_dir key, unless the parameter is "uncached".
+  std::string cache_key_;
 
   // implements CodeGenerator ----------------------------------------
   bool Generate(const FileDescriptor* file,
@@ -201,6 +219,11 @@ class CommandLineInterfaceTest::NullCodeGenerator : public CodeGenerator {
     parameter_ = parameter;
     return true;
   }
+  bool AppendCacheKey(const std::string& parameter, std::string* key) const {
+    if (parameter == "uncached") return false;
+    key->append(cache_key_);
+    return true;
+  }
 };
 
 // ===================================================================
@@ -300,6 +323,7 @@ void CommandLineInterfaceTest::Run(const std::string& command) {
 
   CaptureTestStderr();
 
+  null_generator_->called_ = false;
   return_code_ = cli_.Run(args.size(), argv.get());
 
   error_text_ = GetCapturedTestStderr();
@@ -400,6 +424,29 @@ void CommandLineInterfaceTest::ExpectNullCodeGeneratorCalled(
   EXPECT_EQ(parameter, null_generator_->parameter_);
 }
 
+void CommandLineInterfaceTest::ExpectNullCodeGeneratorNotCalled() {
+  EXPECT_FALSE(null_generator_->called_);
+}
+
+void CommandLineInterfaceTest::SetNullCodeGeneratorCacheKey(
+    const std::string& key) {
+  null_generator_->cache_key_ = key;
+}
+
+void CommandLineInterfaceTest::BackdateTempFile(const std::string& name) {
+  struct utimbuf times;
+  times.actime = 1000000000;
+  times.modtime = 1000000000;
+  std::string path = temp_directory_ + "/" + name;
+  ASSERT_EQ(0, utime(path.c_str(), &times));
+}
+
+bool CommandLineInterfaceTest::TempFileIsBackdated(const std::string& name) {
+  struct stat info;
+  std::string path = temp_directory_ + "/" + name;
+  return stat(path.c_str(), &info) == 0 && info.st_mtime == 1000000000;
+}
+
 void CommandLineInterfaceTest::ReadDescriptorSet(
     const std::string& filename, FileDescriptorSet* descriptor_set) {
   std::string path = temp_directory_ + "/" + filename;
@@ -567,6 +614,196 @@ TEST_F(CommandLineInterfaceTest, Insert) {
       "foo.proto", "Foo");
 }
 
+TEST_F(CommandLineInterfaceTest, ParallelOutput) {
+  // Test that -j gives the same output as a serial run.
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  CreateTempFile("bar.proto",
+    "syntax = \"proto2\";\n"
+    "message Bar {}\n");
+
+  Run("protocol_compiler -j4 --test_out=$tmpdir --plug_out=$tmpdir "
+      "--proto_path=$tmpdir foo.proto bar.proto");
+
+  ExpectNoErrors();
+  ExpectGeneratedWithMultipleInputs("test_generator", "foo.proto,bar.proto",
+                                    "foo.proto", "Foo");
+  ExpectGeneratedWithMultipleInputs("test_generator", "foo.proto,bar.proto",
+                                    "bar.proto", "Bar");
+  ExpectGeneratedWithMultipleInputs("test_plugin", "foo.proto,bar.proto",
+                                    "foo.proto", "Foo");
+  ExpectGeneratedWithMultipleInputs("test_plugin", "foo.proto,bar.proto",
+                                    "bar.proto", "Bar");
+}
+
+TEST_F(CommandLineInterfaceTest, ParallelInsert) {
+  // Test that with -j, insertions into files written by other generators
+  // still land in the same order.
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  Run("protocol_compiler --jobs=4 "
+      "--test_out=TestParameter:$tmpdir "
+      "--plug_out=TestPluginParameter:$tmpdir "
+      "--test_out=insert=test_generator,test_plugin:$tmpdir "
+      "--plug_out=insert=test_generator,test_plugin:$tmpdir "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectNoErrors();
+  ExpectGeneratedWithInsertions(
+      "test_generator", "TestParameter", "test_generator,test_plugin",
+      "foo.proto", "Foo");
+  ExpectGeneratedWithInsertions(
+      "test_plugin", "TestPluginParameter", "test_generator,test_plugin",
+      "foo.proto", "Foo");
+}
+
+TEST_F(CommandLineInterfaceTest, ParallelGeneratorError) {
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  CreateTempFile("bar.proto",
+    "syntax = \"proto2\";\n"
+    "message MockCodeGenerator_Error {}\n");
+
+  Run("protocol_compiler --jobs=3 --test_out=$tmpdir "
+      "--proto_path=$tmpdir foo.proto bar.proto");
+
+  ExpectErrorText(
+      "--test_out: bar.proto: Saw message type MockCodeGenerator_Error.\n");
+}
+
+TEST_F(CommandLineInterfaceTest, BadJobsError) {
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  Run("protocol_compiler -j0 --test_out=$tmpdir "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectErrorText("-j requires a number of jobs between 1 and 1024.\n");
+}
+
+TEST_F(CommandLineInterfaceTest, CacheDir) {
+  // With --cache_dir, running again on the same input neither calls the
+  // generators nor rewrites their output.
+  CreateTempDir("cache");
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  std::string output_file =
+      MockCodeGenerator::GetOutputFileName("test_generator", "foo.proto");
+
+  Run("protocol_compiler --test_out=$tmpdir --null_out=$tmpdir "
+      "--cache_dir=$tmpdir/cache --proto_path=$tmpdir foo.proto");
+
+  ExpectNoErrors();
+  ExpectGenerated("test_generator", "", "foo.proto", "Foo");
+  ExpectNullCodeGeneratorCalled("");
+
+  BackdateTempFile(output_file);
+  Run("protocol_compiler --test_out=$tmpdir --null_out=$tmpdir "
+      "--cache_dir=$tmpdir/cache --proto_path=$tmpdir foo.proto");
+
+  ExpectNoErrors();
+  ExpectGenerated("test_generator", "", "foo.proto", "Foo");
+  ExpectNullCodeGeneratorNotCalled();
+  EXPECT_TRUE(TempFileIsBackdated(output_file));
+
+  // A different parameter is a different cache entry.
+  Run("protocol_compiler --test_out=$tmpdir --null_out=hello:$tmpdir "
+      "--cache_dir=$tmpdir/cache --proto_path=$tmpdir foo.proto");
+
+  ExpectNoErrors();
+  ExpectNullCodeGeneratorCalled("hello");
+
+  // So is a changed file.
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Bar {}\n");
+  Run("protocol_compiler --test_out=$tmpdir --null_out=$tmpdir "
+      "--cache_dir=$tmpdir/cache --proto_path=$tmpdir foo.proto");
+
+  ExpectNoErrors();
+  ExpectGenerated("test_generator", "", "foo.proto", "Bar");
+  ExpectNullCodeGeneratorCalled("");
+}
+
+TEST_F(CommandLineInterfaceTest, CacheDirGeneratorKey) {
+  // What a generator appends to the key, for inputs other than the .proto
+  // files, picks the cache entry too.
+  CreateTempDir("cache");
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  SetNullCodeGeneratorCacheKey("profile 1");
+  Run("protocol_compiler --null_out=$tmpdir "
+      "--cache_dir=$tmpdir/cache --proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  ExpectNullCodeGeneratorCalled("");
+  Run("protocol_compiler --null_out=$tmpdir "
+      "--cache_dir=$tmpdir/cache --proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  ExpectNullCodeGeneratorNotCalled();
+
+  SetNullCodeGeneratorCacheKey("profile 2");
+  Run("protocol_compiler --null_out=$tmpdir "
+      "--cache_dir=$tmpdir/cache --proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  ExpectNullCodeGeneratorCalled("");
+
+  // A generator can keep its output out of the cache altogether.
+  for (int i = 0; i < 2; i++) {
+    Run("protocol_compiler --null_out=uncached:$tmpdir "
+        "--cache_dir=$tmpdir/cache --proto_path=$tmpdir foo.proto");
+    ExpectNoErrors();
+    ExpectNullCodeGeneratorCalled("uncached");
+  }
+}
+
+TEST_F(CommandLineInterfaceTest, CacheDirChangedImport) {
+  // A file which comes from the cache still gets the usual errors, line
+  // numbers included, when an import it depends on changes.
+  CreateTempDir("cache");
+  CreateTempFile("bar.proto",
+    "syntax = \"proto2\";\n"
+    "message Bar {}\n");
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "import \"bar.proto\";\n"
+    "message Foo { optional Bar bar = 1; }\n");
+
+  Run("protocol_compiler --test_out=$tmpdir --cache_dir=$tmpdir/cache "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectNoErrors();
+  ExpectGenerated("test_generator", "", "foo.proto", "Foo");
+
+  CreateTempFile("bar.proto",
+    "syntax = \"proto2\";\n"
+    "message Baz {}\n");
+  Run("protocol_compiler --test_out=$tmpdir --cache_dir=$tmpdir/cache "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectErrorText("foo.proto:3:24: \"Bar\" is not defined.\n");
+}
+
+TEST_F(CommandLineInterfaceTest, CacheDirMissing) {
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  Run("protocol_compiler --test_out=$tmpdir --cache_dir=$tmpdir/cache "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectErrorSubstring("cache/: ");
+}
+
 #if defined(_WIN32)
 
 TEST_F(CommandLineInterfaceTest, WindowsOutputPath) {
@@ -1168,6 +1405,168 @@ TEST_F(CommandLineInterfaceTest, GeneratorPluginNotAllowed) {
   ExpectErrorSubstring("Unknown flag: --plug_out");
 }
 
+#ifndef _WIN32
+
+void* ServePlugins(void* server) {
+  reinterpret_cast<PluginServer*>(server)->Serve(2);
+  return NULL;
+}
+
+TEST_F(CommandLineInterfaceTest, PluginServer) {
+  // Test that plugins run through a plugin server are kept running.
+
+  PluginServer server;
+  std::string error;
+  ASSERT_TRUE(server.Listen(temp_directory() + "/plugins.sock", &error))
+      << error;
+  server.AllowPlugin("test_plugin");
+  pthread_t thread;
+  ASSERT_EQ(0, pthread_create(&thread, NULL, &ServePlugins, &server));
+
+  // Only the user running the server may connect to it.
+  struct stat socket_stat;
+  ASSERT_EQ(0, stat((temp_directory() + "/plugins.sock").c_str(),
+                    &socket_stat));
+  EXPECT_EQ(0600, socket_stat.st_mode & 0777);
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  CreateTempFile("bar.proto",
+    "syntax = \"proto2\";\n"
+    "message Bar {}\n");
+
+  Run("protocol_compiler --plug_out=$tmpdir "
+      "--plugin_server=$tmpdir/plugins.sock "
+      "--proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  ExpectGenerated("test_plugin", "", "foo.proto", "Foo");
+
+  Run("protocol_compiler --plug_out=TestPluginParameter:$tmpdir "
+      "--plugin_server=$tmpdir/plugins.sock "
+      "--proto_path=$tmpdir bar.proto");
+  ExpectNoErrors();
+  ExpectGenerated("test_plugin", "TestPluginParameter", "bar.proto", "Bar");
+
+  EXPECT_EQ(1, server.processes_started());
+
+  // A plugin which fails on the server is run again directly, which reports
+  // the failure, and the server does not use it again.
+  CreateTempFile("error.proto",
+    "syntax = \"proto2\";\n"
+    "message MockCodeGenerator_Exit {}\n");
+  Run("protocol_compiler --plug_out=$tmpdir "
+      "--plugin_server=$tmpdir/plugins.sock "
+      "--proto_path=$tmpdir error.proto");
+  ExpectErrorSubstring(
+      "--plug_out: prefix-gen-plug: Plugin failed with status code 123.");
+
+  Run("protocol_compiler --plug_out=$tmpdir "
+      "--plugin_server=$tmpdir/plugins.sock "
+      "--proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  EXPECT_EQ(3, server.processes_started());
+
+  server.Shutdown();
+  pthread_join(thread, NULL);
+}
+
+TEST_F(CommandLineInterfaceTest, PluginServerKillsHungPlugin) {
+  // A plugin which does not answer in time is killed, and a new process
+  // answers the next request.
+
+  PluginServer server;
+  std::string error;
+  ASSERT_TRUE(server.Listen(temp_directory() + "/plugins.sock", &error))
+      << error;
+  server.AllowPlugin("test_plugin");
+  server.SetPluginTimeout(1000);
+  pthread_t thread;
+  ASSERT_EQ(0, pthread_create(&thread, NULL, &ServePlugins, &server));
+
+  CodeGeneratorRequest request;
+  FileDescriptorProto* file = request.add_proto_file();
+  file->set_name("hang.proto");
+  file->add_message_type()->set_name("MockCodeGenerator_Hang");
+  request.add_file_to_generate("hang.proto");
+  CodeGeneratorResponse response;
+  // protoc would now run the plugin itself.
+  EXPECT_FALSE(PluginServer::RunPlugin(temp_directory() + "/plugins.sock",
+                                       "test_plugin", Subprocess::EXACT_NAME,
+                                       request, &response));
+  EXPECT_EQ(1, server.processes_started());
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+  Run("protocol_compiler --plug_out=$tmpdir "
+      "--plugin_server=$tmpdir/plugins.sock "
+      "--proto_path=$tmpdir foo.proto");
+  ExpectNoErrors();
+  ExpectGenerated("test_plugin", "", "foo.proto", "Foo");
+  EXPECT_EQ(2, server.processes_started());
+
+  server.Shutdown();
+  pthread_join(thread, NULL);
+}
+
+TEST_F(CommandLineInterfaceTest, PluginServerRefusesOtherPlugins) {
+  // Plugins the server was not given are run directly.
+
+  PluginServer server;
+  std::string error;
+  ASSERT_TRUE(server.Listen(temp_directory() + "/plugins.sock", &error))
+      << error;
+  server.AllowPlugin("some_other_plugin");
+  pthread_t thread;
+  ASSERT_EQ(0, pthread_create(&thread, NULL, &ServePlugins, &server));
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  Run("protocol_compiler --plug_out=$tmpdir "
+      "--plugin_server=$tmpdir/plugins.sock "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectNoErrors();
+  ExpectGenerated("test_plugin", "", "foo.proto", "Foo");
+  EXPECT_EQ(0, server.processes_started());
+
+  server.Shutdown();
+  pthread_join(thread, NULL);
+}
+
+TEST_F(CommandLineInterfaceTest, PluginServerNotRunning) {
+  // Without a server, plugins are run directly.
+
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  Run("protocol_compiler --plug_out=$tmpdir "
+      "--plugin_server=$tmpdir/plugins.sock "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectNoErrors();
+  ExpectGenerated("test_plugin", "", "foo.proto", "Foo");
+}
+
+#endif  // !_WIN32
+
+TEST_F(CommandLineInterfaceTest, ServePluginsWithInputs) {
+  CreateTempFile("foo.proto",
+    "syntax = \"proto2\";\n"
+    "message Foo {}\n");
+
+  Run("protocol_compiler --serve_plugins=$tmpdir/plugins.sock "
+      "--proto_path=$tmpdir foo.proto");
+
+  ExpectErrorText(
+      "When using --serve_plugins, no input files or output directives "
+      "should be given.\n");
+}
+
 TEST_F(CommandLineInterfaceTest, HelpText) {
   Run("test_exec_name --help");
 
@@ -46,8 +46,9 @@ namespace cpp {
 namespace {
 
 void SetEnumVariables(const FieldDescriptor* descriptor,
+                      const Options& options,
                       std::map<std::string, std::string>* variables) {
-  cpp::SetCommonFieldVariables(descriptor, variables);
+  cpp::SetCommonFieldVariables(descriptor, options, variables);
   const EnumValueDescriptor* default_value = descriptor->default_value_enum();
   (*variables)["type"] = ClassName(descriptor->enum_type(), true);
   (*variables)["default"] = SimpleItoa(default_value->number());
@@ -58,9 +59,10 @@ void SetEnumVariables(const FieldDescriptor* descriptor,
 // ===================================================================
 
 EnumFieldGenerator::
-EnumFieldGenerator(const FieldDescriptor* descriptor)
+EnumFieldGenerator(const FieldDescriptor* descriptor,
+                   const Options& options)
   : descriptor_(descriptor) {
-  SetEnumVariables(descriptor, &variables_);
+  SetEnumVariables(descriptor, options, &variables_);
 }
 
 EnumFieldGenerator::~EnumFieldGenerator() {}
@@ -81,18 +83,18 @@ void EnumFieldGenerator::
 GenerateInlineAccessorDefinitions(io::Printer* printer) const {
   printer->Print(variables_,
     "inline $type$ $classname$::$name$() const {\n"
-    "  return static_cast< $type$ >($name$_);\n"
+    "  return static_cast< $type$ >($member$);\n"
     "}\n"
     "inline void $classname$::set_$name$($type$ value) {\n"
     "  GOOGLE_DCHECK($type$_IsValid(value));\n"
     "  set_has_$name$();\n"
-    "  $name$_ = value;\n"
+    "  $mutable_member$ = value;\n"
     "}\n");
 }
 
 void EnumFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = $default$;\n");
+  printer->Print(variables_, "$member$ = $default$;\n");
 }
 
 void EnumFieldGenerator::
@@ -102,7 +104,7 @@ GenerateMergingCode(io::Printer* printer) const {
 
 void EnumFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "std::swap($name$_, other->$name$_);\n");
+  printer->Print(variables_, "std::swap($member$, other->$member$);\n");
 }
 
 void EnumFieldGenerator::
@@ -152,9 +154,10 @@ GenerateByteSize(io::Printer* printer) const {
 // ===================================================================
 
 RepeatedEnumFieldGenerator::
-RepeatedEnumFieldGenerator(const FieldDescriptor* descriptor)
+RepeatedEnumFieldGenerator(const FieldDescriptor* descriptor,
+                           const Options& options)
   : descriptor_(descriptor) {
-  SetEnumVariables(descriptor, &variables_);
+  SetEnumVariables(descriptor, options, &variables_);
 }
 
 RepeatedEnumFieldGenerator::~RepeatedEnumFieldGenerator() {}
@@ -184,40 +187,40 @@ void RepeatedEnumFieldGenerator::
 GenerateInlineAccessorDefinitions(io::Printer* printer) const {
   printer->Print(variables_,
     "inline $type$ $classname$::$name$(int index) const {\n"
-    "  return static_cast< $type$ >($name$_.Get(index));\n"
+    "  return static_cast< $type$ >($member$.Get(index));\n"
     "}\n"
     "inline void $classname$::set_$name$(int index, $type$ value) {\n"
     "  GOOGLE_DCHECK($type$_IsValid(value));\n"
-    "  $name$_.Set(index, value);\n"
+    "  $member$.Set(index, value);\n"
     "}\n"
     "inline void $classname$::add_$name$($type$ value) {\n"
     "  GOOGLE_DCHECK($type$_IsValid(value));\n"
-    "  $name$_.Add(value);\n"
+    "  $mutable_member$.Add(value);\n"
     "}\n");
   printer->Print(variables_,
     "inline const ::google::protobuf::RepeatedField<int>&\n"
     "$classname$::$name$() const {\n"
-    "  return $name$_;\n"
+    "  return $member$;\n"
     "}\n"
     "inline ::google::protobuf::RepeatedField<int>*\n"
     "$classname$::mutable_$name$() {\n"
-    "  return &$name$_;\n"
+    "  return &$mutable_member$;\n"
     "}\n");
 }
 
 void RepeatedEnumFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Clear();\n");
+  printer->Print(variables_, "$member$.Clear();\n");
 }
 
 void RepeatedEnumFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.MergeFrom(from.$name$_);\n");
+  printer->Print(variables_, "$mutable_member$.MergeFrom(from.$member$);\n");
 }
 
 void RepeatedEnumFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Swap(&other->$name$_);\n");
+  printer->Print(variables_, "$member$.Swap(&other->$member$);\n");
 }
 
 void RepeatedEnumFieldGenerator::
@@ -40,6 +40,7 @@
 
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/compiler/cpp/cpp_options.h>
 
 namespace google {
 namespace protobuf {
@@ -55,8 +56,14 @@ namespace cpp {
 // Helper function: set variables in the map that are the same for all
 // field code generators.
 // ['name', 'index', 'number', 'classname', 'declared_type', 'tag_size',
-// 'deprecation'].
+// 'deprecation', 'member', 'mutable_member'].
+//
+// 'member' is the expression naming the field's data member from within the
+// message, for reading it (and writing it where the field is known to be
+// set); 'mutable_member' is the one for writing it.  They differ from
+// '$name$_' only for cold fields (see IsColdField() in cpp_helpers.h).
 void SetCommonFieldVariables(const FieldDescriptor* descriptor,
+                             const Options& options,
                              std::map<std::string, std::string>* variables);
 
 class FieldGenerator {
@@ -66,9 +73,15 @@ class FieldGenerator {
 
   // Generate lines of code declaring members fields of the message class
   // needed to represent this field.  These are placed inside the message
-  // class.
+  // class.  Cold fields' members are placed inside the message's struct of
+  // cold fields instead.
   virtual void GeneratePrivateMembers(io::Printer* printer) const = 0;
 
+  // Generate declarations of static members of the message class needed by
+  // this field, such as its default value.
+  // Most field types don't need this, so the default implementation is empty.
+  virtual void GenerateStaticMembers(io::Printer* printer) const {}
+
   // Generate prototypes for all of the accessor functions related to this
   // field.  These are placed inside the class definition.
   virtual void GenerateAccessorDeclarations(io::Printer* printer) const = 0;
@@ -106,14 +119,27 @@ class FieldGenerator {
 
   // Generate initialization code for private members declared by
   // GeneratePrivateMembers(). These go into the message class's SharedCtor()
-  // method, invoked by each of the generated constructors.
+  // method, invoked by each of the generated constructors, or for cold fields
+  // into the constructor of the struct of cold fields.
   virtual void GenerateConstructorCode(io::Printer* printer) const = 0;
 
   // Generate any code that needs to go in the class's SharedDtor() method,
-  // invoked by the destructor.
+  // invoked by the destructor, or for cold fields in the destructor of the
+  // struct of cold fields.
   // Most field types don't need this, so the default implementation is empty.
   virtual void GenerateDestructorCode(io::Printer* printer) const {}
 
+  // Generate lines of code which construct static data used by the field,
+  // such as a default value kept in static storage.  These are placed in the
+  // file's InitDefaults() function, before the default instance is built.
+  // Most field types don't need this, so the default implementation is empty.
+  virtual void GenerateDefaultValueInitializer(io::Printer* printer) const {}
+
+  // Generate lines of code which destroy what
+  // GenerateDefaultValueInitializer() constructed.  These are placed in the
+  // file's ShutdownFile() function.
+  virtual void GenerateDefaultValueShutdownCode(io::Printer* printer) const {}
+
   // Generate lines to decode this field, which will be placed inside the
   // message's MergeFromCodedStream() method.
   virtual void GenerateMergeFromCodedStream(io::Printer* printer) const = 0;
@@ -144,7 +170,7 @@ class FieldGenerator {
 // Convenience class which constructs FieldGenerators for a Descriptor.
 class FieldGeneratorMap {
  public:
-  explicit FieldGeneratorMap(const Descriptor* descriptor);
+  FieldGeneratorMap(const Descriptor* descriptor, const Options& options);
   ~FieldGeneratorMap();
 
   const FieldGenerator& get(const FieldDescriptor* field) const;
@@ -153,7 +179,8 @@ class FieldGeneratorMap {
   const Descriptor* descriptor_;
   scoped_array<scoped_ptr<FieldGenerator> > field_generators_;
 
-  static FieldGenerator* MakeGenerator(const FieldDescriptor* field);
+  static FieldGenerator* MakeGenerator(const FieldDescriptor* field,
+                                       const Options& options);
 
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(FieldGeneratorMap);
 };
@@ -0,0 +1,382 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Tests the code generated for cpp_test_field_profile.proto, which is
+// compiled with the field_profile option so that its rarely accessed fields
+// are moved out of the message into a lazily allocated struct.  The fields
+// must behave exactly as they would without the profile.
+
+#include <google/protobuf/compiler/cpp/cpp_test_field_profile.pb.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace cpp {
+
+// Can't use an anonymous namespace here due to brokenness of Tru64 compiler.
+namespace cpp_field_profile_unittest {
+
+using ::protobuf_unittest::TestFieldProfile;
+using ::protobuf_unittest::TestNoFieldProfile;
+
+void SetColdFields(TestFieldProfile* message) {
+  message->set_cold_int64(5);
+  message->set_cold_string("6");
+  message->set_cold_bytes("7");
+  message->mutable_cold_message()->set_bb(8);
+  message->mutable_cold_import_message()->set_d(9);
+  message->set_cold_enum(TestFieldProfile::FOO);
+  message->add_cold_repeated_int32(11);
+  message->add_cold_repeated_string("12");
+  message->add_cold_repeated_message()->set_bb(13);
+  message->set_cold_bool(true);
+}
+
+void ExpectColdFieldsSet(const TestFieldProfile& message) {
+  EXPECT_TRUE(message.has_cold_int64());
+  EXPECT_TRUE(message.has_cold_string());
+  EXPECT_TRUE(message.has_cold_bytes());
+  EXPECT_TRUE(message.has_cold_message());
+  EXPECT_TRUE(message.has_cold_import_message());
+  EXPECT_TRUE(message.has_cold_enum());
+  EXPECT_TRUE(message.has_cold_bool());
+
+  EXPECT_EQ(5, message.cold_int64());
+  EXPECT_EQ("6", message.cold_string());
+  EXPECT_EQ("7", message.cold_bytes());
+  EXPECT_EQ(8, message.cold_message().bb());
+  EXPECT_EQ(9, message.cold_import_message().d());
+  EXPECT_EQ(TestFieldProfile::FOO, message.cold_enum());
+  ASSERT_EQ(1, message.cold_repeated_int32_size());
+  EXPECT_EQ(11, message.cold_repeated_int32(0));
+  ASSERT_EQ(1, message.cold_repeated_string_size());
+  EXPECT_EQ("12", message.cold_repeated_string(0));
+  ASSERT_EQ(1, message.cold_repeated_message_size());
+  EXPECT_EQ(13, message.cold_repeated_message(0).bb());
+  EXPECT_TRUE(message.cold_bool());
+}
+
+void ExpectColdFieldsClear(const TestFieldProfile& message) {
+  EXPECT_FALSE(message.has_cold_int64());
+  EXPECT_FALSE(message.has_cold_string());
+  EXPECT_FALSE(message.has_cold_bytes());
+  EXPECT_FALSE(message.has_cold_message());
+  EXPECT_FALSE(message.has_cold_import_message());
+  EXPECT_FALSE(message.has_cold_enum());
+  EXPECT_FALSE(message.has_cold_bool());
+
+  EXPECT_EQ(0, message.cold_int64());
+  EXPECT_EQ("cold", message.cold_string());
+  EXPECT_EQ("", message.cold_bytes());
+  EXPECT_FALSE(message.cold_message().has_bb());
+  EXPECT_FALSE(message.cold_import_message().has_d());
+  EXPECT_EQ(TestFieldProfile::BAR, message.cold_enum());
+  EXPECT_EQ(0, message.cold_repeated_int32_size());
+  EXPECT_EQ(0, message.cold_repeated_string_size());
+  EXPECT_EQ(0, message.cold_repeated_message_size());
+  EXPECT_FALSE(message.cold_bool());
+}
+
+TEST(FieldProfileTest, Defaults) {
+  TestFieldProfile message;
+  ExpectColdFieldsClear(message);
+  ExpectColdFieldsClear(TestFieldProfile::default_instance());
+
+  // Defaults of cold submessages are the default instances, as usual.
+  EXPECT_EQ(&TestFieldProfile::NestedMessage::default_instance(),
+            &message.cold_message());
+  EXPECT_EQ(&protobuf_unittest_import::ImportMessage::default_instance(),
+            &message.cold_import_message());
+}
+
+TEST(FieldProfileTest, Accessors) {
+  TestFieldProfile message;
+  SetColdFields(&message);
+  ExpectColdFieldsSet(message);
+
+  message.set_cold_int64(50);
+  EXPECT_EQ(50, message.cold_int64());
+  message.mutable_cold_repeated_int32()->Add(110);
+  EXPECT_EQ(2, message.cold_repeated_int32_size());
+  message.set_cold_repeated_string(0, "120");
+  EXPECT_EQ("120", message.cold_repeated_string(0));
+}
+
+TEST(FieldProfileTest, ColdFieldsAreMovedOutOfTheMessage) {
+  TestFieldProfile message;
+  const int empty_size = message.SpaceUsed();
+
+  // Setting hot fields does not allocate the cold ones.  (The repeated
+  // fields' first elements fit in their initial space.)
+  message.set_hot_int32(1);
+  message.add_hot_repeated_int32(4);
+  message.add_packed_int32(15);
+  const int hot_size = message.SpaceUsed();
+  EXPECT_EQ(empty_size, hot_size);
+
+  // Reading and clearing cold fields does not either.
+  EXPECT_EQ(0, message.cold_int64());
+  EXPECT_EQ(0, message.cold_repeated_message_size());
+  message.clear_cold_int64();
+  message.clear_cold_repeated_string();
+  message.clear_cold_message();
+  EXPECT_EQ(hot_size, message.SpaceUsed());
+
+  // The first cold field set does.
+  message.set_cold_bool(true);
+  EXPECT_GT(message.SpaceUsed(), hot_size);
+  EXPECT_TRUE(message.cold_bool());
+
+  // Clearing the message keeps them, as it keeps the rest of its memory.
+  const int cold_size = message.SpaceUsed();
+  message.Clear();
+  EXPECT_FALSE(message.has_cold_bool());
+  EXPECT_EQ(cold_size, message.SpaceUsed());
+}
+
+TEST(FieldProfileTest, Clear) {
+  TestFieldProfile message;
+  message.set_hot_int32(1);
+  SetColdFields(&message);
+  message.Clear();
+  EXPECT_FALSE(message.has_hot_int32());
+  ExpectColdFieldsClear(message);
+
+  SetColdFields(&message);
+  message.clear_cold_int64();
+  message.clear_cold_string();
+  message.clear_cold_message();
+  message.clear_cold_enum();
+  message.clear_cold_repeated_int32();
+  message.clear_cold_repeated_message();
+  EXPECT_FALSE(message.has_cold_int64());
+  EXPECT_EQ("cold", message.cold_string());
+  EXPECT_FALSE(message.has_cold_message());
+  EXPECT_EQ(TestFieldProfile::BAR, message.cold_enum());
+  EXPECT_EQ(0, message.cold_repeated_int32_size());
+  EXPECT_EQ(0, message.cold_repeated_message_size());
+  EXPECT_EQ("7", message.cold_bytes());
+  EXPECT_EQ(1, message.cold_repeated_string_size());
+}
+
+TEST(FieldProfileTest, Release) {
+  TestFieldProfile message;
+  EXPECT_TRUE(message.release_cold_string() == NULL);
+  EXPECT_TRUE(message.release_cold_message() == NULL);
+
+  SetColdFields(&message);
+  ::std::string* str = message.release_cold_string();
+  ASSERT_TRUE(str != NULL);
+  EXPECT_EQ("6", *str);
+  delete str;
+  EXPECT_FALSE(message.has_cold_string());
+  EXPECT_EQ("cold", message.cold_string());
+
+  TestFieldProfile::NestedMessage* nested = message.release_cold_message();
+  ASSERT_TRUE(nested != NULL);
+  EXPECT_EQ(8, nested->bb());
+  delete nested;
+  EXPECT_FALSE(message.has_cold_message());
+}
+
+TEST(FieldProfileTest, CopyAndMerge) {
+  TestFieldProfile message1;
+  message1.set_hot_int32(1);
+  SetColdFields(&message1);
+
+  TestFieldProfile message2(message1);
+  EXPECT_EQ(1, message2.hot_int32());
+  ExpectColdFieldsSet(message2);
+
+  TestFieldProfile message3;
+  message3.CopyFrom(message2);
+  ExpectColdFieldsSet(message3);
+
+  // Merging an empty message leaves the cold fields unallocated.
+  TestFieldProfile message4;
+  const int empty_size = message4.SpaceUsed();
+  message4.MergeFrom(TestFieldProfile());
+  EXPECT_EQ(empty_size, message4.SpaceUsed());
+
+  message4.MergeFrom(message1);
+  message4.MergeFrom(message1);
+  EXPECT_EQ(2, message4.cold_repeated_int32_size());
+  EXPECT_EQ(2, message4.cold_repeated_message_size());
+  EXPECT_EQ(5, message4.cold_int64());
+}
+
+TEST(FieldProfileTest, Swap) {
+  TestFieldProfile message1;
+  TestFieldProfile message2;
+  message1.set_hot_int32(1);
+  SetColdFields(&message1);
+
+  message1.Swap(&message2);
+  EXPECT_FALSE(message1.has_hot_int32());
+  ExpectColdFieldsClear(message1);
+  EXPECT_EQ(1, message2.hot_int32());
+  ExpectColdFieldsSet(message2);
+
+  // Both messages must still be usable after swapping in the default cold
+  // fields.
+  SetColdFields(&message1);
+  message2.Clear();
+  ExpectColdFieldsSet(message1);
+  ExpectColdFieldsClear(message2);
+}
+
+TEST(FieldProfileTest, Serialization) {
+  TestFieldProfile message1;
+  message1.set_hot_int32(1);
+  message1.set_hot_string("2");
+  message1.add_packed_int32(15);
+  SetColdFields(&message1);
+
+  ::std::string data;
+  ASSERT_TRUE(message1.SerializeToString(&data));
+  EXPECT_EQ(message1.ByteSize(), data.size());
+
+  TestFieldProfile message2;
+  ASSERT_TRUE(message2.ParseFromString(data));
+  EXPECT_EQ(1, message2.hot_int32());
+  EXPECT_EQ("2", message2.hot_string());
+  EXPECT_EQ(15, message2.packed_int32(0));
+  ExpectColdFieldsSet(message2);
+  EXPECT_EQ(data, message2.SerializeAsString());
+
+  // A message with no cold fields set parses without allocating them.
+  TestFieldProfile message3;
+  message3.set_hot_int32(1);
+  TestFieldProfile message4;
+  const int empty_size = message4.SpaceUsed();
+  ASSERT_TRUE(message4.ParseFromString(message3.SerializeAsString()));
+  EXPECT_EQ(empty_size, message4.SpaceUsed());
+}
+
+TEST(FieldProfileTest, Reflection) {
+  TestFieldProfile message;
+  const Descriptor* descriptor = message.GetDescriptor();
+  const Reflection* reflection = message.GetReflection();
+  const FieldDescriptor* cold_int64 = descriptor->FindFieldByName("cold_int64");
+  const FieldDescriptor* cold_string =
+      descriptor->FindFieldByName("cold_string");
+  const FieldDescriptor* cold_message =
+      descriptor->FindFieldByName("cold_message");
+  const FieldDescriptor* cold_repeated_int32 =
+      descriptor->FindFieldByName("cold_repeated_int32");
+  ASSERT_TRUE(cold_int64 != NULL);
+  ASSERT_TRUE(cold_string != NULL);
+  ASSERT_TRUE(cold_message != NULL);
+  ASSERT_TRUE(cold_repeated_int32 != NULL);
+
+  // Defaults, read through the default cold fields.
+  const int empty_size = reflection->SpaceUsed(message);
+  EXPECT_EQ(0, reflection->GetInt64(message, cold_int64));
+  EXPECT_EQ("cold", reflection->GetString(message, cold_string));
+  EXPECT_EQ(&TestFieldProfile::NestedMessage::default_instance(),
+            &reflection->GetMessage(message, cold_message));
+  EXPECT_EQ(0, reflection->FieldSize(message, cold_repeated_int32));
+  reflection->ClearField(&message, cold_repeated_int32);
+  reflection->ClearField(&message, cold_string);
+  EXPECT_EQ(empty_size, reflection->SpaceUsed(message));
+
+  // Storing default values only sets has-bits, and clearing them again
+  // allocates nothing either.
+  reflection->SetInt64(&message, cold_int64, 0);
+  reflection->SetString(&message, cold_string, "cold");
+  EXPECT_TRUE(message.has_cold_int64());
+  EXPECT_TRUE(message.has_cold_string());
+  EXPECT_EQ("cold", message.cold_string());
+  EXPECT_EQ(empty_size, reflection->SpaceUsed(message));
+  TestFieldProfile parsed;
+  ASSERT_TRUE(parsed.ParseFromString(message.SerializeAsString()));
+  EXPECT_TRUE(parsed.has_cold_int64());
+  EXPECT_TRUE(parsed.has_cold_string());
+  reflection->ClearField(&message, cold_int64);
+  reflection->ClearField(&message, cold_string);
+  EXPECT_FALSE(message.has_cold_int64());
+  EXPECT_FALSE(message.has_cold_string());
+  EXPECT_EQ(empty_size, reflection->SpaceUsed(message));
+
+  reflection->SetInt64(&message, cold_int64, 5);
+  reflection->SetString(&message, cold_string, "6");
+  reflection->MutableMessage(&message, cold_message);
+  reflection->AddInt32(&message, cold_repeated_int32, 11);
+  EXPECT_EQ(5, message.cold_int64());
+  EXPECT_EQ("6", message.cold_string());
+  EXPECT_TRUE(message.has_cold_message());
+  EXPECT_EQ(11, message.cold_repeated_int32(0));
+  EXPECT_GT(reflection->SpaceUsed(message), empty_size);
+
+  std::vector<const FieldDescriptor*> fields;
+  reflection->ListFields(message, &fields);
+  EXPECT_EQ(4, fields.size());
+
+  TestFieldProfile message2;
+  reflection->Swap(&message, &message2);
+  EXPECT_FALSE(message.has_cold_int64());
+  EXPECT_EQ(5, message2.cold_int64());
+  EXPECT_EQ(11, message2.cold_repeated_int32(0));
+
+  reflection->ClearField(&message2, cold_int64);
+  reflection->ClearField(&message2, cold_repeated_int32);
+  EXPECT_FALSE(message2.has_cold_int64());
+  EXPECT_EQ(0, message2.cold_repeated_int32_size());
+  EXPECT_EQ("6", message2.cold_string());
+
+  // Reflection-based copies agree with the generated ones.
+  TestFieldProfile message3;
+  SetColdFields(&message3);
+  TestFieldProfile message4;
+  message4.CopyFrom(static_cast<const Message&>(message3));
+  ExpectColdFieldsSet(message4);
+}
+
+TEST(FieldProfileTest, NoProfile) {
+  // A message without counts in the profile is generated as usual.
+  TestNoFieldProfile message;
+  message.set_a(1);
+  message.set_b("2");
+  TestNoFieldProfile message2;
+  ASSERT_TRUE(message2.ParseFromString(message.SerializeAsString()));
+  EXPECT_EQ(1, message2.a());
+  EXPECT_EQ("2", message2.b());
+}
+
+}  // namespace cpp_field_profile_unittest
+
+}  // namespace cpp
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
@@ -51,7 +51,7 @@ namespace cpp {
 // ===================================================================
 
 FileGenerator::FileGenerator(const FileDescriptor* file,
-                             const std::string& dllexport_decl)
+                             const Options& options)
   : file_(file),
     message_generators_(
       new scoped_ptr<MessageGenerator>[file->message_type_count()]),
@@ -61,26 +61,26 @@ FileGenerator::FileGenerator(const FileDescriptor* file,
       new scoped_ptr<ServiceGenerator>[file->service_count()]),
     extension_generators_(
       new scoped_ptr<ExtensionGenerator>[file->extension_count()]),
-    dllexport_decl_(dllexport_decl) {
+    dllexport_decl_(options.dllexport_decl) {
 
   for (int i = 0; i < file->message_type_count(); i++) {
     message_generators_[i].reset(
-      new MessageGenerator(file->message_type(i), dllexport_decl));
+      new MessageGenerator(file->message_type(i), options));
   }
 
   for (int i = 0; i < file->enum_type_count(); i++) {
     enum_generators_[i].reset(
-      new EnumGenerator(file->enum_type(i), dllexport_decl));
+      new EnumGenerator(file->enum_type(i), dllexport_decl_));
   }
 
   for (int i = 0; i < file->service_count(); i++) {
     service_generators_[i].reset(
-      new ServiceGenerator(file->service(i), dllexport_decl));
+      new ServiceGenerator(file->service(i), options));
   }
 
   for (int i = 0; i < file->extension_count(); i++) {
     extension_generators_[i].reset(
-      new ExtensionGenerator(file->extension(i), dllexport_decl));
+      new ExtensionGenerator(file->extension(i), dllexport_decl_));
   }
 
   protobuf::SplitStringUsing(file_->package(), ".", &package_parts_);
@@ -167,9 +167,11 @@ void FileGenerator::GenerateHeader(io::Printer* printer) {
   printer->Print(
     // Note that we don't put dllexport_decl on these because they are only
     // called by the .pb.cc file in which they are defined.
+    "void $initdefaultsname$();\n"
     "void $assigndescriptorsname$();\n"
     "void $shutdownfilename$();\n"
     "\n",
+    "initdefaultsname", GlobalInitDefaultsName(file_->name()),
     "assigndescriptorsname", GlobalAssignDescriptorsName(file_->name()),
     "shutdownfilename", GlobalShutdownFileName(file_->name()));
 
@@ -384,18 +386,66 @@ void FileGenerator::GenerateBuildDescriptors(io::Printer* printer) {
   // FileDescriptorProto for this .proto file to the global DescriptorPool
   // for generated files (DescriptorPool::generated_pool()).  It always runs
   // at static initialization time, so all files will be registered before
-  // main() starts.  This procedure also constructs default instances and
-  // registers extensions.
+  // main() starts.  It only records the encoded bytes and registers
+  // extensions; nothing is parsed or built at that point.
   //
-  // Its sibling, AssignDescriptors(), actually pulls the compiled
-  // FileDescriptor from the DescriptorPool and uses it to populate all of
-  // the global variables which store pointers to the descriptor objects.
-  // It also constructs the reflection objects.  It is called the first time
-  // anyone calls descriptor() or GetReflection() on one of the types defined
-  // in the file.
-
-  // In optimize_for = LITE_RUNTIME mode, we don't generate AssignDescriptors()
-  // and we only use AddDescriptors() to allocate default instances.
+  // InitDefaults() constructs the default instances.  It runs the first time
+  // default_instance() or descriptor() of one of the file's types is called,
+  // or a message is constructed whose fields point at the default values it
+  // constructs (e.g. a string field with a non-empty default).  Other
+  // messages do not check, so constructing them costs nothing extra.
+  //
+  // AssignDescriptors() actually pulls the compiled FileDescriptor from the
+  // DescriptorPool and uses it to populate all of the global variables which
+  // store pointers to the descriptor objects.  It also constructs the
+  // reflection objects.  It is called the first time anyone calls
+  // descriptor() or GetReflection() on one of the types defined in the file.
+
+  // Default instances and default values live in static storage (see
+  // StaticStorage in generated_message_util.h), so ShutdownFile() has to know
+  // whether they were ever constructed.
+  printer->Print(
+    "\n"
+    "namespace {\n"
+    "\n"
+    "bool protobuf_defaults_initialized_ = false;\n"
+    "\n"
+    "}  // namespace\n"
+    "\n"
+    "void $initdefaultsname$() {\n",
+    "initdefaultsname", GlobalInitDefaultsName(file_->name()));
+  printer->Indent();
+
+  // Construct and initialize default instances.
+  for (int i = 0; i < file_->message_type_count(); i++) {
+    message_generators_[i]->GenerateDefaultInstanceAllocator(printer);
+  }
+  for (int i = 0; i < file_->message_type_count(); i++) {
+    message_generators_[i]->GenerateDefaultInstanceInitializer(printer);
+  }
+  printer->Print("protobuf_defaults_initialized_ = true;\n");
+
+  printer->Outdent();
+  printer->Print(
+    "}\n"
+    "\n");
+
+  // protobuf_InitDefaultsOnce():  The first time it is called, calls
+  // InitDefaults().  All later times, waits for the first call to complete
+  // and then returns.
+  printer->Print(
+    "namespace {\n"
+    "\n"
+    "GOOGLE_PROTOBUF_DECLARE_ONCE(protobuf_InitDefaults_once_);\n"
+    "inline void protobuf_InitDefaultsOnce() {\n"
+    "  ::google::protobuf::GoogleOnceInit(&protobuf_InitDefaults_once_,\n"
+    "                 &$initdefaultsname$);\n"
+    "}\n"
+    "\n"
+    "}  // namespace\n",
+    "initdefaultsname", GlobalInitDefaultsName(file_->name()));
+
+  // In optimize_for = LITE_RUNTIME mode, we don't generate AssignDescriptors().
   if (HasDescriptorMethods(file_)) {
     printer->Print(
       "\n"
@@ -408,7 +458,8 @@ void FileGenerator::GenerateBuildDescriptors(io::Printer* printer) {
     // been called yet, so we call it manually.  Note that it's fine if
     // AddDescriptors() is called multiple times.
     printer->Print(
-      "$adddescriptorsname$();\n",
+      "$adddescriptorsname$();\n"
+      "protobuf_InitDefaultsOnce();\n",
       "adddescriptorsname", GlobalAddDescriptorsName(file_->name()));
 
     // Get the file's descriptor from the pool.
@@ -483,6 +534,13 @@ void FileGenerator::GenerateBuildDescriptors(io::Printer* printer) {
     "shutdownfilename", GlobalShutdownFileName(file_->name()));
   printer->Indent();
 
+  printer->Print("if (protobuf_defaults_initialized_) {\n");
+  printer->Indent();
+  for (int i = 0; i < file_->message_type_count(); i++) {
+    message_generators_[i]->GenerateDefaultInstanceShutdownCode(printer);
+  }
+  printer->Outdent();
+  printer->Print("}\n");
   for (int i = 0; i < file_->message_type_count(); i++) {
     message_generators_[i]->GenerateShutdownCode(printer);
   }
@@ -528,7 +586,7 @@ void FileGenerator::GenerateBuildDescriptors(io::Printer* printer) {
   if (HasDescriptorMethods(file_)) {
     // Embed the descriptor.  We simply serialize the entire FileDescriptorProto
     // and embed it as a std::string literal, which is parsed and built into real
-    // descriptors at initialization time.
+    // descriptors the first time the file is looked up.
     FileDescriptorProto file_proto;
     file_->CopyTo(&file_proto);
     std::string file_data;
@@ -554,17 +612,14 @@ void FileGenerator::GenerateBuildDescriptors(io::Printer* printer) {
       "filename", file_->name());
   }
 
-  // Allocate and initialize default instances.  This can't be done lazily
-  // since default instances are returned by simple accessors and are used with
-  // extensions.  Speaking of which, we also register extensions at this time.
-  for (int i = 0; i < file_->message_type_count(); i++) {
-    message_generators_[i]->GenerateDefaultInstanceAllocator(printer);
-  }
+  // Extensions must be known before anything is parsed, so they are still
+  // registered eagerly.  This initializes the defaults of the types they
+  // refer to, but nothing else.
   for (int i = 0; i < file_->extension_count(); i++) {
     extension_generators_[i]->GenerateRegistration(printer);
   }
   for (int i = 0; i < file_->message_type_count(); i++) {
-    message_generators_[i]->GenerateDefaultInstanceInitializer(printer);
+    message_generators_[i]->GenerateExtensionRegistrations(printer);
   }
 
   printer->Print(
@@ -39,6 +39,7 @@
 #include <vector>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/compiler/cpp/cpp_field.h>
+#include <google/protobuf/compiler/cpp/cpp_options.h>
 
 // Need to include these (vs. forward declare) as a scoped_ptr inside a
 // scoped_array needs to be fully defined. Otherwise some compilers complain.
@@ -61,9 +62,8 @@ namespace cpp {
 
 class FileGenerator {
  public:
-  // See generator.cc for the meaning of dllexport_decl.
   explicit FileGenerator(const FileDescriptor* file,
-                         const std::string& dllexport_decl);
+                         const Options& options);
   ~FileGenerator();
 
   void GenerateHeader(io::Printer* printer);
@@ -34,6 +34,7 @@
 
 #include <google/protobuf/compiler/cpp/cpp_generator.h>
 
+#include <stdio.h>
 #include <vector>
 #include <utility>
 
@@ -42,14 +43,95 @@
 #include <google/protobuf/io/printer.h>
 #include <google/protobuf/io/zero_copy_stream.h>
 #include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
 
 namespace google {
 namespace protobuf {
 namespace compiler {
 namespace cpp {
 
+struct CppGenerator::FieldProfile {
+  std::string contents;                  // of the file, for AppendCacheKey()
+  std::string error;                     // empty if the file was read
+  std::map<std::string, uint64> counts;
+};
+
+namespace {
+
+// Reads a field profile:  one "<full field name> <count>" pair per line.
+// Blank lines and text after '#' are ignored.
+bool ReadFieldProfile(const std::string& filename,
+                      std::string* contents,
+                      std::map<std::string, uint64>* profile,
+                      std::string* error) {
+  FILE* file = fopen(filename.c_str(), "rb");
+  if (file == NULL) {
+    *error = filename + ": Could not open field profile.";
+    return false;
+  }
+  char buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    contents->append(buffer, size);
+  }
+  fclose(file);
+
+  std::vector<std::string> lines;
+  SplitStringUsing(*contents, "\r\n", &lines);
+  for (int i = 0; i < lines.size(); i++) {
+    std::string line = lines[i].substr(0, lines[i].find('#'));
+    std::vector<std::string> parts;
+    SplitStringUsing(line, " \t", &parts);
+    if (parts.empty()) continue;
+
+    char* end = NULL;
+    uint64 count = parts.size() == 2
+        ? strtou64(parts[1].c_str(), &end, 10) : 0;
+    if (end == NULL || *end != '\0' || end == parts[1].c_str()) {
+      *error = filename + ": Expected \"<field name> <count>\": " + lines[i];
+      return false;
+    }
+    (*profile)[parts[0]] += count;
+  }
+  return true;
+}
+
+}  // namespace
+
 CppGenerator::CppGenerator() {}
-CppGenerator::~CppGenerator() {}
+CppGenerator::~CppGenerator() {
+  STLDeleteValues(&field_profiles_);
+}
+
+const CppGenerator::FieldProfile* CppGenerator::GetFieldProfile(
+    const std::string& filename) const {
+  MutexLock lock(&field_profiles_mutex_);
+  FieldProfile*& profile = field_profiles_[filename];
+  if (profile == NULL) {
+    profile = new FieldProfile;
+    ReadFieldProfile(filename, &profile->contents, &profile->counts,
+                     &profile->error);
+  }
+  return profile;
+}
+
+bool CppGenerator::AppendCacheKey(const std::string& parameter,
+                                  std::string* key) const {
+  // Generated code depends on the field profile's contents, not just on its
+  // name.
+  std::vector<std::pair<std::string, std::string> > options;
+  compiler::ParseGeneratorParameter(parameter, &options);
+  for (int i = 0; i < options.size(); i++) {
+    if (options[i].first == "field_profile") {
+      const FieldProfile* profile = GetFieldProfile(options[i].second);
+      if (!profile->error.empty()) return false;
+      key->append(profile->contents);
+      key->push_back('\0');
+    }
+  }
+  return true;
+}
 
 bool CppGenerator::Generate(const FileDescriptor* file,
                             const std::string& parameter,
@@ -61,12 +143,6 @@ bool CppGenerator::Generate(const FileDescriptor* file,
   // -----------------------------------------------------------------
   // parse generator options
 
-  // TODO(kenton):  If we ever have more options, we may want to create a
-  //   class that encapsulates them which we can pass down to all the
-  //   generator classes.  Currently we pass dllexport_decl down to all of
-  //   them via the constructors, but we don't want to have to add another
-  //   constructor parameter for every option.
-
   // If the dllexport_decl option is passed to the compiler, we need to write
   // it in front of every symbol that should be exported if this .proto is
   // compiled into a Windows DLL.  E.g., if the user invokes the protocol
@@ -78,11 +154,50 @@ bool CppGenerator::Generate(const FileDescriptor* file,
   //   }
   // FOO_EXPORT is a macro which should expand to __declspec(dllexport) or
   // __declspec(dllimport) depending on what is being compiled.
-  std::string dllexport_decl;
+  //
+  // If the future_stubs option is passed (--cpp_out=future_stubs=true:outdir),
+  // service stubs get, besides each usual method, one taking and returning an
+  // RpcFuture (see service.h) in place of the response and "done" callback.
+  //
+  // If the field_profile option names a file of field access counts
+  // (--cpp_out=field_profile=foo.profile:outdir), each message with counts in
+  // it gets its fields laid out hottest first, and the fields it counts
+  // rarely or never move into a struct allocated on first write.  See
+  // IsColdField() in cpp_helpers.h.  The profile is read once, however many
+  // files it is used for.
+  //
+  // If the has_bit_iteration option is passed
+  // (--cpp_out=has_bit_iteration=true:outdir), messages with many singular
+  // fields get Clear(), MergeFrom(), ByteSize() and SerializeWithCachedSizes()
+  // which visit only the fields that are set.  That pays off for wide messages
+  // of which few fields are set, but costs messages with most of theirs set.
+  // See UseHasBitIteration() in cpp_message.cc.
+  Options file_options;
 
   for (int i = 0; i < options.size(); i++) {
     if (options[i].first == "dllexport_decl") {
-      dllexport_decl = options[i].second;
+      file_options.dllexport_decl = options[i].second;
+    } else if (options[i].first == "future_stubs") {
+      if (options[i].second == "true") {
+        file_options.future_stubs = true;
+      } else if (options[i].second != "false") {
+        *error = "future_stubs must be true or false.";
+        return false;
+      }
+    } else if (options[i].first == "has_bit_iteration") {
+      if (options[i].second == "true") {
+        file_options.has_bit_iteration = true;
+      } else if (options[i].second != "false") {
+        *error = "has_bit_iteration must be true or false.";
+        return false;
+      }
+    } else if (options[i].first == "field_profile") {
+      const FieldProfile* profile = GetFieldProfile(options[i].second);
+      if (!profile->error.empty()) {
+        *error = profile->error;
+        return false;
+      }
+      file_options.field_profile = &profile->counts;
     } else {
       *error = "Unknown generator option: " + options[i].first;
       return false;
@@ -95,7 +210,7 @@ bool CppGenerator::Generate(const FileDescriptor* file,
   std::string basename = StripProto(file->name());
   basename.append(".pb");
 
-  FileGenerator file_generator(file, dllexport_decl);
+  FileGenerator file_generator(file, file_options);
 
   // Generate header.
   {
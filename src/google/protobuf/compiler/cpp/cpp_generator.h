@@ -37,6 +37,7 @@
 #ifndef GOOGLE_PROTOBUF_COMPILER_CPP_GENERATOR_H__
 #define GOOGLE_PROTOBUF_COMPILER_CPP_GENERATOR_H__
 
+#include <map>
 #include <string>
 #include <google/protobuf/compiler/code_generator.h>
 
@@ -59,8 +60,19 @@ class LIBPROTOC_EXPORT CppGenerator : public CodeGenerator {
                 const std::string& parameter,
                 GeneratorContext* generator_context,
                 std::string* error) const;
+  bool AppendCacheKey(const std::string& parameter, std::string* key) const;
 
  private:
+  struct FieldProfile;
+
+  // Returns the field profile in the given file, reading it the first time
+  // it is asked for.  protoc runs the generator once for each file, from
+  // several threads with -j.
+  const FieldProfile* GetFieldProfile(const std::string& filename) const;
+
+  mutable Mutex field_profiles_mutex_;
+  mutable std::map<std::string, FieldProfile*> field_profiles_;
+
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(CppGenerator);
 };
 
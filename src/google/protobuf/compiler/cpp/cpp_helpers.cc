@@ -32,7 +32,9 @@
 //  Based on original Protocol Buffers design by
 //  Sanjay Ghemawat, Jeff Dean, and others.
 
+#include <algorithm>
 #include <limits>
+#include <map>
 #include <google/protobuf/stubs/hash.h>
 
 #include <google/protobuf/compiler/cpp/cpp_helpers.h>
@@ -325,6 +327,11 @@ std::string GlobalAddDescriptorsName(const std::string& filename) {
   return "protobuf_AddDesc_" + FilenameIdentifier(filename);
 }
 
+// Return the name of the InitDefaults() function for a given file.
+std::string GlobalInitDefaultsName(const std::string& filename) {
+  return "protobuf_InitDefaults_" + FilenameIdentifier(filename);
+}
+
 // Return the name of the AssignDescriptors() function for a given file.
 std::string GlobalAssignDescriptorsName(const std::string& filename) {
   return "protobuf_AssignDesc_" + FilenameIdentifier(filename);
@@ -340,6 +347,45 @@ std::string EscapeTrigraphs(const std::string& to_escape) {
   return protobuf::StringReplace(to_escape, "?", "\\?", true);
 }
 
+bool HasFieldProfile(const Descriptor* descriptor, const Options& options) {
+  if (options.field_profile == NULL) return false;
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    if (options.field_profile->count(descriptor->field(i)->full_name()) > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64 FieldAccessCount(const FieldDescriptor* field, const Options& options) {
+  if (options.field_profile == NULL) return 0;
+  std::map<std::string, uint64>::const_iterator iter =
+      options.field_profile->find(field->full_name());
+  return iter == options.field_profile->end() ? 0 : iter->second;
+}
+
+bool IsColdField(const FieldDescriptor* field, const Options& options) {
+  const Descriptor* descriptor = field->containing_type();
+  if (field->options().packed() ||
+      !HasFieldProfile(descriptor, options)) {
+    return false;
+  }
+  uint64 hottest = 0;
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    hottest = std::max(hottest,
+                       FieldAccessCount(descriptor->field(i), options));
+  }
+  uint64 count = FieldAccessCount(field, options);
+  return count == 0 || count < hottest / 100;
+}
+
+bool HasColdFields(const Descriptor* descriptor, const Options& options) {
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    if (IsColdField(descriptor->field(i), options)) return true;
+  }
+  return false;
+}
+
 }  // namespace cpp
 }  // namespace compiler
 }  // namespace protobuf
@@ -38,6 +38,7 @@
 #include <string>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/compiler/cpp/cpp_options.h>
 
 namespace google {
 namespace protobuf {
@@ -106,6 +107,9 @@ std::string FilenameIdentifier(const std::string& filename);
 // Return the name of the AddDescriptors() function for a given file.
 std::string GlobalAddDescriptorsName(const std::string& filename);
 
+// Return the name of the InitDefaults() function for a given file.
+std::string GlobalInitDefaultsName(const std::string& filename);
+
 // Return the name of the AssignDescriptors() function for a given file.
 std::string GlobalAssignDescriptorsName(const std::string& filename);
 
@@ -150,6 +154,22 @@ inline bool HasFastArraySerialization(const FileDescriptor* file) {
   return file->options().optimize_for() == FileOptions::SPEED;
 }
 
+// Does the field profile count accesses to any field of this message?  If
+// not, its fields keep their usual layout.
+bool HasFieldProfile(const Descriptor* descriptor, const Options& options);
+
+// How many accesses the field profile counts for the field (0 if none).
+uint64 FieldAccessCount(const FieldDescriptor* field, const Options& options);
+
+// Should the field live in the message's lazily allocated struct of cold
+// fields?  True for fields of a profiled message which the profile counts
+// less than 1% as often as the message's hottest field.  Packed repeated
+// fields stay in the message, with their cached byte size.
+bool IsColdField(const FieldDescriptor* field, const Options& options);
+
+// Does the message have any cold fields?
+bool HasColdFields(const Descriptor* descriptor, const Options& options);
+
 
 }  // namespace cpp
 }  // namespace compiler
@@ -73,6 +73,21 @@ struct FieldOrderingByNumber {
   }
 };
 
+// Sort fields by how many accesses the field profile counts, most first.
+class FieldOrderingByAccessCount {
+ public:
+  explicit FieldOrderingByAccessCount(const Options& options)
+    : options_(&options) {}
+
+  inline bool operator()(const FieldDescriptor* a,
+                         const FieldDescriptor* b) const {
+    return FieldAccessCount(a, *options_) > FieldAccessCount(b, *options_);
+  }
+
+ private:
+  const Options* options_;
+};
+
 const char* kWireTypeNames[] = {
   "VARINT",
   "FIXED64",
@@ -103,6 +118,171 @@ struct ExtensionRangeSorter {
   }
 };
 
+// With the has_bit_iteration option, messages with more singular fields than
+// this visit only the fields whose has-bits are set in Clear(), MergeFrom(),
+// ByteSize() and SerializeWithCachedSizes(), finding them with
+// LowestSetBit32() and jumping to each one's code through a switch on its
+// index.  That costs O(set fields) rather than O(declared fields), which pays
+// off for wide messages of which only a few fields are set.  In smaller
+// messages, and in those with most of their fields set, testing each has-bit
+// in turn is cheaper than the switch's indirect jump, so the option is off by
+// default.
+const int kMinFieldsForHasBitIteration = 32;
+
+bool UseHasBitIteration(const Descriptor* descriptor, const Options& options) {
+  if (!options.has_bit_iteration) return false;
+  int singular_fields = 0;
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    if (!descriptor->field(i)->is_repeated()) ++singular_fields;
+  }
+  return singular_fields > kMinFieldsForHasBitIteration;
+}
+
+// Prints the start of a loop over the set bits of the uint32 "bits", one
+// word of a bit array, switching on the index of each bit within the word.
+// Each case is printed between PrintSetBitCaseStart() and
+// PrintSetBitCaseEnd(), and the loop is closed by PrintSetBitLoopEnd().
+// Giving each word its own loop keeps the case labels dense, so that the
+// switch compiles to a jump table.
+void PrintSetBitLoopStart(io::Printer* printer, const std::string& bits) {
+  printer->Print(
+    "for (::google::protobuf::uint32 bits = $bits$; bits != 0;\n"
+    "     bits &= bits - 1) {\n"
+    "  switch (::google::protobuf::internal::LowestSetBit32(bits)) {\n",
+    "bits", bits);
+  printer->Indent();
+  printer->Indent();
+}
+
+void PrintSetBitCaseStart(io::Printer* printer, int bit) {
+  printer->Print(
+    "case $bit$: {\n",
+    "bit", SimpleItoa(bit % 32));
+  printer->Indent();
+}
+
+void PrintSetBitCaseEnd(io::Printer* printer) {
+  printer->Print("break;\n");
+  printer->Outdent();
+  printer->Print("}\n");
+}
+
+void PrintSetBitLoopEnd(io::Printer* printer) {
+  printer->Print(
+    "default:\n"
+    "  break;\n");
+  printer->Outdent();
+  printer->Outdent();
+  printer->Print(
+    "  }\n"
+    "}\n");
+}
+
+// Messages with at least this many non-cold singular fields which
+// HasZeroBytesDefault() keep them together in one block of data members.
+// Clear() resets the block with a single memset(), and MergeFrom() and
+// CopyFrom() copy it with a single memcpy() when they can.
+const int kMinFieldsForScalarBlock = 2;
+
+// Returns true if the field is a singular number, bool or enum whose default
+// value is all zero bytes, so that memset() can reset it.
+bool HasZeroBytesDefault(const FieldDescriptor* field) {
+  if (field->is_repeated()) return false;
+
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+      return field->default_value_int32() == 0;
+    case FieldDescriptor::CPPTYPE_INT64:
+      return field->default_value_int64() == 0;
+    case FieldDescriptor::CPPTYPE_UINT32:
+      return field->default_value_uint32() == 0;
+    case FieldDescriptor::CPPTYPE_UINT64:
+      return field->default_value_uint64() == 0;
+    case FieldDescriptor::CPPTYPE_DOUBLE: {
+      // -0.0 compares equal to 0.0, but its sign bit is set.
+      double value = field->default_value_double();
+      uint64 bits;
+      memcpy(&bits, &value, sizeof(bits));
+      return bits == 0;
+    }
+    case FieldDescriptor::CPPTYPE_FLOAT: {
+      float value = field->default_value_float();
+      uint32 bits;
+      memcpy(&bits, &value, sizeof(bits));
+      return bits == 0;
+    }
+    case FieldDescriptor::CPPTYPE_BOOL:
+      return !field->default_value_bool();
+    case FieldDescriptor::CPPTYPE_ENUM:
+      return field->default_value_enum()->number() == 0;
+    case FieldDescriptor::CPPTYPE_STRING:
+    case FieldDescriptor::CPPTYPE_MESSAGE:
+      return false;
+
+    // No default because we want the compiler to complain if any new
+    // CppTypes are added.
+  }
+
+  GOOGLE_LOG(FATAL) << "Can't get here.";
+  return false;
+}
+
+// Returns true if a new message of this type points at values which the
+// file's InitDefaults() constructs, so that its constructor has to run
+// InitDefaults() first:  the default values of string fields with a
+// non-empty default, and the default struct of cold fields.  Messages of
+// other types only reach the default instances through default_instance().
+bool ConstructorNeedsDefaults(const Descriptor* descriptor,
+                              const Options& options) {
+  if (HasColdFields(descriptor, options)) return true;
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const FieldDescriptor* field = descriptor->field(i);
+    if (!field->is_repeated() &&
+        field->cpp_type() == FieldDescriptor::CPPTYPE_STRING &&
+        !field->default_value_string().empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the masks of the has-bits of "fields", one per _has_bits_ word of
+// the message, as hexadecimal literals; "0" for the words holding none of
+// them.
+std::vector<std::string> HasBitMasks(
+    const Descriptor* descriptor,
+    const std::vector<const FieldDescriptor*>& fields) {
+  std::vector<uint32> masks((descriptor->field_count() + 31) / 32, 0);
+  for (int i = 0; i < fields.size(); i++) {
+    masks[fields[i]->index() / 32] |= 1u << (fields[i]->index() % 32);
+  }
+
+  std::vector<std::string> result;
+  for (int i = 0; i < masks.size(); i++) {
+    char buffer[kFastToBufferSize];
+    result.push_back(masks[i] == 0 ? std::string("0") :
+        "0x" + std::string(FastHex32ToBuffer(masks[i], buffer)) + "u");
+  }
+  return result;
+}
+
+// Returns a condition which holds if any of the has-bits of "fields" is set
+// in the array "has_bits", or, if "all" is true, if every one of them is.
+std::string HasBitsCondition(const Descriptor* descriptor,
+                             const std::vector<const FieldDescriptor*>& fields,
+                             const std::string& has_bits, bool all) {
+  std::vector<std::string> masks = HasBitMasks(descriptor, fields);
+  std::string result;
+  for (int i = 0; i < masks.size(); i++) {
+    if (masks[i] == "0") continue;
+    if (!result.empty()) result += all ? " &&\n    " : " ||\n    ";
+    std::string word = "(" + has_bits + "[" + SimpleItoa(i) + "] & " +
+                       masks[i] + ")";
+    result += all ? word + " == " + masks[i] : word + " != 0";
+  }
+  return result;
+}
+
 // Returns true if the message type has any required fields.  If it doesn't,
 // we can optimize out calls to its IsInitialized() method.
 //
@@ -280,11 +460,12 @@ void OptimizePadding(std::vector<const FieldDescriptor*>* fields) {
 // ===================================================================
 
 MessageGenerator::MessageGenerator(const Descriptor* descriptor,
-                                   const std::string& dllexport_decl)
+                                   const Options& options)
   : descriptor_(descriptor),
     classname_(ClassName(descriptor, false)),
-    dllexport_decl_(dllexport_decl),
-    field_generators_(descriptor),
+    options_(options),
+    dllexport_decl_(options.dllexport_decl),
+    field_generators_(descriptor, options),
     nested_generators_(new scoped_ptr<MessageGenerator>[
       descriptor->nested_type_count()]),
     enum_generators_(new scoped_ptr<EnumGenerator>[
@@ -294,18 +475,41 @@ MessageGenerator::MessageGenerator(const Descriptor* descriptor,
 
   for (int i = 0; i < descriptor->nested_type_count(); i++) {
     nested_generators_[i].reset(
-      new MessageGenerator(descriptor->nested_type(i), dllexport_decl));
+      new MessageGenerator(descriptor->nested_type(i), options));
   }
 
   for (int i = 0; i < descriptor->enum_type_count(); i++) {
     enum_generators_[i].reset(
-      new EnumGenerator(descriptor->enum_type(i), dllexport_decl));
+      new EnumGenerator(descriptor->enum_type(i), dllexport_decl_));
   }
 
   for (int i = 0; i < descriptor->extension_count(); i++) {
     extension_generators_[i].reset(
-      new ExtensionGenerator(descriptor->extension(i), dllexport_decl));
+      new ExtensionGenerator(descriptor->extension(i), dllexport_decl_));
+  }
+
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const FieldDescriptor* field = descriptor->field(i);
+    if (HasZeroBytesDefault(field) && !IsColdField(field, options)) {
+      scalar_block_.push_back(field);
+    }
   }
+  if (scalar_block_.size() < kMinFieldsForScalarBlock) {
+    scalar_block_.clear();
+  } else {
+    // The block is laid out the same way as the other fields; see
+    // GenerateClassDefinition().
+    if (HasFieldProfile(descriptor, options)) {
+      std::stable_sort(scalar_block_.begin(), scalar_block_.end(),
+                       FieldOrderingByAccessCount(options));
+    }
+    OptimizePadding(&scalar_block_);
+  }
+}
+
+bool MessageGenerator::InScalarBlock(const FieldDescriptor* field) const {
+  return std::find(scalar_block_.begin(), scalar_block_.end(), field) !=
+         scalar_block_.end();
 }
 
 MessageGenerator::~MessageGenerator() {}
@@ -349,7 +553,7 @@ GenerateFieldAccessorDeclarations(io::Printer* printer) {
     PrintFieldComment(printer, field);
 
     std::map<std::string, std::string> vars;
-    SetCommonFieldVariables(field, &vars);
+    SetCommonFieldVariables(field, options_, &vars);
     vars["constant_name"] = FieldConstantName(field);
 
     if (field->is_repeated()) {
@@ -386,13 +590,13 @@ GenerateFieldAccessorDefinitions(io::Printer* printer) {
     PrintFieldComment(printer, field);
 
     std::map<std::string, std::string> vars;
-    SetCommonFieldVariables(field, &vars);
+    SetCommonFieldVariables(field, options_, &vars);
 
     // Generate has_$name$() or $name$_size().
     if (field->is_repeated()) {
       printer->Print(vars,
         "inline int $classname$::$name$_size() const {\n"
-        "  return $name$_.size();\n"
+        "  return $member$.size();\n"
         "}\n");
     } else {
       // Singular field.
@@ -416,8 +620,18 @@ GenerateFieldAccessorDefinitions(io::Printer* printer) {
     printer->Print(vars,
       "inline void $classname$::clear_$name$() {\n");
 
+    // A cold field which was never written still has its default value, in
+    // the shared default struct of cold fields.
     printer->Indent();
-    field_generators_.get(field).GenerateClearingCode(printer);
+    if (IsColdField(field, options_)) {
+      printer->Print("if (_cold_ != _default_cold_) {\n");
+      printer->Indent();
+      field_generators_.get(field).GenerateClearingCode(printer);
+      printer->Outdent();
+      printer->Print("}\n");
+    } else {
+      field_generators_.get(field).GenerateClearingCode(printer);
+    }
     printer->Outdent();
 
     if (!field->is_repeated()) {
@@ -491,6 +705,12 @@ GenerateClassDefinition(io::Printer* printer) {
 
   printer->Print(vars,
     "static const $classname$& default_instance();\n"
+    "\n"
+    "// Returns the default instance without initializing it.  Only for use\n"
+    "// by generated code of the same .proto file.\n"
+    "static inline const $classname$* internal_default_instance() {\n"
+    "  return default_instance_;\n"
+    "}\n"
     "\n");
 
 
@@ -499,7 +719,10 @@ GenerateClassDefinition(io::Printer* printer) {
     "\n"
     "// implements Message ----------------------------------------------\n"
     "\n"
-    "$classname$* New() const;\n");
+    "$classname$* New() const;\n"
+    "const ::google::protobuf::MessageLite* GetPrototype() const {\n"
+    "  return &default_instance();\n"
+    "}\n");
 
   if (HasGeneratedMethods(descriptor_->file())) {
     if (HasDescriptorMethods(descriptor_->file())) {
@@ -533,7 +756,12 @@ GenerateClassDefinition(io::Printer* printer) {
     "private:\n"
     "void SharedCtor();\n"
     "void SharedDtor();\n"
-    "void SetCachedSize(int size) const;\n"
+    "void SetCachedSize(int size) const;\n");
+  if (HasGeneratedMethods(descriptor_->file()) && !scalar_block_.empty()) {
+    printer->Print(vars,
+      "void MergeFromExceptScalarBlock(const $classname$& from);\n");
+  }
+  printer->Print(
     "public:\n"
     "\n");
 
@@ -604,6 +832,41 @@ GenerateClassDefinition(io::Printer* printer) {
   }
   printer->Print("\n");
 
+  // Fields the field profile counts rarely or never live in a struct which
+  // is only allocated when one of them is first written.  Until then _cold_
+  // points at the shared _default_cold_, which holds their default values.
+  std::vector<const FieldDescriptor*> fields;
+  std::vector<const FieldDescriptor*> cold_fields;
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    if (IsColdField(descriptor_->field(i), options_)) {
+      cold_fields.push_back(descriptor_->field(i));
+    } else if (!InScalarBlock(descriptor_->field(i))) {
+      fields.push_back(descriptor_->field(i));
+    }
+  }
+
+  if (!cold_fields.empty()) {
+    printer->Print(
+      "struct _cold_fields : public ::google::protobuf::internal::ColdFields {\n"
+      "  _cold_fields();\n"
+      "  ~_cold_fields();\n"
+      "  _cold_fields* New() const;\n"
+      "\n");
+    printer->Indent();
+    OptimizePadding(&cold_fields);
+    for (int i = 0; i < cold_fields.size(); ++i) {
+      field_generators_.get(cold_fields[i]).GeneratePrivateMembers(printer);
+    }
+    printer->Outdent();
+    printer->Print(
+      "};\n"
+      "inline _cold_fields* _mutable_cold() {\n"
+      "  if (_cold_ == _default_cold_) _cold_ = new _cold_fields;\n"
+      "  return _cold_;\n"
+      "}\n"
+      "\n");
+  }
+
   // To minimize padding, data members are divided into three sections:
   // (1) members assumed to align to 8 bytes
   // (2) members corresponding to message fields, re-ordered to optimize
@@ -624,15 +887,34 @@ GenerateClassDefinition(io::Printer* printer) {
       "\n");
   }
 
+  if (!cold_fields.empty()) {
+    printer->Print(
+      "_cold_fields* _cold_;\n"
+      "\n");
+  }
+
   // Field members:
 
-  std::vector<const FieldDescriptor*> fields;
-  for (int i = 0; i < descriptor_->field_count(); i++) {
-    fields.push_back(descriptor_->field(i));
+  // With a field profile, the hottest fields go first so that the fields
+  // used together share cache lines.  OptimizePadding() keeps each field
+  // near its position in this order.
+  if (HasFieldProfile(descriptor_, options_)) {
+    std::stable_sort(fields.begin(), fields.end(),
+                     FieldOrderingByAccessCount(options_));
   }
   OptimizePadding(&fields);
   for (int i = 0; i < fields.size(); ++i) {
     field_generators_.get(fields[i]).GeneratePrivateMembers(printer);
+    field_generators_.get(fields[i]).GenerateStaticMembers(printer);
+  }
+  // The scalar block goes last:  OptimizePadding() leaves any field smaller
+  // than 8 bytes at its end, next to the 4-byte members below.
+  for (int i = 0; i < scalar_block_.size(); ++i) {
+    field_generators_.get(scalar_block_[i]).GeneratePrivateMembers(printer);
+    field_generators_.get(scalar_block_[i]).GenerateStaticMembers(printer);
+  }
+  for (int i = 0; i < cold_fields.size(); ++i) {
+    field_generators_.get(cold_fields[i]).GenerateStaticMembers(printer);
   }
 
   // Members assumed to align to 4 bytes:
@@ -666,9 +948,12 @@ GenerateClassDefinition(io::Printer* printer) {
     "adddescriptorsname",
       GlobalAddDescriptorsName(descriptor_->file()->name()));
   printer->Print(
+    "friend void $initdefaultsname$();\n"
     "friend void $assigndescriptorsname$();\n"
     "friend void $shutdownfilename$();\n"
     "\n",
+    "initdefaultsname",
+      GlobalInitDefaultsName(descriptor_->file()->name()),
     "assigndescriptorsname",
       GlobalAssignDescriptorsName(descriptor_->file()->name()),
     "shutdownfilename", GlobalShutdownFileName(descriptor_->file()->name()));
@@ -677,6 +962,12 @@ GenerateClassDefinition(io::Printer* printer) {
     "void InitAsDefaultInstance();\n"
     "static $classname$* default_instance_;\n",
     "classname", classname_);
+  if (!cold_fields.empty()) {
+    printer->Print(
+      "static ::google::protobuf::internal::StaticStorage<_cold_fields>\n"
+      "  _default_cold_storage_;\n"
+      "static _cold_fields* _default_cold_;\n");
+  }
 
   printer->Outdent();
   printer->Print(vars, "};");
@@ -755,8 +1046,16 @@ GenerateDescriptorInitializer(io::Printer* printer, int index) {
   }
   printer->Print(vars,
     "    ::google::protobuf::DescriptorPool::generated_pool(),\n"
-    "    ::google::protobuf::MessageFactory::generated_factory(),\n"
-    "    sizeof($classname$));\n");
+    "    ::google::protobuf::MessageFactory::generated_factory(),\n");
+  if (HasColdFields(descriptor_, options_)) {
+    printer->Print(vars,
+      "    sizeof($classname$),\n"
+      "    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET($classname$, _cold_),\n"
+      "    sizeof($classname$::_cold_fields));\n");
+  } else {
+    printer->Print(vars,
+      "    sizeof($classname$));\n");
+  }
 
   // Handle nested types.
   for (int i = 0; i < descriptor_->nested_type_count(); i++) {
@@ -784,11 +1083,23 @@ GenerateTypeRegistrations(io::Printer* printer) {
 
 void MessageGenerator::
 GenerateDefaultInstanceAllocator(io::Printer* printer) {
-  // Construct the default instance.  We can't call InitAsDefaultInstance() yet
+  // Construct the default instance in its static storage, after the default
+  // values its fields point at.  We can't call InitAsDefaultInstance() yet
   // because we need to make sure all default instances that this one might
-  // depend on are constructed first.
+  // depend on are constructed first.  default_instance_ already points at the
+  // storage, so the constructor can tell it is building the default instance
+  // and does not re-enter InitDefaults().
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    field_generators_.get(descriptor_->field(i))
+                     .GenerateDefaultValueInitializer(printer);
+  }
+  if (HasColdFields(descriptor_, options_)) {
+    printer->Print(
+      "new ($classname$::_default_cold_) $classname$::_cold_fields();\n",
+      "classname", classname_);
+  }
   printer->Print(
-    "$classname$::default_instance_ = new $classname$();\n",
+    "new ($classname$::default_instance_) $classname$();\n",
     "classname", classname_);
 
   // Handle nested types.
@@ -804,23 +1115,49 @@ GenerateDefaultInstanceInitializer(io::Printer* printer) {
     "$classname$::default_instance_->InitAsDefaultInstance();\n",
     "classname", classname_);
 
-  // Register extensions.
+  // Handle nested types.
+  for (int i = 0; i < descriptor_->nested_type_count(); i++) {
+    nested_generators_[i]->GenerateDefaultInstanceInitializer(printer);
+  }
+}
+
+void MessageGenerator::
+GenerateExtensionRegistrations(io::Printer* printer) {
   for (int i = 0; i < descriptor_->extension_count(); i++) {
     extension_generators_[i]->GenerateRegistration(printer);
   }
 
   // Handle nested types.
   for (int i = 0; i < descriptor_->nested_type_count(); i++) {
-    nested_generators_[i]->GenerateDefaultInstanceInitializer(printer);
+    nested_generators_[i]->GenerateExtensionRegistrations(printer);
   }
 }
 
 void MessageGenerator::
-GenerateShutdownCode(io::Printer* printer) {
+GenerateDefaultInstanceShutdownCode(io::Printer* printer) {
   printer->Print(
-    "delete $classname$::default_instance_;\n",
+    "::google::protobuf::internal::DestroyStaticObject("
+    "*$classname$::default_instance_);\n",
     "classname", classname_);
+  if (HasColdFields(descriptor_, options_)) {
+    printer->Print(
+      "::google::protobuf::internal::DestroyStaticObject("
+      "*$classname$::_default_cold_);\n",
+      "classname", classname_);
+  }
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    field_generators_.get(descriptor_->field(i))
+                     .GenerateDefaultValueShutdownCode(printer);
+  }
 
+  // Handle nested types.
+  for (int i = 0; i < descriptor_->nested_type_count(); i++) {
+    nested_generators_[i]->GenerateDefaultInstanceShutdownCode(printer);
+  }
+}
+
+void MessageGenerator::
+GenerateShutdownCode(io::Printer* printer) {
   if (HasDescriptorMethods(descriptor_->file())) {
     printer->Print(
       "delete $classname$_reflection_;\n",
@@ -937,10 +1274,18 @@ GenerateOffsets(io::Printer* printer) {
 
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
-    printer->Print(
-      "GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET($classname$, $name$_),\n",
-      "classname", classname_,
-      "name", FieldName(field));
+    if (IsColdField(field, options_)) {
+      printer->Print(
+        "GOOGLE_PROTOBUF_GENERATED_COLD_FIELD_OFFSET("
+          "$classname$::_cold_fields, $name$_),\n",
+        "classname", classname_,
+        "name", FieldName(field));
+    } else {
+      printer->Print(
+        "GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET($classname$, $name$_),\n",
+        "classname", classname_,
+        "name", FieldName(field));
+    }
   }
 
   printer->Outdent();
@@ -956,8 +1301,13 @@ GenerateSharedConstructorCode(io::Printer* printer) {
 
   printer->Print(
     "_cached_size_ = 0;\n");
+  if (HasColdFields(descriptor_, options_)) {
+    printer->Print(
+      "_cold_ = _default_cold_;\n");
+  }
 
   for (int i = 0; i < descriptor_->field_count(); i++) {
+    if (IsColdField(descriptor_->field(i), options_)) continue;
     field_generators_.get(descriptor_->field(i))
                      .GenerateConstructorCode(printer);
   }
@@ -977,9 +1327,14 @@ GenerateSharedDestructorCode(io::Printer* printer) {
   printer->Indent();
   // Write the destructors for each field.
   for (int i = 0; i < descriptor_->field_count(); i++) {
+    if (IsColdField(descriptor_->field(i), options_)) continue;
     field_generators_.get(descriptor_->field(i))
                      .GenerateDestructorCode(printer);
   }
+  if (HasColdFields(descriptor_, options_)) {
+    printer->Print(
+      "if (_cold_ != _default_cold_) delete _cold_;\n");
+  }
 
   printer->Print(
     "if (this != default_instance_) {\n");
@@ -992,7 +1347,8 @@ GenerateSharedDestructorCode(io::Printer* printer) {
     const FieldDescriptor* field = descriptor_->field(i);
 
     if (!field->is_repeated() &&
-        field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+        field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE &&
+        !IsColdField(field, options_)) {
       printer->Print("  delete $name$_;\n",
                      "name", FieldName(field));
     }
@@ -1005,6 +1361,61 @@ GenerateSharedDestructorCode(io::Printer* printer) {
     "\n");
 }
 
+void MessageGenerator::
+GenerateColdFieldsStructors(io::Printer* printer) {
+  // The struct of cold fields is built and torn down like the message itself,
+  // with the default struct standing in for the default instance.
+  printer->Print(
+    "$classname$::_cold_fields::_cold_fields() {\n",
+    "classname", classname_);
+  printer->Indent();
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    if (!IsColdField(descriptor_->field(i), options_)) continue;
+    field_generators_.get(descriptor_->field(i))
+                     .GenerateConstructorCode(printer);
+  }
+  printer->Outdent();
+  printer->Print(
+    "}\n"
+    "\n"
+    "$classname$::_cold_fields::~_cold_fields() {\n",
+    "classname", classname_);
+  printer->Indent();
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    if (!IsColdField(descriptor_->field(i), options_)) continue;
+    field_generators_.get(descriptor_->field(i))
+                     .GenerateDestructorCode(printer);
+  }
+  printer->Print(
+    "if (this != _default_cold_) {\n");
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    const FieldDescriptor* field = descriptor_->field(i);
+
+    if (!field->is_repeated() &&
+        field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE &&
+        IsColdField(field, options_)) {
+      printer->Print("  delete $name$_;\n",
+                     "name", FieldName(field));
+    }
+  }
+  printer->Outdent();
+  printer->Print(
+    "  }\n"
+    "}\n"
+    "\n"
+    "$classname$::_cold_fields* $classname$::_cold_fields::New() const {\n"
+    "  return new _cold_fields;\n"
+    "}\n"
+    "\n"
+    "::google::protobuf::internal::StaticStorage<$classname$::_cold_fields>\n"
+    "  $classname$::_default_cold_storage_;\n"
+    "$classname$::_cold_fields* $classname$::_default_cold_ =\n"
+    "  reinterpret_cast<$classname$::_cold_fields*>(\n"
+    "    &$classname$::_default_cold_storage_);\n"
+    "\n",
+    "classname", classname_);
+}
+
 void MessageGenerator::
 GenerateStructors(io::Printer* printer) {
   std::string superclass = SuperClassName(descriptor_);
@@ -1012,11 +1423,16 @@ GenerateStructors(io::Printer* printer) {
   // Generate the default constructor.
   printer->Print(
     "$classname$::$classname$()\n"
-    "  : $superclass$() {\n"
-    "  SharedCtor();\n"
-    "}\n",
+    "  : $superclass$() {\n",
     "classname", classname_,
     "superclass", superclass);
+  if (ConstructorNeedsDefaults(descriptor_, options_)) {
+    printer->Print(
+      "  if (this != default_instance_) protobuf_InitDefaultsOnce();\n");
+  }
+  printer->Print(
+    "  SharedCtor();\n"
+    "}\n");
 
   printer->Print(
     "\n"
@@ -1034,10 +1450,24 @@ GenerateStructors(io::Printer* printer) {
 
     if (!field->is_repeated() &&
         field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
-      printer->Print(
-          "  $name$_ = const_cast< $type$*>(&$type$::default_instance());\n",
-          "name", FieldName(field),
-          "type", FieldMessageTypeName(field));
+      // The default struct of cold fields takes the place of the default
+      // instance's own cold fields.
+      std::string name = FieldName(field);
+      if (IsColdField(field, options_)) name = "_default_cold_->" + name;
+      // Types from this file are being initialized right now; calling their
+      // default_instance() would re-enter InitDefaults().
+      if (field->message_type()->file() == descriptor_->file()) {
+        printer->Print(
+            "  $name$_ = const_cast< $type$*>(\n"
+            "      $type$::internal_default_instance());\n",
+            "name", name,
+            "type", FieldMessageTypeName(field));
+      } else {
+        printer->Print(
+            "  $name$_ = const_cast< $type$*>(&$type$::default_instance());\n",
+            "name", name,
+            "type", FieldMessageTypeName(field));
+      }
     }
   }
   printer->Print(
@@ -1058,6 +1488,10 @@ GenerateStructors(io::Printer* printer) {
   // Generate the shared constructor code.
   GenerateSharedConstructorCode(printer);
 
+  if (HasColdFields(descriptor_, options_)) {
+    GenerateColdFieldsStructors(printer);
+  }
+
   // Generate the destructor.
   printer->Print(
     "$classname$::~$classname$() {\n"
@@ -1094,18 +1528,21 @@ GenerateStructors(io::Printer* printer) {
 
   printer->Print(
     "const $classname$& $classname$::default_instance() {\n"
-    "  if (default_instance_ == NULL) $adddescriptorsname$();"
+    "  protobuf_InitDefaultsOnce();\n"
     "  return *default_instance_;\n"
     "}\n"
     "\n"
-    "$classname$* $classname$::default_instance_ = NULL;\n"
+    "namespace {\n"
+    "::google::protobuf::internal::StaticStorage<$classname$>\n"
+    "  $classname$_default_instance_storage_;\n"
+    "}  // namespace\n"
+    "$classname$* $classname$::default_instance_ =\n"
+    "  reinterpret_cast<$classname$*>(&$classname$_default_instance_storage_);\n"
     "\n"
     "$classname$* $classname$::New() const {\n"
     "  return new $classname$;\n"
     "}\n",
-    "classname", classname_,
-    "adddescriptorsname",
-    GlobalAddDescriptorsName(descriptor_->file()->name()));
+    "classname", classname_);
 
 }
 
@@ -1121,34 +1558,123 @@ GenerateClear(io::Printer* printer) {
     printer->Print("_extensions_.Clear();\n");
   }
 
-  for (int i = 0; i < descriptor_->field_count(); i++) {
-    const FieldDescriptor* field = descriptor_->field(i);
+  if (!scalar_block_.empty()) {
+    // All of the fields in the block default to zero bytes.
+    printer->Print(
+      ("if (" + HasBitsCondition(descriptor_, scalar_block_, "_has_bits_",
+                                 false) + ") {\n").c_str());
+    printer->Print(
+      "  ::memset(&$first$_, 0,\n"
+      "    reinterpret_cast<char*>(&$last$_ + 1) -\n"
+      "    reinterpret_cast<char*>(&$first$_));\n"
+      "}\n",
+      "first", FieldName(scalar_block_.front()),
+      "last", FieldName(scalar_block_.back()));
+  }
+
+  if (UseHasBitIteration(descriptor_, options_)) {
+    // A primitive field whose has-bit is clear already holds its default
+    // value, so only the fields which are set need clearing.
+    for (int word = 0; word * 32 < descriptor_->field_count(); word++) {
+      std::vector<const FieldDescriptor*> fields;
+      for (int i = word * 32;
+           i < descriptor_->field_count() && i < word * 32 + 32; i++) {
+        const FieldDescriptor* field = descriptor_->field(i);
+        if (!field->is_repeated() && !IsColdField(field, options_) &&
+            !InScalarBlock(field)) {
+          fields.push_back(field);
+        }
+      }
+      if (fields.empty()) continue;
 
-    if (!field->is_repeated()) {
-      // We can use the fact that _has_bits_ is a giant bitfield to our
-      // advantage:  We can check up to 32 bits at a time for equality to
-      // zero, and skip the whole range if so.  This can improve the speed
-      // of Clear() for messages which contain a very large number of
-      // optional fields of which only a few are used at a time.  Here,
-      // we've chosen to check 8 bits at a time rather than 32.
-      if (i / 8 != last_index / 8 || last_index < 0) {
-        if (last_index >= 0) {
+      // The memset() above took care of the scalar block's bits.
+      std::string bits = "_has_bits_[" + SimpleItoa(word) + "]";
+      if (!scalar_block_.empty()) {
+        bits += " & " + HasBitMasks(descriptor_, fields)[word];
+      }
+      PrintSetBitLoopStart(printer, bits);
+      for (int i = 0; i < fields.size(); i++) {
+        PrintSetBitCaseStart(printer, fields[i]->index());
+        field_generators_.get(fields[i]).GenerateClearingCode(printer);
+        PrintSetBitCaseEnd(printer);
+      }
+      PrintSetBitLoopEnd(printer);
+    }
+  } else {
+    for (int i = 0; i < descriptor_->field_count(); i++) {
+      const FieldDescriptor* field = descriptor_->field(i);
+
+      if (!field->is_repeated() && !IsColdField(field, options_) &&
+          !InScalarBlock(field)) {
+        // We can use the fact that _has_bits_ is a giant bitfield to our
+        // advantage:  We can check up to 32 bits at a time for equality to
+        // zero, and skip the whole range if so.  This can improve the speed
+        // of Clear() for messages which contain a very large number of
+        // optional fields of which only a few are used at a time.  Here,
+        // we've chosen to check 8 bits at a time rather than 32.
+        if (i / 8 != last_index / 8 || last_index < 0) {
+          if (last_index >= 0) {
+            printer->Outdent();
+            printer->Print("}\n");
+          }
+          printer->Print(
+            "if (_has_bits_[$index$ / 32] & (0xffu << ($index$ % 32))) {\n",
+            "index", SimpleItoa(field->index()));
+          printer->Indent();
+        }
+        last_index = i;
+
+        // It's faster to just overwrite primitive types, but we should
+        // only clear strings and messages if they were set.
+        // TODO(kenton):  Let the CppFieldGenerator decide this somehow.
+        bool should_check_bit =
+          field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE ||
+          field->cpp_type() == FieldDescriptor::CPPTYPE_STRING;
+
+        if (should_check_bit) {
+          printer->Print(
+            "if (has_$name$()) {\n",
+            "name", FieldName(field));
+          printer->Indent();
+        }
+
+        field_generators_.get(field).GenerateClearingCode(printer);
+
+        if (should_check_bit) {
           printer->Outdent();
           printer->Print("}\n");
         }
-        printer->Print(
-          "if (_has_bits_[$index$ / 32] & (0xffu << ($index$ % 32))) {\n",
-          "index", SimpleItoa(field->index()));
-        printer->Indent();
       }
-      last_index = i;
+    }
+
+    if (last_index >= 0) {
+      printer->Outdent();
+      printer->Print("}\n");
+    }
+  }
+
+  // Repeated fields don't use _has_bits_ so we clear them in a separate
+  // pass.
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    const FieldDescriptor* field = descriptor_->field(i);
+
+    if (field->is_repeated() && !IsColdField(field, options_)) {
+      field_generators_.get(field).GenerateClearingCode(printer);
+    }
+  }
+
+  // Cold fields need clearing only if they were ever written.
+  if (HasColdFields(descriptor_, options_)) {
+    printer->Print("if (_cold_ != _default_cold_) {\n");
+    printer->Indent();
+    for (int i = 0; i < descriptor_->field_count(); i++) {
+      const FieldDescriptor* field = descriptor_->field(i);
+      if (!IsColdField(field, options_)) continue;
 
-      // It's faster to just overwrite primitive types, but we should
-      // only clear strings and messages if they were set.
-      // TODO(kenton):  Let the CppFieldGenerator decide this somehow.
       bool should_check_bit =
-        field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE ||
-        field->cpp_type() == FieldDescriptor::CPPTYPE_STRING;
+        !field->is_repeated() &&
+        (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE ||
+         field->cpp_type() == FieldDescriptor::CPPTYPE_STRING);
 
       if (should_check_bit) {
         printer->Print(
@@ -1164,23 +1690,10 @@ GenerateClear(io::Printer* printer) {
         printer->Print("}\n");
       }
     }
-  }
-
-  if (last_index >= 0) {
     printer->Outdent();
     printer->Print("}\n");
   }
 
-  // Repeated fields don't use _has_bits_ so we clear them in a separate
-  // pass.
-  for (int i = 0; i < descriptor_->field_count(); i++) {
-    const FieldDescriptor* field = descriptor_->field(i);
-
-    if (field->is_repeated()) {
-      field_generators_.get(field).GenerateClearingCode(printer);
-    }
-  }
-
   printer->Print(
     "::memset(_has_bits_, 0, sizeof(_has_bits_));\n");
 
@@ -1205,8 +1718,12 @@ GenerateSwap(io::Printer* printer) {
   if (HasGeneratedMethods(descriptor_->file())) {
     for (int i = 0; i < descriptor_->field_count(); i++) {
       const FieldDescriptor* field = descriptor_->field(i);
+      if (IsColdField(field, options_)) continue;
       field_generators_.get(field).GenerateSwappingCode(printer);
     }
+    if (HasColdFields(descriptor_, options_)) {
+      printer->Print("std::swap(_cold_, other->_cold_);\n");
+    }
 
     for (int i = 0; i < (descriptor_->field_count() + 31) / 32; ++i) {
       printer->Print("std::swap(_has_bits_[$i$], other->_has_bits_[$i$]);\n",
@@ -1276,54 +1793,103 @@ GenerateMergeFrom(io::Printer* printer) {
     "classname", classname_);
   printer->Indent();
 
+  if (!scalar_block_.empty()) {
+    // CopyFrom() copies the scalar block itself and then merges the rest
+    // with MergeFromExceptScalarBlock().
+    GenerateScalarBlockMerging(printer);
+    printer->Print("MergeFromExceptScalarBlock(from);\n");
+    printer->Outdent();
+    printer->Print(
+      "}\n"
+      "\n"
+      "void $classname$::MergeFromExceptScalarBlock(const $classname$& from) {\n",
+      "classname", classname_);
+    printer->Indent();
+  }
+
   // Merge Repeated fields. These fields do not require a
   // check as we can simply iterate over them.
   for (int i = 0; i < descriptor_->field_count(); ++i) {
     const FieldDescriptor* field = descriptor_->field(i);
 
-    if (field->is_repeated()) {
+    if (field->is_repeated() && IsColdField(field, options_)) {
+      // Don't allocate the cold fields just to merge nothing into them.
+      printer->Print(
+        "if (from.$name$_size() > 0) {\n",
+        "name", FieldName(field));
+      printer->Indent();
+      field_generators_.get(field).GenerateMergingCode(printer);
+      printer->Outdent();
+      printer->Print("}\n");
+    } else if (field->is_repeated()) {
       field_generators_.get(field).GenerateMergingCode(printer);
     }
   }
 
   // Merge Optional and Required fields (after a _has_bit check).
-  int last_index = -1;
+  if (UseHasBitIteration(descriptor_, options_)) {
+    for (int word = 0; word * 32 < descriptor_->field_count(); word++) {
+      std::vector<const FieldDescriptor*> fields;
+      for (int i = word * 32;
+           i < descriptor_->field_count() && i < word * 32 + 32; ++i) {
+        const FieldDescriptor* field = descriptor_->field(i);
+        if (!field->is_repeated() && !InScalarBlock(field)) {
+          fields.push_back(field);
+        }
+      }
+      if (fields.empty()) continue;
 
-  for (int i = 0; i < descriptor_->field_count(); ++i) {
-    const FieldDescriptor* field = descriptor_->field(i);
+      std::string bits = "from._has_bits_[" + SimpleItoa(word) + "]";
+      if (!scalar_block_.empty()) {
+        bits += " & " + HasBitMasks(descriptor_, fields)[word];
+      }
+      PrintSetBitLoopStart(printer, bits);
+      for (int i = 0; i < fields.size(); ++i) {
+        PrintSetBitCaseStart(printer, fields[i]->index());
+        field_generators_.get(fields[i]).GenerateMergingCode(printer);
+        PrintSetBitCaseEnd(printer);
+      }
+      PrintSetBitLoopEnd(printer);
+    }
+  } else {
+    int last_index = -1;
 
-    if (!field->is_repeated()) {
-      // See above in GenerateClear for an explanation of this.
-      if (i / 8 != last_index / 8 || last_index < 0) {
-        if (last_index >= 0) {
-          printer->Outdent();
-          printer->Print("}\n");
+    for (int i = 0; i < descriptor_->field_count(); ++i) {
+      const FieldDescriptor* field = descriptor_->field(i);
+
+      if (!field->is_repeated() && !InScalarBlock(field)) {
+        // See above in GenerateClear for an explanation of this.
+        if (i / 8 != last_index / 8 || last_index < 0) {
+          if (last_index >= 0) {
+            printer->Outdent();
+            printer->Print("}\n");
+          }
+          printer->Print(
+            "if (from._has_bits_[$index$ / 32] & (0xffu << ($index$ % 32))) {\n",
+            "index", SimpleItoa(field->index()));
+          printer->Indent();
         }
+
+        last_index = i;
+
         printer->Print(
-          "if (from._has_bits_[$index$ / 32] & (0xffu << ($index$ % 32))) {\n",
-          "index", SimpleItoa(field->index()));
+          "if (from.has_$name$()) {\n",
+          "name", FieldName(field));
         printer->Indent();
-      }
 
-      last_index = i;
+        field_generators_.get(field).GenerateMergingCode(printer);
 
-      printer->Print(
-        "if (from.has_$name$()) {\n",
-        "name", FieldName(field));
-      printer->Indent();
-
-      field_generators_.get(field).GenerateMergingCode(printer);
+        printer->Outdent();
+        printer->Print("}\n");
+      }
+    }
 
+    if (last_index >= 0) {
       printer->Outdent();
       printer->Print("}\n");
     }
   }
 
-  if (last_index >= 0) {
-    printer->Outdent();
-    printer->Print("}\n");
-  }
-
   if (descriptor_->extension_range_count() > 0) {
     printer->Print("_extensions_.MergeFrom(from._extensions_);\n");
   }
@@ -1337,6 +1903,86 @@ GenerateMergeFrom(io::Printer* printer) {
   printer->Print("}\n");
 }
 
+void MessageGenerator::
+GenerateScalarBlockMerging(io::Printer* printer) {
+  std::vector<std::string> masks = HasBitMasks(descriptor_, scalar_block_);
+
+  // When all of the block's fields are set in "from", they are all
+  // overwritten, so the whole block can be copied.
+  printer->Print(
+    ("if (" + HasBitsCondition(descriptor_, scalar_block_, "from._has_bits_",
+                               true) + ") {\n").c_str());
+  printer->Indent();
+  GenerateScalarBlockCopy(printer);
+  for (int i = 0; i < masks.size(); i++) {
+    if (masks[i] == "0") continue;
+    printer->Print(
+      "_has_bits_[$word$] |= $mask$;\n",
+      "word", SimpleItoa(i),
+      "mask", masks[i]);
+  }
+  printer->Outdent();
+  printer->Print("} else {\n");
+  printer->Indent();
+
+  for (int word = 0; word < masks.size(); word++) {
+    if (masks[word] == "0") continue;
+    std::map<std::string, std::string> vars;
+    vars["word"] = SimpleItoa(word);
+    vars["mask"] = masks[word];
+
+    if (UseHasBitIteration(descriptor_, options_)) {
+      PrintSetBitLoopStart(printer,
+                           "from._has_bits_[" + vars["word"] + "] & " +
+                           vars["mask"]);
+    } else {
+      printer->Print(vars,
+        "if (from._has_bits_[$word$] & $mask$) {\n");
+      printer->Indent();
+    }
+
+    for (int i = word * 32;
+         i < descriptor_->field_count() && i < word * 32 + 32; i++) {
+      const FieldDescriptor* field = descriptor_->field(i);
+      if (!InScalarBlock(field)) continue;
+
+      if (UseHasBitIteration(descriptor_, options_)) {
+        PrintSetBitCaseStart(printer, field->index());
+        field_generators_.get(field).GenerateMergingCode(printer);
+        PrintSetBitCaseEnd(printer);
+      } else {
+        printer->Print(
+          "if (from.has_$name$()) {\n",
+          "name", FieldName(field));
+        printer->Indent();
+        field_generators_.get(field).GenerateMergingCode(printer);
+        printer->Outdent();
+        printer->Print("}\n");
+      }
+    }
+
+    if (UseHasBitIteration(descriptor_, options_)) {
+      PrintSetBitLoopEnd(printer);
+    } else {
+      printer->Outdent();
+      printer->Print("}\n");
+    }
+  }
+
+  printer->Outdent();
+  printer->Print("}\n");
+}
+
+void MessageGenerator::
+GenerateScalarBlockCopy(io::Printer* printer) {
+  printer->Print(
+    "::memcpy(&$first$_, &from.$first$_,\n"
+    "  reinterpret_cast<const char*>(&$last$_ + 1) -\n"
+    "  reinterpret_cast<const char*>(&$first$_));\n",
+    "first", FieldName(scalar_block_.front()),
+    "last", FieldName(scalar_block_.back()));
+}
+
 void MessageGenerator::
 GenerateCopyFrom(io::Printer* printer) {
   if (HasDescriptorMethods(descriptor_->file())) {
@@ -1347,10 +1993,26 @@ GenerateCopyFrom(io::Printer* printer) {
       "classname", classname_);
     printer->Indent();
 
-    printer->Print(
-      "if (&from == this) return;\n"
-      "Clear();\n"
-      "MergeFrom(from);\n");
+    if (scalar_block_.empty()) {
+      printer->Print(
+        "if (&from == this) return;\n"
+        "Clear();\n"
+        "MergeFrom(from);\n");
+    } else {
+      // Let the class-specific CopyFrom copy the scalar block in one go.
+      printer->Print(
+        "if (&from == this) return;\n"
+        "const $classname$* source =\n"
+        "  ::google::protobuf::internal::dynamic_cast_if_available<const $classname$*>(\n"
+        "    &from);\n"
+        "if (source == NULL) {\n"
+        "  Clear();\n"
+        "  MergeFrom(from);\n"
+        "} else {\n"
+        "  CopyFrom(*source);\n"
+        "}\n",
+        "classname", classname_);
+    }
 
     printer->Outdent();
     printer->Print("}\n\n");
@@ -1362,10 +2024,29 @@ GenerateCopyFrom(io::Printer* printer) {
     "classname", classname_);
   printer->Indent();
 
-  printer->Print(
-    "if (&from == this) return;\n"
-    "Clear();\n"
-    "MergeFrom(from);\n");
+  if (scalar_block_.empty()) {
+    printer->Print(
+      "if (&from == this) return;\n"
+      "Clear();\n"
+      "MergeFrom(from);\n");
+  } else {
+    // After Clear(), the fields of the scalar block which are not set in
+    // "from" hold zero bytes in both messages, so the whole block can be
+    // copied.
+    printer->Print(
+      "if (&from == this) return;\n"
+      "Clear();\n");
+    GenerateScalarBlockCopy(printer);
+    std::vector<std::string> masks = HasBitMasks(descriptor_, scalar_block_);
+    for (int i = 0; i < masks.size(); i++) {
+      if (masks[i] == "0") continue;
+      printer->Print(
+        "_has_bits_[$word$] |= from._has_bits_[$word$] & $mask$;\n",
+        "word", SimpleItoa(i),
+        "mask", masks[i]);
+    }
+    printer->Print("MergeFromExceptScalarBlock(from);\n");
+  }
 
   printer->Outdent();
   printer->Print("}\n");
@@ -1624,6 +2305,100 @@ void MessageGenerator::GenerateSerializeOneExtensionRange(
   }
 }
 
+void MessageGenerator::GenerateSerializeSetFields(
+    io::Printer* printer, const std::vector<SerializationItem>& items,
+    bool to_array) {
+  // Each field and extension range gets a position in the order they are
+  // written, i.e. by field number.  The positions of what is to be written
+  // are collected in the bit array to_write, and then visited in order.
+  std::vector<int> positions(descriptor_->field_count());
+  bool positions_are_indices = true;
+  for (int i = 0; i < items.size(); i++) {
+    const FieldDescriptor* field = items[i].first;
+    if (field != NULL) {
+      positions[field->index()] = i;
+      if (!field->is_repeated() && field->index() != i) {
+        positions_are_indices = false;
+      }
+    }
+  }
+
+  const int has_words = (descriptor_->field_count() + 31) / 32;
+  const int words = (items.size() + 31) / 32;
+  printer->Print(
+    "::google::protobuf::uint32 to_write[$words$];\n",
+    "words", SimpleItoa(words));
+
+  if (positions_are_indices) {
+    // The has-bits of the singular fields are already in place.
+    for (int i = 0; i < words; i++) {
+      printer->Print(
+        i < has_words ? "to_write[$i$] = _has_bits_[$i$];\n"
+                      : "to_write[$i$] = 0;\n",
+        "i", SimpleItoa(i));
+    }
+  } else {
+    printer->Print("static const int kPositions[] = {");
+    for (int i = 0; i < positions.size(); i++) {
+      printer->Print(i % 16 == 0 ? "\n  $position$," : " $position$,",
+                     "position", SimpleItoa(positions[i]));
+    }
+    printer->Print(
+      "\n"
+      "};\n"
+      "::memset(to_write, 0, sizeof(to_write));\n"
+      "for (int word = 0; word < $has_words$; word++) {\n"
+      "  ::google::protobuf::uint32 bits = _has_bits_[word];\n"
+      "  while (bits != 0) {\n"
+      "    const int position = kPositions[\n"
+      "      word * 32 + ::google::protobuf::internal::LowestSetBit32(bits)];\n"
+      "    bits &= bits - 1;\n"
+      "    to_write[position / 32] |= 1u << (position % 32);\n"
+      "  }\n"
+      "}\n",
+      "has_words", SimpleItoa(has_words));
+  }
+
+  // Repeated fields have no has-bits; extension ranges are always visited.
+  for (int i = 0; i < items.size(); i++) {
+    std::map<std::string, std::string> vars;
+    vars["word"] = SimpleItoa(i / 32);
+    vars["bit"] = SimpleItoa(i % 32);
+    if (items[i].first == NULL) {
+      printer->Print(vars,
+        "to_write[$word$] |= 1u << $bit$;\n");
+    } else if (items[i].first->is_repeated()) {
+      vars["name"] = FieldName(items[i].first);
+      printer->Print(vars,
+        "if ($name$_size() > 0) to_write[$word$] |= 1u << $bit$;\n");
+    }
+  }
+  printer->Print("\n");
+
+  for (int word = 0; word < words; word++) {
+    PrintSetBitLoopStart(printer, "to_write[" + SimpleItoa(word) + "]");
+    for (int i = word * 32; i < items.size() && i < word * 32 + 32; i++) {
+      PrintSetBitCaseStart(printer, i);
+      const FieldDescriptor* field = items[i].first;
+      if (field == NULL) {
+        GenerateSerializeOneExtensionRange(printer, items[i].second, to_array);
+      } else {
+        PrintFieldComment(printer, field);
+        if (to_array) {
+          field_generators_.get(field).GenerateSerializeWithCachedSizesToArray(
+              printer);
+        } else {
+          field_generators_.get(field).GenerateSerializeWithCachedSizes(
+              printer);
+        }
+      }
+      PrintSetBitCaseEnd(printer);
+    }
+    PrintSetBitLoopEnd(printer);
+  }
+  printer->Print("\n");
+}
+
 void MessageGenerator::
 GenerateSerializeWithCachedSizes(io::Printer* printer) {
   if (descriptor_->options().message_set_wire_format()) {
@@ -1705,22 +2480,31 @@ GenerateSerializeWithCachedSizesBody(io::Printer* printer, bool to_array) {
        ExtensionRangeSorter());
 
   // Merge the fields and the extension ranges, both sorted by field number.
+  std::vector<SerializationItem> items;
   int i, j;
   for (i = 0, j = 0;
        i < descriptor_->field_count() || j < sorted_extensions.size();
        ) {
     if (i == descriptor_->field_count()) {
-      GenerateSerializeOneExtensionRange(printer,
-                                         sorted_extensions[j++],
-                                         to_array);
+      items.push_back(SerializationItem(NULL, sorted_extensions[j++]));
     } else if (j == sorted_extensions.size()) {
-      GenerateSerializeOneField(printer, ordered_fields[i++], to_array);
+      items.push_back(SerializationItem(ordered_fields[i++], NULL));
     } else if (ordered_fields[i]->number() < sorted_extensions[j]->start) {
-      GenerateSerializeOneField(printer, ordered_fields[i++], to_array);
+      items.push_back(SerializationItem(ordered_fields[i++], NULL));
     } else {
-      GenerateSerializeOneExtensionRange(printer,
-                                         sorted_extensions[j++],
-                                         to_array);
+      items.push_back(SerializationItem(NULL, sorted_extensions[j++]));
+    }
+  }
+
+  if (UseHasBitIteration(descriptor_, options_)) {
+    GenerateSerializeSetFields(printer, items, to_array);
+  } else {
+    for (i = 0; i < items.size(); i++) {
+      if (items[i].first != NULL) {
+        GenerateSerializeOneField(printer, items[i].first, to_array);
+      } else {
+        GenerateSerializeOneExtensionRange(printer, items[i].second, to_array);
+      }
     }
   }
 
@@ -1774,49 +2558,69 @@ GenerateByteSize(io::Printer* printer) {
     "int total_size = 0;\n"
     "\n");
 
-  int last_index = -1;
+  if (UseHasBitIteration(descriptor_, options_)) {
+    for (int word = 0; word * 32 < descriptor_->field_count(); word++) {
+      PrintSetBitLoopStart(printer,
+                           "_has_bits_[" + SimpleItoa(word) + "]");
+      for (int i = word * 32;
+           i < descriptor_->field_count() && i < word * 32 + 32; i++) {
+        const FieldDescriptor* field = descriptor_->field(i);
+
+        if (!field->is_repeated()) {
+          PrintSetBitCaseStart(printer, field->index());
+          PrintFieldComment(printer, field);
+          field_generators_.get(field).GenerateByteSize(printer);
+          PrintSetBitCaseEnd(printer);
+        }
+      }
+      PrintSetBitLoopEnd(printer);
+    }
+    printer->Print("\n");
+  } else {
+    int last_index = -1;
 
-  for (int i = 0; i < descriptor_->field_count(); i++) {
-    const FieldDescriptor* field = descriptor_->field(i);
+    for (int i = 0; i < descriptor_->field_count(); i++) {
+      const FieldDescriptor* field = descriptor_->field(i);
 
-    if (!field->is_repeated()) {
-      // See above in GenerateClear for an explanation of this.
-      // TODO(kenton):  Share code?  Unclear how to do so without
-      //   over-engineering.
-      if ((i / 8) != (last_index / 8) ||
-          last_index < 0) {
-        if (last_index >= 0) {
-          printer->Outdent();
-          printer->Print("}\n");
+      if (!field->is_repeated()) {
+        // See above in GenerateClear for an explanation of this.
+        // TODO(kenton):  Share code?  Unclear how to do so without
+        //   over-engineering.
+        if ((i / 8) != (last_index / 8) ||
+            last_index < 0) {
+          if (last_index >= 0) {
+            printer->Outdent();
+            printer->Print("}\n");
+          }
+          printer->Print(
+            "if (_has_bits_[$index$ / 32] & (0xffu << ($index$ % 32))) {\n",
+            "index", SimpleItoa(field->index()));
+          printer->Indent();
         }
+        last_index = i;
+
+        PrintFieldComment(printer, field);
+
         printer->Print(
-          "if (_has_bits_[$index$ / 32] & (0xffu << ($index$ % 32))) {\n",
-          "index", SimpleItoa(field->index()));
+          "if (has_$name$()) {\n",
+          "name", FieldName(field));
         printer->Indent();
-      }
-      last_index = i;
 
-      PrintFieldComment(printer, field);
-
-      printer->Print(
-        "if (has_$name$()) {\n",
-        "name", FieldName(field));
-      printer->Indent();
+        field_generators_.get(field).GenerateByteSize(printer);
 
-      field_generators_.get(field).GenerateByteSize(printer);
+        printer->Outdent();
+        printer->Print(
+          "}\n"
+          "\n");
+      }
+    }
 
+    if (last_index >= 0) {
       printer->Outdent();
-      printer->Print(
-        "}\n"
-        "\n");
+      printer->Print("}\n");
     }
   }
 
-  if (last_index >= 0) {
-    printer->Outdent();
-    printer->Print("}\n");
-  }
-
   // Repeated fields don't use _has_bits_ so we count them in a separate
   // pass.
   for (int i = 0; i < descriptor_->field_count(); i++) {
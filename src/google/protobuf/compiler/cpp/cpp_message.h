@@ -36,6 +36,8 @@
 #define GOOGLE_PROTOBUF_COMPILER_CPP_MESSAGE_H__
 
 #include <string>
+#include <utility>
+#include <vector>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/compiler/cpp/cpp_field.h>
 
@@ -55,9 +57,8 @@ class ExtensionGenerator;      // extension.h
 
 class MessageGenerator {
  public:
-  // See generator.cc for the meaning of dllexport_decl.
-  explicit MessageGenerator(const Descriptor* descriptor,
-                            const std::string& dllexport_decl);
+  // See generator.cc for the meaning of the options.
+  MessageGenerator(const Descriptor* descriptor, const Options& options);
   ~MessageGenerator();
 
   // Header stuff.
@@ -94,7 +95,8 @@ class MessageGenerator {
   // for all types.
   void GenerateTypeRegistrations(io::Printer* printer);
 
-  // Generates code that allocates the message's default instance.
+  // Generates code that constructs the message's default instance and default
+  // values in their static storage.
   void GenerateDefaultInstanceAllocator(io::Printer* printer);
 
   // Generates code that initializes the message's default instance.  This
@@ -102,6 +104,14 @@ class MessageGenerator {
   // allocated before any can be initialized.
   void GenerateDefaultInstanceInitializer(io::Printer* printer);
 
+  // Generates code that registers the extensions declared inside this
+  // message (and its nested types) with the ExtensionSet registry.
+  void GenerateExtensionRegistrations(io::Printer* printer);
+
+  // Generates code that destroys the default instance and the default values
+  // constructed by GenerateDefaultInstanceAllocator().
+  void GenerateDefaultInstanceShutdownCode(io::Printer* printer);
+
   // Generates code that should be run when ShutdownProtobufLibrary() is called,
   // to delete all dynamically-allocated objects.
   void GenerateShutdownCode(io::Printer* printer);
@@ -128,6 +138,9 @@ class MessageGenerator {
   void GenerateSharedConstructorCode(io::Printer* printer);
   // Generate the shared destructor code.
   void GenerateSharedDestructorCode(io::Printer* printer);
+  // Generate the constructor, destructor and New() of the struct of cold
+  // fields, and its default instance.
+  void GenerateColdFieldsStructors(io::Printer* printer);
 
   // Generate standard Message methods.
   void GenerateClear(io::Printer* printer);
@@ -139,6 +152,10 @@ class MessageGenerator {
   void GenerateByteSize(io::Printer* printer);
   void GenerateMergeFrom(io::Printer* printer);
   void GenerateCopyFrom(io::Printer* printer);
+  // Generate the part of MergeFrom() which merges the scalar block, and the
+  // memcpy() copying the block from "from".
+  void GenerateScalarBlockMerging(io::Printer* printer);
+  void GenerateScalarBlockCopy(io::Printer* printer);
   void GenerateSwap(io::Printer* printer);
   void GenerateIsInitialized(io::Printer* printer);
 
@@ -150,15 +167,33 @@ class MessageGenerator {
       io::Printer* printer, const Descriptor::ExtensionRange* range,
       bool unbounded);
 
+  // A field or an extension range to serialize; the other one is NULL.
+  typedef std::pair<const FieldDescriptor*, const Descriptor::ExtensionRange*>
+      SerializationItem;
+  // Generate code serializing only the fields which are set, and the
+  // extension ranges, given in field number order.
+  void GenerateSerializeSetFields(io::Printer* printer,
+                                  const std::vector<SerializationItem>& items,
+                                  bool unbounded);
+
+  // Returns true if the field is a member of scalar_block_.
+  bool InScalarBlock(const FieldDescriptor* field) const;
 
   const Descriptor* descriptor_;
   std::string classname_;
+  const Options& options_;
   std::string dllexport_decl_;
   FieldGeneratorMap field_generators_;
   scoped_array<scoped_ptr<MessageGenerator> > nested_generators_;
   scoped_array<scoped_ptr<EnumGenerator> > enum_generators_;
   scoped_array<scoped_ptr<ExtensionGenerator> > extension_generators_;
 
+  // The singular fields which default to zero bytes, in the order they are
+  // laid out as one contiguous block of data members (see
+  // kMinFieldsForScalarBlock in cpp_message.cc); empty if the message has
+  // too few of them.
+  std::vector<const FieldDescriptor*> scalar_block_;
+
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MessageGenerator);
 };
 
@@ -45,8 +45,9 @@ namespace cpp {
 namespace {
 
 void SetMessageVariables(const FieldDescriptor* descriptor,
+                         const Options& options,
                          std::map<std::string, std::string>* variables) {
-  cpp::SetCommonFieldVariables(descriptor, variables);
+  cpp::SetCommonFieldVariables(descriptor, options, variables);
   (*variables)["type"] = cpp::FieldMessageTypeName(descriptor);
   (*variables)["stream_writer"] = (*variables)["declared_type"] +
       (cpp::HasFastArraySerialization(descriptor->message_type()->file()) ?
@@ -59,9 +60,10 @@ void SetMessageVariables(const FieldDescriptor* descriptor,
 // ===================================================================
 
 MessageFieldGenerator::
-MessageFieldGenerator(const FieldDescriptor* descriptor)
+MessageFieldGenerator(const FieldDescriptor* descriptor,
+                      const Options& options)
   : descriptor_(descriptor) {
-  SetMessageVariables(descriptor, &variables_);
+  SetMessageVariables(descriptor, options, &variables_);
 }
 
 MessageFieldGenerator::~MessageFieldGenerator() {}
@@ -83,17 +85,17 @@ void MessageFieldGenerator::
 GenerateInlineAccessorDefinitions(io::Printer* printer) const {
   printer->Print(variables_,
     "inline const $type$& $classname$::$name$() const {\n"
-    "  return $name$_ != NULL ? *$name$_ : *default_instance_->$name$_;\n"
+    "  return $member$ != NULL ? *$member$ : $type$::default_instance();\n"
     "}\n"
     "inline $type$* $classname$::mutable_$name$() {\n"
     "  set_has_$name$();\n"
-    "  if ($name$_ == NULL) $name$_ = new $type$;\n"
-    "  return $name$_;\n"
+    "  if ($mutable_member$ == NULL) $mutable_member$ = new $type$;\n"
+    "  return $member$;\n"
     "}\n"
     "inline $type$* $classname$::release_$name$() {\n"
     "  clear_has_$name$();\n"
-    "  $type$* temp = $name$_;\n"
-    "  $name$_ = NULL;\n"
+    "  $type$* temp = $mutable_member$;\n"
+    "  $member$ = NULL;\n"
     "  return temp;\n"
     "}\n");
 }
@@ -101,7 +103,7 @@ GenerateInlineAccessorDefinitions(io::Printer* printer) const {
 void MessageFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
   printer->Print(variables_,
-    "if ($name$_ != NULL) $name$_->$type$::Clear();\n");
+    "if ($member$ != NULL) $member$->$type$::Clear();\n");
 }
 
 void MessageFieldGenerator::
@@ -112,7 +114,7 @@ GenerateMergingCode(io::Printer* printer) const {
 
 void MessageFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "std::swap($name$_, other->$name$_);\n");
+  printer->Print(variables_, "std::swap($member$, other->$member$);\n");
 }
 
 void MessageFieldGenerator::
@@ -159,9 +161,10 @@ GenerateByteSize(io::Printer* printer) const {
 // ===================================================================
 
 RepeatedMessageFieldGenerator::
-RepeatedMessageFieldGenerator(const FieldDescriptor* descriptor)
+RepeatedMessageFieldGenerator(const FieldDescriptor* descriptor,
+                              const Options& options)
   : descriptor_(descriptor) {
-  SetMessageVariables(descriptor, &variables_);
+  SetMessageVariables(descriptor, options, &variables_);
 }
 
 RepeatedMessageFieldGenerator::~RepeatedMessageFieldGenerator() {}
@@ -189,38 +192,38 @@ void RepeatedMessageFieldGenerator::
 GenerateInlineAccessorDefinitions(io::Printer* printer) const {
   printer->Print(variables_,
     "inline const $type$& $classname$::$name$(int index) const {\n"
-    "  return $name$_.Get(index);\n"
+    "  return $member$.Get(index);\n"
     "}\n"
     "inline $type$* $classname$::mutable_$name$(int index) {\n"
-    "  return $name$_.Mutable(index);\n"
+    "  return $member$.Mutable(index);\n"
     "}\n"
     "inline $type$* $classname$::add_$name$() {\n"
-    "  return $name$_.Add();\n"
+    "  return $mutable_member$.Add();\n"
     "}\n");
   printer->Print(variables_,
     "inline const ::google::protobuf::RepeatedPtrField< $type$ >&\n"
     "$classname$::$name$() const {\n"
-    "  return $name$_;\n"
+    "  return $member$;\n"
     "}\n"
     "inline ::google::protobuf::RepeatedPtrField< $type$ >*\n"
     "$classname$::mutable_$name$() {\n"
-    "  return &$name$_;\n"
+    "  return &$mutable_member$;\n"
     "}\n");
 }
 
 void RepeatedMessageFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Clear();\n");
+  printer->Print(variables_, "$member$.Clear();\n");
 }
 
 void RepeatedMessageFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.MergeFrom(from.$name$_);\n");
+  printer->Print(variables_, "$mutable_member$.MergeFrom(from.$member$);\n");
 }
 
 void RepeatedMessageFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Swap(&other->$name$_);\n");
+  printer->Print(variables_, "$member$.Swap(&other->$member$);\n");
 }
 
 void RepeatedMessageFieldGenerator::
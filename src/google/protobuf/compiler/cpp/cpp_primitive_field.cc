@@ -80,8 +80,9 @@ int FixedSize(FieldDescriptor::Type type) {
 }
 
 void SetPrimitiveVariables(const FieldDescriptor* descriptor,
+                           const Options& options,
                            std::map<std::string, std::string>* variables) {
-  cpp::SetCommonFieldVariables(descriptor, variables);
+  cpp::SetCommonFieldVariables(descriptor, options, variables);
   (*variables)["type"] = cpp::PrimitiveTypeName(descriptor->cpp_type());
   (*variables)["default"] = cpp::DefaultValue(descriptor);
   (*variables)["tag"] = SimpleItoa(internal::WireFormat::MakeTag(descriptor));
@@ -99,9 +100,10 @@ void SetPrimitiveVariables(const FieldDescriptor* descriptor,
 // ===================================================================
 
 PrimitiveFieldGenerator::
-PrimitiveFieldGenerator(const FieldDescriptor* descriptor)
+PrimitiveFieldGenerator(const FieldDescriptor* descriptor,
+                        const Options& options)
   : descriptor_(descriptor) {
-  SetPrimitiveVariables(descriptor, &variables_);
+  SetPrimitiveVariables(descriptor, options, &variables_);
 }
 
 PrimitiveFieldGenerator::~PrimitiveFieldGenerator() {}
@@ -122,17 +124,17 @@ void PrimitiveFieldGenerator::
 GenerateInlineAccessorDefinitions(io::Printer* printer) const {
   printer->Print(variables_,
     "inline $type$ $classname$::$name$() const {\n"
-    "  return $name$_;\n"
+    "  return $member$;\n"
     "}\n"
     "inline void $classname$::set_$name$($type$ value) {\n"
     "  set_has_$name$();\n"
-    "  $name$_ = value;\n"
+    "  $mutable_member$ = value;\n"
     "}\n");
 }
 
 void PrimitiveFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_ = $default$;\n");
+  printer->Print(variables_, "$member$ = $default$;\n");
 }
 
 void PrimitiveFieldGenerator::
@@ -142,7 +144,7 @@ GenerateMergingCode(io::Printer* printer) const {
 
 void PrimitiveFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "std::swap($name$_, other->$name$_);\n");
+  printer->Print(variables_, "std::swap($member$, other->$member$);\n");
 }
 
 void PrimitiveFieldGenerator::
@@ -155,7 +157,7 @@ GenerateMergeFromCodedStream(io::Printer* printer) const {
   printer->Print(variables_,
     "DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<\n"
     "         $type$, $wire_format_field_type$>(\n"
-    "       input, &$name$_)));\n"
+    "       input, &$mutable_member$)));\n"
     "set_has_$name$();\n");
 }
 
@@ -190,9 +192,10 @@ GenerateByteSize(io::Printer* printer) const {
 // ===================================================================
 
 RepeatedPrimitiveFieldGenerator::
-RepeatedPrimitiveFieldGenerator(const FieldDescriptor* descriptor)
+RepeatedPrimitiveFieldGenerator(const FieldDescriptor* descriptor,
+                                const Options& options)
   : descriptor_(descriptor) {
-  SetPrimitiveVariables(descriptor, &variables_);
+  SetPrimitiveVariables(descriptor, options, &variables_);
 
   if (descriptor->options().packed()) {
     variables_["packed_reader"] = "ReadPackedPrimitive";
@@ -232,38 +235,38 @@ void RepeatedPrimitiveFieldGenerator::
 GenerateInlineAccessorDefinitions(io::Printer* printer) const {
   printer->Print(variables_,
     "inline $type$ $classname$::$name$(int index) const {\n"
-    "  return $name$_.Get(index);\n"
+    "  return $member$.Get(index);\n"
     "}\n"
     "inline void $classname$::set_$name$(int index, $type$ value) {\n"
-    "  $name$_.Set(index, value);\n"
+    "  $member$.Set(index, value);\n"
     "}\n"
     "inline void $classname$::add_$name$($type$ value) {\n"
-    "  $name$_.Add(value);\n"
+    "  $mutable_member$.Add(value);\n"
     "}\n");
   printer->Print(variables_,
     "inline const ::google::protobuf::RepeatedField< $type$ >&\n"
     "$classname$::$name$() const {\n"
-    "  return $name$_;\n"
+    "  return $member$;\n"
     "}\n"
     "inline ::google::protobuf::RepeatedField< $type$ >*\n"
     "$classname$::mutable_$name$() {\n"
-    "  return &$name$_;\n"
+    "  return &$mutable_member$;\n"
     "}\n");
 }
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Clear();\n");
+  printer->Print(variables_, "$member$.Clear();\n");
 }
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.MergeFrom(from.$name$_);\n");
+  printer->Print(variables_, "$mutable_member$.MergeFrom(from.$member$);\n");
 }
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Swap(&other->$name$_);\n");
+  printer->Print(variables_, "$member$.Swap(&other->$member$);\n");
 }
 
 void RepeatedPrimitiveFieldGenerator::
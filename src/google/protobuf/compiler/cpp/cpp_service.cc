@@ -43,14 +43,15 @@ namespace compiler {
 namespace cpp {
 
 ServiceGenerator::ServiceGenerator(const ServiceDescriptor* descriptor,
-                                   const std::string& dllexport_decl)
-  : descriptor_(descriptor) {
+                                   const Options& options)
+  : descriptor_(descriptor),
+    future_stubs_(options.future_stubs) {
   vars_["classname"] = descriptor_->name();
   vars_["full_name"] = descriptor_->full_name();
-  if (dllexport_decl.empty()) {
+  if (options.dllexport_decl.empty()) {
     vars_["dllexport"] = "";
   } else {
-    vars_["dllexport"] = dllexport_decl + " ";
+    vars_["dllexport"] = options.dllexport_decl + " ";
   }
 }
 
@@ -129,6 +130,16 @@ void ServiceGenerator::GenerateStubDefinition(io::Printer* printer) {
 
   GenerateMethodSignatures(NON_VIRTUAL, printer);
 
+  if (future_stubs_) {
+    printer->Print(
+      "\n"
+      "// Like the methods above, but the response is kept in *future, which\n"
+      "// is also run as the \"done\" callback.  Each Reset()s *future, starts\n"
+      "// the call and returns *future.  See RpcFuture in service.h.\n"
+      "\n");
+    GenerateFutureMethodSignatures(printer);
+  }
+
   printer->Outdent();
   printer->Print(vars_,
     " private:\n"
@@ -157,6 +168,22 @@ void ServiceGenerator::GenerateMethodSignatures(
   }
 }
 
+void ServiceGenerator::GenerateFutureMethodSignatures(io::Printer* printer) {
+  for (int i = 0; i < descriptor_->method_count(); i++) {
+    const MethodDescriptor* method = descriptor_->method(i);
+    std::map<std::string, std::string> sub_vars;
+    sub_vars["name"] = method->name();
+    sub_vars["input_type"] = ClassName(method->input_type(), true);
+    sub_vars["output_type"] = ClassName(method->output_type(), true);
+
+    printer->Print(sub_vars,
+      "::google::protobuf::RpcFuture< $output_type$>& $name$(\n"
+      "    ::google::protobuf::RpcController* controller,\n"
+      "    const $input_type$* request,\n"
+      "    ::google::protobuf::RpcFuture< $output_type$>* future);\n");
+  }
+}
+
 // ===================================================================
 
 void ServiceGenerator::GenerateDescriptorInitializer(
@@ -207,6 +234,9 @@ void ServiceGenerator::GenerateImplementation(io::Printer* printer) {
     "\n");
 
   GenerateStubMethods(printer);
+  if (future_stubs_) {
+    GenerateFutureStubMethods(printer);
+  }
 }
 
 void ServiceGenerator::GenerateNotImplementedMethods(io::Printer* printer) {
@@ -328,6 +358,30 @@ void ServiceGenerator::GenerateStubMethods(io::Printer* printer) {
   }
 }
 
+void ServiceGenerator::GenerateFutureStubMethods(io::Printer* printer) {
+  for (int i = 0; i < descriptor_->method_count(); i++) {
+    const MethodDescriptor* method = descriptor_->method(i);
+    std::map<std::string, std::string> sub_vars;
+    sub_vars["classname"] = descriptor_->name();
+    sub_vars["name"] = method->name();
+    sub_vars["index"] = SimpleItoa(i);
+    sub_vars["input_type"] = ClassName(method->input_type(), true);
+    sub_vars["output_type"] = ClassName(method->output_type(), true);
+
+    printer->Print(sub_vars,
+      "::google::protobuf::RpcFuture< $output_type$>& $classname$_Stub::$name$(\n"
+      "    ::google::protobuf::RpcController* controller,\n"
+      "    const $input_type$* request,\n"
+      "    ::google::protobuf::RpcFuture< $output_type$>* future) {\n"
+      "  future->Reset();\n"
+      "  channel_->CallMethod(descriptor()->method($index$),\n"
+      "                       controller, request, future->mutable_response(),\n"
+      "                       future);\n"
+      "  return *future;\n"
+      "}\n");
+  }
+}
+
 }  // namespace cpp
 }  // namespace compiler
 }  // namespace protobuf
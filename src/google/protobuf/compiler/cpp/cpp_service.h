@@ -39,6 +39,7 @@
 #include <string>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/compiler/cpp/cpp_options.h>
 
 namespace google {
 namespace protobuf {
@@ -53,9 +54,8 @@ namespace cpp {
 
 class ServiceGenerator {
  public:
-  // See generator.cc for the meaning of dllexport_decl.
   explicit ServiceGenerator(const ServiceDescriptor* descriptor,
-                            const std::string& dllexport_decl);
+                            const Options& options);
   ~ServiceGenerator();
 
   // Header stuff.
@@ -89,6 +89,9 @@ class ServiceGenerator {
   void GenerateMethodSignatures(VirtualOrNon virtual_or_non,
                                 io::Printer* printer);
 
+  // Prints signatures for the stub's methods returning an RpcFuture.
+  void GenerateFutureMethodSignatures(io::Printer* printer);
+
   // Source file stuff.
 
   // Generate the default implementations of the service methods, which
@@ -104,8 +107,13 @@ class ServiceGenerator {
   // Generate the stub's implementations of the service methods.
   void GenerateStubMethods(io::Printer* printer);
 
+  // Generate the stub's implementations of the methods returning an
+  // RpcFuture.
+  void GenerateFutureStubMethods(io::Printer* printer);
+
   const ServiceDescriptor* descriptor_;
   std::map<std::string, std::string> vars_;
+  bool future_stubs_;
 
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ServiceGenerator);
 };
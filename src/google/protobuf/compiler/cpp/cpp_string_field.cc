@@ -46,12 +46,15 @@ namespace cpp {
 namespace {
 
 void SetStringVariables(const FieldDescriptor* descriptor,
+                        const Options& options,
                         std::map<std::string, std::string>* variables) {
-  cpp::SetCommonFieldVariables(descriptor, variables);
+  cpp::SetCommonFieldVariables(descriptor, options, variables);
   (*variables)["default"] = cpp::DefaultValue(descriptor);
   (*variables)["default_variable"] = descriptor->default_value_string().empty()
       ? std::string( "::google::protobuf::internal::kEmptyString" )
       : std::string( "_default_" + cpp::FieldName(descriptor) + "_" );
+  (*variables)["default_storage"] =
+      "_default_" + cpp::FieldName(descriptor) + "_storage_";
   (*variables)["pointer_type"] =
       descriptor->type() == FieldDescriptor::TYPE_BYTES ? "void" : "char";
 }
@@ -61,9 +64,10 @@ void SetStringVariables(const FieldDescriptor* descriptor,
 // ===================================================================
 
 StringFieldGenerator::
-StringFieldGenerator(const FieldDescriptor* descriptor)
+StringFieldGenerator(const FieldDescriptor* descriptor,
+                     const Options& options)
   : descriptor_(descriptor) {
-  SetStringVariables(descriptor, &variables_);
+  SetStringVariables(descriptor, options, &variables_);
 }
 
 StringFieldGenerator::~StringFieldGenerator() {}
@@ -71,8 +75,12 @@ StringFieldGenerator::~StringFieldGenerator() {}
 void StringFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
   printer->Print(variables_, "::std::string* $name$_;\n");
+}
+
+void StringFieldGenerator::
+GenerateStaticMembers(io::Printer* printer) const {
   if (!descriptor_->default_value_string().empty()) {
-    printer->Print(variables_, "static const ::std::string $default_variable$;\n");
+    printer->Print(variables_, "static const ::std::string& $default_variable$;\n");
   }
 }
 
@@ -122,51 +130,52 @@ void StringFieldGenerator::
 GenerateInlineAccessorDefinitions(io::Printer* printer) const {
   printer->Print(variables_,
     "inline const ::std::string& $classname$::$name$() const {\n"
-    "  return *$name$_;\n"
+    "  return *$member$;\n"
     "}\n"
     "inline void $classname$::set_$name$(const ::std::string& value) {\n"
     "  set_has_$name$();\n"
-    "  if ($name$_ == &$default_variable$) {\n"
-    "    $name$_ = new ::std::string;\n"
+    "  if ($mutable_member$ == &$default_variable$) {\n"
+    "    $mutable_member$ = ::google::protobuf::internal::NewString();\n"
     "  }\n"
-    "  $name$_->assign(value);\n"
+    "  $member$->assign(value);\n"
     "}\n"
     "inline void $classname$::set_$name$(const char* value) {\n"
     "  set_has_$name$();\n"
-    "  if ($name$_ == &$default_variable$) {\n"
-    "    $name$_ = new ::std::string;\n"
+    "  if ($mutable_member$ == &$default_variable$) {\n"
+    "    $mutable_member$ = ::google::protobuf::internal::NewString();\n"
     "  }\n"
-    "  $name$_->assign(value);\n"
+    "  $member$->assign(value);\n"
     "}\n"
     "inline "
     "void $classname$::set_$name$(const $pointer_type$* value, size_t size) {\n"
     "  set_has_$name$();\n"
-    "  if ($name$_ == &$default_variable$) {\n"
-    "    $name$_ = new ::std::string;\n"
+    "  if ($mutable_member$ == &$default_variable$) {\n"
+    "    $mutable_member$ = ::google::protobuf::internal::NewString();\n"
     "  }\n"
-    "  $name$_->assign(reinterpret_cast<const char*>(value), size);\n"
+    "  $member$->assign(reinterpret_cast<const char*>(value), size);\n"
     "}\n"
     "inline ::std::string* $classname$::mutable_$name$() {\n"
     "  set_has_$name$();\n"
-    "  if ($name$_ == &$default_variable$) {\n");
+    "  if ($mutable_member$ == &$default_variable$) {\n");
   if (descriptor_->default_value_string().empty()) {
     printer->Print(variables_,
-      "    $name$_ = new ::std::string;\n");
+      "    $mutable_member$ = ::google::protobuf::internal::NewString();\n");
   } else {
     printer->Print(variables_,
-      "    $name$_ = new ::std::string($default_variable$);\n");
+      "    $mutable_member$ = ::google::protobuf::internal::NewString("
+      "$default_variable$);\n");
   }
   printer->Print(variables_,
     "  }\n"
-    "  return $name$_;\n"
+    "  return $member$;\n"
     "}\n"
     "inline ::std::string* $classname$::release_$name$() {\n"
     "  clear_has_$name$();\n"
-    "  if ($name$_ == &$default_variable$) {\n"
+    "  if ($member$ == &$default_variable$) {\n"
     "    return NULL;\n"
     "  } else {\n"
-    "    ::std::string* temp = $name$_;\n"
-    "    $name$_ = const_cast< ::std::string*>(&$default_variable$);\n"
+    "    ::std::string* temp = $member$;\n"
+    "    $member$ = const_cast< ::std::string*>(&$default_variable$);\n"
     "    return temp;\n"
     "  }\n"
     "}\n");
@@ -174,9 +183,35 @@ GenerateInlineAccessorDefinitions(io::Printer* printer) const {
 
 void StringFieldGenerator::
 GenerateNonInlineAccessorDefinitions(io::Printer* printer) const {
+  // The default value lives in zero-initialized storage and is constructed
+  // by the file's InitDefaults(), so it needs no dynamic initialization.
+  if (!descriptor_->default_value_string().empty()) {
+    printer->Print(variables_,
+      "namespace {\n"
+      "::google::protobuf::internal::StaticStorage< ::std::string>\n"
+      "  $classname$$default_storage$;\n"
+      "}  // namespace\n"
+      "const ::std::string& $classname$::$default_variable$ =\n"
+      "  *reinterpret_cast<const ::std::string*>(\n"
+      "    &$classname$$default_storage$);\n");
+  }
+}
+
+void StringFieldGenerator::
+GenerateDefaultValueInitializer(io::Printer* printer) const {
+  if (!descriptor_->default_value_string().empty()) {
+    printer->Print(variables_,
+      "new (const_cast< ::std::string*>(&$classname$::$default_variable$))\n"
+      "  ::std::string($default$);\n");
+  }
+}
+
+void StringFieldGenerator::
+GenerateDefaultValueShutdownCode(io::Printer* printer) const {
   if (!descriptor_->default_value_string().empty()) {
     printer->Print(variables_,
-      "const ::std::string $classname$::$default_variable$($default$);\n");
+      "::google::protobuf::internal::DestroyStaticObject("
+      "$classname$::$default_variable$);\n");
   }
 }
 
@@ -184,13 +219,13 @@ void StringFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
   if (descriptor_->default_value_string().empty()) {
     printer->Print(variables_,
-      "if ($name$_ != &$default_variable$) {\n"
-      "  $name$_->clear();\n"
+      "if ($member$ != &$default_variable$) {\n"
+      "  $member$->clear();\n"
       "}\n");
   } else {
     printer->Print(variables_,
-      "if ($name$_ != &$default_variable$) {\n"
-      "  $name$_->assign($default_variable$);\n"
+      "if ($member$ != &$default_variable$) {\n"
+      "  $member$->assign($default_variable$);\n"
       "}\n");
   }
 }
@@ -202,7 +237,7 @@ GenerateMergingCode(io::Printer* printer) const {
 
 void StringFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "std::swap($name$_, other->$name$_);\n");
+  printer->Print(variables_, "std::swap($member$, other->$member$);\n");
 }
 
 void StringFieldGenerator::
@@ -273,9 +308,10 @@ GenerateByteSize(io::Printer* printer) const {
 // ===================================================================
 
 RepeatedStringFieldGenerator::
-RepeatedStringFieldGenerator(const FieldDescriptor* descriptor)
+RepeatedStringFieldGenerator(const FieldDescriptor* descriptor,
+                             const Options& options)
   : descriptor_(descriptor) {
-  SetStringVariables(descriptor, &variables_);
+  SetStringVariables(descriptor, options, &variables_);
 }
 
 RepeatedStringFieldGenerator::~RepeatedStringFieldGenerator() {}
@@ -328,60 +364,60 @@ void RepeatedStringFieldGenerator::
 GenerateInlineAccessorDefinitions(io::Printer* printer) const {
   printer->Print(variables_,
     "inline const ::std::string& $classname$::$name$(int index) const {\n"
-    "  return $name$_.Get(index);\n"
+    "  return $member$.Get(index);\n"
     "}\n"
     "inline ::std::string* $classname$::mutable_$name$(int index) {\n"
-    "  return $name$_.Mutable(index);\n"
+    "  return $member$.Mutable(index);\n"
     "}\n"
     "inline void $classname$::set_$name$(int index, const ::std::string& value) {\n"
-    "  $name$_.Mutable(index)->assign(value);\n"
+    "  $member$.Mutable(index)->assign(value);\n"
     "}\n"
     "inline void $classname$::set_$name$(int index, const char* value) {\n"
-    "  $name$_.Mutable(index)->assign(value);\n"
+    "  $member$.Mutable(index)->assign(value);\n"
     "}\n"
     "inline void "
     "$classname$::set_$name$"
     "(int index, const $pointer_type$* value, size_t size) {\n"
-    "  $name$_.Mutable(index)->assign(\n"
+    "  $member$.Mutable(index)->assign(\n"
     "    reinterpret_cast<const char*>(value), size);\n"
     "}\n"
     "inline ::std::string* $classname$::add_$name$() {\n"
-    "  return $name$_.Add();\n"
+    "  return $mutable_member$.Add();\n"
     "}\n"
     "inline void $classname$::add_$name$(const ::std::string& value) {\n"
-    "  $name$_.Add()->assign(value);\n"
+    "  $mutable_member$.Add()->assign(value);\n"
     "}\n"
     "inline void $classname$::add_$name$(const char* value) {\n"
-    "  $name$_.Add()->assign(value);\n"
+    "  $mutable_member$.Add()->assign(value);\n"
     "}\n"
     "inline void "
     "$classname$::add_$name$(const $pointer_type$* value, size_t size) {\n"
-    "  $name$_.Add()->assign(reinterpret_cast<const char*>(value), size);\n"
+    "  $mutable_member$.Add()->assign(reinterpret_cast<const char*>(value), size);\n"
     "}\n");
   printer->Print(variables_,
     "inline const ::google::protobuf::RepeatedPtrField< ::std::string>&\n"
     "$classname$::$name$() const {\n"
-    "  return $name$_;\n"
+    "  return $member$;\n"
     "}\n"
     "inline ::google::protobuf::RepeatedPtrField< ::std::string>*\n"
     "$classname$::mutable_$name$() {\n"
-    "  return &$name$_;\n"
+    "  return &$mutable_member$;\n"
     "}\n");
 }
 
 void RepeatedStringFieldGenerator::
 GenerateClearingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Clear();\n");
+  printer->Print(variables_, "$member$.Clear();\n");
 }
 
 void RepeatedStringFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.MergeFrom(from.$name$_);\n");
+  printer->Print(variables_, "$mutable_member$.MergeFrom(from.$member$);\n");
 }
 
 void RepeatedStringFieldGenerator::
 GenerateSwappingCode(io::Printer* printer) const {
-  printer->Print(variables_, "$name$_.Swap(&other->$name$_);\n");
+  printer->Print(variables_, "$member$.Swap(&other->$member$);\n");
 }
 
 void RepeatedStringFieldGenerator::
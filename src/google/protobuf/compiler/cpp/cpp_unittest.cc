@@ -50,6 +50,8 @@
 #include <google/protobuf/unittest_no_generic_services.pb.h>
 #include <google/protobuf/test_util.h>
 #include <google/protobuf/compiler/cpp/cpp_test_bad_identifiers.pb.h>
+#include <google/protobuf/compiler/cpp/cpp_test_future_stubs.pb.h>
+#include <google/protobuf/compiler/cpp/cpp_test_many_fields.pb.h>
 #include <google/protobuf/compiler/importer.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
@@ -793,6 +795,119 @@ TEST(GeneratedMessageTest, ExtensionConstantValues) {
   EXPECT_EQ(unittest::kRepeatedNestedEnumExtensionFieldNumber, 51);
 }
 
+#ifndef PROTOBUF_TEST_NO_DESCRIPTORS
+
+// TestManyFields is compiled with has_bit_iteration=true, and has enough
+// fields for its generated methods to visit only the fields which are set.
+// Check them against reflection, which visits all fields in field number
+// order.
+TEST(GeneratedMessageTest, ManyFields) {
+  unittest::TestManyFields message1;
+  message1.set_optional_fixed32_1(1);
+  message1.set_optional_sint64_4(-4);
+  message1.mutable_optional_message_10()->set_bb(10);
+  message1.add_repeated_int32_21(21);
+  message1.add_repeated_string_26("26");
+  message1.set_optional_string_32("32");
+  message1.add_packed_int32_42(42);
+  message1.set_optional_double_47(47);
+  message1.set_optional_int32_200(200);
+  message1.SetExtension(unittest::many_fields_extension, 150);
+
+  DynamicMessageFactory factory;
+  scoped_ptr<Message> dynamic_message(factory.GetPrototype(
+      unittest::TestManyFields::descriptor())->New());
+
+  // Both serializers write the fields in the same order.
+  std::string data = message1.SerializeAsString();
+  EXPECT_EQ(message1.ByteSize(), data.size());
+  ASSERT_TRUE(dynamic_message->ParseFromString(data));
+  EXPECT_EQ(data, dynamic_message->SerializeAsString());
+
+  std::string stream_data;
+  {
+    io::StringOutputStream output(&stream_data);
+    io::CodedOutputStream coded_output(&output);
+    message1.SerializeWithCachedSizes(&coded_output);
+  }
+  EXPECT_EQ(data, stream_data);
+
+  unittest::TestManyFields message2;
+  message2.set_optional_fixed32_1(100);
+  message2.set_optional_int32_7(7);
+  message2.add_repeated_int32_21(210);
+  message2.MergeFrom(message1);
+  EXPECT_EQ(1, message2.optional_fixed32_1());
+  EXPECT_EQ(7, message2.optional_int32_7());
+  EXPECT_EQ(-4, message2.optional_sint64_4());
+  EXPECT_EQ(10, message2.optional_message_10().bb());
+  EXPECT_EQ(2, message2.repeated_int32_21_size());
+  EXPECT_EQ("32", message2.optional_string_32());
+  EXPECT_EQ(200, message2.optional_int32_200());
+  EXPECT_EQ(150, message2.GetExtension(unittest::many_fields_extension));
+
+  message2.Clear();
+  EXPECT_EQ(0, message2.ByteSize());
+  EXPECT_FALSE(message2.has_optional_fixed32_1());
+  EXPECT_EQ(0, message2.optional_fixed32_1());
+  EXPECT_EQ(0, message2.optional_int32_7());
+  EXPECT_FALSE(message2.has_optional_message_10());
+  EXPECT_FALSE(message2.optional_message_10().has_bb());
+  EXPECT_EQ("", message2.optional_string_32());
+  EXPECT_EQ(0, message2.repeated_int32_21_size());
+
+  message2.CopyFrom(message1);
+  EXPECT_EQ(data, message2.SerializeAsString());
+}
+
+TEST(GeneratedMessageTest, ScalarBlock) {
+  // The optional numbers and bool of TestAllTypes default to zero, so they
+  // are laid out in one block, which Clear() resets with memset() and
+  // MergeFrom() and CopyFrom() copy with memcpy() when they can.
+  unittest::TestAllTypes message1;
+  message1.set_optional_int32(1);
+  message1.set_optional_double(2);
+  message1.set_default_int32(3);
+
+  unittest::TestAllTypes message2;
+  message2.set_optional_int32(10);
+  message2.set_optional_int64(20);
+  message2.set_optional_bool(true);
+
+  // Merging some of the block's fields leaves the others alone.
+  message2.MergeFrom(message1);
+  EXPECT_EQ(1, message2.optional_int32());
+  EXPECT_EQ(20, message2.optional_int64());
+  EXPECT_EQ(2, message2.optional_double());
+  EXPECT_TRUE(message2.optional_bool());
+  EXPECT_EQ(3, message2.default_int32());
+  EXPECT_FALSE(message2.has_optional_uint32());
+
+  // Copying replaces all of them.
+  message2.CopyFrom(message1);
+  EXPECT_EQ(1, message2.optional_int32());
+  EXPECT_FALSE(message2.has_optional_int64());
+  EXPECT_EQ(0, message2.optional_int64());
+  EXPECT_FALSE(message2.has_optional_bool());
+  EXPECT_FALSE(message2.optional_bool());
+  EXPECT_EQ(message1.SerializeAsString(), message2.SerializeAsString());
+
+  // Merging all of them copies the whole block.
+  TestUtil::SetAllFields(&message1);
+  message2.MergeFrom(message1);
+  TestUtil::ExpectAllFieldsSet(message2);
+
+  message2.Clear();
+  TestUtil::ExpectClear(message2);
+
+  // CopyFrom() through the Message interface takes the same path.
+  Message* message = &message2;
+  message->CopyFrom(message1);
+  TestUtil::ExpectAllFieldsSet(message2);
+}
+
+#endif  // !PROTOBUF_TEST_NO_DESCRIPTORS
+
 // ===================================================================
 
 TEST(GeneratedEnumTest, EnumValuesAsSwitchCases) {
@@ -1178,6 +1293,100 @@ TEST_F(GeneratedServiceTest, Stub) {
   EXPECT_EQ(bar_, mock_channel_.method_);
 }
 
+TEST_F(GeneratedServiceTest, FutureStub) {
+  // Test the methods generated by the future_stubs option, with which
+  // cpp_test_future_stubs.proto is compiled.
+  const MethodDescriptor* foo =
+      unittest::TestFutureService::descriptor()->FindMethodByName("Foo");
+  unittest::TestFutureService::Stub stub(&mock_channel_);
+
+  // A Closure counting how many times it is run.
+  class CountingClosure : public Closure {
+   public:
+    CountingClosure() : runs_(0) {}
+    void Run() { ++runs_; }
+    int runs_;
+  };
+
+  RpcFuture<unittest::FooResponse> future;
+  future.mutable_response()->mutable_unknown_fields()->AddVarint(1, 2);
+  RpcFuture<unittest::FooResponse>& result =
+      stub.Foo(&mock_controller_, &foo_request_, &future);
+  EXPECT_EQ(&future, &result);
+
+  // The stub Reset() the future, and made it the response and "done".
+  ASSERT_TRUE(mock_channel_.called_);
+  EXPECT_EQ(foo              , mock_channel_.method_    );
+  EXPECT_EQ(&mock_controller_, mock_channel_.controller_);
+  EXPECT_EQ(&foo_request_    , mock_channel_.request_   );
+  EXPECT_EQ(future.mutable_response(), mock_channel_.response_);
+  EXPECT_EQ(&future          , mock_channel_.done_      );
+  EXPECT_EQ(0, future.response().unknown_fields().field_count());
+
+  CountingClosure callback;
+  EXPECT_FALSE(future.IsDone());
+  future.Then(&callback);
+  EXPECT_EQ(0, callback.runs_);
+
+  // The channel completes the call.
+  mock_channel_.done_->Run();
+  EXPECT_TRUE(future.IsDone());
+  EXPECT_EQ(1, callback.runs_);
+  future.Wait();  // returns at once
+
+  // Then() on a finished call runs the callback right away.
+  CountingClosure callback2;
+  future.Then(&callback2);
+  EXPECT_EQ(1, callback2.runs_);
+
+  // The future can be used again.
+  mock_channel_.Reset();
+  stub.Foo(&mock_controller_, &foo_request_, &future);
+  ASSERT_TRUE(mock_channel_.called_);
+  EXPECT_FALSE(future.IsDone());
+  mock_channel_.done_->Run();
+  EXPECT_TRUE(future.IsDone());
+  EXPECT_EQ(1, callback.runs_);
+}
+
+TEST_F(GeneratedServiceTest, FutureCallbackStartsNextCall) {
+  unittest::TestFutureService::Stub stub(&mock_channel_);
+
+  // A callback which checks that the call is done and makes the next call
+  // with the same future, as a coroutine resumed by co_await may.
+  class NextCall : public Closure {
+   public:
+    NextCall(unittest::TestFutureService::Stub* stub,
+             RpcController* controller, const unittest::FooRequest* request,
+             RpcFuture<unittest::FooResponse>* future)
+        : stub_(stub), controller_(controller), request_(request),
+          future_(future), was_done_(false) {}
+    void Run() {
+      was_done_ = future_->IsDone();
+      stub_->Foo(controller_, request_, future_);
+    }
+    unittest::TestFutureService::Stub* stub_;
+    RpcController* controller_;
+    const unittest::FooRequest* request_;
+    RpcFuture<unittest::FooResponse>* future_;
+    bool was_done_;
+  };
+
+  RpcFuture<unittest::FooResponse> future;
+  NextCall next_call(&stub, &mock_controller_, &foo_request_, &future);
+  stub.Foo(&mock_controller_, &foo_request_, &future).Then(&next_call);
+  mock_channel_.Reset();
+  mock_channel_.done_->Run();
+  EXPECT_TRUE(next_call.was_done_);
+
+  // Completing the first call left the second one alone.
+  ASSERT_TRUE(mock_channel_.called_);
+  EXPECT_FALSE(future.IsDone());
+  mock_channel_.done_->Run();
+  EXPECT_TRUE(future.IsDone());
+  future.Wait();
+}
+
 TEST_F(GeneratedServiceTest, NotImplemented) {
   // Test that failing to implement a method of a service causes it to fail
   // with a "not implemented" error message.
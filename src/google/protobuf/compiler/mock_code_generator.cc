@@ -32,6 +32,12 @@
 
 #include <google/protobuf/compiler/mock_code_generator.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
 #include <google/protobuf/testing/file.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/io/zero_copy_stream.h>
@@ -132,6 +138,15 @@ bool MockCodeGenerator::Generate(
       } else if (command == "Abort") {
         std::cerr << "Saw message type MockCodeGenerator_Abort." << std::endl;
         abort();
+      } else if (command == "Hang") {
+        std::cerr << "Saw message type MockCodeGenerator_Hang." << std::endl;
+        while (true) {
+#ifdef _WIN32
+          Sleep(INFINITE);
+#else
+          pause();
+#endif
+        }
       } else {
         GOOGLE_LOG(FATAL) << "Unknown MockCodeGenerator command: " << command;
       }
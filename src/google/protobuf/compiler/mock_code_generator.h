@@ -59,6 +59,8 @@ namespace compiler {
 //     MockCodeGenerator_Exit." to stderr and then calls exit(123).
 //   MockCodeGenerator_Abort:  Generate() prints "Saw message type
 //     MockCodeGenerator_Abort." to stderr and then calls abort().
+//   MockCodeGenerator_Hang:  Generate() prints "Saw message type
+//     MockCodeGenerator_Hang." to stderr and then never returns.
 class MockCodeGenerator : public CodeGenerator {
  public:
   MockCodeGenerator(const std::string& name);
@@ -32,6 +32,7 @@
 
 #include <google/protobuf/compiler/plugin.h>
 
+#include <string.h>
 #include <iostream>
 #include <set>
 
@@ -56,6 +57,7 @@
 #include <google/protobuf/compiler/plugin.pb.h>
 #include <google/protobuf/compiler/code_generator.h>
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 
 
@@ -96,30 +98,19 @@ class GeneratorResponseContext : public GeneratorContext {
   const std::vector<const FileDescriptor*>& parsed_files_;
 };
 
-int PluginMain(int argc, char* argv[], const CodeGenerator* generator) {
-
-  if (argc > 1) {
-    std::cerr << argv[0] << ": Unknown option: " << argv[1] << std::endl;
-    return 1;
-  }
-
-#ifdef _WIN32
-  _setmode(STDIN_FILENO, _O_BINARY);
-  _setmode(STDOUT_FILENO, _O_BINARY);
-#endif
-
-  CodeGeneratorRequest request;
-  if (!request.ParseFromFileDescriptor(STDIN_FILENO)) {
-    std::cerr << argv[0] << ": protoc sent unparseable request to plugin." << std::endl;
-    return 1;
-  }
-
+// Runs the generator on every file in the request, filling in *response.
+// Returns false, having written the reason to stderr, if the request itself
+// is malformed.
+static bool GenerateCode(const char* program_name,
+                         const CodeGeneratorRequest& request,
+                         const CodeGenerator* generator,
+                         CodeGeneratorResponse* response) {
   DescriptorPool pool;
   for (int i = 0; i < request.proto_file_size(); i++) {
     const FileDescriptor* file = pool.BuildFile(request.proto_file(i));
     if (file == NULL) {
       // BuildFile() already wrote an error message.
-      return 1;
+      return false;
     }
   }
 
@@ -127,15 +118,14 @@ int PluginMain(int argc, char* argv[], const CodeGenerator* generator) {
   for (int i = 0; i < request.file_to_generate_size(); i++) {
     parsed_files.push_back(pool.FindFileByName(request.file_to_generate(i)));
     if (parsed_files.back() == NULL) {
-      std::cerr << argv[0] << ": protoc asked plugin to generate a file but "
+      std::cerr << program_name << ": protoc asked plugin to generate a file but "
               "did not provide a descriptor for the file: "
            << request.file_to_generate(i) << std::endl;
-      return 1;
+      return false;
     }
   }
 
-  CodeGeneratorResponse response;
-  GeneratorResponseContext context(&response, parsed_files);
+  GeneratorResponseContext context(response, parsed_files);
 
   for (int i = 0; i < parsed_files.size(); i++) {
     const FileDescriptor* file = parsed_files[i];
@@ -149,11 +139,91 @@ int PluginMain(int argc, char* argv[], const CodeGenerator* generator) {
               "description.";
     }
     if (!error.empty()) {
-      response.set_error(file->name() + ": " + error);
+      response->set_error(file->name() + ": " + error);
       break;
     }
   }
 
+  return true;
+}
+
+// Serves requests until stdin ends, as described for persistent plugins in
+// plugin.proto.
+static int ServeRequests(const char* program_name,
+                         const CodeGenerator* generator) {
+  io::FileInputStream input(STDIN_FILENO);
+  io::FileOutputStream output(STDOUT_FILENO);
+
+  while (true) {
+    CodeGeneratorRequest request;
+    {
+      // A new CodedInputStream for each request, so that the total bytes
+      // limit applies to each one rather than to the whole stream.  Its
+      // destructor hands any read-ahead back to input.
+      io::CodedInputStream coded_input(&input);
+      uint32 size;
+      if (!coded_input.ReadVarint32(&size)) {
+        // End of input.
+        return 0;
+      }
+      io::CodedInputStream::Limit limit = coded_input.PushLimit(size);
+      if (!request.ParseFromCodedStream(&coded_input) ||
+          !coded_input.ConsumedEntireMessage()) {
+        std::cerr << program_name << ": protoc sent unparseable request to "
+                     "plugin." << std::endl;
+        return 1;
+      }
+      coded_input.PopLimit(limit);
+    }
+
+    CodeGeneratorResponse response;
+    if (!GenerateCode(program_name, request, generator, &response)) {
+      return 1;
+    }
+
+    {
+      io::CodedOutputStream coded_output(&output);
+      coded_output.WriteVarint32(response.ByteSize());
+      response.SerializeWithCachedSizes(&coded_output);
+      if (coded_output.HadError()) break;
+    }
+    if (!output.Flush()) break;
+  }
+
+  std::cerr << program_name << ": Error writing to stdout." << std::endl;
+  return 1;
+}
+
+int PluginMain(int argc, char* argv[], const CodeGenerator* generator) {
+
+  bool persistent = false;
+  if (argc == 2 && strcmp(argv[1], "--persistent") == 0) {
+    persistent = true;
+  } else if (argc > 1) {
+    std::cerr << argv[0] << ": Unknown option: " << argv[1] << std::endl;
+    return 1;
+  }
+
+#ifdef _WIN32
+  _setmode(STDIN_FILENO, _O_BINARY);
+  _setmode(STDOUT_FILENO, _O_BINARY);
+#endif
+
+  if (persistent) {
+    return ServeRequests(argv[0], generator);
+  }
+
+  CodeGeneratorRequest request;
+  if (!request.ParseFromFileDescriptor(STDIN_FILENO)) {
+    std::cerr << argv[0] << ": protoc sent unparseable request to plugin." << std::endl;
+    return 1;
+  }
+
+  CodeGeneratorResponse response;
+  if (!GenerateCode(argv[0], request, generator, &response)) {
+    return 1;
+  }
+
   if (!response.SerializeToFileDescriptor(STDOUT_FILENO)) {
     std::cerr << argv[0] << ": Error writing to stdout." << std::endl;
     return 1;
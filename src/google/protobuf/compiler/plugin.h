@@ -51,6 +51,11 @@
 //     protoc --plugin=protoc-gen-NAME=path/to/mybinary --NAME_out=OUT_DIR
 //   On Windows, make sure to include the .exe suffix:
 //     protoc --plugin=protoc-gen-NAME=path/to/mybinary.exe --NAME_out=OUT_DIR
+//
+// PluginMain() also implements the persistent plugin protocol described in
+// plugin.proto, so such plugins can be kept running by a plugin server
+// (protoc --serve_plugins) between invocations of protoc.  Note that the
+// generator is then called for many requests in turn, in one process.
 
 #ifndef GOOGLE_PROTOBUF_COMPILER_PLUGIN_H__
 #define GOOGLE_PROTOBUF_COMPILER_PLUGIN_H__
@@ -28,12 +28,49 @@ const ::google::protobuf::internal::GeneratedMessageReflection*
 const ::google::protobuf::Descriptor* CodeGeneratorResponse_File_descriptor_ = NULL;
 const ::google::protobuf::internal::GeneratedMessageReflection*
   CodeGeneratorResponse_File_reflection_ = NULL;
+const ::google::protobuf::Descriptor* PluginServerRequest_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  PluginServerRequest_reflection_ = NULL;
+const ::google::protobuf::Descriptor* PluginServerResponse_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  PluginServerResponse_reflection_ = NULL;
+
+}  // namespace
+
+
+namespace {
+
+bool protobuf_defaults_initialized_ = false;
 
 }  // namespace
 
+void protobuf_InitDefaults_google_2fprotobuf_2fcompiler_2fplugin_2eproto() {
+  new (CodeGeneratorRequest::default_instance_) CodeGeneratorRequest();
+  new (CodeGeneratorResponse::default_instance_) CodeGeneratorResponse();
+  new (CodeGeneratorResponse_File::default_instance_) CodeGeneratorResponse_File();
+  new (PluginServerRequest::default_instance_) PluginServerRequest();
+  new (PluginServerResponse::default_instance_) PluginServerResponse();
+  CodeGeneratorRequest::default_instance_->InitAsDefaultInstance();
+  CodeGeneratorResponse::default_instance_->InitAsDefaultInstance();
+  CodeGeneratorResponse_File::default_instance_->InitAsDefaultInstance();
+  PluginServerRequest::default_instance_->InitAsDefaultInstance();
+  PluginServerResponse::default_instance_->InitAsDefaultInstance();
+  protobuf_defaults_initialized_ = true;
+}
+
+namespace {
+
+GOOGLE_PROTOBUF_DECLARE_ONCE(protobuf_InitDefaults_once_);
+inline void protobuf_InitDefaultsOnce() {
+  ::google::protobuf::GoogleOnceInit(&protobuf_InitDefaults_once_,
+                 &protobuf_InitDefaults_google_2fprotobuf_2fcompiler_2fplugin_2eproto);
+}
+
+}  // namespace
 
 void protobuf_AssignDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto() {
   protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+  protobuf_InitDefaultsOnce();
   const ::google::protobuf::FileDescriptor* file =
     ::google::protobuf::DescriptorPool::generated_pool()->FindFileByName(
       "google/protobuf/compiler/plugin.proto");
@@ -88,6 +125,39 @@ void protobuf_AssignDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(CodeGeneratorResponse_File));
+  PluginServerRequest_descriptor_ = file->message_type(2);
+  static const int PluginServerRequest_offsets_[3] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(PluginServerRequest, plugin_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(PluginServerRequest, search_path_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(PluginServerRequest, request_),
+  };
+  PluginServerRequest_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      PluginServerRequest_descriptor_,
+      PluginServerRequest::default_instance_,
+      PluginServerRequest_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(PluginServerRequest, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(PluginServerRequest, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(PluginServerRequest));
+  PluginServerResponse_descriptor_ = file->message_type(3);
+  static const int PluginServerResponse_offsets_[2] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(PluginServerResponse, error_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(PluginServerResponse, response_),
+  };
+  PluginServerResponse_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      PluginServerResponse_descriptor_,
+      PluginServerResponse::default_instance_,
+      PluginServerResponse_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(PluginServerResponse, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(PluginServerResponse, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(PluginServerResponse));
 }
 
 namespace {
@@ -106,17 +176,27 @@ void protobuf_RegisterTypes(const ::std::string&) {
     CodeGeneratorResponse_descriptor_, &CodeGeneratorResponse::default_instance());
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
     CodeGeneratorResponse_File_descriptor_, &CodeGeneratorResponse_File::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    PluginServerRequest_descriptor_, &PluginServerRequest::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    PluginServerResponse_descriptor_, &PluginServerResponse::default_instance());
 }
 
 }  // namespace
 
 void protobuf_ShutdownFile_google_2fprotobuf_2fcompiler_2fplugin_2eproto() {
-  delete CodeGeneratorRequest::default_instance_;
+  if (protobuf_defaults_initialized_) {
+    ::google::protobuf::internal::DestroyStaticObject(*CodeGeneratorRequest::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*CodeGeneratorResponse::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*CodeGeneratorResponse_File::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*PluginServerRequest::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*PluginServerResponse::default_instance_);
+  }
   delete CodeGeneratorRequest_reflection_;
-  delete CodeGeneratorResponse::default_instance_;
   delete CodeGeneratorResponse_reflection_;
-  delete CodeGeneratorResponse_File::default_instance_;
   delete CodeGeneratorResponse_File_reflection_;
+  delete PluginServerRequest_reflection_;
+  delete PluginServerResponse_reflection_;
 }
 
 void protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto() {
@@ -136,15 +216,15 @@ void protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto() {
     "atorResponse\022\r\n\005error\030\001 \001(\t\022B\n\004file\030\017 \003("
     "\01324.google.protobuf.compiler.CodeGenerat"
     "orResponse.File\032>\n\004File\022\014\n\004name\030\001 \001(\t\022\027\n"
-    "\017insertion_point\030\002 \001(\t\022\017\n\007content\030\017 \001(\t", 399);
+    "\017insertion_point\030\002 \001(\t\022\017\n\007content\030\017 \001(\t\""
+    "{\n\023PluginServerRequest\022\016\n\006plugin\030\001 \001(\t\022\023"
+    "\n\013search_path\030\002 \001(\010\022\?\n\007request\030\003 \001(\0132..g"
+    "oogle.protobuf.compiler.CodeGeneratorReq"
+    "uest\"h\n\024PluginServerResponse\022\r\n\005error\030\001 "
+    "\001(\t\022A\n\010response\030\002 \001(\0132/.google.protobuf."
+    "compiler.CodeGeneratorResponse", 630);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "google/protobuf/compiler/plugin.proto", &protobuf_RegisterTypes);
-  CodeGeneratorRequest::default_instance_ = new CodeGeneratorRequest();
-  CodeGeneratorResponse::default_instance_ = new CodeGeneratorResponse();
-  CodeGeneratorResponse_File::default_instance_ = new CodeGeneratorResponse_File();
-  CodeGeneratorRequest::default_instance_->InitAsDefaultInstance();
-  CodeGeneratorResponse::default_instance_->InitAsDefaultInstance();
-  CodeGeneratorResponse_File::default_instance_->InitAsDefaultInstance();
   ::google::protobuf::internal::OnShutdown(&protobuf_ShutdownFile_google_2fprotobuf_2fcompiler_2fplugin_2eproto);
 }
 
@@ -207,10 +287,16 @@ const ::google::protobuf::Descriptor* CodeGeneratorRequest::descriptor() {
 }
 
 const CodeGeneratorRequest& CodeGeneratorRequest::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-CodeGeneratorRequest* CodeGeneratorRequest::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<CodeGeneratorRequest>
+  CodeGeneratorRequest_default_instance_storage_;
+}  // namespace
+CodeGeneratorRequest* CodeGeneratorRequest::default_instance_ =
+  reinterpret_cast<CodeGeneratorRequest*>(&CodeGeneratorRequest_default_instance_storage_);
 
 CodeGeneratorRequest* CodeGeneratorRequest::New() const {
   return new CodeGeneratorRequest;
@@ -530,10 +616,16 @@ const ::google::protobuf::Descriptor* CodeGeneratorResponse_File::descriptor() {
 }
 
 const CodeGeneratorResponse_File& CodeGeneratorResponse_File::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-CodeGeneratorResponse_File* CodeGeneratorResponse_File::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<CodeGeneratorResponse_File>
+  CodeGeneratorResponse_File_default_instance_storage_;
+}  // namespace
+CodeGeneratorResponse_File* CodeGeneratorResponse_File::default_instance_ =
+  reinterpret_cast<CodeGeneratorResponse_File*>(&CodeGeneratorResponse_File_default_instance_storage_);
 
 CodeGeneratorResponse_File* CodeGeneratorResponse_File::New() const {
   return new CodeGeneratorResponse_File;
@@ -859,10 +951,16 @@ const ::google::protobuf::Descriptor* CodeGeneratorResponse::descriptor() {
 }
 
 const CodeGeneratorResponse& CodeGeneratorResponse::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-CodeGeneratorResponse* CodeGeneratorResponse::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<CodeGeneratorResponse>
+  CodeGeneratorResponse_default_instance_storage_;
+}  // namespace
+CodeGeneratorResponse* CodeGeneratorResponse::default_instance_ =
+  reinterpret_cast<CodeGeneratorResponse*>(&CodeGeneratorResponse_default_instance_storage_);
 
 CodeGeneratorResponse* CodeGeneratorResponse::New() const {
   return new CodeGeneratorResponse;
@@ -1073,6 +1171,599 @@ void CodeGeneratorResponse::Swap(CodeGeneratorResponse* other) {
 }
 
 
+// ===================================================================
+
+#ifndef _MSC_VER
+const int PluginServerRequest::kPluginFieldNumber;
+const int PluginServerRequest::kSearchPathFieldNumber;
+const int PluginServerRequest::kRequestFieldNumber;
+#endif  // !_MSC_VER
+
+PluginServerRequest::PluginServerRequest()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void PluginServerRequest::InitAsDefaultInstance() {
+  request_ = const_cast< ::google::protobuf::compiler::CodeGeneratorRequest*>(
+      ::google::protobuf::compiler::CodeGeneratorRequest::internal_default_instance());
+}
+
+PluginServerRequest::PluginServerRequest(const PluginServerRequest& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void PluginServerRequest::SharedCtor() {
+  _cached_size_ = 0;
+  plugin_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+  search_path_ = false;
+  request_ = NULL;
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+PluginServerRequest::~PluginServerRequest() {
+  SharedDtor();
+}
+
+void PluginServerRequest::SharedDtor() {
+  if (plugin_ != &::google::protobuf::internal::kEmptyString) {
+    delete plugin_;
+  }
+  if (this != default_instance_) {
+    delete request_;
+  }
+}
+
+void PluginServerRequest::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* PluginServerRequest::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return PluginServerRequest_descriptor_;
+}
+
+const PluginServerRequest& PluginServerRequest::default_instance() {
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
+}
+
+namespace {
+::google::protobuf::internal::StaticStorage<PluginServerRequest>
+  PluginServerRequest_default_instance_storage_;
+}  // namespace
+PluginServerRequest* PluginServerRequest::default_instance_ =
+  reinterpret_cast<PluginServerRequest*>(&PluginServerRequest_default_instance_storage_);
+
+PluginServerRequest* PluginServerRequest::New() const {
+  return new PluginServerRequest;
+}
+
+void PluginServerRequest::Clear() {
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (has_plugin()) {
+      if (plugin_ != &::google::protobuf::internal::kEmptyString) {
+        plugin_->clear();
+      }
+    }
+    search_path_ = false;
+    if (has_request()) {
+      if (request_ != NULL) request_->::google::protobuf::compiler::CodeGeneratorRequest::Clear();
+    }
+  }
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool PluginServerRequest::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // optional string plugin = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadString(
+                input, this->mutable_plugin()));
+          ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+            this->plugin().data(), this->plugin().length(),
+            ::google::protobuf::internal::WireFormat::PARSE);
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(16)) goto parse_search_path;
+        break;
+      }
+      
+      // optional bool search_path = 2;
+      case 2: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_search_path:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &search_path_)));
+          set_has_search_path();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(26)) goto parse_request;
+        break;
+      }
+      
+      // optional .google.protobuf.compiler.CodeGeneratorRequest request = 3;
+      case 3: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_request:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+               input, mutable_request()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+      
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void PluginServerRequest::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // optional string plugin = 1;
+  if (has_plugin()) {
+    ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+      this->plugin().data(), this->plugin().length(),
+      ::google::protobuf::internal::WireFormat::SERIALIZE);
+    ::google::protobuf::internal::WireFormatLite::WriteString(
+      1, this->plugin(), output);
+  }
+  
+  // optional bool search_path = 2;
+  if (has_search_path()) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(2, this->search_path(), output);
+  }
+  
+  // optional .google.protobuf.compiler.CodeGeneratorRequest request = 3;
+  if (has_request()) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      3, this->request(), output);
+  }
+  
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* PluginServerRequest::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // optional string plugin = 1;
+  if (has_plugin()) {
+    ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+      this->plugin().data(), this->plugin().length(),
+      ::google::protobuf::internal::WireFormat::SERIALIZE);
+    target =
+      ::google::protobuf::internal::WireFormatLite::WriteStringToArray(
+        1, this->plugin(), target);
+  }
+  
+  // optional bool search_path = 2;
+  if (has_search_path()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(2, this->search_path(), target);
+  }
+  
+  // optional .google.protobuf.compiler.CodeGeneratorRequest request = 3;
+  if (has_request()) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        3, this->request(), target);
+  }
+  
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int PluginServerRequest::ByteSize() const {
+  int total_size = 0;
+  
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // optional string plugin = 1;
+    if (has_plugin()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::StringSize(
+          this->plugin());
+    }
+    
+    // optional bool search_path = 2;
+    if (has_search_path()) {
+      total_size += 1 + 1;
+    }
+    
+    // optional .google.protobuf.compiler.CodeGeneratorRequest request = 3;
+    if (has_request()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+          this->request());
+    }
+    
+  }
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void PluginServerRequest::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const PluginServerRequest* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const PluginServerRequest*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void PluginServerRequest::MergeFrom(const PluginServerRequest& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_plugin()) {
+      set_plugin(from.plugin());
+    }
+    if (from.has_search_path()) {
+      set_search_path(from.search_path());
+    }
+    if (from.has_request()) {
+      mutable_request()->::google::protobuf::compiler::CodeGeneratorRequest::MergeFrom(from.request());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void PluginServerRequest::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void PluginServerRequest::CopyFrom(const PluginServerRequest& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool PluginServerRequest::IsInitialized() const {
+  
+  if (has_request()) {
+    if (!this->request().IsInitialized()) return false;
+  }
+  return true;
+}
+
+void PluginServerRequest::Swap(PluginServerRequest* other) {
+  if (other != this) {
+    std::swap(plugin_, other->plugin_);
+    std::swap(search_path_, other->search_path_);
+    std::swap(request_, other->request_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata PluginServerRequest::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = PluginServerRequest_descriptor_;
+  metadata.reflection = PluginServerRequest_reflection_;
+  return metadata;
+}
+
+
+// ===================================================================
+
+#ifndef _MSC_VER
+const int PluginServerResponse::kErrorFieldNumber;
+const int PluginServerResponse::kResponseFieldNumber;
+#endif  // !_MSC_VER
+
+PluginServerResponse::PluginServerResponse()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void PluginServerResponse::InitAsDefaultInstance() {
+  response_ = const_cast< ::google::protobuf::compiler::CodeGeneratorResponse*>(
+      ::google::protobuf::compiler::CodeGeneratorResponse::internal_default_instance());
+}
+
+PluginServerResponse::PluginServerResponse(const PluginServerResponse& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void PluginServerResponse::SharedCtor() {
+  _cached_size_ = 0;
+  error_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+  response_ = NULL;
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+PluginServerResponse::~PluginServerResponse() {
+  SharedDtor();
+}
+
+void PluginServerResponse::SharedDtor() {
+  if (error_ != &::google::protobuf::internal::kEmptyString) {
+    delete error_;
+  }
+  if (this != default_instance_) {
+    delete response_;
+  }
+}
+
+void PluginServerResponse::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* PluginServerResponse::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return PluginServerResponse_descriptor_;
+}
+
+const PluginServerResponse& PluginServerResponse::default_instance() {
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
+}
+
+namespace {
+::google::protobuf::internal::StaticStorage<PluginServerResponse>
+  PluginServerResponse_default_instance_storage_;
+}  // namespace
+PluginServerResponse* PluginServerResponse::default_instance_ =
+  reinterpret_cast<PluginServerResponse*>(&PluginServerResponse_default_instance_storage_);
+
+PluginServerResponse* PluginServerResponse::New() const {
+  return new PluginServerResponse;
+}
+
+void PluginServerResponse::Clear() {
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (has_error()) {
+      if (error_ != &::google::protobuf::internal::kEmptyString) {
+        error_->clear();
+      }
+    }
+    if (has_response()) {
+      if (response_ != NULL) response_->::google::protobuf::compiler::CodeGeneratorResponse::Clear();
+    }
+  }
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool PluginServerResponse::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // optional string error = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadString(
+                input, this->mutable_error()));
+          ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+            this->error().data(), this->error().length(),
+            ::google::protobuf::internal::WireFormat::PARSE);
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(18)) goto parse_response;
+        break;
+      }
+      
+      // optional .google.protobuf.compiler.CodeGeneratorResponse response = 2;
+      case 2: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_response:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+               input, mutable_response()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+      
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void PluginServerResponse::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // optional string error = 1;
+  if (has_error()) {
+    ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+      this->error().data(), this->error().length(),
+      ::google::protobuf::internal::WireFormat::SERIALIZE);
+    ::google::protobuf::internal::WireFormatLite::WriteString(
+      1, this->error(), output);
+  }
+  
+  // optional .google.protobuf.compiler.CodeGeneratorResponse response = 2;
+  if (has_response()) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      2, this->response(), output);
+  }
+  
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* PluginServerResponse::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // optional string error = 1;
+  if (has_error()) {
+    ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+      this->error().data(), this->error().length(),
+      ::google::protobuf::internal::WireFormat::SERIALIZE);
+    target =
+      ::google::protobuf::internal::WireFormatLite::WriteStringToArray(
+        1, this->error(), target);
+  }
+  
+  // optional .google.protobuf.compiler.CodeGeneratorResponse response = 2;
+  if (has_response()) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        2, this->response(), target);
+  }
+  
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int PluginServerResponse::ByteSize() const {
+  int total_size = 0;
+  
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // optional string error = 1;
+    if (has_error()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::StringSize(
+          this->error());
+    }
+    
+    // optional .google.protobuf.compiler.CodeGeneratorResponse response = 2;
+    if (has_response()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+          this->response());
+    }
+    
+  }
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void PluginServerResponse::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const PluginServerResponse* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const PluginServerResponse*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void PluginServerResponse::MergeFrom(const PluginServerResponse& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_error()) {
+      set_error(from.error());
+    }
+    if (from.has_response()) {
+      mutable_response()->::google::protobuf::compiler::CodeGeneratorResponse::MergeFrom(from.response());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void PluginServerResponse::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void PluginServerResponse::CopyFrom(const PluginServerResponse& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool PluginServerResponse::IsInitialized() const {
+  
+  return true;
+}
+
+void PluginServerResponse::Swap(PluginServerResponse* other) {
+  if (other != this) {
+    std::swap(error_, other->error_);
+    std::swap(response_, other->response_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata PluginServerResponse::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = PluginServerResponse_descriptor_;
+  metadata.reflection = PluginServerResponse_reflection_;
+  return metadata;
+}
+
+
 // @@protoc_insertion_point(namespace_scope)
 
 }  // namespace compiler
@@ -32,12 +32,15 @@ namespace compiler {
 
 // Internal implementation detail -- do not call these.
 void LIBPROTOC_EXPORT protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+void protobuf_InitDefaults_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
 void protobuf_AssignDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
 void protobuf_ShutdownFile_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
 
 class CodeGeneratorRequest;
 class CodeGeneratorResponse;
 class CodeGeneratorResponse_File;
+class PluginServerRequest;
+class PluginServerResponse;
 
 // ===================================================================
 
@@ -64,11 +67,20 @@ class LIBPROTOC_EXPORT CodeGeneratorRequest : public ::google::protobuf::Message
   static const ::google::protobuf::Descriptor* descriptor();
   static const CodeGeneratorRequest& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const CodeGeneratorRequest* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(CodeGeneratorRequest* other);
   
   // implements Message ----------------------------------------------
   
   CodeGeneratorRequest* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const CodeGeneratorRequest& from);
@@ -149,6 +161,7 @@ class LIBPROTOC_EXPORT CodeGeneratorRequest : public ::google::protobuf::Message
   ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
   
   friend void LIBPROTOC_EXPORT protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
   
@@ -180,11 +193,20 @@ class LIBPROTOC_EXPORT CodeGeneratorResponse_File : public ::google::protobuf::M
   static const ::google::protobuf::Descriptor* descriptor();
   static const CodeGeneratorResponse_File& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const CodeGeneratorResponse_File* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(CodeGeneratorResponse_File* other);
   
   // implements Message ----------------------------------------------
   
   CodeGeneratorResponse_File* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const CodeGeneratorResponse_File& from);
@@ -263,6 +285,7 @@ class LIBPROTOC_EXPORT CodeGeneratorResponse_File : public ::google::protobuf::M
   ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
   
   friend void LIBPROTOC_EXPORT protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
   
@@ -294,11 +317,20 @@ class LIBPROTOC_EXPORT CodeGeneratorResponse : public ::google::protobuf::Messag
   static const ::google::protobuf::Descriptor* descriptor();
   static const CodeGeneratorResponse& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const CodeGeneratorResponse* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(CodeGeneratorResponse* other);
   
   // implements Message ----------------------------------------------
   
   CodeGeneratorResponse* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const CodeGeneratorResponse& from);
@@ -364,12 +396,237 @@ class LIBPROTOC_EXPORT CodeGeneratorResponse : public ::google::protobuf::Messag
   ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
   
   friend void LIBPROTOC_EXPORT protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
   
   void InitAsDefaultInstance();
   static CodeGeneratorResponse* default_instance_;
 };
+// -------------------------------------------------------------------
+
+class LIBPROTOC_EXPORT PluginServerRequest : public ::google::protobuf::Message {
+ public:
+  PluginServerRequest();
+  virtual ~PluginServerRequest();
+  
+  PluginServerRequest(const PluginServerRequest& from);
+  
+  inline PluginServerRequest& operator=(const PluginServerRequest& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+  
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+  
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const PluginServerRequest& default_instance();
+  
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const PluginServerRequest* internal_default_instance() {
+    return default_instance_;
+  }
+  
+  void Swap(PluginServerRequest* other);
+  
+  // implements Message ----------------------------------------------
+  
+  PluginServerRequest* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const PluginServerRequest& from);
+  void MergeFrom(const PluginServerRequest& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::google::protobuf::Metadata GetMetadata() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // optional string plugin = 1;
+  inline bool has_plugin() const;
+  inline void clear_plugin();
+  static const int kPluginFieldNumber = 1;
+  inline const ::std::string& plugin() const;
+  inline void set_plugin(const ::std::string& value);
+  inline void set_plugin(const char* value);
+  inline void set_plugin(const char* value, size_t size);
+  inline ::std::string* mutable_plugin();
+  inline ::std::string* release_plugin();
+  
+  // optional bool search_path = 2;
+  inline bool has_search_path() const;
+  inline void clear_search_path();
+  static const int kSearchPathFieldNumber = 2;
+  inline bool search_path() const;
+  inline void set_search_path(bool value);
+  
+  // optional .google.protobuf.compiler.CodeGeneratorRequest request = 3;
+  inline bool has_request() const;
+  inline void clear_request();
+  static const int kRequestFieldNumber = 3;
+  inline const ::google::protobuf::compiler::CodeGeneratorRequest& request() const;
+  inline ::google::protobuf::compiler::CodeGeneratorRequest* mutable_request();
+  inline ::google::protobuf::compiler::CodeGeneratorRequest* release_request();
+  
+  // @@protoc_insertion_point(class_scope:google.protobuf.compiler.PluginServerRequest)
+ private:
+  inline void set_has_plugin();
+  inline void clear_has_plugin();
+  inline void set_has_search_path();
+  inline void clear_has_search_path();
+  inline void set_has_request();
+  inline void clear_has_request();
+  
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+  
+  ::std::string* plugin_;
+  ::google::protobuf::compiler::CodeGeneratorRequest* request_;
+  bool search_path_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
+  
+  friend void LIBPROTOC_EXPORT protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+  friend void protobuf_AssignDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+  friend void protobuf_ShutdownFile_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+  
+  void InitAsDefaultInstance();
+  static PluginServerRequest* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class LIBPROTOC_EXPORT PluginServerResponse : public ::google::protobuf::Message {
+ public:
+  PluginServerResponse();
+  virtual ~PluginServerResponse();
+  
+  PluginServerResponse(const PluginServerResponse& from);
+  
+  inline PluginServerResponse& operator=(const PluginServerResponse& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+  
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+  
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const PluginServerResponse& default_instance();
+  
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const PluginServerResponse* internal_default_instance() {
+    return default_instance_;
+  }
+  
+  void Swap(PluginServerResponse* other);
+  
+  // implements Message ----------------------------------------------
+  
+  PluginServerResponse* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const PluginServerResponse& from);
+  void MergeFrom(const PluginServerResponse& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::google::protobuf::Metadata GetMetadata() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // optional string error = 1;
+  inline bool has_error() const;
+  inline void clear_error();
+  static const int kErrorFieldNumber = 1;
+  inline const ::std::string& error() const;
+  inline void set_error(const ::std::string& value);
+  inline void set_error(const char* value);
+  inline void set_error(const char* value, size_t size);
+  inline ::std::string* mutable_error();
+  inline ::std::string* release_error();
+  
+  // optional .google.protobuf.compiler.CodeGeneratorResponse response = 2;
+  inline bool has_response() const;
+  inline void clear_response();
+  static const int kResponseFieldNumber = 2;
+  inline const ::google::protobuf::compiler::CodeGeneratorResponse& response() const;
+  inline ::google::protobuf::compiler::CodeGeneratorResponse* mutable_response();
+  inline ::google::protobuf::compiler::CodeGeneratorResponse* release_response();
+  
+  // @@protoc_insertion_point(class_scope:google.protobuf.compiler.PluginServerResponse)
+ private:
+  inline void set_has_error();
+  inline void clear_has_error();
+  inline void set_has_response();
+  inline void clear_has_response();
+  
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+  
+  ::std::string* error_;
+  ::google::protobuf::compiler::CodeGeneratorResponse* response_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
+  
+  friend void LIBPROTOC_EXPORT protobuf_AddDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+  friend void protobuf_AssignDesc_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+  friend void protobuf_ShutdownFile_google_2fprotobuf_2fcompiler_2fplugin_2eproto();
+  
+  void InitAsDefaultInstance();
+  static PluginServerResponse* default_instance_;
+};
 // ===================================================================
 
 
@@ -443,28 +700,28 @@ inline const ::std::string& CodeGeneratorRequest::parameter() const {
 inline void CodeGeneratorRequest::set_parameter(const ::std::string& value) {
   set_has_parameter();
   if (parameter_ == &::google::protobuf::internal::kEmptyString) {
-    parameter_ = new ::std::string;
+    parameter_ = ::google::protobuf::internal::NewString();
   }
   parameter_->assign(value);
 }
 inline void CodeGeneratorRequest::set_parameter(const char* value) {
   set_has_parameter();
   if (parameter_ == &::google::protobuf::internal::kEmptyString) {
-    parameter_ = new ::std::string;
+    parameter_ = ::google::protobuf::internal::NewString();
   }
   parameter_->assign(value);
 }
 inline void CodeGeneratorRequest::set_parameter(const char* value, size_t size) {
   set_has_parameter();
   if (parameter_ == &::google::protobuf::internal::kEmptyString) {
-    parameter_ = new ::std::string;
+    parameter_ = ::google::protobuf::internal::NewString();
   }
   parameter_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* CodeGeneratorRequest::mutable_parameter() {
   set_has_parameter();
   if (parameter_ == &::google::protobuf::internal::kEmptyString) {
-    parameter_ = new ::std::string;
+    parameter_ = ::google::protobuf::internal::NewString();
   }
   return parameter_;
 }
@@ -530,28 +787,28 @@ inline const ::std::string& CodeGeneratorResponse_File::name() const {
 inline void CodeGeneratorResponse_File::set_name(const ::std::string& value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void CodeGeneratorResponse_File::set_name(const char* value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void CodeGeneratorResponse_File::set_name(const char* value, size_t size) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* CodeGeneratorResponse_File::mutable_name() {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   return name_;
 }
@@ -588,28 +845,28 @@ inline const ::std::string& CodeGeneratorResponse_File::insertion_point() const
 inline void CodeGeneratorResponse_File::set_insertion_point(const ::std::string& value) {
   set_has_insertion_point();
   if (insertion_point_ == &::google::protobuf::internal::kEmptyString) {
-    insertion_point_ = new ::std::string;
+    insertion_point_ = ::google::protobuf::internal::NewString();
   }
   insertion_point_->assign(value);
 }
 inline void CodeGeneratorResponse_File::set_insertion_point(const char* value) {
   set_has_insertion_point();
   if (insertion_point_ == &::google::protobuf::internal::kEmptyString) {
-    insertion_point_ = new ::std::string;
+    insertion_point_ = ::google::protobuf::internal::NewString();
   }
   insertion_point_->assign(value);
 }
 inline void CodeGeneratorResponse_File::set_insertion_point(const char* value, size_t size) {
   set_has_insertion_point();
   if (insertion_point_ == &::google::protobuf::internal::kEmptyString) {
-    insertion_point_ = new ::std::string;
+    insertion_point_ = ::google::protobuf::internal::NewString();
   }
   insertion_point_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* CodeGeneratorResponse_File::mutable_insertion_point() {
   set_has_insertion_point();
   if (insertion_point_ == &::google::protobuf::internal::kEmptyString) {
-    insertion_point_ = new ::std::string;
+    insertion_point_ = ::google::protobuf::internal::NewString();
   }
   return insertion_point_;
 }
@@ -646,28 +903,28 @@ inline const ::std::string& CodeGeneratorResponse_File::content() const {
 inline void CodeGeneratorResponse_File::set_content(const ::std::string& value) {
   set_has_content();
   if (content_ == &::google::protobuf::internal::kEmptyString) {
-    content_ = new ::std::string;
+    content_ = ::google::protobuf::internal::NewString();
   }
   content_->assign(value);
 }
 inline void CodeGeneratorResponse_File::set_content(const char* value) {
   set_has_content();
   if (content_ == &::google::protobuf::internal::kEmptyString) {
-    content_ = new ::std::string;
+    content_ = ::google::protobuf::internal::NewString();
   }
   content_->assign(value);
 }
 inline void CodeGeneratorResponse_File::set_content(const char* value, size_t size) {
   set_has_content();
   if (content_ == &::google::protobuf::internal::kEmptyString) {
-    content_ = new ::std::string;
+    content_ = ::google::protobuf::internal::NewString();
   }
   content_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* CodeGeneratorResponse_File::mutable_content() {
   set_has_content();
   if (content_ == &::google::protobuf::internal::kEmptyString) {
-    content_ = new ::std::string;
+    content_ = ::google::protobuf::internal::NewString();
   }
   return content_;
 }
@@ -708,28 +965,28 @@ inline const ::std::string& CodeGeneratorResponse::error() const {
 inline void CodeGeneratorResponse::set_error(const ::std::string& value) {
   set_has_error();
   if (error_ == &::google::protobuf::internal::kEmptyString) {
-    error_ = new ::std::string;
+    error_ = ::google::protobuf::internal::NewString();
   }
   error_->assign(value);
 }
 inline void CodeGeneratorResponse::set_error(const char* value) {
   set_has_error();
   if (error_ == &::google::protobuf::internal::kEmptyString) {
-    error_ = new ::std::string;
+    error_ = ::google::protobuf::internal::NewString();
   }
   error_->assign(value);
 }
 inline void CodeGeneratorResponse::set_error(const char* value, size_t size) {
   set_has_error();
   if (error_ == &::google::protobuf::internal::kEmptyString) {
-    error_ = new ::std::string;
+    error_ = ::google::protobuf::internal::NewString();
   }
   error_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* CodeGeneratorResponse::mutable_error() {
   set_has_error();
   if (error_ == &::google::protobuf::internal::kEmptyString) {
-    error_ = new ::std::string;
+    error_ = ::google::protobuf::internal::NewString();
   }
   return error_;
 }
@@ -769,6 +1026,210 @@ CodeGeneratorResponse::mutable_file() {
   return &file_;
 }
 
+// -------------------------------------------------------------------
+
+// PluginServerRequest
+
+// optional string plugin = 1;
+inline bool PluginServerRequest::has_plugin() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void PluginServerRequest::set_has_plugin() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void PluginServerRequest::clear_has_plugin() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void PluginServerRequest::clear_plugin() {
+  if (plugin_ != &::google::protobuf::internal::kEmptyString) {
+    plugin_->clear();
+  }
+  clear_has_plugin();
+}
+inline const ::std::string& PluginServerRequest::plugin() const {
+  return *plugin_;
+}
+inline void PluginServerRequest::set_plugin(const ::std::string& value) {
+  set_has_plugin();
+  if (plugin_ == &::google::protobuf::internal::kEmptyString) {
+    plugin_ = ::google::protobuf::internal::NewString();
+  }
+  plugin_->assign(value);
+}
+inline void PluginServerRequest::set_plugin(const char* value) {
+  set_has_plugin();
+  if (plugin_ == &::google::protobuf::internal::kEmptyString) {
+    plugin_ = ::google::protobuf::internal::NewString();
+  }
+  plugin_->assign(value);
+}
+inline void PluginServerRequest::set_plugin(const char* value, size_t size) {
+  set_has_plugin();
+  if (plugin_ == &::google::protobuf::internal::kEmptyString) {
+    plugin_ = ::google::protobuf::internal::NewString();
+  }
+  plugin_->assign(reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* PluginServerRequest::mutable_plugin() {
+  set_has_plugin();
+  if (plugin_ == &::google::protobuf::internal::kEmptyString) {
+    plugin_ = ::google::protobuf::internal::NewString();
+  }
+  return plugin_;
+}
+inline ::std::string* PluginServerRequest::release_plugin() {
+  clear_has_plugin();
+  if (plugin_ == &::google::protobuf::internal::kEmptyString) {
+    return NULL;
+  } else {
+    ::std::string* temp = plugin_;
+    plugin_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+    return temp;
+  }
+}
+
+// optional bool search_path = 2;
+inline bool PluginServerRequest::has_search_path() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void PluginServerRequest::set_has_search_path() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void PluginServerRequest::clear_has_search_path() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void PluginServerRequest::clear_search_path() {
+  search_path_ = false;
+  clear_has_search_path();
+}
+inline bool PluginServerRequest::search_path() const {
+  return search_path_;
+}
+inline void PluginServerRequest::set_search_path(bool value) {
+  set_has_search_path();
+  search_path_ = value;
+}
+
+// optional .google.protobuf.compiler.CodeGeneratorRequest request = 3;
+inline bool PluginServerRequest::has_request() const {
+  return (_has_bits_[0] & 0x00000004u) != 0;
+}
+inline void PluginServerRequest::set_has_request() {
+  _has_bits_[0] |= 0x00000004u;
+}
+inline void PluginServerRequest::clear_has_request() {
+  _has_bits_[0] &= ~0x00000004u;
+}
+inline void PluginServerRequest::clear_request() {
+  if (request_ != NULL) request_->::google::protobuf::compiler::CodeGeneratorRequest::Clear();
+  clear_has_request();
+}
+inline const ::google::protobuf::compiler::CodeGeneratorRequest& PluginServerRequest::request() const {
+  return request_ != NULL ? *request_ : ::google::protobuf::compiler::CodeGeneratorRequest::default_instance();
+}
+inline ::google::protobuf::compiler::CodeGeneratorRequest* PluginServerRequest::mutable_request() {
+  set_has_request();
+  if (request_ == NULL) request_ = new ::google::protobuf::compiler::CodeGeneratorRequest;
+  return request_;
+}
+inline ::google::protobuf::compiler::CodeGeneratorRequest* PluginServerRequest::release_request() {
+  clear_has_request();
+  ::google::protobuf::compiler::CodeGeneratorRequest* temp = request_;
+  request_ = NULL;
+  return temp;
+}
+
+// -------------------------------------------------------------------
+
+// PluginServerResponse
+
+// optional string error = 1;
+inline bool PluginServerResponse::has_error() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void PluginServerResponse::set_has_error() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void PluginServerResponse::clear_has_error() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void PluginServerResponse::clear_error() {
+  if (error_ != &::google::protobuf::internal::kEmptyString) {
+    error_->clear();
+  }
+  clear_has_error();
+}
+inline const ::std::string& PluginServerResponse::error() const {
+  return *error_;
+}
+inline void PluginServerResponse::set_error(const ::std::string& value) {
+  set_has_error();
+  if (error_ == &::google::protobuf::internal::kEmptyString) {
+    error_ = ::google::protobuf::internal::NewString();
+  }
+  error_->assign(value);
+}
+inline void PluginServerResponse::set_error(const char* value) {
+  set_has_error();
+  if (error_ == &::google::protobuf::internal::kEmptyString) {
+    error_ = ::google::protobuf::internal::NewString();
+  }
+  error_->assign(value);
+}
+inline void PluginServerResponse::set_error(const char* value, size_t size) {
+  set_has_error();
+  if (error_ == &::google::protobuf::internal::kEmptyString) {
+    error_ = ::google::protobuf::internal::NewString();
+  }
+  error_->assign(reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* PluginServerResponse::mutable_error() {
+  set_has_error();
+  if (error_ == &::google::protobuf::internal::kEmptyString) {
+    error_ = ::google::protobuf::internal::NewString();
+  }
+  return error_;
+}
+inline ::std::string* PluginServerResponse::release_error() {
+  clear_has_error();
+  if (error_ == &::google::protobuf::internal::kEmptyString) {
+    return NULL;
+  } else {
+    ::std::string* temp = error_;
+    error_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+    return temp;
+  }
+}
+
+// optional .google.protobuf.compiler.CodeGeneratorResponse response = 2;
+inline bool PluginServerResponse::has_response() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void PluginServerResponse::set_has_response() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void PluginServerResponse::clear_has_response() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void PluginServerResponse::clear_response() {
+  if (response_ != NULL) response_->::google::protobuf::compiler::CodeGeneratorResponse::Clear();
+  clear_has_response();
+}
+inline const ::google::protobuf::compiler::CodeGeneratorResponse& PluginServerResponse::response() const {
+  return response_ != NULL ? *response_ : ::google::protobuf::compiler::CodeGeneratorResponse::default_instance();
+}
+inline ::google::protobuf::compiler::CodeGeneratorResponse* PluginServerResponse::mutable_response() {
+  set_has_response();
+  if (response_ == NULL) response_ = new ::google::protobuf::compiler::CodeGeneratorResponse;
+  return response_;
+}
+inline ::google::protobuf::compiler::CodeGeneratorResponse* PluginServerResponse::release_response() {
+  clear_has_response();
+  ::google::protobuf::compiler::CodeGeneratorResponse* temp = response_;
+  response_ = NULL;
+  return temp;
+}
+
 
 // @@protoc_insertion_point(namespace_scope)
 
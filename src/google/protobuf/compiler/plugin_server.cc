@@ -0,0 +1,442 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/compiler/plugin_server.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <google/protobuf/compiler/plugin.pb.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+
+#ifdef _WIN32
+
+PluginServer::PluginServer() {}
+PluginServer::~PluginServer() {}
+
+bool PluginServer::Listen(const std::string& socket_path, std::string* error) {
+  *error = "Plugin servers are not supported on Windows.";
+  return false;
+}
+
+void PluginServer::AllowPlugin(const std::string& path) {}
+void PluginServer::SetPluginTimeout(int milliseconds) {}
+
+void PluginServer::Serve(int num_threads) {}
+void PluginServer::Shutdown() {}
+int PluginServer::processes_started() { return 0; }
+
+bool PluginServer::RunPlugin(const std::string& socket_path,
+                             const std::string& program,
+                             Subprocess::SearchMode search_mode,
+                             const CodeGeneratorRequest& request,
+                             CodeGeneratorResponse* response) {
+  // No server can be reached; run the plugin directly.
+  return false;
+}
+
+#else  // _WIN32
+
+namespace {
+
+// How long a client may take to send its request before the server gives
+// up on it, so that a stuck client cannot tie up a serving thread.
+const int kClientTimeoutSeconds = 10;
+
+// How long a plugin may take to answer, unless SetPluginTimeout() says
+// otherwise.  A plugin which is merely slow still works, since the client
+// runs it itself once the server gives up on it.
+const int kDefaultPluginTimeoutMs = 60 * 1000;
+
+// Reads from fd until the end of file.
+bool ReadToEnd(int fd, std::string* data) {
+  char buffer[4096];
+  while (true) {
+    int n = read(fd, buffer, sizeof(buffer));
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (n == 0) return true;
+    data->append(buffer, n);
+  }
+}
+
+bool WriteFully(int fd, const std::string& data) {
+  const char* pos = data.data();
+  int size = data.size();
+  while (size > 0) {
+    int n = write(fd, pos, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    pos += n;
+    size -= n;
+  }
+  return true;
+}
+
+// Fills in *address for the socket at path.  Returns false if the path is
+// too long.
+bool MakeAddress(const std::string& path, sockaddr_un* address) {
+  if (path.size() >= sizeof(address->sun_path)) return false;
+  memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  memcpy(address->sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+// Returns path made absolute relative to the current directory, or an empty
+// string if the current directory cannot be found.
+std::string MakeAbsolute(const std::string& path) {
+  if (!path.empty() && path[0] == '/') return path;
+  char cwd[4096];
+  if (getcwd(cwd, sizeof(cwd)) == NULL) return "";
+  return std::string(cwd) + "/" + path;
+}
+
+// Returns a socket connected to the server at path, or -1.
+int Connect(const std::string& path) {
+  sockaddr_un address;
+  if (!MakeAddress(path, &address)) return -1;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  while (connect(fd, reinterpret_cast<sockaddr*>(&address),
+                 sizeof(address)) < 0) {
+    if (errno != EINTR) {
+      close(fd);
+      return -1;
+    }
+  }
+  return fd;
+}
+
+struct ThreadStart {
+  void (*function)(void*);
+  void* arg;
+};
+
+void* ThreadMain(void* start) {
+  ThreadStart* thread_start = reinterpret_cast<ThreadStart*>(start);
+  thread_start->function(thread_start->arg);
+  return NULL;
+}
+
+}  // namespace
+
+PluginServer::PluginServer()
+    : listen_fd_(-1), plugin_timeout_ms_(kDefaultPluginTimeoutMs),
+      processes_started_(0) {
+  shutdown_pipe_[0] = -1;
+  shutdown_pipe_[1] = -1;
+}
+
+PluginServer::~PluginServer() {
+  if (listen_fd_ != -1) {
+    close(listen_fd_);
+    unlink(socket_path_.c_str());
+  }
+  if (shutdown_pipe_[0] != -1) {
+    close(shutdown_pipe_[0]);
+    close(shutdown_pipe_[1]);
+  }
+  // Deleting a Subprocess closes its stdin and waits for it to exit.
+  for (ProcessMap::iterator iter = idle_processes_.begin();
+       iter != idle_processes_.end(); ++iter) {
+    STLDeleteElements(&iter->second);
+  }
+}
+
+bool PluginServer::Listen(const std::string& socket_path, std::string* error) {
+  GOOGLE_CHECK_EQ(listen_fd_, -1) << "Listen() may only be called once.";
+
+  sockaddr_un address;
+  if (!MakeAddress(socket_path, &address)) {
+    *error = socket_path + ": Socket path is too long.";
+    return false;
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    *error = std::string("socket: ") + strerror(errno);
+    return false;
+  }
+  fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+  // The server runs plugins as whoever started it, so only that user may
+  // connect.  The socket is created with mode 0600 from the start rather
+  // than chmod()ed afterwards, which would leave a window open.
+  mode_t old_umask = umask(0177);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 &&
+      errno == EADDRINUSE) {
+    // Replace the socket unless a server is still listening on it.
+    int other_server = Connect(socket_path);
+    if (other_server != -1) {
+      umask(old_umask);
+      close(other_server);
+      close(fd);
+      *error = socket_path + ": Another plugin server is listening there.";
+      return false;
+    }
+    unlink(socket_path.c_str());
+    bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+  }
+  umask(old_umask);
+  // Any failure to bind shows up here.
+  if (listen(fd, SOMAXCONN) < 0) {
+    *error = socket_path + ": " + strerror(errno);
+    close(fd);
+    return false;
+  }
+
+  // Several threads wait for connections; those that lose the race to
+  // accept one must not block.
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+  if (pipe(shutdown_pipe_) < 0) {
+    *error = std::string("pipe: ") + strerror(errno);
+    close(fd);
+    return false;
+  }
+  fcntl(shutdown_pipe_[0], F_SETFD, FD_CLOEXEC);
+  fcntl(shutdown_pipe_[1], F_SETFD, FD_CLOEXEC);
+
+  socket_path_ = socket_path;
+  listen_fd_ = fd;
+  return true;
+}
+
+void PluginServer::AllowPlugin(const std::string& path) {
+  allowed_plugins_.insert(MakeAbsolute(path));
+}
+
+void PluginServer::SetPluginTimeout(int milliseconds) {
+  plugin_timeout_ms_ = milliseconds;
+}
+
+void PluginServer::Serve(int num_threads) {
+  GOOGLE_CHECK_NE(listen_fd_, -1) << "Must call Listen() first.";
+
+  // A plugin or client which goes away must not kill the server.
+  signal(SIGPIPE, SIG_IGN);
+
+  ThreadStart start = { &ServeConnections, this };
+  std::vector<pthread_t> threads;
+  for (int i = 1; i < num_threads; i++) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, &ThreadMain, &start) != 0) break;
+    threads.push_back(thread);
+  }
+  ServeConnections(this);
+  for (int i = 0; i < threads.size(); i++) {
+    pthread_join(threads[i], NULL);
+  }
+}
+
+void PluginServer::Shutdown() {
+  // The byte is never read, so the pipe stays readable for every thread.
+  char byte = 0;
+  while (write(shutdown_pipe_[1], &byte, 1) < 0 && errno == EINTR) {}
+}
+
+int PluginServer::processes_started() {
+  MutexLock lock(&mutex_);
+  return processes_started_;
+}
+
+void PluginServer::ServeConnections(void* server_ptr) {
+  PluginServer* server = reinterpret_cast<PluginServer*>(server_ptr);
+  while (true) {
+    pollfd fds[2];
+    fds[0].fd = server->listen_fd_;
+    fds[0].events = POLLIN;
+    fds[1].fd = server->shutdown_pipe_[0];
+    fds[1].events = POLLIN;
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      GOOGLE_LOG(FATAL) << "poll: " << strerror(errno);
+    }
+    if (fds[1].revents != 0) return;
+
+    int connection;
+    {
+      MutexLock lock(&server->fork_mutex_);
+      connection = accept(server->listen_fd_, NULL, NULL);
+      if (connection != -1) {
+        fcntl(connection, F_SETFD, FD_CLOEXEC);
+      }
+    }
+    if (connection == -1) {
+      // Most likely another thread took the connection.
+      continue;
+    }
+    // Some systems pass O_NONBLOCK on from the listening socket.
+    fcntl(connection, F_SETFL, fcntl(connection, F_GETFL) & ~O_NONBLOCK);
+
+    server->HandleConnection(connection);
+    close(connection);
+  }
+}
+
+void PluginServer::HandleConnection(int connection) {
+  timeval timeout;
+  timeout.tv_sec = kClientTimeoutSeconds;
+  timeout.tv_usec = 0;
+  setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  std::string data;
+  PluginServerRequest request;
+  PluginServerResponse response;
+  if (!ReadToEnd(connection, &data) || !request.ParseFromString(data)) {
+    response.set_error("Plugin server received an unparseable request.");
+  } else if (request.search_path() ||
+             allowed_plugins_.count(request.plugin()) == 0) {
+    response.set_error(request.plugin() + ": Not served by this server.");
+  } else {
+    std::string error;
+    if (!RunOnPool(request.plugin(), request.request(),
+                   response.mutable_response(), &error)) {
+      response.Clear();
+      response.set_error(error);
+    }
+  }
+  // If the client has gone away there is no one to tell.
+  WriteFully(connection, response.SerializeAsString());
+}
+
+bool PluginServer::RunOnPool(const std::string& program,
+                             const CodeGeneratorRequest& request,
+                             CodeGeneratorResponse* response,
+                             std::string* error) {
+  // Try an idle process first.  It may have exited since it was last used,
+  // or hang, in which case we start a new one and try again.
+  Subprocess* process = NULL;
+  {
+    MutexLock lock(&mutex_);
+    std::vector<Subprocess*>& idle = idle_processes_[program];
+    if (!idle.empty()) {
+      process = idle.back();
+      idle.pop_back();
+    }
+  }
+  if (process != NULL) {
+    if (process->Exchange(request, response, plugin_timeout_ms_, error)) {
+      MutexLock lock(&mutex_);
+      idle_processes_[program].push_back(process);
+      return true;
+    }
+    delete process;
+    response->Clear();
+  }
+
+  process = new Subprocess;
+  {
+    MutexLock lock(&fork_mutex_);
+    process->StartPersistent(program, Subprocess::EXACT_NAME);
+  }
+  {
+    MutexLock lock(&mutex_);
+    ++processes_started_;
+  }
+  if (!process->Exchange(request, response, plugin_timeout_ms_, error)) {
+    delete process;
+    return false;
+  }
+  MutexLock lock(&mutex_);
+  idle_processes_[program].push_back(process);
+  return true;
+}
+
+bool PluginServer::RunPlugin(const std::string& socket_path,
+                             const std::string& program,
+                             Subprocess::SearchMode search_mode,
+                             const CodeGeneratorRequest& request,
+                             CodeGeneratorResponse* response) {
+  // Servers only run plugins they were given by path.
+  if (search_mode == Subprocess::SEARCH_PATH) return false;
+
+  PluginServerRequest server_request;
+  // Relative to our working directory, not the server's.
+  server_request.set_plugin(MakeAbsolute(program));
+  if (server_request.plugin().empty()) return false;
+  *server_request.mutable_request() = request;
+
+  int connection = Connect(socket_path);
+  if (connection == -1) return false;
+
+  // The "sighandler_t" typedef is GNU-specific, so define our own.
+  typedef void SignalHandler(int);
+
+  // Make sure SIGPIPE is disabled so that if the server goes away it
+  // doesn't kill us.
+  SignalHandler* old_pipe_handler = signal(SIGPIPE, SIG_IGN);
+
+  std::string data;
+  bool success = WriteFully(connection, server_request.SerializeAsString()) &&
+                 shutdown(connection, SHUT_WR) == 0 &&
+                 ReadToEnd(connection, &data);
+  close(connection);
+  signal(SIGPIPE, old_pipe_handler);
+
+  // Whatever went wrong, the plugin may still run outside the server, e.g.
+  // if it does not support the persistent protocol.  If the plugin itself
+  // is at fault, running it directly reports the failure.
+  PluginServerResponse server_response;
+  if (!success || !server_response.ParseFromString(data) ||
+      server_response.has_error() || !server_response.has_response()) {
+    return false;
+  }
+  response->Swap(server_response.mutable_response());
+  return true;
+}
+
+#endif  // !_WIN32
+
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
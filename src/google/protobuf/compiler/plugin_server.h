@@ -0,0 +1,159 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Keeps protoc plugins running from one invocation of protoc to the next.
+//
+// Starting a plugin can cost more than running it, e.g. for one written in
+// Java or Python.  A plugin server, started with
+//   protoc --serve_plugins=SOCKET --plugin=PATH... -jN
+// listens on the Unix domain socket SOCKET and runs the requests protoc
+// sends it when given --plugin_server=SOCKET.  Each plugin is started as a
+// persistent plugin (see plugin.proto) and is kept running once it has
+// answered, ready for the next request for the same plugin.  At most N
+// requests run at once, so at most N processes are kept for each plugin.
+//
+// Only the plugins given to the server with --plugin are served, and these
+// must implement the persistent protocol.  protoc runs any other plugin
+// itself, as it does when the server cannot run a plugin at all.  That
+// includes a plugin which takes too long to answer:  the server kills it,
+// and starts a new process for the next request.  The socket is only
+// accessible to the user running the server.
+//
+// Plugins run by a server write any messages on stderr to the server's
+// stderr, not to that of protoc.
+
+#ifndef GOOGLE_PROTOBUF_COMPILER_PLUGIN_SERVER_H__
+#define GOOGLE_PROTOBUF_COMPILER_PLUGIN_SERVER_H__
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/compiler/subprocess.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+
+class CodeGeneratorRequest;    // plugin.pb.h
+class CodeGeneratorResponse;   // plugin.pb.h
+
+class LIBPROTOC_EXPORT PluginServer {
+ public:
+  PluginServer();
+  // Ends the plugins kept running and removes the socket.
+  ~PluginServer();
+
+  // Starts listening on the Unix domain socket socket_path.  A socket left
+  // there by a server which has gone away is replaced.  Returns false and
+  // sets *error if the socket cannot be created, or if another server is
+  // listening on it.  Not supported on Windows.
+  bool Listen(const std::string& socket_path, std::string* error);
+
+  // Lets clients run the plugin executable at path, which is taken
+  // relative to the current directory unless it is absolute.  Requests for
+  // any other plugin are refused.  Call before Serve().
+  void AllowPlugin(const std::string& path);
+
+  // Kills a plugin which takes longer than milliseconds to answer a request
+  // (by default, a minute); the client then runs the plugin itself.  Call
+  // before Serve().
+  void SetPluginTimeout(int milliseconds);
+
+  // Serves connections on num_threads threads, one of them the calling
+  // thread, until Shutdown() is called.
+  void Serve(int num_threads);
+
+  // Makes Serve() return once the requests in progress are done.  May be
+  // called from any thread.
+  void Shutdown();
+
+  // Returns how many plugin processes have been started so far.
+  int processes_started();
+
+  // Runs a plugin through the server listening on socket_path.  Returns
+  // true and fills in *response if the plugin ran.  Returns false if no
+  // server could be reached, or if the server refused the plugin or could
+  // not run it; the caller should then run the plugin itself.
+  static bool RunPlugin(const std::string& socket_path,
+                        const std::string& program,
+                        Subprocess::SearchMode search_mode,
+                        const CodeGeneratorRequest& request,
+                        CodeGeneratorResponse* response);
+
+ private:
+  // Thread body for Serve().  server is a PluginServer.
+  static void ServeConnections(void* server);
+
+  // Answers one client connection.
+  void HandleConnection(int connection);
+
+  // Runs request on an idle process for the given plugin, or on a new one,
+  // and keeps the process for later if it is still usable.
+  bool RunOnPool(const std::string& program,
+                 const CodeGeneratorRequest& request,
+                 CodeGeneratorResponse* response,
+                 std::string* error);
+
+#ifndef _WIN32
+  std::string socket_path_;
+  int listen_fd_;
+
+  // Written to by Shutdown().  Every serving thread waits for it to become
+  // readable as well as for connections.
+  int shutdown_pipe_[2];
+
+  // Absolute paths of the plugins clients may run.  Not changed once
+  // serving has started.
+  std::set<std::string> allowed_plugins_;
+  int plugin_timeout_ms_;
+
+  // Held while accepting a connection or starting a plugin, so that no file
+  // descriptor is inherited by a plugin before it is marked close-on-exec.
+  Mutex fork_mutex_;
+
+  // Guards the members below.
+  Mutex mutex_;
+
+  // Processes waiting for a request, by program.
+  typedef std::map<std::string, std::vector<Subprocess*> > ProcessMap;
+  ProcessMap idle_processes_;
+  int processes_started_;
+#endif  // !_WIN32
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(PluginServer);
+};
+
+}  // namespace compiler
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_COMPILER_PLUGIN_SERVER_H__
@@ -36,13 +36,17 @@
 
 #ifndef _WIN32
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <sys/select.h>
+#include <sys/time.h>
 #include <sys/wait.h>
 #include <signal.h>
 #endif
 
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/message.h>
+#include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/stubs/substitute.h>
 
 namespace google {
@@ -284,11 +288,28 @@ Subprocess::~Subprocess() {
   if (child_stdout_ != -1) {
     close(child_stdout_);
   }
+  if (child_pid_ != -1) {
+    std::string error;
+    WaitForExit(&error);
+  }
 }
 
 void Subprocess::Start(const std::string& program, SearchMode search_mode) {
-  // Note that we assume that there are no other threads, thus we don't have to
-  // do crazy stuff like using socket pairs or avoiding libc locks.
+  Launch(program, search_mode, NULL);
+}
+
+void Subprocess::StartPersistent(const std::string& program,
+                                 SearchMode search_mode) {
+  Launch(program, search_mode, "--persistent");
+  // So that Exchange() can give up on writing to a plugin which does not
+  // read.
+  fcntl(child_stdin_, F_SETFL, fcntl(child_stdin_, F_GETFL) | O_NONBLOCK);
+}
+
+void Subprocess::Launch(const std::string& program, SearchMode search_mode,
+                        const char* argument) {
+  // Note that we assume that no other thread forks while we do, thus we don't
+  // have to do crazy stuff like using socket pairs or avoiding libc locks.
 
   // [0] is read end, [1] is write end.
   int stdin_pipe[2];
@@ -297,7 +318,13 @@ void Subprocess::Start(const std::string& program, SearchMode search_mode) {
   pipe(stdin_pipe);
   pipe(stdout_pipe);
 
-  char* argv[2] = { strdup(program.c_str()), NULL };
+  // Our ends of the pipes must not leak into other children, or a
+  // persistent plugin would never see the end of its input.
+  fcntl(stdin_pipe[1], F_SETFD, FD_CLOEXEC);
+  fcntl(stdout_pipe[0], F_SETFD, FD_CLOEXEC);
+
+  char* argv[3] = { strdup(program.c_str()),
+                    argument == NULL ? NULL : strdup(argument), NULL };
 
   child_pid_ = fork();
   if (child_pid_ == -1) {
@@ -332,6 +359,7 @@ void Subprocess::Start(const std::string& program, SearchMode search_mode) {
     _exit(1);
   } else {
     free(argv[0]);
+    free(argv[1]);
 
     close(stdin_pipe[0]);
     close(stdout_pipe[1]);
@@ -418,15 +446,31 @@ bool Subprocess::Communicate(const Message& input, Message* output,
     child_stdin_ = -1;
   }
 
+  bool exited_normally = WaitForExit(error);
+
+  // Restore SIGPIPE handling.
+  signal(SIGPIPE, old_pipe_handler);
+
+  if (!exited_normally) {
+    return false;
+  }
+
+  if (!output->ParseFromString(output_data)) {
+    *error = "Plugin output is unparseable.";
+    return false;
+  }
+
+  return true;
+}
+
+bool Subprocess::WaitForExit(std::string* error) {
   int status;
   while (waitpid(child_pid_, &status, 0) == -1) {
     if (errno != EINTR) {
       GOOGLE_LOG(FATAL) << "waitpid: " << strerror(errno);
     }
   }
-
-  // Restore SIGPIPE handling.
-  signal(SIGPIPE, old_pipe_handler);
+  child_pid_ = -1;
 
   if (WIFEXITED(status)) {
     if (WEXITSTATUS(status) != 0) {
@@ -445,6 +489,139 @@ bool Subprocess::Communicate(const Message& input, Message* output,
     return false;
   }
 
+  return true;
+}
+
+static const int kMaxVarint32Bytes = 5;
+
+// Like the default total bytes limit of io::CodedInputStream.
+static const uint32 kMaxReplySize = 64 << 20;
+
+// Returns the current time in milliseconds, for deadlines.
+static int64 NowMs() {
+  timeval now;
+  gettimeofday(&now, NULL);
+  return static_cast<int64>(now.tv_sec) * 1000 + now.tv_usec / 1000;
+}
+
+// Returns true if deadline (a NowMs() time, or -1 for none) has passed.
+static bool Expired(int64 deadline) {
+  return deadline != -1 && NowMs() >= deadline;
+}
+
+// Waits until fd is ready for events, or returns false once deadline has
+// passed.  Errors are left for the following read or write to report.
+static bool WaitUntilReady(int fd, short events, int64 deadline) {
+  while (true) {
+    int timeout_ms = -1;
+    if (deadline != -1) {
+      int64 left = deadline - NowMs();
+      if (left <= 0) return false;
+      timeout_ms = static_cast<int>(left);
+    }
+    pollfd poll_fd;
+    poll_fd.fd = fd;
+    poll_fd.events = events;
+    poll_fd.revents = 0;
+    int ready = poll(&poll_fd, 1, timeout_ms);
+    if (ready > 0 || (ready < 0 && errno != EINTR)) return true;
+  }
+}
+
+// Writes all of data to fd, which must be non-blocking.  Returns false if
+// that fails, e.g. because the reader has gone away, or if deadline passes.
+static bool WriteFully(int fd, const char* data, int size, int64 deadline) {
+  while (size > 0) {
+    int n = write(fd, data, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN && WaitUntilReady(fd, POLLOUT, deadline)) continue;
+      return false;
+    }
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+// Reads exactly size bytes from fd.  Returns false on error or end of file,
+// or if deadline passes.
+static bool ReadFully(int fd, char* data, int size, int64 deadline) {
+  while (size > 0) {
+    if (!WaitUntilReady(fd, POLLIN, deadline)) return false;
+    int n = read(fd, data, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (n == 0) return false;
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+// Reads a varint one byte at a time, so as not to read past it.
+static bool ReadVarint32(int fd, uint32* value, int64 deadline) {
+  *value = 0;
+  for (int i = 0; i < kMaxVarint32Bytes; i++) {
+    uint8 byte;
+    if (!ReadFully(fd, reinterpret_cast<char*>(&byte), 1, deadline)) {
+      return false;
+    }
+    *value |= static_cast<uint32>(byte & 0x7F) << (7 * i);
+    if ((byte & 0x80) == 0) return true;
+  }
+  return false;
+}
+
+bool Subprocess::Exchange(const Message& input, Message* output,
+                          int timeout_ms, std::string* error) {
+  GOOGLE_CHECK_NE(child_stdin_, -1) << "Must call StartPersistent() first.";
+
+  uint8 size_bytes[kMaxVarint32Bytes];
+  uint8* size_end =
+      io::CodedOutputStream::WriteVarint32ToArray(input.ByteSize(), size_bytes);
+  std::string input_data(reinterpret_cast<char*>(size_bytes),
+                         size_end - size_bytes);
+  input.AppendToString(&input_data);
+
+  int64 deadline = timeout_ms < 0 ? -1 : NowMs() + timeout_ms;
+
+  // If the child has exited, writing fails and reading sees the end of its
+  // output, so a failed write only matters if it ran out of time.
+  uint32 size;
+  std::string output_data;
+  bool replied =
+      (WriteFully(child_stdin_, input_data.data(), input_data.size(),
+                  deadline) || !Expired(deadline)) &&
+      ReadVarint32(child_stdout_, &size, deadline);
+  if (replied && size > kMaxReplySize) {
+    *error = "Plugin output is unparseable.";
+    return false;
+  }
+  if (replied && size > 0) {
+    output_data.resize(size);
+    replied = ReadFully(child_stdout_, &output_data[0], size, deadline);
+  }
+
+  if (!replied) {
+    bool timed_out = Expired(deadline);
+    if (timed_out) kill(child_pid_, SIGKILL);
+    close(child_stdin_);
+    child_stdin_ = -1;
+    close(child_stdout_);
+    child_stdout_ = -1;
+    if (WaitForExit(error)) {
+      *error = "Plugin exited without replying.";
+    }
+    if (timed_out) {
+      *error = strings::Substitute("Plugin did not reply within $0 ms.",
+                                   timeout_ms);
+    }
+    return false;
+  }
+
   if (!output->ParseFromString(output_data)) {
     *error = "Plugin output is unparseable.";
     return false;
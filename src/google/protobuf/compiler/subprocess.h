@@ -74,6 +74,24 @@ class LIBPROTOC_EXPORT Subprocess {
   // *error to a description of the problem.
   bool Communicate(const Message& input, Message* output, std::string* error);
 
+#ifndef _WIN32
+  // Like Start(), but passes the program the argument "--persistent", which
+  // asks a plugin to answer any number of requests (see plugin.proto).  Use
+  // Exchange() rather than Communicate() with it.  The destructor closes the
+  // plugin's stdin, which tells it to exit, and waits for it.
+  void StartPersistent(const std::string& program, SearchMode search_mode);
+
+  // Writes input to a subprocess started with StartPersistent() and reads
+  // its reply into *output, each preceded by its size as a varint.  The
+  // pipes stay open for the next call.  If the subprocess has not replied
+  // timeout_ms milliseconds after the call (-1 for no limit), it is killed.
+  // On any sort of error, returns false and sets *error to a description of
+  // the problem; the subprocess should not be used after that.  SIGPIPE
+  // must be ignored by the caller.
+  bool Exchange(const Message& input, Message* output, int timeout_ms,
+                std::string* error);
+#endif
+
 #ifdef _WIN32
   // Given an error code, returns a human-readable error message.  This is
   // defined here so that CommandLineInterface can share it.
@@ -91,6 +109,14 @@ class LIBPROTOC_EXPORT Subprocess {
   HANDLE child_stdout_;
 
 #else  // _WIN32
+  // Starts program with the given argument, if not NULL.
+  void Launch(const std::string& program, SearchMode search_mode,
+              const char* argument);
+
+  // Waits for the child to exit.  Returns false and sets *error if it did
+  // not exit with status code zero.
+  bool WaitForExit(std::string* error);
+
   pid_t child_pid_;
 
   // The file descriptors for our end of the child's pipes.  We close each and
@@ -155,69 +155,49 @@ std::string ToCamelCase(const std::string& input) {
   return result;
 }
 
-// A DescriptorPool contains a bunch of hash_maps to implement the
+// A DescriptorPool contains a bunch of hash tables to implement the
 // various Find*By*() methods.  Since hashtable lookups are O(1), it's
-// most efficient to construct a fixed set of large hash_maps used by
+// most efficient to construct a fixed set of large tables used by
 // all objects in the pool rather than construct one or more small
-// hash_maps for each object.
+// tables for each object.
 //
-// The keys to these hash_maps are (parent, name) or (parent, number)
-// pairs.  Unfortunately STL doesn't provide hash functions for pair<>,
-// so we must invent our own.
+// The keys to these tables are names, (parent, name) pairs or
+// (parent, number) pairs.  The tables are FlatHashTables (see below) rather
+// than hash_maps:  a pool loaded with thousands of files holds millions of
+// entries, and a hash_map spends a separately-allocated node and a bucket
+// pointer on every one of them.
 //
 // TODO(kenton):  Use StringPiece rather than const char* in keys?  It would
 //   be a lot cleaner but we'd just have to convert it back to const char*
 //   for the open source release.
 
 typedef std::pair<const void*, const char*> PointerStringPair;
-
-struct PointerStringPairEqual {
-  inline bool operator()(const PointerStringPair& a,
-                         const PointerStringPair& b) const {
-    return a.first == b.first && strcmp(a.second, b.second) == 0;
-  }
-};
-
-template<typename PairType>
-struct PointerIntegerPairHash {
-  size_t operator()(const PairType& p) const {
-    // FIXME(kenton):  What is the best way to compute this hash?  I have
-    // no idea!  This seems a bit better than an XOR.
-    return reinterpret_cast<intptr_t>(p.first) * ((1 << 16) - 1) + p.second;
-  }
-
-  // Used only by MSVC and platforms where hash_map is not available.
-  static const size_t bucket_size = 4;
-  static const size_t min_buckets = 8;
-  inline bool operator()(const PairType& a, const PairType& b) const {
-    return a.first < b.first ||
-          (a.first == b.first && a.second < b.second);
-  }
-};
-
 typedef std::pair<const Descriptor*, int> DescriptorIntPair;
 typedef std::pair<const EnumDescriptor*, int> EnumIntPair;
 
-struct PointerStringPairHash {
-  size_t operator()(const PointerStringPair& p) const {
-    // FIXME(kenton):  What is the best way to compute this hash?  I have
-    // no idea!  This seems a bit better than an XOR.
-    hash<const char*> cstring_hash;
-    return reinterpret_cast<intptr_t>(p.first) * ((1 << 16) - 1) +
-           cstring_hash(p.second);
+// FNV-1a.  FlatHashTable picks a slot by masking off the low bits of the hash,
+// so unlike the hash<const char*> used with hash_map, every input bit needs
+// to affect them.
+inline size_t HashBytes(const char* data, size_t size) {
+  uint32 result = 2166136261u;
+  for (size_t i = 0; i < size; i++) {
+    result = (result ^ static_cast<uint8>(data[i])) * 16777619u;
   }
+  return result;
+}
 
-  // Used only by MSVC and platforms where hash_map is not available.
-  static const size_t bucket_size = 4;
-  static const size_t min_buckets = 8;
-  inline bool operator()(const PointerStringPair& a,
-                         const PointerStringPair& b) const {
-    if (a.first < b.first) return true;
-    if (a.first > b.first) return false;
-    return strcmp(a.second, b.second) < 0;
-  }
-};
+inline size_t HashCString(const char* str) {
+  return HashBytes(str, strlen(str));
+}
 
+inline size_t HashPointerAndValue(const void* pointer, size_t value) {
+  // Descriptors are at least pointer-aligned, so the low bits of the pointer
+  // are always zero.  Keep consecutive values in consecutive slots; that is
+  // the common case for field and enum numbers and suits linear probing.
+  size_t result = static_cast<size_t>(reinterpret_cast<intptr_t>(pointer));
+  result = (result >> 3) * 0x9E3779B1u;
+  return (result ^ (result >> 16)) + value;
+}
 
 struct Symbol {
   enum Type {
@@ -276,31 +256,251 @@ struct Symbol {
 
 const Symbol kNullSymbol;
 
-typedef hash_map<const char*, Symbol,
-                 hash<const char*>, streq>
+// A hash table using open addressing with linear probing.  All entries live
+// in a single array whose size is a power of two, and the table is kept at
+// most 3/4 full.  There is no per-entry allocation at all, which matters
+// because a large pool holds millions of entries (see above).
+//
+// Traits describes the Entry type:
+//   typedef ... Key;
+//   static Key KeyOf(const Entry& entry);
+//   static bool IsEmpty(const Entry& entry);  // True for Entry().
+//   static size_t Hash(const Key& key);
+//   static bool Equal(const Key& a, const Key& b);
+// Where the key can be recomputed from the descriptor being indexed, the
+// entry is just a pointer to that descriptor; otherwise it is a key/value
+// pair (see MapTraits).  Empty entries cannot be inserted.
+template<typename Entry, typename Traits>
+class FlatHashTable {
+ public:
+  typedef typename Traits::Key Key;
+
+  FlatHashTable() : size_(0) {}
+
+  // Returns NULL if the key is not present.
+  const Entry* Find(const Key& key) const {
+    if (size_ == 0) return NULL;
+    const size_t mask = entries_.size() - 1;
+    for (size_t i = Traits::Hash(key) & mask; ; i = (i + 1) & mask) {
+      const Entry& entry = entries_[i];
+      if (Traits::IsEmpty(entry)) return NULL;
+      if (Traits::Equal(Traits::KeyOf(entry), key)) return &entry;
+    }
+  }
+
+  // Returns false and leaves the table unchanged if an entry with the same
+  // key is already present.
+  bool InsertIfNotPresent(const Entry& entry) {
+    GOOGLE_DCHECK(!Traits::IsEmpty(entry));
+    if ((size_ + 1) * 4 > entries_.size() * 3) Grow();
+    return InsertNoGrow(entry);
+  }
+
+  // Removes the entry with the given key if there is one.  Instead of
+  // leaving a tombstone, later entries of the same probe run are shifted
+  // back, so lookups never have to step over deleted slots.
+  void Erase(const Key& key) {
+    if (size_ == 0) return;
+    const size_t mask = entries_.size() - 1;
+    size_t hole = Traits::Hash(key) & mask;
+    while (true) {
+      if (Traits::IsEmpty(entries_[hole])) return;
+      if (Traits::Equal(Traits::KeyOf(entries_[hole]), key)) break;
+      hole = (hole + 1) & mask;
+    }
+
+    for (size_t i = (hole + 1) & mask; !Traits::IsEmpty(entries_[i]);
+         i = (i + 1) & mask) {
+      // The entry at i may move into the hole unless its home slot lies
+      // cyclically in (hole, i], in which case moving it would put it
+      // in front of its home slot where lookups would never find it.
+      size_t home = Traits::Hash(Traits::KeyOf(entries_[i])) & mask;
+      bool home_in_range = hole <= i ? (hole < home && home <= i)
+                                     : (hole < home || home <= i);
+      if (!home_in_range) {
+        entries_[hole] = entries_[i];
+        hole = i;
+      }
+    }
+    entries_[hole] = Entry();
+    --size_;
+  }
+
+ private:
+  bool InsertNoGrow(const Entry& new_entry) {
+    const Key& key = Traits::KeyOf(new_entry);
+    const size_t mask = entries_.size() - 1;
+    for (size_t i = Traits::Hash(key) & mask; ; i = (i + 1) & mask) {
+      Entry& entry = entries_[i];
+      if (Traits::IsEmpty(entry)) {
+        entry = new_entry;
+        ++size_;
+        return true;
+      }
+      if (Traits::Equal(Traits::KeyOf(entry), key)) return false;
+    }
+  }
+
+  void Grow() {
+    std::vector<Entry> old_entries;
+    old_entries.swap(entries_);
+    entries_.resize(old_entries.empty() ? 8 : old_entries.size() * 2);
+    size_ = 0;
+    for (int i = 0; i < old_entries.size(); i++) {
+      if (!Traits::IsEmpty(old_entries[i])) {
+        InsertNoGrow(old_entries[i]);
+      }
+    }
+  }
+
+  std::vector<Entry> entries_;
+  int size_;
+};
+
+inline bool IsNullValue(const void* value) { return value == NULL; }
+inline bool IsNullValue(const Symbol& value) { return value.IsNull(); }
+
+// Traits for a table of std::pair<Key, Value> entries.  A null value marks
+// an empty slot.  KeyTraits provides Hash() and Equal() for Key.
+template<typename KeyType, typename Value, typename KeyTraits>
+struct MapTraits : public KeyTraits {
+  typedef KeyType Key;
+  typedef std::pair<Key, Value> Entry;
+
+  static const Key& KeyOf(const Entry& entry) { return entry.first; }
+  static bool IsEmpty(const Entry& entry) { return IsNullValue(entry.second); }
+};
+
+struct CStringKeyTraits {
+  static size_t Hash(const char* key) { return HashCString(key); }
+  static bool Equal(const char* a, const char* b) {
+    return strcmp(a, b) == 0;
+  }
+};
+
+struct PointerStringPairKeyTraits {
+  static size_t Hash(const PointerStringPair& key) {
+    return HashPointerAndValue(key.first, HashCString(key.second));
+  }
+  static bool Equal(const PointerStringPair& a, const PointerStringPair& b) {
+    return a.first == b.first && strcmp(a.second, b.second) == 0;
+  }
+};
+
+// Compares strings by value.  Used for the string interning table, where
+// the strings may contain NULs (e.g. bytes default values).
+struct StringKeyTraits {
+  static size_t Hash(const std::string* key) {
+    return HashBytes(key->data(), key->size());
+  }
+  static bool Equal(const std::string* a, const std::string* b) {
+    return *a == *b;
+  }
+};
+
+template<typename PairType>
+struct PointerIntegerPairKeyTraits {
+  static size_t Hash(const PairType& key) {
+    return HashPointerAndValue(key.first, key.second);
+  }
+  static bool Equal(const PairType& a, const PairType& b) {
+    return a == b;
+  }
+};
+
+// Traits for tables whose entries are just a descriptor pointer.
+template<typename DescriptorType>
+struct DescriptorTraits {
+  static bool IsEmpty(const DescriptorType* entry) { return entry == NULL; }
+};
+
+// The parent under which a field's lowercase and camel-case names are
+// looked up.
+inline const void* StylizedNameParent(const FieldDescriptor* field) {
+  if (field->is_extension()) {
+    if (field->extension_scope() == NULL) {
+      return field->file();
+    } else {
+      return field->extension_scope();
+    }
+  } else {
+    return field->containing_type();
+  }
+}
+
+struct FieldByLowercaseNameTraits
+    : public DescriptorTraits<FieldDescriptor>, PointerStringPairKeyTraits {
+  typedef PointerStringPair Key;
+  static Key KeyOf(const FieldDescriptor* field) {
+    return Key(StylizedNameParent(field), field->lowercase_name().c_str());
+  }
+};
+
+struct FieldByCamelcaseNameTraits
+    : public DescriptorTraits<FieldDescriptor>, PointerStringPairKeyTraits {
+  typedef PointerStringPair Key;
+  static Key KeyOf(const FieldDescriptor* field) {
+    return Key(StylizedNameParent(field), field->camelcase_name().c_str());
+  }
+};
+
+struct FieldByNumberTraits
+    : public DescriptorTraits<FieldDescriptor>,
+      PointerIntegerPairKeyTraits<DescriptorIntPair> {
+  typedef DescriptorIntPair Key;
+  static Key KeyOf(const FieldDescriptor* field) {
+    return Key(field->containing_type(), field->number());
+  }
+};
+
+struct EnumValueByNumberTraits
+    : public DescriptorTraits<EnumValueDescriptor>,
+      PointerIntegerPairKeyTraits<EnumIntPair> {
+  typedef EnumIntPair Key;
+  static Key KeyOf(const EnumValueDescriptor* value) {
+    return Key(value->type(), value->number());
+  }
+};
+
+typedef MapTraits<const char*, Symbol, CStringKeyTraits>
+  SymbolsByNameTraits;
+typedef FlatHashTable<SymbolsByNameTraits::Entry, SymbolsByNameTraits>
   SymbolsByNameMap;
-typedef hash_map<PointerStringPair, Symbol,
-                 PointerStringPairHash, PointerStringPairEqual>
+typedef MapTraits<PointerStringPair, Symbol, PointerStringPairKeyTraits>
+  SymbolsByParentTraits;
+typedef FlatHashTable<SymbolsByParentTraits::Entry, SymbolsByParentTraits>
   SymbolsByParentMap;
-typedef hash_map<const char*, const FileDescriptor*,
-                 hash<const char*>, streq>
+typedef MapTraits<const char*, const FileDescriptor*, CStringKeyTraits>
+  FilesByNameTraits;
+typedef FlatHashTable<FilesByNameTraits::Entry, FilesByNameTraits>
   FilesByNameMap;
-typedef hash_map<PointerStringPair, const FieldDescriptor*,
-                 PointerStringPairHash, PointerStringPairEqual>
-  FieldsByNameMap;
-typedef hash_map<DescriptorIntPair, const FieldDescriptor*,
-                 PointerIntegerPairHash<DescriptorIntPair> >
+typedef MapTraits<const std::string*, const std::string*, StringKeyTraits>
+  InternedStringTraits;
+typedef FlatHashTable<InternedStringTraits::Entry, InternedStringTraits>
+  InternedStringMap;
+typedef FlatHashTable<const FieldDescriptor*, FieldByLowercaseNameTraits>
+  FieldsByLowercaseNameMap;
+typedef FlatHashTable<const FieldDescriptor*, FieldByCamelcaseNameTraits>
+  FieldsByCamelcaseNameMap;
+typedef FlatHashTable<const FieldDescriptor*, FieldByNumberTraits>
   FieldsByNumberMap;
-typedef hash_map<EnumIntPair, const EnumValueDescriptor*,
-                 PointerIntegerPairHash<EnumIntPair> >
+typedef FlatHashTable<const EnumValueDescriptor*, EnumValueByNumberTraits>
   EnumValuesByNumberMap;
-// This is a map rather than a hash_map, since we use it to iterate
+
+// This is a map rather than a hash table, since we use it to iterate
 // through all the extensions that extend a given Descriptor, and an
 // ordered data structure that implements lower_bound is convenient
 // for that.
 typedef std::map<DescriptorIntPair, const FieldDescriptor*>
   ExtensionsGroupedByDescriptorMap;
 
+// Runs the destructor of an object living in memory from
+// DescriptorPool::Tables::AllocateBytes(), which is not freed individually.
+template<typename Type>
+inline void Destroy(Type* object) {
+  object->~Type();
+}
+
 }  // anonymous namespace
 
 // ===================================================================
@@ -386,6 +586,19 @@ class DescriptorPool::Tables {
   // The string is initialized to the given value for convenience.
   std::string* AllocateString(const std::string& value);
 
+  // Like AllocateString(), but returns the same string object for every call
+  // with an equal value, so the result must never be modified.  Use this for
+  // strings which repeat a lot across files -- simple names, lowercase and
+  // camel-case names, packages and default values -- but not for full names,
+  // which are unique anyway.
+  const std::string* InternString(const std::string& value);
+
+  // Allocate the string scope + "." + name, or just name if scope is empty,
+  // which is how full names are formed.  Unlike appending to the result of
+  // AllocateString(), this leaves no slack capacity in the string.
+  std::string* AllocateFullName(const std::string& scope,
+                                const std::string& name);
+
   // Allocate a protocol message object.  Some older versions of GCC have
   // trouble understanding explicit template instantiations in some cases, so
   // in those cases we have to pass a dummy pointer of the right type as the
@@ -401,20 +614,32 @@ class DescriptorPool::Tables {
   std::vector<FileDescriptorTables*> file_tables_;  // All file tables in the pool.
   std::vector<void*> allocations_;  // All other memory allocated in the pool.
 
+  // AllocateBytes() hands out small allocations by bumping a pointer
+  // through a block of kBlockSize bytes, so that descriptors and strings
+  // don't each pay for a separate operator new.  The blocks themselves are
+  // recorded in allocations_.
+  static const int kBlockSize = 8192;
+  char* block_pos_;  // Next free byte of the current block.
+  char* block_end_;  // End of the current block.
+
   SymbolsByNameMap      symbols_by_name_;
   FilesByNameMap        files_by_name_;
+  InternedStringMap     interned_strings_;
   ExtensionsGroupedByDescriptorMap extensions_;
 
   int strings_before_checkpoint_;
   int messages_before_checkpoint_;
   int file_tables_before_checkpoint_;
   int allocations_before_checkpoint_;
+  char* block_pos_before_checkpoint_;
+  char* block_end_before_checkpoint_;
   std::vector<const char*      > symbols_after_checkpoint_;
   std::vector<const char*      > files_after_checkpoint_;
+  std::vector<const std::string*> interned_strings_after_checkpoint_;
   std::vector<DescriptorIntPair> extensions_after_checkpoint_;
 
   // Allocate some bytes which will be reclaimed when the pool is
-  // destroyed.
+  // destroyed.  The result is aligned suitably for any descriptor type.
   void* AllocateBytes(int size);
 };
 
@@ -473,26 +698,34 @@ class FileDescriptorTables {
   void AddFieldByStylizedNames(const FieldDescriptor* field);
 
  private:
-  SymbolsByParentMap    symbols_by_parent_;
-  FieldsByNameMap       fields_by_lowercase_name_;
-  FieldsByNameMap       fields_by_camelcase_name_;
-  FieldsByNumberMap     fields_by_number_;       // Not including extensions.
-  EnumValuesByNumberMap enum_values_by_number_;
+  SymbolsByParentMap       symbols_by_parent_;
+  FieldsByLowercaseNameMap fields_by_lowercase_name_;
+  FieldsByCamelcaseNameMap fields_by_camelcase_name_;
+  FieldsByNumberMap        fields_by_number_;  // Not including extensions.
+  EnumValuesByNumberMap    enum_values_by_number_;
 };
 
 DescriptorPool::Tables::Tables()
-  : strings_before_checkpoint_(0),
+  : block_pos_(NULL),
+    block_end_(NULL),
+    strings_before_checkpoint_(0),
     messages_before_checkpoint_(0),
-    allocations_before_checkpoint_(0) {}
+    file_tables_before_checkpoint_(0),
+    allocations_before_checkpoint_(0),
+    block_pos_before_checkpoint_(NULL),
+    block_end_before_checkpoint_(NULL) {}
 
 DescriptorPool::Tables::~Tables() {
   // Note that the deletion order is important, since the destructors of some
-  // messages may refer to objects in allocations_.
+  // messages may refer to objects in allocations_, and the strings themselves
+  // live in allocations_.
   STLDeleteElements(&messages_);
+  for (int i = 0; i < strings_.size(); i++) {
+    Destroy(strings_[i]);
+  }
   for (int i = 0; i < allocations_.size(); i++) {
     operator delete(allocations_[i]);
   }
-  STLDeleteElements(&strings_);
   STLDeleteElements(&file_tables_);
 }
 
@@ -506,18 +739,24 @@ void DescriptorPool::Tables::Checkpoint() {
   messages_before_checkpoint_ = messages_.size();
   file_tables_before_checkpoint_ = file_tables_.size();
   allocations_before_checkpoint_ = allocations_.size();
+  block_pos_before_checkpoint_ = block_pos_;
+  block_end_before_checkpoint_ = block_end_;
 
   symbols_after_checkpoint_.clear();
   files_after_checkpoint_.clear();
+  interned_strings_after_checkpoint_.clear();
   extensions_after_checkpoint_.clear();
 }
 
 void DescriptorPool::Tables::Rollback() {
   for (int i = 0; i < symbols_after_checkpoint_.size(); i++) {
-    symbols_by_name_.erase(symbols_after_checkpoint_[i]);
+    symbols_by_name_.Erase(symbols_after_checkpoint_[i]);
   }
   for (int i = 0; i < files_after_checkpoint_.size(); i++) {
-    files_by_name_.erase(files_after_checkpoint_[i]);
+    files_by_name_.Erase(files_after_checkpoint_[i]);
+  }
+  for (int i = 0; i < interned_strings_after_checkpoint_.size(); i++) {
+    interned_strings_.Erase(interned_strings_after_checkpoint_[i]);
   }
   for (int i = 0; i < extensions_after_checkpoint_.size(); i++) {
     extensions_.erase(extensions_after_checkpoint_[i]);
@@ -525,12 +764,14 @@ void DescriptorPool::Tables::Rollback() {
 
   symbols_after_checkpoint_.clear();
   files_after_checkpoint_.clear();
+  interned_strings_after_checkpoint_.clear();
   extensions_after_checkpoint_.clear();
 
-  STLDeleteContainerPointers(
-    strings_.begin() + strings_before_checkpoint_, strings_.end());
   STLDeleteContainerPointers(
     messages_.begin() + messages_before_checkpoint_, messages_.end());
+  for (int i = strings_before_checkpoint_; i < strings_.size(); i++) {
+    Destroy(strings_[i]);
+  }
   STLDeleteContainerPointers(
     file_tables_.begin() + file_tables_before_checkpoint_, file_tables_.end());
   for (int i = allocations_before_checkpoint_; i < allocations_.size(); i++) {
@@ -541,27 +782,30 @@ void DescriptorPool::Tables::Rollback() {
   messages_.resize(messages_before_checkpoint_);
   file_tables_.resize(file_tables_before_checkpoint_);
   allocations_.resize(allocations_before_checkpoint_);
+  block_pos_ = block_pos_before_checkpoint_;
+  block_end_ = block_end_before_checkpoint_;
 }
 
 // -------------------------------------------------------------------
 
 inline Symbol DescriptorPool::Tables::FindSymbol(const std::string& key) const {
-  const Symbol* result = FindOrNull(symbols_by_name_, key.c_str());
+  const SymbolsByNameTraits::Entry* result =
+    symbols_by_name_.Find(key.c_str());
   if (result == NULL) {
     return kNullSymbol;
   } else {
-    return *result;
+    return result->second;
   }
 }
 
 inline Symbol FileDescriptorTables::FindNestedSymbol(
     const void* parent, const std::string& name) const {
-  const Symbol* result =
-    FindOrNull(symbols_by_parent_, PointerStringPair(parent, name.c_str()));
+  const SymbolsByParentTraits::Entry* result =
+    symbols_by_parent_.Find(PointerStringPair(parent, name.c_str()));
   if (result == NULL) {
     return kNullSymbol;
   } else {
-    return *result;
+    return result->second;
   }
 }
 
@@ -595,29 +839,36 @@ Symbol DescriptorPool::Tables::FindByNameHelper(
 
 inline const FileDescriptor* DescriptorPool::Tables::FindFile(
     const std::string& key) const {
-  return FindPtrOrNull(files_by_name_, key.c_str());
+  const FilesByNameTraits::Entry* result = files_by_name_.Find(key.c_str());
+  return result == NULL ? NULL : result->second;
 }
 
 inline const FieldDescriptor* FileDescriptorTables::FindFieldByNumber(
     const Descriptor* parent, int number) const {
-  return FindPtrOrNull(fields_by_number_, std::make_pair(parent, number));
+  const FieldDescriptor* const* result =
+    fields_by_number_.Find(DescriptorIntPair(parent, number));
+  return result == NULL ? NULL : *result;
 }
 
 inline const FieldDescriptor* FileDescriptorTables::FindFieldByLowercaseName(
     const void* parent, const std::string& lowercase_name) const {
-  return FindPtrOrNull(fields_by_lowercase_name_,
-                       PointerStringPair(parent, lowercase_name.c_str()));
+  const FieldDescriptor* const* result = fields_by_lowercase_name_.Find(
+    PointerStringPair(parent, lowercase_name.c_str()));
+  return result == NULL ? NULL : *result;
 }
 
 inline const FieldDescriptor* FileDescriptorTables::FindFieldByCamelcaseName(
     const void* parent, const std::string& camelcase_name) const {
-  return FindPtrOrNull(fields_by_camelcase_name_,
-                       PointerStringPair(parent, camelcase_name.c_str()));
+  const FieldDescriptor* const* result = fields_by_camelcase_name_.Find(
+    PointerStringPair(parent, camelcase_name.c_str()));
+  return result == NULL ? NULL : *result;
 }
 
 inline const EnumValueDescriptor* FileDescriptorTables::FindEnumValueByNumber(
     const EnumDescriptor* parent, int number) const {
-  return FindPtrOrNull(enum_values_by_number_, std::make_pair(parent, number));
+  const EnumValueDescriptor* const* result =
+    enum_values_by_number_.Find(EnumIntPair(parent, number));
+  return result == NULL ? NULL : *result;
 }
 
 inline const FieldDescriptor* DescriptorPool::Tables::FindExtension(
@@ -638,7 +889,8 @@ inline void DescriptorPool::Tables::FindAllExtensions(
 
 bool DescriptorPool::Tables::AddSymbol(
     const std::string& full_name, Symbol symbol) {
-  if (InsertIfNotPresent(&symbols_by_name_, full_name.c_str(), symbol)) {
+  if (symbols_by_name_.InsertIfNotPresent(
+        std::make_pair(full_name.c_str(), symbol))) {
     symbols_after_checkpoint_.push_back(full_name.c_str());
     return true;
   } else {
@@ -649,11 +901,13 @@ bool DescriptorPool::Tables::AddSymbol(
 bool FileDescriptorTables::AddAliasUnderParent(
     const void* parent, const std::string& name, Symbol symbol) {
   PointerStringPair by_parent_key(parent, name.c_str());
-  return InsertIfNotPresent(&symbols_by_parent_, by_parent_key, symbol);
+  return symbols_by_parent_.InsertIfNotPresent(
+    std::make_pair(by_parent_key, symbol));
 }
 
 bool DescriptorPool::Tables::AddFile(const FileDescriptor* file) {
-  if (InsertIfNotPresent(&files_by_name_, file->name().c_str(), file)) {
+  if (files_by_name_.InsertIfNotPresent(
+        std::make_pair(file->name().c_str(), file))) {
     files_after_checkpoint_.push_back(file->name().c_str());
     return true;
   } else {
@@ -663,33 +917,19 @@ bool DescriptorPool::Tables::AddFile(const FileDescriptor* file) {
 
 void FileDescriptorTables::AddFieldByStylizedNames(
     const FieldDescriptor* field) {
-  const void* parent;
-  if (field->is_extension()) {
-    if (field->extension_scope() == NULL) {
-      parent = field->file();
-    } else {
-      parent = field->extension_scope();
-    }
-  } else {
-    parent = field->containing_type();
-  }
-
-  PointerStringPair lowercase_key(parent, field->lowercase_name().c_str());
-  InsertIfNotPresent(&fields_by_lowercase_name_, lowercase_key, field);
-
-  PointerStringPair camelcase_key(parent, field->camelcase_name().c_str());
-  InsertIfNotPresent(&fields_by_camelcase_name_, camelcase_key, field);
+  // The keys are computed from the field itself; see
+  // FieldByLowercaseNameTraits and FieldByCamelcaseNameTraits.
+  fields_by_lowercase_name_.InsertIfNotPresent(field);
+  fields_by_camelcase_name_.InsertIfNotPresent(field);
 }
 
 bool FileDescriptorTables::AddFieldByNumber(const FieldDescriptor* field) {
-  DescriptorIntPair key(field->containing_type(), field->number());
-  return InsertIfNotPresent(&fields_by_number_, key, field);
+  return fields_by_number_.InsertIfNotPresent(field);
 }
 
 bool FileDescriptorTables::AddEnumValueByNumber(
     const EnumValueDescriptor* value) {
-  EnumIntPair key(value->type(), value->number());
-  return InsertIfNotPresent(&enum_values_by_number_, key, value);
+  return enum_values_by_number_.InsertIfNotPresent(value);
 }
 
 bool DescriptorPool::Tables::AddExtension(const FieldDescriptor* field) {
@@ -715,11 +955,35 @@ Type* DescriptorPool::Tables::AllocateArray(int count) {
 }
 
 std::string* DescriptorPool::Tables::AllocateString(const std::string& value) {
-  std::string* result = new std::string(value);
+  std::string* result =
+    new(AllocateBytes(sizeof(std::string))) std::string(value);
   strings_.push_back(result);
   return result;
 }
 
+std::string* DescriptorPool::Tables::AllocateFullName(
+    const std::string& scope, const std::string& name) {
+  if (scope.empty()) return AllocateString(name);
+
+  std::string full_name;
+  full_name.reserve(scope.size() + 1 + name.size());
+  full_name.append(scope);
+  full_name.append(1, '.');
+  full_name.append(name);
+  return AllocateString(full_name);
+}
+
+const std::string* DescriptorPool::Tables::InternString(
+    const std::string& value) {
+  const InternedStringTraits::Entry* existing = interned_strings_.Find(&value);
+  if (existing != NULL) return existing->second;
+
+  const std::string* result = AllocateString(value);
+  interned_strings_.InsertIfNotPresent(std::make_pair(result, result));
+  interned_strings_after_checkpoint_.push_back(result);
+  return result;
+}
+
 template<typename Type>
 Type* DescriptorPool::Tables::AllocateMessage(Type* dummy) {
   Type* result = new Type;
@@ -734,14 +998,29 @@ FileDescriptorTables* DescriptorPool::Tables::AllocateFileTables() {
 }
 
 void* DescriptorPool::Tables::AllocateBytes(int size) {
-  // TODO(kenton):  Would it be worthwhile to implement this in some more
-  // sophisticated way?  Probably not for the open source release, but for
-  // internal use we could easily plug in one of our existing memory pool
-  // allocators...
   if (size == 0) return NULL;
 
-  void* result = operator new(size);
-  allocations_.push_back(result);
+  // Round up so that every allocation stays 8-byte aligned, which is enough
+  // for all of the descriptor types (they contain at most doubles, 64-bit
+  // integers and pointers).
+  size = (size + 7) & ~7;
+
+  if (size > kBlockSize / 4) {
+    // Big arrays get a block of their own rather than wasting whatever is
+    // left of the current block.
+    void* result = operator new(size);
+    allocations_.push_back(result);
+    return result;
+  }
+
+  if (block_end_ - block_pos_ < size) {
+    block_pos_ = reinterpret_cast<char*>(operator new(kBlockSize));
+    block_end_ = block_pos_ + kBlockSize;
+    allocations_.push_back(block_pos_);
+  }
+
+  void* result = block_pos_;
+  block_pos_ += size;
   return result;
 }
 
@@ -854,12 +1133,16 @@ void DescriptorPool::InternalAddGeneratedFile(
   // FileDescriptorProto and generates a FileDescriptor (and all its children)
   // based on it.
   //
+  // The bytes are not even parsed here:  AddLazily() only records them, and
+  // the database reads file names and indexes symbols on the first lookup
+  // that needs them.  Those lookups happen under the pool's mutex.
+  //
   // Note that FileDescriptorProto is itself a generated protocol message.
   // Therefore, when we parse one, we have to be very careful to avoid using
   // any descriptor-based operations, since this might cause infinite recursion
   // or deadlock.
   InitGeneratedPoolOnce();
-  GOOGLE_CHECK(generated_database_->Add(encoded_file_descriptor, size));
+  generated_database_->AddLazily(encoded_file_descriptor, size);
 }
 
 
@@ -2772,13 +3055,13 @@ const FileDescriptor* DescriptorBuilder::BuildFile(
 
   result->name_ = tables_->AllocateString(proto.name());
   if (proto.has_package()) {
-    result->package_ = tables_->AllocateString(proto.package());
+    result->package_ = tables_->InternString(proto.package());
   } else {
     // We cannot rely on proto.package() returning a valid string if
     // proto.has_package() is false, because we might be running at static
     // initialization time, in which case default values have not yet been
     // initialized.
-    result->package_ = tables_->AllocateString("");
+    result->package_ = tables_->InternString("");
   }
   result->pool_ = pool_;
 
@@ -2883,13 +3166,12 @@ void DescriptorBuilder::BuildMessage(const DescriptorProto& proto,
                                      Descriptor* result) {
   const std::string& scope = (parent == NULL) ?
     file_->package() : parent->full_name();
-  std::string* full_name = tables_->AllocateString(scope);
-  if (!full_name->empty()) full_name->append(1, '.');
-  full_name->append(proto.name());
+  const std::string* full_name =
+    tables_->AllocateFullName(scope, proto.name());
 
   ValidateSymbolName(proto.name(), *full_name, proto);
 
-  result->name_            = tables_->AllocateString(proto.name());
+  result->name_            = tables_->InternString(proto.name());
   result->full_name_       = full_name;
   result->file_            = file_;
   result->containing_type_ = parent;
@@ -2951,33 +3233,24 @@ void DescriptorBuilder::BuildFieldOrExtension(const FieldDescriptorProto& proto,
                                               bool is_extension) {
   const std::string& scope = (parent == NULL) ?
     file_->package() : parent->full_name();
-  std::string* full_name = tables_->AllocateString(scope);
-  if (!full_name->empty()) full_name->append(1, '.');
-  full_name->append(proto.name());
+  const std::string* full_name =
+    tables_->AllocateFullName(scope, proto.name());
 
   ValidateSymbolName(proto.name(), *full_name, proto);
 
-  result->name_         = tables_->AllocateString(proto.name());
+  result->name_         = tables_->InternString(proto.name());
   result->full_name_    = full_name;
   result->file_         = file_;
   result->number_       = proto.number();
   result->is_extension_ = is_extension;
 
   // If .proto files follow the style guide then the name should already be
-  // lower-cased.  If that's the case we can just reuse the string we already
-  // allocated rather than allocate a new one.
+  // lower-cased, and single-word names are also their own camel-case name.
+  // Interning makes all of these share the string we already allocated.
   std::string lowercase_name(proto.name());
   LowerString(&lowercase_name);
-  if (lowercase_name == proto.name()) {
-    result->lowercase_name_ = result->name_;
-  } else {
-    result->lowercase_name_ = tables_->AllocateString(lowercase_name);
-  }
-
-  // Don't bother with the above optimization for camel-case names since
-  // .proto files that follow the guide shouldn't be using names in this
-  // format, so the optimization wouldn't help much.
-  result->camelcase_name_ = tables_->AllocateString(ToCamelCase(proto.name()));
+  result->lowercase_name_ = tables_->InternString(lowercase_name);
+  result->camelcase_name_ = tables_->InternString(ToCamelCase(proto.name()));
 
   // Some compilers do not allow static_cast directly between two enum types,
   // so we must cast to int first.
@@ -3061,11 +3334,11 @@ void DescriptorBuilder::BuildFieldOrExtension(const FieldDescriptorProto& proto,
           break;
         case FieldDescriptor::CPPTYPE_STRING:
           if (result->type() == FieldDescriptor::TYPE_BYTES) {
-            result->default_value_string_ = tables_->AllocateString(
+            result->default_value_string_ = tables_->InternString(
               UnescapeCEscapeString(proto.default_value()));
           } else {
             result->default_value_string_ =
-              tables_->AllocateString(proto.default_value());
+              tables_->InternString(proto.default_value());
           }
           break;
         case FieldDescriptor::CPPTYPE_MESSAGE:
@@ -3200,13 +3473,12 @@ void DescriptorBuilder::BuildEnum(const EnumDescriptorProto& proto,
                                   EnumDescriptor* result) {
   const std::string& scope = (parent == NULL) ?
     file_->package() : parent->full_name();
-  std::string* full_name = tables_->AllocateString(scope);
-  if (!full_name->empty()) full_name->append(1, '.');
-  full_name->append(proto.name());
+  const std::string* full_name =
+    tables_->AllocateFullName(scope, proto.name());
 
   ValidateSymbolName(proto.name(), *full_name, proto);
 
-  result->name_            = tables_->AllocateString(proto.name());
+  result->name_            = tables_->InternString(proto.name());
   result->full_name_       = full_name;
   result->file_            = file_;
   result->containing_type_ = parent;
@@ -3237,15 +3509,21 @@ void DescriptorBuilder::BuildEnum(const EnumDescriptorProto& proto,
 void DescriptorBuilder::BuildEnumValue(const EnumValueDescriptorProto& proto,
                                        const EnumDescriptor* parent,
                                        EnumValueDescriptor* result) {
-  result->name_   = tables_->AllocateString(proto.name());
+  result->name_   = tables_->InternString(proto.name());
   result->number_ = proto.number();
   result->type_   = parent;
 
   // Note:  full_name for enum values is a sibling to the parent's name, not a
   //   child of it.
-  std::string* full_name = tables_->AllocateString(*parent->full_name_);
-  full_name->resize(full_name->size() - parent->name_->size());
-  full_name->append(*result->name_);
+  const std::string& parent_full_name = *parent->full_name_;
+  std::string scope;
+  if (parent_full_name.size() > parent->name_->size()) {
+    // Drop the parent's name along with the dot preceding it.
+    scope = parent_full_name.substr(
+      0, parent_full_name.size() - parent->name_->size() - 1);
+  }
+  const std::string* full_name =
+    tables_->AllocateFullName(scope, *result->name_);
   result->full_name_ = full_name;
 
   ValidateSymbolName(proto.name(), *full_name, proto);
@@ -3305,13 +3583,12 @@ void DescriptorBuilder::BuildEnumValue(const EnumValueDescriptorProto& proto,
 void DescriptorBuilder::BuildService(const ServiceDescriptorProto& proto,
                                      const void* dummy,
                                      ServiceDescriptor* result) {
-  std::string* full_name = tables_->AllocateString(file_->package());
-  if (!full_name->empty()) full_name->append(1, '.');
-  full_name->append(proto.name());
+  const std::string* full_name =
+    tables_->AllocateFullName(file_->package(), proto.name());
 
   ValidateSymbolName(proto.name(), *full_name, proto);
 
-  result->name_      = tables_->AllocateString(proto.name());
+  result->name_      = tables_->InternString(proto.name());
   result->full_name_ = full_name;
   result->file_      = file_;
 
@@ -3331,12 +3608,11 @@ void DescriptorBuilder::BuildService(const ServiceDescriptorProto& proto,
 void DescriptorBuilder::BuildMethod(const MethodDescriptorProto& proto,
                                     const ServiceDescriptor* parent,
                                     MethodDescriptor* result) {
-  result->name_    = tables_->AllocateString(proto.name());
+  result->name_    = tables_->InternString(proto.name());
   result->service_ = parent;
 
-  std::string* full_name = tables_->AllocateString(parent->full_name());
-  full_name->append(1, '.');
-  full_name->append(*result->name_);
+  const std::string* full_name =
+    tables_->AllocateFullName(parent->full_name(), *result->name_);
   result->full_name_ = full_name;
 
   ValidateSymbolName(proto.name(), *full_name, proto);
@@ -86,8 +86,69 @@ const ::google::protobuf::internal::GeneratedMessageReflection*
 }  // namespace
 
 
+namespace {
+
+bool protobuf_defaults_initialized_ = false;
+
+}  // namespace
+
+void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto() {
+  new (FileDescriptorSet::default_instance_) FileDescriptorSet();
+  new (FileDescriptorProto::default_instance_) FileDescriptorProto();
+  new (DescriptorProto::default_instance_) DescriptorProto();
+  new (DescriptorProto_ExtensionRange::default_instance_) DescriptorProto_ExtensionRange();
+  new (FieldDescriptorProto::default_instance_) FieldDescriptorProto();
+  new (EnumDescriptorProto::default_instance_) EnumDescriptorProto();
+  new (EnumValueDescriptorProto::default_instance_) EnumValueDescriptorProto();
+  new (ServiceDescriptorProto::default_instance_) ServiceDescriptorProto();
+  new (MethodDescriptorProto::default_instance_) MethodDescriptorProto();
+  new (FileOptions::default_instance_) FileOptions();
+  new (MessageOptions::default_instance_) MessageOptions();
+  new (FieldOptions::default_instance_) FieldOptions();
+  new (EnumOptions::default_instance_) EnumOptions();
+  new (EnumValueOptions::default_instance_) EnumValueOptions();
+  new (ServiceOptions::default_instance_) ServiceOptions();
+  new (MethodOptions::default_instance_) MethodOptions();
+  new (UninterpretedOption::default_instance_) UninterpretedOption();
+  new (UninterpretedOption_NamePart::default_instance_) UninterpretedOption_NamePart();
+  new (SourceCodeInfo::default_instance_) SourceCodeInfo();
+  new (SourceCodeInfo_Location::default_instance_) SourceCodeInfo_Location();
+  FileDescriptorSet::default_instance_->InitAsDefaultInstance();
+  FileDescriptorProto::default_instance_->InitAsDefaultInstance();
+  DescriptorProto::default_instance_->InitAsDefaultInstance();
+  DescriptorProto_ExtensionRange::default_instance_->InitAsDefaultInstance();
+  FieldDescriptorProto::default_instance_->InitAsDefaultInstance();
+  EnumDescriptorProto::default_instance_->InitAsDefaultInstance();
+  EnumValueDescriptorProto::default_instance_->InitAsDefaultInstance();
+  ServiceDescriptorProto::default_instance_->InitAsDefaultInstance();
+  MethodDescriptorProto::default_instance_->InitAsDefaultInstance();
+  FileOptions::default_instance_->InitAsDefaultInstance();
+  MessageOptions::default_instance_->InitAsDefaultInstance();
+  FieldOptions::default_instance_->InitAsDefaultInstance();
+  EnumOptions::default_instance_->InitAsDefaultInstance();
+  EnumValueOptions::default_instance_->InitAsDefaultInstance();
+  ServiceOptions::default_instance_->InitAsDefaultInstance();
+  MethodOptions::default_instance_->InitAsDefaultInstance();
+  UninterpretedOption::default_instance_->InitAsDefaultInstance();
+  UninterpretedOption_NamePart::default_instance_->InitAsDefaultInstance();
+  SourceCodeInfo::default_instance_->InitAsDefaultInstance();
+  SourceCodeInfo_Location::default_instance_->InitAsDefaultInstance();
+  protobuf_defaults_initialized_ = true;
+}
+
+namespace {
+
+GOOGLE_PROTOBUF_DECLARE_ONCE(protobuf_InitDefaults_once_);
+inline void protobuf_InitDefaultsOnce() {
+  ::google::protobuf::GoogleOnceInit(&protobuf_InitDefaults_once_,
+                 &protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto);
+}
+
+}  // namespace
+
 void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
   protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  protobuf_InitDefaultsOnce();
   const ::google::protobuf::FileDescriptor* file =
     ::google::protobuf::DescriptorPool::generated_pool()->FindFileByName(
       "google/protobuf/descriptor.proto");
@@ -506,45 +567,47 @@ void protobuf_RegisterTypes(const ::std::string&) {
 }  // namespace
 
 void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto() {
-  delete FileDescriptorSet::default_instance_;
+  if (protobuf_defaults_initialized_) {
+    ::google::protobuf::internal::DestroyStaticObject(*FileDescriptorSet::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*FileDescriptorProto::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*DescriptorProto::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*DescriptorProto_ExtensionRange::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*FieldDescriptorProto::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*EnumDescriptorProto::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*EnumValueDescriptorProto::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*ServiceDescriptorProto::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*MethodDescriptorProto::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*FileOptions::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*MessageOptions::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*FieldOptions::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*EnumOptions::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*EnumValueOptions::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*ServiceOptions::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*MethodOptions::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*UninterpretedOption::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*UninterpretedOption_NamePart::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*SourceCodeInfo::default_instance_);
+    ::google::protobuf::internal::DestroyStaticObject(*SourceCodeInfo_Location::default_instance_);
+  }
   delete FileDescriptorSet_reflection_;
-  delete FileDescriptorProto::default_instance_;
   delete FileDescriptorProto_reflection_;
-  delete DescriptorProto::default_instance_;
   delete DescriptorProto_reflection_;
-  delete DescriptorProto_ExtensionRange::default_instance_;
   delete DescriptorProto_ExtensionRange_reflection_;
-  delete FieldDescriptorProto::default_instance_;
   delete FieldDescriptorProto_reflection_;
-  delete EnumDescriptorProto::default_instance_;
   delete EnumDescriptorProto_reflection_;
-  delete EnumValueDescriptorProto::default_instance_;
   delete EnumValueDescriptorProto_reflection_;
-  delete ServiceDescriptorProto::default_instance_;
   delete ServiceDescriptorProto_reflection_;
-  delete MethodDescriptorProto::default_instance_;
   delete MethodDescriptorProto_reflection_;
-  delete FileOptions::default_instance_;
   delete FileOptions_reflection_;
-  delete MessageOptions::default_instance_;
   delete MessageOptions_reflection_;
-  delete FieldOptions::default_instance_;
   delete FieldOptions_reflection_;
-  delete EnumOptions::default_instance_;
   delete EnumOptions_reflection_;
-  delete EnumValueOptions::default_instance_;
   delete EnumValueOptions_reflection_;
-  delete ServiceOptions::default_instance_;
   delete ServiceOptions_reflection_;
-  delete MethodOptions::default_instance_;
   delete MethodOptions_reflection_;
-  delete UninterpretedOption::default_instance_;
   delete UninterpretedOption_reflection_;
-  delete UninterpretedOption_NamePart::default_instance_;
   delete UninterpretedOption_NamePart_reflection_;
-  delete SourceCodeInfo::default_instance_;
   delete SourceCodeInfo_reflection_;
-  delete SourceCodeInfo_Location::default_instance_;
   delete SourceCodeInfo_Location_reflection_;
 }
 
@@ -656,46 +719,6 @@ void protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto() {
     "B\020DescriptorProtosH\001", 3940);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "google/protobuf/descriptor.proto", &protobuf_RegisterTypes);
-  FileDescriptorSet::default_instance_ = new FileDescriptorSet();
-  FileDescriptorProto::default_instance_ = new FileDescriptorProto();
-  DescriptorProto::default_instance_ = new DescriptorProto();
-  DescriptorProto_ExtensionRange::default_instance_ = new DescriptorProto_ExtensionRange();
-  FieldDescriptorProto::default_instance_ = new FieldDescriptorProto();
-  EnumDescriptorProto::default_instance_ = new EnumDescriptorProto();
-  EnumValueDescriptorProto::default_instance_ = new EnumValueDescriptorProto();
-  ServiceDescriptorProto::default_instance_ = new ServiceDescriptorProto();
-  MethodDescriptorProto::default_instance_ = new MethodDescriptorProto();
-  FileOptions::default_instance_ = new FileOptions();
-  MessageOptions::default_instance_ = new MessageOptions();
-  FieldOptions::default_instance_ = new FieldOptions();
-  EnumOptions::default_instance_ = new EnumOptions();
-  EnumValueOptions::default_instance_ = new EnumValueOptions();
-  ServiceOptions::default_instance_ = new ServiceOptions();
-  MethodOptions::default_instance_ = new MethodOptions();
-  UninterpretedOption::default_instance_ = new UninterpretedOption();
-  UninterpretedOption_NamePart::default_instance_ = new UninterpretedOption_NamePart();
-  SourceCodeInfo::default_instance_ = new SourceCodeInfo();
-  SourceCodeInfo_Location::default_instance_ = new SourceCodeInfo_Location();
-  FileDescriptorSet::default_instance_->InitAsDefaultInstance();
-  FileDescriptorProto::default_instance_->InitAsDefaultInstance();
-  DescriptorProto::default_instance_->InitAsDefaultInstance();
-  DescriptorProto_ExtensionRange::default_instance_->InitAsDefaultInstance();
-  FieldDescriptorProto::default_instance_->InitAsDefaultInstance();
-  EnumDescriptorProto::default_instance_->InitAsDefaultInstance();
-  EnumValueDescriptorProto::default_instance_->InitAsDefaultInstance();
-  ServiceDescriptorProto::default_instance_->InitAsDefaultInstance();
-  MethodDescriptorProto::default_instance_->InitAsDefaultInstance();
-  FileOptions::default_instance_->InitAsDefaultInstance();
-  MessageOptions::default_instance_->InitAsDefaultInstance();
-  FieldOptions::default_instance_->InitAsDefaultInstance();
-  EnumOptions::default_instance_->InitAsDefaultInstance();
-  EnumValueOptions::default_instance_->InitAsDefaultInstance();
-  ServiceOptions::default_instance_->InitAsDefaultInstance();
-  MethodOptions::default_instance_->InitAsDefaultInstance();
-  UninterpretedOption::default_instance_->InitAsDefaultInstance();
-  UninterpretedOption_NamePart::default_instance_->InitAsDefaultInstance();
-  SourceCodeInfo::default_instance_->InitAsDefaultInstance();
-  SourceCodeInfo_Location::default_instance_->InitAsDefaultInstance();
   ::google::protobuf::internal::OnShutdown(&protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto);
 }
 
@@ -752,10 +775,16 @@ const ::google::protobuf::Descriptor* FileDescriptorSet::descriptor() {
 }
 
 const FileDescriptorSet& FileDescriptorSet::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-FileDescriptorSet* FileDescriptorSet::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<FileDescriptorSet>
+  FileDescriptorSet_default_instance_storage_;
+}  // namespace
+FileDescriptorSet* FileDescriptorSet::default_instance_ =
+  reinterpret_cast<FileDescriptorSet*>(&FileDescriptorSet_default_instance_storage_);
 
 FileDescriptorSet* FileDescriptorSet::New() const {
   return new FileDescriptorSet;
@@ -932,8 +961,10 @@ FileDescriptorProto::FileDescriptorProto()
 }
 
 void FileDescriptorProto::InitAsDefaultInstance() {
-  options_ = const_cast< ::google::protobuf::FileOptions*>(&::google::protobuf::FileOptions::default_instance());
-  source_code_info_ = const_cast< ::google::protobuf::SourceCodeInfo*>(&::google::protobuf::SourceCodeInfo::default_instance());
+  options_ = const_cast< ::google::protobuf::FileOptions*>(
+      ::google::protobuf::FileOptions::internal_default_instance());
+  source_code_info_ = const_cast< ::google::protobuf::SourceCodeInfo*>(
+      ::google::protobuf::SourceCodeInfo::internal_default_instance());
 }
 
 FileDescriptorProto::FileDescriptorProto(const FileDescriptorProto& from)
@@ -979,10 +1010,16 @@ const ::google::protobuf::Descriptor* FileDescriptorProto::descriptor() {
 }
 
 const FileDescriptorProto& FileDescriptorProto::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-FileDescriptorProto* FileDescriptorProto::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<FileDescriptorProto>
+  FileDescriptorProto_default_instance_storage_;
+}  // namespace
+FileDescriptorProto* FileDescriptorProto::default_instance_ =
+  reinterpret_cast<FileDescriptorProto*>(&FileDescriptorProto_default_instance_storage_);
 
 FileDescriptorProto* FileDescriptorProto::New() const {
   return new FileDescriptorProto;
@@ -1559,19 +1596,26 @@ const ::google::protobuf::Descriptor* DescriptorProto_ExtensionRange::descriptor
 }
 
 const DescriptorProto_ExtensionRange& DescriptorProto_ExtensionRange::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-DescriptorProto_ExtensionRange* DescriptorProto_ExtensionRange::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<DescriptorProto_ExtensionRange>
+  DescriptorProto_ExtensionRange_default_instance_storage_;
+}  // namespace
+DescriptorProto_ExtensionRange* DescriptorProto_ExtensionRange::default_instance_ =
+  reinterpret_cast<DescriptorProto_ExtensionRange*>(&DescriptorProto_ExtensionRange_default_instance_storage_);
 
 DescriptorProto_ExtensionRange* DescriptorProto_ExtensionRange::New() const {
   return new DescriptorProto_ExtensionRange;
 }
 
 void DescriptorProto_ExtensionRange::Clear() {
-  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    start_ = 0;
-    end_ = 0;
+  if ((_has_bits_[0] & 0x00000003u) != 0) {
+    ::memset(&start_, 0,
+      reinterpret_cast<char*>(&end_ + 1) -
+      reinterpret_cast<char*>(&start_));
   }
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
   mutable_unknown_fields()->Clear();
@@ -1711,27 +1755,49 @@ void DescriptorProto_ExtensionRange::MergeFrom(const ::google::protobuf::Message
 
 void DescriptorProto_ExtensionRange::MergeFrom(const DescriptorProto_ExtensionRange& from) {
   GOOGLE_CHECK_NE(&from, this);
-  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    if (from.has_start()) {
-      set_start(from.start());
-    }
-    if (from.has_end()) {
-      set_end(from.end());
+  if ((from._has_bits_[0] & 0x00000003u) == 0x00000003u) {
+    ::memcpy(&start_, &from.start_,
+      reinterpret_cast<const char*>(&end_ + 1) -
+      reinterpret_cast<const char*>(&start_));
+    _has_bits_[0] |= 0x00000003u;
+  } else {
+    if (from._has_bits_[0] & 0x00000003u) {
+      if (from.has_start()) {
+        set_start(from.start());
+      }
+      if (from.has_end()) {
+        set_end(from.end());
+      }
     }
   }
+  MergeFromExceptScalarBlock(from);
+}
+
+void DescriptorProto_ExtensionRange::MergeFromExceptScalarBlock(const DescriptorProto_ExtensionRange& from) {
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
 
 void DescriptorProto_ExtensionRange::CopyFrom(const ::google::protobuf::Message& from) {
   if (&from == this) return;
-  Clear();
-  MergeFrom(from);
+  const DescriptorProto_ExtensionRange* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const DescriptorProto_ExtensionRange*>(
+      &from);
+  if (source == NULL) {
+    Clear();
+    MergeFrom(from);
+  } else {
+    CopyFrom(*source);
+  }
 }
 
 void DescriptorProto_ExtensionRange::CopyFrom(const DescriptorProto_ExtensionRange& from) {
   if (&from == this) return;
   Clear();
-  MergeFrom(from);
+  ::memcpy(&start_, &from.start_,
+    reinterpret_cast<const char*>(&end_ + 1) -
+    reinterpret_cast<const char*>(&start_));
+  _has_bits_[0] |= from._has_bits_[0] & 0x00000003u;
+  MergeFromExceptScalarBlock(from);
 }
 
 bool DescriptorProto_ExtensionRange::IsInitialized() const {
@@ -1776,7 +1842,8 @@ DescriptorProto::DescriptorProto()
 }
 
 void DescriptorProto::InitAsDefaultInstance() {
-  options_ = const_cast< ::google::protobuf::MessageOptions*>(&::google::protobuf::MessageOptions::default_instance());
+  options_ = const_cast< ::google::protobuf::MessageOptions*>(
+      ::google::protobuf::MessageOptions::internal_default_instance());
 }
 
 DescriptorProto::DescriptorProto(const DescriptorProto& from)
@@ -1816,10 +1883,16 @@ const ::google::protobuf::Descriptor* DescriptorProto::descriptor() {
 }
 
 const DescriptorProto& DescriptorProto::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-DescriptorProto* DescriptorProto::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<DescriptorProto>
+  DescriptorProto_default_instance_storage_;
+}  // namespace
+DescriptorProto* DescriptorProto::default_instance_ =
+  reinterpret_cast<DescriptorProto*>(&DescriptorProto_default_instance_storage_);
 
 DescriptorProto* DescriptorProto::New() const {
   return new DescriptorProto;
@@ -2337,7 +2410,8 @@ FieldDescriptorProto::FieldDescriptorProto()
 }
 
 void FieldDescriptorProto::InitAsDefaultInstance() {
-  options_ = const_cast< ::google::protobuf::FieldOptions*>(&::google::protobuf::FieldOptions::default_instance());
+  options_ = const_cast< ::google::protobuf::FieldOptions*>(
+      ::google::protobuf::FieldOptions::internal_default_instance());
 }
 
 FieldDescriptorProto::FieldDescriptorProto(const FieldDescriptorProto& from)
@@ -2392,10 +2466,16 @@ const ::google::protobuf::Descriptor* FieldDescriptorProto::descriptor() {
 }
 
 const FieldDescriptorProto& FieldDescriptorProto::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-FieldDescriptorProto* FieldDescriptorProto::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<FieldDescriptorProto>
+  FieldDescriptorProto_default_instance_storage_;
+}  // namespace
+FieldDescriptorProto* FieldDescriptorProto::default_instance_ =
+  reinterpret_cast<FieldDescriptorProto*>(&FieldDescriptorProto_default_instance_storage_);
 
 FieldDescriptorProto* FieldDescriptorProto::New() const {
   return new FieldDescriptorProto;
@@ -2907,7 +2987,8 @@ EnumDescriptorProto::EnumDescriptorProto()
 }
 
 void EnumDescriptorProto::InitAsDefaultInstance() {
-  options_ = const_cast< ::google::protobuf::EnumOptions*>(&::google::protobuf::EnumOptions::default_instance());
+  options_ = const_cast< ::google::protobuf::EnumOptions*>(
+      ::google::protobuf::EnumOptions::internal_default_instance());
 }
 
 EnumDescriptorProto::EnumDescriptorProto(const EnumDescriptorProto& from)
@@ -2947,10 +3028,16 @@ const ::google::protobuf::Descriptor* EnumDescriptorProto::descriptor() {
 }
 
 const EnumDescriptorProto& EnumDescriptorProto::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-EnumDescriptorProto* EnumDescriptorProto::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<EnumDescriptorProto>
+  EnumDescriptorProto_default_instance_storage_;
+}  // namespace
+EnumDescriptorProto* EnumDescriptorProto::default_instance_ =
+  reinterpret_cast<EnumDescriptorProto*>(&EnumDescriptorProto_default_instance_storage_);
 
 EnumDescriptorProto* EnumDescriptorProto::New() const {
   return new EnumDescriptorProto;
@@ -3222,7 +3309,8 @@ EnumValueDescriptorProto::EnumValueDescriptorProto()
 }
 
 void EnumValueDescriptorProto::InitAsDefaultInstance() {
-  options_ = const_cast< ::google::protobuf::EnumValueOptions*>(&::google::protobuf::EnumValueOptions::default_instance());
+  options_ = const_cast< ::google::protobuf::EnumValueOptions*>(
+      ::google::protobuf::EnumValueOptions::internal_default_instance());
 }
 
 EnumValueDescriptorProto::EnumValueDescriptorProto(const EnumValueDescriptorProto& from)
@@ -3263,10 +3351,16 @@ const ::google::protobuf::Descriptor* EnumValueDescriptorProto::descriptor() {
 }
 
 const EnumValueDescriptorProto& EnumValueDescriptorProto::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-EnumValueDescriptorProto* EnumValueDescriptorProto::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<EnumValueDescriptorProto>
+  EnumValueDescriptorProto_default_instance_storage_;
+}  // namespace
+EnumValueDescriptorProto* EnumValueDescriptorProto::default_instance_ =
+  reinterpret_cast<EnumValueDescriptorProto*>(&EnumValueDescriptorProto_default_instance_storage_);
 
 EnumValueDescriptorProto* EnumValueDescriptorProto::New() const {
   return new EnumValueDescriptorProto;
@@ -3534,7 +3628,8 @@ ServiceDescriptorProto::ServiceDescriptorProto()
 }
 
 void ServiceDescriptorProto::InitAsDefaultInstance() {
-  options_ = const_cast< ::google::protobuf::ServiceOptions*>(&::google::protobuf::ServiceOptions::default_instance());
+  options_ = const_cast< ::google::protobuf::ServiceOptions*>(
+      ::google::protobuf::ServiceOptions::internal_default_instance());
 }
 
 ServiceDescriptorProto::ServiceDescriptorProto(const ServiceDescriptorProto& from)
@@ -3574,10 +3669,16 @@ const ::google::protobuf::Descriptor* ServiceDescriptorProto::descriptor() {
 }
 
 const ServiceDescriptorProto& ServiceDescriptorProto::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-ServiceDescriptorProto* ServiceDescriptorProto::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<ServiceDescriptorProto>
+  ServiceDescriptorProto_default_instance_storage_;
+}  // namespace
+ServiceDescriptorProto* ServiceDescriptorProto::default_instance_ =
+  reinterpret_cast<ServiceDescriptorProto*>(&ServiceDescriptorProto_default_instance_storage_);
 
 ServiceDescriptorProto* ServiceDescriptorProto::New() const {
   return new ServiceDescriptorProto;
@@ -3850,7 +3951,8 @@ MethodDescriptorProto::MethodDescriptorProto()
 }
 
 void MethodDescriptorProto::InitAsDefaultInstance() {
-  options_ = const_cast< ::google::protobuf::MethodOptions*>(&::google::protobuf::MethodOptions::default_instance());
+  options_ = const_cast< ::google::protobuf::MethodOptions*>(
+      ::google::protobuf::MethodOptions::internal_default_instance());
 }
 
 MethodDescriptorProto::MethodDescriptorProto(const MethodDescriptorProto& from)
@@ -3898,10 +4000,16 @@ const ::google::protobuf::Descriptor* MethodDescriptorProto::descriptor() {
 }
 
 const MethodDescriptorProto& MethodDescriptorProto::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-MethodDescriptorProto* MethodDescriptorProto::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<MethodDescriptorProto>
+  MethodDescriptorProto_default_instance_storage_;
+}  // namespace
+MethodDescriptorProto* MethodDescriptorProto::default_instance_ =
+  reinterpret_cast<MethodDescriptorProto*>(&MethodDescriptorProto_default_instance_storage_);
 
 MethodDescriptorProto* MethodDescriptorProto::New() const {
   return new MethodDescriptorProto;
@@ -4311,10 +4419,16 @@ const ::google::protobuf::Descriptor* FileOptions::descriptor() {
 }
 
 const FileOptions& FileOptions::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-FileOptions* FileOptions::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<FileOptions>
+  FileOptions_default_instance_storage_;
+}  // namespace
+FileOptions* FileOptions::default_instance_ =
+  reinterpret_cast<FileOptions*>(&FileOptions_default_instance_storage_);
 
 FileOptions* FileOptions::New() const {
   return new FileOptions;
@@ -4322,6 +4436,11 @@ FileOptions* FileOptions::New() const {
 
 void FileOptions::Clear() {
   _extensions_.Clear();
+  if ((_has_bits_[0] & 0x000000ecu) != 0) {
+    ::memset(&java_multiple_files_, 0,
+      reinterpret_cast<char*>(&py_generic_services_ + 1) -
+      reinterpret_cast<char*>(&java_multiple_files_));
+  }
   if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
     if (has_java_package()) {
       if (java_package_ != &::google::protobuf::internal::kEmptyString) {
@@ -4333,12 +4452,7 @@ void FileOptions::Clear() {
         java_outer_classname_->clear();
       }
     }
-    java_multiple_files_ = false;
-    java_generate_equals_and_hash_ = false;
     optimize_for_ = 1;
-    cc_generic_services_ = false;
-    java_generic_services_ = false;
-    py_generic_services_ = false;
   }
   uninterpreted_option_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
@@ -4744,6 +4858,34 @@ void FileOptions::MergeFrom(const ::google::protobuf::Message& from) {
 
 void FileOptions::MergeFrom(const FileOptions& from) {
   GOOGLE_CHECK_NE(&from, this);
+  if ((from._has_bits_[0] & 0x000000ecu) == 0x000000ecu) {
+    ::memcpy(&java_multiple_files_, &from.java_multiple_files_,
+      reinterpret_cast<const char*>(&py_generic_services_ + 1) -
+      reinterpret_cast<const char*>(&java_multiple_files_));
+    _has_bits_[0] |= 0x000000ecu;
+  } else {
+    if (from._has_bits_[0] & 0x000000ecu) {
+      if (from.has_java_multiple_files()) {
+        set_java_multiple_files(from.java_multiple_files());
+      }
+      if (from.has_java_generate_equals_and_hash()) {
+        set_java_generate_equals_and_hash(from.java_generate_equals_and_hash());
+      }
+      if (from.has_cc_generic_services()) {
+        set_cc_generic_services(from.cc_generic_services());
+      }
+      if (from.has_java_generic_services()) {
+        set_java_generic_services(from.java_generic_services());
+      }
+      if (from.has_py_generic_services()) {
+        set_py_generic_services(from.py_generic_services());
+      }
+    }
+  }
+  MergeFromExceptScalarBlock(from);
+}
+
+void FileOptions::MergeFromExceptScalarBlock(const FileOptions& from) {
   uninterpreted_option_.MergeFrom(from.uninterpreted_option_);
   if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
     if (from.has_java_package()) {
@@ -4752,24 +4894,9 @@ void FileOptions::MergeFrom(const FileOptions& from) {
     if (from.has_java_outer_classname()) {
       set_java_outer_classname(from.java_outer_classname());
     }
-    if (from.has_java_multiple_files()) {
-      set_java_multiple_files(from.java_multiple_files());
-    }
-    if (from.has_java_generate_equals_and_hash()) {
-      set_java_generate_equals_and_hash(from.java_generate_equals_and_hash());
-    }
     if (from.has_optimize_for()) {
       set_optimize_for(from.optimize_for());
     }
-    if (from.has_cc_generic_services()) {
-      set_cc_generic_services(from.cc_generic_services());
-    }
-    if (from.has_java_generic_services()) {
-      set_java_generic_services(from.java_generic_services());
-    }
-    if (from.has_py_generic_services()) {
-      set_py_generic_services(from.py_generic_services());
-    }
   }
   _extensions_.MergeFrom(from._extensions_);
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
@@ -4777,14 +4904,25 @@ void FileOptions::MergeFrom(const FileOptions& from) {
 
 void FileOptions::CopyFrom(const ::google::protobuf::Message& from) {
   if (&from == this) return;
-  Clear();
-  MergeFrom(from);
+  const FileOptions* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const FileOptions*>(
+      &from);
+  if (source == NULL) {
+    Clear();
+    MergeFrom(from);
+  } else {
+    CopyFrom(*source);
+  }
 }
 
 void FileOptions::CopyFrom(const FileOptions& from) {
   if (&from == this) return;
   Clear();
-  MergeFrom(from);
+  ::memcpy(&java_multiple_files_, &from.java_multiple_files_,
+    reinterpret_cast<const char*>(&py_generic_services_ + 1) -
+    reinterpret_cast<const char*>(&java_multiple_files_));
+  _has_bits_[0] |= from._has_bits_[0] & 0x000000ecu;
+  MergeFromExceptScalarBlock(from);
 }
 
 bool FileOptions::IsInitialized() const {
@@ -4872,10 +5010,16 @@ const ::google::protobuf::Descriptor* MessageOptions::descriptor() {
 }
 
 const MessageOptions& MessageOptions::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-MessageOptions* MessageOptions::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<MessageOptions>
+  MessageOptions_default_instance_storage_;
+}  // namespace
+MessageOptions* MessageOptions::default_instance_ =
+  reinterpret_cast<MessageOptions*>(&MessageOptions_default_instance_storage_);
 
 MessageOptions* MessageOptions::New() const {
   return new MessageOptions;
@@ -4883,9 +5027,10 @@ MessageOptions* MessageOptions::New() const {
 
 void MessageOptions::Clear() {
   _extensions_.Clear();
-  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    message_set_wire_format_ = false;
-    no_standard_descriptor_accessor_ = false;
+  if ((_has_bits_[0] & 0x00000003u) != 0) {
+    ::memset(&message_set_wire_format_, 0,
+      reinterpret_cast<char*>(&no_standard_descriptor_accessor_ + 1) -
+      reinterpret_cast<char*>(&message_set_wire_format_));
   }
   uninterpreted_option_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
@@ -5073,29 +5218,51 @@ void MessageOptions::MergeFrom(const ::google::protobuf::Message& from) {
 
 void MessageOptions::MergeFrom(const MessageOptions& from) {
   GOOGLE_CHECK_NE(&from, this);
-  uninterpreted_option_.MergeFrom(from.uninterpreted_option_);
-  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    if (from.has_message_set_wire_format()) {
-      set_message_set_wire_format(from.message_set_wire_format());
-    }
-    if (from.has_no_standard_descriptor_accessor()) {
-      set_no_standard_descriptor_accessor(from.no_standard_descriptor_accessor());
+  if ((from._has_bits_[0] & 0x00000003u) == 0x00000003u) {
+    ::memcpy(&message_set_wire_format_, &from.message_set_wire_format_,
+      reinterpret_cast<const char*>(&no_standard_descriptor_accessor_ + 1) -
+      reinterpret_cast<const char*>(&message_set_wire_format_));
+    _has_bits_[0] |= 0x00000003u;
+  } else {
+    if (from._has_bits_[0] & 0x00000003u) {
+      if (from.has_message_set_wire_format()) {
+        set_message_set_wire_format(from.message_set_wire_format());
+      }
+      if (from.has_no_standard_descriptor_accessor()) {
+        set_no_standard_descriptor_accessor(from.no_standard_descriptor_accessor());
+      }
     }
   }
+  MergeFromExceptScalarBlock(from);
+}
+
+void MessageOptions::MergeFromExceptScalarBlock(const MessageOptions& from) {
+  uninterpreted_option_.MergeFrom(from.uninterpreted_option_);
   _extensions_.MergeFrom(from._extensions_);
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
 
 void MessageOptions::CopyFrom(const ::google::protobuf::Message& from) {
   if (&from == this) return;
-  Clear();
-  MergeFrom(from);
+  const MessageOptions* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const MessageOptions*>(
+      &from);
+  if (source == NULL) {
+    Clear();
+    MergeFrom(from);
+  } else {
+    CopyFrom(*source);
+  }
 }
 
 void MessageOptions::CopyFrom(const MessageOptions& from) {
   if (&from == this) return;
   Clear();
-  MergeFrom(from);
+  ::memcpy(&message_set_wire_format_, &from.message_set_wire_format_,
+    reinterpret_cast<const char*>(&no_standard_descriptor_accessor_ + 1) -
+    reinterpret_cast<const char*>(&message_set_wire_format_));
+  _has_bits_[0] |= from._has_bits_[0] & 0x00000003u;
+  MergeFromExceptScalarBlock(from);
 }
 
 bool MessageOptions::IsInitialized() const {
@@ -5207,10 +5374,16 @@ const ::google::protobuf::Descriptor* FieldOptions::descriptor() {
 }
 
 const FieldOptions& FieldOptions::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-FieldOptions* FieldOptions::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<FieldOptions>
+  FieldOptions_default_instance_storage_;
+}  // namespace
+FieldOptions* FieldOptions::default_instance_ =
+  reinterpret_cast<FieldOptions*>(&FieldOptions_default_instance_storage_);
 
 FieldOptions* FieldOptions::New() const {
   return new FieldOptions;
@@ -5218,10 +5391,12 @@ FieldOptions* FieldOptions::New() const {
 
 void FieldOptions::Clear() {
   _extensions_.Clear();
-  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    ctype_ = 0;
-    packed_ = false;
-    deprecated_ = false;
+  if ((_has_bits_[0] & 0x00000007u) != 0) {
+    ::memset(&ctype_, 0,
+      reinterpret_cast<char*>(&deprecated_ + 1) -
+      reinterpret_cast<char*>(&ctype_));
+  }
+  if (_has_bits_[3 / 32] & (0xffu << (3 % 32))) {
     if (has_experimental_map_key()) {
       if (experimental_map_key_ != &::google::protobuf::internal::kEmptyString) {
         experimental_map_key_->clear();
@@ -5496,17 +5671,30 @@ void FieldOptions::MergeFrom(const ::google::protobuf::Message& from) {
 
 void FieldOptions::MergeFrom(const FieldOptions& from) {
   GOOGLE_CHECK_NE(&from, this);
-  uninterpreted_option_.MergeFrom(from.uninterpreted_option_);
-  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    if (from.has_ctype()) {
-      set_ctype(from.ctype());
-    }
-    if (from.has_packed()) {
-      set_packed(from.packed());
-    }
-    if (from.has_deprecated()) {
-      set_deprecated(from.deprecated());
+  if ((from._has_bits_[0] & 0x00000007u) == 0x00000007u) {
+    ::memcpy(&ctype_, &from.ctype_,
+      reinterpret_cast<const char*>(&deprecated_ + 1) -
+      reinterpret_cast<const char*>(&ctype_));
+    _has_bits_[0] |= 0x00000007u;
+  } else {
+    if (from._has_bits_[0] & 0x00000007u) {
+      if (from.has_ctype()) {
+        set_ctype(from.ctype());
+      }
+      if (from.has_packed()) {
+        set_packed(from.packed());
+      }
+      if (from.has_deprecated()) {
+        set_deprecated(from.deprecated());
+      }
     }
+  }
+  MergeFromExceptScalarBlock(from);
+}
+
+void FieldOptions::MergeFromExceptScalarBlock(const FieldOptions& from) {
+  uninterpreted_option_.MergeFrom(from.uninterpreted_option_);
+  if (from._has_bits_[3 / 32] & (0xffu << (3 % 32))) {
     if (from.has_experimental_map_key()) {
       set_experimental_map_key(from.experimental_map_key());
     }
@@ -5517,14 +5705,25 @@ void FieldOptions::MergeFrom(const FieldOptions& from) {
 
 void FieldOptions::CopyFrom(const ::google::protobuf::Message& from) {
   if (&from == this) return;
-  Clear();
-  MergeFrom(from);
+  const FieldOptions* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const FieldOptions*>(
+      &from);
+  if (source == NULL) {
+    Clear();
+    MergeFrom(from);
+  } else {
+    CopyFrom(*source);
+  }
 }
 
 void FieldOptions::CopyFrom(const FieldOptions& from) {
   if (&from == this) return;
   Clear();
-  MergeFrom(from);
+  ::memcpy(&ctype_, &from.ctype_,
+    reinterpret_cast<const char*>(&deprecated_ + 1) -
+    reinterpret_cast<const char*>(&ctype_));
+  _has_bits_[0] |= from._has_bits_[0] & 0x00000007u;
+  MergeFromExceptScalarBlock(from);
 }
 
 bool FieldOptions::IsInitialized() const {
@@ -5604,10 +5803,16 @@ const ::google::protobuf::Descriptor* EnumOptions::descriptor() {
 }
 
 const EnumOptions& EnumOptions::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-EnumOptions* EnumOptions::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<EnumOptions>
+  EnumOptions_default_instance_storage_;
+}  // namespace
+EnumOptions* EnumOptions::default_instance_ =
+  reinterpret_cast<EnumOptions*>(&EnumOptions_default_instance_storage_);
 
 EnumOptions* EnumOptions::New() const {
   return new EnumOptions;
@@ -5828,10 +6033,16 @@ const ::google::protobuf::Descriptor* EnumValueOptions::descriptor() {
 }
 
 const EnumValueOptions& EnumValueOptions::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-EnumValueOptions* EnumValueOptions::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<EnumValueOptions>
+  EnumValueOptions_default_instance_storage_;
+}  // namespace
+EnumValueOptions* EnumValueOptions::default_instance_ =
+  reinterpret_cast<EnumValueOptions*>(&EnumValueOptions_default_instance_storage_);
 
 EnumValueOptions* EnumValueOptions::New() const {
   return new EnumValueOptions;
@@ -6052,10 +6263,16 @@ const ::google::protobuf::Descriptor* ServiceOptions::descriptor() {
 }
 
 const ServiceOptions& ServiceOptions::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-ServiceOptions* ServiceOptions::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<ServiceOptions>
+  ServiceOptions_default_instance_storage_;
+}  // namespace
+ServiceOptions* ServiceOptions::default_instance_ =
+  reinterpret_cast<ServiceOptions*>(&ServiceOptions_default_instance_storage_);
 
 ServiceOptions* ServiceOptions::New() const {
   return new ServiceOptions;
@@ -6276,10 +6493,16 @@ const ::google::protobuf::Descriptor* MethodOptions::descriptor() {
 }
 
 const MethodOptions& MethodOptions::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-MethodOptions* MethodOptions::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<MethodOptions>
+  MethodOptions_default_instance_storage_;
+}  // namespace
+MethodOptions* MethodOptions::default_instance_ =
+  reinterpret_cast<MethodOptions*>(&MethodOptions_default_instance_storage_);
 
 MethodOptions* MethodOptions::New() const {
   return new MethodOptions;
@@ -6506,10 +6729,16 @@ const ::google::protobuf::Descriptor* UninterpretedOption_NamePart::descriptor()
 }
 
 const UninterpretedOption_NamePart& UninterpretedOption_NamePart::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-UninterpretedOption_NamePart* UninterpretedOption_NamePart::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<UninterpretedOption_NamePart>
+  UninterpretedOption_NamePart_default_instance_storage_;
+}  // namespace
+UninterpretedOption_NamePart* UninterpretedOption_NamePart::default_instance_ =
+  reinterpret_cast<UninterpretedOption_NamePart*>(&UninterpretedOption_NamePart_default_instance_storage_);
 
 UninterpretedOption_NamePart* UninterpretedOption_NamePart::New() const {
   return new UninterpretedOption_NamePart;
@@ -6784,25 +7013,33 @@ const ::google::protobuf::Descriptor* UninterpretedOption::descriptor() {
 }
 
 const UninterpretedOption& UninterpretedOption::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-UninterpretedOption* UninterpretedOption::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<UninterpretedOption>
+  UninterpretedOption_default_instance_storage_;
+}  // namespace
+UninterpretedOption* UninterpretedOption::default_instance_ =
+  reinterpret_cast<UninterpretedOption*>(&UninterpretedOption_default_instance_storage_);
 
 UninterpretedOption* UninterpretedOption::New() const {
   return new UninterpretedOption;
 }
 
 void UninterpretedOption::Clear() {
+  if ((_has_bits_[0] & 0x0000001cu) != 0) {
+    ::memset(&positive_int_value_, 0,
+      reinterpret_cast<char*>(&double_value_ + 1) -
+      reinterpret_cast<char*>(&positive_int_value_));
+  }
   if (_has_bits_[1 / 32] & (0xffu << (1 % 32))) {
     if (has_identifier_value()) {
       if (identifier_value_ != &::google::protobuf::internal::kEmptyString) {
         identifier_value_->clear();
       }
     }
-    positive_int_value_ = GOOGLE_ULONGLONG(0);
-    negative_int_value_ = GOOGLE_LONGLONG(0);
-    double_value_ = 0;
     if (has_string_value()) {
       if (string_value_ != &::google::protobuf::internal::kEmptyString) {
         string_value_->clear();
@@ -7141,20 +7378,33 @@ void UninterpretedOption::MergeFrom(const ::google::protobuf::Message& from) {
 
 void UninterpretedOption::MergeFrom(const UninterpretedOption& from) {
   GOOGLE_CHECK_NE(&from, this);
+  if ((from._has_bits_[0] & 0x0000001cu) == 0x0000001cu) {
+    ::memcpy(&positive_int_value_, &from.positive_int_value_,
+      reinterpret_cast<const char*>(&double_value_ + 1) -
+      reinterpret_cast<const char*>(&positive_int_value_));
+    _has_bits_[0] |= 0x0000001cu;
+  } else {
+    if (from._has_bits_[0] & 0x0000001cu) {
+      if (from.has_positive_int_value()) {
+        set_positive_int_value(from.positive_int_value());
+      }
+      if (from.has_negative_int_value()) {
+        set_negative_int_value(from.negative_int_value());
+      }
+      if (from.has_double_value()) {
+        set_double_value(from.double_value());
+      }
+    }
+  }
+  MergeFromExceptScalarBlock(from);
+}
+
+void UninterpretedOption::MergeFromExceptScalarBlock(const UninterpretedOption& from) {
   name_.MergeFrom(from.name_);
   if (from._has_bits_[1 / 32] & (0xffu << (1 % 32))) {
     if (from.has_identifier_value()) {
       set_identifier_value(from.identifier_value());
     }
-    if (from.has_positive_int_value()) {
-      set_positive_int_value(from.positive_int_value());
-    }
-    if (from.has_negative_int_value()) {
-      set_negative_int_value(from.negative_int_value());
-    }
-    if (from.has_double_value()) {
-      set_double_value(from.double_value());
-    }
     if (from.has_string_value()) {
       set_string_value(from.string_value());
     }
@@ -7167,14 +7417,25 @@ void UninterpretedOption::MergeFrom(const UninterpretedOption& from) {
 
 void UninterpretedOption::CopyFrom(const ::google::protobuf::Message& from) {
   if (&from == this) return;
-  Clear();
-  MergeFrom(from);
+  const UninterpretedOption* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const UninterpretedOption*>(
+      &from);
+  if (source == NULL) {
+    Clear();
+    MergeFrom(from);
+  } else {
+    CopyFrom(*source);
+  }
 }
 
 void UninterpretedOption::CopyFrom(const UninterpretedOption& from) {
   if (&from == this) return;
   Clear();
-  MergeFrom(from);
+  ::memcpy(&positive_int_value_, &from.positive_int_value_,
+    reinterpret_cast<const char*>(&double_value_ + 1) -
+    reinterpret_cast<const char*>(&positive_int_value_));
+  _has_bits_[0] |= from._has_bits_[0] & 0x0000001cu;
+  MergeFromExceptScalarBlock(from);
 }
 
 bool UninterpretedOption::IsInitialized() const {
@@ -7255,10 +7516,16 @@ const ::google::protobuf::Descriptor* SourceCodeInfo_Location::descriptor() {
 }
 
 const SourceCodeInfo_Location& SourceCodeInfo_Location::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-SourceCodeInfo_Location* SourceCodeInfo_Location::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<SourceCodeInfo_Location>
+  SourceCodeInfo_Location_default_instance_storage_;
+}  // namespace
+SourceCodeInfo_Location* SourceCodeInfo_Location::default_instance_ =
+  reinterpret_cast<SourceCodeInfo_Location*>(&SourceCodeInfo_Location_default_instance_storage_);
 
 SourceCodeInfo_Location* SourceCodeInfo_Location::New() const {
   return new SourceCodeInfo_Location;
@@ -7543,10 +7810,16 @@ const ::google::protobuf::Descriptor* SourceCodeInfo::descriptor() {
 }
 
 const SourceCodeInfo& SourceCodeInfo::default_instance() {
-  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+  protobuf_InitDefaultsOnce();
+  return *default_instance_;
 }
 
-SourceCodeInfo* SourceCodeInfo::default_instance_ = NULL;
+namespace {
+::google::protobuf::internal::StaticStorage<SourceCodeInfo>
+  SourceCodeInfo_default_instance_storage_;
+}  // namespace
+SourceCodeInfo* SourceCodeInfo::default_instance_ =
+  reinterpret_cast<SourceCodeInfo*>(&SourceCodeInfo_default_instance_storage_);
 
 SourceCodeInfo* SourceCodeInfo::New() const {
   return new SourceCodeInfo;
@@ -30,6 +30,7 @@ namespace protobuf {
 
 // Internal implementation detail -- do not call these.
 void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
 void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
 void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
 
@@ -174,11 +175,20 @@ class LIBPROTOBUF_EXPORT FileDescriptorSet : public ::google::protobuf::Message
   static const ::google::protobuf::Descriptor* descriptor();
   static const FileDescriptorSet& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const FileDescriptorSet* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(FileDescriptorSet* other);
   
   // implements Message ----------------------------------------------
   
   FileDescriptorSet* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const FileDescriptorSet& from);
@@ -228,6 +238,7 @@ class LIBPROTOBUF_EXPORT FileDescriptorSet : public ::google::protobuf::Message
   ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -259,11 +270,20 @@ class LIBPROTOBUF_EXPORT FileDescriptorProto : public ::google::protobuf::Messag
   static const ::google::protobuf::Descriptor* descriptor();
   static const FileDescriptorProto& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const FileDescriptorProto* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(FileDescriptorProto* other);
   
   // implements Message ----------------------------------------------
   
   FileDescriptorProto* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const FileDescriptorProto& from);
@@ -419,6 +439,7 @@ class LIBPROTOBUF_EXPORT FileDescriptorProto : public ::google::protobuf::Messag
   ::google::protobuf::uint32 _has_bits_[(9 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -450,11 +471,20 @@ class LIBPROTOBUF_EXPORT DescriptorProto_ExtensionRange : public ::google::proto
   static const ::google::protobuf::Descriptor* descriptor();
   static const DescriptorProto_ExtensionRange& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const DescriptorProto_ExtensionRange* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(DescriptorProto_ExtensionRange* other);
   
   // implements Message ----------------------------------------------
   
   DescriptorProto_ExtensionRange* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const DescriptorProto_ExtensionRange& from);
@@ -473,6 +503,7 @@ class LIBPROTOBUF_EXPORT DescriptorProto_ExtensionRange : public ::google::proto
   void SharedCtor();
   void SharedDtor();
   void SetCachedSize(int size) const;
+  void MergeFromExceptScalarBlock(const DescriptorProto_ExtensionRange& from);
   public:
   
   ::google::protobuf::Metadata GetMetadata() const;
@@ -511,6 +542,7 @@ class LIBPROTOBUF_EXPORT DescriptorProto_ExtensionRange : public ::google::proto
   ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -542,11 +574,20 @@ class LIBPROTOBUF_EXPORT DescriptorProto : public ::google::protobuf::Message {
   static const ::google::protobuf::Descriptor* descriptor();
   static const DescriptorProto& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const DescriptorProto* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(DescriptorProto* other);
   
   // implements Message ----------------------------------------------
   
   DescriptorProto* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const DescriptorProto& from);
@@ -675,6 +716,7 @@ class LIBPROTOBUF_EXPORT DescriptorProto : public ::google::protobuf::Message {
   ::google::protobuf::uint32 _has_bits_[(7 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -706,11 +748,20 @@ class LIBPROTOBUF_EXPORT FieldDescriptorProto : public ::google::protobuf::Messa
   static const ::google::protobuf::Descriptor* descriptor();
   static const FieldDescriptorProto& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const FieldDescriptorProto* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(FieldDescriptorProto* other);
   
   // implements Message ----------------------------------------------
   
   FieldDescriptorProto* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const FieldDescriptorProto& from);
@@ -909,6 +960,7 @@ class LIBPROTOBUF_EXPORT FieldDescriptorProto : public ::google::protobuf::Messa
   ::google::protobuf::uint32 _has_bits_[(8 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -940,11 +992,20 @@ class LIBPROTOBUF_EXPORT EnumDescriptorProto : public ::google::protobuf::Messag
   static const ::google::protobuf::Descriptor* descriptor();
   static const EnumDescriptorProto& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const EnumDescriptorProto* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(EnumDescriptorProto* other);
   
   // implements Message ----------------------------------------------
   
   EnumDescriptorProto* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const EnumDescriptorProto& from);
@@ -1019,6 +1080,7 @@ class LIBPROTOBUF_EXPORT EnumDescriptorProto : public ::google::protobuf::Messag
   ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -1050,11 +1112,20 @@ class LIBPROTOBUF_EXPORT EnumValueDescriptorProto : public ::google::protobuf::M
   static const ::google::protobuf::Descriptor* descriptor();
   static const EnumValueDescriptorProto& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const EnumValueDescriptorProto* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(EnumValueDescriptorProto* other);
   
   // implements Message ----------------------------------------------
   
   EnumValueDescriptorProto* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const EnumValueDescriptorProto& from);
@@ -1126,6 +1197,7 @@ class LIBPROTOBUF_EXPORT EnumValueDescriptorProto : public ::google::protobuf::M
   ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -1157,11 +1229,20 @@ class LIBPROTOBUF_EXPORT ServiceDescriptorProto : public ::google::protobuf::Mes
   static const ::google::protobuf::Descriptor* descriptor();
   static const ServiceDescriptorProto& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const ServiceDescriptorProto* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(ServiceDescriptorProto* other);
   
   // implements Message ----------------------------------------------
   
   ServiceDescriptorProto* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const ServiceDescriptorProto& from);
@@ -1236,6 +1317,7 @@ class LIBPROTOBUF_EXPORT ServiceDescriptorProto : public ::google::protobuf::Mes
   ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -1267,11 +1349,20 @@ class LIBPROTOBUF_EXPORT MethodDescriptorProto : public ::google::protobuf::Mess
   static const ::google::protobuf::Descriptor* descriptor();
   static const MethodDescriptorProto& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const MethodDescriptorProto* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(MethodDescriptorProto* other);
   
   // implements Message ----------------------------------------------
   
   MethodDescriptorProto* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const MethodDescriptorProto& from);
@@ -1361,6 +1452,7 @@ class LIBPROTOBUF_EXPORT MethodDescriptorProto : public ::google::protobuf::Mess
   ::google::protobuf::uint32 _has_bits_[(4 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -1392,11 +1484,20 @@ class LIBPROTOBUF_EXPORT FileOptions : public ::google::protobuf::Message {
   static const ::google::protobuf::Descriptor* descriptor();
   static const FileOptions& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const FileOptions* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(FileOptions* other);
   
   // implements Message ----------------------------------------------
   
   FileOptions* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const FileOptions& from);
@@ -1415,6 +1516,7 @@ class LIBPROTOBUF_EXPORT FileOptions : public ::google::protobuf::Message {
   void SharedCtor();
   void SharedDtor();
   void SetCachedSize(int size) const;
+  void MergeFromExceptScalarBlock(const FileOptions& from);
   public:
   
   ::google::protobuf::Metadata GetMetadata() const;
@@ -1550,18 +1652,19 @@ class LIBPROTOBUF_EXPORT FileOptions : public ::google::protobuf::Message {
   
   ::std::string* java_package_;
   ::std::string* java_outer_classname_;
+  ::google::protobuf::RepeatedPtrField< ::google::protobuf::UninterpretedOption > uninterpreted_option_;
   int optimize_for_;
   bool java_multiple_files_;
   bool java_generate_equals_and_hash_;
   bool cc_generic_services_;
   bool java_generic_services_;
-  ::google::protobuf::RepeatedPtrField< ::google::protobuf::UninterpretedOption > uninterpreted_option_;
   bool py_generic_services_;
   
   mutable int _cached_size_;
   ::google::protobuf::uint32 _has_bits_[(9 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -1593,11 +1696,20 @@ class LIBPROTOBUF_EXPORT MessageOptions : public ::google::protobuf::Message {
   static const ::google::protobuf::Descriptor* descriptor();
   static const MessageOptions& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const MessageOptions* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(MessageOptions* other);
   
   // implements Message ----------------------------------------------
   
   MessageOptions* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const MessageOptions& from);
@@ -1616,6 +1728,7 @@ class LIBPROTOBUF_EXPORT MessageOptions : public ::google::protobuf::Message {
   void SharedCtor();
   void SharedDtor();
   void SetCachedSize(int size) const;
+  void MergeFromExceptScalarBlock(const MessageOptions& from);
   public:
   
   ::google::protobuf::Metadata GetMetadata() const;
@@ -1670,6 +1783,7 @@ class LIBPROTOBUF_EXPORT MessageOptions : public ::google::protobuf::Message {
   ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -1701,11 +1815,20 @@ class LIBPROTOBUF_EXPORT FieldOptions : public ::google::protobuf::Message {
   static const ::google::protobuf::Descriptor* descriptor();
   static const FieldOptions& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const FieldOptions* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(FieldOptions* other);
   
   // implements Message ----------------------------------------------
   
   FieldOptions* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const FieldOptions& from);
@@ -1724,6 +1847,7 @@ class LIBPROTOBUF_EXPORT FieldOptions : public ::google::protobuf::Message {
   void SharedCtor();
   void SharedDtor();
   void SetCachedSize(int size) const;
+  void MergeFromExceptScalarBlock(const FieldOptions& from);
   public:
   
   ::google::protobuf::Metadata GetMetadata() const;
@@ -1817,16 +1941,17 @@ class LIBPROTOBUF_EXPORT FieldOptions : public ::google::protobuf::Message {
   
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
   
+  ::std::string* experimental_map_key_;
+  ::google::protobuf::RepeatedPtrField< ::google::protobuf::UninterpretedOption > uninterpreted_option_;
   int ctype_;
   bool packed_;
   bool deprecated_;
-  ::std::string* experimental_map_key_;
-  ::google::protobuf::RepeatedPtrField< ::google::protobuf::UninterpretedOption > uninterpreted_option_;
   
   mutable int _cached_size_;
   ::google::protobuf::uint32 _has_bits_[(5 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -1858,11 +1983,20 @@ class LIBPROTOBUF_EXPORT EnumOptions : public ::google::protobuf::Message {
   static const ::google::protobuf::Descriptor* descriptor();
   static const EnumOptions& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const EnumOptions* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(EnumOptions* other);
   
   // implements Message ----------------------------------------------
   
   EnumOptions* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const EnumOptions& from);
@@ -1915,6 +2049,7 @@ class LIBPROTOBUF_EXPORT EnumOptions : public ::google::protobuf::Message {
   ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -1946,11 +2081,20 @@ class LIBPROTOBUF_EXPORT EnumValueOptions : public ::google::protobuf::Message {
   static const ::google::protobuf::Descriptor* descriptor();
   static const EnumValueOptions& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const EnumValueOptions* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(EnumValueOptions* other);
   
   // implements Message ----------------------------------------------
   
   EnumValueOptions* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const EnumValueOptions& from);
@@ -2003,6 +2147,7 @@ class LIBPROTOBUF_EXPORT EnumValueOptions : public ::google::protobuf::Message {
   ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -2034,11 +2179,20 @@ class LIBPROTOBUF_EXPORT ServiceOptions : public ::google::protobuf::Message {
   static const ::google::protobuf::Descriptor* descriptor();
   static const ServiceOptions& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const ServiceOptions* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(ServiceOptions* other);
   
   // implements Message ----------------------------------------------
   
   ServiceOptions* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const ServiceOptions& from);
@@ -2091,6 +2245,7 @@ class LIBPROTOBUF_EXPORT ServiceOptions : public ::google::protobuf::Message {
   ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -2122,11 +2277,20 @@ class LIBPROTOBUF_EXPORT MethodOptions : public ::google::protobuf::Message {
   static const ::google::protobuf::Descriptor* descriptor();
   static const MethodOptions& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const MethodOptions* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(MethodOptions* other);
   
   // implements Message ----------------------------------------------
   
   MethodOptions* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const MethodOptions& from);
@@ -2179,6 +2343,7 @@ class LIBPROTOBUF_EXPORT MethodOptions : public ::google::protobuf::Message {
   ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -2210,11 +2375,20 @@ class LIBPROTOBUF_EXPORT UninterpretedOption_NamePart : public ::google::protobu
   static const ::google::protobuf::Descriptor* descriptor();
   static const UninterpretedOption_NamePart& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const UninterpretedOption_NamePart* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(UninterpretedOption_NamePart* other);
   
   // implements Message ----------------------------------------------
   
   UninterpretedOption_NamePart* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const UninterpretedOption_NamePart& from);
@@ -2275,6 +2449,7 @@ class LIBPROTOBUF_EXPORT UninterpretedOption_NamePart : public ::google::protobu
   ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -2306,11 +2481,20 @@ class LIBPROTOBUF_EXPORT UninterpretedOption : public ::google::protobuf::Messag
   static const ::google::protobuf::Descriptor* descriptor();
   static const UninterpretedOption& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const UninterpretedOption* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(UninterpretedOption* other);
   
   // implements Message ----------------------------------------------
   
   UninterpretedOption* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const UninterpretedOption& from);
@@ -2329,6 +2513,7 @@ class LIBPROTOBUF_EXPORT UninterpretedOption : public ::google::protobuf::Messag
   void SharedCtor();
   void SharedDtor();
   void SetCachedSize(int size) const;
+  void MergeFromExceptScalarBlock(const UninterpretedOption& from);
   public:
   
   ::google::protobuf::Metadata GetMetadata() const;
@@ -2424,16 +2609,17 @@ class LIBPROTOBUF_EXPORT UninterpretedOption : public ::google::protobuf::Messag
   
   ::google::protobuf::RepeatedPtrField< ::google::protobuf::UninterpretedOption_NamePart > name_;
   ::std::string* identifier_value_;
+  ::std::string* string_value_;
+  ::std::string* aggregate_value_;
   ::google::protobuf::uint64 positive_int_value_;
   ::google::protobuf::int64 negative_int_value_;
   double double_value_;
-  ::std::string* string_value_;
-  ::std::string* aggregate_value_;
   
   mutable int _cached_size_;
   ::google::protobuf::uint32 _has_bits_[(7 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -2465,11 +2651,20 @@ class LIBPROTOBUF_EXPORT SourceCodeInfo_Location : public ::google::protobuf::Me
   static const ::google::protobuf::Descriptor* descriptor();
   static const SourceCodeInfo_Location& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const SourceCodeInfo_Location* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(SourceCodeInfo_Location* other);
   
   // implements Message ----------------------------------------------
   
   SourceCodeInfo_Location* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const SourceCodeInfo_Location& from);
@@ -2534,6 +2729,7 @@ class LIBPROTOBUF_EXPORT SourceCodeInfo_Location : public ::google::protobuf::Me
   ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -2565,11 +2761,20 @@ class LIBPROTOBUF_EXPORT SourceCodeInfo : public ::google::protobuf::Message {
   static const ::google::protobuf::Descriptor* descriptor();
   static const SourceCodeInfo& default_instance();
   
+  // Returns the default instance without initializing it.  Only for use
+  // by generated code of the same .proto file.
+  static inline const SourceCodeInfo* internal_default_instance() {
+    return default_instance_;
+  }
+  
   void Swap(SourceCodeInfo* other);
   
   // implements Message ----------------------------------------------
   
   SourceCodeInfo* New() const;
+  const ::google::protobuf::MessageLite* GetPrototype() const {
+    return &default_instance();
+  }
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
   void CopyFrom(const SourceCodeInfo& from);
@@ -2621,6 +2826,7 @@ class LIBPROTOBUF_EXPORT SourceCodeInfo : public ::google::protobuf::Message {
   ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
   
   friend void LIBPROTOBUF_EXPORT protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  friend void protobuf_InitDefaults_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto();
   friend void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto();
   
@@ -2685,28 +2891,28 @@ inline const ::std::string& FileDescriptorProto::name() const {
 inline void FileDescriptorProto::set_name(const ::std::string& value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void FileDescriptorProto::set_name(const char* value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void FileDescriptorProto::set_name(const char* value, size_t size) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* FileDescriptorProto::mutable_name() {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   return name_;
 }
@@ -2743,28 +2949,28 @@ inline const ::std::string& FileDescriptorProto::package() const {
 inline void FileDescriptorProto::set_package(const ::std::string& value) {
   set_has_package();
   if (package_ == &::google::protobuf::internal::kEmptyString) {
-    package_ = new ::std::string;
+    package_ = ::google::protobuf::internal::NewString();
   }
   package_->assign(value);
 }
 inline void FileDescriptorProto::set_package(const char* value) {
   set_has_package();
   if (package_ == &::google::protobuf::internal::kEmptyString) {
-    package_ = new ::std::string;
+    package_ = ::google::protobuf::internal::NewString();
   }
   package_->assign(value);
 }
 inline void FileDescriptorProto::set_package(const char* value, size_t size) {
   set_has_package();
   if (package_ == &::google::protobuf::internal::kEmptyString) {
-    package_ = new ::std::string;
+    package_ = ::google::protobuf::internal::NewString();
   }
   package_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* FileDescriptorProto::mutable_package() {
   set_has_package();
   if (package_ == &::google::protobuf::internal::kEmptyString) {
-    package_ = new ::std::string;
+    package_ = ::google::protobuf::internal::NewString();
   }
   return package_;
 }
@@ -2938,7 +3144,7 @@ inline void FileDescriptorProto::clear_options() {
   clear_has_options();
 }
 inline const ::google::protobuf::FileOptions& FileDescriptorProto::options() const {
-  return options_ != NULL ? *options_ : *default_instance_->options_;
+  return options_ != NULL ? *options_ : ::google::protobuf::FileOptions::default_instance();
 }
 inline ::google::protobuf::FileOptions* FileDescriptorProto::mutable_options() {
   set_has_options();
@@ -2967,7 +3173,7 @@ inline void FileDescriptorProto::clear_source_code_info() {
   clear_has_source_code_info();
 }
 inline const ::google::protobuf::SourceCodeInfo& FileDescriptorProto::source_code_info() const {
-  return source_code_info_ != NULL ? *source_code_info_ : *default_instance_->source_code_info_;
+  return source_code_info_ != NULL ? *source_code_info_ : ::google::protobuf::SourceCodeInfo::default_instance();
 }
 inline ::google::protobuf::SourceCodeInfo* FileDescriptorProto::mutable_source_code_info() {
   set_has_source_code_info();
@@ -3055,28 +3261,28 @@ inline const ::std::string& DescriptorProto::name() const {
 inline void DescriptorProto::set_name(const ::std::string& value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void DescriptorProto::set_name(const char* value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void DescriptorProto::set_name(const char* value, size_t size) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* DescriptorProto::mutable_name() {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   return name_;
 }
@@ -3231,7 +3437,7 @@ inline void DescriptorProto::clear_options() {
   clear_has_options();
 }
 inline const ::google::protobuf::MessageOptions& DescriptorProto::options() const {
-  return options_ != NULL ? *options_ : *default_instance_->options_;
+  return options_ != NULL ? *options_ : ::google::protobuf::MessageOptions::default_instance();
 }
 inline ::google::protobuf::MessageOptions* DescriptorProto::mutable_options() {
   set_has_options();
@@ -3271,28 +3477,28 @@ inline const ::std::string& FieldDescriptorProto::name() const {
 inline void FieldDescriptorProto::set_name(const ::std::string& value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void FieldDescriptorProto::set_name(const char* value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void FieldDescriptorProto::set_name(const char* value, size_t size) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* FieldDescriptorProto::mutable_name() {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   return name_;
 }
@@ -3397,28 +3603,28 @@ inline const ::std::string& FieldDescriptorProto::type_name() const {
 inline void FieldDescriptorProto::set_type_name(const ::std::string& value) {
   set_has_type_name();
   if (type_name_ == &::google::protobuf::internal::kEmptyString) {
-    type_name_ = new ::std::string;
+    type_name_ = ::google::protobuf::internal::NewString();
   }
   type_name_->assign(value);
 }
 inline void FieldDescriptorProto::set_type_name(const char* value) {
   set_has_type_name();
   if (type_name_ == &::google::protobuf::internal::kEmptyString) {
-    type_name_ = new ::std::string;
+    type_name_ = ::google::protobuf::internal::NewString();
   }
   type_name_->assign(value);
 }
 inline void FieldDescriptorProto::set_type_name(const char* value, size_t size) {
   set_has_type_name();
   if (type_name_ == &::google::protobuf::internal::kEmptyString) {
-    type_name_ = new ::std::string;
+    type_name_ = ::google::protobuf::internal::NewString();
   }
   type_name_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* FieldDescriptorProto::mutable_type_name() {
   set_has_type_name();
   if (type_name_ == &::google::protobuf::internal::kEmptyString) {
-    type_name_ = new ::std::string;
+    type_name_ = ::google::protobuf::internal::NewString();
   }
   return type_name_;
 }
@@ -3455,28 +3661,28 @@ inline const ::std::string& FieldDescriptorProto::extendee() const {
 inline void FieldDescriptorProto::set_extendee(const ::std::string& value) {
   set_has_extendee();
   if (extendee_ == &::google::protobuf::internal::kEmptyString) {
-    extendee_ = new ::std::string;
+    extendee_ = ::google::protobuf::internal::NewString();
   }
   extendee_->assign(value);
 }
 inline void FieldDescriptorProto::set_extendee(const char* value) {
   set_has_extendee();
   if (extendee_ == &::google::protobuf::internal::kEmptyString) {
-    extendee_ = new ::std::string;
+    extendee_ = ::google::protobuf::internal::NewString();
   }
   extendee_->assign(value);
 }
 inline void FieldDescriptorProto::set_extendee(const char* value, size_t size) {
   set_has_extendee();
   if (extendee_ == &::google::protobuf::internal::kEmptyString) {
-    extendee_ = new ::std::string;
+    extendee_ = ::google::protobuf::internal::NewString();
   }
   extendee_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* FieldDescriptorProto::mutable_extendee() {
   set_has_extendee();
   if (extendee_ == &::google::protobuf::internal::kEmptyString) {
-    extendee_ = new ::std::string;
+    extendee_ = ::google::protobuf::internal::NewString();
   }
   return extendee_;
 }
@@ -3513,28 +3719,28 @@ inline const ::std::string& FieldDescriptorProto::default_value() const {
 inline void FieldDescriptorProto::set_default_value(const ::std::string& value) {
   set_has_default_value();
   if (default_value_ == &::google::protobuf::internal::kEmptyString) {
-    default_value_ = new ::std::string;
+    default_value_ = ::google::protobuf::internal::NewString();
   }
   default_value_->assign(value);
 }
 inline void FieldDescriptorProto::set_default_value(const char* value) {
   set_has_default_value();
   if (default_value_ == &::google::protobuf::internal::kEmptyString) {
-    default_value_ = new ::std::string;
+    default_value_ = ::google::protobuf::internal::NewString();
   }
   default_value_->assign(value);
 }
 inline void FieldDescriptorProto::set_default_value(const char* value, size_t size) {
   set_has_default_value();
   if (default_value_ == &::google::protobuf::internal::kEmptyString) {
-    default_value_ = new ::std::string;
+    default_value_ = ::google::protobuf::internal::NewString();
   }
   default_value_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* FieldDescriptorProto::mutable_default_value() {
   set_has_default_value();
   if (default_value_ == &::google::protobuf::internal::kEmptyString) {
-    default_value_ = new ::std::string;
+    default_value_ = ::google::protobuf::internal::NewString();
   }
   return default_value_;
 }
@@ -3564,7 +3770,7 @@ inline void FieldDescriptorProto::clear_options() {
   clear_has_options();
 }
 inline const ::google::protobuf::FieldOptions& FieldDescriptorProto::options() const {
-  return options_ != NULL ? *options_ : *default_instance_->options_;
+  return options_ != NULL ? *options_ : ::google::protobuf::FieldOptions::default_instance();
 }
 inline ::google::protobuf::FieldOptions* FieldDescriptorProto::mutable_options() {
   set_has_options();
@@ -3604,28 +3810,28 @@ inline const ::std::string& EnumDescriptorProto::name() const {
 inline void EnumDescriptorProto::set_name(const ::std::string& value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void EnumDescriptorProto::set_name(const char* value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void EnumDescriptorProto::set_name(const char* value, size_t size) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* EnumDescriptorProto::mutable_name() {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   return name_;
 }
@@ -3680,7 +3886,7 @@ inline void EnumDescriptorProto::clear_options() {
   clear_has_options();
 }
 inline const ::google::protobuf::EnumOptions& EnumDescriptorProto::options() const {
-  return options_ != NULL ? *options_ : *default_instance_->options_;
+  return options_ != NULL ? *options_ : ::google::protobuf::EnumOptions::default_instance();
 }
 inline ::google::protobuf::EnumOptions* EnumDescriptorProto::mutable_options() {
   set_has_options();
@@ -3720,28 +3926,28 @@ inline const ::std::string& EnumValueDescriptorProto::name() const {
 inline void EnumValueDescriptorProto::set_name(const ::std::string& value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void EnumValueDescriptorProto::set_name(const char* value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void EnumValueDescriptorProto::set_name(const char* value, size_t size) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* EnumValueDescriptorProto::mutable_name() {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   return name_;
 }
@@ -3793,7 +3999,7 @@ inline void EnumValueDescriptorProto::clear_options() {
   clear_has_options();
 }
 inline const ::google::protobuf::EnumValueOptions& EnumValueDescriptorProto::options() const {
-  return options_ != NULL ? *options_ : *default_instance_->options_;
+  return options_ != NULL ? *options_ : ::google::protobuf::EnumValueOptions::default_instance();
 }
 inline ::google::protobuf::EnumValueOptions* EnumValueDescriptorProto::mutable_options() {
   set_has_options();
@@ -3833,28 +4039,28 @@ inline const ::std::string& ServiceDescriptorProto::name() const {
 inline void ServiceDescriptorProto::set_name(const ::std::string& value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void ServiceDescriptorProto::set_name(const char* value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void ServiceDescriptorProto::set_name(const char* value, size_t size) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* ServiceDescriptorProto::mutable_name() {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   return name_;
 }
@@ -3909,7 +4115,7 @@ inline void ServiceDescriptorProto::clear_options() {
   clear_has_options();
 }
 inline const ::google::protobuf::ServiceOptions& ServiceDescriptorProto::options() const {
-  return options_ != NULL ? *options_ : *default_instance_->options_;
+  return options_ != NULL ? *options_ : ::google::protobuf::ServiceOptions::default_instance();
 }
 inline ::google::protobuf::ServiceOptions* ServiceDescriptorProto::mutable_options() {
   set_has_options();
@@ -3949,28 +4155,28 @@ inline const ::std::string& MethodDescriptorProto::name() const {
 inline void MethodDescriptorProto::set_name(const ::std::string& value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void MethodDescriptorProto::set_name(const char* value) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(value);
 }
 inline void MethodDescriptorProto::set_name(const char* value, size_t size) {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   name_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* MethodDescriptorProto::mutable_name() {
   set_has_name();
   if (name_ == &::google::protobuf::internal::kEmptyString) {
-    name_ = new ::std::string;
+    name_ = ::google::protobuf::internal::NewString();
   }
   return name_;
 }
@@ -4007,28 +4213,28 @@ inline const ::std::string& MethodDescriptorProto::input_type() const {
 inline void MethodDescriptorProto::set_input_type(const ::std::string& value) {
   set_has_input_type();
   if (input_type_ == &::google::protobuf::internal::kEmptyString) {
-    input_type_ = new ::std::string;
+    input_type_ = ::google::protobuf::internal::NewString();
   }
   input_type_->assign(value);
 }
 inline void MethodDescriptorProto::set_input_type(const char* value) {
   set_has_input_type();
   if (input_type_ == &::google::protobuf::internal::kEmptyString) {
-    input_type_ = new ::std::string;
+    input_type_ = ::google::protobuf::internal::NewString();
   }
   input_type_->assign(value);
 }
 inline void MethodDescriptorProto::set_input_type(const char* value, size_t size) {
   set_has_input_type();
   if (input_type_ == &::google::protobuf::internal::kEmptyString) {
-    input_type_ = new ::std::string;
+    input_type_ = ::google::protobuf::internal::NewString();
   }
   input_type_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* MethodDescriptorProto::mutable_input_type() {
   set_has_input_type();
   if (input_type_ == &::google::protobuf::internal::kEmptyString) {
-    input_type_ = new ::std::string;
+    input_type_ = ::google::protobuf::internal::NewString();
   }
   return input_type_;
 }
@@ -4065,28 +4271,28 @@ inline const ::std::string& MethodDescriptorProto::output_type() const {
 inline void MethodDescriptorProto::set_output_type(const ::std::string& value) {
   set_has_output_type();
   if (output_type_ == &::google::protobuf::internal::kEmptyString) {
-    output_type_ = new ::std::string;
+    output_type_ = ::google::protobuf::internal::NewString();
   }
   output_type_->assign(value);
 }
 inline void MethodDescriptorProto::set_output_type(const char* value) {
   set_has_output_type();
   if (output_type_ == &::google::protobuf::internal::kEmptyString) {
-    output_type_ = new ::std::string;
+    output_type_ = ::google::protobuf::internal::NewString();
   }
   output_type_->assign(value);
 }
 inline void MethodDescriptorProto::set_output_type(const char* value, size_t size) {
   set_has_output_type();
   if (output_type_ == &::google::protobuf::internal::kEmptyString) {
-    output_type_ = new ::std::string;
+    output_type_ = ::google::protobuf::internal::NewString();
   }
   output_type_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* MethodDescriptorProto::mutable_output_type() {
   set_has_output_type();
   if (output_type_ == &::google::protobuf::internal::kEmptyString) {
-    output_type_ = new ::std::string;
+    output_type_ = ::google::protobuf::internal::NewString();
   }
   return output_type_;
 }
@@ -4116,7 +4322,7 @@ inline void MethodDescriptorProto::clear_options() {
   clear_has_options();
 }
 inline const ::google::protobuf::MethodOptions& MethodDescriptorProto::options() const {
-  return options_ != NULL ? *options_ : *default_instance_->options_;
+  return options_ != NULL ? *options_ : ::google::protobuf::MethodOptions::default_instance();
 }
 inline ::google::protobuf::MethodOptions* MethodDescriptorProto::mutable_options() {
   set_has_options();
@@ -4156,28 +4362,28 @@ inline const ::std::string& FileOptions::java_package() const {
 inline void FileOptions::set_java_package(const ::std::string& value) {
   set_has_java_package();
   if (java_package_ == &::google::protobuf::internal::kEmptyString) {
-    java_package_ = new ::std::string;
+    java_package_ = ::google::protobuf::internal::NewString();
   }
   java_package_->assign(value);
 }
 inline void FileOptions::set_java_package(const char* value) {
   set_has_java_package();
   if (java_package_ == &::google::protobuf::internal::kEmptyString) {
-    java_package_ = new ::std::string;
+    java_package_ = ::google::protobuf::internal::NewString();
   }
   java_package_->assign(value);
 }
 inline void FileOptions::set_java_package(const char* value, size_t size) {
   set_has_java_package();
   if (java_package_ == &::google::protobuf::internal::kEmptyString) {
-    java_package_ = new ::std::string;
+    java_package_ = ::google::protobuf::internal::NewString();
   }
   java_package_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* FileOptions::mutable_java_package() {
   set_has_java_package();
   if (java_package_ == &::google::protobuf::internal::kEmptyString) {
-    java_package_ = new ::std::string;
+    java_package_ = ::google::protobuf::internal::NewString();
   }
   return java_package_;
 }
@@ -4214,28 +4420,28 @@ inline const ::std::string& FileOptions::java_outer_classname() const {
 inline void FileOptions::set_java_outer_classname(const ::std::string& value) {
   set_has_java_outer_classname();
   if (java_outer_classname_ == &::google::protobuf::internal::kEmptyString) {
-    java_outer_classname_ = new ::std::string;
+    java_outer_classname_ = ::google::protobuf::internal::NewString();
   }
   java_outer_classname_->assign(value);
 }
 inline void FileOptions::set_java_outer_classname(const char* value) {
   set_has_java_outer_classname();
   if (java_outer_classname_ == &::google::protobuf::internal::kEmptyString) {
-    java_outer_classname_ = new ::std::string;
+    java_outer_classname_ = ::google::protobuf::internal::NewString();
   }
   java_outer_classname_->assign(value);
 }
 inline void FileOptions::set_java_outer_classname(const char* value, size_t size) {
   set_has_java_outer_classname();
   if (java_outer_classname_ == &::google::protobuf::internal::kEmptyString) {
-    java_outer_classname_ = new ::std::string;
+    java_outer_classname_ = ::google::protobuf::internal::NewString();
   }
   java_outer_classname_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* FileOptions::mutable_java_outer_classname() {
   set_has_java_outer_classname();
   if (java_outer_classname_ == &::google::protobuf::internal::kEmptyString) {
-    java_outer_classname_ = new ::std::string;
+    java_outer_classname_ = ::google::protobuf::internal::NewString();
   }
   return java_outer_classname_;
 }
@@ -4574,28 +4780,28 @@ inline const ::std::string& FieldOptions::experimental_map_key() const {
 inline void FieldOptions::set_experimental_map_key(const ::std::string& value) {
   set_has_experimental_map_key();
   if (experimental_map_key_ == &::google::protobuf::internal::kEmptyString) {
-    experimental_map_key_ = new ::std::string;
+    experimental_map_key_ = ::google::protobuf::internal::NewString();
   }
   experimental_map_key_->assign(value);
 }
 inline void FieldOptions::set_experimental_map_key(const char* value) {
   set_has_experimental_map_key();
   if (experimental_map_key_ == &::google::protobuf::internal::kEmptyString) {
-    experimental_map_key_ = new ::std::string;
+    experimental_map_key_ = ::google::protobuf::internal::NewString();
   }
   experimental_map_key_->assign(value);
 }
 inline void FieldOptions::set_experimental_map_key(const char* value, size_t size) {
   set_has_experimental_map_key();
   if (experimental_map_key_ == &::google::protobuf::internal::kEmptyString) {
-    experimental_map_key_ = new ::std::string;
+    experimental_map_key_ = ::google::protobuf::internal::NewString();
   }
   experimental_map_key_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* FieldOptions::mutable_experimental_map_key() {
   set_has_experimental_map_key();
   if (experimental_map_key_ == &::google::protobuf::internal::kEmptyString) {
-    experimental_map_key_ = new ::std::string;
+    experimental_map_key_ = ::google::protobuf::internal::NewString();
   }
   return experimental_map_key_;
 }
@@ -4777,28 +4983,28 @@ inline const ::std::string& UninterpretedOption_NamePart::name_part() const {
 inline void UninterpretedOption_NamePart::set_name_part(const ::std::string& value) {
   set_has_name_part();
   if (name_part_ == &::google::protobuf::internal::kEmptyString) {
-    name_part_ = new ::std::string;
+    name_part_ = ::google::protobuf::internal::NewString();
   }
   name_part_->assign(value);
 }
 inline void UninterpretedOption_NamePart::set_name_part(const char* value) {
   set_has_name_part();
   if (name_part_ == &::google::protobuf::internal::kEmptyString) {
-    name_part_ = new ::std::string;
+    name_part_ = ::google::protobuf::internal::NewString();
   }
   name_part_->assign(value);
 }
 inline void UninterpretedOption_NamePart::set_name_part(const char* value, size_t size) {
   set_has_name_part();
   if (name_part_ == &::google::protobuf::internal::kEmptyString) {
-    name_part_ = new ::std::string;
+    name_part_ = ::google::protobuf::internal::NewString();
   }
   name_part_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* UninterpretedOption_NamePart::mutable_name_part() {
   set_has_name_part();
   if (name_part_ == &::google::protobuf::internal::kEmptyString) {
-    name_part_ = new ::std::string;
+    name_part_ = ::google::protobuf::internal::NewString();
   }
   return name_part_;
 }
@@ -4886,28 +5092,28 @@ inline const ::std::string& UninterpretedOption::identifier_value() const {
 inline void UninterpretedOption::set_identifier_value(const ::std::string& value) {
   set_has_identifier_value();
   if (identifier_value_ == &::google::protobuf::internal::kEmptyString) {
-    identifier_value_ = new ::std::string;
+    identifier_value_ = ::google::protobuf::internal::NewString();
   }
   identifier_value_->assign(value);
 }
 inline void UninterpretedOption::set_identifier_value(const char* value) {
   set_has_identifier_value();
   if (identifier_value_ == &::google::protobuf::internal::kEmptyString) {
-    identifier_value_ = new ::std::string;
+    identifier_value_ = ::google::protobuf::internal::NewString();
   }
   identifier_value_->assign(value);
 }
 inline void UninterpretedOption::set_identifier_value(const char* value, size_t size) {
   set_has_identifier_value();
   if (identifier_value_ == &::google::protobuf::internal::kEmptyString) {
-    identifier_value_ = new ::std::string;
+    identifier_value_ = ::google::protobuf::internal::NewString();
   }
   identifier_value_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* UninterpretedOption::mutable_identifier_value() {
   set_has_identifier_value();
   if (identifier_value_ == &::google::protobuf::internal::kEmptyString) {
-    identifier_value_ = new ::std::string;
+    identifier_value_ = ::google::protobuf::internal::NewString();
   }
   return identifier_value_;
 }
@@ -5010,28 +5216,28 @@ inline const ::std::string& UninterpretedOption::string_value() const {
 inline void UninterpretedOption::set_string_value(const ::std::string& value) {
   set_has_string_value();
   if (string_value_ == &::google::protobuf::internal::kEmptyString) {
-    string_value_ = new ::std::string;
+    string_value_ = ::google::protobuf::internal::NewString();
   }
   string_value_->assign(value);
 }
 inline void UninterpretedOption::set_string_value(const char* value) {
   set_has_string_value();
   if (string_value_ == &::google::protobuf::internal::kEmptyString) {
-    string_value_ = new ::std::string;
+    string_value_ = ::google::protobuf::internal::NewString();
   }
   string_value_->assign(value);
 }
 inline void UninterpretedOption::set_string_value(const void* value, size_t size) {
   set_has_string_value();
   if (string_value_ == &::google::protobuf::internal::kEmptyString) {
-    string_value_ = new ::std::string;
+    string_value_ = ::google::protobuf::internal::NewString();
   }
   string_value_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* UninterpretedOption::mutable_string_value() {
   set_has_string_value();
   if (string_value_ == &::google::protobuf::internal::kEmptyString) {
-    string_value_ = new ::std::string;
+    string_value_ = ::google::protobuf::internal::NewString();
   }
   return string_value_;
 }
@@ -5068,28 +5274,28 @@ inline const ::std::string& UninterpretedOption::aggregate_value() const {
 inline void UninterpretedOption::set_aggregate_value(const ::std::string& value) {
   set_has_aggregate_value();
   if (aggregate_value_ == &::google::protobuf::internal::kEmptyString) {
-    aggregate_value_ = new ::std::string;
+    aggregate_value_ = ::google::protobuf::internal::NewString();
   }
   aggregate_value_->assign(value);
 }
 inline void UninterpretedOption::set_aggregate_value(const char* value) {
   set_has_aggregate_value();
   if (aggregate_value_ == &::google::protobuf::internal::kEmptyString) {
-    aggregate_value_ = new ::std::string;
+    aggregate_value_ = ::google::protobuf::internal::NewString();
   }
   aggregate_value_->assign(value);
 }
 inline void UninterpretedOption::set_aggregate_value(const char* value, size_t size) {
   set_has_aggregate_value();
   if (aggregate_value_ == &::google::protobuf::internal::kEmptyString) {
-    aggregate_value_ = new ::std::string;
+    aggregate_value_ = ::google::protobuf::internal::NewString();
   }
   aggregate_value_->assign(reinterpret_cast<const char*>(value), size);
 }
 inline ::std::string* UninterpretedOption::mutable_aggregate_value() {
   set_has_aggregate_value();
   if (aggregate_value_ == &::google::protobuf::internal::kEmptyString) {
-    aggregate_value_ = new ::std::string;
+    aggregate_value_ = ::google::protobuf::internal::NewString();
   }
   return aggregate_value_;
 }
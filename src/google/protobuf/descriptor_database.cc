@@ -297,7 +297,8 @@ bool SimpleDescriptorDatabase::MaybeCopy(const FileDescriptorProto* file,
 
 // -------------------------------------------------------------------
 
-EncodedDescriptorDatabase::EncodedDescriptorDatabase() {}
+EncodedDescriptorDatabase::EncodedDescriptorDatabase()
+  : lazy_files_read_(0) {}
 EncodedDescriptorDatabase::~EncodedDescriptorDatabase() {
   for (int i = 0; i < files_to_delete_.size(); i++) {
     operator delete(files_to_delete_[i]);
@@ -324,22 +325,109 @@ bool EncodedDescriptorDatabase::AddCopy(
   return Add(copy, size);
 }
 
+void EncodedDescriptorDatabase::AddLazily(
+    const void* encoded_file_descriptor, int size) {
+  lazy_files_.push_back(LazyFile());
+  lazy_files_.back().encoded_file =
+      std::make_pair(encoded_file_descriptor, size);
+  lazy_files_.back().indexed = false;
+}
+
+void EncodedDescriptorDatabase::ReadLazyFileHeaders() {
+  for (; lazy_files_read_ < lazy_files_.size(); ++lazy_files_read_) {
+    LazyFile* file = &lazy_files_[lazy_files_read_];
+    if (!ReadFileHeader(file->encoded_file, file)) {
+      // Let Add() report the error.
+      IndexLazyFile(lazy_files_read_);
+      continue;
+    }
+    lazy_files_by_name_.insert(std::make_pair(file->name, lazy_files_read_));
+    lazy_files_by_package_.insert(
+        std::make_pair(file->package, lazy_files_read_));
+    for (int i = 0; i < file->dependencies.size(); i++) {
+      lazy_files_by_dependency_.insert(
+          std::make_pair(file->dependencies[i], lazy_files_read_));
+    }
+  }
+}
+
+void EncodedDescriptorDatabase::IndexLazyFile(int index) {
+  LazyFile* file = &lazy_files_[index];
+  if (!file->indexed) {
+    file->indexed = true;
+    Add(file->encoded_file.first, file->encoded_file.second);
+  }
+}
+
+void EncodedDescriptorDatabase::IndexLazyFilesForSymbol(
+    const std::string& symbol_name) {
+  if (lazy_files_.empty()) return;
+  ReadLazyFileHeaders();
+
+  // A file's symbols are its package followed by a '.' (if the package is
+  // not empty) and more, so the files which may define symbol_name are those
+  // whose package is empty or symbol_name up to one of its '.'s.
+  std::string::size_type end = 0;
+  do {
+    typedef std::multimap<std::string, int>::const_iterator Iterator;
+    std::pair<Iterator, Iterator> range =
+        lazy_files_by_package_.equal_range(symbol_name.substr(0, end));
+    for (Iterator it = range.first; it != range.second; ++it) {
+      IndexLazyFile(it->second);
+    }
+    end = symbol_name.find('.', end + 1);
+  } while (end != std::string::npos);
+}
+
+void EncodedDescriptorDatabase::IndexLazyFilesForExtendee(
+    const std::string& containing_type) {
+  if (lazy_files_.empty()) return;
+  IndexLazyFilesForSymbol(containing_type);
+
+  // To extend a type, a file has to define it or import the file which does.
+  std::string defining_file;
+  if (!ReadFileName(index_.FindSymbol(containing_type), &defining_file)) {
+    // The type is not in this database, so any file might extend it.
+    for (int i = 0; i < lazy_files_.size(); i++) IndexLazyFile(i);
+    return;
+  }
+  typedef std::multimap<std::string, int>::const_iterator Iterator;
+  std::pair<Iterator, Iterator> range =
+      lazy_files_by_dependency_.equal_range(defining_file);
+  for (Iterator it = range.first; it != range.second; ++it) {
+    IndexLazyFile(it->second);
+  }
+}
+
 bool EncodedDescriptorDatabase::FindFileByName(
     const std::string& filename,
     FileDescriptorProto* output) {
-  return MaybeParse(index_.FindFile(filename), output);
+  std::pair<const void*, int> encoded_file = index_.FindFile(filename);
+  if (encoded_file.first == NULL && !lazy_files_.empty()) {
+    ReadLazyFileHeaders();
+    const int* index = FindOrNull(lazy_files_by_name_, filename);
+    if (index != NULL) encoded_file = lazy_files_[*index].encoded_file;
+  }
+  return MaybeParse(encoded_file, output);
 }
 
 bool EncodedDescriptorDatabase::FindFileContainingSymbol(
     const std::string& symbol_name,
     FileDescriptorProto* output) {
+  IndexLazyFilesForSymbol(symbol_name);
   return MaybeParse(index_.FindSymbol(symbol_name), output);
 }
 
 bool EncodedDescriptorDatabase::FindNameOfFileContainingSymbol(
     const std::string& symbol_name,
     std::string* output) {
-  std::pair<const void*, int> encoded_file = index_.FindSymbol(symbol_name);
+  IndexLazyFilesForSymbol(symbol_name);
+  return ReadFileName(index_.FindSymbol(symbol_name), output);
+}
+
+bool EncodedDescriptorDatabase::ReadFileName(
+    std::pair<const void*, int> encoded_file,
+    std::string* output) {
   if (encoded_file.first == NULL) return false;
 
   // Optimization:  The name should be the first field in the encoded message.
@@ -365,10 +453,44 @@ bool EncodedDescriptorDatabase::FindNameOfFileContainingSymbol(
   }
 }
 
+bool EncodedDescriptorDatabase::ReadFileHeader(
+    std::pair<const void*, int> encoded_file,
+    LazyFile* output) {
+  io::CodedInputStream input(reinterpret_cast<const uint8*>(encoded_file.first),
+                             encoded_file.second);
+
+  // Only the name, package and dependency fields are read; the others, which
+  // hold the file's definitions, are skipped without being parsed.
+  std::string value;
+  while (uint32 tag = input.ReadTag()) {
+    int field_number = internal::WireFormatLite::GetTagFieldNumber(tag);
+    if (field_number > FileDescriptorProto::kDependencyFieldNumber ||
+        internal::WireFormatLite::GetTagWireType(tag) !=
+            internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      if (!internal::WireFormatLite::SkipField(&input, tag)) return false;
+      continue;
+    }
+    if (!internal::WireFormatLite::ReadString(&input, &value)) return false;
+    switch (field_number) {
+      case FileDescriptorProto::kNameFieldNumber:
+        output->name.swap(value);
+        break;
+      case FileDescriptorProto::kPackageFieldNumber:
+        output->package.swap(value);
+        break;
+      case FileDescriptorProto::kDependencyFieldNumber:
+        output->dependencies.push_back(value);
+        break;
+    }
+  }
+  return input.ConsumedEntireMessage();
+}
+
 bool EncodedDescriptorDatabase::FindFileContainingExtension(
     const std::string& containing_type,
     int field_number,
     FileDescriptorProto* output) {
+  IndexLazyFilesForExtendee(containing_type);
   return MaybeParse(index_.FindExtension(containing_type, field_number),
                     output);
 }
@@ -376,6 +498,7 @@ bool EncodedDescriptorDatabase::FindFileContainingExtension(
 bool EncodedDescriptorDatabase::FindAllExtensionNumbers(
     const std::string& extendee_type,
     std::vector<int>* output) {
+  IndexLazyFilesForExtendee(extendee_type);
   return index_.FindAllExtensionNumbers(extendee_type, output);
 }
 
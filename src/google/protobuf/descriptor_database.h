@@ -283,6 +283,17 @@ class LIBPROTOBUF_EXPORT EncodedDescriptorDatabase : public DescriptorDatabase {
   // need to keep it around.
   bool AddCopy(const void* encoded_file_descriptor, int size);
 
+  // Like Add(), but does not parse or index the file right away.  Only the
+  // pointer is recorded.  The file's name, package and imports are read the
+  // first time a file, symbol or extension is looked up which the index does
+  // not know.  The file itself is only indexed when a symbol which may be in
+  // its package is looked up, or an extension of a type defined in the file
+  // or in a file it imports.  Errors that Add() would have returned are
+  // logged at that point instead, and the offending file is left out of the
+  // index.  Used for the generated pool, where every linked .pb.cc registers
+  // its file during static initialization.
+  void AddLazily(const void* encoded_file_descriptor, int size);
+
   // Like FindFileContainingSymbol but returns only the name of the file.
   bool FindNameOfFileContainingSymbol(const std::string& symbol_name,
                                       std::string* output);
@@ -302,6 +313,45 @@ class LIBPROTOBUF_EXPORT EncodedDescriptorDatabase : public DescriptorDatabase {
   SimpleDescriptorDatabase::DescriptorIndex<std::pair<const void*, int> > index_;
   std::vector<void*> files_to_delete_;
 
+  // A file passed to AddLazily(), and what ReadLazyFileHeaders() read of it.
+  struct LazyFile {
+    std::pair<const void*, int> encoded_file;
+    std::string name;
+    std::string package;
+    std::vector<std::string> dependencies;
+    bool indexed;  // Passed to Add() already.
+  };
+
+  // Files passed to AddLazily().  The first lazy_files_read_ of them have
+  // been read by ReadLazyFileHeaders(), and are in the maps below by their
+  // index in lazy_files_.
+  std::vector<LazyFile> lazy_files_;
+  int lazy_files_read_;
+  std::map<std::string, int> lazy_files_by_name_;
+  std::multimap<std::string, int> lazy_files_by_package_;
+  std::multimap<std::string, int> lazy_files_by_dependency_;
+
+  // Reads the name, package and imports of the lazily-added files not read
+  // yet, and adds them to the maps above.
+  void ReadLazyFileHeaders();
+
+  // Adds lazily-added files to index_:  the file at the index, the files
+  // which may define symbol_name (those of its enclosing packages), and the
+  // files which may extend containing_type (those defining or importing the
+  // file which defines it).
+  void IndexLazyFile(int index);
+  void IndexLazyFilesForSymbol(const std::string& symbol_name);
+  void IndexLazyFilesForExtendee(const std::string& containing_type);
+
+  // Reads the name, package and imports of an encoded FileDescriptorProto,
+  // without parsing the rest of it.
+  static bool ReadFileHeader(std::pair<const void*, int> encoded_file,
+                             LazyFile* output);
+
+  // Reads the name of an encoded FileDescriptorProto.
+  static bool ReadFileName(std::pair<const void*, int> encoded_file,
+                           std::string* output);
+
   // If encoded_file.first is non-NULL, parse the data into *output and return
   // true, otherwise return false.
   bool MaybeParse(std::pair<const void*, int> encoded_file,
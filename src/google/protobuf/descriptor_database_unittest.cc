@@ -514,6 +514,102 @@ TEST(EncodedDescriptorDatabaseExtraTest, FindNameOfFileContainingSymbol) {
   EXPECT_FALSE(db.FindNameOfFileContainingSymbol("baz.Baz", &filename));
 }
 
+TEST(EncodedDescriptorDatabaseExtraTest, AddLazily) {
+  FileDescriptorProto file1, file2a, file2b;
+  file1.set_name("foo.proto");
+  file1.set_package("foo");
+  file1.add_message_type()->set_name("Foo");
+  FieldDescriptorProto* extension = file1.add_extension();
+  extension->set_name("ext");
+  extension->set_number(5);
+  extension->set_extendee(".foo.Foo");
+  file2a.set_name("bar.proto");
+  file2b.set_package("bar");
+  file2b.add_message_type()->set_name("Bar");
+
+  std::string data1 = file1.SerializeAsString();
+  // Name not in front, so it can only be found by parsing.
+  std::string data2 = file2b.SerializeAsString() + file2a.SerializeAsString();
+
+  EncodedDescriptorDatabase db;
+  db.AddLazily(data1.data(), data1.size());
+  db.AddLazily(data2.data(), data2.size());
+
+  FileDescriptorProto output;
+  EXPECT_TRUE(db.FindFileByName("bar.proto", &output));
+  EXPECT_EQ("bar", output.package());
+  EXPECT_TRUE(db.FindFileByName("foo.proto", &output));
+  EXPECT_EQ("foo", output.package());
+  EXPECT_FALSE(db.FindFileByName("baz.proto", &output));
+
+  // Files added after the names were read are still found.
+  FileDescriptorProto file3;
+  file3.set_name("baz.proto");
+  file3.set_package("baz");
+  std::string data3 = file3.SerializeAsString();
+  db.AddLazily(data3.data(), data3.size());
+  EXPECT_TRUE(db.FindFileByName("baz.proto", &output));
+
+  EXPECT_TRUE(db.FindFileContainingSymbol("bar.Bar", &output));
+  EXPECT_EQ("bar.proto", output.name());
+  EXPECT_TRUE(db.FindFileContainingExtension("foo.Foo", 5, &output));
+  EXPECT_EQ("foo.proto", output.name());
+
+  // Once indexed, files are still found by name.
+  EXPECT_TRUE(db.FindFileByName("foo.proto", &output));
+  EXPECT_TRUE(db.FindFileByName("baz.proto", &output));
+}
+
+TEST(EncodedDescriptorDatabaseExtraTest, IndexesOnlyLazyFilesNeeded) {
+  FileDescriptorProto foo, bar, qux1, qux2;
+  foo.set_name("foo.proto");
+  foo.set_package("foo");
+  foo.add_message_type()->set_name("Foo");
+  bar.set_name("bar.proto");
+  bar.set_package("bar");
+  bar.add_dependency("foo.proto");
+  FieldDescriptorProto* extension = bar.add_extension();
+  extension->set_name("ext");
+  extension->set_number(5);
+  extension->set_extendee(".foo.Foo");
+  // These two conflict, which Add() reports when they are indexed.
+  qux1.set_name("qux1.proto");
+  qux1.set_package("qux");
+  qux1.add_message_type()->set_name("Qux");
+  qux2.set_name("qux2.proto");
+  qux2.set_package("qux");
+  qux2.add_message_type()->set_name("Qux");
+
+  std::string data[] = { foo.SerializeAsString(), bar.SerializeAsString(),
+                         qux1.SerializeAsString(), qux2.SerializeAsString() };
+  EncodedDescriptorDatabase db;
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(data); i++) {
+    db.AddLazily(data[i].data(), data[i].size());
+  }
+
+  FileDescriptorProto output;
+  {
+    ScopedMemoryLog log;
+    EXPECT_TRUE(db.FindFileContainingSymbol("foo.Foo.Nested", &output));
+    EXPECT_EQ("foo.proto", output.name());
+    // Found through bar.proto's import of foo.proto.
+    EXPECT_TRUE(db.FindFileContainingExtension("foo.Foo", 5, &output));
+    EXPECT_EQ("bar.proto", output.name());
+    std::vector<int> numbers;
+    EXPECT_TRUE(db.FindAllExtensionNumbers("foo.Foo", &numbers));
+    ASSERT_EQ(1, numbers.size());
+    EXPECT_EQ(5, numbers[0]);
+    EXPECT_FALSE(db.FindFileContainingSymbol("baz.Baz", &output));
+    // The qux files were not indexed.
+    EXPECT_TRUE(log.GetMessages(ERROR).empty());
+  }
+  {
+    ScopedMemoryLog log;
+    EXPECT_TRUE(db.FindFileContainingSymbol("qux.Qux", &output));
+    EXPECT_EQ(1, log.GetMessages(ERROR).size());
+  }
+}
+
 // ===================================================================
 
 class MergedDescriptorDatabaseTest : public testing::Test {
@@ -1738,6 +1738,42 @@ TEST_F(MiscTest, FieldOptions) {
   EXPECT_EQ(FieldOptions::CORD, bar->options().ctype());
 }
 
+TEST_F(MiscTest, EqualNamesAreShared) {
+  // The pool interns simple names and default values, so equal strings
+  // appearing in different files should be the same object.
+  FileDescriptorProto file_proto;
+  file_proto.set_name("foo.proto");
+  file_proto.set_package("foo");
+  AddField(AddMessage(&file_proto, "TestMessage"), "some_name", 1,
+           FieldDescriptorProto::LABEL_OPTIONAL,
+           FieldDescriptorProto::TYPE_STRING)
+    ->set_default_value("hello");
+
+  DescriptorPool pool;
+  const FileDescriptor* foo_file = pool.BuildFile(file_proto);
+  ASSERT_TRUE(foo_file != NULL);
+
+  file_proto.set_name("bar.proto");
+  file_proto.set_package("bar");
+  const FileDescriptor* bar_file = pool.BuildFile(file_proto);
+  ASSERT_TRUE(bar_file != NULL);
+
+  const Descriptor* foo_message = foo_file->message_type(0);
+  const Descriptor* bar_message = bar_file->message_type(0);
+  EXPECT_EQ("foo.TestMessage", foo_message->full_name());
+  EXPECT_EQ("bar.TestMessage", bar_message->full_name());
+  EXPECT_EQ(&foo_message->name(), &bar_message->name());
+
+  const FieldDescriptor* foo_field = foo_message->field(0);
+  const FieldDescriptor* bar_field = bar_message->field(0);
+  EXPECT_EQ(&foo_field->name(), &bar_field->name());
+  EXPECT_EQ(&foo_field->name(), &foo_field->lowercase_name());
+  EXPECT_EQ("someName", foo_field->camelcase_name());
+  EXPECT_EQ(&foo_field->camelcase_name(), &bar_field->camelcase_name());
+  EXPECT_EQ(&foo_field->default_value_string(),
+            &bar_field->default_value_string());
+}
+
 // ===================================================================
 
 class AllowUnknownDependenciesTest : public testing::Test {
@@ -3616,6 +3652,50 @@ TEST_F(ValidationErrorTest, RollbackAfterError) {
     "}");
 }
 
+TEST_F(ValidationErrorTest, RollbackManySymbols) {
+  // Like RollbackAfterError, but with enough symbols that removing them
+  // shuffles lots of entries around in the pool's symbol tables.  Symbols
+  // which were defined before the failed file must all survive.
+  FileDescriptorProto bar_file;
+  bar_file.set_name("bar.proto");
+  for (int i = 0; i < 100; i++) {
+    AddMessage(&bar_file, "Bar" + SimpleItoa(i));
+  }
+  ASSERT_TRUE(pool_.BuildFile(bar_file) != NULL);
+
+  FileDescriptorProto foo_file;
+  foo_file.set_name("foo.proto");
+  foo_file.add_dependency("bar.proto");
+  for (int i = 0; i < 300; i++) {
+    AddField(AddMessage(&foo_file, "Foo" + SimpleItoa(i)), "bar", 1,
+             FieldDescriptorProto::LABEL_OPTIONAL,
+             FieldDescriptorProto::TYPE_MESSAGE)
+      ->set_type_name("Bar" + SimpleItoa(i % 100));
+  }
+  foo_file.mutable_message_type(299)->mutable_field(0)
+    ->set_type_name("NoSuchType");
+
+  MockErrorCollector error_collector;
+  EXPECT_TRUE(
+    pool_.BuildFileCollectingErrors(foo_file, &error_collector) == NULL);
+  EXPECT_EQ("foo.proto: Foo299.bar: TYPE: \"NoSuchType\" is not defined.\n",
+            error_collector.text_);
+
+  EXPECT_TRUE(pool_.FindFileByName("foo.proto") == NULL);
+  for (int i = 0; i < 300; i++) {
+    EXPECT_TRUE(pool_.FindMessageTypeByName("Foo" + SimpleItoa(i)) == NULL);
+  }
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(pool_.FindMessageTypeByName("Bar" + SimpleItoa(i)) != NULL);
+  }
+
+  foo_file.mutable_message_type(299)->mutable_field(0)->set_type_name("Bar0");
+  ASSERT_TRUE(pool_.BuildFile(foo_file) != NULL);
+  for (int i = 0; i < 300; i++) {
+    EXPECT_TRUE(pool_.FindMessageTypeByName("Foo" + SimpleItoa(i)) != NULL);
+  }
+}
+
 TEST_F(ValidationErrorTest, ErrorsReportedToLogError) {
   // Test that errors are reported to GOOGLE_LOG(ERROR) if no error collector is
   // provided.
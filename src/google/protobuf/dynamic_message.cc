@@ -190,6 +190,7 @@ class DynamicMessage : public Message {
   // implements Message ----------------------------------------------
 
   Message* New() const;
+  const MessageLite* GetPrototype() const;
 
   int GetCachedSize() const;
   void SetCachedSize(int size) const;
@@ -408,6 +409,10 @@ Message* DynamicMessage::New() const {
   return new(new_base) DynamicMessage(type_info_);
 }
 
+const MessageLite* DynamicMessage::GetPrototype() const {
+  return type_info_->prototype.get();
+}
+
 int DynamicMessage::GetCachedSize() const {
   return cached_byte_size_;
 }
@@ -529,8 +534,9 @@ const Message* DynamicMessageFactory::GetPrototypeNoLock(
   size = AlignOffset(size);
   type_info->size = size;
 
-  // Allocate the prototype.
-  void* base = operator new(size);
+  // Allocate the prototype.  It is freed by delete, so it must come from
+  // DynamicMessage's operator new, like the messages New() allocates.
+  void* base = DynamicMessage::operator new(size);
   memset(base, 0, size);
   DynamicMessage* prototype = new(base) DynamicMessage(type_info);
   type_info->prototype.reset(prototype);
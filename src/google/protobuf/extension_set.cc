@@ -36,6 +36,7 @@
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/stubs/once.h>
 #include <google/protobuf/extension_set.h>
+#include <google/protobuf/allocator.h>
 #include <google/protobuf/message_lite.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
@@ -374,7 +375,7 @@ std::string* ExtensionSet::MutableString(int number, FieldType type,
     extension->type = type;
     GOOGLE_DCHECK_EQ(cpp_type(extension->type), WireFormatLite::CPPTYPE_STRING);
     extension->is_repeated = false;
-    extension->string_value = new std::string;
+    extension->string_value = NewString();
   } else {
     GOOGLE_DCHECK_TYPE(*extension, OPTIONAL, STRING);
   }
@@ -55,6 +55,7 @@ namespace protobuf {
   class Message;                                       // message.h
   class MessageFactory;                                // message.h
   class UnknownFieldSet;                               // unknown_field_set.h
+  class SpaceUsedBreakdown;                            // space_used_breakdown.h
   namespace io {
     class CodedInputStream;                              // coded_stream.h
     class CodedOutputStream;                             // coded_stream.h
@@ -379,6 +380,13 @@ class LIBPROTOBUF_EXPORT ExtensionSet {
   // SpaceUsed()).
   int SpaceUsedExcludingSelf() const;
 
+  // Reports SpaceUsedExcludingSelf() to *breakdown piece by piece, for
+  // implementing Reflection::AddSpaceUsed().  containing_type and pool find
+  // the descriptors of the extensions, as in AppendToList().
+  void AddSpaceUsedExcludingSelf(const Descriptor* containing_type,
+                                 const DescriptorPool* pool,
+                                 SpaceUsedBreakdown* breakdown) const;
+
  private:
 
   struct Extension {
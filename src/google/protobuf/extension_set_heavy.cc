@@ -39,6 +39,7 @@
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/message.h>
 #include <google/protobuf/repeated_field.h>
+#include <google/protobuf/space_used_breakdown.h>
 #include <google/protobuf/wire_format.h>
 #include <google/protobuf/wire_format_lite_inl.h>
 
@@ -244,6 +245,108 @@ int ExtensionSet::SpaceUsedExcludingSelf() const {
   return total_size;
 }
 
+void ExtensionSet::AddSpaceUsedExcludingSelf(
+    const Descriptor* containing_type,
+    const DescriptorPool* pool,
+    SpaceUsedBreakdown* breakdown) const {
+  breakdown->AddSelf(
+      extensions_.size() * sizeof(std::map<int, Extension>::value_type));
+  for (std::map<int, Extension>::const_iterator iter = extensions_.begin();
+       iter != extensions_.end(); ++iter) {
+    const Extension& extension = iter->second;
+    const FieldDescriptor* field = extension.descriptor;
+    if (field == NULL) {
+      field = pool->FindExtensionByNumber(containing_type, iter->first);
+    }
+    if (field == NULL) {
+      // Not known to the pool; count it as the message's own.
+      breakdown->AddSelf(extension.SpaceUsedExcludingSelf());
+      continue;
+    }
+
+    if (extension.is_repeated) {
+      switch (cpp_type(extension.type)) {
+#define HANDLE_TYPE(UPPERCASE, LOWERCASE)                                     \
+        case FieldDescriptor::CPPTYPE_##UPPERCASE:                            \
+          breakdown->AddField(                                                \
+              field,                                                          \
+              sizeof(*extension.repeated_##LOWERCASE##_value) +               \
+                  extension.repeated_##LOWERCASE##_value                      \
+                      ->SpaceUsedExcludingSelf(),                             \
+              extension.repeated_##LOWERCASE##_value                          \
+                  ->SpaceUnusedExcludingSelf(),                               \
+              extension.repeated_##LOWERCASE##_value->size());                \
+          break
+
+        HANDLE_TYPE(  INT32,   int32);
+        HANDLE_TYPE(  INT64,   int64);
+        HANDLE_TYPE( UINT32,  uint32);
+        HANDLE_TYPE( UINT64,  uint64);
+        HANDLE_TYPE(  FLOAT,   float);
+        HANDLE_TYPE( DOUBLE,  double);
+        HANDLE_TYPE(   BOOL,    bool);
+        HANDLE_TYPE(   ENUM,    enum);
+#undef HANDLE_TYPE
+
+        case FieldDescriptor::CPPTYPE_STRING: {
+          const RepeatedPtrField<std::string>& repeated =
+              *extension.repeated_string_value;
+          int slack = repeated.SpaceUnusedExcludingSelf();
+          for (int i = 0; i < repeated.size(); i++) {
+            slack += SpaceUsedBreakdown::StringSlack(repeated.Get(i));
+          }
+          breakdown->AddField(
+              field, sizeof(repeated) + repeated.SpaceUsedExcludingSelf(),
+              slack, repeated.size());
+          break;
+        }
+
+        case FieldDescriptor::CPPTYPE_MESSAGE: {
+          // As in SpaceUsedExcludingSelf(), the elements are Messages.
+          const RepeatedPtrFieldBase* repeated =
+              extension.repeated_message_value;
+          breakdown->AddField(
+              field,
+              sizeof(*extension.repeated_message_value) +
+                  repeated->SpaceUsedExcludingElements<
+                      GenericTypeHandler<Message> >(),
+              repeated->SpaceUnusedExcludingSelf<
+                  GenericTypeHandler<Message> >(),
+              0);
+          for (int i = 0; i < repeated->size(); i++) {
+            breakdown->AddSubmessage(
+                field, repeated->Get<GenericTypeHandler<Message> >(i), true);
+          }
+          break;
+        }
+      }
+    } else {
+      switch (cpp_type(extension.type)) {
+        case FieldDescriptor::CPPTYPE_STRING: {
+          int bytes = sizeof(*extension.string_value) +
+                      StringSpaceUsedExcludingSelf(*extension.string_value);
+          if (extension.is_cleared) {
+            breakdown->AddField(field, bytes, bytes, 0);
+          } else {
+            breakdown->AddField(
+                field, bytes,
+                SpaceUsedBreakdown::StringSlack(*extension.string_value), 1);
+          }
+          break;
+        }
+        case FieldDescriptor::CPPTYPE_MESSAGE:
+          breakdown->AddSubmessage(
+              field, *down_cast<Message*>(extension.message_value),
+              !extension.is_cleared);
+          break;
+        default:
+          // No extra storage costs for primitive types.
+          break;
+      }
+    }
+  }
+}
+
 inline int ExtensionSet::RepeatedMessage_SpaceUsedExcludingSelf(
     RepeatedPtrFieldBase* field) {
   return field->SpaceUsedExcludingSelf<GenericTypeHandler<Message> >();
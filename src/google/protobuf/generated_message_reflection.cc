@@ -32,13 +32,16 @@
 //  Based on original Protocol Buffers design by
 //  Sanjay Ghemawat, Jeff Dean, and others.
 
+#include <string.h>
 #include <algorithm>
 #include <google/protobuf/generated_message_reflection.h>
+#include <google/protobuf/allocator.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/descriptor.pb.h>
 #include <google/protobuf/repeated_field.h>
 #include <google/protobuf/extension_set.h>
 #include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/space_used_breakdown.h>
 #include <google/protobuf/stubs/common.h>
 
 namespace google {
@@ -182,6 +185,35 @@ GeneratedMessageReflection::GeneratedMessageReflection(
     unknown_fields_offset_(unknown_fields_offset),
     extensions_offset_(extensions_offset),
     object_size_      (object_size),
+    cold_fields_offset_(-1),
+    cold_fields_size_ (0),
+    descriptor_pool_  ((descriptor_pool == NULL) ?
+                         DescriptorPool::generated_pool() :
+                         descriptor_pool),
+    message_factory_  (factory) {
+}
+
+GeneratedMessageReflection::GeneratedMessageReflection(
+    const Descriptor* descriptor,
+    const Message* default_instance,
+    const int offsets[],
+    int has_bits_offset,
+    int unknown_fields_offset,
+    int extensions_offset,
+    const DescriptorPool* descriptor_pool,
+    MessageFactory* factory,
+    int object_size,
+    int cold_fields_offset,
+    int cold_fields_size)
+  : descriptor_       (descriptor),
+    default_instance_ (default_instance),
+    offsets_          (offsets),
+    has_bits_offset_  (has_bits_offset),
+    unknown_fields_offset_(unknown_fields_offset),
+    extensions_offset_(extensions_offset),
+    object_size_      (object_size),
+    cold_fields_offset_(cold_fields_offset),
+    cold_fields_size_ (cold_fields_size),
     descriptor_pool_  ((descriptor_pool == NULL) ?
                          DescriptorPool::generated_pool() :
                          descriptor_pool),
@@ -214,8 +246,13 @@ int GeneratedMessageReflection::SpaceUsed(const Message& message) const {
     total_size += GetExtensionSet(message).SpaceUsedExcludingSelf();
   }
 
+  // Cold fields use no memory of their own until one is written.
+  bool has_cold_fields = HasColdFields(message);
+  if (has_cold_fields) total_size += cold_fields_size_;
+
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
+    if (IsColdField(field) && !has_cold_fields) continue;
 
     if (field->is_repeated()) {
       switch (field->cpp_type()) {
@@ -306,6 +343,121 @@ int GeneratedMessageReflection::SpaceUsed(const Message& message) const {
   return total_size;
 }
 
+bool GeneratedMessageReflection::AddSpaceUsed(
+    const Message& message, SpaceUsedBreakdown* breakdown) const {
+  // Reports what SpaceUsed() counts, in the same way.
+  bool has_cold_fields = HasColdFields(message);
+  breakdown->AddSelf(object_size_ + (has_cold_fields ? cold_fields_size_ : 0));
+  breakdown->AddUnknownFields(GetUnknownFields(message));
+
+  if (extensions_offset_ != -1) {
+    GetExtensionSet(message).AddSpaceUsedExcludingSelf(
+        descriptor_, descriptor_pool_, breakdown);
+  }
+
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    const FieldDescriptor* field = descriptor_->field(i);
+    if (IsColdField(field) && !has_cold_fields) continue;
+
+    if (field->is_repeated()) {
+      switch (field->cpp_type()) {
+#define HANDLE_TYPE(UPPERCASE, LOWERCASE)                                     \
+        case FieldDescriptor::CPPTYPE_##UPPERCASE : {                         \
+          const RepeatedField<LOWERCASE>& repeated =                          \
+              GetRaw<RepeatedField<LOWERCASE> >(message, field);              \
+          breakdown->AddField(field, repeated.SpaceUsedExcludingSelf(),       \
+                              repeated.SpaceUnusedExcludingSelf(),            \
+                              repeated.size());                               \
+          break;                                                              \
+        }
+
+        HANDLE_TYPE( INT32,  int32);
+        HANDLE_TYPE( INT64,  int64);
+        HANDLE_TYPE(UINT32, uint32);
+        HANDLE_TYPE(UINT64, uint64);
+        HANDLE_TYPE(DOUBLE, double);
+        HANDLE_TYPE( FLOAT,  float);
+        HANDLE_TYPE(  BOOL,   bool);
+        HANDLE_TYPE(  ENUM,    int);
+#undef HANDLE_TYPE
+
+        case FieldDescriptor::CPPTYPE_STRING:
+          switch (field->options().ctype()) {
+            default:  // TODO(kenton):  Support other string reps.
+            case FieldOptions::STRING: {
+              const RepeatedPtrField<std::string>& repeated =
+                  GetRaw<RepeatedPtrField<std::string> >(message, field);
+              int slack = repeated.SpaceUnusedExcludingSelf();
+              for (int j = 0; j < repeated.size(); j++) {
+                slack += SpaceUsedBreakdown::StringSlack(repeated.Get(j));
+              }
+              breakdown->AddField(field, repeated.SpaceUsedExcludingSelf(),
+                                  slack, repeated.size());
+              break;
+            }
+          }
+          break;
+
+        case FieldDescriptor::CPPTYPE_MESSAGE: {
+          const RepeatedPtrFieldBase& repeated =
+              GetRaw<RepeatedPtrFieldBase>(message, field);
+          breakdown->AddField(
+              field,
+              repeated.SpaceUsedExcludingElements<GenericTypeHandler<Message> >(),
+              repeated.SpaceUnusedExcludingSelf<GenericTypeHandler<Message> >(),
+              0);
+          for (int j = 0; j < repeated.size(); j++) {
+            breakdown->AddSubmessage(
+                field, repeated.Get<GenericTypeHandler<Message> >(j), true);
+          }
+          break;
+        }
+      }
+    } else {
+      switch (field->cpp_type()) {
+        case FieldDescriptor::CPPTYPE_STRING: {
+          switch (field->options().ctype()) {
+            default:  // TODO(kenton):  Support other string reps.
+            case FieldOptions::STRING: {
+              const std::string* ptr = GetField<const std::string*>(message, field);
+              const std::string* default_ptr = DefaultRaw<const std::string*>(field);
+
+              if (ptr != default_ptr) {
+                int bytes = sizeof(*ptr) + StringSpaceUsedExcludingSelf(*ptr);
+                if (HasBit(message, field)) {
+                  breakdown->AddField(field, bytes,
+                                      SpaceUsedBreakdown::StringSlack(*ptr), 1);
+                } else {
+                  // Kept after the field was cleared.
+                  breakdown->AddField(field, bytes, bytes, 0);
+                }
+              }
+              break;
+            }
+          }
+          break;
+        }
+
+        case FieldDescriptor::CPPTYPE_MESSAGE:
+          if (&message != default_instance_) {
+            const Message* sub_message = GetRaw<const Message*>(message, field);
+            if (sub_message != NULL) {
+              breakdown->AddSubmessage(field, *sub_message,
+                                       HasBit(message, field));
+            }
+          }
+          break;
+
+        default:
+          // Field is inline, so it is part of object_size_.
+          break;
+      }
+    }
+  }
+
+  return true;
+}
+
 void GeneratedMessageReflection::Swap(
     Message* message1,
     Message* message2) const {
@@ -335,8 +487,14 @@ void GeneratedMessageReflection::Swap(
     std::swap(has_bits1[i], has_bits2[i]);
   }
 
+  // Swapping the structs of cold fields swaps all of the cold fields.
+  if (cold_fields_offset_ != -1) {
+    std::swap(*MutableColdFields(message1), *MutableColdFields(message2));
+  }
+
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
+    if (IsColdField(field)) continue;
     if (field->is_repeated()) {
       switch (field->cpp_type()) {
 #define SWAP_ARRAYS(CPPTYPE, TYPE)                                           \
@@ -462,6 +620,11 @@ void GeneratedMessageReflection::ClearField(
   } else if (!field->is_repeated()) {
     if (HasBit(*message, field)) {
       ClearBit(message, field);
+      if (IsColdField(field) && !HasColdFields(*message)) {
+        // Only the has-bit was set (see SetField()), so the field still
+        // holds its default value.
+        return;
+      }
 
       // We need to set the field back to its default value.
       switch (field->cpp_type()) {
@@ -508,6 +671,8 @@ void GeneratedMessageReflection::ClearField(
           break;
       }
     }
+  } else if (IsColdField(field) && !HasColdFields(*message)) {
+    // The field was never written, so it is empty already.
   } else {
     switch (field->cpp_type()) {
 #define HANDLE_TYPE(UPPERCASE, LOWERCASE)                                     \
@@ -789,9 +954,14 @@ void GeneratedMessageReflection::SetString(
     switch (field->options().ctype()) {
       default:  // TODO(kenton):  Support other string reps.
       case FieldOptions::STRING: {
+        if (IsColdField(field) && !HasColdFields(*message) &&
+            value == *DefaultRaw<const std::string*>(field)) {
+          SetBit(message, field);
+          break;
+        }
         std::string** ptr = MutableField<std::string*>(message, field);
         if (*ptr == DefaultRaw<const std::string*>(field)) {
-          *ptr = new std::string(value);
+          *ptr = NewString(value);
         } else {
           (*ptr)->assign(value);
         }
@@ -1053,6 +1223,44 @@ Message* GeneratedMessageReflection::AddMessage(
 
 // -------------------------------------------------------------------
 
+namespace {
+
+// Is the field a RepeatedField<T> of its own cpp_type() in the message?
+// Extensions live in the ExtensionSet instead, and enums are stored as int.
+bool IsRawRepeatedField(const FieldDescriptor* field) {
+  if (field->is_extension()) return false;
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_STRING:
+    case FieldDescriptor::CPPTYPE_ENUM:
+    case FieldDescriptor::CPPTYPE_MESSAGE:
+      return false;
+    default:
+      return true;
+  }
+}
+
+}  // namespace
+
+const void* GeneratedMessageReflection::GetRawRepeatedField(
+    const Message& message, const FieldDescriptor* field) const {
+  USAGE_CHECK_MESSAGE_TYPE(GetRawRepeatedField);
+  USAGE_CHECK_REPEATED(GetRawRepeatedField);
+
+  if (!IsRawRepeatedField(field)) return NULL;
+  return &GetRaw<char>(message, field);
+}
+
+void* GeneratedMessageReflection::MutableRawRepeatedField(
+    Message* message, const FieldDescriptor* field) const {
+  USAGE_CHECK_MESSAGE_TYPE(MutableRawRepeatedField);
+  USAGE_CHECK_REPEATED(MutableRawRepeatedField);
+
+  if (!IsRawRepeatedField(field)) return NULL;
+  return MutableRaw<char>(message, field);
+}
+
+// -------------------------------------------------------------------
+
 const FieldDescriptor* GeneratedMessageReflection::FindKnownExtensionByName(
     const std::string& name) const {
   if (extensions_offset_ == -1) return NULL;
@@ -1094,27 +1302,65 @@ const FieldDescriptor* GeneratedMessageReflection::FindKnownExtensionByNumber(
 
 // These simple template accessors obtain pointers (or references) to
 // the given field.
+// Cold fields are read from the message's struct of cold fields, which may
+// be the shared default one; MutableRaw() gives the message its own struct
+// first.
 template <typename Type>
 inline const Type& GeneratedMessageReflection::GetRaw(
     const Message& message, const FieldDescriptor* field) const {
-  const void* ptr = reinterpret_cast<const uint8*>(&message) +
-                    offsets_[field->index()];
+  int offset = offsets_[field->index()];
+  const void* base = &message;
+  if (offset & kColdFieldOffsetFlag) {
+    base = GetColdFields(message);
+    offset &= ~kColdFieldOffsetFlag;
+  }
+  const void* ptr = reinterpret_cast<const uint8*>(base) + offset;
   return *reinterpret_cast<const Type*>(ptr);
 }
 
 template <typename Type>
 inline Type* GeneratedMessageReflection::MutableRaw(
     Message* message, const FieldDescriptor* field) const {
-  void* ptr = reinterpret_cast<uint8*>(message) + offsets_[field->index()];
+  int offset = offsets_[field->index()];
+  void* base = message;
+  if (offset & kColdFieldOffsetFlag) {
+    ColdFields** cold_fields = MutableColdFields(message);
+    const ColdFields* default_cold_fields = GetColdFields(*default_instance_);
+    if (*cold_fields == default_cold_fields) {
+      *cold_fields = default_cold_fields->New();
+    }
+    base = *cold_fields;
+    offset &= ~kColdFieldOffsetFlag;
+  }
+  void* ptr = reinterpret_cast<uint8*>(base) + offset;
   return reinterpret_cast<Type*>(ptr);
 }
 
 template <typename Type>
 inline const Type& GeneratedMessageReflection::DefaultRaw(
     const FieldDescriptor* field) const {
-  const void* ptr = reinterpret_cast<const uint8*>(default_instance_) +
-                    offsets_[field->index()];
-  return *reinterpret_cast<const Type*>(ptr);
+  return GetRaw<Type>(*default_instance_, field);
+}
+
+inline bool GeneratedMessageReflection::IsColdField(
+    const FieldDescriptor* field) const {
+  return (offsets_[field->index()] & kColdFieldOffsetFlag) != 0;
+}
+inline const ColdFields* GeneratedMessageReflection::GetColdFields(
+    const Message& message) const {
+  const void* ptr = reinterpret_cast<const uint8*>(&message) +
+                    cold_fields_offset_;
+  return *reinterpret_cast<const ColdFields* const*>(ptr);
+}
+inline ColdFields** GeneratedMessageReflection::MutableColdFields(
+    Message* message) const {
+  void* ptr = reinterpret_cast<uint8*>(message) + cold_fields_offset_;
+  return reinterpret_cast<ColdFields**>(ptr);
+}
+inline bool GeneratedMessageReflection::HasColdFields(
+    const Message& message) const {
+  return cold_fields_offset_ != -1 &&
+         GetColdFields(message) != GetColdFields(*default_instance_);
 }
 
 inline const uint32* GeneratedMessageReflection::GetHasBits(
@@ -1171,6 +1417,14 @@ inline const Type& GeneratedMessageReflection::GetField(
 template <typename Type>
 inline void GeneratedMessageReflection::SetField(
     Message* message, const FieldDescriptor* field, const Type& value) const {
+  // A cold field of a message without cold fields of its own reads the
+  // default ones, so storing its default value needs only the has-bit.  The
+  // bytes are compared so that -0.0 is not taken for 0.0.
+  if (IsColdField(field) && !HasColdFields(*message) &&
+      memcmp(&value, &DefaultRaw<Type>(field), sizeof(Type)) == 0) {
+    SetBit(message, field);
+    return;
+  }
   *MutableRaw<Type>(message, field) = value;
   SetBit(message, field);
 }
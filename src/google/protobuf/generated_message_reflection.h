@@ -61,6 +61,7 @@ class GeneratedMessageReflection;
 
 // Defined in other files.
 class ExtensionSet;             // extension_set.h
+class ColdFields;               // generated_message_util.h
 
 // THIS CLASS IS NOT INTENDED FOR DIRECT USE.  It is intended for use
 // by generated code.  This class is just a big hack that reduces code
@@ -128,6 +129,29 @@ class LIBPROTOBUF_EXPORT GeneratedMessageReflection : public Reflection {
                              const DescriptorPool* pool,
                              MessageFactory* factory,
                              int object_size);
+
+  // Constructs a GeneratedMessageReflection for a message type which keeps
+  // some fields in a lazily allocated struct (see ColdFields in
+  // generated_message_util.h).  The offsets of those fields are relative to
+  // the start of the struct and computed with the
+  // GOOGLE_PROTOBUF_GENERATED_COLD_FIELD_OFFSET() macro, defined below.
+  // Additional parameters:
+  //   cold_fields_offset:  Offset in the message of the ColdFields pointer.
+  //                  The default instance's pointer is the shared default
+  //                  struct, which other messages point at until they
+  //                  first write one of its fields.
+  //   cold_fields_size:  The size of the struct, as measured by sizeof().
+  GeneratedMessageReflection(const Descriptor* descriptor,
+                             const Message* default_instance,
+                             const int offsets[],
+                             int has_bits_offset,
+                             int unknown_fields_offset,
+                             int extensions_offset,
+                             const DescriptorPool* pool,
+                             MessageFactory* factory,
+                             int object_size,
+                             int cold_fields_offset,
+                             int cold_fields_size);
   ~GeneratedMessageReflection();
 
   // implements Reflection -------------------------------------------
@@ -136,6 +160,8 @@ class LIBPROTOBUF_EXPORT GeneratedMessageReflection : public Reflection {
   UnknownFieldSet* MutableUnknownFields(Message* message) const;
 
   int SpaceUsed(const Message& message) const;
+  bool AddSpaceUsed(const Message& message,
+                    SpaceUsedBreakdown* breakdown) const;
 
   bool HasField(const Message& message, const FieldDescriptor* field) const;
   int FieldSize(const Message& message, const FieldDescriptor* field) const;
@@ -267,6 +293,11 @@ class LIBPROTOBUF_EXPORT GeneratedMessageReflection : public Reflection {
   Message* AddMessage(Message* message, const FieldDescriptor* field,
                       MessageFactory* factory = NULL) const;
 
+  const void* GetRawRepeatedField(const Message& message,
+                                  const FieldDescriptor* field) const;
+  void* MutableRawRepeatedField(Message* message,
+                                const FieldDescriptor* field) const;
+
   const FieldDescriptor* FindKnownExtensionByName(const std::string& name) const;
   const FieldDescriptor* FindKnownExtensionByNumber(int number) const;
 
@@ -281,6 +312,8 @@ class LIBPROTOBUF_EXPORT GeneratedMessageReflection : public Reflection {
   int unknown_fields_offset_;
   int extensions_offset_;
   int object_size_;
+  int cold_fields_offset_;
+  int cold_fields_size_;
 
   const DescriptorPool* descriptor_pool_;
   MessageFactory* message_factory_;
@@ -293,6 +326,13 @@ class LIBPROTOBUF_EXPORT GeneratedMessageReflection : public Reflection {
                           const FieldDescriptor* field) const;
   template <typename Type>
   inline const Type& DefaultRaw(const FieldDescriptor* field) const;
+
+  // Helpers for fields kept in the struct of cold fields.  HasColdFields()
+  // is true once the message has its own struct.
+  inline bool IsColdField(const FieldDescriptor* field) const;
+  inline const ColdFields* GetColdFields(const Message& message) const;
+  inline ColdFields** MutableColdFields(Message* message) const;
+  inline bool HasColdFields(const Message& message) const;
   inline const Message* GetMessagePrototype(const FieldDescriptor* field) const;
 
   inline const uint32* GetHasBits(const Message& message) const;
@@ -363,6 +403,16 @@ class LIBPROTOBUF_EXPORT GeneratedMessageReflection : public Reflection {
       &reinterpret_cast<const TYPE*>(16)->FIELD) -            \
     reinterpret_cast<const char*>(16))
 
+// Marks an offset as relative to the struct of cold fields rather than to
+// the message.
+static const int kColdFieldOffsetFlag = 1 << 30;
+
+// The offset of a field in the struct of cold fields TYPE, for the offsets
+// array given to GeneratedMessageReflection.
+#define GOOGLE_PROTOBUF_GENERATED_COLD_FIELD_OFFSET(TYPE, FIELD)       \
+  (GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(TYPE, FIELD) |      \
+   ::google::protobuf::internal::kColdFieldOffsetFlag)
+
 // There are some places in proto2 where dynamic_cast would be useful as an
 // optimization.  For example, take Message::MergeFrom(const Message& other).
 // For a given generated message FooMessage, we generate these two methods:
@@ -123,6 +123,38 @@ TEST(GeneratedMessageReflectionTest, GetStringReference) {
        "a reference to the underlying string.";
 }
 
+TEST(GeneratedMessageReflectionTest, RawRepeatedField) {
+  // Test that GetRawRepeatedField() and MutableRawRepeatedField() return the
+  // RepeatedField of repeated numeric and bool fields, and NULL otherwise.
+  unittest::TestAllTypes message;
+  message.add_repeated_int32(1);
+  message.add_repeated_double(2.5);
+
+  const Reflection* reflection = message.GetReflection();
+
+  EXPECT_EQ(&message.repeated_int32(),
+            reflection->GetRawRepeatedField(message, F("repeated_int32")));
+  EXPECT_EQ(message.mutable_repeated_double(),
+            reflection->MutableRawRepeatedField(&message,
+                                                F("repeated_double")));
+  EXPECT_EQ(&message.repeated_bool(),
+            reflection->GetRawRepeatedField(message, F("repeated_bool")));
+
+  EXPECT_TRUE(reflection->GetRawRepeatedField(
+      message, F("repeated_string")) == NULL);
+  EXPECT_TRUE(reflection->GetRawRepeatedField(
+      message, F("repeated_nested_enum")) == NULL);
+  EXPECT_TRUE(reflection->MutableRawRepeatedField(
+      &message, F("repeated_nested_message")) == NULL);
+
+  unittest::TestAllExtensions extensions;
+  const FieldDescriptor* extension =
+      extensions.GetDescriptor()->file()->FindExtensionByName(
+          "repeated_int32_extension");
+  ASSERT_TRUE(extension != NULL);
+  EXPECT_TRUE(extensions.GetReflection()->GetRawRepeatedField(
+      extensions, extension) == NULL);
+}
 
 TEST(GeneratedMessageReflectionTest, DefaultsAfterClear) {
   // Check that after setting all fields and then clearing, getting an
@@ -36,6 +36,8 @@
 
 #include <limits>
 
+#include <google/protobuf/allocator.h>
+
 namespace google {
 namespace protobuf {
 namespace internal {
@@ -49,6 +51,24 @@ double NaN() {
 
 const ::std::string kEmptyString;
 
+ColdFields::~ColdFields() {}
+
+void* ColdFields::operator new(size_t size) {
+  return Allocate(size, ALLOCATION_MESSAGE);
+}
+
+void ColdFields::operator delete(void* ptr) {
+  Free(ptr, ALLOCATION_MESSAGE);
+}
+
+void* ColdFields::operator new(size_t size, const std::nothrow_t&) throw() {
+  return AllocateNoThrow(size, ALLOCATION_MESSAGE);
+}
+
+void ColdFields::operator delete(void* ptr, const std::nothrow_t&) throw() {
+  Free(ptr, ALLOCATION_MESSAGE);
+}
+
 
 }  // namespace internal
 }  // namespace protobuf
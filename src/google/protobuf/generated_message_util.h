@@ -38,6 +38,7 @@
 #ifndef GOOGLE_PROTOBUF_GENERATED_MESSAGE_UTIL_H__
 #define GOOGLE_PROTOBUF_GENERATED_MESSAGE_UTIL_H__
 
+#include <new>
 #include <string>
 
 #include <google/protobuf/stubs/common.h>
@@ -74,6 +75,67 @@ LIBPROTOBUF_EXPORT double NaN();
 // Constant used for empty default strings.
 LIBPROTOBUF_EXPORT extern const ::std::string kEmptyString;
 
+// Zero-initialized storage for one object of the given type.  Generated code
+// keeps default instances and default string values in these, constructing
+// them in place on first use and destroying them with DestroyStaticObject()
+// at shutdown.  Since the storage has no constructor it is set up before any
+// dynamic initialization and costs no heap allocation.
+template <typename Type>
+union StaticStorage {
+  char bytes[sizeof(Type)];
+  double align_double;
+  int64 align_int64;
+  void* align_pointer;
+};
+
+template <typename Type>
+inline void DestroyStaticObject(const Type& object) {
+  const_cast<Type&>(object).~Type();
+}
+
+// Base of the struct into which generated code moves the fields a field
+// profile counts rarely or never (see the field_profile option of the C++
+// code generator).  Each message points at a shared default instance of the
+// struct, holding the fields' default values, until it first writes one of
+// them.
+class LIBPROTOBUF_EXPORT ColdFields {
+ public:
+  ColdFields() {}
+  virtual ~ColdFields();
+
+  // Allocates a struct of the same type holding default values.
+  virtual ColdFields* New() const = 0;
+
+  // Like messages, the structs are counted as ALLOCATION_MESSAGE by
+  // GetAllocationStats() and allocated through the installed Allocator.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+  static void* operator new(size_t size, const std::nothrow_t&) throw();
+  static void operator delete(void* ptr, const std::nothrow_t&) throw();
+  static void* operator new(size_t, void* place) { return place; }
+  static void operator delete(void*, void*) {}
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ColdFields);
+};
+
+// Returns the index of the lowest set bit of a non-zero word.  Generated code
+// of messages with many fields uses it to visit only the fields whose
+// has-bits are set.
+inline int LowestSetBit32(uint32 bits) {
+#ifdef __GNUC__
+  return __builtin_ctz(bits);
+#else
+  // Isolate the lowest bit and look its position up with a de Bruijn
+  // sequence.
+  static const int kPositions[32] = {
+     0,  1, 28,  2, 29, 14, 24,  3, 30, 22, 20, 15, 25, 17,  4,  8,
+    31, 27, 13, 23, 21, 19, 16,  7, 26, 12, 18,  6, 11,  5, 10,  9
+  };
+  return kPositions[((bits & (~bits + 1)) * 0x077CB531u) >> 27];
+#endif
+}
+
 
 }  // namespace internal
 }  // namespace protobuf
@@ -313,6 +313,9 @@ class LIBPROTOBUF_EXPORT CodedInputStream {
   // stack is hit, or -1 if no limits are in place.
   int BytesUntilLimit();
 
+  // Returns the number of bytes read from the start of the input so far.
+  int CurrentPosition() const;
+
   // Total Bytes Limit -----------------------------------------------
   // To prevent malicious users from sending excessively large messages
   // and causing integer overflows or memory exhaustion, CodedInputStream
@@ -1042,6 +1045,10 @@ inline int CodedInputStream::BufferSize() const {
   return buffer_end_ - buffer_;
 }
 
+inline int CodedInputStream::CurrentPosition() const {
+  return total_bytes_read_ - (BufferSize() + buffer_size_after_limit_);
+}
+
 inline CodedInputStream::CodedInputStream(ZeroCopyInputStream* input)
   : input_(input),
     buffer_(NULL),
@@ -92,6 +92,14 @@
 #include <google/protobuf/io/zero_copy_stream.h>
 #include <google/protobuf/stubs/strutil.h>
 
+// SSE2 is part of every x86-64 processor; 32-bit x86 builds get it only
+// when they ask for it.
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GOOGLE_PROTOBUF_TOKENIZER_SSE2
+#endif
+
 namespace google {
 namespace protobuf {
 namespace io {
@@ -142,6 +150,118 @@ CHARACTER_CLASS(Escape, c == 'a' || c == 'b' || c == 'f' || c == 'n' ||
 
 #undef CHARACTER_CLASS
 
+// Most of the input is made of runs of characters which the tokenizer only
+// has to step over:  whitespace, the rest of an identifier or number, the
+// body of a string or comment.  The functions below find where such a run
+// ends within the current buffer, sixteen bytes at a time where SSE2 is
+// available.  A run never includes '\n' or '\t', which NextChar() has to
+// see to keep the line and column right, or '\0'.
+
+#ifdef GOOGLE_PROTOBUF_TOKENIZER_SSE2
+
+// Returns the index of the lowest set bit of a non-zero mask.
+inline int LowestSetBit(int mask) {
+#ifdef __GNUC__
+  return __builtin_ctz(mask);
+#else
+  int bit = 0;
+  while ((mask & 1) == 0) {
+    mask >>= 1;
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+inline __m128i LoadBlock(const char* p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+// Marks the bytes of block which are in [low, high].  The comparisons are
+// signed, so this only works for ranges of ASCII characters other than '\0';
+// bytes of 0x80 and up are never in range.
+inline __m128i InRange(__m128i block, char low, char high) {
+  return _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(low - 1)),
+                       _mm_cmplt_epi8(block, _mm_set1_epi8(high + 1)));
+}
+
+// Given the marks of the bytes which belong to a run, returns the offset of
+// the first byte of the block which does not, or 16 if they all do.
+inline int RunLength(__m128i in_run) {
+  int stop = ~_mm_movemask_epi8(in_run) & 0xFFFF;
+  return stop == 0 ? 16 : LowestSetBit(stop);
+}
+
+#endif  // GOOGLE_PROTOBUF_TOKENIZER_SSE2
+
+// Returns the first character in [p, end) which is not in CharacterClass,
+// or is '\n' or '\t'.  Returns end if there is none.
+template<typename CharacterClass>
+inline const char* ScanRun(const char* p, const char* end) {
+  while (p < end && CharacterClass::InClass(*p) && *p != '\n' && *p != '\t') {
+    ++p;
+  }
+  return p;
+}
+
+#ifdef GOOGLE_PROTOBUF_TOKENIZER_SSE2
+
+template<>
+inline const char* ScanRun<Whitespace>(const char* p, const char* end) {
+  for (; end - p >= 16; p += 16) {
+    __m128i block = LoadBlock(p);
+    int length = RunLength(
+        _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')),
+                     InRange(block, '\v', '\r')));  // \v, \f and \r.
+    if (length < 16) return p + length;
+  }
+  while (p < end && (*p == ' ' || ('\v' <= *p && *p <= '\r'))) ++p;
+  return p;
+}
+
+template<>
+inline const char* ScanRun<Alphanumeric>(const char* p, const char* end) {
+  for (; end - p >= 16; p += 16) {
+    __m128i block = LoadBlock(p);
+    int length = RunLength(
+        _mm_or_si128(
+            _mm_or_si128(InRange(block, 'a', 'z'), InRange(block, 'A', 'Z')),
+            _mm_or_si128(InRange(block, '0', '9'),
+                         _mm_cmpeq_epi8(block, _mm_set1_epi8('_')))));
+    if (length < 16) return p + length;
+  }
+  while (p < end && Alphanumeric::InClass(*p)) ++p;
+  return p;
+}
+
+#endif  // GOOGLE_PROTOBUF_TOKENIZER_SSE2
+
+// Returns the first character in [p, end) which is a, b or c, or any
+// control character.  Returns end if there is none.
+inline const char* ScanUntil(const char* p, const char* end,
+                             char a, char b, char c) {
+#ifdef GOOGLE_PROTOBUF_TOKENIZER_SSE2
+  for (; end - p >= 16; p += 16) {
+    __m128i block = LoadBlock(p);
+    // Control characters are the bytes up to 0x1F.  _mm_min_epu8() compares
+    // unsigned, so that UTF-8 and other high bytes are not among them.
+    __m128i stop = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(a)),
+                     _mm_cmpeq_epi8(block, _mm_set1_epi8(b))),
+        _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(c)),
+                     _mm_cmpeq_epi8(_mm_min_epu8(block, _mm_set1_epi8(0x1F)),
+                                    block)));
+    int length = RunLength(_mm_xor_si128(stop, _mm_set1_epi8(-1)));
+    if (length < 16) return p + length;
+  }
+#endif
+  while (p < end && *p != a && *p != b && *p != c &&
+         static_cast<unsigned char>(*p) >= ' ') {
+    ++p;
+  }
+  return p;
+}
+
 // Given a char, interpret it as a numeric digit and return its value.
 // This supports any number base up to 36.
 inline int DigitValue(char digit) {
@@ -188,8 +308,11 @@ Tokenizer::Tokenizer(ZeroCopyInputStream* input,
     line_(0),
     column_(0),
     token_start_(-1),
+    current_text_(""),
+    current_text_size_(0),
     allow_f_after_float_(false),
-    comment_style_(CPP_COMMENT_STYLE) {
+    comment_style_(CPP_COMMENT_STYLE),
+    copy_token_text_(true) {
 
   current_.line = 0;
   current_.column = 0;
@@ -231,6 +354,18 @@ void Tokenizer::NextChar() {
   }
 }
 
+inline void Tokenizer::AdvanceTo(const char* stop) {
+  int count = stop - (buffer_ + buffer_pos_);
+  if (count == 0) return;
+  column_ += count;
+  buffer_pos_ += count;
+  if (buffer_pos_ < buffer_size_) {
+    current_char_ = buffer_[buffer_pos_];
+  } else {
+    Refresh();
+  }
+}
+
 void Tokenizer::Refresh() {
   if (read_error_) {
     current_char_ = '\0';
@@ -270,12 +405,25 @@ inline void Tokenizer::StartToken() {
 }
 
 inline void Tokenizer::EndToken() {
-  // Note:  The if() is necessary because some STL implementations crash when
-  //   you call string::append(NULL, 0), presumably because they are trying to
-  //   be helpful by detecting the NULL pointer, even though there's nothing
-  //   wrong with reading zero bytes from NULL.
-  if (buffer_pos_ != token_start_) {
-    current_.text.append(buffer_ + token_start_, buffer_pos_ - token_start_);
+  // Note:  The if()s are necessary because some STL implementations crash
+  //   when you call string::append(NULL, 0), presumably because they are
+  //   trying to be helpful by detecting the NULL pointer, even though
+  //   there's nothing wrong with reading zero bytes from NULL.
+  int size = buffer_pos_ - token_start_;
+  if (current_.text.empty()) {
+    // Refresh() didn't have to save a part of the token, so all of it is
+    // still in the buffer.
+    current_text_ = buffer_ + token_start_;
+    current_text_size_ = size;
+    if (copy_token_text_ && size != 0) {
+      current_.text.append(current_text_, size);
+    }
+  } else {
+    if (size != 0) {
+      current_.text.append(buffer_ + token_start_, size);
+    }
+    current_text_ = current_.text.data();
+    current_text_size_ = current_.text.size();
   }
   token_start_ = -1;
   current_.end_column = column_;
@@ -311,7 +459,13 @@ inline bool Tokenizer::TryConsume(char c) {
 template<typename CharacterClass>
 inline void Tokenizer::ConsumeZeroOrMore() {
   while (CharacterClass::InClass(current_char_)) {
-    NextChar();
+    const char* stop = ScanRun<CharacterClass>(buffer_ + buffer_pos_,
+                                               buffer_ + buffer_size_);
+    if (stop == buffer_ + buffer_pos_) {
+      NextChar();  // '\n' or '\t'.
+    } else {
+      AdvanceTo(stop);
+    }
   }
 }
 
@@ -320,9 +474,7 @@ inline void Tokenizer::ConsumeOneOrMore(const char* error) {
   if (!CharacterClass::InClass(current_char_)) {
     AddError(error);
   } else {
-    do {
-      NextChar();
-    } while (CharacterClass::InClass(current_char_));
+    ConsumeZeroOrMore<CharacterClass>();
   }
 }
 
@@ -332,6 +484,10 @@ inline void Tokenizer::ConsumeOneOrMore(const char* error) {
 
 void Tokenizer::ConsumeString(char delimiter) {
   while (true) {
+    // Skip ahead to the next character which needs a closer look.
+    AdvanceTo(ScanUntil(buffer_ + buffer_pos_, buffer_ + buffer_size_,
+                        delimiter, '\\', delimiter));
+
     switch (current_char_) {
       case '\0':
       case '\n': {
@@ -428,7 +584,13 @@ Tokenizer::TokenType Tokenizer::ConsumeNumber(bool started_with_zero,
 
 void Tokenizer::ConsumeLineComment() {
   while (current_char_ != '\0' && current_char_ != '\n') {
-    NextChar();
+    const char* stop = ScanUntil(buffer_ + buffer_pos_,
+                                 buffer_ + buffer_size_, '\n', '\n', '\n');
+    if (stop == buffer_ + buffer_pos_) {
+      NextChar();  // Some other control character, such as '\t'.
+    } else {
+      AdvanceTo(stop);
+    }
   }
   TryConsume('\n');
 }
@@ -441,7 +603,13 @@ void Tokenizer::ConsumeBlockComment() {
     while (current_char_ != '\0' &&
            current_char_ != '*' &&
            current_char_ != '/') {
-      NextChar();
+      const char* stop = ScanUntil(buffer_ + buffer_pos_,
+                                   buffer_ + buffer_size_, '*', '/', '*');
+      if (stop == buffer_ + buffer_pos_) {
+        NextChar();  // A control character, such as '\n'.
+      } else {
+        AdvanceTo(stop);
+      }
     }
 
     if (TryConsume('*') && TryConsume('/')) {
@@ -482,7 +650,9 @@ bool Tokenizer::Next() {
       } else {
         // Oops, it was just a slash.  Return it.
         current_.type = TYPE_SYMBOL;
-        current_.text = "/";
+        current_text_ = "/";
+        current_text_size_ = 1;
+        if (copy_token_text_) current_.text = "/";
         current_.line = line_;
         current_.column = column_ - 1;
         return true;
@@ -551,6 +721,8 @@ bool Tokenizer::Next() {
   // EOF
   current_.type = TYPE_END;
   current_.text.clear();
+  current_text_ = "";
+  current_text_size_ = 0;
   current_.line = line_;
   current_.column = column_;
   current_.end_column = column_;
@@ -566,15 +738,19 @@ bool Tokenizer::Next() {
 
 bool Tokenizer::ParseInteger(const std::string& text, uint64 max_value,
                              uint64* output) {
+  return ParseInteger(text.data(), text.data() + text.size(), max_value,
+                      output);
+}
+
+bool Tokenizer::ParseInteger(const char* begin, const char* end,
+                             uint64 max_value, uint64* output) {
   // Sadly, we can't just use strtoul() since it is only 32-bit and strtoull()
   // is non-standard.  I hate the C standard library.  :(
 
-//  return strtoull(text.c_str(), NULL, 0);
-
-  const char* ptr = text.c_str();
+  const char* ptr = begin;
   int base = 10;
-  if (ptr[0] == '0') {
-    if (ptr[1] == 'x' || ptr[1] == 'X') {
+  if (end - ptr >= 1 && ptr[0] == '0') {
+    if (end - ptr >= 2 && (ptr[1] == 'x' || ptr[1] == 'X')) {
       // This is hex.
       base = 16;
       ptr += 2;
@@ -584,77 +760,97 @@ bool Tokenizer::ParseInteger(const std::string& text, uint64 max_value,
     }
   }
 
+  // This many digits can't overflow a uint64, so only the final result
+  // needs to be compared with max_value.  Only the (rare) digits beyond
+  // these need the expensive check.
+  int safe_digits = base == 16 ? 16 : base == 8 ? 21 : 19;
+  const char* safe_end = end - ptr > safe_digits ? ptr + safe_digits : end;
+
   uint64 result = 0;
-  for (; *ptr != '\0'; ptr++) {
+  for (; ptr < end; ptr++) {
     int digit = DigitValue(*ptr);
     GOOGLE_LOG_IF(DFATAL, digit < 0 || digit >= base)
       << " Tokenizer::ParseInteger() passed text that could not have been"
-         " tokenized as an integer: " << protobuf::CEscape(text);
-    if (digit > max_value || result > (max_value - digit) / base) {
+         " tokenized as an integer: "
+      << protobuf::CEscape(std::string(begin, end - begin));
+    if (ptr < safe_end) {
+      result = result * base + digit;
+    } else if (digit > max_value || result > (max_value - digit) / base) {
       // Overflow.
       return false;
+    } else {
+      result = result * base + digit;
     }
-    result = result * base + digit;
   }
 
+  if (result > max_value) return false;
   *output = result;
   return true;
 }
 
 double Tokenizer::ParseFloat(const std::string& text) {
-  const char* start = text.c_str();
-  char* end;
-  double result = NoLocaleStrtod(start, &end);
+  return ParseFloat(text.data(), text.data() + text.size());
+}
+
+double Tokenizer::ParseFloat(const char* begin, const char* end) {
+  double result;
+  const char* ptr = ParseDecimalDouble(begin, end, &result);
 
   // "1e" is not a valid float, but if the tokenizer reads it, it will
   // report an error but still return it as a valid token.  We need to
   // accept anything the tokenizer could possibly return, error or not.
-  if (*end == 'e' || *end == 'E') {
-    ++end;
-    if (*end == '-' || *end == '+') ++end;
+  if (ptr != end && (*ptr == 'e' || *ptr == 'E')) {
+    ++ptr;
+    if (ptr != end && (*ptr == '-' || *ptr == '+')) ++ptr;
   }
 
   // If the Tokenizer had allow_f_after_float_ enabled, the float may be
   // suffixed with the letter 'f'.
-  if (*end == 'f' || *end == 'F') {
-    ++end;
+  if (ptr != end && (*ptr == 'f' || *ptr == 'F')) {
+    ++ptr;
   }
 
-  GOOGLE_LOG_IF(DFATAL, end - start != text.size() || *start == '-')
+  GOOGLE_LOG_IF(DFATAL, ptr != end || (begin != end && *begin == '-'))
     << " Tokenizer::ParseFloat() passed text that could not have been"
-       " tokenized as a float: " << protobuf::CEscape(text);
+       " tokenized as a float: "
+    << protobuf::CEscape(std::string(begin, end - begin));
   return result;
 }
 
 void Tokenizer::ParseStringAppend(const std::string& text, std::string* output) {
-  // Reminder:  text[0] is always the quote character.  (If text is
+  ParseStringAppend(text.data(), text.data() + text.size(), output);
+}
+
+void Tokenizer::ParseStringAppend(const char* begin, const char* end,
+                                  std::string* output) {
+  // Reminder:  *begin is always the quote character.  (If text is
   //   empty, it's invalid, so we'll just return.)
-  if (text.empty()) {
+  if (begin == end) {
     GOOGLE_LOG(DFATAL)
       << " Tokenizer::ParseStringAppend() passed text that could not"
-         " have been tokenized as a string: " << protobuf::CEscape(text);
+         " have been tokenized as a string: \"\"";
     return;
   }
 
-  output->reserve(output->size() + text.size());
+  output->reserve(output->size() + (end - begin));
 
   // Loop through the string copying characters to "output" and
   // interpreting escape sequences.  Note that any invalid escape
   // sequences or other errors were already reported while tokenizing.
   // In this case we do not need to produce valid results.
-  for (const char* ptr = text.c_str() + 1; *ptr != '\0'; ptr++) {
-    if (*ptr == '\\' && ptr[1] != '\0') {
+  for (const char* ptr = begin + 1; ptr != end; ptr++) {
+    if (*ptr == '\\' && ptr + 1 != end) {
       // An escape sequence.
       ++ptr;
 
       if (OctalDigit::InClass(*ptr)) {
         // An octal escape.  May one, two, or three digits.
         int code = DigitValue(*ptr);
-        if (OctalDigit::InClass(ptr[1])) {
+        if (ptr + 1 != end && OctalDigit::InClass(ptr[1])) {
           ++ptr;
           code = code * 8 + DigitValue(*ptr);
         }
-        if (OctalDigit::InClass(ptr[1])) {
+        if (ptr + 1 != end && OctalDigit::InClass(ptr[1])) {
           ++ptr;
           code = code * 8 + DigitValue(*ptr);
         }
@@ -664,11 +860,11 @@ void Tokenizer::ParseStringAppend(const std::string& text, std::string* output)
         // A hex escape.  May zero, one, or two digits.  (The zero case
         // will have been caught as an error earlier.)
         int code = 0;
-        if (HexDigit::InClass(ptr[1])) {
+        if (ptr + 1 != end && HexDigit::InClass(ptr[1])) {
           ++ptr;
           code = DigitValue(*ptr);
         }
-        if (HexDigit::InClass(ptr[1])) {
+        if (ptr + 1 != end && HexDigit::InClass(ptr[1])) {
           ++ptr;
           code = code * 16 + DigitValue(*ptr);
         }
@@ -679,7 +875,7 @@ void Tokenizer::ParseStringAppend(const std::string& text, std::string* output)
         output->push_back(TranslateEscape(*ptr));
       }
 
-    } else if (*ptr == text[0]) {
+    } else if (*ptr == *begin) {
       // Ignore quote matching the starting quote.
     } else {
       output->push_back(*ptr);
@@ -133,6 +133,13 @@ class LIBPROTOBUF_EXPORT Tokenizer {
   // previous call to Next().
   const Token& previous();
 
+  // The text of the current token, like current().text, but without
+  // copying it:  unless the token straddles two buffers of the input stream,
+  // this points directly into the stream's buffer.  The text is not
+  // NUL-terminated and is only valid until the next call to Next().
+  const char* current_text() const { return current_text_; }
+  int current_text_size() const { return current_text_size_; }
+
   // Advance to the next token.  Returns false if the end of the input is
   // reached.
   bool Next();
@@ -143,6 +150,8 @@ class LIBPROTOBUF_EXPORT Tokenizer {
   // comes from a TYPE_FLOAT token parsed by Tokenizer.  If it doesn't, the
   // result is undefined (possibly an assert failure).
   static double ParseFloat(const std::string& text);
+  // Same, for the text in [begin, end).  Does not allocate.
+  static double ParseFloat(const char* begin, const char* end);
 
   // Parses a TYPE_STRING token.  This never fails, so long as the text actually
   // comes from a TYPE_STRING token parsed by Tokenizer.  If it doesn't, the
@@ -151,6 +160,9 @@ class LIBPROTOBUF_EXPORT Tokenizer {
 
   // Identical to ParseString, but appends to output.
   static void ParseStringAppend(const std::string& text, std::string* output);
+  // Same, for the text in [begin, end).
+  static void ParseStringAppend(const char* begin, const char* end,
+                                std::string* output);
 
   // Parses a TYPE_INTEGER token.  Returns false if the result would be
   // greater than max_value.  Otherwise, returns true and sets *output to the
@@ -159,6 +171,9 @@ class LIBPROTOBUF_EXPORT Tokenizer {
   // failure).
   static bool ParseInteger(const std::string& text, uint64 max_value,
                            uint64* output);
+  // Same, for the text in [begin, end).
+  static bool ParseInteger(const char* begin, const char* end,
+                           uint64 max_value, uint64* output);
 
   // Options ---------------------------------------------------------
 
@@ -180,6 +195,12 @@ class LIBPROTOBUF_EXPORT Tokenizer {
   // Sets the comment style.
   void set_comment_style(CommentStyle style) { comment_style_ = style; }
 
+  // Set false if only current_text() will be used to read token text.  Then
+  // current().text and previous().text are not filled in (except for tokens
+  // which straddle buffers), so that tokenizing never copies or allocates.
+  // Defaults to true.
+  void set_copy_token_text(bool value) { copy_token_text_ = value; }
+
   // -----------------------------------------------------------------
  private:
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(Tokenizer);
@@ -206,9 +227,14 @@ class LIBPROTOBUF_EXPORT Tokenizer {
   // currently parsing a token, this is -1.
   int token_start_;
 
+  // Returned by current_text() and current_text_size().
+  const char* current_text_;
+  int current_text_size_;
+
   // Options.
   bool allow_f_after_float_;
   CommentStyle comment_style_;
+  bool copy_token_text_;
 
   // Since we count columns we need to interpret tabs somehow.  We'll take
   // the standard 8-character definition for lack of any way to do better.
@@ -223,12 +249,18 @@ class LIBPROTOBUF_EXPORT Tokenizer {
   // Read a new buffer from the input.
   void Refresh();
 
+  // Consume all characters from the current one up to, but not including,
+  // stop, which points into the current buffer.  None of them may be '\n'
+  // or '\t', so each one moves the column along by one.
+  inline void AdvanceTo(const char* stop);
+
   // Called when the current character is the first character of a new
   // token (not including whitespace or comments).
   inline void StartToken();
   // Called when the current character is the first character after the
-  // end of the last token.  After this returns, current_.text will
-  // contain all text consumed since StartToken() was called.
+  // end of the last token.  After this returns, current_text_ will point
+  // at all text consumed since StartToken() was called, and so will
+  // current_.text if copy_token_text_ is set.
   inline void EndToken();
 
   // Convenience method to add an error at the current line and column.
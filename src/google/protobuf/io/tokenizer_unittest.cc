@@ -421,6 +421,29 @@ MultiTokenCase kMultiTokenCases[] = {
     { Tokenizer::TYPE_IDENTIFIER, "bar", 1, 11, 14 },
     { Tokenizer::TYPE_END       , ""   , 1, 14, 14 },
   }},
+
+  // Test runs longer than the sixteen bytes which are scanned at a time.
+  { "a_very_long_identifier_Name_0123456789                    "
+    "\"a string literal longer than sixteen bytes\""
+    " \r\v\f \r\v\f \r\v\f \r\v\f \r\v\fz", {
+    { Tokenizer::TYPE_IDENTIFIER, "a_very_long_identifier_Name_0123456789",
+      0, 0, 38 },
+    { Tokenizer::TYPE_STRING,
+      "\"a string literal longer than sixteen bytes\"", 0, 58, 102 },
+    { Tokenizer::TYPE_IDENTIFIER, "z", 0, 122, 123 },
+    { Tokenizer::TYPE_END       , "" , 0, 123, 123 },
+  }},
+
+  // Test that tabs, newlines and high bytes within long runs are accounted
+  // for.
+  { "\"\tstring with a tab and \300\301 high bytes\"\t  \t"
+    "// a comment with a tab\t and \300 more than sixteen bytes\n"
+    "/* a block comment\tspanning\nmore than one line */ end", {
+    { Tokenizer::TYPE_STRING,
+      "\"\tstring with a tab and \300\301 high bytes\"", 0, 0, 44 },
+    { Tokenizer::TYPE_IDENTIFIER, "end", 2, 22, 25 },
+    { Tokenizer::TYPE_END       , ""   , 2, 25, 25 },
+  }},
 };
 
 TEST_2D(TokenizerTest, MultipleTokens, kMultiTokenCases, kBlockSizes) {
@@ -465,6 +488,8 @@ TEST_2D(TokenizerTest, MultipleTokens, kMultiTokenCases, kBlockSizes) {
     // Check that the token matches the expected one.
     EXPECT_EQ(token.type, tokenizer.current().type);
     EXPECT_EQ(token.text, tokenizer.current().text);
+    EXPECT_EQ(token.text, std::string(tokenizer.current_text(),
+                                      tokenizer.current_text_size()));
     EXPECT_EQ(token.line, tokenizer.current().line);
     EXPECT_EQ(token.column, tokenizer.current().column);
     EXPECT_EQ(token.end_column, tokenizer.current().end_column);
@@ -475,6 +500,43 @@ TEST_2D(TokenizerTest, MultipleTokens, kMultiTokenCases, kBlockSizes) {
   EXPECT_TRUE(error_collector.text_.empty());
 }
 
+// Same, but with set_copy_token_text(false), so only current_text() can
+// be checked.
+TEST_2D(TokenizerTest, MultipleTokensWithoutCopy, kMultiTokenCases,
+        kBlockSizes) {
+  TestInputStream input(kMultiTokenCases_case.input.data(),
+                        kMultiTokenCases_case.input.size(),
+                        kBlockSizes_case);
+  TestErrorCollector error_collector;
+  Tokenizer tokenizer(&input, &error_collector);
+  tokenizer.set_copy_token_text(false);
+
+  EXPECT_EQ(0, tokenizer.current_text_size());
+
+  int i = 0;
+  Tokenizer::Token token;
+  do {
+    token = kMultiTokenCases_case.output[i++];
+
+    SCOPED_TRACE(testing::Message() << "Token #" << i << ": " << token.text);
+
+    if (token.type != Tokenizer::TYPE_END) {
+      ASSERT_TRUE(tokenizer.Next());
+    } else {
+      ASSERT_FALSE(tokenizer.Next());
+    }
+
+    EXPECT_EQ(token.type, tokenizer.current().type);
+    EXPECT_EQ(token.text, std::string(tokenizer.current_text(),
+                                      tokenizer.current_text_size()));
+    EXPECT_EQ(token.line, tokenizer.current().line);
+    EXPECT_EQ(token.column, tokenizer.current().column);
+
+  } while (token.type != Tokenizer::TYPE_END);
+
+  EXPECT_TRUE(error_collector.text_.empty());
+}
+
 // This test causes gcc 3.3.5 (and earlier?) to give the cryptic error:
 //   "sorry, unimplemented: `method_call_expr' not supported by dump_expr"
 #if !defined(__GNUC__) || __GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ > 3)
@@ -550,6 +612,25 @@ TEST_F(TokenizerTest, ParseInteger) {
   EXPECT_FALSE(Tokenizer::ParseInteger("12346", 12345, &i));
   EXPECT_TRUE (Tokenizer::ParseInteger("0xFFFFFFFFFFFFFFFF" , kuint64max, &i));
   EXPECT_FALSE(Tokenizer::ParseInteger("0x10000000000000000", kuint64max, &i));
+  EXPECT_TRUE (Tokenizer::ParseInteger("18446744073709551615", kuint64max, &i));
+  EXPECT_EQ(kuint64max, i);
+  EXPECT_FALSE(Tokenizer::ParseInteger("18446744073709551616", kuint64max, &i));
+  EXPECT_FALSE(Tokenizer::ParseInteger("99999999999999999999", kuint64max, &i));
+  EXPECT_FALSE(Tokenizer::ParseInteger("9223372036854775808",
+                                       kint64max, &i));
+  EXPECT_TRUE (Tokenizer::ParseInteger("01777777777777777777777",
+                                       kuint64max, &i));
+  EXPECT_EQ(kuint64max, i);
+  EXPECT_FALSE(Tokenizer::ParseInteger("02000000000000000000000",
+                                       kuint64max, &i));
+  EXPECT_TRUE (Tokenizer::ParseInteger("00000000000000000000000000000001",
+                                       1, &i));
+  EXPECT_EQ(1, i);
+
+  // Only the given range is parsed.
+  const char* text = "12345";
+  EXPECT_TRUE(Tokenizer::ParseInteger(text, text + 3, kuint64max, &i));
+  EXPECT_EQ(123, i);
 }
 
 TEST_F(TokenizerTest, ParseFloat) {
@@ -567,6 +648,13 @@ TEST_F(TokenizerTest, ParseFloat) {
   EXPECT_DOUBLE_EQ(6e-12, Tokenizer::ParseFloat("6e-12"));
   EXPECT_DOUBLE_EQ(1.2  , Tokenizer::ParseFloat("1.2"));
   EXPECT_DOUBLE_EQ(1.e2 , Tokenizer::ParseFloat("1.e2"));
+  EXPECT_EQ(0.1, Tokenizer::ParseFloat("0.1"));
+  EXPECT_EQ(1.7976931348623157e308,
+            Tokenizer::ParseFloat("1.7976931348623157e308"));
+
+  // Only the given range is parsed.
+  const char* text = "1.25e3";
+  EXPECT_EQ(1.25, Tokenizer::ParseFloat(text, text + 4));
 
   // Test invalid integers that may still be tokenized as integers.
   EXPECT_DOUBLE_EQ(1, Tokenizer::ParseFloat("1e"));
@@ -620,6 +708,17 @@ TEST_F(TokenizerTest, ParseString) {
 #endif  // GTEST_HAS_DEATH_TEST
 }
 
+TEST_F(TokenizerTest, ParseStringRange) {
+  // Escapes at the end of the range mustn't read past it.
+  const char* text = "'a\\101'\\x4";
+  std::string output;
+  Tokenizer::ParseStringAppend(text, text + 7, &output);
+  EXPECT_EQ("aA", output);
+  output.clear();
+  Tokenizer::ParseStringAppend(text, text + 4, &output);
+  EXPECT_EQ("a\001", output);
+}
+
 TEST_F(TokenizerTest, ParseStringAppend) {
   // Check that ParseString and ParseStringAppend differ.
   std::string output("stuff+");
@@ -657,6 +756,8 @@ ErrorCase kErrorCases[] = {
     "0:4: String literals cannot cross line boundaries.\n" },
   { "'bar\nfoo", true,
     "0:4: String literals cannot cross line boundaries.\n" },
+  { "'a string literal longer than sixteen bytes\nfoo", true,
+    "0:43: String literals cannot cross line boundaries.\n" },
 
   // Integer errors.
   { "123foo", true,
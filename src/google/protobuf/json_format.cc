@@ -0,0 +1,1456 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <google/protobuf/json_format.h>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/tokenizer.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+
+namespace google {
+namespace protobuf {
+
+namespace {
+
+const char kBase64Digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Returns the value of a base64 digit, or -1 if c is not one.  Both the
+// standard and the URL-safe alphabets are accepted.
+int Base64DigitValue(char c) {
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '+' || c == '-') return 62;
+  if (c == '/' || c == '_') return 63;
+  return -1;
+}
+
+// Decodes base64 text, with or without '=' padding, and appends the bytes
+// to *output.  Returns false if the text is not valid base64.
+bool Base64Unescape(const char* text, int size, std::string* output) {
+  int padding = 0;
+  while (size > 0 && text[size - 1] == '=' && padding < 2) {
+    --size;
+    ++padding;
+  }
+  if (size % 4 == 1 || (padding > 0 && (size + padding) % 4 != 0)) {
+    return false;
+  }
+
+  output->reserve(output->size() + size / 4 * 3 + 2);
+  uint32 bits = 0;
+  int bit_count = 0;
+  for (int i = 0; i < size; i++) {
+    int value = Base64DigitValue(text[i]);
+    if (value < 0) return false;
+    bits = (bits << 6) | value;
+    bit_count += 6;
+    if (bit_count >= 8) {
+      bit_count -= 8;
+      output->push_back(static_cast<char>(bits >> bit_count));
+    }
+  }
+  return true;
+}
+
+// Appends the UTF-8 encoding of a Unicode code point to *output.
+void AppendUtf8(uint32 code_point, std::string* output) {
+  if (code_point < 0x80) {
+    output->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    output->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    output->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    output->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    output->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    output->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    output->push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    output->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    output->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    output->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+inline bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// Characters which may appear in a JSON number.
+inline bool IsNumberChar(int c) {
+  return IsDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' ||
+         c == 'E';
+}
+
+// Returns true if [begin, end) is exactly one number in JSON syntax:
+//   -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool IsJsonNumber(const char* begin, const char* end) {
+  const char* p = begin;
+  if (p < end && *p == '-') ++p;
+  if (p == end || !IsDigit(*p)) return false;
+  if (*p == '0') {
+    ++p;
+  } else {
+    while (p < end && IsDigit(*p)) ++p;
+  }
+  if (p < end && *p == '.') {
+    ++p;
+    if (p == end || !IsDigit(*p)) return false;
+    while (p < end && IsDigit(*p)) ++p;
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    if (p < end && (*p == '+' || *p == '-')) ++p;
+    if (p == end || !IsDigit(*p)) return false;
+    while (p < end && IsDigit(*p)) ++p;
+  }
+  return p == end;
+}
+
+// Converts a JSON number with an integral value (e.g. "12", "-3" or
+// "1.5e3") to its magnitude and sign.  Returns false if the value is not
+// integral or its magnitude does not fit in a uint64.
+bool JsonNumberToInteger(const char* begin, const char* end,
+                         uint64* magnitude, bool* negative) {
+  *negative = (*begin == '-');
+  const char* p = *negative ? begin + 1 : begin;
+
+  uint64 result = 0;
+  for (; p < end && IsDigit(*p); ++p) {
+    int digit = *p - '0';
+    if (result > (kuint64max - digit) / 10) return false;
+    result = result * 10 + digit;
+  }
+  if (p == end) {
+    *magnitude = result;
+    return true;
+  }
+
+  // A fraction or an exponent.  Go through a double; integers this large
+  // can't have been written exactly anyway.
+  double value;
+  ParseDecimalDouble(begin, end, &value);
+  if (*negative) value = -value;
+  if (!(value < 18446744073709551616.0)) return false;  // 2^64, or NaN
+  result = static_cast<uint64>(value);
+  if (static_cast<double>(result) != value) return false;
+  *magnitude = result;
+  return true;
+}
+
+}  // namespace
+
+// Makes code slightly more readable.  The meaning of "DO(foo)" is
+// "Execute foo and fail if it fails.", where failure is indicated by
+// returning false.
+#define DO(STATEMENT) if (STATEMENT) {} else return false
+
+// Reads JSON straight from the ZeroCopyInputStream's buffers and stores
+// each value into the message as soon as it has been read, so no document
+// tree is ever built.  Strings are decoded into buffers that are reused for
+// the whole parse, and numbers are converted in place when they don't
+// straddle two buffers.  Like TextFormat's parser, this is *not*
+// thread-safe.
+class JsonFormat::Parser::ParserImpl {
+ public:
+
+  // Determines if repeated values for a non-repeated field are
+  // permitted, e.g., the text {"foo": 1, "foo": 2} for a required/optional
+  // field named "foo".
+  enum SingularOverwritePolicy {
+    ALLOW_SINGULAR_OVERWRITES = 0,   // the last value is retained
+    FORBID_SINGULAR_OVERWRITES = 1,  // an error is issued
+  };
+
+  ParserImpl(const Descriptor* root_message_type,
+             io::ZeroCopyInputStream* input_stream,
+             io::ErrorCollector* error_collector,
+             bool ignore_unknown_fields,
+             SingularOverwritePolicy singular_overwrite_policy)
+    : input_(input_stream),
+      buffer_(NULL),
+      buffer_end_(NULL),
+      at_end_(false),
+      line_(0),
+      column_(0),
+      token_line_(0),
+      token_column_(0),
+      error_collector_(error_collector),
+      root_message_type_(root_message_type),
+      ignore_unknown_fields_(ignore_unknown_fields),
+      singular_overwrite_policy_(singular_overwrite_policy),
+      had_errors_(false) {
+  }
+  ~ParserImpl() {
+    // Give back whatever we didn't read, as Tokenizer does.
+    if (buffer_ < buffer_end_) {
+      input_->BackUp(buffer_end_ - buffer_);
+    }
+  }
+
+  // Parses a JSON object from the input into the given message.  Returns
+  // false if an error occurs (an error will also be logged to
+  // GOOGLE_LOG(ERROR)).
+  bool Parse(Message* output) {
+    SkipWhitespace();
+    StartToken();
+    DO(ConsumeObject(output, 0));
+    SkipWhitespace();
+    StartToken();
+    if (Peek() != -1) {
+      ReportError("Expected end of input, found " + DescribeNext() + ".");
+      return false;
+    }
+    return !had_errors_;
+  }
+
+  void ReportError(int line, int col, const std::string& message) {
+    had_errors_ = true;
+    if (error_collector_ == NULL) {
+      if (line >= 0) {
+        GOOGLE_LOG(ERROR) << "Error parsing JSON "
+                   << root_message_type_->full_name()
+                   << ": " << (line + 1) << ":"
+                   << (col + 1) << ": " << message;
+      } else {
+        GOOGLE_LOG(ERROR) << "Error parsing JSON "
+                   << root_message_type_->full_name()
+                   << ": " << message;
+      }
+    } else {
+      error_collector_->AddError(line, col, message);
+    }
+  }
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ParserImpl);
+
+  // Objects nested deeper than this are rejected rather than risk running
+  // out of stack.  Matches CodedInputStream's default recursion limit.
+  static const int kMaxDepth = 100;
+
+  // Reports an error at the start of the current token.
+  void ReportError(const std::string& message) {
+    ReportError(token_line_, token_column_, message);
+  }
+
+  // ---------------------------------------------------------------------
+  // Reading characters.
+
+  // Gets the next non-empty buffer from the input.  Returns false at the
+  // end of the input.
+  bool Refill() {
+    while (!at_end_) {
+      const void* data;
+      int size;
+      if (!input_->Next(&data, &size)) {
+        at_end_ = true;
+        buffer_ = buffer_end_ = NULL;
+        return false;
+      }
+      if (size > 0) {
+        buffer_ = static_cast<const char*>(data);
+        buffer_end_ = buffer_ + size;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Returns the next character without consuming it, or -1 at the end of
+  // the input.
+  int Peek() {
+    if (buffer_ == buffer_end_ && !Refill()) return -1;
+    return static_cast<uint8>(*buffer_);
+  }
+
+  // Consumes the character returned by the last call to Peek(), which must
+  // not have been -1.
+  void Advance() {
+    if (*buffer_ == '\n') {
+      ++line_;
+      column_ = 0;
+    } else {
+      ++column_;
+    }
+    ++buffer_;
+  }
+
+  void SkipWhitespace() {
+    while (true) {
+      int c = Peek();
+      if (c != ' ' && c != '\n' && c != '\r' && c != '\t') return;
+      Advance();
+    }
+  }
+
+  // Errors are reported at the position recorded by the last StartToken().
+  void StartToken() {
+    token_line_ = line_;
+    token_column_ = column_;
+  }
+
+  // Describes the next character for an error message.
+  std::string DescribeNext() {
+    int c = Peek();
+    if (c == -1) return "end of input";
+    return "\"" + CEscape(std::string(1, static_cast<char>(c))) + "\"";
+  }
+
+  // Consumes the given character, or reports an error.
+  bool Consume(char expected) {
+    if (Peek() == static_cast<uint8>(expected)) {
+      Advance();
+      return true;
+    }
+    StartToken();
+    ReportError(std::string("Expected \"") + expected + "\", found " +
+                DescribeNext() + ".");
+    return false;
+  }
+
+  // Consumes the given character if it is next.
+  bool TryConsume(char expected) {
+    if (Peek() == static_cast<uint8>(expected)) {
+      Advance();
+      return true;
+    }
+    return false;
+  }
+
+  // ---------------------------------------------------------------------
+  // Reading tokens.
+
+  // Consumes a run of letters, e.g. true, false or null.
+  void ConsumeWord(std::string* word) {
+    word->clear();
+    while (true) {
+      int c = Peek();
+      if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))) return;
+      word->push_back(static_cast<char>(c));
+      Advance();
+    }
+  }
+
+  // Returns true if the next token is a JSON null, and consumes it.
+  bool TryConsumeNull() {
+    if (Peek() != 'n') return false;
+    ConsumeWord(&word_);
+    if (word_ != "null") {
+      ReportError("Expected value, found \"" + word_ + "\".");
+    }
+    return true;
+  }
+
+  // Consumes a JSON string, decoding it into *output.
+  bool ConsumeString(std::string* output) {
+    output->clear();
+    if (Peek() != '"') {
+      ReportError("Expected string, found " + DescribeNext() + ".");
+      return false;
+    }
+    Advance();
+
+    while (true) {
+      if (buffer_ == buffer_end_ && !Refill()) {
+        ReportError("String literal not terminated.");
+        return false;
+      }
+
+      // Copy the longest run of characters that need no decoding.
+      const char* run = buffer_;
+      const char* p = run;
+      while (p < buffer_end_ && *p != '"' && *p != '\\' &&
+             static_cast<uint8>(*p) >= 0x20) {
+        ++p;
+      }
+      output->append(run, p - run);
+      column_ += p - run;
+      buffer_ = p;
+      if (p == buffer_end_) continue;
+
+      if (*p == '"') {
+        Advance();
+        return true;
+      } else if (*p == '\\') {
+        Advance();
+        DO(ConsumeEscape(output));
+      } else {
+        ReportError(line_, column_, "Invalid control character in string.");
+        return false;
+      }
+    }
+  }
+
+  // Consumes what follows a backslash in a string.
+  bool ConsumeEscape(std::string* output) {
+    int c = Peek();
+    switch (c) {
+      case '"':
+      case '\\':
+      case '/': output->push_back(static_cast<char>(c)); break;
+      case 'b': output->push_back('\b'); break;
+      case 'f': output->push_back('\f'); break;
+      case 'n': output->push_back('\n'); break;
+      case 'r': output->push_back('\r'); break;
+      case 't': output->push_back('\t'); break;
+      case 'u': {
+        Advance();
+        uint32 code_point;
+        DO(ConsumeHexDigits(&code_point));
+        if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+          // A high surrogate, which must be followed by a low one.
+          uint32 low_surrogate = 0;
+          if (!TryConsume('\\') || !TryConsume('u') ||
+              !ConsumeHexDigits(&low_surrogate) ||
+              low_surrogate < 0xDC00 || low_surrogate > 0xDFFF) {
+            ReportError(line_, column_, "Unpaired surrogate in string.");
+            return false;
+          }
+          code_point = 0x10000 + ((code_point - 0xD800) << 10) +
+                       (low_surrogate - 0xDC00);
+        } else if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+          ReportError(line_, column_, "Unpaired surrogate in string.");
+          return false;
+        }
+        AppendUtf8(code_point, output);
+        return true;
+      }
+      default:
+        ReportError(line_, column_, "Invalid escape sequence in string.");
+        return false;
+    }
+    Advance();
+    return true;
+  }
+
+  // Consumes the four hex digits of a \u escape.
+  bool ConsumeHexDigits(uint32* value) {
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+      int c = Peek();
+      int digit;
+      if (c >= '0' && c <= '9') {
+        digit = c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        digit = c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        digit = c - 'A' + 10;
+      } else {
+        ReportError(line_, column_, "Expected four hex digits after \\u.");
+        return false;
+      }
+      *value = (*value << 4) | digit;
+      Advance();
+    }
+    return true;
+  }
+
+  // Consumes a JSON number and points [*begin, *end) at its text, which is
+  // only valid until the next read.
+  bool ConsumeNumberText(const char** begin, const char** end) {
+    Peek();
+    const char* p = buffer_;
+    while (p < buffer_end_ && IsNumberChar(*p)) ++p;
+    if (p < buffer_end_) {
+      // The whole number is in the current buffer; use it where it is.
+      *begin = buffer_;
+      *end = p;
+      column_ += p - buffer_;
+      buffer_ = p;
+    } else {
+      number_.clear();
+      for (int c = Peek(); IsNumberChar(c); c = Peek()) {
+        number_.push_back(static_cast<char>(c));
+        Advance();
+      }
+      *begin = number_.data();
+      *end = *begin + number_.size();
+    }
+
+    if (!IsJsonNumber(*begin, *end)) {
+      if (*begin == *end) {
+        ReportError("Expected number, found " + DescribeNext() + ".");
+      } else {
+        ReportError("Invalid number \"" + std::string(*begin, *end) + "\".");
+      }
+      return false;
+    }
+    return true;
+  }
+
+  // Like ConsumeNumberText(), but also accepts a number written as a JSON
+  // string, e.g. "123".
+  bool ConsumeNumberOrString(const char** begin, const char** end) {
+    if (Peek() != '"') {
+      return ConsumeNumberText(begin, end);
+    }
+    DO(ConsumeString(&string_));
+    *begin = string_.data();
+    *end = *begin + string_.size();
+    if (!IsJsonNumber(*begin, *end)) {
+      ReportError("Expected number, found \"" + CEscape(string_) + "\".");
+      return false;
+    }
+    return true;
+  }
+
+  bool ConsumeUnsignedInteger(uint64* value, uint64 max_value) {
+    const char* begin;
+    const char* end;
+    DO(ConsumeNumberOrString(&begin, &end));
+    bool negative;
+    if (!JsonNumberToInteger(begin, end, value, &negative)) {
+      ReportError("Expected integer, found \"" + std::string(begin, end) +
+                  "\".");
+      return false;
+    }
+    if ((negative && *value != 0) || *value > max_value) {
+      ReportError("Integer out of range.");
+      return false;
+    }
+    return true;
+  }
+
+  bool ConsumeSignedInteger(int64* value, uint64 max_value) {
+    const char* begin;
+    const char* end;
+    DO(ConsumeNumberOrString(&begin, &end));
+    uint64 magnitude;
+    bool negative;
+    if (!JsonNumberToInteger(begin, end, &magnitude, &negative)) {
+      ReportError("Expected integer, found \"" + std::string(begin, end) +
+                  "\".");
+      return false;
+    }
+    // Two's complement always allows one more negative integer.
+    if (magnitude > max_value + (negative ? 1 : 0)) {
+      ReportError("Integer out of range.");
+      return false;
+    }
+    if (negative && magnitude > 0) {
+      *value = -static_cast<int64>(magnitude - 1) - 1;
+    } else {
+      *value = static_cast<int64>(magnitude);
+    }
+    return true;
+  }
+
+  bool ConsumeDouble(double* value) {
+    const char* begin;
+    const char* end;
+    if (Peek() == '"') {
+      DO(ConsumeString(&string_));
+      if (string_ == "NaN") {
+        *value = std::numeric_limits<double>::quiet_NaN();
+        return true;
+      } else if (string_ == "Infinity") {
+        *value = std::numeric_limits<double>::infinity();
+        return true;
+      } else if (string_ == "-Infinity") {
+        *value = -std::numeric_limits<double>::infinity();
+        return true;
+      }
+      begin = string_.data();
+      end = begin + string_.size();
+      if (!IsJsonNumber(begin, end)) {
+        ReportError("Expected number, found \"" + CEscape(string_) + "\".");
+        return false;
+      }
+    } else {
+      DO(ConsumeNumberText(&begin, &end));
+    }
+    ParseDecimalDouble(begin, end, value);
+    return true;
+  }
+
+  bool ConsumeFloat(float* value) {
+    double parsed;
+    DO(ConsumeDouble(&parsed));
+    // Converting a finite double outside the range of float is undefined.
+    // Magnitudes below FLT_MAX plus half an ulp still round to FLT_MAX, which
+    // is what the printer writes for it ("3.4028235e+38").
+    const double kInfinity = std::numeric_limits<double>::infinity();
+    const double kFloatOverflow =
+        std::numeric_limits<float>::max() + ldexp(1.0, 103);
+    if ((parsed >= kFloatOverflow && parsed != kInfinity) ||
+        (parsed <= -kFloatOverflow && parsed != -kInfinity)) {
+      ReportError("Float out of range.");
+      return false;
+    }
+    if (parsed > std::numeric_limits<float>::max() &&
+        parsed < kFloatOverflow) {
+      *value = std::numeric_limits<float>::max();
+    } else if (parsed < -std::numeric_limits<float>::max() &&
+               parsed > -kFloatOverflow) {
+      *value = -std::numeric_limits<float>::max();
+    } else {
+      *value = static_cast<float>(parsed);
+    }
+    return true;
+  }
+
+  bool ConsumeBool(bool* value) {
+    ConsumeWord(&word_);
+    if (word_ == "true") {
+      *value = true;
+    } else if (word_ == "false") {
+      *value = false;
+    } else {
+      ReportError("Expected true or false, found " +
+                  (word_.empty() ? DescribeNext() : "\"" + word_ + "\"") +
+                  ".");
+      return false;
+    }
+    return true;
+  }
+
+  // ---------------------------------------------------------------------
+  // Reading messages.
+
+  // Consumes a JSON object into the given message.
+  bool ConsumeObject(Message* message, int depth) {
+    if (depth >= kMaxDepth) {
+      ReportError("Message is nested too deeply.");
+      return false;
+    }
+    DO(Consume('{'));
+    SkipWhitespace();
+    if (TryConsume('}')) return true;
+
+    while (true) {
+      SkipWhitespace();
+      DO(ConsumeMember(message, depth));
+      SkipWhitespace();
+      if (TryConsume('}')) return true;
+      DO(Consume(','));
+    }
+  }
+
+  // Looks up the field a member is named after, or returns NULL.
+  const FieldDescriptor* FindField(const Message& message,
+                                   const std::string& name) {
+    if (name.size() > 2 && name[0] == '[' && name[name.size() - 1] == ']') {
+      extension_name_.assign(name, 1, name.size() - 2);
+      return message.GetReflection()->FindKnownExtensionByName(
+          extension_name_);
+    }
+    // Both of these are hash table lookups in the descriptor's pool.
+    const Descriptor* descriptor = message.GetDescriptor();
+    const FieldDescriptor* field = descriptor->FindFieldByCamelcaseName(name);
+    if (field == NULL) {
+      field = descriptor->FindFieldByName(name);
+    }
+    return field;
+  }
+
+  // Consumes one "name": value member of an object.
+  bool ConsumeMember(Message* message, int depth) {
+    StartToken();
+    DO(ConsumeString(&name_));
+    const FieldDescriptor* field = FindField(*message, name_);
+    if (field == NULL) {
+      if (!ignore_unknown_fields_) {
+        ReportError("Message type \"" + message->GetDescriptor()->full_name() +
+                    "\" has no field named \"" + CEscape(name_) + "\".");
+        return false;
+      }
+      SkipWhitespace();
+      DO(Consume(':'));
+      SkipWhitespace();
+      return SkipValue(depth);
+    }
+
+    const Reflection* reflection = message->GetReflection();
+
+    // Fail if the field is not repeated and it has already been specified.
+    if ((singular_overwrite_policy_ == FORBID_SINGULAR_OVERWRITES) &&
+        !field->is_repeated() && reflection->HasField(*message, field)) {
+      ReportError("Non-repeated field \"" + field->name() +
+                  "\" is specified multiple times.");
+      return false;
+    }
+
+    SkipWhitespace();
+    DO(Consume(':'));
+    SkipWhitespace();
+    StartToken();
+
+    if (TryConsumeNull()) {
+      reflection->ClearField(message, field);
+      return !had_errors_;
+    }
+
+    if (!field->is_repeated()) {
+      return ConsumeFieldValue(message, reflection, field, depth);
+    }
+
+    if (Peek() != '[') {
+      ReportError("Expected \"[\" for repeated field \"" + field->name() +
+                  "\", found " + DescribeNext() + ".");
+      return false;
+    }
+    Advance();
+    SkipWhitespace();
+    if (TryConsume(']')) return true;
+    while (true) {
+      SkipWhitespace();
+      StartToken();
+      DO(ConsumeFieldValue(message, reflection, field, depth));
+      SkipWhitespace();
+      if (TryConsume(']')) return true;
+      DO(Consume(','));
+    }
+  }
+
+  bool ConsumeFieldValue(Message* message,
+                         const Reflection* reflection,
+                         const FieldDescriptor* field,
+                         int depth) {
+
+// Define an easy to use macro for setting fields. This macro checks
+// to see if the field is repeated (in which case we need to use the Add
+// methods or not (in which case we need to use the Set methods).
+#define SET_FIELD(CPPTYPE, VALUE)                                  \
+        if (field->is_repeated()) {                                \
+          reflection->Add##CPPTYPE(message, field, VALUE);         \
+        } else {                                                   \
+          reflection->Set##CPPTYPE(message, field, VALUE);         \
+        }                                                          \
+
+    switch(field->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_INT32: {
+        int64 value;
+        DO(ConsumeSignedInteger(&value, kint32max));
+        SET_FIELD(Int32, static_cast<int32>(value));
+        break;
+      }
+
+      case FieldDescriptor::CPPTYPE_UINT32: {
+        uint64 value;
+        DO(ConsumeUnsignedInteger(&value, kuint32max));
+        SET_FIELD(UInt32, static_cast<uint32>(value));
+        break;
+      }
+
+      case FieldDescriptor::CPPTYPE_INT64: {
+        int64 value;
+        DO(ConsumeSignedInteger(&value, kint64max));
+        SET_FIELD(Int64, value);
+        break;
+      }
+
+      case FieldDescriptor::CPPTYPE_UINT64: {
+        uint64 value;
+        DO(ConsumeUnsignedInteger(&value, kuint64max));
+        SET_FIELD(UInt64, value);
+        break;
+      }
+
+      case FieldDescriptor::CPPTYPE_FLOAT: {
+        float value;
+        DO(ConsumeFloat(&value));
+        SET_FIELD(Float, value);
+        break;
+      }
+
+      case FieldDescriptor::CPPTYPE_DOUBLE: {
+        double value;
+        DO(ConsumeDouble(&value));
+        SET_FIELD(Double, value);
+        break;
+      }
+
+      case FieldDescriptor::CPPTYPE_BOOL: {
+        bool value;
+        DO(ConsumeBool(&value));
+        SET_FIELD(Bool, value);
+        break;
+      }
+
+      case FieldDescriptor::CPPTYPE_STRING: {
+        DO(ConsumeString(&string_));
+        if (field->type() == FieldDescriptor::TYPE_BYTES) {
+          bytes_.clear();
+          if (!Base64Unescape(string_.data(), string_.size(), &bytes_)) {
+            ReportError("Invalid base64 data for field \"" + field->name() +
+                        "\".");
+            return false;
+          }
+          SET_FIELD(String, bytes_);
+        } else {
+          SET_FIELD(String, string_);
+        }
+        break;
+      }
+
+      case FieldDescriptor::CPPTYPE_ENUM: {
+        const EnumDescriptor* enum_type = field->enum_type();
+        const EnumValueDescriptor* enum_value = NULL;
+        if (Peek() == '"') {
+          DO(ConsumeString(&string_));
+          enum_value = enum_type->FindValueByName(string_);
+          if (enum_value == NULL) {
+            ReportError("Unknown enumeration value of \"" +
+                        CEscape(string_) + "\" for field \"" +
+                        field->name() + "\".");
+            return false;
+          }
+        } else {
+          int64 number;
+          DO(ConsumeSignedInteger(&number, kint32max));
+          enum_value = enum_type->FindValueByNumber(number);
+          if (enum_value == NULL) {
+            ReportError("Unknown enumeration value of \"" +
+                        SimpleItoa(number) + "\" for field \"" +
+                        field->name() + "\".");
+            return false;
+          }
+        }
+        SET_FIELD(Enum, enum_value);
+        break;
+      }
+
+      case FieldDescriptor::CPPTYPE_MESSAGE: {
+        if (field->is_repeated()) {
+          DO(ConsumeObject(reflection->AddMessage(message, field),
+                           depth + 1));
+        } else {
+          DO(ConsumeObject(reflection->MutableMessage(message, field),
+                           depth + 1));
+        }
+        break;
+      }
+    }
+#undef SET_FIELD
+    return true;
+  }
+
+  // Consumes any JSON value without storing it.  Used for members which
+  // name no known field.
+  bool SkipValue(int depth) {
+    if (depth >= kMaxDepth) {
+      ReportError("Message is nested too deeply.");
+      return false;
+    }
+    StartToken();
+    int c = Peek();
+    if (c == '"') {
+      return ConsumeString(&string_);
+    } else if (c == '-' || IsDigit(c)) {
+      const char* begin;
+      const char* end;
+      return ConsumeNumberText(&begin, &end);
+    } else if (c == '{' || c == '[') {
+      char close = (c == '{') ? '}' : ']';
+      Advance();
+      SkipWhitespace();
+      if (TryConsume(close)) return true;
+      while (true) {
+        SkipWhitespace();
+        if (close == '}') {
+          StartToken();
+          DO(ConsumeString(&string_));
+          SkipWhitespace();
+          DO(Consume(':'));
+          SkipWhitespace();
+        }
+        DO(SkipValue(depth + 1));
+        SkipWhitespace();
+        if (TryConsume(close)) return true;
+        DO(Consume(','));
+      }
+    } else {
+      ConsumeWord(&word_);
+      if (word_ != "true" && word_ != "false" && word_ != "null") {
+        ReportError("Expected value, found " +
+                    (word_.empty() ? DescribeNext() : "\"" + word_ + "\"") +
+                    ".");
+        return false;
+      }
+      return true;
+    }
+  }
+
+  io::ZeroCopyInputStream* input_;
+  const char* buffer_;      // Unread part of the current buffer.
+  const char* buffer_end_;
+  bool at_end_;
+  int line_;
+  int column_;
+  int token_line_;
+  int token_column_;
+
+  // Scratch space reused for the whole parse.
+  std::string name_;
+  std::string extension_name_;
+  std::string string_;
+  std::string bytes_;
+  std::string number_;
+  std::string word_;
+
+  io::ErrorCollector* error_collector_;
+  const Descriptor* root_message_type_;
+  bool ignore_unknown_fields_;
+  SingularOverwritePolicy singular_overwrite_policy_;
+  bool had_errors_;
+};
+
+#undef DO
+
+// ===========================================================================
+// Internal class for writing JSON to the io::ZeroCopyOutputStream.  Like
+// TextFormat's TextGenerator, it formats numbers and escapes strings
+// straight into the stream's buffer.
+class JsonFormat::Printer::JsonGenerator {
+ public:
+  explicit JsonGenerator(io::ZeroCopyOutputStream* output, bool pretty_print)
+    : output_(output),
+      buffer_(NULL),
+      buffer_size_(0),
+      failed_(false),
+      pretty_print_(pretty_print),
+      indent_level_(0),
+      field_list_depth_(0) {
+  }
+
+  ~JsonGenerator() {
+    // Only BackUp() if we're sure we've successfully called Next() at least
+    // once.
+    if (buffer_size_ > 0) {
+      output_->BackUp(buffer_size_);
+    }
+    STLDeleteElements(&field_lists_);
+  }
+
+  bool pretty_print() const { return pretty_print_; }
+
+  // Increase or decrease the indent used by NewLine().
+  void Indent() { ++indent_level_; }
+  void Outdent() { --indent_level_; }
+
+  // When pretty printing, start a new line at the current indent.
+  // Otherwise does nothing.
+  void NewLine() {
+    if (!pretty_print_) return;
+    static const char kSpaces[] = "\n                                ";
+    int size = 1 + indent_level_ * 2;
+    const char* text = kSpaces;
+    while (size > 0) {
+      int chunk = std::min<int>(size, sizeof(kSpaces) - 1);
+      Write(text, chunk);
+      size -= chunk;
+      text = kSpaces + 1;  // Only the first chunk has the newline.
+    }
+  }
+
+  void Print(char c) {
+    if (buffer_size_ > 0) {
+      *buffer_++ = c;
+      --buffer_size_;
+    } else {
+      Write(&c, 1);
+    }
+  }
+  void Print(const char* text, int size) {
+    Write(text, size);
+  }
+  void Print(const std::string& text) {
+    Write(text.data(), text.size());
+  }
+
+  // Print numbers.  When the output buffer has room they are formatted
+  // straight into it.
+  void PrintNumber(int32 value) {
+    char scratch[kFastToBufferSize];
+    char* begin = BeginFormat(kFastToBufferSize, scratch);
+    EndFormat(begin, FastInt32ToBufferLeft(value, begin));
+  }
+  void PrintNumber(int64 value) {
+    char scratch[kFastToBufferSize];
+    char* begin = BeginFormat(kFastToBufferSize, scratch);
+    EndFormat(begin, FastInt64ToBufferLeft(value, begin));
+  }
+  void PrintNumber(uint32 value) {
+    char scratch[kFastToBufferSize];
+    char* begin = BeginFormat(kFastToBufferSize, scratch);
+    EndFormat(begin, FastUInt32ToBufferLeft(value, begin));
+  }
+  void PrintNumber(uint64 value) {
+    char scratch[kFastToBufferSize];
+    char* begin = BeginFormat(kFastToBufferSize, scratch);
+    EndFormat(begin, FastUInt64ToBufferLeft(value, begin));
+  }
+  void PrintNumber(float value) {
+    char scratch[kFloatToBufferSize];
+    char* begin = BeginFormat(kFloatToBufferSize, scratch);
+    FloatToBuffer(value, begin);
+    EndFormat(begin, begin + strlen(begin));
+  }
+  void PrintNumber(double value) {
+    char scratch[kDoubleToBufferSize];
+    char* begin = BeginFormat(kDoubleToBufferSize, scratch);
+    DoubleToBuffer(value, begin);
+    EndFormat(begin, begin + strlen(begin));
+  }
+
+  // Print text as a JSON string, quotes included.  Control characters,
+  // quotes and backslashes are escaped; everything else, including UTF-8
+  // sequences, is copied as is.
+  void PrintString(const std::string& text) {
+    static const char kHexDigits[] = "0123456789abcdef";
+    const char* data = text.data();
+    int size = text.size();
+    int start = 0;  // Start of the characters not yet written.
+    Print('"');
+    for (int i = 0; i < size; i++) {
+      const char* escape;
+      char unicode_escape[6];
+      switch (data[i]) {
+        case '\"': escape = "\\\""; break;
+        case '\\': escape = "\\\\"; break;
+        case '\b': escape = "\\b";  break;
+        case '\f': escape = "\\f";  break;
+        case '\n': escape = "\\n";  break;
+        case '\r': escape = "\\r";  break;
+        case '\t': escape = "\\t";  break;
+        default: {
+          uint8 c = static_cast<uint8>(data[i]);
+          if (c >= 0x20) continue;
+          unicode_escape[0] = '\\';
+          unicode_escape[1] = 'u';
+          unicode_escape[2] = '0';
+          unicode_escape[3] = '0';
+          unicode_escape[4] = kHexDigits[c >> 4];
+          unicode_escape[5] = kHexDigits[c & 0xF];
+          Write(data + start, i - start);
+          Write(unicode_escape, 6);
+          start = i + 1;
+          continue;
+        }
+      }
+      Write(data + start, i - start);
+      Write(escape, 2);
+      start = i + 1;
+    }
+    Write(data + start, size - start);
+    Print('"');
+  }
+
+  // Print bytes as a JSON string holding their base64 encoding, with
+  // padding.
+  void PrintBase64(const std::string& data) {
+    const uint8* bytes = reinterpret_cast<const uint8*>(data.data());
+    int size = data.size();
+    char chunk[256];  // Multiple of 4.
+    int used = 0;
+    Print('"');
+    for (int i = 0; i < size; i += 3) {
+      uint32 bits = bytes[i] << 16;
+      if (i + 1 < size) bits |= bytes[i + 1] << 8;
+      if (i + 2 < size) bits |= bytes[i + 2];
+      chunk[used++] = kBase64Digits[bits >> 18];
+      chunk[used++] = kBase64Digits[(bits >> 12) & 0x3F];
+      chunk[used++] = i + 1 < size ? kBase64Digits[(bits >> 6) & 0x3F] : '=';
+      chunk[used++] = i + 2 < size ? kBase64Digits[bits & 0x3F] : '=';
+      if (used == sizeof(chunk)) {
+        Write(chunk, used);
+        used = 0;
+      }
+    }
+    Write(chunk, used);
+    Print('"');
+  }
+
+  // Printer::Print() lists the fields of each message into one of these,
+  // one list per level of nesting, so that they can be reused.
+  std::vector<const FieldDescriptor*>* PushFieldList() {
+    if (field_list_depth_ == static_cast<int>(field_lists_.size())) {
+      field_lists_.push_back(new std::vector<const FieldDescriptor*>);
+    }
+    return field_lists_[field_list_depth_++];
+  }
+  void PopFieldList() {
+    --field_list_depth_;
+  }
+
+  // True if any write to the underlying stream failed.  (We don't just
+  // crash in this case because this is an I/O failure, not a programming
+  // error.)
+  bool failed() const { return failed_; }
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(JsonGenerator);
+
+  // Returns where to format up to max_size bytes of text (including a
+  // terminating NUL):  the output buffer itself if it has room, otherwise
+  // scratch.  Pass the result and the end of the text to EndFormat().
+  char* BeginFormat(int max_size, char* scratch) {
+    if (failed_ || buffer_size_ < max_size) {
+      return scratch;
+    }
+    return buffer_;
+  }
+
+  void EndFormat(char* begin, char* end) {
+    if (begin == buffer_) {
+      buffer_ += end - begin;
+      buffer_size_ -= end - begin;
+    } else {
+      Write(begin, end - begin);
+    }
+  }
+
+  void Write(const char* data, int size) {
+    if (failed_) return;
+    if (size == 0) return;
+
+    while (size > buffer_size_) {
+      // Data exceeds space in the buffer.  Copy what we can and request a
+      // new buffer.
+      memcpy(buffer_, data, buffer_size_);
+      data += buffer_size_;
+      size -= buffer_size_;
+      void* void_buffer;
+      failed_ = !output_->Next(&void_buffer, &buffer_size_);
+      if (failed_) return;
+      buffer_ = reinterpret_cast<char*>(void_buffer);
+    }
+
+    // Buffer is big enough to receive the data; copy it.
+    memcpy(buffer_, data, size);
+    buffer_ += size;
+    buffer_size_ -= size;
+  }
+
+  io::ZeroCopyOutputStream* const output_;
+  char* buffer_;
+  int buffer_size_;
+  bool failed_;
+
+  const bool pretty_print_;
+  int indent_level_;
+
+  std::vector<std::vector<const FieldDescriptor*>*> field_lists_;
+  int field_list_depth_;
+};
+
+// ===========================================================================
+
+JsonFormat::Parser::Parser()
+  : error_collector_(NULL),
+    allow_partial_(false),
+    ignore_unknown_fields_(false) {
+}
+
+JsonFormat::Parser::~Parser() {}
+
+bool JsonFormat::Parser::Parse(io::ZeroCopyInputStream* input,
+                               Message* output) {
+  output->Clear();
+  ParserImpl parser(output->GetDescriptor(), input, error_collector_,
+                    ignore_unknown_fields_,
+                    ParserImpl::FORBID_SINGULAR_OVERWRITES);
+  return MergeUsingImpl(input, output, &parser);
+}
+
+bool JsonFormat::Parser::ParseFromString(const std::string& input,
+                                         Message* output) {
+  io::ArrayInputStream input_stream(input.data(), input.size());
+  return Parse(&input_stream, output);
+}
+
+bool JsonFormat::Parser::Merge(io::ZeroCopyInputStream* input,
+                               Message* output) {
+  ParserImpl parser(output->GetDescriptor(), input, error_collector_,
+                    ignore_unknown_fields_,
+                    ParserImpl::ALLOW_SINGULAR_OVERWRITES);
+  return MergeUsingImpl(input, output, &parser);
+}
+
+bool JsonFormat::Parser::MergeFromString(const std::string& input,
+                                         Message* output) {
+  io::ArrayInputStream input_stream(input.data(), input.size());
+  return Merge(&input_stream, output);
+}
+
+bool JsonFormat::Parser::MergeUsingImpl(io::ZeroCopyInputStream* input,
+                                        Message* output,
+                                        ParserImpl* parser_impl) {
+  if (!parser_impl->Parse(output)) return false;
+  if (!allow_partial_ && !output->IsInitialized()) {
+    std::vector<std::string> missing_fields;
+    output->FindInitializationErrors(&missing_fields);
+    parser_impl->ReportError(-1, 0, "Message missing required fields: " +
+                                    JoinStrings(missing_fields, ", "));
+    return false;
+  }
+  return true;
+}
+
+/* static */ bool JsonFormat::Parse(io::ZeroCopyInputStream* input,
+                                    Message* output) {
+  return Parser().Parse(input, output);
+}
+
+/* static */ bool JsonFormat::Merge(io::ZeroCopyInputStream* input,
+                                    Message* output) {
+  return Parser().Merge(input, output);
+}
+
+/* static */ bool JsonFormat::ParseFromString(const std::string& input,
+                                              Message* output) {
+  return Parser().ParseFromString(input, output);
+}
+
+/* static */ bool JsonFormat::MergeFromString(const std::string& input,
+                                              Message* output) {
+  return Parser().MergeFromString(input, output);
+}
+
+// ===========================================================================
+
+JsonFormat::Printer::Printer()
+  : preserve_field_names_(false),
+    print_enums_as_ints_(false),
+    pretty_print_(false) {}
+
+JsonFormat::Printer::~Printer() {}
+
+bool JsonFormat::Printer::PrintToString(const Message& message,
+                                        std::string* output) const {
+  GOOGLE_DCHECK(output) << "output specified is NULL";
+
+  output->clear();
+  io::StringOutputStream output_stream(output);
+
+  bool result = Print(message, &output_stream);
+
+  return result;
+}
+
+bool JsonFormat::Printer::Print(const Message& message,
+                                io::ZeroCopyOutputStream* output) const {
+  JsonGenerator generator(output, pretty_print_);
+
+  Print(message, generator);
+  if (pretty_print_) generator.Print('\n');
+
+  // Output false if the generator failed internally.
+  return !generator.failed();
+}
+
+void JsonFormat::Printer::Print(const Message& message,
+                                JsonGenerator& generator) const {
+  const Reflection* reflection = message.GetReflection();
+  std::vector<const FieldDescriptor*>* fields = generator.PushFieldList();
+  fields->clear();
+  fields->reserve(message.GetDescriptor()->field_count());
+  reflection->ListFields(message, fields);
+
+  generator.Print('{');
+  generator.Indent();
+  for (int i = 0; i < fields->size(); i++) {
+    if (i > 0) generator.Print(',');
+    generator.NewLine();
+    PrintField(message, reflection, (*fields)[i], generator);
+  }
+  generator.Outdent();
+  if (!fields->empty()) generator.NewLine();
+  generator.Print('}');
+
+  generator.PopFieldList();
+}
+
+void JsonFormat::Printer::PrintField(const Message& message,
+                                     const Reflection* reflection,
+                                     const FieldDescriptor* field,
+                                     JsonGenerator& generator) const {
+  // Names are identifiers, so they never need escaping.
+  generator.Print('"');
+  if (field->is_extension()) {
+    generator.Print('[');
+    generator.Print(field->full_name());
+    generator.Print(']');
+  } else if (preserve_field_names_) {
+    generator.Print(field->name());
+  } else {
+    generator.Print(field->camelcase_name());
+  }
+  generator.Print('"');
+  generator.Print(':');
+  if (generator.pretty_print()) generator.Print(' ');
+
+  if (!field->is_repeated()) {
+    PrintFieldValue(message, reflection, field, -1, generator);
+    return;
+  }
+
+  int count = reflection->FieldSize(message, field);
+  generator.Print('[');
+  generator.Indent();
+  for (int j = 0; j < count; ++j) {
+    if (j > 0) generator.Print(',');
+    generator.NewLine();
+    PrintFieldValue(message, reflection, field, j, generator);
+  }
+  generator.Outdent();
+  generator.NewLine();
+  generator.Print(']');
+}
+
+void JsonFormat::Printer::PrintFieldValue(
+    const Message& message,
+    const Reflection* reflection,
+    const FieldDescriptor* field,
+    int index,
+    JsonGenerator& generator) const {
+  GOOGLE_DCHECK(field->is_repeated() || (index == -1))
+      << "Index must be -1 for non-repeated fields";
+
+  switch (field->cpp_type()) {
+#define OUTPUT_FIELD(CPPTYPE, METHOD)                                        \
+      case FieldDescriptor::CPPTYPE_##CPPTYPE:                               \
+        generator.PrintNumber(field->is_repeated() ?                         \
+          reflection->GetRepeated##METHOD(message, field, index) :           \
+          reflection->Get##METHOD(message, field));                          \
+        break;                                                               \
+
+      OUTPUT_FIELD( INT32,  Int32);
+      OUTPUT_FIELD(UINT32, UInt32);
+#undef OUTPUT_FIELD
+
+      // 64-bit integers are quoted, since many JSON readers hold every
+      // number in a double.
+#define OUTPUT_QUOTED_FIELD(CPPTYPE, METHOD)                                 \
+      case FieldDescriptor::CPPTYPE_##CPPTYPE:                               \
+        generator.Print('"');                                                \
+        generator.PrintNumber(field->is_repeated() ?                         \
+          reflection->GetRepeated##METHOD(message, field, index) :           \
+          reflection->Get##METHOD(message, field));                          \
+        generator.Print('"');                                                \
+        break;                                                               \
+
+      OUTPUT_QUOTED_FIELD( INT64,  Int64);
+      OUTPUT_QUOTED_FIELD(UINT64, UInt64);
+#undef OUTPUT_QUOTED_FIELD
+
+      // JSON has no numbers for NaN and infinity, so those are quoted.
+#define OUTPUT_FLOATING_FIELD(CPPTYPE, METHOD, TYPE)                         \
+      case FieldDescriptor::CPPTYPE_##CPPTYPE: {                             \
+        TYPE value = field->is_repeated() ?                                  \
+          reflection->GetRepeated##METHOD(message, field, index) :           \
+          reflection->Get##METHOD(message, field);                           \
+        if (value != value) {                                                \
+          generator.Print("\"NaN\"", 5);                                     \
+        } else if (value == std::numeric_limits<TYPE>::infinity()) {         \
+          generator.Print("\"Infinity\"", 10);                               \
+        } else if (value == -std::numeric_limits<TYPE>::infinity()) {        \
+          generator.Print("\"-Infinity\"", 11);                              \
+        } else {                                                             \
+          generator.PrintNumber(value);                                      \
+        }                                                                    \
+        break;                                                               \
+      }
+
+      OUTPUT_FLOATING_FIELD( FLOAT,  Float,  float);
+      OUTPUT_FLOATING_FIELD(DOUBLE, Double, double);
+#undef OUTPUT_FLOATING_FIELD
+
+      case FieldDescriptor::CPPTYPE_STRING: {
+        std::string scratch;
+        const std::string& value = field->is_repeated() ?
+            reflection->GetRepeatedStringReference(
+              message, field, index, &scratch) :
+            reflection->GetStringReference(message, field, &scratch);
+
+        if (field->type() == FieldDescriptor::TYPE_BYTES) {
+          generator.PrintBase64(value);
+        } else {
+          generator.PrintString(value);
+        }
+        break;
+      }
+
+      case FieldDescriptor::CPPTYPE_BOOL:
+        if (field->is_repeated() ?
+            reflection->GetRepeatedBool(message, field, index) :
+            reflection->GetBool(message, field)) {
+          generator.Print("true", 4);
+        } else {
+          generator.Print("false", 5);
+        }
+        break;
+
+      case FieldDescriptor::CPPTYPE_ENUM: {
+        const EnumValueDescriptor* value = field->is_repeated() ?
+          reflection->GetRepeatedEnum(message, field, index) :
+          reflection->GetEnum(message, field);
+        if (print_enums_as_ints_) {
+          generator.PrintNumber(static_cast<int32>(value->number()));
+        } else {
+          generator.Print('"');
+          generator.Print(value->name());
+          generator.Print('"');
+        }
+        break;
+      }
+
+      case FieldDescriptor::CPPTYPE_MESSAGE:
+        Print(field->is_repeated() ?
+                reflection->GetRepeatedMessage(message, field, index) :
+                reflection->GetMessage(message, field),
+              generator);
+        break;
+  }
+}
+
+/* static */ bool JsonFormat::Print(const Message& message,
+                                    io::ZeroCopyOutputStream* output) {
+  return Printer().Print(message, output);
+}
+
+/* static */ bool JsonFormat::PrintToString(
+    const Message& message, std::string* output) {
+  return Printer().PrintToString(message, output);
+}
+
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,206 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Utilities for printing and parsing protocol messages as JSON.
+//
+// A message is written as a JSON object with one member per field that is
+// set.  Values map as follows:
+//
+//   int32, uint32, sint32, fixed32, sfixed32:  JSON number
+//   int64, uint64, sint64, fixed64, sfixed64:  JSON string, e.g. "123"
+//                                              (a number is also accepted)
+//   float, double:  JSON number, or "NaN", "Infinity" or "-Infinity"
+//   bool:           true or false
+//   string:         JSON string
+//   bytes:          JSON string holding the base64 encoding
+//   enum:           JSON string holding the value's name (a number is
+//                   also accepted)
+//   message, group: JSON object
+//   repeated:       JSON array
+//
+// Members are named by each field's camelcase_name() (e.g. "fooBar" for
+// foo_bar) unless the Printer is told to keep the original names; the
+// Parser accepts either.  Extensions are named by their full name in
+// brackets, e.g. "[protobuf_unittest.optional_int32_extension]".  A null
+// value clears the field.  Unknown fields are not printed.
+
+#ifndef GOOGLE_PROTOBUF_JSON_FORMAT_H__
+#define GOOGLE_PROTOBUF_JSON_FORMAT_H__
+
+#include <string>
+#include <google/protobuf/message.h>
+#include <google/protobuf/descriptor.h>
+
+namespace google {
+namespace protobuf {
+
+namespace io {
+  class ErrorCollector;      // tokenizer.h
+}
+
+// This class implements the JSON format.  Like TextFormat, it works on any
+// message through its Descriptor and Reflection interfaces.
+//
+// This class is really a namespace that contains only static methods.
+class LIBPROTOBUF_EXPORT JsonFormat {
+ public:
+  // Outputs a JSON representation of the given message to the given
+  // output stream.
+  static bool Print(const Message& message, io::ZeroCopyOutputStream* output);
+
+  // Like Print(), but outputs directly to a string.
+  static bool PrintToString(const Message& message, std::string* output);
+
+  // Class for those users which require more control over how a message is
+  // printed.
+  class LIBPROTOBUF_EXPORT Printer {
+   public:
+    Printer();
+    ~Printer();
+
+    // Like JsonFormat::Print
+    bool Print(const Message& message, io::ZeroCopyOutputStream* output) const;
+    // Like JsonFormat::PrintToString
+    bool PrintToString(const Message& message, std::string* output) const;
+
+    // Set true to name members by the field names given in the .proto file
+    // (e.g. "foo_bar") instead of by their lowerCamelCase form ("fooBar").
+    void SetPreserveFieldNames(bool preserve_field_names) {
+      preserve_field_names_ = preserve_field_names;
+    }
+
+    // Set true to print enum values as numbers instead of names.
+    void SetPrintEnumsAsInts(bool print_enums_as_ints) {
+      print_enums_as_ints_ = print_enums_as_ints;
+    }
+
+    // Set true to put each member and array element on its own line,
+    // indented by two spaces per level of nesting.  By default the output
+    // contains no whitespace at all.
+    void SetPrettyPrint(bool pretty_print) {
+      pretty_print_ = pretty_print;
+    }
+
+   private:
+    // Forward declaration of an internal class used to print the JSON
+    // output to the OutputStream (see json_format.cc for implementation).
+    class JsonGenerator;
+
+    // Print a message as a JSON object.
+    void Print(const Message& message, JsonGenerator& generator) const;
+
+    // Print one member:  the field's name and its value or array of values.
+    void PrintField(const Message& message,
+                    const Reflection* reflection,
+                    const FieldDescriptor* field,
+                    JsonGenerator& generator) const;
+
+    // Print a single value of the field.  For non-repeated fields, an index
+    // of -1 must be supplied.
+    void PrintFieldValue(const Message& message,
+                         const Reflection* reflection,
+                         const FieldDescriptor* field,
+                         int index,
+                         JsonGenerator& generator) const;
+
+    bool preserve_field_names_;
+    bool print_enums_as_ints_;
+    bool pretty_print_;
+  };
+
+  // Parses a JSON object from the given input stream into the given
+  // message.  This function parses the format written by Print().
+  static bool Parse(io::ZeroCopyInputStream* input, Message* output);
+  // Like Parse(), but reads directly from a string.
+  static bool ParseFromString(const std::string& input, Message* output);
+
+  // Like Parse(), but the data is merged into the given message, as if
+  // using Message::MergeFrom().
+  static bool Merge(io::ZeroCopyInputStream* input, Message* output);
+  // Like Merge(), but reads directly from a string.
+  static bool MergeFromString(const std::string& input, Message* output);
+
+  // For more control over parsing, use this class.
+  class LIBPROTOBUF_EXPORT Parser {
+   public:
+    Parser();
+    ~Parser();
+
+    // Like JsonFormat::Parse().
+    bool Parse(io::ZeroCopyInputStream* input, Message* output);
+    // Like JsonFormat::ParseFromString().
+    bool ParseFromString(const std::string& input, Message* output);
+    // Like JsonFormat::Merge().
+    bool Merge(io::ZeroCopyInputStream* input, Message* output);
+    // Like JsonFormat::MergeFromString().
+    bool MergeFromString(const std::string& input, Message* output);
+
+    // Set where to report parse errors.  If NULL (the default), errors will
+    // be printed to stderr.
+    void RecordErrorsTo(io::ErrorCollector* error_collector) {
+      error_collector_ = error_collector;
+    }
+
+    // Normally parsing fails if, after parsing, output->IsInitialized()
+    // returns false.  Call AllowPartialMessage(true) to skip this check.
+    void AllowPartialMessage(bool allow) {
+      allow_partial_ = allow;
+    }
+
+    // Normally a member which names no field of the message is an error.
+    // Call IgnoreUnknownFields(true) to skip such members instead.
+    void IgnoreUnknownFields(bool ignore) {
+      ignore_unknown_fields_ = ignore;
+    }
+
+   private:
+    // Forward declaration of an internal class used to parse JSON
+    // (see json_format.cc for implementation).
+    class ParserImpl;
+
+    // Like TextFormat::Merge().  The provided implementation is used
+    // to do the parsing.
+    bool MergeUsingImpl(io::ZeroCopyInputStream* input,
+                        Message* output,
+                        ParserImpl* parser_impl);
+
+    io::ErrorCollector* error_collector_;
+    bool allow_partial_;
+    bool ignore_unknown_fields_;
+  };
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(JsonFormat);
+};
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_JSON_FORMAT_H__
@@ -0,0 +1,496 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <limits>
+
+#include <google/protobuf/json_format.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/io/tokenizer.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/test_util.h>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/stubs/substitute.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+
+namespace google {
+namespace protobuf {
+
+// Can't use an anonymous namespace here due to brokenness of Tru64 compiler.
+namespace json_format_unittest {
+
+inline bool IsNaN(double value) {
+  // NaN is never equal to anything, even itself.
+  return value != value;
+}
+
+TEST(JsonFormatTest, RoundTripAllTypes) {
+  unittest::TestAllTypes message, parsed;
+  TestUtil::SetAllFields(&message);
+
+  std::string json;
+  EXPECT_TRUE(JsonFormat::PrintToString(message, &json));
+  EXPECT_TRUE(JsonFormat::ParseFromString(json, &parsed)) << json;
+  TestUtil::ExpectAllFieldsSet(parsed);
+
+  JsonFormat::Printer printer;
+  printer.SetPreserveFieldNames(true);
+  printer.SetPrintEnumsAsInts(true);
+  printer.SetPrettyPrint(true);
+  EXPECT_TRUE(printer.PrintToString(message, &json));
+  EXPECT_TRUE(JsonFormat::ParseFromString(json, &parsed)) << json;
+  TestUtil::ExpectAllFieldsSet(parsed);
+}
+
+TEST(JsonFormatTest, RoundTripAllExtensions) {
+  unittest::TestAllExtensions message, parsed;
+  TestUtil::SetAllExtensions(&message);
+
+  std::string json;
+  EXPECT_TRUE(JsonFormat::PrintToString(message, &json));
+  EXPECT_TRUE(JsonFormat::ParseFromString(json, &parsed)) << json;
+  TestUtil::ExpectAllExtensionsSet(parsed);
+}
+
+TEST(JsonFormatTest, Print) {
+  unittest::TestAllTypes message;
+  message.set_optional_int32(-12);
+  message.set_optional_int64(GOOGLE_LONGLONG(9007199254740993));
+  message.set_optional_uint64(kuint64max);
+  message.set_optional_float(0.1f);
+  message.set_optional_bool(true);
+  message.set_optional_string("caf\xc3\xa9");
+  message.set_optional_bytes(std::string("\0\xff\x10", 3));
+  message.mutable_optional_nested_message()->set_bb(7);
+  message.set_optional_nested_enum(unittest::TestAllTypes::BAZ);
+  message.add_repeated_int32(1);
+  message.add_repeated_int32(2);
+  message.add_repeated_nested_message();
+
+  std::string json;
+  EXPECT_TRUE(JsonFormat::PrintToString(message, &json));
+  EXPECT_EQ(
+    "{\"optionalInt32\":-12,"
+    "\"optionalInt64\":\"9007199254740993\","
+    "\"optionalUint64\":\"18446744073709551615\","
+    "\"optionalFloat\":0.1,"
+    "\"optionalBool\":true,"
+    "\"optionalString\":\"caf\xc3\xa9\","
+    "\"optionalBytes\":\"AP8Q\","
+    "\"optionalNestedMessage\":{\"bb\":7},"
+    "\"optionalNestedEnum\":\"BAZ\","
+    "\"repeatedInt32\":[1,2],"
+    "\"repeatedNestedMessage\":[{}]}",
+    json);
+}
+
+TEST(JsonFormatTest, PrintOptions) {
+  unittest::TestAllTypes message;
+  message.set_optional_int32(1);
+  message.set_optional_nested_enum(unittest::TestAllTypes::BAR);
+  message.add_repeated_int32(1);
+  message.add_repeated_int32(2);
+  message.mutable_optional_nested_message()->set_bb(3);
+
+  JsonFormat::Printer printer;
+  printer.SetPreserveFieldNames(true);
+  printer.SetPrintEnumsAsInts(true);
+  printer.SetPrettyPrint(true);
+  std::string json;
+  EXPECT_TRUE(printer.PrintToString(message, &json));
+  EXPECT_EQ(
+    "{\n"
+    "  \"optional_int32\": 1,\n"
+    "  \"optional_nested_message\": {\n"
+    "    \"bb\": 3\n"
+    "  },\n"
+    "  \"optional_nested_enum\": 2,\n"
+    "  \"repeated_int32\": [\n"
+    "    1,\n"
+    "    2\n"
+    "  ]\n"
+    "}\n",
+    json);
+
+  message.Clear();
+  EXPECT_TRUE(printer.PrintToString(message, &json));
+  EXPECT_EQ("{}\n", json);
+}
+
+TEST(JsonFormatTest, PrintExtensionName) {
+  unittest::TestAllExtensions message;
+  message.SetExtension(unittest::optional_int32_extension, 5);
+  std::string json;
+  EXPECT_TRUE(JsonFormat::PrintToString(message, &json));
+  EXPECT_EQ("{\"[protobuf_unittest.optional_int32_extension]\":5}", json);
+}
+
+TEST(JsonFormatTest, StringEscape) {
+  unittest::TestAllTypes message;
+  message.set_optional_string(std::string("\"\\/\b\f\n\r\t\x01\x1f\0", 11));
+  std::string json;
+  EXPECT_TRUE(JsonFormat::PrintToString(message, &json));
+  EXPECT_EQ("{\"optionalString\":"
+            "\"\\\"\\\\/\\b\\f\\n\\r\\t\\u0001\\u001f\\u0000\"}", json);
+
+  unittest::TestAllTypes parsed;
+  EXPECT_TRUE(JsonFormat::ParseFromString(json, &parsed));
+  EXPECT_EQ(message.optional_string(), parsed.optional_string());
+}
+
+TEST(JsonFormatTest, ParseUnicodeEscapes) {
+  unittest::TestAllTypes message;
+  EXPECT_TRUE(JsonFormat::ParseFromString(
+    "{\"optionalString\": \"\\u0041\\u00e9\\u20AC\\ud83d\\ude00\\/\"}",
+    &message));
+  EXPECT_EQ("A\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80/",
+            message.optional_string());
+}
+
+TEST(JsonFormatTest, Bytes) {
+  // Every remainder of length modulo 3, and every byte value.
+  for (int length = 0; length < 260; length++) {
+    std::string bytes;
+    for (int i = 0; i < length; i++) {
+      bytes.push_back(static_cast<char>(i * 7));
+    }
+    unittest::TestAllTypes message, parsed;
+    message.set_optional_bytes(bytes);
+    std::string json;
+    EXPECT_TRUE(JsonFormat::PrintToString(message, &json));
+    EXPECT_TRUE(JsonFormat::ParseFromString(json, &parsed)) << json;
+    EXPECT_EQ(bytes, parsed.optional_bytes());
+  }
+
+  // Padding is optional, and the URL-safe alphabet is accepted.
+  unittest::TestAllTypes message;
+  EXPECT_TRUE(JsonFormat::ParseFromString(
+    "{\"optionalBytes\": \"-_8\", \"repeatedBytes\": [\"YQ\", \"YWI=\"]}",
+    &message));
+  EXPECT_EQ("\xfb\xff", message.optional_bytes());
+  ASSERT_EQ(2, message.repeated_bytes_size());
+  EXPECT_EQ("a", message.repeated_bytes(0));
+  EXPECT_EQ("ab", message.repeated_bytes(1));
+}
+
+TEST(JsonFormatTest, FloatSpecialValues) {
+  unittest::TestAllTypes message;
+  message.add_repeated_double(std::numeric_limits<double>::quiet_NaN());
+  message.add_repeated_double(std::numeric_limits<double>::infinity());
+  message.add_repeated_double(-std::numeric_limits<double>::infinity());
+  message.add_repeated_double(-0.0);
+  message.add_repeated_double(1e300);
+  message.set_optional_float(std::numeric_limits<float>::infinity());
+
+  std::string json;
+  EXPECT_TRUE(JsonFormat::PrintToString(message, &json));
+  EXPECT_EQ("{\"optionalFloat\":\"Infinity\","
+            "\"repeatedDouble\":[\"NaN\",\"Infinity\",\"-Infinity\",-0,"
+            "1e+300]}", json);
+
+  unittest::TestAllTypes parsed;
+  EXPECT_TRUE(JsonFormat::ParseFromString(json, &parsed));
+  ASSERT_EQ(5, parsed.repeated_double_size());
+  EXPECT_TRUE(IsNaN(parsed.repeated_double(0)));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(),
+            parsed.repeated_double(1));
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(),
+            parsed.repeated_double(2));
+  EXPECT_EQ(1e300, parsed.repeated_double(4));
+  EXPECT_EQ(std::numeric_limits<float>::infinity(), parsed.optional_float());
+}
+
+TEST(JsonFormatTest, ParseNumbers) {
+  unittest::TestAllTypes message;
+  EXPECT_TRUE(JsonFormat::ParseFromString(
+    "{\"optionalInt32\": \"-2147483648\","
+    " \"optionalUint32\": 4294967295,"
+    " \"optionalInt64\": -9223372036854775808,"
+    " \"optionalUint64\": \"18446744073709551615\","
+    " \"optionalSint32\": 1.5e3,"
+    " \"optionalFixed32\": 10.0,"
+    " \"optionalDouble\": \"2.5E-3\","
+    " \"optionalFloat\": -0.1}",
+    &message));
+  EXPECT_EQ(kint32min, message.optional_int32());
+  EXPECT_EQ(kuint32max, message.optional_uint32());
+  EXPECT_EQ(kint64min, message.optional_int64());
+  EXPECT_EQ(kuint64max, message.optional_uint64());
+  EXPECT_EQ(1500, message.optional_sint32());
+  EXPECT_EQ(10, message.optional_fixed32());
+  EXPECT_EQ(2.5e-3, message.optional_double());
+  EXPECT_EQ(-0.1f, message.optional_float());
+
+  // The shortest decimal for FLT_MAX is slightly above it as a double.
+  EXPECT_TRUE(JsonFormat::ParseFromString(
+    "{\"optionalFloat\": -3.4028235e38}", &message));
+  EXPECT_EQ(-std::numeric_limits<float>::max(), message.optional_float());
+}
+
+TEST(JsonFormatTest, ParseEnum) {
+  unittest::TestAllTypes message;
+  EXPECT_TRUE(JsonFormat::ParseFromString(
+    "{\"optionalNestedEnum\": \"BAR\", \"repeatedNestedEnum\": [3, \"FOO\"]}",
+    &message));
+  EXPECT_EQ(unittest::TestAllTypes::BAR, message.optional_nested_enum());
+  ASSERT_EQ(2, message.repeated_nested_enum_size());
+  EXPECT_EQ(unittest::TestAllTypes::BAZ, message.repeated_nested_enum(0));
+  EXPECT_EQ(unittest::TestAllTypes::FOO, message.repeated_nested_enum(1));
+}
+
+TEST(JsonFormatTest, ParseEitherFieldName) {
+  unittest::TestAllTypes message;
+  EXPECT_TRUE(JsonFormat::ParseFromString(
+    "{\"optional_int32\": 1, \"optionalInt64\": \"2\","
+    " \"optionalgroup\": {\"a\": 3}}",
+    &message));
+  EXPECT_EQ(1, message.optional_int32());
+  EXPECT_EQ(2, message.optional_int64());
+  EXPECT_EQ(3, message.optionalgroup().a());
+}
+
+TEST(JsonFormatTest, ParseNull) {
+  unittest::TestAllTypes message;
+  message.set_optional_int32(1);
+  message.add_repeated_string("a");
+  EXPECT_TRUE(JsonFormat::MergeFromString(
+    "{\"optionalInt32\": null, \"repeatedString\": null,"
+    " \"optionalString\": \"b\"}",
+    &message));
+  EXPECT_FALSE(message.has_optional_int32());
+  EXPECT_EQ(0, message.repeated_string_size());
+  EXPECT_EQ("b", message.optional_string());
+}
+
+TEST(JsonFormatTest, IgnoreUnknownFields) {
+  unittest::TestAllTypes message;
+  JsonFormat::Parser parser;
+  parser.IgnoreUnknownFields(true);
+  EXPECT_TRUE(parser.ParseFromString(
+    "{\"unknown\": {\"a\": [1, -2.5e3, \"x\\\"y\", true, null, {}, []]},"
+    " \"optionalInt32\": 5, \"alsoUnknown\": false}",
+    &message));
+  EXPECT_EQ(5, message.optional_int32());
+}
+
+TEST(JsonFormatTest, ParseFromSmallBuffers) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  JsonFormat::Printer printer;
+  printer.SetPrettyPrint(true);
+  std::string json;
+  EXPECT_TRUE(printer.PrintToString(message, &json));
+
+  // Every token ends up split across buffers at some block size.
+  for (int block_size = 1; block_size < 20; block_size++) {
+    io::ArrayInputStream input(json.data(), json.size(), block_size);
+    unittest::TestAllTypes parsed;
+    EXPECT_TRUE(JsonFormat::Parse(&input, &parsed)) << block_size;
+    TestUtil::ExpectAllFieldsSet(parsed);
+  }
+}
+
+TEST(JsonFormatTest, PrintToSmallBuffers) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  std::string expected;
+  EXPECT_TRUE(JsonFormat::PrintToString(message, &expected));
+
+  for (int block_size = 1; block_size < 40; block_size++) {
+    std::string output(expected.size() + 100, '\0');
+    io::ArrayOutputStream output_stream(string_as_array(&output),
+                                        output.size(), block_size);
+    EXPECT_TRUE(JsonFormat::Print(message, &output_stream));
+    output.resize(output_stream.ByteCount());
+    EXPECT_EQ(expected, output) << "block_size = " << block_size;
+  }
+}
+
+TEST(JsonFormatTest, SurroundingWhitespace) {
+  unittest::TestAllTypes message;
+  EXPECT_TRUE(JsonFormat::ParseFromString(" {\"optionalInt32\": 1}\n ",
+                                          &message));
+  EXPECT_EQ(1, message.optional_int32());
+}
+
+// ===========================================================================
+
+class JsonFormatParserTest : public testing::Test {
+ protected:
+  void ExpectFailure(const std::string& input, const std::string& message,
+                     int line, int col) {
+    unittest::TestAllTypes proto;
+    ExpectFailure(input, message, line, col, &proto);
+  }
+
+  void ExpectFailure(const std::string& input, const std::string& message,
+                     int line, int col, Message* proto) {
+    JsonFormat::Parser parser;
+    MockErrorCollector error_collector;
+    parser.RecordErrorsTo(&error_collector);
+    EXPECT_FALSE(parser.ParseFromString(input, proto));
+    EXPECT_EQ(SimpleItoa(line) + ":" + SimpleItoa(col) + ": " + message + "\n",
+              error_collector.text_);
+  }
+
+  // An error collector which simply concatenates all its errors into a big
+  // block of text which can be checked.
+  class MockErrorCollector : public io::ErrorCollector {
+   public:
+    MockErrorCollector() {}
+    ~MockErrorCollector() {}
+
+    std::string text_;
+
+    // implements ErrorCollector -------------------------------------
+    void AddError(int line, int column, const std::string& message) {
+      strings::SubstituteAndAppend(&text_, "$0:$1: $2\n",
+                                   line + 1, column + 1, message);
+    }
+  };
+};
+
+TEST_F(JsonFormatParserTest, InvalidSyntax) {
+  ExpectFailure("", "Expected \"{\", found end of input.", 1, 1);
+  ExpectFailure("[]", "Expected \"{\", found \"[\".", 1, 1);
+  ExpectFailure("{\"optionalInt32\" 1}",
+                "Expected \":\", found \"1\".", 1, 18);
+  ExpectFailure("{\"optionalInt32\": 1 \"optionalInt64\": 2}",
+                "Expected \",\", found \"\\\"\".", 1, 21);
+  ExpectFailure("{\"optionalInt32\": 1,}",
+                "Expected string, found \"}\".", 1, 21);
+  ExpectFailure("{\n  \"optionalString\": \"abc",
+                "String literal not terminated.", 2, 21);
+  ExpectFailure("{\"optionalString\": \"a\nb\"}",
+                "Invalid control character in string.", 1, 22);
+  ExpectFailure("{\"optionalString\": \"\\x\"}",
+                "Invalid escape sequence in string.", 1, 22);
+  ExpectFailure("{\"optionalString\": \"\\ud800\"}",
+                "Unpaired surrogate in string.", 1, 27);
+  ExpectFailure("{}x", "Expected end of input, found \"x\".", 1, 3);
+  ExpectFailure("{} {}", "Expected end of input, found \"{\".", 1, 4);
+}
+
+TEST_F(JsonFormatParserTest, InvalidFieldName) {
+  ExpectFailure(
+    "{\n  \"optionalInt32\": 1,\n  \"noSuchField\": 1}",
+    "Message type \"protobuf_unittest.TestAllTypes\" has no field named "
+    "\"noSuchField\".",
+    3, 3);
+  ExpectFailure(
+    "{\"[protobuf_unittest.optional_int32_extension]\": 1}",
+    "Message type \"protobuf_unittest.TestAllTypes\" has no field named "
+    "\"[protobuf_unittest.optional_int32_extension]\".",
+    1, 2);
+}
+
+TEST_F(JsonFormatParserTest, InvalidFieldValues) {
+  ExpectFailure("{\"optionalInt32\": 2147483648}",
+                "Integer out of range.", 1, 19);
+  ExpectFailure("{\"optionalUint32\": -1}",
+                "Integer out of range.", 1, 20);
+  ExpectFailure("{\"optionalInt64\": \"9223372036854775808\"}",
+                "Integer out of range.", 1, 19);
+  ExpectFailure("{\"optionalUint64\": 18446744073709551616}",
+                "Expected integer, found \"18446744073709551616\".", 1, 20);
+  ExpectFailure("{\"optionalInt32\": 1.5}",
+                "Expected integer, found \"1.5\".", 1, 19);
+  ExpectFailure("{\"optionalInt32\": 01}",
+                "Invalid number \"01\".", 1, 19);
+  ExpectFailure("{\"optionalInt32\": \"one\"}",
+                "Expected number, found \"one\".", 1, 19);
+  ExpectFailure("{\"optionalFloat\": 1e300}",
+                "Float out of range.", 1, 19);
+  ExpectFailure("{\"optionalFloat\": \"-3.5e38\"}",
+                "Float out of range.", 1, 19);
+  ExpectFailure("{\"optionalDouble\": .5}",
+                "Invalid number \".5\".", 1, 20);
+  ExpectFailure("{\"optionalBool\": 1}",
+                "Expected true or false, found \"1\".", 1, 18);
+  ExpectFailure("{\"optionalBool\": \"true\"}",
+                "Expected true or false, found \"\\\"\".", 1, 18);
+  ExpectFailure("{\"optionalString\": 1}",
+                "Expected string, found \"1\".", 1, 20);
+  ExpectFailure("{\"optionalBytes\": \"a\"}",
+                "Invalid base64 data for field \"optional_bytes\".", 1, 19);
+  ExpectFailure("{\"optionalNestedEnum\": \"GRAULT\"}",
+                "Unknown enumeration value of \"GRAULT\" for field "
+                "\"optional_nested_enum\".", 1, 24);
+  ExpectFailure("{\"optionalNestedEnum\": 4}",
+                "Unknown enumeration value of \"4\" for field "
+                "\"optional_nested_enum\".", 1, 24);
+  ExpectFailure("{\"repeatedInt32\": 1}",
+                "Expected \"[\" for repeated field \"repeated_int32\", found "
+                "\"1\".", 1, 19);
+  ExpectFailure("{\"optionalNestedMessage\": []}",
+                "Expected \"{\", found \"[\".", 1, 27);
+  ExpectFailure("{\"optionalInt32\": nil}",
+                "Expected value, found \"nil\".", 1, 19);
+}
+
+TEST_F(JsonFormatParserTest, NestedTooDeeply) {
+  std::string json;
+  for (int i = 0; i < 200; i++) json += "{\"a\":";
+  unittest::TestRecursiveMessage message;
+  ExpectFailure(json, "Message is nested too deeply.", 1, 501, &message);
+}
+
+TEST_F(JsonFormatParserTest, MissingRequired) {
+  unittest::TestRequired message;
+  ExpectFailure("{\"a\": 1}",
+                "Message missing required fields: b, c",
+                0, 1, &message);
+
+  JsonFormat::Parser parser;
+  parser.AllowPartialMessage(true);
+  EXPECT_TRUE(parser.ParseFromString("{\"a\": 1}", &message));
+}
+
+TEST_F(JsonFormatParserTest, ParseDuplicateOptional) {
+  unittest::ForeignMessage message;
+  ExpectFailure("{\"c\": 1, \"c\": 2}",
+                "Non-repeated field \"c\" is specified multiple times.",
+                1, 10, &message);
+}
+
+TEST_F(JsonFormatParserTest, MergeDuplicateOptional) {
+  unittest::ForeignMessage message;
+  JsonFormat::Parser parser;
+  EXPECT_TRUE(parser.MergeFromString("{\"c\": 1, \"c\": 2}", &message));
+  EXPECT_EQ(2, message.c());
+}
+
+}  // namespace json_format_unittest
+}  // namespace protobuf
+}  // namespace google
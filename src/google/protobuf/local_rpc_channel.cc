@@ -0,0 +1,563 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <google/protobuf/local_rpc_channel.h>
+
+#include <deque>
+
+#include "config.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN  // We only need minimal includes
+#if !defined(_WIN32_WINNT) || _WIN32_WINNT < 0x0600
+#undef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600  // for condition variables
+#endif
+#include <windows.h>
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#include <string.h>
+#include <sys/time.h>
+#else
+#error "No suitable threading library available."
+#endif
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+
+namespace google {
+namespace protobuf {
+
+// ===================================================================
+// Threads, and a mutex with a condition variable, for the worker pool.
+
+#ifdef _WIN32
+
+struct LocalRpcChannel::Monitor {
+  CRITICAL_SECTION mutex;
+  CONDITION_VARIABLE condition;
+
+  Monitor() {
+    InitializeCriticalSection(&mutex);
+    InitializeConditionVariable(&condition);
+  }
+  ~Monitor() { DeleteCriticalSection(&mutex); }
+
+  void Lock() { EnterCriticalSection(&mutex); }
+  void Unlock() { LeaveCriticalSection(&mutex); }
+  void Wait() { SleepConditionVariableCS(&condition, &mutex, INFINITE); }
+  void WaitFor(int64 ms) {
+    SleepConditionVariableCS(&condition, &mutex, static_cast<DWORD>(ms));
+  }
+  void Signal() { WakeConditionVariable(&condition); }
+  void SignalAll() { WakeAllConditionVariable(&condition); }
+};
+
+struct LocalRpcChannel::Thread {
+  void (*main)(void*);
+  void* arg;
+  HANDLE handle;
+
+  Thread(void (*main)(void*), void* arg) : main(main), arg(arg) {
+    handle = CreateThread(NULL, 0, &Start, this, 0, NULL);
+    GOOGLE_CHECK(handle != NULL) << "CreateThread: " << GetLastError();
+  }
+  void Join() {
+    WaitForSingleObject(handle, INFINITE);
+    CloseHandle(handle);
+  }
+
+  static DWORD WINAPI Start(LPVOID thread) {
+    Thread* self = reinterpret_cast<Thread*>(thread);
+    self->main(self->arg);
+    return 0;
+  }
+};
+
+namespace {
+
+// Adds delta to *value and returns the result, as one atomic operation and
+// a full memory barrier.
+inline int AtomicAdd(volatile int* value, int delta) {
+  return InterlockedExchangeAdd(reinterpret_cast<volatile LONG*>(value),
+                                delta) + delta;
+}
+
+// Milliseconds since some fixed point in time.
+int64 NowMs() {
+  FILETIME now;
+  GetSystemTimeAsFileTime(&now);
+  return ((static_cast<int64>(now.dwHighDateTime) << 32) |
+          now.dwLowDateTime) / 10000;
+}
+
+}  // namespace
+
+#else  // _WIN32
+
+namespace {
+
+inline int AtomicAdd(volatile int* value, int delta) {
+  return __sync_add_and_fetch(value, delta);
+}
+
+int64 NowMs() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return static_cast<int64>(now.tv_sec) * 1000 + now.tv_usec / 1000;
+}
+
+}  // namespace
+
+struct LocalRpcChannel::Monitor {
+  pthread_mutex_t mutex;
+  pthread_cond_t condition;
+
+  Monitor() {
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&condition, NULL);
+  }
+  ~Monitor() {
+    pthread_cond_destroy(&condition);
+    pthread_mutex_destroy(&mutex);
+  }
+
+  void Lock() { pthread_mutex_lock(&mutex); }
+  void Unlock() { pthread_mutex_unlock(&mutex); }
+  void Wait() { pthread_cond_wait(&condition, &mutex); }
+  void WaitFor(int64 ms) {
+    // pthread_cond_timedwait() takes the time of day to wait until.
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    int64 usec = now.tv_usec + (ms % 1000) * 1000;
+    struct timespec until;
+    until.tv_sec = now.tv_sec + ms / 1000 + usec / 1000000;
+    until.tv_nsec = (usec % 1000000) * 1000;
+    pthread_cond_timedwait(&condition, &mutex, &until);
+  }
+  void Signal() { pthread_cond_signal(&condition); }
+  void SignalAll() { pthread_cond_broadcast(&condition); }
+};
+
+struct LocalRpcChannel::Thread {
+  void (*main)(void*);
+  void* arg;
+  pthread_t thread;
+
+  Thread(void (*main)(void*), void* arg) : main(main), arg(arg) {
+    int result = pthread_create(&thread, NULL, &Start, this);
+    GOOGLE_CHECK_EQ(result, 0) << "pthread_create: " << strerror(result);
+  }
+  void Join() { pthread_join(thread, NULL); }
+
+  static void* Start(void* thread) {
+    Thread* self = reinterpret_cast<Thread*>(thread);
+    self->main(self->arg);
+    return NULL;
+  }
+};
+
+#endif  // !_WIN32
+
+// ===================================================================
+
+LocalRpcController::LocalRpcController()
+  : failed_(false),
+    canceled_(false),
+    cancel_callback_(NULL),
+    timeout_ms_(0) {
+}
+
+LocalRpcController::~LocalRpcController() {}
+
+void LocalRpcController::set_timeout_ms(int timeout_ms) {
+  timeout_ms_ = timeout_ms;
+}
+
+void LocalRpcController::Reset() {
+  MutexLock lock(&mutex_);
+  failed_ = false;
+  error_text_.clear();
+  canceled_ = false;
+  cancel_reason_.clear();
+  cancel_callback_ = NULL;
+  timeout_ms_ = 0;
+}
+
+bool LocalRpcController::Failed() const {
+  MutexLock lock(&mutex_);
+  return failed_;
+}
+
+std::string LocalRpcController::ErrorText() const {
+  MutexLock lock(&mutex_);
+  return error_text_;
+}
+
+void LocalRpcController::StartCancel() {
+  Closure* callback = Cancel("Canceled.");
+  if (callback != NULL) callback->Run();
+}
+
+void LocalRpcController::SetFailed(const std::string& reason) {
+  MutexLock lock(&mutex_);
+  failed_ = true;
+  error_text_ = reason;
+}
+
+bool LocalRpcController::IsCanceled() const {
+  MutexLock lock(&mutex_);
+  return canceled_;
+}
+
+void LocalRpcController::NotifyOnCancel(Closure* callback) {
+  {
+    MutexLock lock(&mutex_);
+    if (!canceled_) {
+      cancel_callback_ = callback;
+      return;
+    }
+  }
+  callback->Run();
+}
+
+Closure* LocalRpcController::Cancel(const std::string& reason) {
+  MutexLock lock(&mutex_);
+  if (canceled_) return NULL;
+  canceled_ = true;
+  cancel_reason_ = reason;
+  Closure* callback = cancel_callback_;
+  cancel_callback_ = NULL;
+  return callback;
+}
+
+void LocalRpcController::FinishCall() {
+  Closure* callback;
+  {
+    MutexLock lock(&mutex_);
+    if (canceled_ && !failed_) {
+      failed_ = true;
+      error_text_ = cancel_reason_;
+    }
+    callback = cancel_callback_;
+    cancel_callback_ = NULL;
+  }
+  if (callback != NULL) callback->Run();
+}
+
+// ===================================================================
+
+// A call in progress.  It is also the "done" callback handed to the Service,
+// so that no other closure needs to be allocated per call.
+class LocalRpcChannel::Call : public Closure {
+ public:
+  LocalRpcChannel* channel;
+  Service* service;
+  const MethodDescriptor* method;     // of service->GetDescriptor()
+  LocalRpcController* controller;
+  const Message* request;
+  Message* response;
+  // When the caller's request or response is not of the class the Service
+  // expects, the copy of it handed to the Service instead; otherwise NULL.
+  Message* service_request;
+  Message* service_response;
+  Closure* done;
+  int64 deadline;                     // in NowMs() time; 0 if none
+
+  // implements Closure ---------------------------------------------
+  void Run() { channel->FinishCall(this); }
+};
+
+struct LocalRpcChannel::Worker {
+  LocalRpcChannel* channel;
+  int index;
+  Thread* thread;
+
+  Mutex mutex;                  // guards calls
+  std::deque<Call*> calls;
+};
+
+LocalRpcChannel::LocalRpcChannel(int num_threads)
+  : next_worker_(0),
+    pending_calls_(0),
+    idle_workers_(0),
+    idle_(new Monitor),
+    shutting_down_(false),
+    deadlines_(new Monitor),
+    stop_deadlines_(false) {
+  GOOGLE_CHECK_GT(num_threads, 0);
+  // Every worker must be there to steal from before the first one starts.
+  for (int i = 0; i < num_threads; i++) {
+    Worker* worker = new Worker;
+    worker->channel = this;
+    worker->index = i;
+    workers_.push_back(worker);
+  }
+  for (int i = 0; i < num_threads; i++) {
+    workers_[i]->thread = new Thread(&WorkerMain, workers_[i]);
+  }
+  deadline_thread_ = new Thread(&DeadlineMain, this);
+}
+
+LocalRpcChannel::~LocalRpcChannel() {
+  idle_->Lock();
+  shutting_down_ = true;
+  idle_->SignalAll();
+  idle_->Unlock();
+  for (int i = 0; i < workers_.size(); i++) {
+    workers_[i]->thread->Join();
+    delete workers_[i]->thread;
+  }
+
+  deadlines_->Lock();
+  stop_deadlines_ = true;
+  deadlines_->Signal();
+  deadlines_->Unlock();
+  deadline_thread_->Join();
+  delete deadline_thread_;
+
+  STLDeleteElements(&workers_);
+  delete idle_;
+  delete deadlines_;
+}
+
+void LocalRpcChannel::RegisterService(Service* service) {
+  const ServiceDescriptor* descriptor = service->GetDescriptor();
+  services_by_descriptor_[descriptor] = service;
+  services_by_name_[descriptor->full_name()] = service;
+}
+
+void LocalRpcChannel::CallMethod(const MethodDescriptor* method,
+                                 RpcController* controller,
+                                 const Message* request,
+                                 Message* response,
+                                 Closure* done) {
+  LocalRpcController* local_controller =
+      down_cast<LocalRpcController*>(controller);
+
+  // Callers using the Service's own descriptors, as generated stubs do,
+  // find it without comparing names.
+  Service* service = NULL;
+  const MethodDescriptor* service_method = method;
+  std::map<const ServiceDescriptor*, Service*>::const_iterator iter =
+      services_by_descriptor_.find(method->service());
+  if (iter != services_by_descriptor_.end()) {
+    service = iter->second;
+  } else {
+    std::map<std::string, Service*>::const_iterator by_name =
+        services_by_name_.find(method->service()->full_name());
+    if (by_name != services_by_name_.end()) {
+      service = by_name->second;
+      service_method =
+          service->GetDescriptor()->FindMethodByName(method->name());
+    }
+  }
+  if (service_method == NULL || service == NULL) {
+    local_controller->SetFailed("Method not found: " + method->full_name());
+    done->Run();
+    return;
+  }
+
+  Call* call = new Call;
+  call->channel = this;
+  call->service = service;
+  call->method = service_method;
+  call->controller = local_controller;
+  call->request = request;
+  call->response = response;
+  call->service_request = NULL;
+  call->service_response = NULL;
+  call->done = done;
+  call->deadline = 0;
+
+  if (local_controller->timeout_ms() > 0) {
+    call->deadline = NowMs() + local_controller->timeout_ms();
+    deadlines_->Lock();
+    bool earliest = deadline_set_.empty() ||
+                    call->deadline < deadline_set_.begin()->first;
+    deadline_set_.insert(std::make_pair(call->deadline, local_controller));
+    if (earliest) deadlines_->Signal();
+    deadlines_->Unlock();
+  }
+
+  Enqueue(call);
+}
+
+void LocalRpcChannel::Enqueue(Call* call) {
+  unsigned int next = AtomicAdd(&next_worker_, 1);
+  Worker* worker = workers_[next % workers_.size()];
+  {
+    MutexLock lock(&worker->mutex);
+    worker->calls.push_back(call);
+  }
+
+  // A worker going idle counts itself in idle_workers_ before it looks at
+  // pending_calls_ for the last time, and AtomicAdd() is a full barrier, so
+  // either it sees this call or this sees it and wakes it.
+  AtomicAdd(&pending_calls_, 1);
+  if (AtomicAdd(&idle_workers_, 0) > 0) {
+    idle_->Lock();
+    idle_->Signal();
+    idle_->Unlock();
+  }
+}
+
+LocalRpcChannel::Call* LocalRpcChannel::Dequeue(Worker* worker) {
+  // A worker runs its own calls oldest first, and steals the newest calls
+  // of the others, so that the two rarely contend for the same end.
+  {
+    MutexLock lock(&worker->mutex);
+    if (!worker->calls.empty()) {
+      Call* call = worker->calls.front();
+      worker->calls.pop_front();
+      return call;
+    }
+  }
+  for (int i = 1; i < workers_.size(); i++) {
+    Worker* victim = workers_[(worker->index + i) % workers_.size()];
+    MutexLock lock(&victim->mutex);
+    if (!victim->calls.empty()) {
+      Call* call = victim->calls.back();
+      victim->calls.pop_back();
+      return call;
+    }
+  }
+  return NULL;
+}
+
+void LocalRpcChannel::WorkerMain(void* worker) {
+  Worker* self = reinterpret_cast<Worker*>(worker);
+  self->channel->RunWorker(self);
+}
+
+void LocalRpcChannel::RunWorker(Worker* worker) {
+  while (true) {
+    Call* call = Dequeue(worker);
+    if (call != NULL) {
+      AtomicAdd(&pending_calls_, -1);
+      RunCall(call);
+      continue;
+    }
+
+    idle_->Lock();
+    AtomicAdd(&idle_workers_, 1);
+    while (AtomicAdd(&pending_calls_, 0) == 0 && !shutting_down_) {
+      idle_->Wait();
+    }
+    AtomicAdd(&idle_workers_, -1);
+    bool exit = shutting_down_ && AtomicAdd(&pending_calls_, 0) == 0;
+    idle_->Unlock();
+    if (exit) return;
+  }
+}
+
+void LocalRpcChannel::RunCall(Call* call) {
+  if (call->controller->IsCanceled()) {
+    FinishCall(call);
+    return;
+  }
+
+  const Message* request = call->request;
+  Message* response = call->response;
+  const Message& request_prototype =
+      call->service->GetRequestPrototype(call->method);
+  if (request->GetReflection() != request_prototype.GetReflection()) {
+    call->service_request = request_prototype.New();
+    call->service_request->ParsePartialFromString(
+        request->SerializePartialAsString());
+    request = call->service_request;
+  }
+  const Message& response_prototype =
+      call->service->GetResponsePrototype(call->method);
+  if (response->GetReflection() != response_prototype.GetReflection()) {
+    call->service_response = response_prototype.New();
+    response = call->service_response;
+  }
+
+  call->service->CallMethod(call->method, call->controller,
+                            request, response, call);
+}
+
+void LocalRpcChannel::FinishCall(Call* call) {
+  if (call->service_response != NULL && !call->controller->Failed()) {
+    call->response->ParsePartialFromString(
+        call->service_response->SerializePartialAsString());
+  }
+  delete call->service_request;
+  delete call->service_response;
+
+  // Once the call is out of deadline_set_, the deadline thread won't touch
+  // its controller again.
+  if (call->deadline != 0) {
+    deadlines_->Lock();
+    deadline_set_.erase(std::make_pair(call->deadline, call->controller));
+    deadlines_->Unlock();
+  }
+  call->controller->FinishCall();
+
+  Closure* done = call->done;
+  delete call;
+  done->Run();
+}
+
+void LocalRpcChannel::DeadlineMain(void* channel) {
+  reinterpret_cast<LocalRpcChannel*>(channel)->RunDeadlines();
+}
+
+void LocalRpcChannel::RunDeadlines() {
+  deadlines_->Lock();
+  while (!stop_deadlines_) {
+    if (deadline_set_.empty()) {
+      deadlines_->Wait();
+      continue;
+    }
+    int64 now = NowMs();
+    if (deadline_set_.begin()->first > now) {
+      deadlines_->WaitFor(deadline_set_.begin()->first - now);
+      continue;
+    }
+
+    LocalRpcController* controller = deadline_set_.begin()->second;
+    deadline_set_.erase(deadline_set_.begin());
+    Closure* callback = controller->Cancel("Deadline exceeded.");
+    if (callback != NULL) {
+      // The callback may finish the call, which needs deadlines_.
+      deadlines_->Unlock();
+      callback->Run();
+      deadlines_->Lock();
+    }
+  }
+  deadlines_->Unlock();
+}
+
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,207 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Defines LocalRpcChannel, an RpcChannel which calls Services living in the
+// same process, on a pool of worker threads, along with LocalRpcController,
+// the RpcController to use with it.
+//
+// Example:
+//   MyServiceImpl service;
+//   LocalRpcChannel channel(8);
+//   channel.RegisterService(&service);
+//
+//   MyService::Stub stub(&channel);
+//   LocalRpcController controller;
+//   controller.set_timeout_ms(100);
+//   stub.MyMethod(&controller, &request, &response, done);
+//
+// Calls are handed out to the worker threads in turn, and a worker with
+// nothing left to do takes calls waiting for the others (work stealing), so
+// that a slow call holds up no more than the worker running it.
+//
+// When the request and response passed to CallMethod() are of the classes of
+// the Service's prototypes (as they are when made through a generated stub
+// over generated code), the Service is handed the caller's objects and
+// nothing is copied.  Otherwise the request is copied into a message of the
+// Service's class, and the response copied back when the call is done,
+// through serialization.
+
+#ifndef GOOGLE_PROTOBUF_LOCAL_RPC_CHANNEL_H__
+#define GOOGLE_PROTOBUF_LOCAL_RPC_CHANNEL_H__
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <google/protobuf/service.h>
+
+namespace google {
+namespace protobuf {
+
+// Defined in this file.
+class LocalRpcChannel;
+class LocalRpcController;
+
+// The RpcController for calls made through a LocalRpcChannel.  The same
+// object is seen by the caller and by the Service, so that the Service's
+// SetFailed() is the caller's Failed(), and the caller's StartCancel() is
+// the Service's IsCanceled().
+//
+// A canceled call is not handed to its Service if it has not started yet.
+// Otherwise the Service is told through IsCanceled() and NotifyOnCancel(),
+// and the call still only completes when the Service runs its "done"
+// callback, as the Service may use the request and response until then.
+// Either way the call then fails with "Canceled." (or "Deadline exceeded."
+// if its deadline passed), unless the Service failed it itself.
+class LIBPROTOBUF_EXPORT LocalRpcController : public RpcController {
+ public:
+  LocalRpcController();
+  ~LocalRpcController();
+
+  // How long, in milliseconds from the call to CallMethod(), the call may
+  // take before it is canceled with "Deadline exceeded."  Zero (the default)
+  // means no deadline.  Reset() sets it back to zero.
+  void set_timeout_ms(int timeout_ms);
+  int timeout_ms() const { return timeout_ms_; }
+
+  // implements RpcController ---------------------------------------
+  void Reset();
+  bool Failed() const;
+  std::string ErrorText() const;
+  void StartCancel();
+  void SetFailed(const std::string& reason);
+  bool IsCanceled() const;
+  void NotifyOnCancel(Closure* callback);
+
+ private:
+  friend class LocalRpcChannel;
+
+  // Marks the call canceled, with reason as the error text it is to fail
+  // with, unless it already was.  Returns the NotifyOnCancel() callback for
+  // the caller to run, if there is one pending.
+  Closure* Cancel(const std::string& reason);
+
+  // Called by LocalRpcChannel when the Service runs the "done" callback, or
+  // when a canceled call is dropped before reaching the Service.  Fails the
+  // call if it was canceled, and runs the NotifyOnCancel() callback if that
+  // is still pending.
+  void FinishCall();
+
+  mutable Mutex mutex_;
+  bool failed_;
+  std::string error_text_;
+  bool canceled_;
+  std::string cancel_reason_;
+  Closure* cancel_callback_;
+  int timeout_ms_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(LocalRpcController);
+};
+
+// An RpcChannel which calls Services registered with it in this process, on
+// its own pool of worker threads.  The RpcController passed to CallMethod()
+// must be a LocalRpcController, and the "done" callback is run on a worker
+// thread (or on the calling thread, if the call fails before it is queued).
+class LIBPROTOBUF_EXPORT LocalRpcChannel : public RpcChannel {
+ public:
+  // Starts num_threads worker threads, and one more to enforce deadlines.
+  explicit LocalRpcChannel(int num_threads);
+
+  // Waits for the calls which have not been handed to their Service yet to
+  // be, and stops the threads.  Calls which the Service has not finished
+  // must not be outstanding:  the channel must outlive them.
+  ~LocalRpcChannel();
+
+  // Makes calls to methods of service->GetDescriptor(), or of a service of
+  // the same full name, go to service.  The channel does not take
+  // ownership.  Services must be registered before any call is made.
+  void RegisterService(Service* service);
+
+  int num_threads() const { return workers_.size(); }
+
+  // implements RpcChannel ------------------------------------------
+  void CallMethod(const MethodDescriptor* method,
+                  RpcController* controller,
+                  const Message* request,
+                  Message* response,
+                  Closure* done);
+
+ private:
+  class Call;
+  struct Worker;
+  struct Monitor;
+  struct Thread;
+
+  // Queues call for the worker threads.
+  void Enqueue(Call* call);
+
+  // Takes a call off worker's own queue, or else steals one from another
+  // worker's.  Returns NULL if there is none anywhere.
+  Call* Dequeue(Worker* worker);
+
+  // Hands the call to its Service, unless it was canceled first.
+  void RunCall(Call* call);
+
+  // Completes the call, once the Service has run the "done" callback.
+  void FinishCall(Call* call);
+
+  static void WorkerMain(void* worker);
+  void RunWorker(Worker* worker);
+  static void DeadlineMain(void* channel);
+  void RunDeadlines();
+
+  std::map<const ServiceDescriptor*, Service*> services_by_descriptor_;
+  std::map<std::string, Service*> services_by_name_;
+
+  std::vector<Worker*> workers_;
+  // Where Enqueue() puts the next call, modulo workers_.size().
+  volatile int next_worker_;
+  // Calls queued and not yet taken off a queue.
+  volatile int pending_calls_;
+  // Workers waiting on idle_ for a call to be queued.
+  volatile int idle_workers_;
+  Monitor* idle_;
+  bool shutting_down_;          // guarded by idle_
+
+  // Calls with a deadline which have not finished, by deadline.
+  std::set<std::pair<int64, LocalRpcController*> > deadline_set_;
+  Monitor* deadlines_;          // guards deadline_set_ and stop_deadlines_
+  bool stop_deadlines_;
+  Thread* deadline_thread_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(LocalRpcChannel);
+};
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_LOCAL_RPC_CHANNEL_H__
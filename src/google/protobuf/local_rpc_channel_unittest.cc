@@ -0,0 +1,356 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <google/protobuf/local_rpc_channel.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/unknown_field_set.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+void SleepMs(int ms) {
+#ifdef _WIN32
+  Sleep(ms);
+#else
+  usleep(ms * 1000);
+#endif
+}
+
+// A flag set by a callback, to wait for from the test's thread.
+class Flag {
+ public:
+  Flag() : set_(false) {}
+
+  void Set() {
+    MutexLock lock(&mutex_);
+    set_ = true;
+  }
+  bool IsSet() {
+    MutexLock lock(&mutex_);
+    return set_;
+  }
+
+  // Waits up to ten seconds for the flag to be set.
+  bool Wait() {
+    for (int i = 0; i < 10000 && !IsSet(); i++) SleepMs(1);
+    return IsSet();
+  }
+
+  Closure* NewSetCallback() { return NewCallback(this, &Flag::Set); }
+
+ private:
+  Mutex mutex_;
+  bool set_;
+};
+
+// Foo() copies the request's unknown fields into the response, blocking
+// first while block_foo is set.  Bar() only finishes when it is canceled.
+class TestServiceImpl : public protobuf_unittest::TestService {
+ public:
+  TestServiceImpl()
+    : foo_calls_(0), last_request_(NULL), cancel_notifications_(0),
+      block_foo_(false), saw_cancel_(false) {}
+
+  void Foo(RpcController* controller,
+           const protobuf_unittest::FooRequest* request,
+           protobuf_unittest::FooResponse* response,
+           Closure* done) {
+    {
+      MutexLock lock(&mutex_);
+      ++foo_calls_;
+      last_request_ = request;
+    }
+    while (block_foo()) SleepMs(1);
+    controller->NotifyOnCancel(
+        NewCallback(this, &TestServiceImpl::CountCancelNotification));
+    response->mutable_unknown_fields()->MergeFrom(request->unknown_fields());
+    done->Run();
+  }
+
+  void Bar(RpcController* controller,
+           const protobuf_unittest::BarRequest* request,
+           protobuf_unittest::BarResponse* response,
+           Closure* done) {
+    controller->NotifyOnCancel(
+        NewCallback(this, &TestServiceImpl::FinishBar, controller, done));
+    bar_started_.Set();
+  }
+
+  int foo_calls() {
+    MutexLock lock(&mutex_);
+    return foo_calls_;
+  }
+  const Message* last_request() {
+    MutexLock lock(&mutex_);
+    return last_request_;
+  }
+  int cancel_notifications() {
+    MutexLock lock(&mutex_);
+    return cancel_notifications_;
+  }
+  bool block_foo() {
+    MutexLock lock(&mutex_);
+    return block_foo_;
+  }
+  void set_block_foo(bool block) {
+    MutexLock lock(&mutex_);
+    block_foo_ = block;
+  }
+  bool saw_cancel() {
+    MutexLock lock(&mutex_);
+    return saw_cancel_;
+  }
+
+  Flag bar_started_;
+
+ private:
+  void CountCancelNotification() {
+    MutexLock lock(&mutex_);
+    ++cancel_notifications_;
+  }
+
+  void FinishBar(RpcController* controller, Closure* done) {
+    {
+      MutexLock lock(&mutex_);
+      saw_cancel_ = controller->IsCanceled();
+    }
+    done->Run();
+  }
+
+  Mutex mutex_;
+  int foo_calls_;
+  const Message* last_request_;
+  int cancel_notifications_;
+  bool block_foo_;
+  bool saw_cancel_;
+};
+
+class LocalRpcChannelTest : public testing::Test {
+ protected:
+  LocalRpcChannelTest() : channel_(4), stub_(&channel_) {
+    channel_.RegisterService(&service_);
+  }
+
+  TestServiceImpl service_;
+  LocalRpcChannel channel_;
+  protobuf_unittest::TestService::Stub stub_;
+  LocalRpcController controller_;
+  Flag done_;
+};
+
+TEST_F(LocalRpcChannelTest, Call) {
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  request.mutable_unknown_fields()->AddVarint(1234, 5);
+  stub_.Foo(&controller_, &request, &response, done_.NewSetCallback());
+
+  ASSERT_TRUE(done_.Wait());
+  EXPECT_FALSE(controller_.Failed());
+  EXPECT_EQ(1, service_.foo_calls());
+  // The objects are of the Service's classes, so it gets the caller's own.
+  EXPECT_EQ(&request, service_.last_request());
+  ASSERT_EQ(1, response.unknown_fields().field_count());
+  EXPECT_EQ(5, response.unknown_fields().field(0).varint());
+  // The call finished without being canceled, so the NotifyOnCancel()
+  // callback was run when it did.
+  EXPECT_EQ(1, service_.cancel_notifications());
+}
+
+TEST_F(LocalRpcChannelTest, CopiesMessagesOfOtherClasses) {
+  DynamicMessageFactory factory;
+  scoped_ptr<Message> request(factory.GetPrototype(
+      protobuf_unittest::FooRequest::descriptor())->New());
+  scoped_ptr<Message> response(factory.GetPrototype(
+      protobuf_unittest::FooResponse::descriptor())->New());
+  request->GetReflection()->MutableUnknownFields(request.get())
+      ->AddVarint(1234, 5);
+
+  channel_.CallMethod(protobuf_unittest::TestService::descriptor()->method(0),
+                      &controller_, request.get(), response.get(),
+                      done_.NewSetCallback());
+
+  ASSERT_TRUE(done_.Wait());
+  EXPECT_FALSE(controller_.Failed());
+  EXPECT_EQ(1, service_.foo_calls());
+  EXPECT_NE(request.get(), service_.last_request());
+  const UnknownFieldSet& unknown_fields =
+      response->GetReflection()->GetUnknownFields(*response);
+  ASSERT_EQ(1, unknown_fields.field_count());
+  EXPECT_EQ(5, unknown_fields.field(0).varint());
+}
+
+TEST_F(LocalRpcChannelTest, UnregisteredService) {
+  LocalRpcChannel channel(1);
+  protobuf_unittest::TestService::Stub stub(&channel);
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  stub.Foo(&controller_, &request, &response, done_.NewSetCallback());
+
+  // The call fails before it is queued, so "done" has already run.
+  EXPECT_TRUE(done_.IsSet());
+  EXPECT_TRUE(controller_.Failed());
+  EXPECT_EQ("Method not found: protobuf_unittest.TestService.Foo",
+            controller_.ErrorText());
+}
+
+TEST_F(LocalRpcChannelTest, StartCancel) {
+  protobuf_unittest::BarRequest request;
+  protobuf_unittest::BarResponse response;
+  stub_.Bar(&controller_, &request, &response, done_.NewSetCallback());
+
+  ASSERT_TRUE(service_.bar_started_.Wait());
+  EXPECT_FALSE(done_.IsSet());
+  controller_.StartCancel();
+
+  ASSERT_TRUE(done_.Wait());
+  EXPECT_TRUE(service_.saw_cancel());
+  EXPECT_TRUE(controller_.Failed());
+  EXPECT_EQ("Canceled.", controller_.ErrorText());
+}
+
+TEST_F(LocalRpcChannelTest, Deadline) {
+  protobuf_unittest::BarRequest request;
+  protobuf_unittest::BarResponse response;
+  controller_.set_timeout_ms(10);
+  stub_.Bar(&controller_, &request, &response, done_.NewSetCallback());
+
+  ASSERT_TRUE(done_.Wait());
+  EXPECT_TRUE(service_.saw_cancel());
+  EXPECT_TRUE(controller_.Failed());
+  EXPECT_EQ("Deadline exceeded.", controller_.ErrorText());
+
+  // Reset() clears the deadline along with the rest.
+  controller_.Reset();
+  EXPECT_EQ(0, controller_.timeout_ms());
+  EXPECT_FALSE(controller_.Failed());
+  EXPECT_FALSE(controller_.IsCanceled());
+}
+
+TEST_F(LocalRpcChannelTest, DeadlineNotReached) {
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  controller_.set_timeout_ms(10000);
+  stub_.Foo(&controller_, &request, &response, done_.NewSetCallback());
+
+  ASSERT_TRUE(done_.Wait());
+  EXPECT_FALSE(controller_.Failed());
+  EXPECT_FALSE(controller_.IsCanceled());
+}
+
+TEST_F(LocalRpcChannelTest, CanceledBeforeStarting) {
+  LocalRpcChannel channel(1);
+  channel.RegisterService(&service_);
+  protobuf_unittest::TestService::Stub stub(&channel);
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response1, response2;
+
+  // Keep the only worker busy with a first call...
+  service_.set_block_foo(true);
+  stub.Foo(&controller_, &request, &response1, done_.NewSetCallback());
+  while (service_.foo_calls() == 0) SleepMs(1);
+
+  // ...so that the second is canceled while still queued.
+  LocalRpcController controller2;
+  Flag done2;
+  stub.Foo(&controller2, &request, &response2, done2.NewSetCallback());
+  controller2.StartCancel();
+  service_.set_block_foo(false);
+
+  ASSERT_TRUE(done_.Wait());
+  ASSERT_TRUE(done2.Wait());
+  EXPECT_FALSE(controller_.Failed());
+  EXPECT_TRUE(controller2.Failed());
+  EXPECT_EQ("Canceled.", controller2.ErrorText());
+  EXPECT_EQ(1, service_.foo_calls());
+}
+
+TEST_F(LocalRpcChannelTest, Future) {
+  protobuf_unittest::FooRequest request;
+  request.mutable_unknown_fields()->AddVarint(1234, 5);
+  RpcFuture<protobuf_unittest::FooResponse> future;
+
+  // The call runs on a worker, and Wait() blocks until it has finished.  The
+  // future is passed the way a future_stubs stub passes it.
+  service_.set_block_foo(true);
+  stub_.Foo(&controller_, &request, future.mutable_response(), &future);
+  future.Then(done_.NewSetCallback());
+  while (service_.foo_calls() == 0) SleepMs(1);
+  EXPECT_FALSE(future.IsDone());
+  service_.set_block_foo(false);
+  future.Wait();
+
+  EXPECT_TRUE(future.IsDone());
+  EXPECT_TRUE(done_.IsSet());
+  EXPECT_FALSE(controller_.Failed());
+  ASSERT_EQ(1, future.response().unknown_fields().field_count());
+  EXPECT_EQ(5, future.response().unknown_fields().field(0).varint());
+}
+
+TEST_F(LocalRpcChannelTest, ManyCalls) {
+  const int kCalls = 1000;
+  protobuf_unittest::FooRequest request;
+  std::vector<protobuf_unittest::FooResponse*> responses;
+  std::vector<LocalRpcController*> controllers;
+  std::vector<Flag*> flags;
+  for (int i = 0; i < kCalls; i++) {
+    responses.push_back(new protobuf_unittest::FooResponse);
+    controllers.push_back(new LocalRpcController);
+    flags.push_back(new Flag);
+    stub_.Foo(controllers[i], &request, responses[i],
+              flags[i]->NewSetCallback());
+  }
+
+  for (int i = 0; i < kCalls; i++) {
+    ASSERT_TRUE(flags[i]->Wait());
+    EXPECT_FALSE(controllers[i]->Failed());
+  }
+  EXPECT_EQ(kCalls, service_.foo_calls());
+
+  STLDeleteElements(&responses);
+  STLDeleteElements(&controllers);
+  STLDeleteElements(&flags);
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
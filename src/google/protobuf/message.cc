@@ -183,6 +183,21 @@ bool Message::SerializePartialToOstream(std::ostream* output) const {
 
 Reflection::~Reflection() {}
 
+const void* Reflection::GetRawRepeatedField(
+    const Message& message, const FieldDescriptor* field) const {
+  return NULL;
+}
+
+void* Reflection::MutableRawRepeatedField(
+    Message* message, const FieldDescriptor* field) const {
+  return NULL;
+}
+
+bool Reflection::AddSpaceUsed(const Message& message,
+                              SpaceUsedBreakdown* breakdown) const {
+  return false;
+}
+
 // ===================================================================
 // MessageFactory
 
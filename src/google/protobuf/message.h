@@ -144,6 +144,7 @@ namespace io {
   class CodedOutputStream;     // coded_stream.h
 }
 class UnknownFieldSet;       // unknown_field_set.h
+class SpaceUsedBreakdown;    // space_used_breakdown.h
 
 // A container to hold message metadata.
 struct Metadata {
@@ -607,6 +608,32 @@ class LIBPROTOBUF_EXPORT Reflection {
                               MessageFactory* factory = NULL) const = 0;
 
 
+  // Repeated field storage ------------------------------------------
+  // These give direct access to the RepeatedField<T> holding a repeated
+  // field whose cpp_type() is a number or bool (T being int32, int64,
+  // uint32, uint64, float, double or bool), so that the whole field can be
+  // read or filled at once.  They return NULL if the field is not stored
+  // that way (extensions, for example), in which case the accessors above
+  // must be used.  The default implementations always return NULL.
+
+  virtual const void* GetRawRepeatedField(const Message& message,
+                                          const FieldDescriptor* field) const;
+  virtual void* MutableRawRepeatedField(Message* message,
+                                        const FieldDescriptor* field) const;
+
+
+  // Memory use ------------------------------------------------------
+  // Used by SpaceUsedBreakdown (space_used_breakdown.h), which most callers
+  // want instead of this.  Reports the memory which SpaceUsed() counts for
+  // message to *breakdown piece by piece, handing it the submessages to
+  // descend into, and returns true.  The default implementation reports
+  // nothing and returns false, so that all of SpaceUsed() is counted as the
+  // message's own.
+
+  virtual bool AddSpaceUsed(const Message& message,
+                            SpaceUsedBreakdown* breakdown) const;
+
+
   // Extensions ------------------------------------------------------
 
   // Try to find an extension of this message type by fully-qualified field
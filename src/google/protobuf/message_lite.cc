@@ -35,20 +35,68 @@
 
 #include <google/protobuf/message_lite.h>
 #include <string>
+#include <google/protobuf/allocator.h>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/message_stats.h>
 #include <google/protobuf/stubs/stl_util-inl.h>
 
+#include "config.h"
+
 namespace google {
 namespace protobuf {
 
 MessageLite::~MessageLite() {}
 
+void* MessageLite::operator new(size_t size) {
+  return internal::Allocate(size, ALLOCATION_MESSAGE);
+}
+
+void MessageLite::operator delete(void* ptr) {
+  internal::Free(ptr, ALLOCATION_MESSAGE);
+}
+
+void* MessageLite::operator new(size_t size, const std::nothrow_t&) throw() {
+  return internal::AllocateNoThrow(size, ALLOCATION_MESSAGE);
+}
+
+void MessageLite::operator delete(void* ptr, const std::nothrow_t&) throw() {
+  internal::Free(ptr, ALLOCATION_MESSAGE);
+}
+
 std::string MessageLite::InitializationErrorString() const {
   return "(cannot determine missing fields for lite message)";
 }
 
+const MessageLite* MessageLite::GetPrototype() const {
+  return NULL;
+}
+
+// Count the parsing or serialization of *this by the calling method in the
+// message stats (see message_stats.h), if they are compiled in.  POSITION is
+// the position in the input or output before and then after:
+//   GOOGLE_PROTOBUF_STATS_START(input->CurrentPosition());
+//   bool result = ...;
+//   GOOGLE_PROTOBUF_STATS_PARSED(input->CurrentPosition(), result);
+// Only the Partial variants of the Serialize methods count, since the others
+// just call those.
+#ifdef GOOGLE_PROTOBUF_MESSAGE_STATS
+#define GOOGLE_PROTOBUF_STATS_START(POSITION)                              \
+  const int stats_position = (POSITION);                                 \
+  const uint64 stats_start = internal::MessageStatsNow()
+#define GOOGLE_PROTOBUF_STATS_PARSED(POSITION, RESULT)                     \
+  internal::CountParse(*this, (POSITION) - stats_position, stats_start,  \
+                       (RESULT))
+#define GOOGLE_PROTOBUF_STATS_SERIALIZED(POSITION, RESULT)                 \
+  internal::CountSerialize(*this, (POSITION) - stats_position,           \
+                           stats_start, (RESULT))
+#else
+#define GOOGLE_PROTOBUF_STATS_START(POSITION)
+#define GOOGLE_PROTOBUF_STATS_PARSED(POSITION, RESULT)
+#define GOOGLE_PROTOBUF_STATS_SERIALIZED(POSITION, RESULT)
+#endif
+
 namespace {
 
 // When serializing, we first compute the byte size, then serialize the message.
@@ -154,61 +202,95 @@ bool InlineParsePartialFromArray(const void* data, int size,
 }  // namespace
 
 bool MessageLite::MergeFromCodedStream(io::CodedInputStream* input) {
-  return InlineMergeFromCodedStream(input, this);
+  GOOGLE_PROTOBUF_STATS_START(input->CurrentPosition());
+  bool result = InlineMergeFromCodedStream(input, this);
+  GOOGLE_PROTOBUF_STATS_PARSED(input->CurrentPosition(), result);
+  return result;
 }
 
 bool MessageLite::ParseFromCodedStream(io::CodedInputStream* input) {
-  return InlineParseFromCodedStream(input, this);
+  GOOGLE_PROTOBUF_STATS_START(input->CurrentPosition());
+  bool result = InlineParseFromCodedStream(input, this);
+  GOOGLE_PROTOBUF_STATS_PARSED(input->CurrentPosition(), result);
+  return result;
 }
 
 bool MessageLite::ParsePartialFromCodedStream(io::CodedInputStream* input) {
-  return InlineParsePartialFromCodedStream(input, this);
+  GOOGLE_PROTOBUF_STATS_START(input->CurrentPosition());
+  bool result = InlineParsePartialFromCodedStream(input, this);
+  GOOGLE_PROTOBUF_STATS_PARSED(input->CurrentPosition(), result);
+  return result;
 }
 
 bool MessageLite::ParseFromZeroCopyStream(io::ZeroCopyInputStream* input) {
+  GOOGLE_PROTOBUF_STATS_START(0);
   io::CodedInputStream decoder(input);
-  return ParseFromCodedStream(&decoder) && decoder.ConsumedEntireMessage();
+  bool result = InlineParseFromCodedStream(&decoder, this) &&
+                decoder.ConsumedEntireMessage();
+  GOOGLE_PROTOBUF_STATS_PARSED(decoder.CurrentPosition(), result);
+  return result;
 }
 
 bool MessageLite::ParsePartialFromZeroCopyStream(
     io::ZeroCopyInputStream* input) {
+  GOOGLE_PROTOBUF_STATS_START(0);
   io::CodedInputStream decoder(input);
-  return ParsePartialFromCodedStream(&decoder) &&
-         decoder.ConsumedEntireMessage();
+  bool result = InlineParsePartialFromCodedStream(&decoder, this) &&
+                decoder.ConsumedEntireMessage();
+  GOOGLE_PROTOBUF_STATS_PARSED(decoder.CurrentPosition(), result);
+  return result;
 }
 
 bool MessageLite::ParseFromBoundedZeroCopyStream(
     io::ZeroCopyInputStream* input, int size) {
+  GOOGLE_PROTOBUF_STATS_START(0);
   io::CodedInputStream decoder(input);
   decoder.PushLimit(size);
-  return ParseFromCodedStream(&decoder) &&
-         decoder.ConsumedEntireMessage() &&
-         decoder.BytesUntilLimit() == 0;
+  bool result = InlineParseFromCodedStream(&decoder, this) &&
+                decoder.ConsumedEntireMessage() &&
+                decoder.BytesUntilLimit() == 0;
+  GOOGLE_PROTOBUF_STATS_PARSED(decoder.CurrentPosition(), result);
+  return result;
 }
 
 bool MessageLite::ParsePartialFromBoundedZeroCopyStream(
     io::ZeroCopyInputStream* input, int size) {
+  GOOGLE_PROTOBUF_STATS_START(0);
   io::CodedInputStream decoder(input);
   decoder.PushLimit(size);
-  return ParsePartialFromCodedStream(&decoder) &&
-         decoder.ConsumedEntireMessage() &&
-         decoder.BytesUntilLimit() == 0;
+  bool result = InlineParsePartialFromCodedStream(&decoder, this) &&
+                decoder.ConsumedEntireMessage() &&
+                decoder.BytesUntilLimit() == 0;
+  GOOGLE_PROTOBUF_STATS_PARSED(decoder.CurrentPosition(), result);
+  return result;
 }
 
 bool MessageLite::ParseFromString(const std::string& data) {
-  return InlineParseFromArray(data.data(), data.size(), this);
+  GOOGLE_PROTOBUF_STATS_START(0);
+  bool result = InlineParseFromArray(data.data(), data.size(), this);
+  GOOGLE_PROTOBUF_STATS_PARSED(data.size(), result);
+  return result;
 }
 
 bool MessageLite::ParsePartialFromString(const std::string& data) {
-  return InlineParsePartialFromArray(data.data(), data.size(), this);
+  GOOGLE_PROTOBUF_STATS_START(0);
+  bool result = InlineParsePartialFromArray(data.data(), data.size(), this);
+  GOOGLE_PROTOBUF_STATS_PARSED(data.size(), result);
+  return result;
 }
 
 bool MessageLite::ParseFromArray(const void* data, int size) {
-  return InlineParseFromArray(data, size, this);
+  GOOGLE_PROTOBUF_STATS_START(0);
+  bool result = InlineParseFromArray(data, size, this);
+  GOOGLE_PROTOBUF_STATS_PARSED(size, result);
+  return result;
 }
 
 bool MessageLite::ParsePartialFromArray(const void* data, int size) {
-  return InlineParsePartialFromArray(data, size, this);
+  GOOGLE_PROTOBUF_STATS_START(0);
+  bool result = InlineParsePartialFromArray(data, size, this);
+  GOOGLE_PROTOBUF_STATS_PARSED(size, result);
+  return result;
 }
 
 
@@ -232,6 +314,7 @@ bool MessageLite::SerializeToCodedStream(io::CodedOutputStream* output) const {
 
 bool MessageLite::SerializePartialToCodedStream(
     io::CodedOutputStream* output) const {
+  GOOGLE_PROTOBUF_STATS_START(output->ByteCount());
   const int size = ByteSize();  // Force size to be cached.
   uint8* buffer = output->GetDirectBufferForNBytesAndAdvance(size);
   if (buffer != NULL) {
@@ -239,11 +322,13 @@ bool MessageLite::SerializePartialToCodedStream(
     if (end - buffer != size) {
       ByteSizeConsistencyError(size, ByteSize(), end - buffer);
     }
+    GOOGLE_PROTOBUF_STATS_SERIALIZED(output->ByteCount(), true);
     return true;
   } else {
     int original_byte_count = output->ByteCount();
     SerializeWithCachedSizes(output);
     if (output->HadError()) {
+      GOOGLE_PROTOBUF_STATS_SERIALIZED(output->ByteCount(), false);
       return false;
     }
     int final_byte_count = output->ByteCount();
@@ -253,6 +338,7 @@ bool MessageLite::SerializePartialToCodedStream(
                                final_byte_count - original_byte_count);
     }
 
+    GOOGLE_PROTOBUF_STATS_SERIALIZED(final_byte_count, true);
     return true;
   }
 }
@@ -275,6 +361,7 @@ bool MessageLite::AppendToString(std::string* output) const {
 }
 
 bool MessageLite::AppendPartialToString(std::string* output) const {
+  GOOGLE_PROTOBUF_STATS_START(output->size());
   int old_size = output->size();
   int byte_size = ByteSize();
   STLStringResizeUninitialized(output, old_size + byte_size);
@@ -283,6 +370,7 @@ bool MessageLite::AppendPartialToString(std::string* output) const {
   if (end - start != byte_size) {
     ByteSizeConsistencyError(byte_size, ByteSize(), end - start);
   }
+  GOOGLE_PROTOBUF_STATS_SERIALIZED(output->size(), true);
   return true;
 }
 
@@ -302,13 +390,18 @@ bool MessageLite::SerializeToArray(void* data, int size) const {
 }
 
 bool MessageLite::SerializePartialToArray(void* data, int size) const {
+  GOOGLE_PROTOBUF_STATS_START(0);
   int byte_size = ByteSize();
-  if (size < byte_size) return false;
+  if (size < byte_size) {
+    GOOGLE_PROTOBUF_STATS_SERIALIZED(0, false);
+    return false;
+  }
   uint8* start = reinterpret_cast<uint8*>(data);
   uint8* end = SerializeWithCachedSizesToArray(start);
   if (end - start != byte_size) {
     ByteSizeConsistencyError(byte_size, ByteSize(), end - start);
   }
+  GOOGLE_PROTOBUF_STATS_SERIALIZED(byte_size, true);
   return true;
 }
 
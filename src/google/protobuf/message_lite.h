@@ -39,6 +39,7 @@
 #ifndef GOOGLE_PROTOBUF_MESSAGE_LITE_H__
 #define GOOGLE_PROTOBUF_MESSAGE_LITE_H__
 
+#include <new>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/io/coded_stream.h>
 
@@ -73,6 +74,16 @@ class LIBPROTOBUF_EXPORT MessageLite {
   inline MessageLite() {}
   virtual ~MessageLite();
 
+  // Messages are allocated through the Allocator (see allocator.h).  The
+  // nothrow and placement forms are declared because these would hide them
+  // otherwise.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+  static void* operator new(size_t size, const std::nothrow_t&) throw();
+  static void operator delete(void* ptr, const std::nothrow_t&) throw();
+  static inline void* operator new(size_t, void* place) { return place; }
+  static inline void operator delete(void*, void*) {}
+
   // Basic Operations ------------------------------------------------
 
   // Get the name of this message type, e.g. "foo.bar.BazProto".
@@ -229,6 +240,11 @@ class LIBPROTOBUF_EXPORT MessageLite {
   // method.)
   virtual int GetCachedSize() const = 0;
 
+  // Returns the default instance of this message's type, or NULL for classes
+  // which do not say (those neither generated by protoc nor DynamicMessages).
+  // Used to tell types apart when counting them (see message_stats.h).
+  virtual const MessageLite* GetPrototype() const;
+
  private:
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MessageLite);
 };
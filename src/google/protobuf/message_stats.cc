@@ -0,0 +1,280 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/message_stats.h>
+#include <algorithm>
+#include <map>
+#include <google/protobuf/message_lite.h>
+#include <google/protobuf/stubs/once.h>
+
+#include "config.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN  // We only need minimal includes
+#include <windows.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#include <sys/time.h>
+#else
+#error "No suitable threading library available."
+#endif
+
+namespace google {
+namespace protobuf {
+
+MessageStats::MessageStats()
+  : prototype(NULL),
+    parses(0),
+    parse_failures(0),
+    parse_bytes(0),
+    parse_cycles(0),
+    serializes(0),
+    serialize_failures(0),
+    serialize_bytes(0),
+    serialize_cycles(0) {}
+
+namespace {
+
+// Counts of all types, by prototype.
+typedef std::map<const MessageLite*, MessageStats> Totals;
+
+// Adds the counts of from to *to, or subtracts them if sign is -1.
+void AddCounts(const MessageStats& from, int sign, MessageStats* to) {
+  to->parses += sign * from.parses;
+  to->parse_failures += sign * from.parse_failures;
+  to->parse_bytes += sign * from.parse_bytes;
+  to->parse_cycles += sign * from.parse_cycles;
+  to->serializes += sign * from.serializes;
+  to->serialize_failures += sign * from.serialize_failures;
+  to->serialize_bytes += sign * from.serialize_bytes;
+  to->serialize_cycles += sign * from.serialize_cycles;
+}
+
+void AddTotals(const Totals& from, int sign, Totals* to) {
+  for (Totals::const_iterator it = from.begin(); it != from.end(); ++it) {
+    AddCounts(it->second, sign, &(*to)[it->first]);
+  }
+}
+
+bool ByTypeName(const MessageStats& a, const MessageStats& b) {
+  return a.type_name < b.type_name;
+}
+
+// The counts of one thread.  Only that thread adds types or counts, so it
+// does both without locking; other threads only read them, and take mutex_
+// to keep counts_ from changing while they do.
+class ThreadStats {
+ public:
+  ThreadStats() : last_prototype_(NULL), last_stats_(NULL) {}
+
+  // Returns the counts for the given type, starting them if needed.
+  MessageStats* Find(const MessageLite* prototype) {
+    if (prototype == last_prototype_) return last_stats_;
+    Totals::iterator it = counts_.find(prototype);
+    if (it != counts_.end()) {
+      last_stats_ = &it->second;
+    } else {
+      internal::MutexLock lock(&mutex_);
+      last_stats_ = &counts_[prototype];
+    }
+    last_prototype_ = prototype;
+    return last_stats_;
+  }
+
+  // Adds the counts to *totals.  Called by any thread.
+  void AddTo(Totals* totals) {
+    internal::MutexLock lock(&mutex_);
+    AddTotals(counts_, 1, totals);
+  }
+
+ private:
+  internal::Mutex mutex_;
+  Totals counts_;
+
+  // The type counted last, which is likely to be counted next.
+  const MessageLite* last_prototype_;
+  MessageStats* last_stats_;
+};
+
+// All the threads' counts.
+struct Registry {
+  internal::Mutex mutex;
+  std::vector<ThreadStats*> threads;  // Threads counting.
+  Totals exited;                      // Counts of threads which exited.
+  Totals reset;                       // Totals at ResetMessageStats().
+};
+
+Registry* registry_ = NULL;
+GOOGLE_PROTOBUF_DECLARE_ONCE(registry_init_);
+
+// This thread's counts, or NULL if it has not counted yet.
+GOOGLE_THREAD_LOCAL ThreadStats* thread_stats_ = NULL;
+
+#if defined(HAVE_PTHREAD) && !defined(_WIN32)
+// Moves the counts of a thread into registry_->exited when it exits.  On
+// Windows, the counts of threads which exit are kept as they are instead.
+pthread_key_t thread_exit_key_;
+
+void ThreadExited(void* thread_stats) {
+  ThreadStats* stats = static_cast<ThreadStats*>(thread_stats);
+  {
+    internal::MutexLock lock(&registry_->mutex);
+    stats->AddTo(&registry_->exited);
+    std::vector<ThreadStats*>& threads = registry_->threads;
+    threads.erase(std::find(threads.begin(), threads.end(), stats));
+  }
+  delete stats;
+}
+#endif
+
+// The registry is never deleted, not even by ShutdownProtobufLibrary():
+// other threads may still count, and hold their ThreadStats in
+// thread_stats_, after that.
+void InitRegistry() {
+  registry_ = new Registry;
+#if defined(HAVE_PTHREAD) && !defined(_WIN32)
+  pthread_key_create(&thread_exit_key_, &ThreadExited);
+#endif
+}
+
+ThreadStats* GetThreadStats() {
+  if (thread_stats_ == NULL) {
+    GoogleOnceInit(&registry_init_, &InitRegistry);
+    thread_stats_ = new ThreadStats;
+    {
+      internal::MutexLock lock(&registry_->mutex);
+      registry_->threads.push_back(thread_stats_);
+    }
+#if defined(HAVE_PTHREAD) && !defined(_WIN32)
+    pthread_setspecific(thread_exit_key_, thread_stats_);
+#endif
+  }
+  return thread_stats_;
+}
+
+// Returns the counts of all threads since the program started.
+void GetTotals(Totals* totals) {
+  GoogleOnceInit(&registry_init_, &InitRegistry);
+  internal::MutexLock lock(&registry_->mutex);
+  *totals = registry_->exited;
+  for (int i = 0; i < registry_->threads.size(); i++) {
+    registry_->threads[i]->AddTo(totals);
+  }
+}
+
+}  // namespace
+
+bool MessageStatsEnabled() {
+#ifdef GOOGLE_PROTOBUF_MESSAGE_STATS
+  return true;
+#else
+  return false;
+#endif
+}
+
+void GetMessageStats(std::vector<MessageStats>* stats) {
+  Totals totals;
+  GetTotals(&totals);
+  {
+    internal::MutexLock lock(&registry_->mutex);
+    AddTotals(registry_->reset, -1, &totals);
+  }
+  stats->clear();
+  for (Totals::const_iterator it = totals.begin(); it != totals.end(); ++it) {
+    if (it->second.parses != 0 || it->second.serializes != 0) {
+      stats->push_back(it->second);
+      stats->back().type_name = it->first->GetTypeName();
+      stats->back().prototype = it->first;
+    }
+  }
+  std::sort(stats->begin(), stats->end(), &ByTypeName);
+}
+
+void ResetMessageStats() {
+  Totals totals;
+  GetTotals(&totals);
+  internal::MutexLock lock(&registry_->mutex);
+  registry_->reset.swap(totals);
+}
+
+namespace internal {
+
+uint64 MessageStatsNow() {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+  return __rdtsc();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+  uint32 low, high;
+  __asm__ __volatile__("rdtsc" : "=a" (low), "=d" (high));
+  return (static_cast<uint64>(high) << 32) | low;
+#elif defined(_WIN32)
+  static LARGE_INTEGER frequency;
+  if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+  return static_cast<uint64>(
+      static_cast<double>(now.QuadPart) * 1e9 / frequency.QuadPart);
+#else
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return (static_cast<uint64>(now.tv_sec) * 1000000 + now.tv_usec) * 1000;
+#endif
+}
+
+void CountParse(const MessageLite& message, int bytes, uint64 start,
+                bool succeeded) {
+  uint64 end = MessageStatsNow();
+  const MessageLite* prototype = message.GetPrototype();
+  if (prototype == NULL) return;
+  MessageStats* stats = GetThreadStats()->Find(prototype);
+  ++stats->parses;
+  if (!succeeded) ++stats->parse_failures;
+  stats->parse_bytes += bytes;
+  stats->parse_cycles += end - start;
+}
+
+void CountSerialize(const MessageLite& message, int bytes, uint64 start,
+                    bool succeeded) {
+  uint64 end = MessageStatsNow();
+  const MessageLite* prototype = message.GetPrototype();
+  if (prototype == NULL) return;
+  MessageStats* stats = GetThreadStats()->Find(prototype);
+  ++stats->serializes;
+  if (!succeeded) ++stats->serialize_failures;
+  stats->serialize_bytes += bytes;
+  stats->serialize_cycles += end - start;
+}
+
+}  // namespace internal
+
+}  // namespace protobuf
+}  // namespace google
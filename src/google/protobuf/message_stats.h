@@ -0,0 +1,121 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Counts parsing and serialization per message type:  how many messages
+// of each type were parsed and serialized, how many bytes that took, how
+// long it took and how many times it failed, e.g. to find out which types
+// a server spends its time on:
+//   std::vector<MessageStats> stats;
+//   GetMessageStats(&stats);
+//   for (int i = 0; i < stats.size(); i++) {
+//     printf("%s: %lld parsed\n", stats[i].type_name.c_str(),
+//            static_cast<long long>(stats[i].parses));
+//   }
+//
+// The counting is done by the Parse*(), Merge*(), Serialize*() and
+// Append*() methods of MessageLite (and so of Message), and is only compiled
+// in when the library is built with GOOGLE_PROTOBUF_MESSAGE_STATS defined
+// ("./configure --enable-message-stats", or in config.h for MSVC and C++
+// Builder).  Otherwise those methods do no more than they always did, and
+// GetMessageStats() returns nothing.
+//
+// Only top-level messages are counted; embedded messages are part of the
+// message they are in.  Messages of classes with no GetPrototype() (those
+// not generated by protoc nor DynamicMessages) are not counted either.
+//
+// Each thread counts in its own table, without locking, so counting scales
+// with the number of threads; GetMessageStats() adds up the tables of all
+// threads.  Counts made while GetMessageStats() runs may or may not be in
+// what it returns.
+
+#ifndef GOOGLE_PROTOBUF_MESSAGE_STATS_H__
+#define GOOGLE_PROTOBUF_MESSAGE_STATS_H__
+
+#include <string>
+#include <vector>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+
+class MessageLite;    // message_lite.h
+
+// What was counted for one message type.
+struct LIBPROTOBUF_EXPORT MessageStats {
+  MessageStats();
+
+  // The type's full name and its default instance.  For a Message type, the
+  // Descriptor is down_cast<const Message*>(prototype)->GetDescriptor().
+  std::string type_name;
+  const MessageLite* prototype;
+
+  // Messages parsed (including merged) and serialized, how many of those
+  // failed, the bytes they read or wrote, and the time they took, in ticks
+  // of the CPU's cycle counter where there is one (rdtsc on x86), else in
+  // nanoseconds.
+  int64 parses;
+  int64 parse_failures;
+  int64 parse_bytes;
+  int64 parse_cycles;
+  int64 serializes;
+  int64 serialize_failures;
+  int64 serialize_bytes;
+  int64 serialize_cycles;
+};
+
+// Returns whether the library counts at all, i.e. was built with
+// GOOGLE_PROTOBUF_MESSAGE_STATS.
+LIBPROTOBUF_EXPORT bool MessageStatsEnabled();
+
+// Replaces *stats with what was counted since the program started or since
+// the last ResetMessageStats(), one MessageStats for each type counted, in
+// order of type_name.
+LIBPROTOBUF_EXPORT void GetMessageStats(std::vector<MessageStats>* stats);
+
+// Makes GetMessageStats() count from now on.
+LIBPROTOBUF_EXPORT void ResetMessageStats();
+
+namespace internal {
+
+// Used by MessageLite to count.  MessageStatsNow() returns the time in the
+// units of parse_cycles, and the others add to message's counts, with start
+// the MessageStatsNow() before parsing or serializing it.
+LIBPROTOBUF_EXPORT uint64 MessageStatsNow();
+LIBPROTOBUF_EXPORT void CountParse(const MessageLite& message, int bytes,
+                                   uint64 start, bool succeeded);
+LIBPROTOBUF_EXPORT void CountSerialize(const MessageLite& message, int bytes,
+                                       uint64 start, bool succeeded);
+
+}  // namespace internal
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_MESSAGE_STATS_H__
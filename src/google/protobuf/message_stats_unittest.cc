@@ -0,0 +1,235 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <string>
+#include <vector>
+#include <google/protobuf/message_stats.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/test_util.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/unittest_lite.pb.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+class MessageStatsTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    ResetMessageStats();
+  }
+
+  // Returns what GetMessageStats() has for the given type, all zeros if
+  // nothing.
+  MessageStats Get(const MessageLite& prototype) {
+    std::vector<MessageStats> stats;
+    GetMessageStats(&stats);
+    for (int i = 0; i < stats.size(); i++) {
+      if (stats[i].prototype == &prototype) {
+        EXPECT_EQ(prototype.GetTypeName(), stats[i].type_name);
+        return stats[i];
+      }
+    }
+    return MessageStats();
+  }
+};
+
+TEST_F(MessageStatsTest, CountsParsingAndSerializing) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  std::string data;
+  ASSERT_TRUE(message.SerializeToString(&data));
+
+  unittest::TestAllTypes parsed;
+  EXPECT_TRUE(parsed.ParseFromString(data));
+  EXPECT_FALSE(parsed.ParseFromString("\xff"));
+  {
+    io::ArrayInputStream input(data.data(), data.size());
+    EXPECT_TRUE(parsed.ParseFromZeroCopyStream(&input));
+  }
+
+  MessageStats stats = Get(unittest::TestAllTypes::default_instance());
+  if (!MessageStatsEnabled()) {
+    EXPECT_EQ(0, stats.parses);
+    EXPECT_EQ(0, stats.serializes);
+    return;
+  }
+  EXPECT_EQ(3, stats.parses);
+  EXPECT_EQ(1, stats.parse_failures);
+  EXPECT_EQ(2 * data.size() + 1, stats.parse_bytes);
+  EXPECT_LT(0, stats.parse_cycles);
+  EXPECT_EQ(1, stats.serializes);
+  EXPECT_EQ(0, stats.serialize_failures);
+  EXPECT_EQ(data.size(), stats.serialize_bytes);
+
+  // Embedded messages are part of the message they are in.
+  EXPECT_EQ(0,
+            Get(unittest::TestAllTypes::NestedMessage::default_instance())
+                .parses);
+}
+
+TEST_F(MessageStatsTest, CountsCodedStreams) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  std::string data;
+  {
+    io::StringOutputStream output(&data);
+    io::CodedOutputStream coded_output(&output);
+    coded_output.WriteVarint32(1234);  // Not part of the message.
+    EXPECT_TRUE(message.SerializeToCodedStream(&coded_output));
+  }
+
+  io::CodedInputStream input(reinterpret_cast<const uint8*>(data.data()),
+                             data.size());
+  uint32 tag;
+  input.ReadVarint32(&tag);
+  EXPECT_TRUE(message.ParseFromCodedStream(&input));
+
+  if (!MessageStatsEnabled()) return;
+  MessageStats stats = Get(unittest::TestAllTypes::default_instance());
+  EXPECT_EQ(1, stats.parses);
+  EXPECT_EQ(message.ByteSize(), stats.parse_bytes);
+  EXPECT_EQ(1, stats.serializes);
+  EXPECT_EQ(message.ByteSize(), stats.serialize_bytes);
+}
+
+TEST_F(MessageStatsTest, CountsSerializeToArrayFailure) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  char buffer[4];
+  EXPECT_FALSE(message.SerializeToArray(buffer, sizeof(buffer)));
+
+  if (!MessageStatsEnabled()) return;
+  MessageStats stats = Get(unittest::TestAllTypes::default_instance());
+  EXPECT_EQ(1, stats.serializes);
+  EXPECT_EQ(1, stats.serialize_failures);
+  EXPECT_EQ(0, stats.serialize_bytes);
+}
+
+TEST_F(MessageStatsTest, CountsLiteMessages) {
+  unittest::TestAllTypesLite message;
+  message.set_optional_int32(123);
+  std::string data = message.SerializeAsString();
+  EXPECT_TRUE(message.ParseFromString(data));
+
+  if (!MessageStatsEnabled()) return;
+  MessageStats stats = Get(unittest::TestAllTypesLite::default_instance());
+  EXPECT_EQ(1, stats.parses);
+  EXPECT_EQ(1, stats.serializes);
+  EXPECT_EQ(data.size(), stats.serialize_bytes);
+}
+
+TEST_F(MessageStatsTest, CountsDynamicMessagesPerType) {
+  DynamicMessageFactory factory;
+  const Message* prototype =
+      factory.GetPrototype(unittest::TestAllTypes::descriptor());
+  const Message* other_prototype =
+      factory.GetPrototype(unittest::TestEmptyMessage::descriptor());
+  scoped_ptr<Message> message(prototype->New());
+  scoped_ptr<Message> other(other_prototype->New());
+  EXPECT_TRUE(message->ParseFromString(""));
+  EXPECT_TRUE(other->ParseFromString(""));
+  EXPECT_TRUE(other->ParseFromString(""));
+
+  if (!MessageStatsEnabled()) return;
+  EXPECT_EQ(1, Get(*prototype).parses);
+  EXPECT_EQ(2, Get(*other_prototype).parses);
+  EXPECT_EQ(0, Get(unittest::TestAllTypes::default_instance()).parses);
+}
+
+TEST_F(MessageStatsTest, Reset) {
+  unittest::TestAllTypes message;
+  EXPECT_TRUE(message.ParseFromString(""));
+  ResetMessageStats();
+  EXPECT_EQ(0, Get(unittest::TestAllTypes::default_instance()).parses);
+  EXPECT_TRUE(message.ParseFromString(""));
+  if (!MessageStatsEnabled()) return;
+  EXPECT_EQ(1, Get(unittest::TestAllTypes::default_instance()).parses);
+}
+
+// Parses a TestAllTypes 1000 times.
+#ifdef _WIN32
+DWORD WINAPI ParseMessages(LPVOID data) {
+#else
+void* ParseMessages(void* data) {
+#endif
+  unittest::TestAllTypes message;
+  for (int i = 0; i < 1000; i++) {
+    message.ParseFromString(*reinterpret_cast<std::string*>(data));
+  }
+  return 0;
+}
+
+TEST_F(MessageStatsTest, AddsUpThreads) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  std::string data = message.SerializeAsString();
+
+  const int kThreads = 4;
+#ifdef _WIN32
+  HANDLE threads[kThreads];
+  for (int i = 0; i < kThreads; i++) {
+    threads[i] = CreateThread(NULL, 0, &ParseMessages, &data, 0, NULL);
+  }
+  for (int i = 0; i < kThreads; i++) {
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+  }
+#else
+  pthread_t threads[kThreads];
+  for (int i = 0; i < kThreads; i++) {
+    pthread_create(&threads[i], NULL, &ParseMessages, &data);
+  }
+  for (int i = 0; i < kThreads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+#endif
+
+  // The threads have exited, but their counts remain.
+  if (!MessageStatsEnabled()) return;
+  MessageStats stats = Get(unittest::TestAllTypes::default_instance());
+  EXPECT_EQ(kThreads * 1000, stats.parses);
+  EXPECT_EQ(kThreads * 1000 * data.size(), stats.parse_bytes);
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
@@ -47,10 +47,11 @@ void RepeatedPtrFieldBase::Reserve(int new_size) {
 
   void** old_elements = elements_;
   total_size_ = std::max(total_size_ * 2, new_size);
-  elements_ = new void*[total_size_];
+  elements_ = static_cast<void**>(Allocate(
+      total_size_ * sizeof(elements_[0]), ALLOCATION_REPEATED_PTR_FIELD));
   memcpy(elements_, old_elements, allocated_size_ * sizeof(elements_[0]));
   if (old_elements != initial_space_) {
-    delete [] old_elements;
+    Free(old_elements, ALLOCATION_REPEATED_PTR_FIELD);
   }
 }
 
@@ -85,7 +86,7 @@ void RepeatedPtrFieldBase::Swap(RepeatedPtrFieldBase* other) {
 }
 
 std::string* StringTypeHandlerBase::New() {
-  return new std::string;
+  return NewString();
 }
 void StringTypeHandlerBase::Delete(std::string* value) {
   delete value;
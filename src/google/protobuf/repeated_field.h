@@ -50,6 +50,7 @@
 #include <iterator>
 #include <algorithm>
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/allocator.h>
 #include <google/protobuf/message_lite.h>
 
 namespace google {
@@ -85,6 +86,9 @@ class RepeatedField {
   void Set(int index, const Element& value);
   void Add(const Element& value);
   Element* Add();
+  // Append the elements [begin, end) of an array, growing the field at
+  // most once.  The array must not be part of this field.
+  void Add(const Element* begin, const Element* end);
   // Remove the last element in the array.
   // We don't provide a way to remove any element other than the last
   // because it invites inefficient use, such as O(n^2) filtering loops
@@ -132,6 +136,9 @@ class RepeatedField {
   // sizeof(*this)
   int SpaceUsedExcludingSelf() const;
 
+  // Returns the part of SpaceUsedExcludingSelf() which holds no elements.
+  int SpaceUnusedExcludingSelf() const;
+
  private:
   static const int kInitialSize = 4;
 
@@ -229,6 +236,12 @@ class LIBPROTOBUF_EXPORT RepeatedPtrFieldBase {
 
   template <typename TypeHandler>
   int SpaceUsedExcludingSelf() const;
+  template <typename TypeHandler>
+  int SpaceUnusedExcludingSelf() const;
+  // The part of SpaceUsedExcludingSelf() which is not the elements in use:
+  // the array, and the objects cleared and kept for reuse.
+  template <typename TypeHandler>
+  int SpaceUsedExcludingElements() const;
 
 
   // Advanced memory management --------------------------------------
@@ -375,6 +388,11 @@ class RepeatedPtrField : public internal::RepeatedPtrFieldBase {
   // excluding sizeof(*this).
   int SpaceUsedExcludingSelf() const;
 
+  // Returns the part of SpaceUsedExcludingSelf() which holds no elements:
+  // the unused part of the array, and the objects which were cleared and
+  // are kept for reuse (see ClearedCount()).
+  int SpaceUnusedExcludingSelf() const;
+
   // Advanced memory management --------------------------------------
   // When hardcore memory management becomes necessary -- as it often
   // does here at Google -- the following methods may be useful.
@@ -437,7 +455,7 @@ inline RepeatedField<Element>::RepeatedField(const RepeatedField& other)
 template <typename Element>
 RepeatedField<Element>::~RepeatedField() {
   if (elements_ != initial_space_) {
-    delete [] elements_;
+    internal::Free(elements_, ALLOCATION_REPEATED_FIELD);
   }
 }
 
@@ -500,6 +518,16 @@ inline Element* RepeatedField<Element>::Add() {
   return &elements_[current_size_++];
 }
 
+template <typename Element>
+inline void RepeatedField<Element>::Add(const Element* begin,
+                                        const Element* end) {
+  int count = end - begin;
+  if (count <= 0) return;
+  Reserve(current_size_ + count);
+  CopyArray(elements_ + current_size_, begin, count);
+  current_size_ += count;
+}
+
 template <typename Element>
 inline void RepeatedField<Element>::RemoveLast() {
   GOOGLE_DCHECK_GT(current_size_, 0);
@@ -594,18 +622,25 @@ inline int RepeatedField<Element>::SpaceUsedExcludingSelf() const {
   return (elements_ != initial_space_) ? total_size_ * sizeof(elements_[0]) : 0;
 }
 
-// Avoid inlining of Reserve(): new, memcpy, and delete[] lead to a significant
-// amount of code bloat.
+template <typename Element>
+inline int RepeatedField<Element>::SpaceUnusedExcludingSelf() const {
+  return (elements_ != initial_space_) ?
+      (total_size_ - current_size_) * sizeof(elements_[0]) : 0;
+}
+
+// Avoid inlining of Reserve(): Allocate(), memcpy, and Free() lead to a
+// significant amount of code bloat.
 template <typename Element>
 void RepeatedField<Element>::Reserve(int new_size) {
   if (total_size_ >= new_size) return;
 
   Element* old_elements = elements_;
   total_size_ = std::max(total_size_ * 2, new_size);
-  elements_ = new Element[total_size_];
+  elements_ = static_cast<Element*>(internal::Allocate(
+      total_size_ * sizeof(Element), ALLOCATION_REPEATED_FIELD));
   MoveArray(elements_, old_elements, current_size_);
   if (old_elements != initial_space_) {
-    delete [] old_elements;
+    internal::Free(old_elements, ALLOCATION_REPEATED_FIELD);
   }
 }
 
@@ -644,7 +679,7 @@ void RepeatedPtrFieldBase::Destroy() {
     TypeHandler::Delete(cast<TypeHandler>(elements_[i]));
   }
   if (elements_ != initial_space_) {
-    delete [] elements_;
+    Free(elements_, ALLOCATION_REPEATED_PTR_FIELD);
   }
 }
 
@@ -748,6 +783,26 @@ inline int RepeatedPtrFieldBase::SpaceUsedExcludingSelf() const {
   return allocated_bytes;
 }
 
+template <typename TypeHandler>
+inline int RepeatedPtrFieldBase::SpaceUnusedExcludingSelf() const {
+  int unused_bytes = (elements_ != initial_space_) ?
+      (total_size_ - current_size_) * sizeof(elements_[0]) : 0;
+  for (int i = current_size_; i < allocated_size_; ++i) {
+    unused_bytes += TypeHandler::SpaceUsed(*cast<TypeHandler>(elements_[i]));
+  }
+  return unused_bytes;
+}
+
+template <typename TypeHandler>
+inline int RepeatedPtrFieldBase::SpaceUsedExcludingElements() const {
+  int allocated_bytes =
+      (elements_ != initial_space_) ? total_size_ * sizeof(elements_[0]) : 0;
+  for (int i = current_size_; i < allocated_size_; ++i) {
+    allocated_bytes += TypeHandler::SpaceUsed(*cast<TypeHandler>(elements_[i]));
+  }
+  return allocated_bytes;
+}
+
 template <typename TypeHandler>
 inline typename TypeHandler::Type* RepeatedPtrFieldBase::AddFromCleared() {
   if (current_size_ < allocated_size_) {
@@ -917,6 +972,12 @@ inline int RepeatedPtrField<Element>::SpaceUsedExcludingSelf() const {
   return internal::RepeatedPtrFieldBase::SpaceUsedExcludingSelf<TypeHandler>();
 }
 
+template <typename Element>
+inline int RepeatedPtrField<Element>::SpaceUnusedExcludingSelf() const {
+  return
+      internal::RepeatedPtrFieldBase::SpaceUnusedExcludingSelf<TypeHandler>();
+}
+
 template <typename Element>
 inline void RepeatedPtrField<Element>::AddAllocated(Element* value) {
   internal::RepeatedPtrFieldBase::AddAllocated<TypeHandler>(value);
@@ -232,6 +232,23 @@ TEST(RepeatedField, MergeFrom) {
   EXPECT_EQ(5, destination.Get(4));
 }
 
+TEST(RepeatedField, AddArray) {
+  RepeatedField<int> field;
+  field.Add(1);
+
+  int values[20];
+  for (int i = 0; i < 20; i++) values[i] = i + 2;
+  field.Add(values, values + 20);
+
+  ASSERT_EQ(21, field.size());
+  for (int i = 0; i < 21; i++) {
+    EXPECT_EQ(i + 1, field.Get(i));
+  }
+
+  field.Add(values, values);
+  EXPECT_EQ(21, field.size());
+}
+
 TEST(RepeatedField, CopyFrom) {
   RepeatedField<int> source, destination;
 
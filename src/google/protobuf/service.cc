@@ -34,6 +34,21 @@
 
 #include <google/protobuf/service.h>
 
+#include "config.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN  // We only need minimal includes
+#if !defined(_WIN32_WINNT) || _WIN32_WINNT < 0x0600
+#undef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600  // for condition variables
+#endif
+#include <windows.h>
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#else
+#error "No suitable threading library available."
+#endif
+
 namespace google {
 namespace protobuf {
 
@@ -41,6 +56,124 @@ Service::~Service() {}
 RpcChannel::~RpcChannel() {}
 RpcController::~RpcController() {}
 
+// ===================================================================
+
+// A thread blocked in RpcFutureBase::Wait().  It lives on that thread's
+// stack, so Run() must not touch it once it has woken the thread up.
+#ifdef _WIN32
+
+struct RpcFutureBase::Waiter {
+  CRITICAL_SECTION mutex;
+  CONDITION_VARIABLE condition;
+  bool woken;
+
+  Waiter() : woken(false) {
+    InitializeCriticalSection(&mutex);
+    InitializeConditionVariable(&condition);
+  }
+  ~Waiter() { DeleteCriticalSection(&mutex); }
+
+  void Wait() {
+    EnterCriticalSection(&mutex);
+    while (!woken) SleepConditionVariableCS(&condition, &mutex, INFINITE);
+    LeaveCriticalSection(&mutex);
+  }
+  void WakeUp() {
+    EnterCriticalSection(&mutex);
+    woken = true;
+    WakeConditionVariable(&condition);
+    LeaveCriticalSection(&mutex);
+  }
+};
+
+#else  // _WIN32
+
+struct RpcFutureBase::Waiter {
+  pthread_mutex_t mutex;
+  pthread_cond_t condition;
+  bool woken;
+
+  Waiter() : woken(false) {
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&condition, NULL);
+  }
+  ~Waiter() {
+    pthread_cond_destroy(&condition);
+    pthread_mutex_destroy(&mutex);
+  }
+
+  void Wait() {
+    pthread_mutex_lock(&mutex);
+    while (!woken) pthread_cond_wait(&condition, &mutex);
+    pthread_mutex_unlock(&mutex);
+  }
+  void WakeUp() {
+    pthread_mutex_lock(&mutex);
+    woken = true;
+    pthread_cond_signal(&condition);
+    pthread_mutex_unlock(&mutex);
+  }
+};
+
+#endif  // !_WIN32
+
+RpcFutureBase::RpcFutureBase()
+  : done_(false), callback_(NULL), waiter_(NULL) {}
+
+RpcFutureBase::~RpcFutureBase() {}
+
+bool RpcFutureBase::IsDone() {
+  MutexLock lock(&mutex_);
+  return done_;
+}
+
+void RpcFutureBase::Wait() {
+  if (IsDone()) return;
+  Waiter waiter;
+  {
+    MutexLock lock(&mutex_);
+    if (done_) return;
+    GOOGLE_DCHECK(waiter_ == NULL) << "Two threads waiting for one RpcFuture.";
+    waiter_ = &waiter;
+  }
+  waiter.Wait();
+}
+
+void RpcFutureBase::Then(Closure* callback) {
+  if (!SetCallbackUnlessDone(callback)) callback->Run();
+}
+
+bool RpcFutureBase::SetCallbackUnlessDone(Closure* callback) {
+  MutexLock lock(&mutex_);
+  if (done_) return false;
+  GOOGLE_DCHECK(callback_ == NULL) << "Then() called twice for one call.";
+  callback_ = callback;
+  return true;
+}
+
+void RpcFutureBase::Reset() {
+  // No call is in progress, so no other thread looks at the future.
+  done_ = false;
+  callback_ = NULL;
+  waiter_ = NULL;
+}
+
+void RpcFutureBase::Run() {
+  // Once done_ is set, the owner or the callback may destroy or reuse the
+  // future, so take what is needed from it first.
+  Closure* callback;
+  Waiter* waiter;
+  {
+    MutexLock lock(&mutex_);
+    GOOGLE_DCHECK(!done_) << "RpcFuture completed twice.";
+    done_ = true;
+    callback = callback_;
+    waiter = waiter_;
+  }
+  if (callback != NULL) callback->Run();
+  if (waiter != NULL) waiter->WakeUp();
+}
+
 }  // namespace protobuf
 
 }  // namespace google
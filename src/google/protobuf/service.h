@@ -103,6 +103,11 @@
 #include <string>
 #include <google/protobuf/stubs/common.h>
 
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#define GOOGLE_PROTOBUF_RPC_FUTURE_AWAITABLE 1
+#endif
+
 namespace google {
 namespace protobuf {
 
@@ -110,6 +115,8 @@ namespace protobuf {
 class Service;
 class RpcController;
 class RpcChannel;
+class RpcFutureBase;
+template <typename Response> class RpcFuture;
 
 // Defined in other files.
 class Descriptor;            // descriptor.h
@@ -285,6 +292,112 @@ class LIBPROTOBUF_EXPORT RpcChannel {
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(RpcChannel);
 };
 
+// The state of one call made through a stub generated with the
+// "future_stubs" option (protoc --cpp_out=future_stubs=true:DIR).  Such a
+// stub has, besides each usual method, one which takes an RpcFuture in
+// place of the response and "done" callback, and returns it:
+//   RpcFuture<MyResponse> future;
+//   stub.Foo(&controller, &request, &future).Wait();
+//   if (controller.Failed()) ...
+//   Use(future.response());
+// The future holds the response, and is itself the "done" callback handed
+// to the RpcChannel, so a call made this way allocates nothing.  The caller
+// owns the future, which must outlive the call; it may be reused for
+// another call once the last one is done.  A future is always completed by
+// the RpcChannel running it as a Closure, so it works with any channel.
+//
+// When compiled with C++20 coroutines, an RpcFuture can also be co_await'ed
+// from a coroutine, which is resumed on the thread that completes the call:
+//   MyResponse* response = co_await stub.Foo(&controller, &request, &future);
+class LIBPROTOBUF_EXPORT RpcFutureBase : public Closure {
+ public:
+  RpcFutureBase();
+  ~RpcFutureBase();
+
+  // Returns true once the call is done.
+  bool IsDone();
+
+  // Blocks until the call is done.  Only one thread may wait for a call.
+  // Does not wait for a callback given to Then():  that runs on the thread
+  // which completes the call, and may still be running when Wait() returns.
+  // A callback which must be waited for has to signal when it is finished.
+  void Wait();
+
+  // Runs callback once the call is done, on the thread that completes it,
+  // or right away if the call is already done.  At most one callback may be
+  // given per call.  The future does not take ownership of callback.  The
+  // call is done before callback runs, and the future is not touched after
+  // that, so callback may Reset() the future for another call, or destroy
+  // it (as a coroutine resumed by co_await may).
+  void Then(Closure* callback);
+
+  // Makes the future ready for another call.  Must not be called while a
+  // call is in progress.  Stubs call this before starting a call.
+  void Reset();
+
+  // implements Closure ---------------------------------------------
+  // Marks the call done.  Called by the RpcChannel, never by users.
+  void Run();
+
+ protected:
+  // Sets the callback to run once the call is done and returns true, unless
+  // the call is already done.
+  bool SetCallbackUnlessDone(Closure* callback);
+
+ private:
+  struct Waiter;  // defined in service.cc
+
+  Mutex mutex_;
+  bool done_;
+  Closure* callback_;  // run when done, if not NULL
+  Waiter* waiter_;     // woken when done, if not NULL
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(RpcFutureBase);
+};
+
+// An RpcFutureBase holding the response to the call.  Response is the
+// generated class of the method's output type.
+template <typename Response>
+class RpcFuture : public RpcFutureBase {
+ public:
+  RpcFuture() {}
+
+  const Response& response() const { return response_; }
+  Response* mutable_response() { return &response_; }
+
+  // Also clears the response.
+  void Reset() {
+    RpcFutureBase::Reset();
+    response_.Clear();
+  }
+
+#ifdef GOOGLE_PROTOBUF_RPC_FUTURE_AWAITABLE
+  // co_await'ing a future gives a pointer to the response.  The Awaiter
+  // lives in the coroutine's frame while it is suspended, and is the
+  // callback which resumes it.
+  class Awaiter : public Closure {
+   public:
+    explicit Awaiter(RpcFuture* future) : future_(future) {}
+    bool await_ready() { return future_->IsDone(); }
+    bool await_suspend(std::coroutine_handle<> coroutine) {
+      coroutine_ = coroutine;
+      return future_->SetCallbackUnlessDone(this);
+    }
+    Response* await_resume() { return &future_->response_; }
+    void Run() { coroutine_.resume(); }
+   private:
+    RpcFuture* future_;
+    std::coroutine_handle<> coroutine_;
+  };
+  Awaiter operator co_await() { return Awaiter(this); }
+#endif
+
+ private:
+  Response response_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(RpcFuture);
+};
+
 }  // namespace protobuf
 
 }  // namespace google
@@ -0,0 +1,200 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/space_used_breakdown.h>
+#include <algorithm>
+#include <utility>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/repeated_field.h>
+#include <google/protobuf/unknown_field_set.h>
+#include <google/protobuf/stubs/strutil.h>
+
+namespace google {
+namespace protobuf {
+
+namespace {
+
+typedef std::pair<std::string, SpaceUsedBreakdown::Usage> NamedUsage;
+
+bool ByDecreasingBytes(const NamedUsage& a, const NamedUsage& b) {
+  if (a.second.bytes != b.second.bytes) return a.second.bytes > b.second.bytes;
+  return a.first < b.first;
+}
+
+void AppendColumn(const std::string& value, int width, std::string* output) {
+  if (value.size() < width) output->append(width - value.size(), ' ');
+  output->append(value);
+}
+
+void AppendTable(const std::string& title,
+                 const SpaceUsedBreakdown::UsageMap& usages,
+                 std::string* output) {
+  std::vector<NamedUsage> sorted(usages.begin(), usages.end());
+  std::sort(sorted.begin(), sorted.end(), &ByDecreasingBytes);
+
+  AppendColumn("bytes", 14, output);
+  AppendColumn("slack", 14, output);
+  AppendColumn("count", 12, output);
+  output->append("  ");
+  output->append(title);
+  output->append("\n");
+  for (int i = 0; i < sorted.size(); i++) {
+    AppendColumn(SimpleItoa(sorted[i].second.bytes), 14, output);
+    AppendColumn(SimpleItoa(sorted[i].second.slack), 14, output);
+    AppendColumn(SimpleItoa(sorted[i].second.count), 12, output);
+    output->append("  ");
+    output->append(sorted[i].first);
+    output->append("\n");
+  }
+}
+
+}  // namespace
+
+SpaceUsedBreakdown::Usage::Usage()
+  : bytes(0),
+    slack(0),
+    count(0) {}
+
+SpaceUsedBreakdown::SpaceUsedBreakdown()
+  : type_(NULL),
+    path_(NULL),
+    absent_depth_(0) {}
+
+SpaceUsedBreakdown::~SpaceUsedBreakdown() {}
+
+void SpaceUsedBreakdown::Add(const Message& message) {
+  ++total_.count;
+  AddMessage(message, PathEntry(message.GetDescriptor()->full_name()), true);
+}
+
+void SpaceUsedBreakdown::Clear() {
+  total_ = Usage();
+  by_field_path_.clear();
+  by_type_.clear();
+}
+
+std::string SpaceUsedBreakdown::DebugString() const {
+  std::string output;
+  AppendTable("field path", by_field_path_, &output);
+  output.append("\n");
+  AppendTable("message type", by_type_, &output);
+  return output;
+}
+
+void SpaceUsedBreakdown::AddSelf(int bytes) {
+  Count(bytes, 0);
+}
+
+void SpaceUsedBreakdown::AddField(const FieldDescriptor* field, int bytes,
+                                  int slack, int values) {
+  if (bytes == 0) return;
+  Usage* usage = &PathEntry(FieldPath(field))->second;
+  usage->count += values;
+  paths_.push_back(usage);
+  Count(bytes, slack);
+  paths_.pop_back();
+}
+
+void SpaceUsedBreakdown::AddSubmessage(const FieldDescriptor* field,
+                                       const Message& message, bool present) {
+  AddMessage(message, PathEntry(FieldPath(field)), present);
+}
+
+void SpaceUsedBreakdown::AddUnknownFields(
+    const UnknownFieldSet& unknown_fields) {
+  int bytes = unknown_fields.SpaceUsedExcludingSelf();
+  if (bytes == 0) return;
+  Usage* usage = &PathEntry(*path_ + ".(unknown fields)")->second;
+  usage->count += unknown_fields.field_count();
+  paths_.push_back(usage);
+  Count(bytes, 0);
+  paths_.pop_back();
+}
+
+int SpaceUsedBreakdown::StringSlack(const std::string& value) {
+  int bytes = internal::StringSpaceUsedExcludingSelf(value);
+  return bytes == 0 ? 0 : bytes - static_cast<int>(value.size());
+}
+
+void SpaceUsedBreakdown::AddMessage(const Message& message,
+                                    UsageMap::value_type* path,
+                                    bool present) {
+  Usage* outer_type = type_;
+  const std::string* outer_path = path_;
+
+  type_ = &by_type_[message.GetDescriptor()->full_name()];
+  ++type_->count;
+  path_ = &path->first;
+  ++path->second.count;
+  paths_.push_back(&path->second);
+  if (!present) ++absent_depth_;
+
+  const Reflection* reflection = message.GetReflection();
+  if (!reflection->AddSpaceUsed(message, this)) {
+    AddSelf(reflection->SpaceUsed(message));
+  }
+
+  if (!present) --absent_depth_;
+  paths_.pop_back();
+  path_ = outer_path;
+  type_ = outer_type;
+}
+
+void SpaceUsedBreakdown::Count(int bytes, int slack) {
+  // Nothing in a message kept after its field was cleared holds data.
+  if (absent_depth_ > 0) slack = bytes;
+
+  type_->bytes += bytes;
+  type_->slack += slack;
+  for (int i = 0; i < paths_.size(); i++) {
+    paths_[i]->bytes += bytes;
+    paths_[i]->slack += slack;
+  }
+  total_.bytes += bytes;
+  total_.slack += slack;
+}
+
+SpaceUsedBreakdown::UsageMap::value_type* SpaceUsedBreakdown::PathEntry(
+    const std::string& path) {
+  return &*by_field_path_.insert(std::make_pair(path, Usage())).first;
+}
+
+std::string SpaceUsedBreakdown::FieldPath(
+    const FieldDescriptor* field) const {
+  if (field->is_extension()) {
+    return *path_ + ".[" + field->full_name() + "]";
+  } else {
+    return *path_ + "." + field->name();
+  }
+}
+
+}  // namespace protobuf
+}  // namespace google
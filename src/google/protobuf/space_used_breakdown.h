@@ -0,0 +1,155 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Breaks the memory of messages down the way SpaceUsed() counts it, by
+// field path and by message type, to find out which fields of which
+// messages take up a cache's memory:
+//   SpaceUsedBreakdown breakdown;
+//   for (int i = 0; i < cache.size(); i++) breakdown.Add(*cache[i]);
+//   std::cerr << breakdown.DebugString();
+//
+// By field path, usage is inclusive:  a path such as
+// "foo.Bar.baz.qux" (field qux of the messages in field baz of the foo.Bar
+// messages added) counts all the memory of those fields, including their
+// submessages, summed over the messages added and over the elements of
+// repeated fields.  A path of just the type name ("foo.Bar") counts all of
+// the messages added.  Extensions are written "[full.name]" and unknown
+// fields "(unknown fields)".
+//
+// By message type, usage is exclusive:  each message counts its own object,
+// the strings and arrays its fields own, and its unknown fields, but not its
+// submessages, which count as their own types.  Summed over the types, that
+// is the sum of SpaceUsed() of the messages added.
+//
+// Either way, slack is the part of the memory which holds no data and which
+// compacting the messages (e.g. copying them into fresh ones) would free:
+// unused capacity of strings and of repeated fields, elements which
+// repeated fields keep for reuse after being cleared, and strings and
+// submessages kept after their fields were cleared.
+
+#ifndef GOOGLE_PROTOBUF_SPACE_USED_BREAKDOWN_H__
+#define GOOGLE_PROTOBUF_SPACE_USED_BREAKDOWN_H__
+
+#include <map>
+#include <string>
+#include <vector>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+
+class Message;             // message.h
+class FieldDescriptor;     // descriptor.h
+class UnknownFieldSet;     // unknown_field_set.h
+
+class LIBPROTOBUF_EXPORT SpaceUsedBreakdown {
+ public:
+  // The memory of one field path or one message type.
+  struct LIBPROTOBUF_EXPORT Usage {
+    Usage();
+
+    int64 bytes;  // As SpaceUsed() counts them.
+    int64 slack;  // Of bytes, those which hold no data.
+    int64 count;  // Messages of the type, or values at the path, or for
+                  // total(), messages added.
+  };
+  typedef std::map<std::string, Usage> UsageMap;
+
+  SpaceUsedBreakdown();
+  ~SpaceUsedBreakdown();
+
+  // Adds the memory of message and of everything in it.
+  void Add(const Message& message);
+
+  // Forgets all the messages added.
+  void Clear();
+
+  // What was added, in all, by field path and by message type (full name).
+  // Fields which use no memory outside of their message object, such as
+  // numbers, have no path.
+  const Usage& total() const { return total_; }
+  const UsageMap& by_field_path() const { return by_field_path_; }
+  const UsageMap& by_type() const { return by_type_; }
+
+  // Returns a table of the field paths and then of the types, each in order
+  // of decreasing bytes.
+  std::string DebugString() const;
+
+  // For Reflection::AddSpaceUsed() ----------------------------------
+  // Implementations report the memory of the message being added with
+  // these:  the message object itself and any bookkeeping of its own, the
+  // memory each field owns outside of the object, not counting its
+  // submessages (values being the number of values in the field), each
+  // submessage the fields hold, and the unknown fields.  present is false
+  // for a submessage kept after its field was cleared, all of which is slack.
+
+  void AddSelf(int bytes);
+  void AddField(const FieldDescriptor* field, int bytes, int slack,
+                int values);
+  void AddSubmessage(const FieldDescriptor* field, const Message& message,
+                     bool present);
+  void AddUnknownFields(const UnknownFieldSet& unknown_fields);
+
+  // Returns how much of the memory which value owns, as
+  // StringSpaceUsedExcludingSelf() counts it, holds no characters.
+  static int StringSlack(const std::string& value);
+
+ private:
+  // Adds message, whose path is the key of path.
+  void AddMessage(const Message& message, UsageMap::value_type* path,
+                  bool present);
+
+  // Adds bytes to the message being added and to the paths it is in.
+  void Count(int bytes, int slack);
+
+  // Returns the entry of the given path, inserting it if needed, and the
+  // path of a field of the message being added.
+  UsageMap::value_type* PathEntry(const std::string& path);
+  std::string FieldPath(const FieldDescriptor* field) const;
+
+  Usage total_;
+  UsageMap by_field_path_;
+  UsageMap by_type_;
+
+  // While adding a message:  its type's usage, its path, the usage of that
+  // path and of the paths it is in, and how many of the messages it is in
+  // were kept after their fields were cleared.
+  Usage* type_;
+  const std::string* path_;
+  std::vector<Usage*> paths_;
+  int absent_depth_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(SpaceUsedBreakdown);
+};
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_SPACE_USED_BREAKDOWN_H__
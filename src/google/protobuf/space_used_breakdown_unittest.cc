@@ -0,0 +1,263 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <string>
+#include <google/protobuf/space_used_breakdown.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/test_util.h>
+#include <google/protobuf/unittest.pb.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+// Returns the sum of the usage by type, which should be the total.
+SpaceUsedBreakdown::Usage SumByType(const SpaceUsedBreakdown& breakdown) {
+  SpaceUsedBreakdown::Usage sum;
+  for (SpaceUsedBreakdown::UsageMap::const_iterator it =
+           breakdown.by_type().begin();
+       it != breakdown.by_type().end(); ++it) {
+    sum.bytes += it->second.bytes;
+    sum.slack += it->second.slack;
+  }
+  return sum;
+}
+
+// Returns the usage of the given path, all zeros if it has none.
+SpaceUsedBreakdown::Usage GetPath(const SpaceUsedBreakdown& breakdown,
+                                  const std::string& path) {
+  SpaceUsedBreakdown::UsageMap::const_iterator it =
+      breakdown.by_field_path().find(path);
+  if (it == breakdown.by_field_path().end()) {
+    return SpaceUsedBreakdown::Usage();
+  }
+  return it->second;
+}
+
+TEST(SpaceUsedBreakdownTest, AddsUpToSpaceUsed) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+
+  SpaceUsedBreakdown breakdown;
+  breakdown.Add(message);
+  EXPECT_EQ(message.SpaceUsed(), breakdown.total().bytes);
+  EXPECT_EQ(1, breakdown.total().count);
+  EXPECT_EQ(breakdown.total().bytes, SumByType(breakdown).bytes);
+  EXPECT_EQ(breakdown.total().slack, SumByType(breakdown).slack);
+  EXPECT_EQ(message.SpaceUsed(),
+            GetPath(breakdown, "protobuf_unittest.TestAllTypes").bytes);
+
+  // A second message adds to the same paths and types.
+  breakdown.Add(message);
+  EXPECT_EQ(2 * message.SpaceUsed(), breakdown.total().bytes);
+  EXPECT_EQ(2, breakdown.total().count);
+  EXPECT_EQ(2, breakdown.by_type()
+                   .find("protobuf_unittest.TestAllTypes")->second.count);
+
+  breakdown.Clear();
+  EXPECT_EQ(0, breakdown.total().bytes);
+  EXPECT_TRUE(breakdown.by_field_path().empty());
+  EXPECT_TRUE(breakdown.by_type().empty());
+}
+
+TEST(SpaceUsedBreakdownTest, FieldPaths) {
+  unittest::TestAllTypes message;
+  message.set_optional_int32(1);
+  message.set_optional_string(std::string(100, 'x'));
+  message.add_repeated_nested_message()->set_bb(1);
+  message.add_repeated_nested_message()->set_bb(2);
+  message.mutable_optional_foreign_message()->set_c(3);
+
+  SpaceUsedBreakdown breakdown;
+  breakdown.Add(message);
+
+  // Numbers are part of the message object.
+  EXPECT_EQ(0, breakdown.by_field_path().count(
+      "protobuf_unittest.TestAllTypes.optional_int32"));
+
+  SpaceUsedBreakdown::Usage string_usage =
+      GetPath(breakdown, "protobuf_unittest.TestAllTypes.optional_string");
+  EXPECT_EQ(sizeof(std::string) +
+                internal::StringSpaceUsedExcludingSelf(
+                    message.optional_string()),
+            string_usage.bytes);
+  EXPECT_EQ(1, string_usage.count);
+
+  // Paths of message fields include their submessages.
+  SpaceUsedBreakdown::Usage nested_usage = GetPath(
+      breakdown, "protobuf_unittest.TestAllTypes.repeated_nested_message");
+  EXPECT_EQ(message.repeated_nested_message().SpaceUsedExcludingSelf(),
+            nested_usage.bytes);
+  EXPECT_EQ(2, nested_usage.count);
+  SpaceUsedBreakdown::Usage foreign_usage = GetPath(
+      breakdown, "protobuf_unittest.TestAllTypes.optional_foreign_message");
+  EXPECT_EQ(message.optional_foreign_message().SpaceUsed(),
+            foreign_usage.bytes);
+  EXPECT_EQ(1, foreign_usage.count);
+
+  // Types do not.
+  const SpaceUsedBreakdown::UsageMap& by_type = breakdown.by_type();
+  EXPECT_EQ(2, by_type.find("protobuf_unittest.TestAllTypes.NestedMessage")
+                   ->second.count);
+  EXPECT_EQ(message.optional_foreign_message().SpaceUsed(),
+            by_type.find("protobuf_unittest.ForeignMessage")->second.bytes);
+  EXPECT_EQ(message.SpaceUsed() -
+                message.repeated_nested_message(0).SpaceUsed() -
+                message.repeated_nested_message(1).SpaceUsed() -
+                message.optional_foreign_message().SpaceUsed(),
+            by_type.find("protobuf_unittest.TestAllTypes")->second.bytes);
+}
+
+TEST(SpaceUsedBreakdownTest, Slack) {
+  unittest::TestAllTypes message;
+
+  // Unused capacity.
+  message.mutable_repeated_int32()->Reserve(100);
+  message.add_repeated_int32(1);
+  std::string* value = message.mutable_optional_string();
+  value->reserve(1000);
+  value->assign("x");
+
+  SpaceUsedBreakdown breakdown;
+  breakdown.Add(message);
+  SpaceUsedBreakdown::Usage int32_usage =
+      GetPath(breakdown, "protobuf_unittest.TestAllTypes.repeated_int32");
+  EXPECT_EQ(message.repeated_int32().SpaceUsedExcludingSelf(),
+            int32_usage.bytes);
+  EXPECT_EQ(int32_usage.bytes - sizeof(int32), int32_usage.slack);
+  EXPECT_EQ(1, int32_usage.count);
+  SpaceUsedBreakdown::Usage string_usage =
+      GetPath(breakdown, "protobuf_unittest.TestAllTypes.optional_string");
+  EXPECT_EQ(internal::StringSpaceUsedExcludingSelf(*value) - 1,
+            string_usage.slack);
+  EXPECT_EQ(int32_usage.slack + string_usage.slack, breakdown.total().slack);
+}
+
+TEST(SpaceUsedBreakdownTest, ClearedFieldsAreSlack) {
+  unittest::TestAllTypes message;
+  for (int i = 0; i < 3; i++) {
+    message.add_repeated_nested_message()->set_bb(i);
+    message.add_repeated_string("a string too long to be stored inline");
+  }
+  message.mutable_optional_nested_message()->set_bb(1);
+  message.set_optional_string("a string too long to be stored inline");
+  message.Clear();
+  ASSERT_EQ(3, message.repeated_nested_message().ClearedCount());
+
+  SpaceUsedBreakdown breakdown;
+  breakdown.Add(message);
+  EXPECT_EQ(message.SpaceUsed(), breakdown.total().bytes);
+
+  const char* kPaths[] = {
+    "protobuf_unittest.TestAllTypes.repeated_nested_message",
+    "protobuf_unittest.TestAllTypes.repeated_string",
+    "protobuf_unittest.TestAllTypes.optional_nested_message",
+    "protobuf_unittest.TestAllTypes.optional_string",
+  };
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(kPaths); i++) {
+    SCOPED_TRACE(kPaths[i]);
+    SpaceUsedBreakdown::Usage usage = GetPath(breakdown, kPaths[i]);
+    EXPECT_LT(0, usage.bytes);
+    EXPECT_EQ(usage.bytes, usage.slack);
+  }
+  const SpaceUsedBreakdown::Usage& nested = breakdown.by_type()
+      .find("protobuf_unittest.TestAllTypes.NestedMessage")->second;
+  EXPECT_EQ(nested.bytes, nested.slack);
+}
+
+TEST(SpaceUsedBreakdownTest, UnknownFields) {
+  unittest::TestEmptyMessage message;
+  unittest::TestAllTypes all_types;
+  TestUtil::SetAllFields(&all_types);
+  ASSERT_TRUE(message.ParseFromString(all_types.SerializeAsString()));
+
+  SpaceUsedBreakdown breakdown;
+  breakdown.Add(message);
+  EXPECT_EQ(message.SpaceUsed(), breakdown.total().bytes);
+  SpaceUsedBreakdown::Usage usage = GetPath(
+      breakdown, "protobuf_unittest.TestEmptyMessage.(unknown fields)");
+  EXPECT_EQ(message.unknown_fields().SpaceUsedExcludingSelf(), usage.bytes);
+  EXPECT_EQ(message.unknown_fields().field_count(), usage.count);
+}
+
+TEST(SpaceUsedBreakdownTest, Extensions) {
+  unittest::TestAllExtensions message;
+  TestUtil::SetAllExtensions(&message);
+
+  SpaceUsedBreakdown breakdown;
+  breakdown.Add(message);
+  EXPECT_EQ(message.SpaceUsed(), breakdown.total().bytes);
+  EXPECT_EQ(message.GetExtension(unittest::optional_nested_message_extension)
+                .SpaceUsed(),
+            GetPath(breakdown,
+                    "protobuf_unittest.TestAllExtensions."
+                    "[protobuf_unittest.optional_nested_message_extension]")
+                .bytes);
+  EXPECT_EQ(2, GetPath(breakdown,
+                       "protobuf_unittest.TestAllExtensions."
+                       "[protobuf_unittest.repeated_int32_extension]").count);
+}
+
+TEST(SpaceUsedBreakdownTest, DynamicMessages) {
+  DynamicMessageFactory factory;
+  const Descriptor* descriptor = unittest::TestAllTypes::descriptor();
+  scoped_ptr<Message> message(factory.GetPrototype(descriptor)->New());
+  TestUtil::ReflectionTester(descriptor).SetAllFieldsViaReflection(
+      message.get());
+
+  SpaceUsedBreakdown breakdown;
+  breakdown.Add(*message);
+  EXPECT_EQ(message->SpaceUsed(), breakdown.total().bytes);
+  EXPECT_EQ(breakdown.total().bytes, SumByType(breakdown).bytes);
+  EXPECT_EQ(2, GetPath(breakdown,
+                       "protobuf_unittest.TestAllTypes.repeated_nested_message")
+                   .count);
+}
+
+TEST(SpaceUsedBreakdownTest, DebugString) {
+  unittest::TestAllTypes message;
+  message.add_repeated_nested_message()->set_bb(1);
+
+  SpaceUsedBreakdown breakdown;
+  breakdown.Add(message);
+  std::string table = breakdown.DebugString();
+  EXPECT_NE(std::string::npos, table.find(
+      "  protobuf_unittest.TestAllTypes.repeated_nested_message\n"));
+  EXPECT_NE(std::string::npos, table.find(
+      "  protobuf_unittest.TestAllTypes.NestedMessage\n"));
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
@@ -239,6 +239,81 @@ namespace internal { FunctionClosure0::~FunctionClosure0() {} }
 
 void DoNothing() {}
 
+namespace internal {
+
+namespace {
+
+// Closures from NewPooledCallback() up to this size share one free list;
+// larger ones (binding large arguments by value) are allocated as usual.
+const size_t kPooledClosureSize = 64;
+
+// Most closures kept on one thread's free list.  Beyond that they are freed.
+const int kMaxPooledClosures = 256;
+
+struct FreeClosure {
+  FreeClosure* next;
+};
+
+GOOGLE_THREAD_LOCAL FreeClosure* free_closures_ = NULL;
+GOOGLE_THREAD_LOCAL int free_closure_count_ = 0;
+
+#if defined(HAVE_PTHREAD) && !defined(_WIN32)
+// Frees a thread's free list when it exits.  On Windows, the closures kept
+// by a thread which exits are leaked, which kMaxPooledClosures bounds.
+pthread_key_t free_closures_key_;
+GOOGLE_THREAD_LOCAL bool free_closures_key_set_ = false;
+GOOGLE_PROTOBUF_DECLARE_ONCE(free_closures_key_init_);
+
+void FreeThreadClosures(void*) {
+  while (free_closures_ != NULL) {
+    FreeClosure* closure = free_closures_;
+    free_closures_ = closure->next;
+    ::operator delete(closure);
+  }
+  free_closure_count_ = 0;
+}
+
+void InitFreeClosuresKey() {
+  pthread_key_create(&free_closures_key_, &FreeThreadClosures);
+}
+
+inline void FreeClosuresAtThreadExit() {
+  if (!free_closures_key_set_) {
+    GoogleOnceInit(&free_closures_key_init_, &InitFreeClosuresKey);
+    // Any non-NULL value makes pthreads call FreeThreadClosures().
+    pthread_setspecific(free_closures_key_, &free_closures_key_set_);
+    free_closures_key_set_ = true;
+  }
+}
+#else
+inline void FreeClosuresAtThreadExit() {}
+#endif
+
+}  // namespace
+
+void* AllocatePooledClosure(size_t size) {
+  if (size > kPooledClosureSize) return ::operator new(size);
+  FreeClosure* closure = free_closures_;
+  if (closure == NULL) return ::operator new(kPooledClosureSize);
+  free_closures_ = closure->next;
+  --free_closure_count_;
+  return closure;
+}
+
+void FreePooledClosure(void* closure, size_t size) {
+  if (size > kPooledClosureSize || free_closure_count_ >= kMaxPooledClosures) {
+    ::operator delete(closure);
+    return;
+  }
+  FreeClosuresAtThreadExit();
+  FreeClosure* free_closure = reinterpret_cast<FreeClosure*>(closure);
+  free_closure->next = free_closures_;
+  free_closures_ = free_closure;
+  ++free_closure_count_;
+}
+
+}  // namespace internal
+
 // ===================================================================
 // emulates google3/base/mutex.cc
 
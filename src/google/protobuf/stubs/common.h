@@ -221,6 +221,16 @@ static const uint64 kuint64max = GOOGLE_ULONGLONG(0xFFFFFFFFFFFFFFFF);
 #endif
 #endif
 
+#ifndef GOOGLE_THREAD_LOCAL
+// For variables of which each thread has its own copy.  Only for variables
+// of POD types with constant initializers, defined in .cc files.
+#ifdef _MSC_VER
+#define GOOGLE_THREAD_LOCAL __declspec(thread)
+#else
+#define GOOGLE_THREAD_LOCAL __thread
+#endif
+#endif
+
 #ifndef GOOGLE_PREDICT_TRUE
 #ifdef __GNUC__
 // Provided at least since GCC 3.0.
@@ -1062,6 +1072,259 @@ inline Closure* NewPermanentCallback(
     object, method, false, arg1, arg2);
 }
 
+// -------------------------------------------------------------------
+// Closures without a heap allocation per use.
+//
+// NewPooledCallback() works just like NewCallback(), but takes the closure's
+// memory from a free list kept by each thread, and gives it back there when
+// the closure has run, instead of calling malloc() and free().  Once a thread
+// has run as many closures as it creates, it allocates none:
+//   service->Foo(controller, request, response,
+//                NewPooledCallback(this, &Handler::FooDone, response));
+// A closure may be run on a different thread than the one that created it;
+// the memory then moves to the running thread's free list.
+//
+// The Callback classes below are Closures meant to be kept in storage the
+// caller owns, e.g. as members of the object tracking a call.  Bind() sets
+// what they call, and may be called again to reuse them; Run() calls it and,
+// unlike closures from NewCallback(), never deletes the closure:
+//   class Handler {
+//    public:
+//     void CallFoo() {
+//       done_.Bind(this, &Handler::FooDone, &response_);
+//       service->Foo(&controller_, &request_, &response_, &done_);
+//     }
+//    private:
+//     MethodCallback1<Handler, FooResponse*> done_;
+//     ...
+//   };
+// They must not be Bind()'d again while a call they were given to is in
+// progress, and are not thread-safe otherwise either.
+
+namespace internal {
+
+// Allocate and free the memory of closures from NewPooledCallback().
+LIBPROTOBUF_EXPORT void* AllocatePooledClosure(size_t size);
+LIBPROTOBUF_EXPORT void FreePooledClosure(void* closure, size_t size);
+
+// ClosureType, with its memory from the calling thread's free list.
+// ClosureType must be self-deleting; its "delete this" frees the closure
+// through the operator delete below, since ~Closure() is virtual.
+template <typename ClosureType>
+class PooledClosure : public ClosureType {
+ public:
+  template <typename A, typename B>
+  PooledClosure(A a, B b) : ClosureType(a, b) {}
+  template <typename A, typename B, typename C>
+  PooledClosure(A a, B b, C c) : ClosureType(a, b, c) {}
+  template <typename A, typename B, typename C, typename D>
+  PooledClosure(A a, B b, C c, D d) : ClosureType(a, b, c, d) {}
+  template <typename A, typename B, typename C, typename D, typename E>
+  PooledClosure(A a, B b, C c, D d, E e) : ClosureType(a, b, c, d, e) {}
+
+  static void* operator new(size_t size) {
+    return AllocatePooledClosure(size);
+  }
+  static void operator delete(void* closure, size_t size) {
+    FreePooledClosure(closure, size);
+  }
+};
+
+}  // namespace internal
+
+// See above.
+inline Closure* NewPooledCallback(void (*function)()) {
+  return new internal::PooledClosure<internal::FunctionClosure0>(
+    function, true);
+}
+
+// See above.
+template <typename Class>
+inline Closure* NewPooledCallback(Class* object, void (Class::*method)()) {
+  return new internal::PooledClosure<internal::MethodClosure0<Class> >(
+    object, method, true);
+}
+
+// See above.
+template <typename Arg1>
+inline Closure* NewPooledCallback(void (*function)(Arg1),
+                                  Arg1 arg1) {
+  return new internal::PooledClosure<internal::FunctionClosure1<Arg1> >(
+    function, true, arg1);
+}
+
+// See above.
+template <typename Class, typename Arg1>
+inline Closure* NewPooledCallback(Class* object, void (Class::*method)(Arg1),
+                                  Arg1 arg1) {
+  return new internal::PooledClosure<internal::MethodClosure1<Class, Arg1> >(
+    object, method, true, arg1);
+}
+
+// See above.
+template <typename Arg1, typename Arg2>
+inline Closure* NewPooledCallback(void (*function)(Arg1, Arg2),
+                                  Arg1 arg1, Arg2 arg2) {
+  return new internal::PooledClosure<
+      internal::FunctionClosure2<Arg1, Arg2> >(function, true, arg1, arg2);
+}
+
+// See above.
+template <typename Class, typename Arg1, typename Arg2>
+inline Closure* NewPooledCallback(Class* object,
+                                  void (Class::*method)(Arg1, Arg2),
+                                  Arg1 arg1, Arg2 arg2) {
+  return new internal::PooledClosure<
+      internal::MethodClosure2<Class, Arg1, Arg2> >(
+    object, method, true, arg1, arg2);
+}
+
+// See above.
+class FunctionCallback : public Closure {
+ public:
+  typedef void (*FunctionType)();
+
+  FunctionCallback() : function_(NULL) {}
+  explicit FunctionCallback(FunctionType function) : function_(function) {}
+
+  void Bind(FunctionType function) { function_ = function; }
+
+  void Run() { function_(); }
+
+ private:
+  FunctionType function_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(FunctionCallback);
+};
+
+// See above.
+template <typename Class>
+class MethodCallback : public Closure {
+ public:
+  typedef void (Class::*MethodType)();
+
+  MethodCallback() : object_(NULL), method_(NULL) {}
+  MethodCallback(Class* object, MethodType method)
+    : object_(object), method_(method) {}
+
+  void Bind(Class* object, MethodType method) {
+    object_ = object;
+    method_ = method;
+  }
+
+  void Run() { (object_->*method_)(); }
+
+ private:
+  Class* object_;
+  MethodType method_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MethodCallback);
+};
+
+// See above.
+template <typename Arg1>
+class FunctionCallback1 : public Closure {
+ public:
+  typedef void (*FunctionType)(Arg1 arg1);
+
+  FunctionCallback1() : function_(NULL), arg1_() {}
+  FunctionCallback1(FunctionType function, Arg1 arg1)
+    : function_(function), arg1_(arg1) {}
+
+  void Bind(FunctionType function, Arg1 arg1) {
+    function_ = function;
+    arg1_ = arg1;
+  }
+
+  void Run() { function_(arg1_); }
+
+ private:
+  FunctionType function_;
+  Arg1 arg1_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(FunctionCallback1);
+};
+
+// See above.
+template <typename Class, typename Arg1>
+class MethodCallback1 : public Closure {
+ public:
+  typedef void (Class::*MethodType)(Arg1 arg1);
+
+  MethodCallback1() : object_(NULL), method_(NULL), arg1_() {}
+  MethodCallback1(Class* object, MethodType method, Arg1 arg1)
+    : object_(object), method_(method), arg1_(arg1) {}
+
+  void Bind(Class* object, MethodType method, Arg1 arg1) {
+    object_ = object;
+    method_ = method;
+    arg1_ = arg1;
+  }
+
+  void Run() { (object_->*method_)(arg1_); }
+
+ private:
+  Class* object_;
+  MethodType method_;
+  Arg1 arg1_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MethodCallback1);
+};
+
+// See above.
+template <typename Arg1, typename Arg2>
+class FunctionCallback2 : public Closure {
+ public:
+  typedef void (*FunctionType)(Arg1 arg1, Arg2 arg2);
+
+  FunctionCallback2() : function_(NULL), arg1_(), arg2_() {}
+  FunctionCallback2(FunctionType function, Arg1 arg1, Arg2 arg2)
+    : function_(function), arg1_(arg1), arg2_(arg2) {}
+
+  void Bind(FunctionType function, Arg1 arg1, Arg2 arg2) {
+    function_ = function;
+    arg1_ = arg1;
+    arg2_ = arg2;
+  }
+
+  void Run() { function_(arg1_, arg2_); }
+
+ private:
+  FunctionType function_;
+  Arg1 arg1_;
+  Arg2 arg2_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(FunctionCallback2);
+};
+
+// See above.
+template <typename Class, typename Arg1, typename Arg2>
+class MethodCallback2 : public Closure {
+ public:
+  typedef void (Class::*MethodType)(Arg1 arg1, Arg2 arg2);
+
+  MethodCallback2() : object_(NULL), method_(NULL), arg1_(), arg2_() {}
+  MethodCallback2(Class* object, MethodType method, Arg1 arg1, Arg2 arg2)
+    : object_(object), method_(method), arg1_(arg1), arg2_(arg2) {}
+
+  void Bind(Class* object, MethodType method, Arg1 arg1, Arg2 arg2) {
+    object_ = object;
+    method_ = method;
+    arg1_ = arg1;
+    arg2_ = arg2;
+  }
+
+  void Run() { (object_->*method_)(arg1_, arg2_); }
+
+ private:
+  Class* object_;
+  MethodType method_;
+  Arg1 arg1_;
+  Arg2 arg2_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MethodCallback2);
+};
+
 // A function which does nothing.  Useful for creating no-op callbacks, e.g.:
 //   Closure* nothing = NewCallback(&DoNothing);
 void LIBPROTOBUF_EXPORT DoNothing();
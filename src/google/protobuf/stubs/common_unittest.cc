@@ -160,6 +160,11 @@ TEST(LoggingTest, SilenceLogging) {
     captured_messages_[1]);
 }
 
+// Too big for the free list kept for NewPooledCallback().
+struct LargeArgument {
+  char bytes[256];
+};
+
 class ClosureTest : public testing::Test {
  public:
   void SetA123Method()   { a_ = 123; }
@@ -171,6 +176,10 @@ class ClosureTest : public testing::Test {
   static void SetAFunction(int a)         { current_instance_->a_ = a; }
   static void SetCFunction(std::string c)      { current_instance_->c_ = c; }
 
+  static void SetCLargeFunction(LargeArgument c) {
+    current_instance_->c_.assign(c.bytes, 1);
+  }
+
   void SetABMethod(int a, const char* b)  { a_ = a; b_ = b; }
   static void SetABFunction(int a, const char* b) {
     current_instance_->a_ = a;
@@ -352,6 +361,104 @@ TEST_F(ClosureTest, TestPermanentClosureDeleteInCallback) {
   permanent_closure_->Run();
 }
 
+// Repeat the basic ones with NewPooledCallback()
+
+TEST_F(ClosureTest, TestPooledClosureFunction0) {
+  Closure* closure = NewPooledCallback(&SetA123Function);
+  EXPECT_NE(123, a_);
+  closure->Run();
+  EXPECT_EQ(123, a_);
+}
+
+TEST_F(ClosureTest, TestPooledClosureMethod0) {
+  Closure* closure = NewPooledCallback(current_instance_,
+                                       &ClosureTest::SetA123Method);
+  EXPECT_NE(123, a_);
+  closure->Run();
+  EXPECT_EQ(123, a_);
+}
+
+TEST_F(ClosureTest, TestPooledClosureFunction1String) {
+  Closure* closure = NewPooledCallback(&SetCFunction, std::string("test"));
+  EXPECT_NE("test", c_);
+  closure->Run();
+  EXPECT_EQ("test", c_);
+}
+
+TEST_F(ClosureTest, TestPooledClosureMethod1) {
+  Closure* closure = NewPooledCallback(current_instance_,
+                                       &ClosureTest::SetAMethod, 456);
+  EXPECT_NE(456, a_);
+  closure->Run();
+  EXPECT_EQ(456, a_);
+}
+
+TEST_F(ClosureTest, TestPooledClosureFunction2) {
+  const char* cstr = "hello";
+  Closure* closure = NewPooledCallback(&SetABFunction, 789, cstr);
+  closure->Run();
+  EXPECT_EQ(789, a_);
+  EXPECT_EQ(cstr, b_);
+}
+
+TEST_F(ClosureTest, TestPooledClosureMethod2) {
+  const char* cstr = "hello";
+  Closure* closure = NewPooledCallback(current_instance_,
+                                       &ClosureTest::SetABMethod, 789, cstr);
+  closure->Run();
+  EXPECT_EQ(789, a_);
+  EXPECT_EQ(cstr, b_);
+}
+
+TEST_F(ClosureTest, TestPooledClosureReusesMemory) {
+  Closure* closure = NewPooledCallback(current_instance_,
+                                       &ClosureTest::SetAMethod, 1);
+  void* memory = closure;
+  closure->Run();
+  closure = NewPooledCallback(current_instance_, &ClosureTest::SetAMethod, 2);
+  EXPECT_EQ(memory, closure);
+  closure->Run();
+  EXPECT_EQ(2, a_);
+}
+
+TEST_F(ClosureTest, TestPooledClosureLargeArgument) {
+  LargeArgument large;
+  large.bytes[0] = 'x';
+  Closure* closure = NewPooledCallback(&SetCLargeFunction, large);
+  closure->Run();
+  EXPECT_EQ("x", c_);
+}
+
+TEST_F(ClosureTest, TestFunctionCallback) {
+  FunctionCallback1<int> callback;
+  callback.Bind(&SetAFunction, 456);
+  callback.Run();
+  EXPECT_EQ(456, a_);
+  callback.Run();
+  callback.Bind(&SetAFunction, 789);
+  callback.Run();
+  EXPECT_EQ(789, a_);
+
+  FunctionCallback2<int, const char*> callback2(&SetABFunction, 1, "hello");
+  callback2.Run();
+  EXPECT_EQ(1, a_);
+  EXPECT_STREQ("hello", b_);
+}
+
+TEST_F(ClosureTest, TestMethodCallback) {
+  MethodCallback<ClosureTest> callback(this, &ClosureTest::SetA123Method);
+  Closure* closure = &callback;
+  closure->Run();
+  EXPECT_EQ(123, a_);
+
+  MethodCallback2<ClosureTest, int, const char*> callback2;
+  for (int i = 0; i < 3; i++) {
+    callback2.Bind(this, &ClosureTest::SetABMethod, i, "hello");
+    callback2.Run();
+    EXPECT_EQ(i, a_);
+  }
+}
+
 }  // anonymous namespace
 }  // namespace protobuf
 }  // namespace google
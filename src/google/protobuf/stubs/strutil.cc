@@ -33,6 +33,7 @@
 #include <google/protobuf/stubs/strutil.h>
 #include <errno.h>
 #include <float.h>    // FLT_DIG and DBL_DIG
+#include <math.h>
 #include <limits>
 #include <limits.h>
 #include <stdio.h>
@@ -943,30 +944,21 @@ std::string SimpleItoa(unsigned long long i) {
 //    It turns out there is no precision value that does the right thing
 //    for all numbers.
 //
-//    Our strategy is to first try printing with a precision that is never
-//    over-precise, then parse the result with strtod() to see if it
-//    matches.  If not, we print again with a precision that will always
-//    give a precise result, but may use more digits than necessary.
+//    We used to print with a precision that is never over-precise, parse
+//    the result with strtod() to see if it matched, and print again with
+//    more precision if not.  That costs two or three trips through the C
+//    library per value, which dominated TextFormat output of messages
+//    full of doubles.
 //
-//    An arguably better strategy would be to use the algorithm described
-//    in "How to Print Floating-Point Numbers Accurately" by Steele &
-//    White, e.g. as implemented by David M. Gay's dtoa().  It turns out,
-//    however, that the following implementation is about as fast as
-//    DMG's code.  Furthermore, DMG's code locks mutexes, which means it
-//    will not scale well on multi-core machines.  DMG's code is slightly
-//    more accurate (in that it will never use more digits than
-//    necessary), but this is probably irrelevant for most users.
-//
-//    Rob Pike and Ken Thompson also have an implementation of dtoa() in
-//    third_party/fmt/fltfmt.cc.  Their implementation is similar to this
-//    one in that it makes guesses and then uses strtod() to check them.
-//    Their implementation is faster because they use their own code to
-//    generate the digits in the first place rather than use snprintf(),
-//    thus avoiding format string parsing overhead.  However, this makes
-//    it considerably more complicated than the following implementation,
-//    and it is embedded in a larger library.  If speed turns out to be
-//    an issue, we could re-implement this in terms of their
-//    implementation.
+//    Now the digits come from Florian Loitsch's Grisu3 algorithm
+//    ("Printing Floating-Point Numbers Quickly and Accurately with
+//    Integers", PLDI 2010), which finds the shortest digit string that
+//    reads back as the same value using a few 64-bit multiplications.
+//    For about 0.5% of values it cannot prove that its answer is the
+//    shortest correctly rounded one and says so; for those we fall back
+//    on the snprintf()/strtod() search.  Either way the digits are then
+//    laid out the way "%g" would lay them out, so output only differs
+//    from the old code where it used more digits than necessary.
 // ----------------------------------------------------------------------
 
 std::string SimpleDtoa(double value) {
@@ -1012,6 +1004,440 @@ void DelocalizeRadix(char* buffer) {
   }
 }
 
+bool safe_strtof(const char* str, float* value) {
+  char* endptr;
+  errno = 0;  // errno only gets set on errors
+#if defined(_WIN32) || defined (__hpux)  // has no strtof()
+  *value = strtod(str, &endptr);
+#else
+  *value = strtof(str, &endptr);
+#endif
+  return *str != 0 && *endptr == 0 && errno == 0;
+}
+
+namespace {
+
+// A floating-point number f * 2^e with a 64-bit significand.  Grisu does
+// all of its work on these.
+struct DiyFp {
+  uint64 f;
+  int e;
+};
+
+inline DiyFp MakeDiyFp(uint64 f, int e) {
+  DiyFp result = { f, e };
+  return result;
+}
+
+// Returns x * y, rounding the 128-bit product of the significands to its
+// upper 64 bits.
+DiyFp Multiply(const DiyFp& x, const DiyFp& y) {
+  const uint64 kMask32 = 0xFFFFFFFFu;
+  uint64 a = x.f >> 32;
+  uint64 b = x.f & kMask32;
+  uint64 c = y.f >> 32;
+  uint64 d = y.f & kMask32;
+  uint64 ac = a * c;
+  uint64 bc = b * c;
+  uint64 ad = a * d;
+  uint64 bd = b * d;
+  uint64 middle = (bd >> 32) + (ad & kMask32) + (bc & kMask32);
+  middle += 1u << 31;  // Round.
+  return MakeDiyFp(ac + (ad >> 32) + (bc >> 32) + (middle >> 32),
+                   x.e + y.e + 64);
+}
+
+// Shifts x left until the top bit of the significand is set.
+DiyFp Normalize(DiyFp x) {
+  while ((x.f & GOOGLE_ULONGLONG(0xFFC0000000000000)) == 0) {
+    x.f <<= 10;
+    x.e -= 10;
+  }
+  while ((x.f & GOOGLE_ULONGLONG(0x8000000000000000)) == 0) {
+    x.f <<= 1;
+    x.e -= 1;
+  }
+  return x;
+}
+
+// Given the fields of a positive, finite IEEE-754 value (of either
+// precision), sets *w to the value and *minus and *plus to the points
+// halfway to its neighbours, all with the same exponent.  Everything
+// strictly between *minus and *plus reads back as the value.
+void Decompose(uint64 fraction, int biased_exponent,
+               int fraction_bits, int exponent_bias,
+               DiyFp* w, DiyFp* minus, DiyFp* plus) {
+  DiyFp value;
+  if (biased_exponent == 0) {
+    // Denormal.
+    value = MakeDiyFp(fraction, 1 - exponent_bias - fraction_bits);
+  } else {
+    value = MakeDiyFp(fraction + (GOOGLE_ULONGLONG(1) << fraction_bits),
+                      biased_exponent - exponent_bias - fraction_bits);
+  }
+
+  *plus = Normalize(MakeDiyFp((value.f << 1) + 1, value.e - 1));
+  if (fraction == 0 && biased_exponent > 1) {
+    // At a power of two the next value down is only half as far away.
+    *minus = MakeDiyFp((value.f << 2) - 1, value.e - 2);
+  } else {
+    *minus = MakeDiyFp((value.f << 1) - 1, value.e - 1);
+  }
+  minus->f <<= minus->e - plus->e;
+  minus->e = plus->e;
+  *w = Normalize(value);
+}
+
+// Normalized powers of ten, 10^decimal_exponent ~= significand *
+// 2^binary_exponent, rounded to nearest, for every eighth decimal exponent
+// from -348 to 340.
+struct CachedPower {
+  uint64 significand;
+  int16 binary_exponent;
+  int16 decimal_exponent;
+};
+
+const CachedPower kCachedPowers[] = {
+  { GOOGLE_ULONGLONG(0xfa8fd5a0081c0288), -1220, -348 },
+  { GOOGLE_ULONGLONG(0xbaaee17fa23ebf76), -1193, -340 },
+  { GOOGLE_ULONGLONG(0x8b16fb203055ac76), -1166, -332 },
+  { GOOGLE_ULONGLONG(0xcf42894a5dce35ea), -1140, -324 },
+  { GOOGLE_ULONGLONG(0x9a6bb0aa55653b2d), -1113, -316 },
+  { GOOGLE_ULONGLONG(0xe61acf033d1a45df), -1087, -308 },
+  { GOOGLE_ULONGLONG(0xab70fe17c79ac6ca), -1060, -300 },
+  { GOOGLE_ULONGLONG(0xff77b1fcbebcdc4f), -1034, -292 },
+  { GOOGLE_ULONGLONG(0xbe5691ef416bd60c), -1007, -284 },
+  { GOOGLE_ULONGLONG(0x8dd01fad907ffc3c),  -980, -276 },
+  { GOOGLE_ULONGLONG(0xd3515c2831559a83),  -954, -268 },
+  { GOOGLE_ULONGLONG(0x9d71ac8fada6c9b5),  -927, -260 },
+  { GOOGLE_ULONGLONG(0xea9c227723ee8bcb),  -901, -252 },
+  { GOOGLE_ULONGLONG(0xaecc49914078536d),  -874, -244 },
+  { GOOGLE_ULONGLONG(0x823c12795db6ce57),  -847, -236 },
+  { GOOGLE_ULONGLONG(0xc21094364dfb5637),  -821, -228 },
+  { GOOGLE_ULONGLONG(0x9096ea6f3848984f),  -794, -220 },
+  { GOOGLE_ULONGLONG(0xd77485cb25823ac7),  -768, -212 },
+  { GOOGLE_ULONGLONG(0xa086cfcd97bf97f4),  -741, -204 },
+  { GOOGLE_ULONGLONG(0xef340a98172aace5),  -715, -196 },
+  { GOOGLE_ULONGLONG(0xb23867fb2a35b28e),  -688, -188 },
+  { GOOGLE_ULONGLONG(0x84c8d4dfd2c63f3b),  -661, -180 },
+  { GOOGLE_ULONGLONG(0xc5dd44271ad3cdba),  -635, -172 },
+  { GOOGLE_ULONGLONG(0x936b9fcebb25c996),  -608, -164 },
+  { GOOGLE_ULONGLONG(0xdbac6c247d62a584),  -582, -156 },
+  { GOOGLE_ULONGLONG(0xa3ab66580d5fdaf6),  -555, -148 },
+  { GOOGLE_ULONGLONG(0xf3e2f893dec3f126),  -529, -140 },
+  { GOOGLE_ULONGLONG(0xb5b5ada8aaff80b8),  -502, -132 },
+  { GOOGLE_ULONGLONG(0x87625f056c7c4a8b),  -475, -124 },
+  { GOOGLE_ULONGLONG(0xc9bcff6034c13053),  -449, -116 },
+  { GOOGLE_ULONGLONG(0x964e858c91ba2655),  -422, -108 },
+  { GOOGLE_ULONGLONG(0xdff9772470297ebd),  -396, -100 },
+  { GOOGLE_ULONGLONG(0xa6dfbd9fb8e5b88f),  -369,  -92 },
+  { GOOGLE_ULONGLONG(0xf8a95fcf88747d94),  -343,  -84 },
+  { GOOGLE_ULONGLONG(0xb94470938fa89bcf),  -316,  -76 },
+  { GOOGLE_ULONGLONG(0x8a08f0f8bf0f156b),  -289,  -68 },
+  { GOOGLE_ULONGLONG(0xcdb02555653131b6),  -263,  -60 },
+  { GOOGLE_ULONGLONG(0x993fe2c6d07b7fac),  -236,  -52 },
+  { GOOGLE_ULONGLONG(0xe45c10c42a2b3b06),  -210,  -44 },
+  { GOOGLE_ULONGLONG(0xaa242499697392d3),  -183,  -36 },
+  { GOOGLE_ULONGLONG(0xfd87b5f28300ca0e),  -157,  -28 },
+  { GOOGLE_ULONGLONG(0xbce5086492111aeb),  -130,  -20 },
+  { GOOGLE_ULONGLONG(0x8cbccc096f5088cc),  -103,  -12 },
+  { GOOGLE_ULONGLONG(0xd1b71758e219652c),   -77,   -4 },
+  { GOOGLE_ULONGLONG(0x9c40000000000000),   -50,    4 },
+  { GOOGLE_ULONGLONG(0xe8d4a51000000000),   -24,   12 },
+  { GOOGLE_ULONGLONG(0xad78ebc5ac620000),     3,   20 },
+  { GOOGLE_ULONGLONG(0x813f3978f8940984),    30,   28 },
+  { GOOGLE_ULONGLONG(0xc097ce7bc90715b3),    56,   36 },
+  { GOOGLE_ULONGLONG(0x8f7e32ce7bea5c70),    83,   44 },
+  { GOOGLE_ULONGLONG(0xd5d238a4abe98068),   109,   52 },
+  { GOOGLE_ULONGLONG(0x9f4f2726179a2245),   136,   60 },
+  { GOOGLE_ULONGLONG(0xed63a231d4c4fb27),   162,   68 },
+  { GOOGLE_ULONGLONG(0xb0de65388cc8ada8),   189,   76 },
+  { GOOGLE_ULONGLONG(0x83c7088e1aab65db),   216,   84 },
+  { GOOGLE_ULONGLONG(0xc45d1df942711d9a),   242,   92 },
+  { GOOGLE_ULONGLONG(0x924d692ca61be758),   269,  100 },
+  { GOOGLE_ULONGLONG(0xda01ee641a708dea),   295,  108 },
+  { GOOGLE_ULONGLONG(0xa26da3999aef774a),   322,  116 },
+  { GOOGLE_ULONGLONG(0xf209787bb47d6b85),   348,  124 },
+  { GOOGLE_ULONGLONG(0xb454e4a179dd1877),   375,  132 },
+  { GOOGLE_ULONGLONG(0x865b86925b9bc5c2),   402,  140 },
+  { GOOGLE_ULONGLONG(0xc83553c5c8965d3d),   428,  148 },
+  { GOOGLE_ULONGLONG(0x952ab45cfa97a0b3),   455,  156 },
+  { GOOGLE_ULONGLONG(0xde469fbd99a05fe3),   481,  164 },
+  { GOOGLE_ULONGLONG(0xa59bc234db398c25),   508,  172 },
+  { GOOGLE_ULONGLONG(0xf6c69a72a3989f5c),   534,  180 },
+  { GOOGLE_ULONGLONG(0xb7dcbf5354e9bece),   561,  188 },
+  { GOOGLE_ULONGLONG(0x88fcf317f22241e2),   588,  196 },
+  { GOOGLE_ULONGLONG(0xcc20ce9bd35c78a5),   614,  204 },
+  { GOOGLE_ULONGLONG(0x98165af37b2153df),   641,  212 },
+  { GOOGLE_ULONGLONG(0xe2a0b5dc971f303a),   667,  220 },
+  { GOOGLE_ULONGLONG(0xa8d9d1535ce3b396),   694,  228 },
+  { GOOGLE_ULONGLONG(0xfb9b7cd9a4a7443c),   720,  236 },
+  { GOOGLE_ULONGLONG(0xbb764c4ca7a44410),   747,  244 },
+  { GOOGLE_ULONGLONG(0x8bab8eefb6409c1a),   774,  252 },
+  { GOOGLE_ULONGLONG(0xd01fef10a657842c),   800,  260 },
+  { GOOGLE_ULONGLONG(0x9b10a4e5e9913129),   827,  268 },
+  { GOOGLE_ULONGLONG(0xe7109bfba19c0c9d),   853,  276 },
+  { GOOGLE_ULONGLONG(0xac2820d9623bf429),   880,  284 },
+  { GOOGLE_ULONGLONG(0x80444b5e7aa7cf85),   907,  292 },
+  { GOOGLE_ULONGLONG(0xbf21e44003acdd2d),   933,  300 },
+  { GOOGLE_ULONGLONG(0x8e679c2f5e44ff8f),   960,  308 },
+  { GOOGLE_ULONGLONG(0xd433179d9c8cb841),   986,  316 },
+  { GOOGLE_ULONGLONG(0x9e19db92b4e31ba9),  1013,  324 },
+  { GOOGLE_ULONGLONG(0xeb96bf6ebadf77d9),  1039,  332 },
+  { GOOGLE_ULONGLONG(0xaf87023b9bf0ee6b),  1066,  340 },
+};
+const int kCachedPowersOffset = 348;  // -kCachedPowers[0].decimal_exponent
+const int kCachedPowersDecimalDistance = 8;
+
+// Grisu needs the scaled value's binary exponent to be within this range.
+const int kMinimalTargetExponent = -60;
+
+// Grisu3's "round_weed":  the digits so far are within the unsafe interval;
+// move the last digit towards w while that gets closer, then check that the
+// result is safely inside the real interval and unambiguously the closest.
+// Returns false if it can't tell.
+bool RoundWeed(char* buffer, int length, uint64 distance_too_high_w,
+               uint64 unsafe_interval, uint64 rest, uint64 ten_kappa,
+               uint64 unit) {
+  uint64 small_distance = distance_too_high_w - unit;
+  uint64 big_distance = distance_too_high_w + unit;
+  while (rest < small_distance &&
+         unsafe_interval - rest >= ten_kappa &&
+         (rest + ten_kappa < small_distance ||
+          small_distance - rest >= rest + ten_kappa - small_distance)) {
+    buffer[length - 1]--;
+    rest += ten_kappa;
+  }
+  if (rest < big_distance &&
+      unsafe_interval - rest >= ten_kappa &&
+      (rest + ten_kappa < big_distance ||
+       big_distance - rest > rest + ten_kappa - big_distance)) {
+    return false;
+  }
+  return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+}
+
+// Generates the digits of w, which low and high bound, stopping as soon as
+// the digits identify a number between them.  The value of the digits is
+// buffer * 10^*kappa.
+bool DigitGen(const DiyFp& low, const DiyFp& w, const DiyFp& high,
+              char* buffer, int* length, int* kappa) {
+  // low and high are only known to within one unit in the last place, so
+  // widen the interval by that much and narrow it again in RoundWeed().
+  uint64 unit = 1;
+  uint64 too_low = low.f - unit;
+  uint64 too_high = high.f + unit;
+  uint64 unsafe_interval = too_high - too_low;
+
+  // Split too_high into the parts before and after the binary point.
+  int shift = -w.e;
+  uint64 one = GOOGLE_ULONGLONG(1) << shift;
+  uint32 integrals = static_cast<uint32>(too_high >> shift);
+  uint64 fractionals = too_high & (one - 1);
+
+  uint32 divisor = 1;
+  *kappa = 1;
+  while (divisor <= integrals / 10) {
+    divisor *= 10;
+    ++*kappa;
+  }
+
+  *length = 0;
+  while (*kappa > 0) {
+    buffer[(*length)++] = '0' + integrals / divisor;
+    integrals %= divisor;
+    --*kappa;
+    uint64 rest = (static_cast<uint64>(integrals) << shift) + fractionals;
+    if (rest < unsafe_interval) {
+      return RoundWeed(buffer, *length, too_high - w.f, unsafe_interval, rest,
+                       static_cast<uint64>(divisor) << shift, unit);
+    }
+    divisor /= 10;
+  }
+
+  while (true) {
+    fractionals *= 10;
+    unit *= 10;
+    unsafe_interval *= 10;
+    buffer[(*length)++] = '0' + static_cast<int>(fractionals >> shift);
+    fractionals &= one - 1;
+    --*kappa;
+    if (fractionals < unsafe_interval) {
+      return RoundWeed(buffer, *length, (too_high - w.f) * unit,
+                       unsafe_interval, fractionals, one, unit);
+    }
+  }
+}
+
+// Sets buffer[0..*length) to the shortest digits which read back as w, and
+// *exponent so that w ~= digits * 10^*exponent.  Returns false if Grisu3
+// can't be sure it found them.
+bool Grisu3(const DiyFp& w, const DiyFp& minus, const DiyFp& plus,
+            char* buffer, int* length, int* exponent) {
+  // Scale by a cached power of ten that brings the binary exponent into
+  // [kMinimalTargetExponent, kMinimalTargetExponent + 28].
+  int min_exponent = kMinimalTargetExponent - (w.e + 64);
+  int k = static_cast<int>(ceil((min_exponent + 63) * 0.30102999566398114));
+  const CachedPower& power = kCachedPowers[
+      (kCachedPowersOffset + k - 1) / kCachedPowersDecimalDistance + 1];
+  DiyFp ten_mk = MakeDiyFp(power.significand, power.binary_exponent);
+
+  int kappa;
+  if (!DigitGen(Multiply(minus, ten_mk), Multiply(w, ten_mk),
+                Multiply(plus, ten_mk), buffer, length, &kappa)) {
+    return false;
+  }
+  *exponent = kappa - power.decimal_exponent;
+  return true;
+}
+
+// Float fields are read back either with strtof() or, by the text format
+// parser, as a double which is then narrowed to float.  Rounding twice can
+// land on the neighbouring float when the text is very close to halfway
+// between two floats, so digits for a float must survive that as well.
+bool SurvivesDoubleRounding(const char* digits, int length, int exponent,
+                            double value) {
+  char text[kDoubleToBufferSize];
+  memcpy(text, digits, length);
+  text[length] = 'e';
+  char* end = FastInt32ToBufferLeft(exponent, text + length + 1);
+  double parsed_value;
+  ParseDecimalDouble(text, end, &parsed_value);
+  return static_cast<float>(parsed_value) == value;
+}
+
+// The slow path for when Grisu3 fails:  print with snprintf() at
+// increasing precision, starting at the given one, until the text reads
+// back as the value.  Starting at DBL_DIG (or FLT_DIG) is safe because if
+// any shorter digits would do, printing at that precision gives those
+// digits followed by zeros.
+void FallbackDigits(double value, bool is_float, int precision,
+                    char* digits, int* length, int* exponent) {
+  char buffer[kDoubleToBufferSize];
+  int max_precision = is_float ? 9 : 17;
+  for (;; ++precision) {
+    int snprintf_result =
+      snprintf(buffer, kDoubleToBufferSize, "%.*e", precision - 1, value);
+    GOOGLE_DCHECK(snprintf_result > 0 && snprintf_result < kDoubleToBufferSize);
+    if (precision >= max_precision) break;
+
+    if (is_float) {
+      // See SurvivesDoubleRounding().
+      float parsed_value;
+      if (safe_strtof(buffer, &parsed_value) && parsed_value == value &&
+          static_cast<float>(strtod(buffer, NULL)) == value) {
+        break;
+      }
+    } else {
+      // volatile to keep the comparison from using extended precision.
+      volatile double parsed_value = strtod(buffer, NULL);
+      if (parsed_value == value) break;
+    }
+  }
+
+  // buffer is "d.ddde+XX", with whatever radix character the locale uses.
+  const char* p = buffer;
+  *length = 0;
+  for (; *p != 'e'; ++p) {
+    if ('0' <= *p && *p <= '9') digits[(*length)++] = *p;
+  }
+  *exponent = atoi(p + 1) - (*length - 1);
+}
+
+// Writes digits * 10^exponent to buffer the way printf("%.*g", precision)
+// would.  digits must not end in '0'.
+void FormatDigits(bool negative, const char* digits, int length,
+                  int exponent, int precision, char* buffer) {
+  if (negative) *buffer++ = '-';
+
+  // The value is 0.digits * 10^decimal_point.
+  int decimal_point = length + exponent;
+  if (decimal_point - 1 < -4 || decimal_point - 1 >= precision) {
+    // Exponential notation, with at least two exponent digits.
+    *buffer++ = digits[0];
+    if (length > 1) {
+      *buffer++ = '.';
+      memcpy(buffer, digits + 1, length - 1);
+      buffer += length - 1;
+    }
+    *buffer++ = 'e';
+    int printed_exponent = decimal_point - 1;
+    if (printed_exponent < 0) {
+      *buffer++ = '-';
+      printed_exponent = -printed_exponent;
+    } else {
+      *buffer++ = '+';
+    }
+    if (printed_exponent < 10) *buffer++ = '0';
+    FastUInt32ToBufferLeft(printed_exponent, buffer);
+  } else if (decimal_point <= 0) {
+    *buffer++ = '0';
+    *buffer++ = '.';
+    memset(buffer, '0', -decimal_point);
+    buffer += -decimal_point;
+    memcpy(buffer, digits, length);
+    buffer[length] = '\0';
+  } else if (decimal_point >= length) {
+    memcpy(buffer, digits, length);
+    memset(buffer + length, '0', decimal_point - length);
+    buffer[decimal_point] = '\0';
+  } else {
+    memcpy(buffer, digits, decimal_point);
+    buffer[decimal_point] = '.';
+    memcpy(buffer + decimal_point + 1, digits + decimal_point,
+           length - decimal_point);
+    buffer[length + 1] = '\0';
+  }
+}
+
+// Shared by DoubleToBuffer() and FloatToBuffer() once the fields of the
+// value have been extracted.  min_precision is DBL_DIG or FLT_DIG.
+char* ShortestToBuffer(double value, bool negative, uint64 fraction,
+                       int biased_exponent, int fraction_bits,
+                       int exponent_bias, int min_precision, char* buffer) {
+  if (biased_exponent == 0 && fraction == 0) {
+    strcpy(buffer, negative ? "-0" : "0");
+    return buffer;
+  }
+
+  char digits[kDoubleToBufferSize];
+  int length;
+  int exponent;
+  DiyFp w, minus, plus;
+  Decompose(fraction, biased_exponent, fraction_bits, exponent_bias,
+            &w, &minus, &plus);
+  bool is_float = min_precision == FLT_DIG;
+  double absolute_value = negative ? -value : value;
+  if (!Grisu3(w, minus, plus, digits, &length, &exponent)) {
+    FallbackDigits(absolute_value, is_float, min_precision,
+                   digits, &length, &exponent);
+  } else if (is_float &&
+             !SurvivesDoubleRounding(digits, length, exponent,
+                                     absolute_value)) {
+    FallbackDigits(absolute_value, is_float, length + 1,
+                   digits, &length, &exponent);
+  }
+  while (digits[length - 1] == '0') {
+    --length;
+    ++exponent;
+  }
+
+  // The old snprintf()-based code printed with precision DBL_DIG, or
+  // DBL_DIG + 2 when that didn't round-trip.  Choosing between fixed and
+  // exponential notation the same way keeps e.g. 1e15 printing as "1e+15".
+  FormatDigits(negative, digits, length, exponent,
+               length <= min_precision ? min_precision : min_precision + 2,
+               buffer);
+  return buffer;
+}
+
+// DoubleToBuffer() and FloatToBuffer() take the values apart by copying
+// their bits into integers of the same size.
+GOOGLE_COMPILE_ASSERT(sizeof(double) == sizeof(uint64), double_is_not_64_bits);
+GOOGLE_COMPILE_ASSERT(sizeof(float) == sizeof(uint32), float_is_not_32_bits);
+
+}  // namespace
+
 char* DoubleToBuffer(double value, char* buffer) {
   // DBL_DIG is 15 for IEEE-754 doubles, which are used on almost all
   // platforms these days.  Just in case some system exists where DBL_DIG
@@ -1030,41 +1456,12 @@ char* DoubleToBuffer(double value, char* buffer) {
     return buffer;
   }
 
-  int snprintf_result =
-    snprintf(buffer, kDoubleToBufferSize, "%.*g", DBL_DIG, value);
-
-  // The snprintf should never overflow because the buffer is significantly
-  // larger than the precision we asked for.
-  GOOGLE_DCHECK(snprintf_result > 0 && snprintf_result < kDoubleToBufferSize);
-
-  // We need to make parsed_value volatile in order to force the compiler to
-  // write it out to the stack.  Otherwise, it may keep the value in a
-  // register, and if it does that, it may keep it as a long double instead
-  // of a double.  This long double may have extra bits that make it compare
-  // unequal to "value" even though it would be exactly equal if it were
-  // truncated to a double.
-  volatile double parsed_value = strtod(buffer, NULL);
-  if (parsed_value != value) {
-    int snprintf_result =
-      snprintf(buffer, kDoubleToBufferSize, "%.*g", DBL_DIG+2, value);
-
-    // Should never overflow; see above.
-    GOOGLE_DCHECK(snprintf_result > 0 && snprintf_result < kDoubleToBufferSize);
-  }
-
-  DelocalizeRadix(buffer);
-  return buffer;
-}
-
-bool safe_strtof(const char* str, float* value) {
-  char* endptr;
-  errno = 0;  // errno only gets set on errors
-#if defined(_WIN32) || defined (__hpux)  // has no strtof()
-  *value = strtod(str, &endptr);
-#else
-  *value = strtof(str, &endptr);
-#endif
-  return *str != 0 && *endptr == 0 && errno == 0;
+  uint64 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return ShortestToBuffer(value, (bits >> 63) != 0,
+                          bits & ((GOOGLE_ULONGLONG(1) << 52) - 1),
+                          static_cast<int>(bits >> 52) & 0x7FF, 52, 1023,
+                          DBL_DIG, buffer);
 }
 
 char* FloatToBuffer(float value, char* buffer) {
@@ -1085,24 +1482,919 @@ char* FloatToBuffer(float value, char* buffer) {
     return buffer;
   }
 
-  int snprintf_result =
-    snprintf(buffer, kFloatToBufferSize, "%.*g", FLT_DIG, value);
+  uint32 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return ShortestToBuffer(value, (bits >> 31) != 0, bits & ((1u << 23) - 1),
+                          static_cast<int>(bits >> 23) & 0xFF, 23, 127,
+                          FLT_DIG, buffer);
+}
+
+// ----------------------------------------------------------------------
+// ParseDecimalDouble()
+//    Uses the algorithm of Eisel and Lemire ("Number Parsing at a Gigabyte
+//    per Second"):  a decimal w * 10^q with at most 19 significant digits is
+//    multiplied by a 128-bit truncation of 5^q, and the top bits of the
+//    product almost always determine the correctly rounded double.  The
+//    rare inputs where they don't, and inputs with more than 19 significant
+//    digits, go to strtod().
+// ----------------------------------------------------------------------
 
-  // The snprintf should never overflow because the buffer is significantly
-  // larger than the precision we asked for.
-  GOOGLE_DCHECK(snprintf_result > 0 && snprintf_result < kFloatToBufferSize);
+namespace {
+
+#define POWER(high, low) { GOOGLE_ULONGLONG(high), GOOGLE_ULONGLONG(low) }
+
+// 5^q for q from -342 to 308, shifted so that the top bit is set and
+// truncated to 128 bits (high word first).  Negative powers are rounded up.
+const uint64 kPowersOfFive[][2] = {
+  POWER(0xeef453d6923bd65a, 0x113faa2906a13b3f),
+  POWER(0x9558b4661b6565f8, 0x4ac7ca59a424c507),
+  POWER(0xbaaee17fa23ebf76, 0x5d79bcf00d2df649),
+  POWER(0xe95a99df8ace6f53, 0xf4d82c2c107973dc),
+  POWER(0x91d8a02bb6c10594, 0x79071b9b8a4be869),
+  POWER(0xb64ec836a47146f9, 0x9748e2826cdee284),
+  POWER(0xe3e27a444d8d98b7, 0xfd1b1b2308169b25),
+  POWER(0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7),
+  POWER(0xb208ef855c969f4f, 0xbdbd2d335e51a935),
+  POWER(0xde8b2b66b3bc4723, 0xad2c788035e61382),
+  POWER(0x8b16fb203055ac76, 0x4c3bcb5021afcc31),
+  POWER(0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d),
+  POWER(0xd953e8624b85dd78, 0xd71d6dad34a2af0d),
+  POWER(0x87d4713d6f33aa6b, 0x8672648c40e5ad68),
+  POWER(0xa9c98d8ccb009506, 0x680efdaf511f18c2),
+  POWER(0xd43bf0effdc0ba48, 0x0212bd1b2566def2),
+  POWER(0x84a57695fe98746d, 0x014bb630f7604b57),
+  POWER(0xa5ced43b7e3e9188, 0x419ea3bd35385e2d),
+  POWER(0xcf42894a5dce35ea, 0x52064cac828675b9),
+  POWER(0x818995ce7aa0e1b2, 0x7343efebd1940993),
+  POWER(0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8),
+  POWER(0xca66fa129f9b60a6, 0xd41a26e077774ef6),
+  POWER(0xfd00b897478238d0, 0x8920b098955522b4),
+  POWER(0x9e20735e8cb16382, 0x55b46e5f5d5535b0),
+  POWER(0xc5a890362fddbc62, 0xeb2189f734aa831d),
+  POWER(0xf712b443bbd52b7b, 0xa5e9ec7501d523e4),
+  POWER(0x9a6bb0aa55653b2d, 0x47b233c92125366e),
+  POWER(0xc1069cd4eabe89f8, 0x999ec0bb696e840a),
+  POWER(0xf148440a256e2c76, 0xc00670ea43ca250d),
+  POWER(0x96cd2a865764dbca, 0x380406926a5e5728),
+  POWER(0xbc807527ed3e12bc, 0xc605083704f5ecf2),
+  POWER(0xeba09271e88d976b, 0xf7864a44c633682e),
+  POWER(0x93445b8731587ea3, 0x7ab3ee6afbe0211d),
+  POWER(0xb8157268fdae9e4c, 0x5960ea05bad82964),
+  POWER(0xe61acf033d1a45df, 0x6fb92487298e33bd),
+  POWER(0x8fd0c16206306bab, 0xa5d3b6d479f8e056),
+  POWER(0xb3c4f1ba87bc8696, 0x8f48a4899877186c),
+  POWER(0xe0b62e2929aba83c, 0x331acdabfe94de87),
+  POWER(0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14),
+  POWER(0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9),
+  POWER(0xdb71e91432b1a24a, 0xc9e82cd9f69d6150),
+  POWER(0x892731ac9faf056e, 0xbe311c083a225cd2),
+  POWER(0xab70fe17c79ac6ca, 0x6dbd630a48aaf406),
+  POWER(0xd64d3d9db981787d, 0x092cbbccdad5b108),
+  POWER(0x85f0468293f0eb4e, 0x25bbf56008c58ea5),
+  POWER(0xa76c582338ed2621, 0xaf2af2b80af6f24e),
+  POWER(0xd1476e2c07286faa, 0x1af5af660db4aee1),
+  POWER(0x82cca4db847945ca, 0x50d98d9fc890ed4d),
+  POWER(0xa37fce126597973c, 0xe50ff107bab528a0),
+  POWER(0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8),
+  POWER(0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a),
+  POWER(0x9faacf3df73609b1, 0x77b191618c54e9ac),
+  POWER(0xc795830d75038c1d, 0xd59df5b9ef6a2417),
+  POWER(0xf97ae3d0d2446f25, 0x4b0573286b44ad1d),
+  POWER(0x9becce62836ac577, 0x4ee367f9430aec32),
+  POWER(0xc2e801fb244576d5, 0x229c41f793cda73f),
+  POWER(0xf3a20279ed56d48a, 0x6b43527578c1110f),
+  POWER(0x9845418c345644d6, 0x830a13896b78aaa9),
+  POWER(0xbe5691ef416bd60c, 0x23cc986bc656d553),
+  POWER(0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8),
+  POWER(0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9),
+  POWER(0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53),
+  POWER(0xe858ad248f5c22c9, 0xd1b3400f8f9cff68),
+  POWER(0x91376c36d99995be, 0x23100809b9c21fa1),
+  POWER(0xb58547448ffffb2d, 0xabd40a0c2832a78a),
+  POWER(0xe2e69915b3fff9f9, 0x16c90c8f323f516c),
+  POWER(0x8dd01fad907ffc3b, 0xae3da7d97f6792e3),
+  POWER(0xb1442798f49ffb4a, 0x99cd11cfdf41779c),
+  POWER(0xdd95317f31c7fa1d, 0x40405643d711d583),
+  POWER(0x8a7d3eef7f1cfc52, 0x482835ea666b2572),
+  POWER(0xad1c8eab5ee43b66, 0xda3243650005eecf),
+  POWER(0xd863b256369d4a40, 0x90bed43e40076a82),
+  POWER(0x873e4f75e2224e68, 0x5a7744a6e804a291),
+  POWER(0xa90de3535aaae202, 0x711515d0a205cb36),
+  POWER(0xd3515c2831559a83, 0x0d5a5b44ca873e03),
+  POWER(0x8412d9991ed58091, 0xe858790afe9486c2),
+  POWER(0xa5178fff668ae0b6, 0x626e974dbe39a872),
+  POWER(0xce5d73ff402d98e3, 0xfb0a3d212dc8128f),
+  POWER(0x80fa687f881c7f8e, 0x7ce66634bc9d0b99),
+  POWER(0xa139029f6a239f72, 0x1c1fffc1ebc44e80),
+  POWER(0xc987434744ac874e, 0xa327ffb266b56220),
+  POWER(0xfbe9141915d7a922, 0x4bf1ff9f0062baa8),
+  POWER(0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9),
+  POWER(0xc4ce17b399107c22, 0xcb550fb4384d21d3),
+  POWER(0xf6019da07f549b2b, 0x7e2a53a146606a48),
+  POWER(0x99c102844f94e0fb, 0x2eda7444cbfc426d),
+  POWER(0xc0314325637a1939, 0xfa911155fefb5308),
+  POWER(0xf03d93eebc589f88, 0x793555ab7eba27ca),
+  POWER(0x96267c7535b763b5, 0x4bc1558b2f3458de),
+  POWER(0xbbb01b9283253ca2, 0x9eb1aaedfb016f16),
+  POWER(0xea9c227723ee8bcb, 0x465e15a979c1cadc),
+  POWER(0x92a1958a7675175f, 0x0bfacd89ec191ec9),
+  POWER(0xb749faed14125d36, 0xcef980ec671f667b),
+  POWER(0xe51c79a85916f484, 0x82b7e12780e7401a),
+  POWER(0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810),
+  POWER(0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15),
+  POWER(0xdfbdcece67006ac9, 0x67a791e093e1d49a),
+  POWER(0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0),
+  POWER(0xaecc49914078536d, 0x58fae9f773886e18),
+  POWER(0xda7f5bf590966848, 0xaf39a475506a899e),
+  POWER(0x888f99797a5e012d, 0x6d8406c952429603),
+  POWER(0xaab37fd7d8f58178, 0xc8e5087ba6d33b83),
+  POWER(0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64),
+  POWER(0x855c3be0a17fcd26, 0x5cf2eea09a55067f),
+  POWER(0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e),
+  POWER(0xd0601d8efc57b08b, 0xf13b94daf124da26),
+  POWER(0x823c12795db6ce57, 0x76c53d08d6b70858),
+  POWER(0xa2cb1717b52481ed, 0x54768c4b0c64ca6e),
+  POWER(0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09),
+  POWER(0xfe5d54150b090b02, 0xd3f93b35435d7c4c),
+  POWER(0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf),
+  POWER(0xc6b8e9b0709f109a, 0x359ab6419ca1091b),
+  POWER(0xf867241c8cc6d4c0, 0xc30163d203c94b62),
+  POWER(0x9b407691d7fc44f8, 0x79e0de63425dcf1d),
+  POWER(0xc21094364dfb5636, 0x985915fc12f542e4),
+  POWER(0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d),
+  POWER(0x979cf3ca6cec5b5a, 0xa705992ceecf9c42),
+  POWER(0xbd8430bd08277231, 0x50c6ff782a838353),
+  POWER(0xece53cec4a314ebd, 0xa4f8bf5635246428),
+  POWER(0x940f4613ae5ed136, 0x871b7795e136be99),
+  POWER(0xb913179899f68584, 0x28e2557b59846e3f),
+  POWER(0xe757dd7ec07426e5, 0x331aeada2fe589cf),
+  POWER(0x9096ea6f3848984f, 0x3ff0d2c85def7621),
+  POWER(0xb4bca50b065abe63, 0x0fed077a756b53a9),
+  POWER(0xe1ebce4dc7f16dfb, 0xd3e8495912c62894),
+  POWER(0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c),
+  POWER(0xb080392cc4349dec, 0xbd8d794d96aacfb3),
+  POWER(0xdca04777f541c567, 0xecf0d7a0fc5583a0),
+  POWER(0x89e42caaf9491b60, 0xf41686c49db57244),
+  POWER(0xac5d37d5b79b6239, 0x311c2875c522ced5),
+  POWER(0xd77485cb25823ac7, 0x7d633293366b828b),
+  POWER(0x86a8d39ef77164bc, 0xae5dff9c02033197),
+  POWER(0xa8530886b54dbdeb, 0xd9f57f830283fdfc),
+  POWER(0xd267caa862a12d66, 0xd072df63c324fd7b),
+  POWER(0x8380dea93da4bc60, 0x4247cb9e59f71e6d),
+  POWER(0xa46116538d0deb78, 0x52d9be85f074e608),
+  POWER(0xcd795be870516656, 0x67902e276c921f8b),
+  POWER(0x806bd9714632dff6, 0x00ba1cd8a3db53b6),
+  POWER(0xa086cfcd97bf97f3, 0x80e8a40eccd228a4),
+  POWER(0xc8a883c0fdaf7df0, 0x6122cd128006b2cd),
+  POWER(0xfad2a4b13d1b5d6c, 0x796b805720085f81),
+  POWER(0x9cc3a6eec6311a63, 0xcbe3303674053bb0),
+  POWER(0xc3f490aa77bd60fc, 0xbedbfc4411068a9c),
+  POWER(0xf4f1b4d515acb93b, 0xee92fb5515482d44),
+  POWER(0x991711052d8bf3c5, 0x751bdd152d4d1c4a),
+  POWER(0xbf5cd54678eef0b6, 0xd262d45a78a0635d),
+  POWER(0xef340a98172aace4, 0x86fb897116c87c34),
+  POWER(0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0),
+  POWER(0xbae0a846d2195712, 0x8974836059cca109),
+  POWER(0xe998d258869facd7, 0x2bd1a438703fc94b),
+  POWER(0x91ff83775423cc06, 0x7b6306a34627ddcf),
+  POWER(0xb67f6455292cbf08, 0x1a3bc84c17b1d542),
+  POWER(0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93),
+  POWER(0x8e938662882af53e, 0x547eb47b7282ee9c),
+  POWER(0xb23867fb2a35b28d, 0xe99e619a4f23aa43),
+  POWER(0xdec681f9f4c31f31, 0x6405fa00e2ec94d4),
+  POWER(0x8b3c113c38f9f37e, 0xde83bc408dd3dd04),
+  POWER(0xae0b158b4738705e, 0x9624ab50b148d445),
+  POWER(0xd98ddaee19068c76, 0x3badd624dd9b0957),
+  POWER(0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6),
+  POWER(0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c),
+  POWER(0xd47487cc8470652b, 0x7647c3200069671f),
+  POWER(0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073),
+  POWER(0xa5fb0a17c777cf09, 0xf468107100525890),
+  POWER(0xcf79cc9db955c2cc, 0x7182148d4066eeb4),
+  POWER(0x81ac1fe293d599bf, 0xc6f14cd848405530),
+  POWER(0xa21727db38cb002f, 0xb8ada00e5a506a7c),
+  POWER(0xca9cf1d206fdc03b, 0xa6d90811f0e4851c),
+  POWER(0xfd442e4688bd304a, 0x908f4a166d1da663),
+  POWER(0x9e4a9cec15763e2e, 0x9a598e4e043287fe),
+  POWER(0xc5dd44271ad3cdba, 0x40eff1e1853f29fd),
+  POWER(0xf7549530e188c128, 0xd12bee59e68ef47c),
+  POWER(0x9a94dd3e8cf578b9, 0x82bb74f8301958ce),
+  POWER(0xc13a148e3032d6e7, 0xe36a52363c1faf01),
+  POWER(0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1),
+  POWER(0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9),
+  POWER(0xbcb2b812db11a5de, 0x7415d448f6b6f0e7),
+  POWER(0xebdf661791d60f56, 0x111b495b3464ad21),
+  POWER(0x936b9fcebb25c995, 0xcab10dd900beec34),
+  POWER(0xb84687c269ef3bfb, 0x3d5d514f40eea742),
+  POWER(0xe65829b3046b0afa, 0x0cb4a5a3112a5112),
+  POWER(0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab),
+  POWER(0xb3f4e093db73a093, 0x59ed216765690f56),
+  POWER(0xe0f218b8d25088b8, 0x306869c13ec3532c),
+  POWER(0x8c974f7383725573, 0x1e414218c73a13fb),
+  POWER(0xafbd2350644eeacf, 0xe5d1929ef90898fa),
+  POWER(0xdbac6c247d62a583, 0xdf45f746b74abf39),
+  POWER(0x894bc396ce5da772, 0x6b8bba8c328eb783),
+  POWER(0xab9eb47c81f5114f, 0x066ea92f3f326564),
+  POWER(0xd686619ba27255a2, 0xc80a537b0efefebd),
+  POWER(0x8613fd0145877585, 0xbd06742ce95f5f36),
+  POWER(0xa798fc4196e952e7, 0x2c48113823b73704),
+  POWER(0xd17f3b51fca3a7a0, 0xf75a15862ca504c5),
+  POWER(0x82ef85133de648c4, 0x9a984d73dbe722fb),
+  POWER(0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba),
+  POWER(0xcc963fee10b7d1b3, 0x318df905079926a8),
+  POWER(0xffbbcfe994e5c61f, 0xfdf17746497f7052),
+  POWER(0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633),
+  POWER(0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0),
+  POWER(0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0),
+  POWER(0x9c1661a651213e2d, 0x06bea10ca65c084e),
+  POWER(0xc31bfa0fe5698db8, 0x486e494fcff30a62),
+  POWER(0xf3e2f893dec3f126, 0x5a89dba3c3efccfa),
+  POWER(0x986ddb5c6b3a76b7, 0xf89629465a75e01c),
+  POWER(0xbe89523386091465, 0xf6bbb397f1135823),
+  POWER(0xee2ba6c0678b597f, 0x746aa07ded582e2c),
+  POWER(0x94db483840b717ef, 0xa8c2a44eb4571cdc),
+  POWER(0xba121a4650e4ddeb, 0x92f34d62616ce413),
+  POWER(0xe896a0d7e51e1566, 0x77b020baf9c81d17),
+  POWER(0x915e2486ef32cd60, 0x0ace1474dc1d122e),
+  POWER(0xb5b5ada8aaff80b8, 0x0d819992132456ba),
+  POWER(0xe3231912d5bf60e6, 0x10e1fff697ed6c69),
+  POWER(0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1),
+  POWER(0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2),
+  POWER(0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde),
+  POWER(0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b),
+  POWER(0xad4ab7112eb3929d, 0x86c16c98d2c953c6),
+  POWER(0xd89d64d57a607744, 0xe871c7bf077ba8b7),
+  POWER(0x87625f056c7c4a8b, 0x11471cd764ad4972),
+  POWER(0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf),
+  POWER(0xd389b47879823479, 0x4aff1d108d4ec2c3),
+  POWER(0x843610cb4bf160cb, 0xcedf722a585139ba),
+  POWER(0xa54394fe1eedb8fe, 0xc2974eb4ee658828),
+  POWER(0xce947a3da6a9273e, 0x733d226229feea32),
+  POWER(0x811ccc668829b887, 0x0806357d5a3f525f),
+  POWER(0xa163ff802a3426a8, 0xca07c2dcb0cf26f7),
+  POWER(0xc9bcff6034c13052, 0xfc89b393dd02f0b5),
+  POWER(0xfc2c3f3841f17c67, 0xbbac2078d443ace2),
+  POWER(0x9d9ba7832936edc0, 0xd54b944b84aa4c0d),
+  POWER(0xc5029163f384a931, 0x0a9e795e65d4df11),
+  POWER(0xf64335bcf065d37d, 0x4d4617b5ff4a16d5),
+  POWER(0x99ea0196163fa42e, 0x504bced1bf8e4e45),
+  POWER(0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6),
+  POWER(0xf07da27a82c37088, 0x5d767327bb4e5a4c),
+  POWER(0x964e858c91ba2655, 0x3a6a07f8d510f86f),
+  POWER(0xbbe226efb628afea, 0x890489f70a55368b),
+  POWER(0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e),
+  POWER(0x92c8ae6b464fc96f, 0x3b0b8bc90012929d),
+  POWER(0xb77ada0617e3bbcb, 0x09ce6ebb40173744),
+  POWER(0xe55990879ddcaabd, 0xcc420a6a101d0515),
+  POWER(0x8f57fa54c2a9eab6, 0x9fa946824a12232d),
+  POWER(0xb32df8e9f3546564, 0x47939822dc96abf9),
+  POWER(0xdff9772470297ebd, 0x59787e2b93bc56f7),
+  POWER(0x8bfbea76c619ef36, 0x57eb4edb3c55b65a),
+  POWER(0xaefae51477a06b03, 0xede622920b6b23f1),
+  POWER(0xdab99e59958885c4, 0xe95fab368e45eced),
+  POWER(0x88b402f7fd75539b, 0x11dbcb0218ebb414),
+  POWER(0xaae103b5fcd2a881, 0xd652bdc29f26a119),
+  POWER(0xd59944a37c0752a2, 0x4be76d3346f0495f),
+  POWER(0x857fcae62d8493a5, 0x6f70a4400c562ddb),
+  POWER(0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952),
+  POWER(0xd097ad07a71f26b2, 0x7e2000a41346a7a7),
+  POWER(0x825ecc24c873782f, 0x8ed400668c0c28c8),
+  POWER(0xa2f67f2dfa90563b, 0x728900802f0f32fa),
+  POWER(0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9),
+  POWER(0xfea126b7d78186bc, 0xe2f610c84987bfa8),
+  POWER(0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9),
+  POWER(0xc6ede63fa05d3143, 0x91503d1c79720dbb),
+  POWER(0xf8a95fcf88747d94, 0x75a44c6397ce912a),
+  POWER(0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba),
+  POWER(0xc24452da229b021b, 0xfbe85badce996168),
+  POWER(0xf2d56790ab41c2a2, 0xfae27299423fb9c3),
+  POWER(0x97c560ba6b0919a5, 0xdccd879fc967d41a),
+  POWER(0xbdb6b8e905cb600f, 0x5400e987bbc1c920),
+  POWER(0xed246723473e3813, 0x290123e9aab23b68),
+  POWER(0x9436c0760c86e30b, 0xf9a0b6720aaf6521),
+  POWER(0xb94470938fa89bce, 0xf808e40e8d5b3e69),
+  POWER(0xe7958cb87392c2c2, 0xb60b1d1230b20e04),
+  POWER(0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2),
+  POWER(0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3),
+  POWER(0xe2280b6c20dd5232, 0x25c6da63c38de1b0),
+  POWER(0x8d590723948a535f, 0x579c487e5a38ad0e),
+  POWER(0xb0af48ec79ace837, 0x2d835a9df0c6d851),
+  POWER(0xdcdb1b2798182244, 0xf8e431456cf88e65),
+  POWER(0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff),
+  POWER(0xac8b2d36eed2dac5, 0xe272467e3d222f3f),
+  POWER(0xd7adf884aa879177, 0x5b0ed81dcc6abb0f),
+  POWER(0x86ccbb52ea94baea, 0x98e947129fc2b4e9),
+  POWER(0xa87fea27a539e9a5, 0x3f2398d747b36224),
+  POWER(0xd29fe4b18e88640e, 0x8eec7f0d19a03aad),
+  POWER(0x83a3eeeef9153e89, 0x1953cf68300424ac),
+  POWER(0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7),
+  POWER(0xcdb02555653131b6, 0x3792f412cb06794d),
+  POWER(0x808e17555f3ebf11, 0xe2bbd88bbee40bd0),
+  POWER(0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4),
+  POWER(0xc8de047564d20a8b, 0xf245825a5a445275),
+  POWER(0xfb158592be068d2e, 0xeed6e2f0f0d56712),
+  POWER(0x9ced737bb6c4183d, 0x55464dd69685606b),
+  POWER(0xc428d05aa4751e4c, 0xaa97e14c3c26b886),
+  POWER(0xf53304714d9265df, 0xd53dd99f4b3066a8),
+  POWER(0x993fe2c6d07b7fab, 0xe546a8038efe4029),
+  POWER(0xbf8fdb78849a5f96, 0xde98520472bdd033),
+  POWER(0xef73d256a5c0f77c, 0x963e66858f6d4440),
+  POWER(0x95a8637627989aad, 0xdde7001379a44aa8),
+  POWER(0xbb127c53b17ec159, 0x5560c018580d5d52),
+  POWER(0xe9d71b689dde71af, 0xaab8f01e6e10b4a6),
+  POWER(0x9226712162ab070d, 0xcab3961304ca70e8),
+  POWER(0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22),
+  POWER(0xe45c10c42a2b3b05, 0x8cb89a7db77c506a),
+  POWER(0x8eb98a7a9a5b04e3, 0x77f3608e92adb242),
+  POWER(0xb267ed1940f1c61c, 0x55f038b237591ed3),
+  POWER(0xdf01e85f912e37a3, 0x6b6c46dec52f6688),
+  POWER(0x8b61313bbabce2c6, 0x2323ac4b3b3da015),
+  POWER(0xae397d8aa96c1b77, 0xabec975e0a0d081a),
+  POWER(0xd9c7dced53c72255, 0x96e7bd358c904a21),
+  POWER(0x881cea14545c7575, 0x7e50d64177da2e54),
+  POWER(0xaa242499697392d2, 0xdde50bd1d5d0b9e9),
+  POWER(0xd4ad2dbfc3d07787, 0x955e4ec64b44e864),
+  POWER(0x84ec3c97da624ab4, 0xbd5af13bef0b113e),
+  POWER(0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e),
+  POWER(0xcfb11ead453994ba, 0x67de18eda5814af2),
+  POWER(0x81ceb32c4b43fcf4, 0x80eacf948770ced7),
+  POWER(0xa2425ff75e14fc31, 0xa1258379a94d028d),
+  POWER(0xcad2f7f5359a3b3e, 0x096ee45813a04330),
+  POWER(0xfd87b5f28300ca0d, 0x8bca9d6e188853fc),
+  POWER(0x9e74d1b791e07e48, 0x775ea264cf55347e),
+  POWER(0xc612062576589dda, 0x95364afe032a819e),
+  POWER(0xf79687aed3eec551, 0x3a83ddbd83f52205),
+  POWER(0x9abe14cd44753b52, 0xc4926a9672793543),
+  POWER(0xc16d9a0095928a27, 0x75b7053c0f178294),
+  POWER(0xf1c90080baf72cb1, 0x5324c68b12dd6339),
+  POWER(0x971da05074da7bee, 0xd3f6fc16ebca5e04),
+  POWER(0xbce5086492111aea, 0x88f4bb1ca6bcf585),
+  POWER(0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6),
+  POWER(0x9392ee8e921d5d07, 0x3aff322e62439fd0),
+  POWER(0xb877aa3236a4b449, 0x09befeb9fad487c3),
+  POWER(0xe69594bec44de15b, 0x4c2ebe687989a9b4),
+  POWER(0x901d7cf73ab0acd9, 0x0f9d37014bf60a11),
+  POWER(0xb424dc35095cd80f, 0x538484c19ef38c95),
+  POWER(0xe12e13424bb40e13, 0x2865a5f206b06fba),
+  POWER(0x8cbccc096f5088cb, 0xf93f87b7442e45d4),
+  POWER(0xafebff0bcb24aafe, 0xf78f69a51539d749),
+  POWER(0xdbe6fecebdedd5be, 0xb573440e5a884d1c),
+  POWER(0x89705f4136b4a597, 0x31680a88f8953031),
+  POWER(0xabcc77118461cefc, 0xfdc20d2b36ba7c3e),
+  POWER(0xd6bf94d5e57a42bc, 0x3d32907604691b4d),
+  POWER(0x8637bd05af6c69b5, 0xa63f9a49c2c1b110),
+  POWER(0xa7c5ac471b478423, 0x0fcf80dc33721d54),
+  POWER(0xd1b71758e219652b, 0xd3c36113404ea4a9),
+  POWER(0x83126e978d4fdf3b, 0x645a1cac083126ea),
+  POWER(0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4),
+  POWER(0xcccccccccccccccc, 0xcccccccccccccccd),
+  POWER(0x8000000000000000, 0x0000000000000000),
+  POWER(0xa000000000000000, 0x0000000000000000),
+  POWER(0xc800000000000000, 0x0000000000000000),
+  POWER(0xfa00000000000000, 0x0000000000000000),
+  POWER(0x9c40000000000000, 0x0000000000000000),
+  POWER(0xc350000000000000, 0x0000000000000000),
+  POWER(0xf424000000000000, 0x0000000000000000),
+  POWER(0x9896800000000000, 0x0000000000000000),
+  POWER(0xbebc200000000000, 0x0000000000000000),
+  POWER(0xee6b280000000000, 0x0000000000000000),
+  POWER(0x9502f90000000000, 0x0000000000000000),
+  POWER(0xba43b74000000000, 0x0000000000000000),
+  POWER(0xe8d4a51000000000, 0x0000000000000000),
+  POWER(0x9184e72a00000000, 0x0000000000000000),
+  POWER(0xb5e620f480000000, 0x0000000000000000),
+  POWER(0xe35fa931a0000000, 0x0000000000000000),
+  POWER(0x8e1bc9bf04000000, 0x0000000000000000),
+  POWER(0xb1a2bc2ec5000000, 0x0000000000000000),
+  POWER(0xde0b6b3a76400000, 0x0000000000000000),
+  POWER(0x8ac7230489e80000, 0x0000000000000000),
+  POWER(0xad78ebc5ac620000, 0x0000000000000000),
+  POWER(0xd8d726b7177a8000, 0x0000000000000000),
+  POWER(0x878678326eac9000, 0x0000000000000000),
+  POWER(0xa968163f0a57b400, 0x0000000000000000),
+  POWER(0xd3c21bcecceda100, 0x0000000000000000),
+  POWER(0x84595161401484a0, 0x0000000000000000),
+  POWER(0xa56fa5b99019a5c8, 0x0000000000000000),
+  POWER(0xcecb8f27f4200f3a, 0x0000000000000000),
+  POWER(0x813f3978f8940984, 0x4000000000000000),
+  POWER(0xa18f07d736b90be5, 0x5000000000000000),
+  POWER(0xc9f2c9cd04674ede, 0xa400000000000000),
+  POWER(0xfc6f7c4045812296, 0x4d00000000000000),
+  POWER(0x9dc5ada82b70b59d, 0xf020000000000000),
+  POWER(0xc5371912364ce305, 0x6c28000000000000),
+  POWER(0xf684df56c3e01bc6, 0xc732000000000000),
+  POWER(0x9a130b963a6c115c, 0x3c7f400000000000),
+  POWER(0xc097ce7bc90715b3, 0x4b9f100000000000),
+  POWER(0xf0bdc21abb48db20, 0x1e86d40000000000),
+  POWER(0x96769950b50d88f4, 0x1314448000000000),
+  POWER(0xbc143fa4e250eb31, 0x17d955a000000000),
+  POWER(0xeb194f8e1ae525fd, 0x5dcfab0800000000),
+  POWER(0x92efd1b8d0cf37be, 0x5aa1cae500000000),
+  POWER(0xb7abc627050305ad, 0xf14a3d9e40000000),
+  POWER(0xe596b7b0c643c719, 0x6d9ccd05d0000000),
+  POWER(0x8f7e32ce7bea5c6f, 0xe4820023a2000000),
+  POWER(0xb35dbf821ae4f38b, 0xdda2802c8a800000),
+  POWER(0xe0352f62a19e306e, 0xd50b2037ad200000),
+  POWER(0x8c213d9da502de45, 0x4526f422cc340000),
+  POWER(0xaf298d050e4395d6, 0x9670b12b7f410000),
+  POWER(0xdaf3f04651d47b4c, 0x3c0cdd765f114000),
+  POWER(0x88d8762bf324cd0f, 0xa5880a69fb6ac800),
+  POWER(0xab0e93b6efee0053, 0x8eea0d047a457a00),
+  POWER(0xd5d238a4abe98068, 0x72a4904598d6d880),
+  POWER(0x85a36366eb71f041, 0x47a6da2b7f864750),
+  POWER(0xa70c3c40a64e6c51, 0x999090b65f67d924),
+  POWER(0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d),
+  POWER(0x82818f1281ed449f, 0xbff8f10e7a8921a4),
+  POWER(0xa321f2d7226895c7, 0xaff72d52192b6a0d),
+  POWER(0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490),
+  POWER(0xfee50b7025c36a08, 0x02f236d04753d5b4),
+  POWER(0x9f4f2726179a2245, 0x01d762422c946590),
+  POWER(0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5),
+  POWER(0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2),
+  POWER(0x9b934c3b330c8577, 0x63cc55f49f88eb2f),
+  POWER(0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb),
+  POWER(0xf316271c7fc3908a, 0x8bef464e3945ef7a),
+  POWER(0x97edd871cfda3a56, 0x97758bf0e3cbb5ac),
+  POWER(0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317),
+  POWER(0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd),
+  POWER(0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a),
+  POWER(0xb975d6b6ee39e436, 0xb3e2fd538e122b44),
+  POWER(0xe7d34c64a9c85d44, 0x60dbbca87196b616),
+  POWER(0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd),
+  POWER(0xb51d13aea4a488dd, 0x6babab6398bdbe41),
+  POWER(0xe264589a4dcdab14, 0xc696963c7eed2dd1),
+  POWER(0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2),
+  POWER(0xb0de65388cc8ada8, 0x3b25a55f43294bcb),
+  POWER(0xdd15fe86affad912, 0x49ef0eb713f39ebe),
+  POWER(0x8a2dbf142dfcc7ab, 0x6e3569326c784337),
+  POWER(0xacb92ed9397bf996, 0x49c2c37f07965404),
+  POWER(0xd7e77a8f87daf7fb, 0xdc33745ec97be906),
+  POWER(0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3),
+  POWER(0xa8acd7c0222311bc, 0xc40832ea0d68ce0c),
+  POWER(0xd2d80db02aabd62b, 0xf50a3fa490c30190),
+  POWER(0x83c7088e1aab65db, 0x792667c6da79e0fa),
+  POWER(0xa4b8cab1a1563f52, 0x577001b891185938),
+  POWER(0xcde6fd5e09abcf26, 0xed4c0226b55e6f86),
+  POWER(0x80b05e5ac60b6178, 0x544f8158315b05b4),
+  POWER(0xa0dc75f1778e39d6, 0x696361ae3db1c721),
+  POWER(0xc913936dd571c84c, 0x03bc3a19cd1e38e9),
+  POWER(0xfb5878494ace3a5f, 0x04ab48a04065c723),
+  POWER(0x9d174b2dcec0e47b, 0x62eb0d64283f9c76),
+  POWER(0xc45d1df942711d9a, 0x3ba5d0bd324f8394),
+  POWER(0xf5746577930d6500, 0xca8f44ec7ee36479),
+  POWER(0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb),
+  POWER(0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e),
+  POWER(0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e),
+  POWER(0x95d04aee3b80ece5, 0xbba1f1d158724a12),
+  POWER(0xbb445da9ca61281f, 0x2a8a6e45ae8edc97),
+  POWER(0xea1575143cf97226, 0xf52d09d71a3293bd),
+  POWER(0x924d692ca61be758, 0x593c2626705f9c56),
+  POWER(0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c),
+  POWER(0xe498f455c38b997a, 0x0b6dfb9c0f956447),
+  POWER(0x8edf98b59a373fec, 0x4724bd4189bd5eac),
+  POWER(0xb2977ee300c50fe7, 0x58edec91ec2cb657),
+  POWER(0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed),
+  POWER(0x8b865b215899f46c, 0xbd79e0d20082ee74),
+  POWER(0xae67f1e9aec07187, 0xecd8590680a3aa11),
+  POWER(0xda01ee641a708de9, 0xe80e6f4820cc9495),
+  POWER(0x884134fe908658b2, 0x3109058d147fdcdd),
+  POWER(0xaa51823e34a7eede, 0xbd4b46f0599fd415),
+  POWER(0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a),
+  POWER(0x850fadc09923329e, 0x03e2cf6bc604ddb0),
+  POWER(0xa6539930bf6bff45, 0x84db8346b786151c),
+  POWER(0xcfe87f7cef46ff16, 0xe612641865679a63),
+  POWER(0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e),
+  POWER(0xa26da3999aef7749, 0xe3be5e330f38f09d),
+  POWER(0xcb090c8001ab551c, 0x5cadf5bfd3072cc5),
+  POWER(0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6),
+  POWER(0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa),
+  POWER(0xc646d63501a1511d, 0xb281e1fd541501b8),
+  POWER(0xf7d88bc24209a565, 0x1f225a7ca91a4226),
+  POWER(0x9ae757596946075f, 0x3375788de9b06958),
+  POWER(0xc1a12d2fc3978937, 0x0052d6b1641c83ae),
+  POWER(0xf209787bb47d6b84, 0xc0678c5dbd23a49a),
+  POWER(0x9745eb4d50ce6332, 0xf840b7ba963646e0),
+  POWER(0xbd176620a501fbff, 0xb650e5a93bc3d898),
+  POWER(0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe),
+  POWER(0x93ba47c980e98cdf, 0xc66f336c36b10137),
+  POWER(0xb8a8d9bbe123f017, 0xb80b0047445d4184),
+  POWER(0xe6d3102ad96cec1d, 0xa60dc059157491e5),
+  POWER(0x9043ea1ac7e41392, 0x87c89837ad68db2f),
+  POWER(0xb454e4a179dd1877, 0x29babe4598c311fb),
+  POWER(0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a),
+  POWER(0x8ce2529e2734bb1d, 0x1899e4a65f58660c),
+  POWER(0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f),
+  POWER(0xdc21a1171d42645d, 0x76707543f4fa1f73),
+  POWER(0x899504ae72497eba, 0x6a06494a791c53a8),
+  POWER(0xabfa45da0edbde69, 0x0487db9d17636892),
+  POWER(0xd6f8d7509292d603, 0x45a9d2845d3c42b6),
+  POWER(0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2),
+  POWER(0xa7f26836f282b732, 0x8e6cac7768d7141e),
+  POWER(0xd1ef0244af2364ff, 0x3207d795430cd926),
+  POWER(0x8335616aed761f1f, 0x7f44e6bd49e807b8),
+  POWER(0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6),
+  POWER(0xcd036837130890a1, 0x36dba887c37a8c0f),
+  POWER(0x802221226be55a64, 0xc2494954da2c9789),
+  POWER(0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c),
+  POWER(0xc83553c5c8965d3d, 0x6f92829494e5acc7),
+  POWER(0xfa42a8b73abbf48c, 0xcb772339ba1f17f9),
+  POWER(0x9c69a97284b578d7, 0xff2a760414536efb),
+  POWER(0xc38413cf25e2d70d, 0xfef5138519684aba),
+  POWER(0xf46518c2ef5b8cd1, 0x7eb258665fc25d69),
+  POWER(0x98bf2f79d5993802, 0xef2f773ffbd97a61),
+  POWER(0xbeeefb584aff8603, 0xaafb550ffacfd8fa),
+  POWER(0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38),
+  POWER(0x952ab45cfa97a0b2, 0xdd945a747bf26183),
+  POWER(0xba756174393d88df, 0x94f971119aeef9e4),
+  POWER(0xe912b9d1478ceb17, 0x7a37cd5601aab85d),
+  POWER(0x91abb422ccb812ee, 0xac62e055c10ab33a),
+  POWER(0xb616a12b7fe617aa, 0x577b986b314d6009),
+  POWER(0xe39c49765fdf9d94, 0xed5a7e85fda0b80b),
+  POWER(0x8e41ade9fbebc27d, 0x14588f13be847307),
+  POWER(0xb1d219647ae6b31c, 0x596eb2d8ae258fc8),
+  POWER(0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb),
+  POWER(0x8aec23d680043bee, 0x25de7bb9480d5854),
+  POWER(0xada72ccc20054ae9, 0xaf561aa79a10ae6a),
+  POWER(0xd910f7ff28069da4, 0x1b2ba1518094da04),
+  POWER(0x87aa9aff79042286, 0x90fb44d2f05d0842),
+  POWER(0xa99541bf57452b28, 0x353a1607ac744a53),
+  POWER(0xd3fa922f2d1675f2, 0x42889b8997915ce8),
+  POWER(0x847c9b5d7c2e09b7, 0x69956135febada11),
+  POWER(0xa59bc234db398c25, 0x43fab9837e699095),
+  POWER(0xcf02b2c21207ef2e, 0x94f967e45e03f4bb),
+  POWER(0x8161afb94b44f57d, 0x1d1be0eebac278f5),
+  POWER(0xa1ba1ba79e1632dc, 0x6462d92a69731732),
+  POWER(0xca28a291859bbf93, 0x7d7b8f7503cfdcfe),
+  POWER(0xfcb2cb35e702af78, 0x5cda735244c3d43e),
+  POWER(0x9defbf01b061adab, 0x3a0888136afa64a7),
+  POWER(0xc56baec21c7a1916, 0x088aaa1845b8fdd0),
+  POWER(0xf6c69a72a3989f5b, 0x8aad549e57273d45),
+  POWER(0x9a3c2087a63f6399, 0x36ac54e2f678864b),
+  POWER(0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd),
+  POWER(0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5),
+  POWER(0x969eb7c47859e743, 0x9f644ae5a4b1b325),
+  POWER(0xbc4665b596706114, 0x873d5d9f0dde1fee),
+  POWER(0xeb57ff22fc0c7959, 0xa90cb506d155a7ea),
+  POWER(0x9316ff75dd87cbd8, 0x09a7f12442d588f2),
+  POWER(0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f),
+  POWER(0xe5d3ef282a242e81, 0x8f1668c8a86da5fa),
+  POWER(0x8fa475791a569d10, 0xf96e017d694487bc),
+  POWER(0xb38d92d760ec4455, 0x37c981dcc395a9ac),
+  POWER(0xe070f78d3927556a, 0x85bbe253f47b1417),
+  POWER(0x8c469ab843b89562, 0x93956d7478ccec8e),
+  POWER(0xaf58416654a6babb, 0x387ac8d1970027b2),
+  POWER(0xdb2e51bfe9d0696a, 0x06997b05fcc0319e),
+  POWER(0x88fcf317f22241e2, 0x441fece3bdf81f03),
+  POWER(0xab3c2fddeeaad25a, 0xd527e81cad7626c3),
+  POWER(0xd60b3bd56a5586f1, 0x8a71e223d8d3b074),
+  POWER(0x85c7056562757456, 0xf6872d5667844e49),
+  POWER(0xa738c6bebb12d16c, 0xb428f8ac016561db),
+  POWER(0xd106f86e69d785c7, 0xe13336d701beba52),
+  POWER(0x82a45b450226b39c, 0xecc0024661173473),
+  POWER(0xa34d721642b06084, 0x27f002d7f95d0190),
+  POWER(0xcc20ce9bd35c78a5, 0x31ec038df7b441f4),
+  POWER(0xff290242c83396ce, 0x7e67047175a15271),
+  POWER(0x9f79a169bd203e41, 0x0f0062c6e984d386),
+  POWER(0xc75809c42c684dd1, 0x52c07b78a3e60868),
+  POWER(0xf92e0c3537826145, 0xa7709a56ccdf8a82),
+  POWER(0x9bbcc7a142b17ccb, 0x88a66076400bb691),
+  POWER(0xc2abf989935ddbfe, 0x6acff893d00ea435),
+  POWER(0xf356f7ebf83552fe, 0x0583f6b8c4124d43),
+  POWER(0x98165af37b2153de, 0xc3727a337a8b704a),
+  POWER(0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c),
+  POWER(0xeda2ee1c7064130c, 0x1162def06f79df73),
+  POWER(0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8),
+  POWER(0xb9a74a0637ce2ee1, 0x6d953e2bd7173692),
+  POWER(0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437),
+  POWER(0x910ab1d4db9914a0, 0x1d9c9892400a22a2),
+  POWER(0xb54d5e4a127f59c8, 0x2503beb6d00cab4b),
+  POWER(0xe2a0b5dc971f303a, 0x2e44ae64840fd61d),
+  POWER(0x8da471a9de737e24, 0x5ceaecfed289e5d2),
+  POWER(0xb10d8e1456105dad, 0x7425a83e872c5f47),
+  POWER(0xdd50f1996b947518, 0xd12f124e28f77719),
+  POWER(0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f),
+  POWER(0xace73cbfdc0bfb7b, 0x636cc64d1001550b),
+  POWER(0xd8210befd30efa5a, 0x3c47f7e05401aa4e),
+  POWER(0x8714a775e3e95c78, 0x65acfaec34810a71),
+  POWER(0xa8d9d1535ce3b396, 0x7f1839a741a14d0d),
+  POWER(0xd31045a8341ca07c, 0x1ede48111209a050),
+  POWER(0x83ea2b892091e44d, 0x934aed0aab460432),
+  POWER(0xa4e4b66b68b65d60, 0xf81da84d5617853f),
+  POWER(0xce1de40642e3f4b9, 0x36251260ab9d668e),
+  POWER(0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019),
+  POWER(0xa1075a24e4421730, 0xb24cf65b8612f81f),
+  POWER(0xc94930ae1d529cfc, 0xdee033f26797b627),
+  POWER(0xfb9b7cd9a4a7443c, 0x169840ef017da3b1),
+  POWER(0x9d412e0806e88aa5, 0x8e1f289560ee864e),
+  POWER(0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2),
+  POWER(0xf5b5d7ec8acb58a2, 0xae10af696774b1db),
+  POWER(0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29),
+  POWER(0xbff610b0cc6edd3f, 0x17fd090a58d32af3),
+  POWER(0xeff394dcff8a948e, 0xddfc4b4cef07f5b0),
+  POWER(0x95f83d0a1fb69cd9, 0x4abdaf101564f98e),
+  POWER(0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1),
+  POWER(0xea53df5fd18d5513, 0x84c86189216dc5ed),
+  POWER(0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4),
+  POWER(0xb7118682dbb66a77, 0x3fbc8c33221dc2a1),
+  POWER(0xe4d5e82392a40515, 0x0fabaf3feaa5334a),
+  POWER(0x8f05b1163ba6832d, 0x29cb4d87f2a7400e),
+  POWER(0xb2c71d5bca9023f8, 0x743e20e9ef511012),
+  POWER(0xdf78e4b2bd342cf6, 0x914da9246b255416),
+  POWER(0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e),
+  POWER(0xae9672aba3d0c320, 0xa184ac2473b529b1),
+  POWER(0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e),
+  POWER(0x8865899617fb1871, 0x7e2fa67c7a658892),
+  POWER(0xaa7eebfb9df9de8d, 0xddbb901b98feeab7),
+  POWER(0xd51ea6fa85785631, 0x552a74227f3ea565),
+  POWER(0x8533285c936b35de, 0xd53a88958f87275f),
+  POWER(0xa67ff273b8460356, 0x8a892abaf368f137),
+  POWER(0xd01fef10a657842c, 0x2d2b7569b0432d85),
+  POWER(0x8213f56a67f6b29b, 0x9c3b29620e29fc73),
+  POWER(0xa298f2c501f45f42, 0x8349f3ba91b47b8f),
+  POWER(0xcb3f2f7642717713, 0x241c70a936219a73),
+  POWER(0xfe0efb53d30dd4d7, 0xed238cd383aa0110),
+  POWER(0x9ec95d1463e8a506, 0xf4363804324a40aa),
+  POWER(0xc67bb4597ce2ce48, 0xb143c6053edcd0d5),
+  POWER(0xf81aa16fdc1b81da, 0xdd94b7868e94050a),
+  POWER(0x9b10a4e5e9913128, 0xca7cf2b4191c8326),
+  POWER(0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0),
+  POWER(0xf24a01a73cf2dccf, 0xbc633b39673c8cec),
+  POWER(0x976e41088617ca01, 0xd5be0503e085d813),
+  POWER(0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18),
+  POWER(0xec9c459d51852ba2, 0xddf8e7d60ed1219e),
+  POWER(0x93e1ab8252f33b45, 0xcabb90e5c942b503),
+  POWER(0xb8da1662e7b00a17, 0x3d6a751f3b936243),
+  POWER(0xe7109bfba19c0c9d, 0x0cc512670a783ad4),
+  POWER(0x906a617d450187e2, 0x27fb2b80668b24c5),
+  POWER(0xb484f9dc9641e9da, 0xb1f9f660802dedf6),
+  POWER(0xe1a63853bbd26451, 0x5e7873f8a0396973),
+  POWER(0x8d07e33455637eb2, 0xdb0b487b6423e1e8),
+  POWER(0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62),
+  POWER(0xdc5c5301c56b75f7, 0x7641a140cc7810fb),
+  POWER(0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d),
+  POWER(0xac2820d9623bf429, 0x546345fa9fbdcd44),
+  POWER(0xd732290fbacaf133, 0xa97c177947ad4095),
+  POWER(0x867f59a9d4bed6c0, 0x49ed8eabcccc485d),
+  POWER(0xa81f301449ee8c70, 0x5c68f256bfff5a74),
+  POWER(0xd226fc195c6a2f8c, 0x73832eec6fff3111),
+  POWER(0x83585d8fd9c25db7, 0xc831fd53c5ff7eab),
+  POWER(0xa42e74f3d032f525, 0xba3e7ca8b77f5e55),
+  POWER(0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb),
+  POWER(0x80444b5e7aa7cf85, 0x7980d163cf5b81b3),
+  POWER(0xa0555e361951c366, 0xd7e105bcc332621f),
+  POWER(0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7),
+  POWER(0xfa856334878fc150, 0xb14f98f6f0feb951),
+  POWER(0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3),
+  POWER(0xc3b8358109e84f07, 0x0a862f80ec4700c8),
+  POWER(0xf4a642e14c6262c8, 0xcd27bb612758c0fa),
+  POWER(0x98e7e9cccfbd7dbd, 0x8038d51cb897789c),
+  POWER(0xbf21e44003acdd2c, 0xe0470a63e6bd56c3),
+  POWER(0xeeea5d5004981478, 0x1858ccfce06cac74),
+  POWER(0x95527a5202df0ccb, 0x0f37801e0c43ebc8),
+  POWER(0xbaa718e68396cffd, 0xd30560258f54e6ba),
+  POWER(0xe950df20247c83fd, 0x47c6b82ef32a2069),
+  POWER(0x91d28b7416cdd27e, 0x4cdc331d57fa5441),
+  POWER(0xb6472e511c81471d, 0xe0133fe4adf8e952),
+  POWER(0xe3d8f9e563a198e5, 0x58180fddd97723a6),
+  POWER(0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648),
+};
 
-  float parsed_value;
-  if (!safe_strtof(buffer, &parsed_value) || parsed_value != value) {
-    int snprintf_result =
-      snprintf(buffer, kFloatToBufferSize, "%.*g", FLT_DIG+2, value);
+#undef POWER
+
+const int kSmallestPowerOfFive = -342;
+const int kLargestPowerOfTen = 308;
+
+const uint64 kDoubleInfinityBits = GOOGLE_ULONGLONG(0x7FF0000000000000);
+
+// Sets *high and *low to the 128-bit product of x and y.
+inline void FullMultiply(uint64 x, uint64 y, uint64* high, uint64* low) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 product = static_cast<unsigned __int128>(x) * y;
+  *high = static_cast<uint64>(product >> 64);
+  *low = static_cast<uint64>(product);
+#else
+  const uint64 kMask32 = 0xFFFFFFFFu;
+  uint64 a = x >> 32;
+  uint64 b = x & kMask32;
+  uint64 c = y >> 32;
+  uint64 d = y & kMask32;
+  uint64 bd = b * d;
+  uint64 middle = (bd >> 32) + ((a * d) & kMask32) + b * c;
+  *high = a * c + ((a * d) >> 32) + (middle >> 32);
+  *low = (middle << 32) | (bd & kMask32);
+#endif
+}
 
-    // Should never overflow; see above.
-    GOOGLE_DCHECK(snprintf_result > 0 && snprintf_result < kFloatToBufferSize);
+inline int CountLeadingZeros64(uint64 x) {
+#if defined(__GNUC__)
+  return __builtin_clzll(x);
+#else
+  int count = 0;
+  while ((x & GOOGLE_ULONGLONG(0x8000000000000000)) == 0) {
+    x <<= 1;
+    ++count;
   }
+  return count;
+#endif
+}
 
-  DelocalizeRadix(buffer);
-  return buffer;
+// Sets *bits to the IEEE-754 representation of w * 10^q, correctly rounded,
+// and returns true, or returns false if the result can't be decided without
+// more precision.  w must be non-zero.
+bool EiselLemire(uint64 w, int q, uint64* bits) {
+  if (q < kSmallestPowerOfFive) {
+    // w < 10^19, so w * 10^q < 10^-323, which rounds to zero.
+    *bits = 0;
+    return true;
+  }
+  if (q > kLargestPowerOfTen) {
+    *bits = kDoubleInfinityBits;
+    return true;
+  }
+
+  int leading_zeros = CountLeadingZeros64(w);
+  w <<= leading_zeros;
+
+  // We need the top 55 bits of the product (52 fraction bits, the implicit
+  // bit, one to tell where the top bit is and one for rounding).  If the
+  // bits below those are all ones a carry from the truncated part of 5^q
+  // could change them, so bring in the next 64 bits of 5^q.
+  const uint64* power = kPowersOfFive[q - kSmallestPowerOfFive];
+  uint64 high, low;
+  FullMultiply(w, power[0], &high, &low);
+  const uint64 kPrecisionMask = 0x1FF;
+  if ((high & kPrecisionMask) == kPrecisionMask) {
+    uint64 second_high, second_low;
+    FullMultiply(w, power[1], &second_high, &second_low);
+    low += second_high;
+    if (second_high > low) ++high;
+  }
+  if (low == ~static_cast<uint64>(0) && (q < -27 || q > 55)) {
+    // Still undecided.  (For -27 <= q <= 55 the table entry is exact, or
+    // exact enough, and this can't happen.)
+    return false;
+  }
+
+  int upper_bit = static_cast<int>(high >> 63);
+  uint64 mantissa = high >> (upper_bit + 9);
+  // floor(log2(10^q)) + 63, plus the exponent bias.
+  int binary_exponent = (((152170 + 65536) * q) >> 16) + 63 + upper_bit -
+                        leading_zeros + 1023;
+
+  if (binary_exponent <= 0) {
+    // Subnormal (or zero).
+    if (-binary_exponent + 1 >= 64) {
+      *bits = 0;
+      return true;
+    }
+    mantissa >>= -binary_exponent + 1;
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    // If rounding carried into bit 52, this is the smallest normal double,
+    // whose representation is exactly that.
+    *bits = mantissa;
+    return true;
+  }
+
+  // A product exactly halfway between two doubles must round to even, but
+  // can only occur for small q; above, "halfway" always rounds up.
+  if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 &&
+      (mantissa << (upper_bit + 9)) == high) {
+    mantissa &= ~static_cast<uint64>(1);
+  }
+  mantissa += mantissa & 1;
+  mantissa >>= 1;
+  if (mantissa >= (static_cast<uint64>(2) << 52)) {
+    mantissa = static_cast<uint64>(1) << 52;
+    ++binary_exponent;
+  }
+  mantissa &= ~(static_cast<uint64>(1) << 52);
+  if (binary_exponent >= 0x7FF) {
+    *bits = kDoubleInfinityBits;
+    return true;
+  }
+  *bits = mantissa | (static_cast<uint64>(binary_exponent) << 52);
+  return true;
+}
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#define GOOGLE_PROTOBUF_EXACT_DOUBLE_ARITHMETIC 1
+// Powers of ten which are exactly representable as doubles.
+const double kExactPowersOfTen[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+#endif
+
+inline bool IsDecimalDigit(char c) {
+  return '0' <= c && c <= '9';
+}
+
+}  // namespace
+
+const char* ParseDecimalDouble(const char* begin, const char* end,
+                               double* value) {
+  const char* ptr = begin;
+  bool negative = false;
+  if (ptr != end && (*ptr == '-' || *ptr == '+')) {
+    negative = *ptr == '-';
+    ++ptr;
+  }
+
+  // Collect up to 19 significant digits into w and adjust the exponent for
+  // the rest; remember whether any dropped digit was non-zero.
+  uint64 w = 0;
+  int significant_digits = 0;
+  int exponent = 0;
+  bool truncated = false;
+  bool saw_digits = false;
+  for (; ptr != end && IsDecimalDigit(*ptr); ++ptr) {
+    saw_digits = true;
+    int digit = *ptr - '0';
+    if (significant_digits < 19) {
+      w = w * 10 + digit;
+      if (w != 0) ++significant_digits;
+    } else {
+      ++exponent;
+      if (digit != 0) truncated = true;
+    }
+  }
+  if (ptr != end && *ptr == '.') {
+    ++ptr;
+    for (; ptr != end && IsDecimalDigit(*ptr); ++ptr) {
+      saw_digits = true;
+      int digit = *ptr - '0';
+      if (significant_digits < 19) {
+        w = w * 10 + digit;
+        if (w != 0) ++significant_digits;
+        --exponent;
+      } else if (digit != 0) {
+        truncated = true;
+      }
+    }
+  }
+  if (!saw_digits) {
+    *value = 0;
+    return begin;
+  }
+
+  if (ptr != end && (*ptr == 'e' || *ptr == 'E')) {
+    const char* exponent_ptr = ptr + 1;
+    bool negative_exponent = false;
+    if (exponent_ptr != end && (*exponent_ptr == '-' || *exponent_ptr == '+')) {
+      negative_exponent = *exponent_ptr == '-';
+      ++exponent_ptr;
+    }
+    // Like strtod(), leave an "e" which isn't followed by digits alone.
+    if (exponent_ptr != end && IsDecimalDigit(*exponent_ptr)) {
+      int explicit_exponent = 0;
+      for (; exponent_ptr != end && IsDecimalDigit(*exponent_ptr);
+           ++exponent_ptr) {
+        // Anything this big is zero or infinity anyway.
+        if (explicit_exponent < 100000) {
+          explicit_exponent = explicit_exponent * 10 + (*exponent_ptr - '0');
+        }
+      }
+      exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+      ptr = exponent_ptr;
+    }
+  }
+
+  double result;
+  uint64 bits;
+  if (w == 0) {
+    result = 0;
+#ifdef GOOGLE_PROTOBUF_EXACT_DOUBLE_ARITHMETIC
+  } else if (!truncated && w <= (static_cast<uint64>(1) << 53) &&
+             exponent >= -22 && exponent <= 22) {
+    // Both w and the power of ten are exact, so one IEEE operation rounds
+    // correctly.
+    result = static_cast<double>(static_cast<int64>(w));
+    if (exponent < 0) {
+      result /= kExactPowersOfTen[-exponent];
+    } else {
+      result *= kExactPowersOfTen[exponent];
+    }
+#endif
+  } else if (!truncated && EiselLemire(w, exponent, &bits)) {
+    memcpy(&result, &bits, sizeof(result));
+  } else {
+    // strtod() wants a NUL-terminated string.  The sign is handled below.
+    const char* digits_begin = negative || *begin == '+' ? begin + 1 : begin;
+    int length = ptr - digits_begin;
+    char buffer[128];
+    if (length < static_cast<int>(sizeof(buffer))) {
+      memcpy(buffer, digits_begin, length);
+      buffer[length] = '\0';
+      result = NoLocaleStrtod(buffer, NULL);
+    } else {
+      result = NoLocaleStrtod(std::string(digits_begin, length).c_str(),
+                              NULL);
+    }
+  }
+
+  *value = negative ? -result : result;
+  return ptr;
 }
 
 // ----------------------------------------------------------------------
@@ -418,8 +418,8 @@ LIBPROTOBUF_EXPORT std::string SimpleItoa(unsigned long long i);
 //    Description: converts a double or float to a string which, if
 //    passed to NoLocaleStrtod(), will produce the exact same original double
 //    (except in case of NaN; all NaNs are considered the same value).
-//    We try to keep the string short but it's not guaranteed to be as
-//    short as possible.
+//    The string has as few significant digits as possible, laid out the
+//    way printf("%g") would lay them out.
 //
 //    DoubleToBuffer() and FloatToBuffer() write the text to the given
 //    buffer and return it.  The buffer must be at least
@@ -449,6 +449,23 @@ static const int kFloatToBufferSize = 24;
 
 LIBPROTOBUF_EXPORT double NoLocaleStrtod(const char* text, char** endptr);
 
+// ----------------------------------------------------------------------
+// ParseDecimalDouble()
+//   Converts the decimal number at the start of [begin, end) to the
+//   nearest double, like NoLocaleStrtod(), but without needing a
+//   NUL-terminated string and, for all but unusual inputs, without
+//   allocating or calling into the C library.  Accepts an optional sign,
+//   digits with an optional decimal point and an optional exponent;
+//   hexadecimal, "inf" and "nan" are not recognized.
+//
+//   Returns a pointer just past the last character used, or begin (with
+//   *value set to zero) if there is no number there.
+// ----------------------------------------------------------------------
+
+LIBPROTOBUF_EXPORT const char* ParseDecimalDouble(const char* begin,
+                                                  const char* end,
+                                                  double* value);
+
 }  // namespace protobuf
 }  // namespace google
 
@@ -35,6 +35,10 @@
 #include <google/protobuf/testing/googletest.h>
 #include <gtest/gtest.h>
 #include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits>
 
 namespace google {
 namespace protobuf {
@@ -78,6 +82,243 @@ TEST(StringUtilityTest, ImmuneToLocales) {
   setlocale(LC_NUMERIC, old_locale.c_str());
 }
 
+TEST(StringUtilityTest, SimpleDtoa) {
+  EXPECT_EQ("0", SimpleDtoa(0.0));
+  EXPECT_EQ("-0", SimpleDtoa(-0.0));
+  EXPECT_EQ("1", SimpleDtoa(1.0));
+  EXPECT_EQ("-1.5", SimpleDtoa(-1.5));
+  EXPECT_EQ("0.1", SimpleDtoa(0.1));
+  EXPECT_EQ("0.30000000000000004", SimpleDtoa(0.1 + 0.2));
+  EXPECT_EQ("123456", SimpleDtoa(123456.0));
+  EXPECT_EQ("100000000000000", SimpleDtoa(1e14));
+  EXPECT_EQ("1e+15", SimpleDtoa(1e15));
+  EXPECT_EQ("0.0001", SimpleDtoa(1e-4));
+  EXPECT_EQ("1.5e-05", SimpleDtoa(1.5e-5));
+  EXPECT_EQ("1e+100", SimpleDtoa(1e100));
+  EXPECT_EQ("1.7976931348623157e+308",
+            SimpleDtoa(std::numeric_limits<double>::max()));
+  EXPECT_EQ("2.2250738585072014e-308",
+            SimpleDtoa(std::numeric_limits<double>::min()));
+  // The old snprintf()-based code printed "4.94065645841247e-324".
+  EXPECT_EQ("5e-324", SimpleDtoa(std::numeric_limits<double>::denorm_min()));
+  EXPECT_EQ("inf", SimpleDtoa(std::numeric_limits<double>::infinity()));
+  EXPECT_EQ("-inf", SimpleDtoa(-std::numeric_limits<double>::infinity()));
+  EXPECT_EQ("nan", SimpleDtoa(std::numeric_limits<double>::quiet_NaN()));
+}
+
+TEST(StringUtilityTest, SimpleFtoa) {
+  EXPECT_EQ("0", SimpleFtoa(0.0f));
+  EXPECT_EQ("-0", SimpleFtoa(-0.0f));
+  EXPECT_EQ("0.1", SimpleFtoa(0.1f));
+  EXPECT_EQ("16777216", SimpleFtoa(16777216.0f));
+  EXPECT_EQ("1e+07", SimpleFtoa(1e7f));
+  EXPECT_EQ("1.5e-05", SimpleFtoa(1.5e-5f));
+  EXPECT_EQ("3.4028235e+38", SimpleFtoa(std::numeric_limits<float>::max()));
+  EXPECT_EQ("1e-45", SimpleFtoa(std::numeric_limits<float>::denorm_min()));
+  EXPECT_EQ("inf", SimpleFtoa(std::numeric_limits<float>::infinity()));
+  EXPECT_EQ("nan", SimpleFtoa(std::numeric_limits<float>::quiet_NaN()));
+
+  // "7.038531e-26" is the shortest text strtof() reads as this value, but
+  // read as a double and then narrowed it gives the next float up.
+  uint32 bits = 363742205;
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  EXPECT_EQ("7.0385307e-26", SimpleFtoa(value));
+}
+
+// Returns the number of significant digits in text printed by SimpleDtoa()
+// or SimpleFtoa().
+int CountSignificantDigits(const std::string& text) {
+  int count = 0;
+  bool leading = true;
+  for (int i = 0; i < text.size() && text[i] != 'e'; i++) {
+    if (text[i] == '0' && leading) continue;
+    if ('0' <= text[i] && text[i] <= '9') {
+      leading = false;
+      ++count;
+    }
+  }
+  // Trailing zeros before the decimal point ("1200") aren't significant.
+  if (text.find_first_of(".e") == std::string::npos) {
+    for (int i = text.size() - 1; i > 0 && text[i] == '0'; i--) --count;
+  }
+  return count;
+}
+
+// Checks that SimpleFtoa(value) reads back as value and that no shorter
+// text would.
+void ExpectFloatRoundTrip(uint32 bits, bool check_shortest) {
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  if (value != value || value == std::numeric_limits<float>::infinity() ||
+      value == -std::numeric_limits<float>::infinity()) {
+    return;
+  }
+
+  // Both strtof() and the way the text format parser reads floats (as a
+  // double, then narrowed) must give back the value.
+  std::string text = SimpleFtoa(value);
+  float parsed = static_cast<float>(NoLocaleStrtod(text.c_str(), NULL));
+  ASSERT_EQ(bits, *reinterpret_cast<uint32*>(&parsed))
+      << text << " for bits " << bits;
+#if !defined(_WIN32) && !defined(__hpux)  // has no strtof(); see safe_strtof()
+  parsed = strtof(text.c_str(), NULL);
+  ASSERT_EQ(bits, *reinterpret_cast<uint32*>(&parsed))
+      << text << " for bits " << bits;
+#endif
+
+  if (check_shortest && value != 0) {
+    int digits = CountSignificantDigits(text);
+    if (digits > 1) {
+      char shorter[64];
+      snprintf(shorter, sizeof(shorter), "%.*e", digits - 2, value);
+      EXPECT_NE(value, static_cast<float>(NoLocaleStrtod(shorter, NULL)))
+          << text << " could be " << shorter;
+    }
+  }
+}
+
+TEST(StringUtilityTest, FloatRoundTrip) {
+  // Every float takes over half an hour; a prime stride still hits every
+  // exponent and plenty of significands.  See FloatRoundTripEverySignificand.
+  for (uint64 bits = 0; bits <= 0xFFFFFFFFu; bits += 4099) {
+    ExpectFloatRoundTrip(static_cast<uint32>(bits), true);
+  }
+  // Powers of two and their neighbours, where the interval is lopsided.
+  for (uint32 exponent = 0; exponent < 0xFF; exponent++) {
+    for (int delta = -1; delta <= 1; delta++) {
+      ExpectFloatRoundTrip((exponent << 23) + delta, true);
+    }
+  }
+}
+
+TEST(StringUtilityTest, FloatRoundTripEverySignificand) {
+  // Checking all 2^32 floats takes too long for every run; check every
+  // significand with the exponent of 7.0385307e-26 (see the SimpleFtoa
+  // test), whose neighbours double rounding is known to trip over.
+  for (uint32 significand = 0; significand < (1u << 23); significand++) {
+    ExpectFloatRoundTrip((43u << 23) | significand, false);
+  }
+}
+
+TEST(StringUtilityTest, DoubleRoundTrip) {
+  uint64 bits = 1;
+  for (int i = 0; i < 1000000; i++) {
+    // Any cheap generator that reaches every exponent will do.
+    bits = bits * GOOGLE_ULONGLONG(6364136223846793005) +
+           GOOGLE_ULONGLONG(1442695040888963407);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    if (value != value) continue;
+
+    std::string text = SimpleDtoa(value);
+    volatile double parsed = NoLocaleStrtod(text.c_str(), NULL);
+    ASSERT_EQ(value, parsed) << text;
+
+    int digits = CountSignificantDigits(text);
+    if (i % 16 == 0 && value != 0 && digits > 1 && digits < 20) {
+      char shorter[64];
+      snprintf(shorter, sizeof(shorter), "%.*e", digits - 2, value);
+      volatile double parsed_shorter = NoLocaleStrtod(shorter, NULL);
+      EXPECT_NE(value, parsed_shorter) << text << " could be " << shorter;
+    }
+  }
+}
+
+// Parses text with ParseDecimalDouble() and checks that all of it was used.
+double ParseAll(const std::string& text) {
+  double value;
+  const char* end = ParseDecimalDouble(text.data(), text.data() + text.size(),
+                                       &value);
+  EXPECT_EQ(text.size(), end - text.data()) << text;
+  return value;
+}
+
+uint64 DoubleBits(double value) {
+  uint64 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+TEST(StringUtilityTest, ParseDecimalDouble) {
+  EXPECT_EQ(1.5, ParseAll("1.5"));
+  EXPECT_EQ(0.5, ParseAll(".5"));
+  EXPECT_EQ(5.0, ParseAll("5."));
+  EXPECT_EQ(-2.5, ParseAll("-25e-1"));
+  EXPECT_EQ(2500.0, ParseAll("+25E+2"));
+  EXPECT_EQ(0.1, ParseAll("0.1"));
+  EXPECT_EQ(1e23, ParseAll("1e23"));
+  EXPECT_EQ(123.0, ParseAll("000123"));
+  EXPECT_EQ(0.000123, ParseAll("0.000123"));
+  EXPECT_EQ(DoubleBits(-0.0), DoubleBits(ParseAll("-0.0")));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), ParseAll("1e400"));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), ParseAll("1e99999999"));
+  EXPECT_EQ(0.0, ParseAll("1e-400"));
+  EXPECT_EQ(std::numeric_limits<double>::denorm_min(), ParseAll("5e-324"));
+  EXPECT_EQ(0.0, ParseAll("2.4703282292062327e-324"));
+  EXPECT_EQ(std::numeric_limits<double>::denorm_min(),
+            ParseAll("2.4703282292062328e-324"));
+  EXPECT_EQ(std::numeric_limits<double>::min(),
+            ParseAll("2.2250738585072014e-308"));
+  EXPECT_EQ(std::numeric_limits<double>::max(),
+            ParseAll("1.7976931348623157e308"));
+  // Halfway between two doubles:  round to even.
+  EXPECT_EQ(9007199254740992.0, ParseAll("9007199254740993"));
+  EXPECT_EQ(9007199254740996.0, ParseAll("9007199254740995"));
+  // More than 19 significant digits.
+  EXPECT_EQ(9007199254740994.0, ParseAll("9007199254740993.0000000000001"));
+  EXPECT_EQ(1.0, ParseAll("1.00000000000000000000000000000000000000001"));
+  EXPECT_EQ(1e30, ParseAll("1000000000000000000000000000000"));
+
+  // Trailing text is left alone, as is an exponent without digits.
+  const char* text = "1.5f";
+  double value;
+  EXPECT_EQ(text + 3, ParseDecimalDouble(text, text + 4, &value));
+  EXPECT_EQ(1.5, value);
+  text = "2e+";
+  EXPECT_EQ(text + 1, ParseDecimalDouble(text, text + 3, &value));
+  EXPECT_EQ(2.0, value);
+  // The end of the range is respected.
+  text = "12345";
+  EXPECT_EQ(text + 2, ParseDecimalDouble(text, text + 2, &value));
+  EXPECT_EQ(12.0, value);
+
+  // No number.
+  text = ".e1";
+  EXPECT_EQ(text, ParseDecimalDouble(text, text + 3, &value));
+  EXPECT_EQ(0.0, value);
+  EXPECT_EQ(text, ParseDecimalDouble(text, text, &value));
+}
+
+TEST(StringUtilityTest, ParseDecimalDoubleMatchesStrtod) {
+  uint64 bits = 1;
+  char text[64];
+  for (int i = 0; i < 300000; i++) {
+    bits = bits * GOOGLE_ULONGLONG(6364136223846793005) +
+           GOOGLE_ULONGLONG(1442695040888963407);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    if (value != value || value == std::numeric_limits<double>::infinity() ||
+        value == -std::numeric_limits<double>::infinity()) {
+      continue;
+    }
+
+    // Print with 1 to 25 digits, so that most inputs aren't exact and
+    // some need more than 19 digits.
+    snprintf(text, sizeof(text), "%.*e", static_cast<int>(i % 25), value);
+    ASSERT_EQ(DoubleBits(NoLocaleStrtod(text, NULL)),
+              DoubleBits(ParseAll(text))) << text;
+
+    // Arbitrary digits and exponents, including ones near the subnormal
+    // range and near overflow.
+    snprintf(text, sizeof(text), "%llue%d",
+             static_cast<unsigned long long>(bits >> (i % 40)),
+             static_cast<int>(bits % 700) - 350);
+    ASSERT_EQ(DoubleBits(NoLocaleStrtod(text, NULL)),
+              DoubleBits(ParseAll(text))) << text;
+  }
+}
+
 }  // anonymous namespace
 }  // namespace protobuf
 }  // namespace google
@@ -35,6 +35,7 @@
 #include <float.h>
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 #include <stack>
 #include <limits>
 #include <vector>
@@ -49,6 +50,7 @@
 #include <google/protobuf/descriptor.pb.h>
 #include <google/protobuf/io/tokenizer.h>
 #include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
 
 namespace google {
 namespace protobuf {
@@ -127,6 +129,10 @@ class TextFormat::Parser::ParserImpl {
       tokenizer_(input_stream, &tokenizer_error_collector_),
       root_message_type_(root_message_type),
       singular_overwrite_policy_(singular_overwrite_policy),
+      streamed_message_(NULL),
+      streamed_field_(NULL),
+      element_callback_(NULL),
+      check_streamed_elements_(false),
       had_errors_(false) {
     // For backwards-compatibility with proto1, we need to allow the 'f' suffix
     // for floats.
@@ -135,11 +141,26 @@ class TextFormat::Parser::ParserImpl {
     // '#' starts a comment.
     tokenizer_.set_comment_style(io::Tokenizer::SH_COMMENT_STYLE);
 
+    // Token text is only read through current_text().
+    tokenizer_.set_copy_token_text(false);
+
     // Consume the starting token.
     tokenizer_.Next();
   }
   ~ParserImpl() { }
 
+  // Hands each value of the given repeated message field of message to
+  // callback instead of keeping it.  If check_initialized is true, values
+  // missing required fields are reported as errors.
+  void StreamField(Message* message, const FieldDescriptor* field,
+                   TextFormat::ElementCallback* callback,
+                   bool check_initialized) {
+    streamed_message_ = message;
+    streamed_field_ = field;
+    element_callback_ = callback;
+    check_streamed_elements_ = check_initialized;
+  }
+
   // Parses the ASCII representation specified in input and saves the
   // information into the output pointer (a Message). Returns
   // false if an error occurs (an error will also be logged to
@@ -220,7 +241,7 @@ class TextFormat::Parser::ParserImpl {
   // Consumes the specified message with the given starting delimeter.
   // This method checks to see that the end delimeter at the conclusion of
   // the consumption matches the starting delimeter passed in here.
-  bool ConsumeMessage(Message* message, const std::string delimeter) {
+  bool ConsumeMessage(Message* message, const char* delimeter) {
     while (!LookingAt(">") &&  !LookingAt("}")) {
       DO(ConsumeField(message));
     }
@@ -335,7 +356,11 @@ class TextFormat::Parser::ParserImpl {
   bool ConsumeFieldMessage(Message* message,
                            const Reflection* reflection,
                            const FieldDescriptor* field) {
-    std::string delimeter;
+    if (field == streamed_field_ && message == streamed_message_) {
+      return ConsumeStreamedElement(message, reflection, field);
+    }
+
+    const char* delimeter;
     if (TryConsume("<")) {
       delimeter = ">";
     } else {
@@ -352,6 +377,38 @@ class TextFormat::Parser::ParserImpl {
     return true;
   }
 
+  // Parses one value of the streamed field into the field's last element,
+  // passes it to the callback and removes it again.  RemoveLast() keeps the
+  // cleared element, so the next value reuses it and its allocations.
+  bool ConsumeStreamedElement(Message* message,
+                              const Reflection* reflection,
+                              const FieldDescriptor* field) {
+    int line = tokenizer_.current().line;
+    int column = tokenizer_.current().column;
+    const char* delimeter;
+    if (TryConsume("<")) {
+      delimeter = ">";
+    } else {
+      DO(Consume("{"));
+      delimeter = "}";
+    }
+
+    Message* element = reflection->AddMessage(message, field);
+    bool success = ConsumeMessage(element, delimeter);
+    if (success && check_streamed_elements_ && !element->IsInitialized()) {
+      std::vector<std::string> missing_fields;
+      element->FindInitializationErrors(&missing_fields);
+      ReportError(line, column, "Message missing required fields: " +
+                                JoinStrings(missing_fields, ", "));
+      success = false;
+    }
+    if (success) {
+      success = element_callback_->OnElement(element);
+    }
+    reflection->RemoveLast(message, field);
+    return success;
+  }
+
   bool ConsumeFieldValue(Message* message,
                          const Reflection* reflection,
                          const FieldDescriptor* field) {
@@ -480,8 +537,16 @@ class TextFormat::Parser::ParserImpl {
   }
 
   // Returns true if the current token's text is equal to that specified.
-  bool LookingAt(const std::string& text) {
-    return tokenizer_.current().text == text;
+  bool LookingAt(const char* text) {
+    int size = tokenizer_.current_text_size();
+    return strncmp(tokenizer_.current_text(), text, size) == 0 &&
+           text[size] == '\0';
+  }
+
+  // Returns a copy of the current token's text, for error messages.
+  std::string CurrentText() {
+    return std::string(tokenizer_.current_text(),
+                       tokenizer_.current_text_size());
   }
 
   // Returns true if the current token's type is equal to that specified.
@@ -497,7 +562,8 @@ class TextFormat::Parser::ParserImpl {
       return false;
     }
 
-    *identifier = tokenizer_.current().text;
+    identifier->assign(tokenizer_.current_text(),
+                       tokenizer_.current_text_size());
 
     tokenizer_.Next();
     return true;
@@ -513,7 +579,9 @@ class TextFormat::Parser::ParserImpl {
 
     text->clear();
     while (LookingAtType(io::Tokenizer::TYPE_STRING)) {
-      io::Tokenizer::ParseStringAppend(tokenizer_.current().text, text);
+      io::Tokenizer::ParseStringAppend(
+          tokenizer_.current_text(),
+          tokenizer_.current_text() + tokenizer_.current_text_size(), text);
 
       tokenizer_.Next();
     }
@@ -529,8 +597,10 @@ class TextFormat::Parser::ParserImpl {
       return false;
     }
 
-    if (!io::Tokenizer::ParseInteger(tokenizer_.current().text,
-                                     max_value, value)) {
+    if (!io::Tokenizer::ParseInteger(
+            tokenizer_.current_text(),
+            tokenizer_.current_text() + tokenizer_.current_text_size(),
+            max_value, value)) {
       ReportError("Integer out of range.");
       return false;
     }
@@ -589,12 +659,14 @@ class TextFormat::Parser::ParserImpl {
       *value = static_cast<double>(integer_value);
     } else if (LookingAtType(io::Tokenizer::TYPE_FLOAT)) {
       // We have found a float value for the double.
-      *value = io::Tokenizer::ParseFloat(tokenizer_.current().text);
+      *value = io::Tokenizer::ParseFloat(
+          tokenizer_.current_text(),
+          tokenizer_.current_text() + tokenizer_.current_text_size());
 
       // Mark the current token as consumed.
       tokenizer_.Next();
     } else if (LookingAtType(io::Tokenizer::TYPE_IDENTIFIER)) {
-      std::string text = tokenizer_.current().text;
+      std::string text = CurrentText();
       LowerString(&text);
       if (text == "inf" || text == "infinity") {
         *value = std::numeric_limits<double>::infinity();
@@ -621,12 +693,10 @@ class TextFormat::Parser::ParserImpl {
   // Consumes a token and confirms that it matches that specified in the
   // value parameter. Returns false if the token found does not match that
   // which was specified.
-  bool Consume(const std::string& value) {
-    const std::string& current_value = tokenizer_.current().text;
-
-    if (current_value != value) {
-      ReportError("Expected \"" + value + "\", found \"" + current_value
-                  + "\".");
+  bool Consume(const char* value) {
+    if (!LookingAt(value)) {
+      ReportError("Expected \"" + std::string(value) + "\", found \"" +
+                  CurrentText() + "\".");
       return false;
     }
 
@@ -637,8 +707,8 @@ class TextFormat::Parser::ParserImpl {
 
   // Attempts to consume the supplied value. Returns false if a the
   // token found does not match the value specified.
-  bool TryConsume(const std::string& value) {
-    if (tokenizer_.current().text == value) {
+  bool TryConsume(const char* value) {
+    if (LookingAt(value)) {
       tokenizer_.Next();
       return true;
     } else {
@@ -674,6 +744,10 @@ class TextFormat::Parser::ParserImpl {
   io::Tokenizer tokenizer_;
   const Descriptor* root_message_type_;
   SingularOverwritePolicy singular_overwrite_policy_;
+  Message* streamed_message_;
+  const FieldDescriptor* streamed_field_;
+  TextFormat::ElementCallback* element_callback_;
+  bool check_streamed_elements_;
   bool had_errors_;
 };
 
@@ -692,7 +766,8 @@ class TextFormat::Printer::TextGenerator {
       at_start_of_line_(true),
       failed_(false),
       indent_(""),
-      initial_indent_level_(initial_indent_level) {
+      initial_indent_level_(initial_indent_level),
+      field_list_depth_(0) {
     indent_.resize(initial_indent_level_ * 2, ' ');
   }
 
@@ -702,6 +777,7 @@ class TextFormat::Printer::TextGenerator {
     if (buffer_size_ > 0) {
       output_->BackUp(buffer_size_);
     }
+    STLDeleteElements(&field_lists_);
   }
 
   // Indent text by two spaces.  After calling Indent(), two spaces will be
@@ -754,6 +830,101 @@ class TextFormat::Printer::TextGenerator {
     Write(text + pos, size - pos);
   }
 
+  // Print text which cannot contain newlines, such as names, without
+  // looking for them.
+  void PrintRaw(const std::string& text) {
+    Write(text.data(), text.size());
+  }
+  void PrintRaw(const char* text, int size) {
+    Write(text, size);
+  }
+
+  // Print numbers.  When the output buffer has room they are formatted
+  // straight into it.
+  void PrintNumber(int32 value) {
+    char scratch[kFastToBufferSize];
+    char* begin = BeginFormat(kFastToBufferSize, scratch);
+    EndFormat(begin, FastInt32ToBufferLeft(value, begin));
+  }
+  void PrintNumber(int64 value) {
+    char scratch[kFastToBufferSize];
+    char* begin = BeginFormat(kFastToBufferSize, scratch);
+    EndFormat(begin, FastInt64ToBufferLeft(value, begin));
+  }
+  void PrintNumber(uint32 value) {
+    char scratch[kFastToBufferSize];
+    char* begin = BeginFormat(kFastToBufferSize, scratch);
+    EndFormat(begin, FastUInt32ToBufferLeft(value, begin));
+  }
+  void PrintNumber(uint64 value) {
+    char scratch[kFastToBufferSize];
+    char* begin = BeginFormat(kFastToBufferSize, scratch);
+    EndFormat(begin, FastUInt64ToBufferLeft(value, begin));
+  }
+  void PrintNumber(float value) {
+    char scratch[kFloatToBufferSize];
+    char* begin = BeginFormat(kFloatToBufferSize, scratch);
+    FloatToBuffer(value, begin);
+    EndFormat(begin, begin + strlen(begin));
+  }
+  void PrintNumber(double value) {
+    char scratch[kDoubleToBufferSize];
+    char* begin = BeginFormat(kDoubleToBufferSize, scratch);
+    DoubleToBuffer(value, begin);
+    EndFormat(begin, begin + strlen(begin));
+  }
+
+  // Print text escaped the way CEscape() (or, if utf8_safe is true,
+  // strings::Utf8SafeCEscape()) would, a run of unescaped characters at a
+  // time.
+  void PrintEscaped(const std::string& text, bool utf8_safe) {
+    const char* data = text.data();
+    int size = text.size();
+    int start = 0;  // Start of the characters not yet written.
+    for (int i = 0; i < size; i++) {
+      const char* escape;
+      char octal_escape[4];
+      switch (data[i]) {
+        case '\n': escape = "\\n";  break;
+        case '\r': escape = "\\r";  break;
+        case '\t': escape = "\\t";  break;
+        case '\"': escape = "\\\""; break;
+        case '\'': escape = "\\'";  break;
+        case '\\': escape = "\\\\"; break;
+        default: {
+          uint8 c = static_cast<uint8>(data[i]);
+          if ((c >= 0x20 && c <= 0x7E) || (utf8_safe && c >= 0x80)) {
+            continue;
+          }
+          octal_escape[0] = '\\';
+          octal_escape[1] = '0' + (c >> 6);
+          octal_escape[2] = '0' + ((c >> 3) & 7);
+          octal_escape[3] = '0' + (c & 7);
+          Write(data + start, i - start);
+          Write(octal_escape, 4);
+          start = i + 1;
+          continue;
+        }
+      }
+      Write(data + start, i - start);
+      Write(escape, 2);
+      start = i + 1;
+    }
+    Write(data + start, size - start);
+  }
+
+  // Printer::Print() lists the fields of each message into one of these,
+  // one list per level of nesting, so that they can be reused.
+  std::vector<const FieldDescriptor*>* PushFieldList() {
+    if (field_list_depth_ == static_cast<int>(field_lists_.size())) {
+      field_lists_.push_back(new std::vector<const FieldDescriptor*>);
+    }
+    return field_lists_[field_list_depth_++];
+  }
+  void PopFieldList() {
+    --field_list_depth_;
+  }
+
   // True if any write to the underlying stream failed.  (We don't just
   // crash in this case because this is an I/O failure, not a programming
   // error.)
@@ -762,6 +933,26 @@ class TextFormat::Printer::TextGenerator {
  private:
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(TextGenerator);
 
+  // Returns where to format up to max_size bytes of text (including a
+  // terminating NUL) with no newlines:  the output buffer itself if it
+  // has room, otherwise scratch.  Pass the result and the end of the text
+  // to EndFormat().
+  char* BeginFormat(int max_size, char* scratch) {
+    if (at_start_of_line_ || failed_ || buffer_size_ < max_size) {
+      return scratch;
+    }
+    return buffer_;
+  }
+
+  void EndFormat(char* begin, char* end) {
+    if (begin == buffer_) {
+      buffer_ += end - begin;
+      buffer_size_ -= end - begin;
+    } else {
+      Write(begin, end - begin);
+    }
+  }
+
   void Write(const char* data, int size) {
     if (failed_) return;
     if (size == 0) return;
@@ -799,6 +990,9 @@ class TextFormat::Printer::TextGenerator {
 
   std::string indent_;
   int initial_indent_level_;
+
+  std::vector<std::vector<const FieldDescriptor*>*> field_lists_;
+  int field_list_depth_;
 };
 
 // ===========================================================================
@@ -806,6 +1000,9 @@ class TextFormat::Printer::TextGenerator {
 TextFormat::Finder::~Finder() {
 }
 
+TextFormat::ElementCallback::~ElementCallback() {
+}
+
 TextFormat::Parser::Parser()
   : error_collector_(NULL),
     finder_(NULL),
@@ -828,6 +1025,26 @@ bool TextFormat::Parser::ParseFromString(const std::string& input,
   return Parse(&input_stream, output);
 }
 
+bool TextFormat::Parser::ParseStreaming(io::ZeroCopyInputStream* input,
+                                        const FieldDescriptor* field,
+                                        ElementCallback* callback,
+                                        Message* output) {
+  if (field->containing_type() != output->GetDescriptor() ||
+      !field->is_repeated() ||
+      field->cpp_type() != FieldDescriptor::CPPTYPE_MESSAGE) {
+    GOOGLE_LOG(DFATAL) << "ParseStreaming() needs a repeated message field of "
+                       << output->GetDescriptor()->full_name() << ", not "
+                       << field->full_name() << ".";
+    return false;
+  }
+
+  output->Clear();
+  ParserImpl parser(output->GetDescriptor(), input, error_collector_,
+                    finder_, ParserImpl::FORBID_SINGULAR_OVERWRITES);
+  parser.StreamField(output, field, callback, !allow_partial_);
+  return MergeUsingImpl(input, output, &parser);
+}
+
 bool TextFormat::Parser::Merge(io::ZeroCopyInputStream* input,
                                Message* output) {
   ParserImpl parser(output->GetDescriptor(), input, error_collector_,
@@ -941,11 +1158,14 @@ bool TextFormat::Printer::PrintUnknownFields(
 void TextFormat::Printer::Print(const Message& message,
                                 TextGenerator& generator) const {
   const Reflection* reflection = message.GetReflection();
-  std::vector<const FieldDescriptor*> fields;
-  reflection->ListFields(message, &fields);
-  for (int i = 0; i < fields.size(); i++) {
-    PrintField(message, reflection, fields[i], generator);
+  std::vector<const FieldDescriptor*>* fields = generator.PushFieldList();
+  fields->clear();
+  fields->reserve(message.GetDescriptor()->field_count());
+  reflection->ListFields(message, fields);
+  for (int i = 0; i < fields->size(); i++) {
+    PrintField(message, reflection, (*fields)[i], generator);
   }
+  generator.PopFieldList();
   PrintUnknownFields(reflection->GetUnknownFields(message), generator);
 }
 
@@ -1055,17 +1275,17 @@ void TextFormat::Printer::PrintFieldName(const Message& message,
         && field->type() == FieldDescriptor::TYPE_MESSAGE
         && field->is_optional()
         && field->extension_scope() == field->message_type()) {
-      generator.Print(field->message_type()->full_name());
+      generator.PrintRaw(field->message_type()->full_name());
     } else {
-      generator.Print(field->full_name());
+      generator.PrintRaw(field->full_name());
     }
     generator.Print("]");
   } else {
     if (field->type() == FieldDescriptor::TYPE_GROUP) {
       // Groups must be serialized with their original capitalization.
-      generator.Print(field->message_type()->name());
+      generator.PrintRaw(field->message_type()->name());
     } else {
-      generator.Print(field->name());
+      generator.PrintRaw(field->name());
     }
   }
 }
@@ -1080,19 +1300,19 @@ void TextFormat::Printer::PrintFieldValue(
       << "Index must be -1 for non-repeated fields";
 
   switch (field->cpp_type()) {
-#define OUTPUT_FIELD(CPPTYPE, METHOD, TO_STRING)                             \
+#define OUTPUT_FIELD(CPPTYPE, METHOD)                                        \
       case FieldDescriptor::CPPTYPE_##CPPTYPE:                               \
-        generator.Print(TO_STRING(field->is_repeated() ?                     \
+        generator.PrintNumber(field->is_repeated() ?                         \
           reflection->GetRepeated##METHOD(message, field, index) :           \
-          reflection->Get##METHOD(message, field)));                         \
+          reflection->Get##METHOD(message, field));                          \
         break;                                                               \
 
-      OUTPUT_FIELD( INT32,  Int32, SimpleItoa);
-      OUTPUT_FIELD( INT64,  Int64, SimpleItoa);
-      OUTPUT_FIELD(UINT32, UInt32, SimpleItoa);
-      OUTPUT_FIELD(UINT64, UInt64, SimpleItoa);
-      OUTPUT_FIELD( FLOAT,  Float, SimpleFtoa);
-      OUTPUT_FIELD(DOUBLE, Double, SimpleDtoa);
+      OUTPUT_FIELD( INT32,  Int32);
+      OUTPUT_FIELD( INT64,  Int64);
+      OUTPUT_FIELD(UINT32, UInt32);
+      OUTPUT_FIELD(UINT64, UInt64);
+      OUTPUT_FIELD( FLOAT,  Float);
+      OUTPUT_FIELD(DOUBLE, Double);
 #undef OUTPUT_FIELD
 
       case FieldDescriptor::CPPTYPE_STRING: {
@@ -1103,11 +1323,7 @@ void TextFormat::Printer::PrintFieldValue(
             reflection->GetStringReference(message, field, &scratch);
 
         generator.Print("\"");
-        if (utf8_string_escaping_) {
-          generator.Print(strings::Utf8SafeCEscape(value));
-        } else {
-          generator.Print(CEscape(value));
-        }
+        generator.PrintEscaped(value, utf8_string_escaping_);
         generator.Print("\"");
 
         break;
@@ -1124,7 +1340,7 @@ void TextFormat::Printer::PrintFieldValue(
         break;
 
       case FieldDescriptor::CPPTYPE_ENUM:
-        generator.Print(field->is_repeated() ?
+        generator.PrintRaw(field->is_repeated() ?
           reflection->GetRepeatedEnum(message, field, index)->name() :
           reflection->GetEnum(message, field)->name());
         break;
@@ -1190,13 +1406,12 @@ void TextFormat::Printer::PrintUnknownFields(
     const UnknownFieldSet& unknown_fields, TextGenerator& generator) const {
   for (int i = 0; i < unknown_fields.field_count(); i++) {
     const UnknownField& field = unknown_fields.field(i);
-    std::string field_number = SimpleItoa(field.number());
 
     switch (field.type()) {
       case UnknownField::TYPE_VARINT:
-        generator.Print(field_number);
+        generator.PrintNumber(field.number());
         generator.Print(": ");
-        generator.Print(SimpleItoa(field.varint()));
+        generator.PrintNumber(field.varint());
         if (single_line_mode_) {
           generator.Print(" ");
         } else {
@@ -1204,7 +1419,7 @@ void TextFormat::Printer::PrintUnknownFields(
         }
         break;
       case UnknownField::TYPE_FIXED32: {
-        generator.Print(field_number);
+        generator.PrintNumber(field.number());
         generator.Print(": 0x");
         char buffer[kFastToBufferSize];
         generator.Print(FastHex32ToBuffer(field.fixed32(), buffer));
@@ -1216,7 +1431,7 @@ void TextFormat::Printer::PrintUnknownFields(
         break;
       }
       case UnknownField::TYPE_FIXED64: {
-        generator.Print(field_number);
+        generator.PrintNumber(field.number());
         generator.Print(": 0x");
         char buffer[kFastToBufferSize];
         generator.Print(FastHex64ToBuffer(field.fixed64(), buffer));
@@ -1228,7 +1443,7 @@ void TextFormat::Printer::PrintUnknownFields(
         break;
       }
       case UnknownField::TYPE_LENGTH_DELIMITED: {
-        generator.Print(field_number);
+        generator.PrintNumber(field.number());
         const std::string& value = field.length_delimited();
         UnknownFieldSet embedded_unknown_fields;
         if (!value.empty() && embedded_unknown_fields.ParseFromString(value)) {
@@ -1251,7 +1466,7 @@ void TextFormat::Printer::PrintUnknownFields(
           // This field is not parseable as a Message.
           // So it is probably just a plain string.
           generator.Print(": \"");
-          generator.Print(CEscape(value));
+          generator.PrintEscaped(value, false);
           generator.Print("\"");
           if (single_line_mode_) {
             generator.Print(" ");
@@ -1262,7 +1477,7 @@ void TextFormat::Printer::PrintUnknownFields(
         break;
       }
       case UnknownField::TYPE_GROUP:
-        generator.Print(field_number);
+        generator.PrintNumber(field.number());
         if (single_line_mode_) {
           generator.Print(" { ");
         } else {
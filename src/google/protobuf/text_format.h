@@ -220,6 +220,19 @@ class LIBPROTOBUF_EXPORT TextFormat {
         const std::string& name) const = 0;
   };
 
+  // Interface through which TextFormat::Parser::ParseStreaming() hands over
+  // the values of a repeated message field one at a time.
+  class LIBPROTOBUF_EXPORT ElementCallback {
+   public:
+    virtual ~ElementCallback();
+
+    // Called with each value of the field as soon as it has been parsed.
+    // The element is cleared and reused for the next value once this
+    // returns, so Swap() it into another message to keep it.  Return false
+    // to stop parsing.
+    virtual bool OnElement(Message* element) = 0;
+  };
+
   // For more control over parsing, use this class.
   class LIBPROTOBUF_EXPORT Parser {
    public:
@@ -235,6 +248,17 @@ class LIBPROTOBUF_EXPORT TextFormat {
     // Like TextFormat::MergeFromString().
     bool MergeFromString(const std::string& input, Message* output);
 
+    // Like Parse(), but for input too big to hold as one message.  Each
+    // value of the given repeated message field of the top-level message
+    // is passed to callback as soon as it has been parsed instead of being
+    // added to output, so memory use is bounded by the largest single
+    // value.  All other fields are parsed into output as usual.  Returns
+    // false on a parse error or if callback returns false.
+    bool ParseStreaming(io::ZeroCopyInputStream* input,
+                        const FieldDescriptor* field,
+                        ElementCallback* callback,
+                        Message* output);
+
     // Set where to report parse errors.  If NULL (the default), errors will
     // be printed to stderr.
     void RecordErrorsTo(io::ErrorCollector* error_collector) {
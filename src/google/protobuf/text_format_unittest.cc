@@ -35,6 +35,8 @@
 #include <math.h>
 #include <stdlib.h>
 #include <limits>
+#include <set>
+#include <vector>
 
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
@@ -49,6 +51,7 @@
 #include <gtest/gtest.h>
 #include <google/protobuf/stubs/strutil.h>
 #include <google/protobuf/stubs/substitute.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
 
 namespace google {
 namespace protobuf {
@@ -223,6 +226,35 @@ TEST_F(TextFormatTest, Utf8DebugString) {
   EXPECT_EQ(correct_string, debug_string);
 }
 
+TEST_F(TextFormatTest, StringEscapeAllBytes) {
+  std::string value;
+  for (int i = 0; i < 256; i++) {
+    value.push_back(static_cast<char>(i));
+  }
+  proto_.set_optional_string(value);
+
+  EXPECT_EQ("optional_string: \"" + CEscape(value) + "\"\n",
+            proto_.DebugString());
+  EXPECT_EQ("optional_string: \"" + strings::Utf8SafeCEscape(value) + "\"\n",
+            proto_.Utf8DebugString());
+}
+
+TEST_F(TextFormatTest, PrintToSmallBuffers) {
+  // Numbers are formatted in place when the output buffer has room, and
+  // elsewhere when it doesn't; the text must come out the same either way.
+  TestUtil::SetAllFields(&proto_);
+  std::string expected = proto_.DebugString();
+
+  for (int block_size = 1; block_size < 40; block_size++) {
+    std::string output(expected.size() + 100, '\0');
+    io::ArrayOutputStream output_stream(string_as_array(&output),
+                                        output.size(), block_size);
+    EXPECT_TRUE(TextFormat::Print(proto_, &output_stream));
+    output.resize(output_stream.ByteCount());
+    EXPECT_EQ(expected, output) << "block_size = " << block_size;
+  }
+}
+
 TEST_F(TextFormatTest, PrintUnknownFields) {
   // Test printing of unknown fields in a message.
 
@@ -1045,6 +1077,112 @@ TEST_F(TextFormatParserTest, MergeDuplicateOptional) {
   EXPECT_EQ(2, message.c());
 }
 
+// Collects the values handed over by ParseStreaming().
+class RecordingElementCallback : public TextFormat::ElementCallback {
+ public:
+  RecordingElementCallback() : stop_after_(-1) {}
+
+  // Copies of the elements received, in order.
+  std::vector<std::string> elements_;
+  // The distinct element objects received.
+  std::set<const Message*> element_objects_;
+  // If not -1, return false once this many elements have been received.
+  int stop_after_;
+
+  // implements ElementCallback -------------------------------------
+  bool OnElement(Message* element) {
+    elements_.push_back(element->ShortDebugString());
+    element_objects_.insert(element);
+    return elements_.size() != stop_after_;
+  }
+};
+
+TEST_F(TextFormatParserTest, ParseStreaming) {
+  std::string input =
+    "optional_int32: 1\n"
+    "repeated_nested_message { bb: 1 }\n"
+    "repeated_int32: 2\n"
+    "repeated_nested_message < bb: 2 >\n"
+    "repeated_nested_message { }\n"
+    "optional_nested_message { bb: 3 }\n";
+  io::ArrayInputStream input_stream(input.data(), input.size());
+  unittest::TestAllTypes message;
+  message.set_optional_string("cleared");
+  RecordingElementCallback callback;
+  TextFormat::Parser parser;
+  EXPECT_TRUE(parser.ParseStreaming(
+      &input_stream,
+      message.GetDescriptor()->FindFieldByName("repeated_nested_message"),
+      &callback, &message));
+
+  ASSERT_EQ(3, callback.elements_.size());
+  EXPECT_EQ("bb: 1", callback.elements_[0]);
+  EXPECT_EQ("bb: 2", callback.elements_[1]);
+  EXPECT_EQ("", callback.elements_[2]);
+  // The same element is reused for every value.
+  EXPECT_EQ(1, callback.element_objects_.size());
+
+  EXPECT_EQ("optional_int32: 1 optional_nested_message { bb: 3 } "
+            "repeated_int32: 2", message.ShortDebugString());
+}
+
+TEST_F(TextFormatParserTest, ParseStreamingStop) {
+  std::string input =
+    "repeated_nested_message { bb: 1 }\n"
+    "repeated_nested_message { bb: 2 }\n"
+    "repeated_nested_message { bb: 3 }\n";
+  io::ArrayInputStream input_stream(input.data(), input.size());
+  unittest::TestAllTypes message;
+  RecordingElementCallback callback;
+  callback.stop_after_ = 2;
+  TextFormat::Parser parser;
+  EXPECT_FALSE(parser.ParseStreaming(
+      &input_stream,
+      message.GetDescriptor()->FindFieldByName("repeated_nested_message"),
+      &callback, &message));
+  EXPECT_EQ(2, callback.elements_.size());
+}
+
+TEST_F(TextFormatParserTest, ParseStreamingErrors) {
+  // Errors inside a streamed value are reported at their position in the
+  // whole input.
+  std::string input =
+    "repeated_message { a: 1 b: 2 c: 3 }\n"
+    "repeated_message { a: 1 b: x }\n";
+  io::ArrayInputStream input_stream(input.data(), input.size());
+  unittest::TestRequiredForeign message;
+  const FieldDescriptor* field =
+      message.GetDescriptor()->FindFieldByName("repeated_message");
+  RecordingElementCallback callback;
+  TextFormat::Parser parser;
+  MockErrorCollector error_collector;
+  parser.RecordErrorsTo(&error_collector);
+  EXPECT_FALSE(parser.ParseStreaming(&input_stream, field, &callback,
+                                     &message));
+  EXPECT_EQ("2:28: Expected integer.\n", error_collector.text_);
+  EXPECT_EQ(1, callback.elements_.size());
+
+  // Each value must be initialized unless partial messages are allowed.
+  input =
+    "repeated_message { a: 1 b: 2 c: 3 }\n"
+    "repeated_message { a: 1 }\n";
+  io::ArrayInputStream partial_stream(input.data(), input.size());
+  error_collector.text_.clear();
+  callback.elements_.clear();
+  EXPECT_FALSE(parser.ParseStreaming(&partial_stream, field, &callback,
+                                     &message));
+  EXPECT_EQ("2:18: Message missing required fields: b, c\n",
+            error_collector.text_);
+  EXPECT_EQ(1, callback.elements_.size());
+
+  io::ArrayInputStream allowed_stream(input.data(), input.size());
+  parser.AllowPartialMessage(true);
+  callback.elements_.clear();
+  EXPECT_TRUE(parser.ParseStreaming(&allowed_stream, field, &callback,
+                                    &message));
+  EXPECT_EQ(2, callback.elements_.size());
+}
+
 TEST_F(TextFormatParserTest, ExplicitDelimiters) {
   unittest::TestRequired message;
   EXPECT_TRUE(TextFormat::ParseFromString("a:1,b:2;c:3", &message));
@@ -0,0 +1,1018 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <google/protobuf/unix_socket_rpc.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+
+namespace google {
+namespace protobuf {
+
+#ifdef __linux__
+
+namespace {
+
+// Tags of the fields of the frames described in unix_socket_rpc.h.
+const uint32 kCallIdTag = 0x08;       // 1: uint64
+const uint32 kServiceNameTag = 0x12;  // 2: string, in calls
+const uint32 kMethodIndexTag = 0x18;  // 3: uint32, in calls
+const uint32 kRequestTag = 0x22;      // 4: bytes, in calls
+const uint32 kErrorTextTag = 0x12;    // 2: string, in responses
+const uint32 kResponseTag = 0x1a;     // 3: bytes, in responses
+
+const int kMaxEvents = 64;
+// The same as CodedInputStream's default total bytes limit.
+const int kDefaultMaxFrameSize = 64 << 20;
+const int kReadChunkSize = 65536;
+// Most frames given to one sendmsg().
+const int kMaxFramesPerWrite = 256;
+
+std::string ErrorString(const char* operation) {
+  return std::string(operation) + ": " + strerror(errno);
+}
+
+// Writes to an eventfd, to wake up the thread waiting for it.
+void WakeUp(int wakeup_fd) {
+  uint64 one = 1;
+  while (write(wakeup_fd, &one, sizeof(one)) < 0 && errno == EINTR) {}
+}
+
+bool MakeAddress(const std::string& socket_path, struct sockaddr_un* address,
+                 std::string* error) {
+  memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address->sun_path)) {
+    *error = "Socket path too long: " + socket_path;
+    return false;
+  }
+  strcpy(address->sun_path, socket_path.c_str());
+  return true;
+}
+
+// Fills in *frame with a varint giving the size of the rest, followed by
+// the given fields and then message as a length-delimited field with
+// message_tag.  The fields are call_id, then text as a length-delimited
+// field with text_tag unless text_tag is 0, then number as a varint field
+// with number_tag unless number_tag is 0.
+void MakeFrame(uint64 call_id,
+               uint32 text_tag, const std::string& text,
+               uint32 number_tag, uint32 number,
+               uint32 message_tag, const Message* message,
+               std::string* frame) {
+  typedef io::CodedOutputStream Output;
+  int message_size = message == NULL ? 0 : message->ByteSize();
+  int body_size = 1 + Output::VarintSize64(call_id);
+  if (text_tag != 0) {
+    body_size += 1 + Output::VarintSize32(text.size()) + text.size();
+  }
+  if (number_tag != 0) {
+    body_size += 1 + Output::VarintSize32(number);
+  }
+  if (message != NULL) {
+    body_size += 1 + Output::VarintSize32(message_size) + message_size;
+  }
+
+  frame->resize(Output::VarintSize32(body_size) + body_size);
+  uint8* target = reinterpret_cast<uint8*>(string_as_array(frame));
+  target = Output::WriteVarint32ToArray(body_size, target);
+  target = Output::WriteTagToArray(kCallIdTag, target);
+  target = Output::WriteVarint64ToArray(call_id, target);
+  if (text_tag != 0) {
+    target = Output::WriteTagToArray(text_tag, target);
+    target = Output::WriteVarint32ToArray(text.size(), target);
+    target = Output::WriteStringToArray(text, target);
+  }
+  if (number_tag != 0) {
+    target = Output::WriteTagToArray(number_tag, target);
+    target = Output::WriteVarint32ToArray(number, target);
+  }
+  if (message != NULL) {
+    target = Output::WriteTagToArray(message_tag, target);
+    target = Output::WriteVarint32ToArray(message_size, target);
+    message->SerializeWithCachedSizesToArray(target);
+  }
+}
+
+// Reads a length-delimited field without copying it.
+bool ReadBytesField(io::CodedInputStream* input,
+                    const char** data, int* size) {
+  uint32 length;
+  const void* buffer;
+  int available;
+  if (!input->ReadVarint32(&length)) return false;
+  if (length == 0) {
+    *data = NULL;
+    *size = 0;
+    return true;
+  }
+  if (!input->GetDirectBufferPointer(&buffer, &available) ||
+      available < static_cast<int>(length)) {
+    return false;
+  }
+  *data = reinterpret_cast<const char*>(buffer);
+  *size = length;
+  return input->Skip(length);
+}
+
+// Reads what is available from fd onto the end of *buffer.  Returns false if
+// the other end closed the connection, or on error.
+bool ReadAvailable(int fd, std::string* buffer) {
+  char chunk[kReadChunkSize];
+  while (true) {
+    ssize_t size = read(fd, chunk, sizeof(chunk));
+    if (size > 0) {
+      buffer->append(chunk, size);
+      if (size < static_cast<ssize_t>(sizeof(chunk))) return true;
+    } else if (size == 0) {
+      return false;
+    } else if (errno != EINTR) {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+  }
+}
+
+// Finds the frame starting at buffer[*position], and moves *position past
+// it.  Returns false if no complete frame starts there, setting *malformed
+// if none ever will or if the frame is bigger than max_size.
+bool NextFrame(const std::string& buffer, int* position, int max_size,
+               const char** frame, int* size, bool* malformed) {
+  int available = buffer.size() - *position;
+  if (available == 0) return false;
+  io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(buffer.data() + *position),
+      std::min(available, 5));
+  uint32 frame_size;
+  if (!input.ReadVarint32(&frame_size)) {
+    // Incomplete, unless five bytes couldn't hold the size.
+    *malformed = available >= 5;
+    return false;
+  }
+  if (frame_size > static_cast<uint32>(max_size)) {
+    *malformed = true;
+    return false;
+  }
+  int header_size = io::CodedOutputStream::VarintSize32(frame_size);
+  if (frame_size > static_cast<uint32>(available - header_size)) {
+    return false;
+  }
+  *frame = buffer.data() + *position + header_size;
+  *size = frame_size;
+  *position += header_size + frame_size;
+  return true;
+}
+
+// Writes as many of *frames as fd takes, in as few calls as possible.
+// *offset is how much of the first frame has already been written.  Returns
+// false on error.
+bool WriteFrames(int fd, std::deque<std::string>* frames, size_t* offset) {
+  while (!frames->empty()) {
+    struct iovec iov[kMaxFramesPerWrite];
+    int count = 0;
+    for (std::deque<std::string>::iterator iter = frames->begin();
+         iter != frames->end() && count < kMaxFramesPerWrite;
+         ++iter, ++count) {
+      size_t skip = count == 0 ? *offset : 0;
+      iov[count].iov_base = string_as_array(&*iter) + skip;
+      iov[count].iov_len = iter->size() - skip;
+    }
+
+    // This is writev(), but with MSG_NOSIGNAL so that a closed connection
+    // is an error rather than SIGPIPE.
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = iov;
+    message.msg_iovlen = count;
+    ssize_t written = sendmsg(fd, &message, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
+    while (written > 0) {
+      size_t left = frames->front().size() - *offset;
+      if (static_cast<size_t>(written) < left) {
+        *offset += written;
+        break;
+      }
+      written -= left;
+      frames->pop_front();
+      *offset = 0;
+    }
+  }
+  return true;
+}
+
+// Moves the strings of *from to the end of *to, without copying them.
+void MoveFrames(std::deque<std::string>* from, std::deque<std::string>* to) {
+  for (int i = 0; i < from->size(); i++) {
+    to->push_back(std::string());
+    to->back().swap((*from)[i]);
+  }
+  from->clear();
+}
+
+}  // namespace
+
+// ===================================================================
+
+struct UnixSocketRpcChannel::IoThread {
+  pthread_t thread;
+};
+
+UnixSocketRpcChannel::UnixSocketRpcChannel()
+  : socket_(-1),
+    wakeup_fd_(-1),
+    epoll_fd_(-1),
+    max_frame_size_(kDefaultMaxFrameSize),
+    io_thread_(NULL),
+    next_call_id_(0),
+    connected_(false),
+    disconnect_reason_("Not connected."),
+    wakeup_pending_(false),
+    stopping_(false) {
+}
+
+UnixSocketRpcChannel::~UnixSocketRpcChannel() {
+  if (io_thread_ != NULL) {
+    {
+      MutexLock lock(&mutex_);
+      stopping_ = true;
+    }
+    WakeUp(wakeup_fd_);
+    pthread_join(io_thread_->thread, NULL);
+    delete io_thread_;
+  }
+  Disconnect("Channel destroyed.");
+  if (socket_ != -1) close(socket_);
+  if (wakeup_fd_ != -1) close(wakeup_fd_);
+  if (epoll_fd_ != -1) close(epoll_fd_);
+}
+
+void UnixSocketRpcChannel::SetMaxFrameSize(int max_frame_size) {
+  GOOGLE_CHECK(io_thread_ == NULL)
+      << "SetMaxFrameSize() called after Connect().";
+  max_frame_size_ = max_frame_size;
+}
+
+bool UnixSocketRpcChannel::Connect(const std::string& socket_path,
+                                   std::string* error) {
+  GOOGLE_CHECK(io_thread_ == NULL) << "Connect() called twice.";
+  struct sockaddr_un address;
+  if (!MakeAddress(socket_path, &address, error)) return false;
+
+  socket_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (socket_ == -1) {
+    *error = ErrorString("socket");
+    return false;
+  }
+  if (connect(socket_, reinterpret_cast<struct sockaddr*>(&address),
+              sizeof(address)) == -1) {
+    *error = ErrorString(("connect to " + socket_path).c_str());
+    return false;
+  }
+  int flags = fcntl(socket_, F_GETFL);
+  fcntl(socket_, F_SETFL, flags | O_NONBLOCK);
+
+  wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (wakeup_fd_ == -1 || epoll_fd_ == -1) {
+    *error = ErrorString("eventfd/epoll_create1");
+    return false;
+  }
+  struct epoll_event event;
+  event.events = EPOLLIN;
+  event.data.fd = socket_;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, socket_, &event);
+  event.data.fd = wakeup_fd_;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event);
+
+  {
+    MutexLock lock(&mutex_);
+    connected_ = true;
+  }
+  io_thread_ = new IoThread;
+  int result = pthread_create(&io_thread_->thread, NULL, &IoThreadMain, this);
+  GOOGLE_CHECK_EQ(result, 0) << "pthread_create: " << strerror(result);
+  return true;
+}
+
+void UnixSocketRpcChannel::CallMethod(const MethodDescriptor* method,
+                                      RpcController* controller,
+                                      const Message* request,
+                                      Message* response,
+                                      Closure* done) {
+  uint64 call_id = __sync_add_and_fetch(&next_call_id_, 1);
+  std::string frame;
+  MakeFrame(call_id, kServiceNameTag, method->service()->full_name(),
+            kMethodIndexTag, method->index(), kRequestTag, request, &frame);
+
+  std::string failure;
+  bool wake = false;
+  {
+    MutexLock lock(&mutex_);
+    if (connected_) {
+      PendingCall* call = &pending_calls_[call_id];
+      call->controller = controller;
+      call->response = response;
+      call->done = done;
+      queued_frames_.push_back(std::string());
+      queued_frames_.back().swap(frame);
+      wake = !wakeup_pending_;
+      wakeup_pending_ = true;
+    } else {
+      failure = disconnect_reason_;
+    }
+  }
+
+  if (!failure.empty()) {
+    controller->SetFailed(failure);
+    done->Run();
+  } else if (wake) {
+    WakeUp(wakeup_fd_);
+  }
+}
+
+void* UnixSocketRpcChannel::IoThreadMain(void* channel) {
+  reinterpret_cast<UnixSocketRpcChannel*>(channel)->RunIo();
+  return NULL;
+}
+
+void UnixSocketRpcChannel::RunIo() {
+  std::string input;
+  std::deque<std::string> output;
+  size_t output_offset = 0;
+  bool watching_output = false;
+  struct epoll_event events[kMaxEvents];
+
+  while (true) {
+    int count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      Disconnect(ErrorString("epoll_wait"));
+      return;
+    }
+
+    for (int i = 0; i < count; i++) {
+      if (events[i].data.fd == wakeup_fd_) {
+        uint64 value;
+        while (read(wakeup_fd_, &value, sizeof(value)) < 0 &&
+               errno == EINTR) {}
+        MutexLock lock(&mutex_);
+        if (stopping_) return;
+        wakeup_pending_ = false;
+        MoveFrames(&queued_frames_, &output);
+      } else if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        bool open = ReadAvailable(socket_, &input);
+        int position = 0;
+        const char* frame;
+        int size;
+        bool malformed = false;
+        while (NextFrame(input, &position, max_frame_size_,
+                         &frame, &size, &malformed)) {
+          if (!HandleResponse(frame, size)) {
+            malformed = true;
+            break;
+          }
+        }
+        input.erase(0, position);
+        if (malformed) {
+          Disconnect("Malformed or oversized response from server.");
+          return;
+        }
+        if (!open) {
+          Disconnect("Connection closed by server.");
+          return;
+        }
+      }
+    }
+
+    if (!WriteFrames(socket_, &output, &output_offset)) {
+      Disconnect(ErrorString("sendmsg"));
+      return;
+    }
+    if (output.empty() == watching_output) {
+      watching_output = !output.empty();
+      struct epoll_event event;
+      event.events = watching_output ? EPOLLIN | EPOLLOUT : EPOLLIN;
+      event.data.fd = socket_;
+      epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, socket_, &event);
+    }
+  }
+}
+
+bool UnixSocketRpcChannel::HandleResponse(const char* frame, int size) {
+  io::CodedInputStream input(reinterpret_cast<const uint8*>(frame), size);
+  uint64 call_id = 0;
+  bool failed = false;
+  std::string error_text;
+  const char* response_data = NULL;
+  int response_size = 0;
+  while (uint32 tag = input.ReadTag()) {
+    bool ok;
+    switch (tag) {
+      case kCallIdTag:
+        ok = input.ReadVarint64(&call_id);
+        break;
+      case kErrorTextTag: {
+        uint32 length;
+        ok = input.ReadVarint32(&length) &&
+             input.ReadString(&error_text, length);
+        failed = true;
+        break;
+      }
+      case kResponseTag:
+        ok = ReadBytesField(&input, &response_data, &response_size);
+        break;
+      default:
+        ok = internal::WireFormatLite::SkipField(&input, tag);
+        break;
+    }
+    if (!ok) return false;
+  }
+
+  PendingCall call;
+  {
+    MutexLock lock(&mutex_);
+    std::map<uint64, PendingCall>::iterator iter =
+        pending_calls_.find(call_id);
+    if (iter == pending_calls_.end()) return false;
+    call = iter->second;
+    pending_calls_.erase(iter);
+  }
+
+  if (failed) {
+    call.controller->SetFailed(error_text);
+  } else if (!call.response->ParseFromArray(response_data, response_size)) {
+    call.controller->SetFailed("Couldn't parse response.");
+  }
+  call.done->Run();
+  return true;
+}
+
+void UnixSocketRpcChannel::Disconnect(const std::string& reason) {
+  std::map<uint64, PendingCall> calls;
+  {
+    MutexLock lock(&mutex_);
+    if (connected_) {
+      connected_ = false;
+      disconnect_reason_ = reason;
+    }
+    calls.swap(pending_calls_);
+    queued_frames_.clear();
+  }
+  for (std::map<uint64, PendingCall>::iterator iter = calls.begin();
+       iter != calls.end(); ++iter) {
+    iter->second.controller->SetFailed(reason);
+    iter->second.done->Run();
+  }
+}
+
+// ===================================================================
+
+struct UnixSocketRpcServer::IoThread {
+  pthread_t thread;
+};
+
+struct UnixSocketRpcServer::Connection {
+  int fd;
+
+  // Used by the I/O thread only.
+  std::string input;
+  std::deque<std::string> output;
+  size_t output_offset;
+  bool watching_output;
+
+  // Guarded by the server's mutex_.
+  std::deque<std::string> queued_output;
+  bool in_flush_list;           // in connections_to_flush_
+  int calls_in_progress;
+  bool closed;
+};
+
+struct UnixSocketRpcServer::MethodPool {
+  std::vector<Message*> requests;
+  std::vector<Message*> responses;
+
+  ~MethodPool() {
+    STLDeleteElements(&requests);
+    STLDeleteElements(&responses);
+  }
+};
+
+// A call being run by a Service.  It is also the controller and the "done"
+// callback handed to the Service, and is reused for later calls once done.
+class UnixSocketRpcServer::ServerCall : public RpcController, public Closure {
+ public:
+  UnixSocketRpcServer* server;
+  Connection* connection;
+  uint64 call_id;
+  MethodPool* pool;
+  Message* request;
+  Message* response;
+
+  bool failed;
+  std::string error_text;
+  Closure* cancel_callback;
+
+  // implements RpcController ---------------------------------------
+  void Reset() {
+    failed = false;
+    error_text.clear();
+    cancel_callback = NULL;
+  }
+  bool Failed() const { return failed; }
+  std::string ErrorText() const { return error_text; }
+  void StartCancel() {}
+  void SetFailed(const std::string& reason) {
+    failed = true;
+    error_text = reason;
+  }
+  bool IsCanceled() const { return false; }
+  // Calls are never canceled, so the callback is run when the call is done.
+  void NotifyOnCancel(Closure* callback) { cancel_callback = callback; }
+
+  // implements Closure ---------------------------------------------
+  void Run() { server->FinishCall(this); }
+};
+
+UnixSocketRpcServer::UnixSocketRpcServer()
+  : listen_fd_(-1),
+    wakeup_fd_(-1),
+    epoll_fd_(-1),
+    max_frame_size_(kDefaultMaxFrameSize),
+    io_thread_(NULL),
+    calls_in_progress_(0),
+    wakeup_pending_(false),
+    stopping_(false) {
+}
+
+UnixSocketRpcServer::~UnixSocketRpcServer() {
+  Stop();
+  STLDeleteValues(&pools_);
+  STLDeleteElements(&free_calls_);
+}
+
+void UnixSocketRpcServer::RegisterService(Service* service) {
+  services_[service->GetDescriptor()->full_name()] = service;
+}
+
+void UnixSocketRpcServer::SetMaxFrameSize(int max_frame_size) {
+  GOOGLE_CHECK(io_thread_ == NULL) << "SetMaxFrameSize() called after Start().";
+  max_frame_size_ = max_frame_size;
+}
+
+bool UnixSocketRpcServer::Start(const std::string& socket_path,
+                                std::string* error) {
+  GOOGLE_CHECK(io_thread_ == NULL) << "Start() called twice.";
+  struct sockaddr_un address;
+  if (!MakeAddress(socket_path, &address, error)) return false;
+
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listen_fd_ == -1) {
+    *error = ErrorString("socket");
+    return false;
+  }
+  unlink(socket_path.c_str());
+  if (bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address)) == -1) {
+    *error = ErrorString(("bind to " + socket_path).c_str());
+    return false;
+  }
+  socket_path_ = socket_path;
+  if (listen(listen_fd_, SOMAXCONN) == -1) {
+    *error = ErrorString("listen");
+    return false;
+  }
+
+  wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (wakeup_fd_ == -1 || epoll_fd_ == -1) {
+    *error = ErrorString("eventfd/epoll_create1");
+    return false;
+  }
+  // Connections are told apart from these by data.ptr.
+  struct epoll_event event;
+  event.events = EPOLLIN;
+  event.data.ptr = &listen_fd_;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event);
+  event.data.ptr = &wakeup_fd_;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event);
+
+  io_thread_ = new IoThread;
+  int result = pthread_create(&io_thread_->thread, NULL, &IoThreadMain, this);
+  GOOGLE_CHECK_EQ(result, 0) << "pthread_create: " << strerror(result);
+  return true;
+}
+
+void UnixSocketRpcServer::Stop() {
+  if (io_thread_ != NULL) {
+    {
+      MutexLock lock(&mutex_);
+      stopping_ = true;
+    }
+    WakeUp(wakeup_fd_);
+    pthread_join(io_thread_->thread, NULL);
+
+    // Connections with calls in progress are deleted by the last of them
+    // to finish.
+    {
+      MutexLock lock(&mutex_);
+      for (int i = 0; i < connections_.size(); i++) {
+        close(connections_[i]->fd);
+        connections_[i]->closed = true;
+        if (connections_[i]->calls_in_progress == 0) delete connections_[i];
+      }
+      connections_.clear();
+      connections_to_flush_.clear();
+      delete io_thread_;
+      io_thread_ = NULL;
+    }
+    while (true) {
+      {
+        MutexLock lock(&mutex_);
+        if (calls_in_progress_ == 0) break;
+      }
+      usleep(1000);
+    }
+  }
+
+  if (!socket_path_.empty()) {
+    unlink(socket_path_.c_str());
+    socket_path_.clear();
+  }
+  if (listen_fd_ != -1) close(listen_fd_);
+  if (wakeup_fd_ != -1) close(wakeup_fd_);
+  if (epoll_fd_ != -1) close(epoll_fd_);
+  listen_fd_ = wakeup_fd_ = epoll_fd_ = -1;
+}
+
+void* UnixSocketRpcServer::IoThreadMain(void* server) {
+  reinterpret_cast<UnixSocketRpcServer*>(server)->RunIo();
+  return NULL;
+}
+
+void UnixSocketRpcServer::RunIo() {
+  struct epoll_event events[kMaxEvents];
+  std::vector<Connection*> to_flush;
+
+  while (true) {
+    int count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      GOOGLE_LOG(ERROR) << ErrorString("epoll_wait");
+      return;
+    }
+
+    for (int i = 0; i < count; i++) {
+      if (events[i].data.ptr == &listen_fd_) {
+        AcceptConnections();
+      } else if (events[i].data.ptr == &wakeup_fd_) {
+        uint64 value;
+        while (read(wakeup_fd_, &value, sizeof(value)) < 0 &&
+               errno == EINTR) {}
+        MutexLock lock(&mutex_);
+        if (stopping_) return;
+        wakeup_pending_ = false;
+      } else {
+        Connection* connection =
+            reinterpret_cast<Connection*>(events[i].data.ptr);
+        if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) &&
+            !ReadCalls(connection)) {
+          CloseConnection(connection);
+        } else if ((events[i].events & EPOLLOUT) &&
+                   !FlushConnection(connection)) {
+          CloseConnection(connection);
+        }
+      }
+    }
+
+    // Send the responses queued by calls which finished meanwhile, on this
+    // thread or another.
+    {
+      MutexLock lock(&mutex_);
+      to_flush.swap(connections_to_flush_);
+      for (int i = 0; i < to_flush.size(); i++) {
+        MoveFrames(&to_flush[i]->queued_output, &to_flush[i]->output);
+        to_flush[i]->in_flush_list = false;
+      }
+    }
+    for (int i = 0; i < to_flush.size(); i++) {
+      if (!FlushConnection(to_flush[i])) CloseConnection(to_flush[i]);
+    }
+    to_flush.clear();
+  }
+}
+
+void UnixSocketRpcServer::AcceptConnections() {
+  while (true) {
+    int fd = accept4(listen_fd_, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd == -1) {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        GOOGLE_LOG(ERROR) << ErrorString("accept4");
+      }
+      return;
+    }
+
+    Connection* connection = new Connection;
+    connection->fd = fd;
+    connection->output_offset = 0;
+    connection->watching_output = false;
+    connection->in_flush_list = false;
+    connection->calls_in_progress = 0;
+    connection->closed = false;
+    {
+      MutexLock lock(&mutex_);
+      connections_.push_back(connection);
+    }
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = connection;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+  }
+}
+
+bool UnixSocketRpcServer::ReadCalls(Connection* connection) {
+  bool open = ReadAvailable(connection->fd, &connection->input);
+  int position = 0;
+  const char* frame;
+  int size;
+  bool malformed = false;
+  while (NextFrame(connection->input, &position, max_frame_size_,
+                   &frame, &size, &malformed)) {
+    if (!DispatchCall(connection, frame, size)) {
+      malformed = true;
+      break;
+    }
+  }
+  connection->input.erase(0, position);
+  if (malformed) {
+    GOOGLE_LOG(ERROR) << "Malformed or oversized call from client; "
+                         "closing connection.";
+    return false;
+  }
+  return open;
+}
+
+bool UnixSocketRpcServer::DispatchCall(Connection* connection,
+                                       const char* frame, int size) {
+  io::CodedInputStream input(reinterpret_cast<const uint8*>(frame), size);
+  uint64 call_id = 0;
+  std::string service_name;
+  uint32 method_index = 0;
+  const char* request_data = NULL;
+  int request_size = 0;
+  while (uint32 tag = input.ReadTag()) {
+    bool ok;
+    switch (tag) {
+      case kCallIdTag:
+        ok = input.ReadVarint64(&call_id);
+        break;
+      case kServiceNameTag: {
+        uint32 length;
+        ok = input.ReadVarint32(&length) &&
+             input.ReadString(&service_name, length);
+        break;
+      }
+      case kMethodIndexTag:
+        ok = input.ReadVarint32(&method_index);
+        break;
+      case kRequestTag:
+        ok = ReadBytesField(&input, &request_data, &request_size);
+        break;
+      default:
+        ok = internal::WireFormatLite::SkipField(&input, tag);
+        break;
+    }
+    if (!ok) return false;
+  }
+
+  std::map<std::string, Service*>::const_iterator iter =
+      services_.find(service_name);
+  Service* service = iter == services_.end() ? NULL : iter->second;
+  if (service == NULL ||
+      method_index >= service->GetDescriptor()->method_count()) {
+    std::string frame;
+    MakeFrame(call_id, kErrorTextTag,
+              service == NULL ? "Unknown service: " + service_name
+                              : "Unknown method of " + service_name,
+              0, 0, 0, NULL, &frame);
+    MutexLock lock(&mutex_);
+    QueueResponse(connection, &frame);
+    return true;
+  }
+
+  const MethodDescriptor* method =
+      service->GetDescriptor()->method(method_index);
+  MethodPool*& pool = pools_[method];
+  if (pool == NULL) pool = new MethodPool;
+
+  ServerCall* call = NULL;
+  Message* request = NULL;
+  Message* response = NULL;
+  {
+    MutexLock lock(&mutex_);
+    if (!free_calls_.empty()) {
+      call = free_calls_.back();
+      free_calls_.pop_back();
+    }
+    if (!pool->requests.empty()) {
+      request = pool->requests.back();
+      pool->requests.pop_back();
+    }
+    if (!pool->responses.empty()) {
+      response = pool->responses.back();
+      pool->responses.pop_back();
+    }
+    ++connection->calls_in_progress;
+    ++calls_in_progress_;
+  }
+  if (call == NULL) call = new ServerCall;
+  if (request == NULL) request = service->GetRequestPrototype(method).New();
+  if (response == NULL) response = service->GetResponsePrototype(method).New();
+
+  call->Reset();
+  call->server = this;
+  call->connection = connection;
+  call->call_id = call_id;
+  call->pool = pool;
+  call->request = request;
+  call->response = response;
+
+  if (!request->ParseFromArray(request_data, request_size)) {
+    call->SetFailed("Couldn't parse request.");
+    call->Run();
+  } else {
+    service->CallMethod(method, call, request, response, call);
+  }
+  return true;
+}
+
+void UnixSocketRpcServer::FinishCall(ServerCall* call) {
+  std::string frame;
+  if (call->failed) {
+    MakeFrame(call->call_id, kErrorTextTag, call->error_text,
+              0, 0, 0, NULL, &frame);
+  } else {
+    MakeFrame(call->call_id, 0, "", 0, 0, kResponseTag, call->response,
+              &frame);
+  }
+  Closure* cancel_callback = call->cancel_callback;
+  call->request->Clear();
+  call->response->Clear();
+
+  Connection* connection = call->connection;
+  bool delete_connection = false;
+  {
+    MutexLock lock(&mutex_);
+    call->pool->requests.push_back(call->request);
+    call->pool->responses.push_back(call->response);
+    free_calls_.push_back(call);
+    --calls_in_progress_;
+    --connection->calls_in_progress;
+    if (connection->closed) {
+      delete_connection = connection->calls_in_progress == 0;
+    } else {
+      QueueResponse(connection, &frame);
+    }
+  }
+  if (delete_connection) delete connection;
+  if (cancel_callback != NULL) cancel_callback->Run();
+}
+
+void UnixSocketRpcServer::QueueResponse(Connection* connection,
+                                        std::string* frame) {
+  connection->queued_output.push_back(std::string());
+  connection->queued_output.back().swap(*frame);
+  if (!connection->in_flush_list) {
+    connection->in_flush_list = true;
+    connections_to_flush_.push_back(connection);
+  }
+  // The I/O thread looks at connections_to_flush_ after every event.
+  if (!wakeup_pending_ && !pthread_equal(pthread_self(), io_thread_->thread)) {
+    wakeup_pending_ = true;
+    WakeUp(wakeup_fd_);
+  }
+}
+
+void UnixSocketRpcServer::CloseConnection(Connection* connection) {
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection->fd, NULL);
+  close(connection->fd);
+  MutexLock lock(&mutex_);
+  connection->closed = true;
+  connections_.erase(
+      std::find(connections_.begin(), connections_.end(), connection));
+  std::vector<Connection*>::iterator iter = std::find(
+      connections_to_flush_.begin(), connections_to_flush_.end(), connection);
+  if (iter != connections_to_flush_.end()) connections_to_flush_.erase(iter);
+  if (connection->calls_in_progress == 0) delete connection;
+}
+
+bool UnixSocketRpcServer::FlushConnection(Connection* connection) {
+  if (!WriteFrames(connection->fd, &connection->output,
+                   &connection->output_offset)) {
+    return false;
+  }
+  if (connection->output.empty() == connection->watching_output) {
+    connection->watching_output = !connection->output.empty();
+    struct epoll_event event;
+    event.events = connection->watching_output ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.ptr = connection;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection->fd, &event);
+  }
+  return true;
+}
+
+#else  // __linux__
+
+namespace {
+const char kNotSupported[] =
+    "RPC over Unix domain sockets is only supported on Linux.";
+}  // namespace
+
+UnixSocketRpcChannel::UnixSocketRpcChannel() {}
+UnixSocketRpcChannel::~UnixSocketRpcChannel() {}
+
+void UnixSocketRpcChannel::SetMaxFrameSize(int max_frame_size) {}
+
+bool UnixSocketRpcChannel::Connect(const std::string& socket_path,
+                                   std::string* error) {
+  *error = kNotSupported;
+  return false;
+}
+
+void UnixSocketRpcChannel::CallMethod(const MethodDescriptor* method,
+                                      RpcController* controller,
+                                      const Message* request,
+                                      Message* response,
+                                      Closure* done) {
+  controller->SetFailed(kNotSupported);
+  done->Run();
+}
+
+UnixSocketRpcServer::UnixSocketRpcServer() {}
+UnixSocketRpcServer::~UnixSocketRpcServer() {}
+
+void UnixSocketRpcServer::RegisterService(Service* service) {}
+void UnixSocketRpcServer::SetMaxFrameSize(int max_frame_size) {}
+
+bool UnixSocketRpcServer::Start(const std::string& socket_path,
+                                std::string* error) {
+  *error = kNotSupported;
+  return false;
+}
+
+void UnixSocketRpcServer::Stop() {}
+
+#endif  // !__linux__
+
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,241 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// An RpcChannel and a server talking to each other over a Unix domain
+// socket, for generic services between processes on the same machine.
+//
+// Server:
+//   MyServiceImpl service;
+//   UnixSocketRpcServer server;
+//   server.RegisterService(&service);
+//   std::string error;
+//   if (!server.Start("/tmp/my_service.socket", &error)) ...
+//
+// Client:
+//   UnixSocketRpcChannel channel;
+//   if (!channel.Connect("/tmp/my_service.socket", &error)) ...
+//   MyService::Stub stub(&channel);
+//   stub.MyMethod(&controller, &request, &response, done);
+//
+// Any number of calls may be outstanding on one channel at once.  Each is
+// sent with an id, which the server sends back with the response, so that
+// responses may come back in any order.  Each side has one thread doing all
+// of its I/O with epoll, which sends whatever calls or responses have been
+// queued since it last wrote in one writev().  Only available on Linux.
+//
+// Each call is sent as a varint giving the size of the rest, followed by a
+// message with these fields, in the protocol buffer wire format:
+//   1: uint64 call id
+//   2: string full name of the service
+//   3: uint32 index of the method in the service
+//   4: bytes  request
+// and its response likewise, with:
+//   1: uint64 call id
+//   2: string error text, if the call failed
+//   3: bytes  response, if it didn't
+
+#ifndef GOOGLE_PROTOBUF_UNIX_SOCKET_RPC_H__
+#define GOOGLE_PROTOBUF_UNIX_SOCKET_RPC_H__
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include <google/protobuf/service.h>
+
+namespace google {
+namespace protobuf {
+
+// Defined in this file.
+class UnixSocketRpcChannel;
+class UnixSocketRpcServer;
+
+// Calls the services of a UnixSocketRpcServer.  The "done" callback of a
+// call is run on the channel's I/O thread, or on the calling thread if the
+// call fails before it is sent.  Failures are reported through the
+// controller's SetFailed(), so the RpcController passed to CallMethod() must
+// be one whose Failed() then returns true, such as LocalRpcController.
+// StartCancel() has no effect on calls made through this channel.
+class LIBPROTOBUF_EXPORT UnixSocketRpcChannel : public RpcChannel {
+ public:
+  UnixSocketRpcChannel();
+  // Closes the connection, failing the calls still outstanding.
+  ~UnixSocketRpcChannel();
+
+  // Connects to the server listening on socket_path, and starts the I/O
+  // thread.  Returns false and sets *error on failure.  Calls made before
+  // the channel is connected, or once the server has closed the connection,
+  // fail.
+  bool Connect(const std::string& socket_path, std::string* error);
+
+  // Sets the size of the largest response the channel accepts, 64MB by
+  // default.  The channel disconnects as soon as the server starts sending a
+  // bigger one, failing all outstanding calls.  Must be called before
+  // Connect().
+  void SetMaxFrameSize(int max_frame_size);
+
+  // implements RpcChannel ------------------------------------------
+  void CallMethod(const MethodDescriptor* method,
+                  RpcController* controller,
+                  const Message* request,
+                  Message* response,
+                  Closure* done);
+
+ private:
+  struct PendingCall {
+    RpcController* controller;
+    Message* response;
+    Closure* done;
+  };
+
+  static void* IoThreadMain(void* channel);
+  void RunIo();
+
+  // Completes the call the response in the given frame is for.  Returns
+  // false if the frame is malformed.
+  bool HandleResponse(const char* frame, int size);
+
+  // Fails all calls still outstanding, and any made from now on.
+  void Disconnect(const std::string& reason);
+
+  int socket_;
+  int wakeup_fd_;               // eventfd, written to wake the I/O thread up
+  int epoll_fd_;
+  int max_frame_size_;
+  struct IoThread;
+  IoThread* io_thread_;         // NULL until started
+
+  Mutex mutex_;                 // guards the members below
+  volatile uint64 next_call_id_;
+  bool connected_;
+  std::string disconnect_reason_;
+  std::map<uint64, PendingCall> pending_calls_;
+  // Frames not yet handed to the I/O thread.
+  std::deque<std::string> queued_frames_;
+  bool wakeup_pending_;
+  bool stopping_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(UnixSocketRpcChannel);
+};
+
+// Listens on a Unix domain socket and calls the Services registered with
+// it for each call received.  Services are called on the server's I/O
+// thread, and may run "done" on any thread, before or after CallMethod()
+// returns.  Requests and responses are taken from pools of messages kept by
+// the server for each method, so that a busy server allocates none.
+class LIBPROTOBUF_EXPORT UnixSocketRpcServer {
+ public:
+  UnixSocketRpcServer();
+  // Stop()s the server.
+  ~UnixSocketRpcServer();
+
+  // Makes calls to the service of the same full name as
+  // service->GetDescriptor() go to service.  The server does not take
+  // ownership.  Services must be registered before Start().
+  void RegisterService(Service* service);
+
+  // Sets the size of the largest call the server accepts, 64MB by default.
+  // A connection that starts sending a bigger one is closed, without the
+  // call being buffered.  Must be called before Start().
+  void SetMaxFrameSize(int max_frame_size);
+
+  // Starts listening on the Unix domain socket socket_path, replacing any
+  // file there, and starts the I/O thread.  Returns false and sets *error on
+  // failure.
+  bool Start(const std::string& socket_path, std::string* error);
+
+  // Stops accepting calls, waits for the Services to finish the calls in
+  // progress, closes all connections and removes the socket.
+  void Stop();
+
+ private:
+  class ServerCall;
+  struct Connection;
+  struct MethodPool;
+
+  static void* IoThreadMain(void* server);
+  void RunIo();
+
+  // Accepts the connections waiting on the listening socket.
+  void AcceptConnections();
+
+  // Reads what connection has sent and dispatches the calls in it.  Returns
+  // false if the connection was closed or failed.
+  bool ReadCalls(Connection* connection);
+
+  // Starts the call in the given frame.  Returns false if the frame is
+  // malformed.
+  bool DispatchCall(Connection* connection, const char* frame, int size);
+
+  // Run as the "done" callback of call:  sends the response and puts the
+  // call's objects back in the pools.
+  void FinishCall(ServerCall* call);
+
+  // Queues frame (swapping it out) to be sent on connection by the I/O
+  // thread, waking it up unless this is the I/O thread.  Must be called
+  // with mutex_ held.
+  void QueueResponse(Connection* connection, std::string* frame);
+
+  // Closes connection, and deletes it once no call on it is in progress.
+  void CloseConnection(Connection* connection);
+
+  // Writes the frames queued for connection that the socket will take,
+  // and watches it for writability if some are left.  Returns false if the
+  // connection failed.
+  bool FlushConnection(Connection* connection);
+
+  std::map<std::string, Service*> services_;
+  std::map<const MethodDescriptor*, MethodPool*> pools_;
+
+  std::string socket_path_;
+  int listen_fd_;
+  int wakeup_fd_;               // eventfd, written to wake the I/O thread up
+  int epoll_fd_;
+  int max_frame_size_;
+  struct IoThread;
+  IoThread* io_thread_;         // NULL until started
+
+  Mutex mutex_;                 // guards the members below
+  std::vector<Connection*> connections_;
+  // Connections with responses queued since the I/O thread last looked.
+  std::vector<Connection*> connections_to_flush_;
+  std::vector<ServerCall*> free_calls_;
+  int calls_in_progress_;
+  bool wakeup_pending_;
+  bool stopping_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(UnixSocketRpcServer);
+};
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_UNIX_SOCKET_RPC_H__
@@ -0,0 +1,348 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <unistd.h>
+
+#include <google/protobuf/unix_socket_rpc.h>
+#include <google/protobuf/local_rpc_channel.h>
+#include <google/protobuf/unknown_field_set.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+#ifdef __linux__
+
+// A flag set by a callback, to wait for from the test's thread.
+class Flag {
+ public:
+  Flag() : set_(false) {}
+
+  void Set() {
+    MutexLock lock(&mutex_);
+    set_ = true;
+  }
+  bool IsSet() {
+    MutexLock lock(&mutex_);
+    return set_;
+  }
+
+  // Waits up to ten seconds for the flag to be set.
+  bool Wait() {
+    for (int i = 0; i < 10000 && !IsSet(); i++) usleep(1000);
+    return IsSet();
+  }
+
+  Closure* NewSetCallback() { return NewCallback(this, &Flag::Set); }
+
+ private:
+  Mutex mutex_;
+  bool set_;
+};
+
+// Foo() copies the request's unknown fields into the response, or fails if
+// the request has none.  Bar() returns without finishing the call, which
+// the test then finishes with FinishBar().
+class TestServiceImpl : public protobuf_unittest::TestService {
+ public:
+  TestServiceImpl() : foo_calls_(0), bar_controller_(NULL), bar_done_(NULL) {}
+
+  void Foo(RpcController* controller,
+           const protobuf_unittest::FooRequest* request,
+           protobuf_unittest::FooResponse* response,
+           Closure* done) {
+    {
+      MutexLock lock(&mutex_);
+      ++foo_calls_;
+    }
+    // Requests come from the server's pools, so are always cleared first.
+    EXPECT_EQ(0, response->unknown_fields().field_count());
+    if (request->unknown_fields().field_count() == 0) {
+      controller->SetFailed("Empty request.");
+    } else {
+      response->mutable_unknown_fields()->MergeFrom(request->unknown_fields());
+    }
+    done->Run();
+  }
+
+  void Bar(RpcController* controller,
+           const protobuf_unittest::BarRequest* request,
+           protobuf_unittest::BarResponse* response,
+           Closure* done) {
+    MutexLock lock(&mutex_);
+    bar_controller_ = controller;
+    bar_done_ = done;
+    bar_started_.Set();
+  }
+
+  // Finishes the call to Bar(), failing it if error_text isn't empty.
+  void FinishBar(const std::string& error_text) {
+    RpcController* controller;
+    Closure* done;
+    {
+      MutexLock lock(&mutex_);
+      controller = bar_controller_;
+      done = bar_done_;
+    }
+    if (!error_text.empty()) controller->SetFailed(error_text);
+    done->Run();
+  }
+
+  int foo_calls() {
+    MutexLock lock(&mutex_);
+    return foo_calls_;
+  }
+
+  Flag bar_started_;
+
+ private:
+  Mutex mutex_;
+  int foo_calls_;
+  RpcController* bar_controller_;
+  Closure* bar_done_;
+};
+
+class UnixSocketRpcTest : public testing::Test {
+ protected:
+  UnixSocketRpcTest()
+    : socket_path_(TestTempDir() + "/unix_socket_rpc_test.socket"),
+      stub_(&channel_) {
+    server_.RegisterService(&service_);
+  }
+
+  virtual void SetUp() {
+    std::string error;
+    ASSERT_TRUE(server_.Start(socket_path_, &error)) << error;
+    ASSERT_TRUE(channel_.Connect(socket_path_, &error)) << error;
+  }
+
+  std::string socket_path_;
+  TestServiceImpl service_;
+  UnixSocketRpcServer server_;
+  UnixSocketRpcChannel channel_;
+  protobuf_unittest::TestService::Stub stub_;
+  LocalRpcController controller_;
+  Flag done_;
+};
+
+TEST_F(UnixSocketRpcTest, Call) {
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  request.mutable_unknown_fields()->AddVarint(1234, 5);
+  request.mutable_unknown_fields()->AddLengthDelimited(1235, "foo");
+  stub_.Foo(&controller_, &request, &response, done_.NewSetCallback());
+
+  ASSERT_TRUE(done_.Wait());
+  EXPECT_FALSE(controller_.Failed()) << controller_.ErrorText();
+  EXPECT_EQ(1, service_.foo_calls());
+  ASSERT_EQ(2, response.unknown_fields().field_count());
+  EXPECT_EQ(5, response.unknown_fields().field(0).varint());
+  EXPECT_EQ("foo", response.unknown_fields().field(1).length_delimited());
+}
+
+TEST_F(UnixSocketRpcTest, Failure) {
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  stub_.Foo(&controller_, &request, &response, done_.NewSetCallback());
+
+  ASSERT_TRUE(done_.Wait());
+  EXPECT_TRUE(controller_.Failed());
+  EXPECT_EQ("Empty request.", controller_.ErrorText());
+}
+
+TEST_F(UnixSocketRpcTest, FinishedFromAnotherThread) {
+  protobuf_unittest::BarRequest request;
+  protobuf_unittest::BarResponse response;
+  stub_.Bar(&controller_, &request, &response, done_.NewSetCallback());
+  ASSERT_TRUE(service_.bar_started_.Wait());
+  usleep(10000);
+  EXPECT_FALSE(done_.IsSet());
+
+  // The response is sent when "done" is run, from this thread.
+  service_.FinishBar("Bar failed.");
+  ASSERT_TRUE(done_.Wait());
+  EXPECT_TRUE(controller_.Failed());
+  EXPECT_EQ("Bar failed.", controller_.ErrorText());
+}
+
+TEST_F(UnixSocketRpcTest, UnknownService) {
+  UnixSocketRpcServer server;
+  std::string path = TestTempDir() + "/unix_socket_rpc_test2.socket";
+  std::string error;
+  ASSERT_TRUE(server.Start(path, &error)) << error;
+  UnixSocketRpcChannel channel;
+  ASSERT_TRUE(channel.Connect(path, &error)) << error;
+
+  protobuf_unittest::TestService::Stub stub(&channel);
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  stub.Foo(&controller_, &request, &response, done_.NewSetCallback());
+
+  ASSERT_TRUE(done_.Wait());
+  EXPECT_TRUE(controller_.Failed());
+  EXPECT_EQ("Unknown service: protobuf_unittest.TestService",
+            controller_.ErrorText());
+}
+
+TEST_F(UnixSocketRpcTest, NotConnected) {
+  UnixSocketRpcChannel channel;
+  std::string error;
+  EXPECT_FALSE(channel.Connect(TestTempDir() + "/no_such.socket", &error));
+  EXPECT_NE(std::string::npos, error.find("connect to ")) << error;
+
+  protobuf_unittest::TestService::Stub stub(&channel);
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  stub.Foo(&controller_, &request, &response, done_.NewSetCallback());
+
+  // The call fails without being sent, so "done" has already run.
+  EXPECT_TRUE(done_.IsSet());
+  EXPECT_TRUE(controller_.Failed());
+  EXPECT_EQ("Not connected.", controller_.ErrorText());
+}
+
+TEST_F(UnixSocketRpcTest, ServerStopped) {
+  server_.Stop();
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  request.mutable_unknown_fields()->AddVarint(1234, 5);
+  stub_.Foo(&controller_, &request, &response, done_.NewSetCallback());
+
+  // Whether the channel notices the closed connection before or after it
+  // sends the call, the call fails.
+  ASSERT_TRUE(done_.Wait());
+  EXPECT_TRUE(controller_.Failed());
+  EXPECT_EQ(0, service_.foo_calls());
+}
+
+TEST_F(UnixSocketRpcTest, ChannelDestroyed) {
+  scoped_ptr<UnixSocketRpcChannel> channel(new UnixSocketRpcChannel);
+  std::string error;
+  ASSERT_TRUE(channel->Connect(socket_path_, &error)) << error;
+  protobuf_unittest::TestService::Stub stub(channel.get());
+  protobuf_unittest::BarRequest request;
+  protobuf_unittest::BarResponse response;
+  stub.Bar(&controller_, &request, &response, done_.NewSetCallback());
+  ASSERT_TRUE(service_.bar_started_.Wait());
+
+  // The outstanding call fails when the channel goes away...
+  channel.reset();
+  EXPECT_TRUE(done_.IsSet());
+  EXPECT_TRUE(controller_.Failed());
+  EXPECT_EQ("Channel destroyed.", controller_.ErrorText());
+
+  // ...and the server drops its response.
+  service_.FinishBar("");
+}
+
+TEST_F(UnixSocketRpcTest, CallTooLarge) {
+  UnixSocketRpcServer server;
+  server.RegisterService(&service_);
+  server.SetMaxFrameSize(100);
+  std::string path = TestTempDir() + "/unix_socket_rpc_test2.socket";
+  std::string error;
+  ASSERT_TRUE(server.Start(path, &error)) << error;
+  UnixSocketRpcChannel channel;
+  ASSERT_TRUE(channel.Connect(path, &error)) << error;
+
+  // The server closes the connection instead of dispatching the call.
+  protobuf_unittest::TestService::Stub stub(&channel);
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  request.mutable_unknown_fields()->AddLengthDelimited(1234,
+                                                       std::string(200, 'x'));
+  stub.Foo(&controller_, &request, &response, done_.NewSetCallback());
+
+  ASSERT_TRUE(done_.Wait());
+  EXPECT_TRUE(controller_.Failed());
+  EXPECT_EQ("Connection closed by server.", controller_.ErrorText());
+  EXPECT_EQ(0, service_.foo_calls());
+}
+
+TEST_F(UnixSocketRpcTest, ResponseTooLarge) {
+  UnixSocketRpcChannel channel;
+  channel.SetMaxFrameSize(100);
+  std::string error;
+  ASSERT_TRUE(channel.Connect(socket_path_, &error)) << error;
+
+  protobuf_unittest::TestService::Stub stub(&channel);
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  request.mutable_unknown_fields()->AddLengthDelimited(1234,
+                                                       std::string(200, 'x'));
+  stub.Foo(&controller_, &request, &response, done_.NewSetCallback());
+
+  ASSERT_TRUE(done_.Wait());
+  EXPECT_TRUE(controller_.Failed());
+  EXPECT_EQ("Malformed or oversized response from server.",
+            controller_.ErrorText());
+  EXPECT_EQ(1, service_.foo_calls());
+}
+
+TEST_F(UnixSocketRpcTest, ManyCalls) {
+  const int kCalls = 1000;
+  std::vector<protobuf_unittest::FooRequest*> requests;
+  std::vector<protobuf_unittest::FooResponse*> responses;
+  std::vector<LocalRpcController*> controllers;
+  std::vector<Flag*> flags;
+  for (int i = 0; i < kCalls; i++) {
+    requests.push_back(new protobuf_unittest::FooRequest);
+    requests[i]->mutable_unknown_fields()->AddVarint(1234, i);
+    responses.push_back(new protobuf_unittest::FooResponse);
+    controllers.push_back(new LocalRpcController);
+    flags.push_back(new Flag);
+    stub_.Foo(controllers[i], requests[i], responses[i],
+              flags[i]->NewSetCallback());
+  }
+
+  for (int i = 0; i < kCalls; i++) {
+    ASSERT_TRUE(flags[i]->Wait());
+    EXPECT_FALSE(controllers[i]->Failed()) << controllers[i]->ErrorText();
+    ASSERT_EQ(1, responses[i]->unknown_fields().field_count());
+    EXPECT_EQ(i, responses[i]->unknown_fields().field(0).varint());
+  }
+  EXPECT_EQ(kCalls, service_.foo_calls());
+
+  STLDeleteElements(&requests);
+  STLDeleteElements(&responses);
+  STLDeleteElements(&controllers);
+  STLDeleteElements(&flags);
+}
+
+#endif  // __linux__
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
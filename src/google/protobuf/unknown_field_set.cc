@@ -34,6 +34,7 @@
 
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/unknown_field_set.h>
+#include <google/protobuf/allocator.h>
 #include <google/protobuf/stubs/stl_util-inl.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream.h>
@@ -43,12 +44,23 @@
 namespace google {
 namespace protobuf {
 
+namespace {
+
+// The contents of UnknownFieldSets are allocated through the Allocator
+// (see allocator.h).
+std::vector<UnknownField>* NewFields() {
+  return internal::NewObject<std::vector<UnknownField> >(
+      ALLOCATION_UNKNOWN_FIELDS);
+}
+
+}  // namespace
+
 UnknownFieldSet::UnknownFieldSet()
   : fields_(NULL) {}
 
 UnknownFieldSet::~UnknownFieldSet() {
   Clear();
-  delete fields_;
+  internal::DeleteObject(fields_, ALLOCATION_UNKNOWN_FIELDS);
 }
 
 void UnknownFieldSet::ClearFallback() {
@@ -91,7 +103,7 @@ int UnknownFieldSet::SpaceUsed() const {
 }
 
 void UnknownFieldSet::AddVarint(int number, uint64 value) {
-  if (fields_ == NULL) fields_ = new std::vector<UnknownField>;
+  if (fields_ == NULL) fields_ = NewFields();
   UnknownField field;
   field.number_ = number;
   field.type_ = UnknownField::TYPE_VARINT;
@@ -100,7 +112,7 @@ void UnknownFieldSet::AddVarint(int number, uint64 value) {
 }
 
 void UnknownFieldSet::AddFixed32(int number, uint32 value) {
-  if (fields_ == NULL) fields_ = new std::vector<UnknownField>;
+  if (fields_ == NULL) fields_ = NewFields();
   UnknownField field;
   field.number_ = number;
   field.type_ = UnknownField::TYPE_FIXED32;
@@ -109,7 +121,7 @@ void UnknownFieldSet::AddFixed32(int number, uint32 value) {
 }
 
 void UnknownFieldSet::AddFixed64(int number, uint64 value) {
-  if (fields_ == NULL) fields_ = new std::vector<UnknownField>;
+  if (fields_ == NULL) fields_ = NewFields();
   UnknownField field;
   field.number_ = number;
   field.type_ = UnknownField::TYPE_FIXED64;
@@ -118,27 +130,29 @@ void UnknownFieldSet::AddFixed64(int number, uint64 value) {
 }
 
 std::string* UnknownFieldSet::AddLengthDelimited(int number) {
-  if (fields_ == NULL) fields_ = new std::vector<UnknownField>;
+  if (fields_ == NULL) fields_ = NewFields();
   UnknownField field;
   field.number_ = number;
   field.type_ = UnknownField::TYPE_LENGTH_DELIMITED;
-  field.length_delimited_ = new std::string;
+  field.length_delimited_ =
+      internal::NewObject<std::string>(ALLOCATION_UNKNOWN_FIELDS);
   fields_->push_back(field);
   return field.length_delimited_;
 }
 
 UnknownFieldSet* UnknownFieldSet::AddGroup(int number) {
-  if (fields_ == NULL) fields_ = new std::vector<UnknownField>;
+  if (fields_ == NULL) fields_ = NewFields();
   UnknownField field;
   field.number_ = number;
   field.type_ = UnknownField::TYPE_GROUP;
-  field.group_ = new UnknownFieldSet;
+  field.group_ =
+      internal::NewObject<UnknownFieldSet>(ALLOCATION_UNKNOWN_FIELDS);
   fields_->push_back(field);
   return field.group_;
 }
 
 void UnknownFieldSet::AddField(const UnknownField& field) {
-  if (fields_ == NULL) fields_ = new std::vector<UnknownField>;
+  if (fields_ == NULL) fields_ = NewFields();
   fields_->push_back(field);
   fields_->back().DeepCopy();
 }
@@ -174,10 +188,10 @@ bool UnknownFieldSet::ParseFromArray(const void* data, int size) {
 void UnknownField::Delete() {
   switch (type()) {
     case UnknownField::TYPE_LENGTH_DELIMITED:
-      delete length_delimited_;
+      internal::DeleteObject(length_delimited_, ALLOCATION_UNKNOWN_FIELDS);
       break;
     case UnknownField::TYPE_GROUP:
-      delete group_;
+      internal::DeleteObject(group_, ALLOCATION_UNKNOWN_FIELDS);
       break;
     default:
       break;
@@ -186,11 +200,16 @@ void UnknownField::Delete() {
 
 void UnknownField::DeepCopy() {
   switch (type()) {
-    case UnknownField::TYPE_LENGTH_DELIMITED:
-      length_delimited_ = new std::string(*length_delimited_);
+    case UnknownField::TYPE_LENGTH_DELIMITED: {
+      std::string* value =
+          internal::NewObject<std::string>(ALLOCATION_UNKNOWN_FIELDS);
+      value->assign(*length_delimited_);
+      length_delimited_ = value;
       break;
+    }
     case UnknownField::TYPE_GROUP: {
-      UnknownFieldSet* group = new UnknownFieldSet;
+      UnknownFieldSet* group =
+          internal::NewObject<UnknownFieldSet>(ALLOCATION_UNKNOWN_FIELDS);
       group->MergeFrom(*group_);
       group_ = group;
       break;
@@ -26,4 +26,12 @@
 
 /* define if you want to use zlib.  See readme.txt for additional
  * requirements. */
-// #define HAVE_ZLIB 1
\ No newline at end of file
+// #define HAVE_ZLIB 1
+
+/* define to count parsing and serialization per message type.  See
+ * google/protobuf/message_stats.h. */
+// #define GOOGLE_PROTOBUF_MESSAGE_STATS 1
+
+/* define to count what the library allocates per category.  See
+ * google/protobuf/allocator.h. */
+// #define GOOGLE_PROTOBUF_ALLOCATION_STATS 1